@@ -0,0 +1,148 @@
+/******************************************************************************
+ * (C) Copyright 2013-2015 Magnus Rosenius and the Free Software Foundation.
+ *
+ * This file is part of OpenRIO.
+ *
+ * OpenRIO is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenRIO is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Lesser Public License
+ * along with OpenRIO.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+
+
+/******************************************************************************
+ * Description:
+ * Link-up time benchmark for the link training in riostack.c.
+ *
+ * Two stacks are connected by a simulated UART line using riouart.c. One
+ * octet is sent in each direction per octet time and the number of octet
+ * times until both links are initialized is counted. The link-up time is
+ * printed for a number of baudrates, counted as ten bits per octet, with the
+ * default and the fast link training in one or both stacks.
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/* The stack functions are used without the test framework, abort on failed assertions. */
+#define ASSERT0(s) { fprintf(stderr, "%s\n", s); abort(); }
+#define ASSERT(c, s) { if( !(c) ) { ASSERT0( s ); } }
+
+#include "riouart.c"
+#include "riostack.c"
+#include "riopacket.c"
+#include "riopool.c"
+
+#define QUEUE_LENGTH 2
+#define OCTETS_MAX 1000000ul
+
+/* One side of the line. */
+typedef struct
+{
+  RioStack_t stack;
+  RioUart_t uart;
+  uint32_t rxBuffer[RIOSTACK_BUFFER_SIZE * QUEUE_LENGTH];
+  uint32_t txBuffer[RIOSTACK_BUFFER_SIZE * QUEUE_LENGTH];
+  uint8_t octets[RIOUART_SYMBOL_SIZE_MAX];
+  uint32_t length;
+  uint32_t index;
+} Side_t;
+
+static Side_t sideA;
+static Side_t sideB;
+
+static const uint32_t baudrates[] = {9600ul, 115200ul, 921600ul, 3000000ul};
+
+static void openSide(Side_t *side, uint8_t fast)
+{
+  RIOSTACK_open(&side->stack, NULL,
+      RIOSTACK_BUFFER_SIZE*QUEUE_LENGTH, side->rxBuffer,
+      RIOSTACK_BUFFER_SIZE*QUEUE_LENGTH, side->txBuffer);
+  if(fast)
+  {
+    RIOSTACK_setLinkTrainingFast(&side->stack);
+  }
+  RIOUART_open(&side->uart);
+  side->length = 0ul;
+  side->index = 0ul;
+  RIOSTACK_portSetStatus(&side->stack, 1u);
+}
+
+/* Send one octet from a side to the other. */
+static void sendOctet(Side_t *from, Side_t *to)
+{
+  RioSymbol_t s;
+  RioSymbol_t decoded;
+
+  if(from->index == from->length)
+  {
+    s = RIOSTACK_portGetSymbol(&from->stack);
+    from->length = RIOUART_encodeSymbols(1ul, &s, from->octets);
+    from->index = 0ul;
+  }
+
+  if(RIOUART_decodeSymbols(&to->uart, 1ul, &from->octets[from->index], &decoded) != 0ul)
+  {
+    RIOSTACK_portAddSymbol(&to->stack, decoded);
+  }
+  from->index++;
+}
+
+/* Return the number of octet times until the link is up. */
+static uint32_t linkUp(uint8_t fastA, uint8_t fastB)
+{
+  uint32_t octets;
+
+  openSide(&sideA, fastA);
+  openSide(&sideB, fastB);
+  for(octets = 0ul; (!RIOSTACK_getLinkIsInitialized(&sideA.stack) ||
+                     !RIOSTACK_getLinkIsInitialized(&sideB.stack)) && (octets < OCTETS_MAX); octets++)
+  {
+    sendOctet(&sideA, &sideB);
+    sendOctet(&sideB, &sideA);
+  }
+  ASSERT(octets < OCTETS_MAX, "The link did not come up");
+
+  return octets;
+}
+
+static void report(const char *name, uint32_t octets)
+{
+  uint32_t i;
+
+  printf("%-22s %8lu", name, (unsigned long) octets);
+  for(i = 0ul; i < sizeof(baudrates)/sizeof(baudrates[0]); i++)
+  {
+    printf(" %10.2f", (10.0 * octets * 1000.0) / baudrates[i]);
+  }
+  printf("\n");
+}
+
+int main(int argc, char *argv[])
+{
+  uint32_t i;
+
+  printf("%-22s %8s", "link training", "octets");
+  for(i = 0ul; i < sizeof(baudrates)/sizeof(baudrates[0]); i++)
+  {
+    printf(" %7lu ms", (unsigned long) baudrates[i]);
+  }
+  printf("\n");
+
+  report("default", linkUp(0u, 0u));
+  report("fast in one stack", linkUp(1u, 0u));
+  report("fast", linkUp(1u, 1u));
+
+  return 0;
+}
+
+/*************************** end of file **************************************/
@@ -0,0 +1,266 @@
+/******************************************************************************
+ * (C) Copyright 2013-2015 Magnus Rosenius and the Free Software Foundation.
+ *
+ * This file is part of OpenRIO.
+ *
+ * OpenRIO is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenRIO is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Lesser Public License
+ * along with OpenRIO.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+
+/******************************************************************************
+ * Description:
+ * Header overhead benchmark for riopacket.c.
+ *
+ * The number of link bytes used by NREAD and NWRITE packets are printed for
+ * all combinations of transport types and address sizes together with the
+ * payload efficiency. The processor time used to build and decode NWRITE
+ * packets with the ordinary and the extended functions is also printed, as well
+ * as the time to re-target a 256 byte NWRITE by decoding and building it again
+ * and by changing the destination with RIOPACKET_patchHeader(). Last, the time
+ * to build short NWRITEs with the ordinary functions is compared with building
+ * them from templates, and the time to validate packets of mixed sizes one at
+ * a time with the time to validate them in batches.
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* The packet functions are used without the test framework, abort on failed assertions. */
+#define ASSERT0(s) { fprintf(stderr, "%s\n", s); abort(); }
+#define ASSERT(c, s) { if( !(c) ) { ASSERT0( s ); } }
+
+#include "riopacket.c"
+
+#define ITERATIONS 1000000
+
+/* The number of packets to validate in each call to RIOPACKET_validBatch(). */
+#define BATCH_SIZE 64
+
+/* The link bytes of the start-of-packet and end-of-packet control symbols. */
+#define PACKET_DELIMITER_SIZE 8u
+
+static const RioPacketTt_t ttList[] =
+  {RIOPACKET_TT_8BITS, RIOPACKET_TT_16BITS, RIOPACKET_TT_32BITS};
+static const char *ttName[] = {"8-bit", "16-bit", "32-bit"};
+static const RioPacketAddressSize_t addressSizeList[] =
+  {RIOPACKET_ADDRESS_34BITS, RIOPACKET_ADDRESS_50BITS, RIOPACKET_ADDRESS_66BITS};
+static const char *addressSizeName[] = {"34-bit", "50-bit", "66-bit"};
+static const uint16_t sizeList[] = {8u, 32u, 64u, 128u, 256u};
+
+static uint8_t payload[256];
+
+static void reportSizes(void)
+{
+  RioPacket_t packet;
+  uint32_t linkBytes;
+  int i, j, k;
+
+  printf("%-8s %-7s %5s", "deviceId", "address", "NREAD");
+  for(k = 0; k < (int) (sizeof(sizeList)/sizeof(sizeList[0])); k++)
+  {
+    printf("   NWRITE%-5u", (unsigned) sizeList[k]);
+  }
+  printf("\n");
+
+  for(i = 0; i < 3; i++)
+  {
+    for(j = 0; j < 3; j++)
+    {
+      RIOPACKET_setNreadExt(&packet, ttList[i], addressSizeList[j], 0x12, 0x34, 0x56, 0x1000, 8u);
+      printf("%-8s %-7s %5lu", ttName[i], addressSizeName[j],
+             (unsigned long) (4u*packet.size + PACKET_DELIMITER_SIZE));
+
+      for(k = 0; k < (int) (sizeof(sizeList)/sizeof(sizeList[0])); k++)
+      {
+        RIOPACKET_setNwriteExt(&packet, ttList[i], addressSizeList[j], 0x12, 0x34, 0x1000,
+                               sizeList[k], payload);
+        if(packet.size != 0u)
+        {
+          linkBytes = 4u*packet.size + PACKET_DELIMITER_SIZE;
+          printf("   %4lu %5.1f%%", (unsigned long) linkBytes, 100.0 * sizeList[k] / linkBytes);
+        }
+        else
+        {
+          printf("   %11s", "too large");
+        }
+      }
+      printf("\n");
+    }
+  }
+}
+
+static void report(const char *name, clock_t ticks)
+{
+  double seconds = (double) ticks / CLOCKS_PER_SEC;
+
+  printf("%-22s %8.1f ns/packet\n", name, 1e9 * seconds / ITERATIONS);
+}
+
+static void benchNwrite(void)
+{
+  RioPacket_t packet;
+  uint8_t data[256];
+  uint16_t dstId, srcId, size;
+  uint32_t dstIdExt, srcIdExt;
+  uint32_t address;
+  uint64_t addressExt;
+  uint32_t check;
+  char name[32];
+  clock_t start;
+  int i, j;
+
+  check = 0;
+  start = clock();
+  for(i = 0; i < ITERATIONS; i++)
+  {
+    RIOPACKET_setNwrite(&packet, 0x12, 0x34, 0x1000 + 8*(i & 0xff), 64u, payload);
+    RIOPACKET_getNwrite(&packet, &dstId, &srcId, &address, &size, data);
+    check += data[i & 0x3f];
+  }
+  report("NWRITE 16-bit", clock() - start);
+
+  for(j = 0; j < 3; j++)
+  {
+    start = clock();
+    for(i = 0; i < ITERATIONS; i++)
+    {
+      RIOPACKET_setNwriteExt(&packet, ttList[j], RIOPACKET_ADDRESS_34BITS, 0x12, 0x34,
+                             0x1000 + 8*(i & 0xff), 64u, payload);
+      RIOPACKET_getNwriteExt(&packet, RIOPACKET_ADDRESS_34BITS, &dstIdExt, &srcIdExt,
+                             &addressExt, &size, data);
+      check += data[i & 0x3f];
+    }
+    snprintf(name, sizeof(name), "NWRITE-EXT %s", ttName[j]);
+    report(name, clock() - start);
+  }
+
+  if(check == 0xffffffffu)
+  {
+    printf("\n");
+  }
+}
+
+static void benchPatch(void)
+{
+  RioPacket_t packet;
+  uint8_t data[256];
+  uint16_t dstId, srcId, size;
+  uint32_t address;
+  clock_t start;
+  int i;
+
+  RIOPACKET_setNwrite(&packet, 0x12, 0x34, 0x1000, 256u, payload);
+  start = clock();
+  for(i = 0; i < ITERATIONS; i++)
+  {
+    RIOPACKET_getNwrite(&packet, &dstId, &srcId, &address, &size, data);
+    RIOPACKET_setNwrite(&packet, (uint16_t) i, srcId, address, size, data);
+  }
+  report("re-target rebuild", clock() - start);
+  ASSERT(RIOPACKET_valid(&packet), "Invalid rebuilt packet");
+
+  RIOPACKET_setNwrite(&packet, 0x12, 0x34, 0x1000, 256u, payload);
+  start = clock();
+  for(i = 0; i < ITERATIONS; i++)
+  {
+    RIOPACKET_patchHeader(&packet, RIOPACKET_FIELD_DESTINATION, (uint16_t) i);
+  }
+  report("re-target patch", clock() - start);
+  ASSERT(RIOPACKET_valid(&packet), "Invalid patched packet");
+}
+
+static void benchTemplate(void)
+{
+  RioPacket_t packet;
+  RioPacketTemplate_t packetTemplate;
+  clock_t start;
+  int i;
+
+  start = clock();
+  for(i = 0; i < ITERATIONS; i++)
+  {
+    RIOPACKET_setNwrite(&packet, 0x12, 0x34, ((uint32_t) i) << 3, 32u, payload);
+  }
+  report("nwrite 32 build", clock() - start);
+  ASSERT(RIOPACKET_valid(&packet), "Invalid built packet");
+
+  RIOPACKET_setNwriteTemplate(&packetTemplate, 0x12, 0x34, 32u);
+  start = clock();
+  for(i = 0; i < ITERATIONS; i++)
+  {
+    RIOPACKET_setNwriteFromTemplate(&packet, &packetTemplate, 0u, ((uint32_t) i) << 3, payload);
+  }
+  report("nwrite 32 template", clock() - start);
+  ASSERT(RIOPACKET_valid(&packet), "Invalid template packet");
+}
+
+static void benchValid(void)
+{
+  static RioPacket_t packets[BATCH_SIZE];
+  const RioPacket_t *packetList[BATCH_SIZE];
+  uint32_t results[BATCH_SIZE/32];
+  uint32_t valid;
+  clock_t start;
+  int i, j;
+
+  for(j = 0; j < BATCH_SIZE; j++)
+  {
+    RIOPACKET_setNwrite(&packets[j], 0x12, 0x34, 0x1000, (uint16_t) (8 * (1 + (j % 32))), payload);
+    packetList[j] = &packets[j];
+  }
+
+  valid = 0;
+  start = clock();
+  for(i = 0; i < ITERATIONS/BATCH_SIZE; i++)
+  {
+    for(j = 0; j < BATCH_SIZE; j++)
+    {
+      valid += RIOPACKET_valid(packetList[j]);
+    }
+  }
+  report("valid mixed sizes", clock() - start);
+  ASSERT(valid == (ITERATIONS/BATCH_SIZE)*BATCH_SIZE, "Invalid packets");
+
+  valid = 0;
+  start = clock();
+  for(i = 0; i < ITERATIONS/BATCH_SIZE; i++)
+  {
+    valid += RIOPACKET_validBatch(packetList, BATCH_SIZE, results);
+  }
+  report("validBatch mixed sizes", clock() - start);
+  ASSERT(valid == (ITERATIONS/BATCH_SIZE)*BATCH_SIZE, "Invalid packets");
+}
+
+int main(int argc, char *argv[])
+{
+  int i;
+
+  for(i = 0; i < 256; i++)
+  {
+    payload[i] = (uint8_t) rand();
+  }
+
+  reportSizes();
+  printf("\n");
+  benchNwrite();
+  benchPatch();
+  benchTemplate();
+  benchValid();
+
+  return 0;
+}
+
+/*************************** end of file **************************************/
@@ -0,0 +1,135 @@
+/******************************************************************************
+ * (C) Copyright 2013-2015 Magnus Rosenius and the Free Software Foundation.
+ *
+ * This file is part of OpenRIO.
+ *
+ * OpenRIO is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenRIO is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Lesser Public License
+ * along with OpenRIO.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+
+/******************************************************************************
+ * Description:
+ * Throughput benchmark for riopcs.c.
+ *
+ * A buffer of data symbols is encoded and decoded a number of times and the
+ * line rate that one core can handle, counted as ten bits per code group, is
+ * printed for characters, symbols and serial bitstreams.
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* The PCS functions are used without the test framework, abort on failed assertions. */
+#define ASSERT0(s) { fprintf(stderr, "%s\n", s); abort(); }
+#define ASSERT(c, s) { if( !(c) ) { ASSERT0( s ); } }
+
+#include "riopcs.c"
+#include "riostack.c"
+#include "riopacket.c"
+#include "riopool.c"
+
+#define SYMBOLS 16384
+#define ITERATIONS 200
+
+static RioSymbol_t symbols[SYMBOLS];
+static RioSymbol_t received[RIOPCS_CODE_GROUPS_MAX(SYMBOLS)];
+static uint16_t characters[4*SYMBOLS];
+static uint16_t decoded[4*SYMBOLS];
+static uint16_t codeGroups[RIOPCS_CODE_GROUPS_MAX(SYMBOLS)];
+static uint8_t bits[2*RIOPCS_CODE_GROUPS_MAX(SYMBOLS)];
+
+static void report(const char *name, clock_t ticks, uint32_t codeGroupCount)
+{
+  double seconds = (double) ticks / CLOCKS_PER_SEC;
+
+  printf("%-22s %8.2f Gbit/s\n", name, (10.0 * codeGroupCount * ITERATIONS) / seconds / 1e9);
+}
+
+int main(int argc, char *argv[])
+{
+  RioPcs_t tx;
+  RioPcs_t rx;
+  clock_t start;
+  uint32_t n;
+  uint32_t m;
+  int i;
+
+
+  for(i = 0; i < SYMBOLS; i++)
+  {
+    symbols[i].type = RIOSTACK_SYMBOL_TYPE_DATA;
+    symbols[i].data = (uint32_t) rand();
+    characters[4*i+0] = (uint16_t) (symbols[i].data >> 24);
+    characters[4*i+1] = (uint16_t) ((symbols[i].data >> 16) & 0xff);
+    characters[4*i+2] = (uint16_t) ((symbols[i].data >> 8) & 0xff);
+    characters[4*i+3] = (uint16_t) (symbols[i].data & 0xff);
+  }
+
+  RIOPCS_open(&tx);
+  RIOPCS_open(&rx);
+
+  start = clock();
+  for(i = 0; i < ITERATIONS; i++)
+  {
+    RIOPCS_encodeCharacters(&tx, 4*SYMBOLS, characters, codeGroups);
+  }
+  report("encode characters", clock() - start, 4*SYMBOLS);
+
+  start = clock();
+  for(i = 0; i < ITERATIONS; i++)
+  {
+    (void) RIOPCS_decodeCharacters(&rx, 4*SYMBOLS, codeGroups, decoded);
+  }
+  report("decode characters", clock() - start, 4*SYMBOLS);
+  ASSERT(memcmp(characters, decoded, sizeof(characters)) == 0, "Decoded characters differs");
+
+  RIOPCS_open(&tx);
+  RIOPCS_open(&rx);
+  n = 0;
+  start = clock();
+  for(i = 0; i < ITERATIONS; i++)
+  {
+    n = RIOPCS_encodeSymbols(&tx, SYMBOLS, symbols, codeGroups);
+  }
+  report("encode symbols", clock() - start, n);
+
+  m = 0;
+  start = clock();
+  for(i = 0; i < ITERATIONS; i++)
+  {
+    m = RIOPCS_decodeSymbols(&rx, n, codeGroups, received);
+  }
+  report("decode symbols", clock() - start, n);
+  ASSERT(m == SYMBOLS, "Wrong number of decoded symbols");
+
+  start = clock();
+  for(i = 0; i < ITERATIONS; i++)
+  {
+    RIOPCS_packBits(n, codeGroups, bits);
+  }
+  report("pack bits", clock() - start, n);
+
+  start = clock();
+  for(i = 0; i < ITERATIONS; i++)
+  {
+    RIOPCS_unpackBits(0, n, bits, codeGroups);
+  }
+  report("unpack bits", clock() - start, n);
+
+  return 0;
+}
+
+/*************************** end of file **************************************/
@@ -0,0 +1,207 @@
+/******************************************************************************
+ * (C) Copyright 2013-2015 Magnus Rosenius and the Free Software Foundation.
+ *
+ * This file is part of OpenRIO.
+ *
+ * OpenRIO is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenRIO is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Lesser Public License
+ * along with OpenRIO.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+
+
+/******************************************************************************
+ * Description:
+ * Throughput benchmark for rioshm.c.
+ *
+ * A child process is connected to the benchmark process with a shared memory
+ * segment. First, symbols are written directly into the ring by the child and
+ * read by the parent. Then, the child sends NWRITE packets with a full payload
+ * from a stack that the parent receives in its stack. The number of symbols
+ * per second is printed for both cases.
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+
+/* The driver is used without the test framework, abort on failed assertions. */
+#define ASSERT0(s) { fprintf(stderr, "%s\n", s); abort(); }
+#define ASSERT(c, s) { if( !(c) ) { ASSERT0( s ); } }
+
+#include "rioshm.c"
+#include "riostack.c"
+#include "riopacket.c"
+#include "riopool.c"
+
+#define RING_SYMBOLS 50000000ul
+#define PACKETS 200000ul
+#define BATCH 256u
+#define QUEUE_LENGTH 16
+
+static RioStack_t stack;
+static uint32_t rxPacketBuffer[RIOSTACK_BUFFER_SIZE * QUEUE_LENGTH];
+static uint32_t txPacketBuffer[RIOSTACK_BUFFER_SIZE * QUEUE_LENGTH];
+
+static double getSeconds(void)
+{
+  struct timespec now;
+
+  (void) clock_gettime(CLOCK_MONOTONIC, &now);
+  return (double) now.tv_sec + (double) now.tv_nsec / 1e9;
+}
+
+static uint32_t getTime(void)
+{
+  return (uint32_t) (getSeconds() * 1000.0);
+}
+
+static int createSegment(RioShm_t *shm)
+{
+  char name[64];
+  int fd;
+
+  snprintf(name, sizeof(name), "/riobench-%d", (int) getpid());
+  fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+  ASSERT(fd >= 0, "Could not create a shared memory object");
+  (void) shm_unlink(name);
+
+  RIOSTACK_open(&stack, NULL,
+      RIOSTACK_BUFFER_SIZE*QUEUE_LENGTH, rxPacketBuffer,
+      RIOSTACK_BUFFER_SIZE*QUEUE_LENGTH, txPacketBuffer);
+  RIOSTACK_portSetTimeout(&stack, 1000);
+  ASSERT(RIOSHM_create(shm, &stack, fd), "Could not create the segment");
+
+  return fd;
+}
+
+static void benchRing(void)
+{
+  RioShm_t shm;
+  RioSymbol_t s[BATCH];
+  uint32_t expected;
+  uint32_t n;
+  uint32_t i;
+  int fd;
+  double start;
+
+
+  fd = createSegment(&shm);
+  if(fork() == 0)
+  {
+    ASSERT(RIOSHM_attach(&shm, &stack, fd), "Could not attach");
+    for(i = 0; i < BATCH; i++)
+    {
+      s[i].type = RIOSTACK_SYMBOL_TYPE_DATA;
+    }
+    expected = 0;
+    while(expected < RING_SYMBOLS)
+    {
+      for(i = 0; i < BATCH; i++)
+      {
+        s[i].data = expected + i;
+      }
+      expected += RIOSHM_send(&shm, BATCH, s);
+    }
+    _exit(0);
+  }
+
+  expected = 0;
+  start = getSeconds();
+  while(expected < RING_SYMBOLS)
+  {
+    n = RIOSHM_receive(&shm, BATCH, s);
+    for(i = 0; i < n; i++)
+    {
+      ASSERT(s[i].data == expected, "Symbols out of order");
+      expected++;
+    }
+    if(n == 0)
+    {
+      RIOSHM_wait(&shm, 1);
+    }
+  }
+  printf("%-22s %8.1f Msymbols/s\n", "ring", RING_SYMBOLS / (getSeconds() - start) / 1e6);
+
+  (void) wait(NULL);
+  RIOSHM_close(&shm);
+}
+
+static void benchStack(void)
+{
+  RioShm_t shm;
+  RioPacket_t packet;
+  uint8_t payload[256];
+  uint32_t received;
+  uint32_t sent;
+  int fd;
+  double start;
+
+
+  fd = createSegment(&shm);
+  if(fork() == 0)
+  {
+    ASSERT(RIOSHM_attach(&shm, &stack, fd), "Could not attach");
+    memset(payload, 0xa5, sizeof(payload));
+    sent = 0;
+    while((sent < PACKETS) || (RIOSTACK_getOutboundQueueLength(&stack) > 0))
+    {
+      while((sent < PACKETS) && (RIOSTACK_getOutboundQueueAvailable(&stack) > 0))
+      {
+        RIOPACKET_setNwrite(&packet, 0x0001, 0x0002, sent * 256u, sizeof(payload), payload);
+        RIOSTACK_setOutboundPacket(&stack, &packet);
+        sent++;
+      }
+      if(RIOSHM_process(&shm, getTime()) == 0)
+      {
+        RIOSHM_wait(&shm, 1);
+      }
+    }
+    _exit(0);
+  }
+
+  received = 0;
+  start = 0.0;
+  while(received < PACKETS)
+  {
+    while(RIOSTACK_getInboundQueueLength(&stack) > 0)
+    {
+      RIOSTACK_getInboundPacket(&stack, &packet);
+      if(received == 0)
+      {
+        start = getSeconds();
+      }
+      received++;
+    }
+    if(RIOSHM_process(&shm, getTime()) == 0)
+    {
+      RIOSHM_wait(&shm, 1);
+    }
+  }
+  printf("%-22s %8.1f Msymbols/s %8.1f kpackets/s\n", "stack NWRITE 256 bytes",
+         shm.statusSymbolsReceived / (getSeconds() - start) / 1e6,
+         PACKETS / (getSeconds() - start) / 1e3);
+
+  (void) wait(NULL);
+  RIOSHM_close(&shm);
+}
+
+int main(int argc, char *argv[])
+{
+  benchRing();
+  benchStack();
+
+  return 0;
+}
+
+/*************************** end of file **************************************/
@@ -0,0 +1,204 @@
+/******************************************************************************
+ * (C) Copyright 2013-2015 Magnus Rosenius and the Free Software Foundation.
+ *
+ * This file is part of OpenRIO.
+ *
+ * OpenRIO is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenRIO is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Lesser Public License
+ * along with OpenRIO.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+
+/******************************************************************************
+ * Description:
+ * Throughput benchmark for riostream.c.
+ *
+ * A 64KiB PDU is transferred repeatedly using data streaming segments and 
+ * using NWRITE packets that carry a small application header in front of 
+ * each fragment. The number of bytes on the link, including the control 
+ * symbols that delimit each packet, and the processor time used to segment 
+ * and reassemble the PDUs are printed for both methods.
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* The stack is used without the test framework, abort on failed assertions. */
+#define ASSERT0(s) { fprintf(stderr, "%s\n", s); abort(); }
+#define ASSERT(c, s) { if( !(c) ) { ASSERT0( s ); } }
+
+#include "riostream.c"
+#include "riostack.c"
+#include "riopacket.c"
+#include "riopool.c"
+
+#define ITERATIONS 500
+#define MTU 256u
+
+/* The size of the application header used in front of each NWRITE fragment. */
+#define NWRITE_HEADER_SIZE 8u
+#define NWRITE_FRAGMENT_SIZE (256u - NWRITE_HEADER_SIZE)
+
+/* The link bytes of the start-of-packet and end-of-packet control symbols. */
+#define PACKET_DELIMITER_SIZE 8u
+
+static uint8_t pdu[RIOSTREAM_PDU_SIZE_MAX];
+static uint8_t buffer[RIOSTREAM_PDU_SIZE_MAX];
+static uint32_t received;
+
+static uint8_t *benchAllocate(void *context, const RioStreamPdu_t *rxPdu, uint32_t *size)
+{
+  *size = sizeof(buffer);
+  return buffer;
+}
+
+static void benchComplete(void *context, const RioStreamPdu_t *rxPdu)
+{
+  if(rxPdu->status == RIOSTREAM_STATUS_OK)
+  {
+    received += rxPdu->length;
+  }
+}
+
+static void report(const char *name, uint32_t packets, uint32_t linkBytes, clock_t ticks)
+{
+  double seconds = (double) ticks / CLOCKS_PER_SEC;
+  double bytes = (double) RIOSTREAM_PDU_SIZE_MAX * ITERATIONS;
+
+  printf("%-10s %6lu packets/PDU %8lu link bytes/PDU %5.1f%% efficiency %8.1f MB/s\n",
+         name, (unsigned long) packets, (unsigned long) linkBytes,
+         100.0 * RIOSTREAM_PDU_SIZE_MAX / linkBytes,
+         (seconds > 0.0) ? (bytes / seconds / 1e6) : 0.0);
+}
+
+static void benchStreaming(void)
+{
+  RioStreamTx_t tx;
+  RioStreamRx_t rx;
+  RioStreamPdu_t pdus[1];
+  RioPacket_t packet;
+  uint32_t packets;
+  uint32_t linkBytes;
+  clock_t start;
+  int i;
+
+  RIOSTREAM_rxOpen(&rx, 1, pdus, benchAllocate, benchComplete, NULL);
+  received = 0;
+  packets = 0;
+  linkBytes = 0;
+
+  start = clock();
+  for(i = 0; i < ITERATIONS; i++)
+  {
+    RIOSTREAM_txOpen(&tx, 0x0002, 0x0001, 0x00, (uint16_t) i, MTU, sizeof(pdu), pdu);
+    while(RIOSTREAM_txGetSegment(&tx, &packet))
+    {
+      (void) RIOSTREAM_rxReceive(&rx, &packet);
+      if(i == 0)
+      {
+        packets++;
+        linkBytes += 4u*packet.size + PACKET_DELIMITER_SIZE;
+      }
+    }
+  }
+  report("STREAMING", packets, linkBytes, clock() - start);
+
+  if((received != sizeof(pdu) * ITERATIONS) || (memcmp(buffer, pdu, sizeof(pdu)) != 0))
+  {
+    printf("STREAMING transfer failed.\n");
+    exit(1);
+  }
+}
+
+static void benchNwrite(void)
+{
+  RioPacket_t packet;
+  uint8_t fragment[256];
+  uint16_t dstId;
+  uint16_t srcId;
+  uint32_t address;
+  uint16_t size;
+  uint32_t offset;
+  uint32_t length;
+  uint32_t packets;
+  uint32_t linkBytes;
+  clock_t start;
+  int i;
+
+  received = 0;
+  packets = 0;
+  linkBytes = 0;
+
+  start = clock();
+  for(i = 0; i < ITERATIONS; i++)
+  {
+    for(offset = 0; offset < sizeof(pdu); offset += length)
+    {
+      /* Transmitter, prefix each fragment with {streamId, offset, total length}. */
+      length = sizeof(pdu) - offset;
+      if(length > NWRITE_FRAGMENT_SIZE)
+      {
+        length = NWRITE_FRAGMENT_SIZE;
+      }
+      fragment[0] = (uint8_t) (i >> 8);
+      fragment[1] = (uint8_t) i;
+      fragment[2] = (uint8_t) (offset >> 16);
+      fragment[3] = (uint8_t) (offset >> 8);
+      fragment[4] = (uint8_t) offset;
+      fragment[5] = (uint8_t) (sizeof(pdu) >> 16);
+      fragment[6] = (uint8_t) (sizeof(pdu) >> 8);
+      fragment[7] = (uint8_t) sizeof(pdu);
+      memcpy(&fragment[NWRITE_HEADER_SIZE], &pdu[offset], length);
+      RIOPACKET_setNwrite(&packet, 0x0002, 0x0001, 0x00000000, 
+                          (uint16_t) ((NWRITE_HEADER_SIZE + length + 7u) & ~7u), fragment);
+      if(i == 0)
+      {
+        packets++;
+        linkBytes += 4u*packet.size + PACKET_DELIMITER_SIZE;
+      }
+
+      /* Receiver, decode the header and copy the fragment into place. */
+      RIOPACKET_getNwrite(&packet, &dstId, &srcId, &address, &size, fragment);
+      address = ((uint32_t) fragment[2] << 16) | ((uint32_t) fragment[3] << 8) | fragment[4];
+      memcpy(&buffer[address], &fragment[NWRITE_HEADER_SIZE], size - NWRITE_HEADER_SIZE);
+      received += size - NWRITE_HEADER_SIZE;
+    }
+  }
+  report("NWRITE", packets, linkBytes, clock() - start);
+
+  if((received != sizeof(pdu) * ITERATIONS) || (memcmp(buffer, pdu, sizeof(pdu)) != 0))
+  {
+    printf("NWRITE transfer failed.\n");
+    exit(1);
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  uint32_t i;
+
+  for(i = 0; i < sizeof(pdu); i++)
+  {
+    pdu[i] = (uint8_t) (i + (i >> 8));
+  }
+
+  printf("Transferring %d PDUs of %lu bytes, MTU %u.\n", 
+         ITERATIONS, (unsigned long) sizeof(pdu), MTU);
+  benchStreaming();
+  benchNwrite();
+
+  return 0;
+}
+
+/*************************** end of file **************************************/
@@ -0,0 +1,215 @@
+/******************************************************************************
+ * (C) Copyright 2013-2015 Magnus Rosenius and the Free Software Foundation.
+ *
+ * This file is part of OpenRIO.
+ *
+ * OpenRIO is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenRIO is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Lesser Public License
+ * along with OpenRIO.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+
+/******************************************************************************
+ * Description:
+ * This file contains a target side executor of RapidIO ATOMIC transactions.
+ * See rioatomic.h for more info.
+ *
+ * Any application specific tailoring needed to compile properly should be done
+ * in rioconfig.h.
+ ******************************************************************************/
+
+/*******************************************************************************
+ * Includes
+ *******************************************************************************/
+
+#include "rioatomic.h"
+
+/* Get definitions of ASSERT() and the atomic operations. */
+#include "rioconfig.h"
+
+
+/*******************************************************************************
+ * Local function prototypes
+ *******************************************************************************/
+
+/**
+ * \brief Apply an operation to a word in the window.
+ *
+ * \param[in] word The word to operate on.
+ * \param[in] ftype The ftype of the request.
+ * \param[in] transaction The transaction of the request.
+ * \param[in] data The data of the request.
+ * \param[in] compare The compare value of the request.
+ * \return The value of the word before the operation.
+ */
+static uint32_t operate(uint32_t *word, const uint8_t ftype, const uint8_t transaction,
+                        const uint32_t data, const uint32_t compare);
+
+
+/*******************************************************************************
+ * Global functions
+ *******************************************************************************/
+
+void RIOATOMIC_open(RioAtomic_t *atomic, const uint32_t base, const uint32_t size, uint32_t *memory)
+{
+  ASSERT(atomic != NULL, "Invalid atomic pointer");
+  ASSERT((memory != NULL) || (size == 0ul), "Invalid memory pointer");
+  ASSERT(((base & 0x3ul) == 0ul) && ((size & 0x3ul) == 0ul), "Unaligned window");
+
+  atomic->base = base;
+  atomic->size = size;
+  atomic->memory = memory;
+
+  atomic->statusExecuted = 0ul;
+  atomic->statusError = 0ul;
+}
+
+
+uint8_t RIOATOMIC_execute(RioAtomic_t *atomic, const RioPacket_t *request, RioPacket_t *response)
+{
+  uint8_t returnValue;
+  uint8_t ftype;
+  uint8_t transaction;
+  uint16_t dstId;
+  uint16_t srcId;
+  uint8_t tid;
+  uint32_t address;
+  uint32_t data;
+  uint32_t compare;
+  uint32_t old;
+  uint8_t payload[4];
+  uint16_t size;
+
+
+  ASSERT(atomic != NULL, "Invalid atomic pointer");
+  ASSERT(request != NULL, "Invalid request pointer");
+  ASSERT(response != NULL, "Invalid response pointer");
+
+  ftype = RIOPACKET_getFtype(request);
+  transaction = RIOPACKET_getTransaction(request);
+
+  /* Decode the request if it is an atomic operation. */
+  returnValue = 1u;
+  if(RIOPACKET_getTt(request) != (uint8_t) RIOPACKET_TT_16BITS)
+  {
+    /* Only packets with 16-bit deviceIds are decoded. */
+    returnValue = 0u;
+  }
+  else if((ftype == (uint8_t) RIOPACKET_FTYPE_REQUEST) &&
+          (transaction >= (uint8_t) RIOPACKET_TRANSACTION_REQUEST_ATOMIC_INC))
+  {
+    /* Atomic request without data. */
+    size = RIOPACKET_getAtomicRequest(request, &dstId, &srcId, &tid, &transaction, &address);
+    data = 0ul;
+    compare = 0ul;
+  }
+  else if((ftype == (uint8_t) RIOPACKET_FTYPE_WRITE) &&
+          (transaction >= (uint8_t) RIOPACKET_TRANSACTION_WRITE_ATOMIC_SWAP) &&
+          (transaction <= (uint8_t) RIOPACKET_TRANSACTION_WRITE_ATOMIC_TEST_AND_SWAP))
+  {
+    /* Atomic request with data. */
+    size = RIOPACKET_getAtomicWrite(request, &dstId, &srcId, &tid, &transaction, &address, &data, &compare);
+  }
+  else
+  {
+    /* Not an atomic operation. */
+    returnValue = 0u;
+  }
+
+  if(returnValue != 0u)
+  {
+    /* Check that the operand is a word inside the window. */
+    if((size == 4u) && 
+       (address >= atomic->base) && ((address - atomic->base) < atomic->size))
+    {
+      /* Valid operand. */
+      old = operate(&atomic->memory[(address - atomic->base) >> 2], ftype, transaction, data, compare);
+
+      payload[0] = (uint8_t) (old >> 24);
+      payload[1] = (uint8_t) (old >> 16);
+      payload[2] = (uint8_t) (old >> 8);
+      payload[3] = (uint8_t) old;
+      RIOPACKET_setResponseWithPayload(response, srcId, dstId, tid, (uint8_t) (address & 0x7ul), 
+                                       4u, payload);
+      atomic->statusExecuted++;
+    }
+    else
+    {
+      /* Invalid operand. */
+      RIOPACKET_setResponseNoPayload(response, srcId, dstId, tid, RIOPACKET_RESPONSE_STATUS_ERROR);
+      atomic->statusError++;
+    }
+  }
+  else
+  {
+    /* Don't do anything. */
+  }
+
+  return returnValue;
+}
+
+
+/*******************************************************************************
+ * Local functions
+ *******************************************************************************/
+
+static uint32_t operate(uint32_t *word, const uint8_t ftype, const uint8_t transaction,
+                        const uint32_t data, const uint32_t compare)
+{
+  uint32_t old;
+  uint32_t new;
+
+
+  /* Calculate the new value and try to write it until no other context has 
+     modified the word in between. */
+  old = RIO_ATOMIC_LOAD(word);
+  do
+  {
+    if(ftype == (uint8_t) RIOPACKET_FTYPE_REQUEST)
+    {
+      switch(transaction)
+      {
+        case RIOPACKET_TRANSACTION_REQUEST_ATOMIC_INC:
+          new = old + 1ul;
+          break;
+        case RIOPACKET_TRANSACTION_REQUEST_ATOMIC_DEC:
+          new = old - 1ul;
+          break;
+        case RIOPACKET_TRANSACTION_REQUEST_ATOMIC_SET:
+          new = 0xfffffffful;
+          break;
+        default:
+          new = 0ul;
+          break;
+      }
+    }
+    else
+    {
+      switch(transaction)
+      {
+        case RIOPACKET_TRANSACTION_WRITE_ATOMIC_SWAP:
+          new = data;
+          break;
+        case RIOPACKET_TRANSACTION_WRITE_ATOMIC_COMPARE_AND_SWAP:
+          new = (old == compare) ? data : old;
+          break;
+        default:
+          new = (old == 0ul) ? data : old;
+          break;
+      }
+    }
+  } while(!RIO_ATOMIC_CAS(word, &old, new));
+
+  return old;
+}
+
+/*************************** end of file **************************************/
@@ -0,0 +1,105 @@
+/******************************************************************************
+ * (C) Copyright 2013-2015 Magnus Rosenius and the Free Software Foundation.
+ *
+ * This file is part of OpenRIO.
+ *
+ * OpenRIO is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenRIO is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Lesser Public License
+ * along with OpenRIO.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+
+/******************************************************************************
+ * Description:
+ * This file contains a target side executor of RapidIO ATOMIC transactions.
+ *
+ * The executor applies received ATOMIC increment, decrement, set, clear, 
+ * swap, compare-and-swap and test-and-swap requests to a window of local 
+ * memory and builds the response to send back. The response contains the 
+ * value the word had before the operation. The operations are done using 
+ * compare-and-swap on the local memory so they are atomic also in relation 
+ * to local accesses made with the RIO_ATOMIC_XXXX macros.
+ *
+ * Only 32-bit operands are supported. Requests outside the window or with an 
+ * unsupported size are answered with an ERROR response.
+ *
+ * Typical usage:
+ *   RIOATOMIC_open(&atomic, 0x00100000, sizeof(memory), memory);
+ *   ...
+ *   RIOSTACK_getInboundPacket(&stack, &request);
+ *   if(RIOATOMIC_execute(&atomic, &request, &response))
+ *   {
+ *     RIOSTACK_setOutboundPacket(&stack, &response);
+ *   }
+ *
+ * Any application specific tailoring needed to compile properly should be done
+ * in rioconfig.h.
+ ******************************************************************************/
+
+#ifndef __RIOATOMIC_H
+#define __RIOATOMIC_H
+
+/*******************************************************************************
+ * Include files.
+ *******************************************************************************/
+
+#include "rioconfig.h"
+#include "riopacket.h"
+
+
+/*******************************************************************************
+ * Global typedefs.
+ *******************************************************************************/
+
+/** The structure to keep all the executor variables. */
+typedef struct
+{
+  uint32_t base; /**< The RapidIO byte address of the first word in the window. */
+  uint32_t size; /**< The size of the window in bytes. */
+  uint32_t *memory; /**< The local memory of the window. */
+
+  /** The number of operations that has been executed. */
+  uint32_t statusExecuted;
+
+  /** The number of requests that has been answered with an error. */
+  uint32_t statusError;
+} RioAtomic_t;
+
+
+/*******************************************************************************
+ * Global function prototypes.
+ *******************************************************************************/
+
+/**
+ * \brief Open an executor for operation.
+ *
+ * \param[in] atomic The executor to operate on.
+ * \param[in] base The RapidIO byte address of the window. Must be word aligned.
+ * \param[in] size The size of the window in bytes. Must be a multiple of four.
+ * \param[in] memory The local memory the window maps to.
+ */
+void RIOATOMIC_open(RioAtomic_t *atomic, const uint32_t base, const uint32_t size, uint32_t *memory);
+
+/**
+ * \brief Execute a received ATOMIC request.
+ *
+ * \param[in] atomic The executor to operate on.
+ * \param[in] request The received packet.
+ * \param[out] response The response to send.
+ * \return Non-zero if the packet was an ATOMIC request and a response was 
+ * created, zero if the packet should be handled elsewhere.
+ */
+uint8_t RIOATOMIC_execute(RioAtomic_t *atomic, const RioPacket_t *request, RioPacket_t *response);
+
+#endif /* __RIOATOMIC_H */
+
+/*************************** end of file **************************************/
@@ -0,0 +1,499 @@
+/******************************************************************************
+ * (C) Copyright 2013-2015 Magnus Rosenius and the Free Software Foundation.
+ *
+ * This file is part of OpenRIO.
+ *
+ * OpenRIO is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenRIO is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Lesser Public License
+ * along with OpenRIO.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+
+/******************************************************************************
+ * Description:
+ * This file contains a bonding layer for stacks connected to the same link
+ * partner. See riobond.h for more info.
+ *
+ * Any application specific tailoring needed to compile properly should be done
+ * in rioconfig.h.
+ ******************************************************************************/
+
+/*******************************************************************************
+ * Includes
+ *******************************************************************************/
+
+#include "riobond.h"
+
+/* Get definitions of ASSERT(), assumed to not return. */
+#include "rioconfig.h"
+
+
+/*******************************************************************************
+ * Local function prototypes
+ *******************************************************************************/
+
+/**
+ * \brief The inbound handler registered in the member stacks.
+ *
+ * \param[in] context The bond.
+ * \param[in] stack The stack the packet was received on.
+ * \param[in] packet The received packet.
+ * \return Non-zero if the handler that was registered before consumed the
+ * packet, zero if it is left in the inbound queue.
+ */
+static uint8_t inboundHandler(void *context, RioStack_t *stack, const RioPacket_t *packet);
+
+/**
+ * \brief Get the flow of a packet.
+ *
+ * \param[in] bond The bond to operate on.
+ * \param[in] packet The packet.
+ * \return The flow of the packet.
+ */
+static RioBondFlow_t *getFlow(RioBond_t *bond, const RioPacket_t *packet);
+
+/**
+ * \brief Check if a flow has packets that has not been acknowledged.
+ *
+ * \param[in] bond The bond to operate on.
+ * \param[in] flow The flow to check.
+ * \return Non-zero if the last packet of the flow is in the outbound queue
+ * of its member.
+ */
+static uint8_t isOutstanding(const RioBond_t *bond, const RioBondFlow_t *flow);
+
+/**
+ * \brief Move the packets of members whose links are down to the other members.
+ *
+ * \param[in] bond The bond to operate on.
+ * \return Non-zero if all packets have been moved, zero if a packet could not
+ * be placed and has to be moved again later.
+ */
+static uint8_t moveStranded(RioBond_t *bond);
+
+/**
+ * \brief Place a packet on a member.
+ *
+ * \param[in] bond The bond to operate on.
+ * \param[in] packet The packet to place.
+ * \return Non-zero if the packet was placed, zero if the member the flow must
+ * use is full or no link is initialized.
+ */
+static uint8_t placePacket(RioBond_t *bond, RioPacket_t *packet);
+
+
+/*******************************************************************************
+ * Global functions
+ *******************************************************************************/
+
+void RIOBOND_open(RioBond_t *bond)
+{
+  uint8_t i;
+  uint8_t ftype;
+
+
+  ASSERT(bond != NULL, "Invalid bond pointer");
+
+  bond->members = 0u;
+  bond->next = 0u;
+  bond->tidMask = 0u;
+  for(i = 0u; i < RIOBOND_MEMBERS_MAX; i++)
+  {
+    bond->member[i] = NULL;
+    bond->enqueued[i] = 0ul;
+    bond->statusPacketsSent[i] = 0ul;
+    for(ftype = 0u; ftype < 16u; ftype++)
+    {
+      bond->nextHandler[i][ftype] = NULL;
+      bond->nextContext[i][ftype] = NULL;
+    }
+  }
+  for(i = 0u; i < RIOBOND_FLOWS; i++)
+  {
+    bond->flow[i].member = 0u;
+    bond->flow[i].sequence = 0ul;
+  }
+  bond->strandedPending = 0u;
+  bond->orderHead = 0u;
+  bond->orderTail = 0u;
+
+  bond->statusFlowsMoved = 0ul;
+}
+
+
+uint8_t RIOBOND_addMember(RioBond_t *bond, RioStack_t *stack)
+{
+  uint8_t returnValue;
+  uint8_t ftype;
+
+
+  ASSERT(stack != NULL, "Invalid stack pointer");
+
+  if(bond->members < RIOBOND_MEMBERS_MAX)
+  {
+    bond->member[bond->members] = stack;
+    bond->enqueued[bond->members] = (uint32_t) RIOSTACK_getOutboundQueueLength(stack);
+    for(ftype = 0u; ftype < 16u; ftype++)
+    {
+      /* Keep the handlers that were registered before to let them consume 
+         packets before the bond records them. A handler of a bond the stack 
+         was a member of before is not kept. */
+      if(stack->rxHandler[ftype] != inboundHandler)
+      {
+        bond->nextHandler[bond->members][ftype] = stack->rxHandler[ftype];
+        bond->nextContext[bond->members][ftype] = stack->rxHandlerContext[ftype];
+      }
+      else
+      {
+        bond->nextHandler[bond->members][ftype] = NULL;
+        bond->nextContext[bond->members][ftype] = NULL;
+      }
+      RIOSTACK_setInboundHandler(stack, ftype, inboundHandler, bond);
+    }
+    bond->members++;
+    returnValue = 1u;
+  }
+  else
+  {
+    returnValue = 0u;
+  }
+
+  return returnValue;
+}
+
+
+void RIOBOND_setFlowTidMask(RioBond_t *bond, const uint8_t mask)
+{
+  bond->tidMask = mask;
+}
+
+
+uint8_t RIOBOND_getLinksInitialized(const RioBond_t *bond)
+{
+  uint8_t count;
+  uint8_t i;
+
+
+  count = 0u;
+  for(i = 0u; i < bond->members; i++)
+  {
+    if(RIOSTACK_getLinkIsInitialized(bond->member[i]))
+    {
+      count++;
+    }
+    else
+    {
+      /* Don't do anything. */
+    }
+  }
+
+  return count;
+}
+
+
+uint8_t RIOBOND_setOutboundPacket(RioBond_t *bond, RioPacket_t *packet)
+{
+  uint8_t returnValue;
+
+
+  ASSERT(bond != NULL, "Invalid bond pointer");
+
+  /* The packets left on a member whose link is down are placed before the new 
+     packet to keep the flows in order. */
+  if(moveStranded(bond))
+  {
+    returnValue = placePacket(bond, packet);
+  }
+  else
+  {
+    returnValue = 0u;
+  }
+
+  return returnValue;
+}
+
+
+uint16_t RIOBOND_getInboundQueueLength(const RioBond_t *bond)
+{
+  return (uint16_t) ((bond->orderHead + RIOBOND_ORDER_SIZE - bond->orderTail) % RIOBOND_ORDER_SIZE);
+}
+
+
+void RIOBOND_getInboundPacket(RioBond_t *bond, RioPacket_t *packet)
+{
+  uint8_t member;
+
+
+  ASSERT(bond != NULL, "Invalid bond pointer");
+
+  if(bond->orderHead != bond->orderTail)
+  {
+    member = bond->order[bond->orderTail];
+    bond->orderTail = (uint16_t) ((bond->orderTail + 1u) % RIOBOND_ORDER_SIZE);
+    RIOSTACK_getInboundPacket(bond->member[member], packet);
+  }
+  else
+  {
+    ASSERT0("Reading from empty inbound queue.");
+  }
+}
+
+
+/*******************************************************************************
+ * Local functions
+ *******************************************************************************/
+
+static uint8_t inboundHandler(void *context, RioStack_t *stack, const RioPacket_t *packet)
+{
+  RioBond_t *bond;
+  uint8_t returnValue;
+  uint8_t ftype;
+  uint8_t i;
+
+
+  bond = (RioBond_t *) context;
+  ftype = RIOPACKET_getFtype(packet);
+  returnValue = 0u;
+  for(i = 0u; i < bond->members; i++)
+  {
+    if(bond->member[i] == stack)
+    {
+      /* Let the handler that was registered before consume the packet. */
+      if(bond->nextHandler[i][ftype] != NULL)
+      {
+        returnValue = bond->nextHandler[i][ftype](bond->nextContext[i][ftype], stack, packet);
+      }
+      else
+      {
+        /* Don't do anything. */
+      }
+
+      if(!returnValue)
+      {
+        bond->order[bond->orderHead] = i;
+        bond->orderHead = (uint16_t) ((bond->orderHead + 1u) % RIOBOND_ORDER_SIZE);
+      }
+      else
+      {
+        /* Don't do anything. */
+      }
+    }
+    else
+    {
+      /* Don't do anything. */
+    }
+  }
+
+  return returnValue;
+}
+
+
+static RioBondFlow_t *getFlow(RioBond_t *bond, const RioPacket_t *packet)
+{
+  uint32_t hash;
+  uint8_t ftype;
+
+
+  hash = RIOPACKET_getDestinationExt(packet);
+  hash = (hash * 31ul) + RIOPACKET_getPriority(packet);
+
+  /* Only use the transaction identifier of packets that has one. */
+  ftype = RIOPACKET_getFtype(packet);
+  if((ftype == RIOPACKET_FTYPE_REQUEST) || (ftype == RIOPACKET_FTYPE_WRITE) ||
+     (ftype == RIOPACKET_FTYPE_MAINTENANCE) || (ftype == RIOPACKET_FTYPE_DOORBELL) ||
+     (ftype == RIOPACKET_FTYPE_RESPONSE))
+  {
+    hash = (hash * 31ul) + (RIOPACKET_getTid(packet) & bond->tidMask);
+  }
+  else
+  {
+    /* Don't do anything. */
+  }
+
+  /* Use the upper bits of a multiplicative hash to select the entry. */
+  hash = (uint32_t) (hash * 0x9e3779b1ul);
+
+  return &bond->flow[hash >> (32u - RIOBOND_FLOWS_BITS)];
+}
+
+
+static uint8_t isOutstanding(const RioBond_t *bond, const RioBondFlow_t *flow)
+{
+  uint32_t completed;
+  uint8_t returnValue;
+
+
+  if(flow->member < bond->members)
+  {
+    /* Packets leave the outbound queue of the member when they are acknowledged. */
+    completed = bond->enqueued[flow->member] - RIOSTACK_getOutboundQueueLength(bond->member[flow->member]);
+    returnValue = (uint8_t) ((int32_t) (flow->sequence - completed) > 0l);
+  }
+  else
+  {
+    returnValue = 0u;
+  }
+
+  return returnValue;
+}
+
+
+static uint8_t moveStranded(RioBond_t *bond)
+{
+  RioStack_t *stack;
+  uint8_t returnValue;
+  uint8_t i;
+
+
+  /* Place the packet that did not fit the last time first. */
+  returnValue = 1u;
+  if(bond->strandedPending != 0u)
+  {
+    if(placePacket(bond, &bond->stranded))
+    {
+      bond->strandedPending = 0u;
+    }
+    else
+    {
+      returnValue = 0u;
+    }
+  }
+  else
+  {
+    /* Don't do anything. */
+  }
+
+  /* The packets are taken in the order they were placed on the member. The 
+     flows that still have packets on the member are moved when their next 
+     packet is placed. */
+  for(i = 0u; (i < bond->members) && (returnValue != 0u); i++)
+  {
+    stack = bond->member[i];
+    while((returnValue != 0u) &&
+          (!RIOSTACK_getLinkIsInitialized(stack)) &&
+          (RIOSTACK_getOutboundQueueLength(stack) > 0u))
+    {
+      (void) RIOSTACK_getOutboundPacket(stack, &bond->stranded);
+      if(getFlow(bond, &bond->stranded)->member == i)
+      {
+        bond->statusFlowsMoved++;
+      }
+      else
+      {
+        /* The flow has already been moved. */
+      }
+      if(!placePacket(bond, &bond->stranded))
+      {
+        bond->strandedPending = 1u;
+        returnValue = 0u;
+      }
+      else
+      {
+        /* Don't do anything. */
+      }
+    }
+  }
+
+  return returnValue;
+}
+
+
+static uint8_t placePacket(RioBond_t *bond, RioPacket_t *packet)
+{
+  RioBondFlow_t *flow;
+  RioStack_t *stack;
+  uint8_t returnValue;
+  uint8_t selected;
+  uint8_t shortest;
+  uint8_t length;
+  uint8_t i;
+  uint8_t j;
+
+
+  flow = getFlow(bond, packet);
+  selected = RIOBOND_MEMBERS_MAX;
+  if(isOutstanding(bond, flow))
+  {
+    /* The flow has packets that have not been acknowledged. */
+    if(RIOSTACK_getLinkIsInitialized(bond->member[flow->member]))
+    {
+      /* Keep the flow on its member to keep it in order. */
+      if(RIOSTACK_getOutboundQueueAvailable(bond->member[flow->member]) > 0u)
+      {
+        selected = flow->member;
+      }
+      else
+      {
+        /* The member is full, try again later. */
+      }
+    }
+    else
+    {
+      /* The link of the member is down, the flow has to move. */
+      flow->sequence = 0ul;
+      flow->member = RIOBOND_MEMBERS_MAX;
+    }
+  }
+  else
+  {
+    flow->member = RIOBOND_MEMBERS_MAX;
+  }
+
+  /* Find the member with the shortest outbound queue if the flow is free to
+     use any member. Start at a new member each time to spread the flows when
+     the queues are equally long. */
+  if(flow->member == RIOBOND_MEMBERS_MAX)
+  {
+    shortest = 0xffu;
+    for(i = 0u; i < bond->members; i++)
+    {
+      j = (uint8_t) ((bond->next + i) % bond->members);
+      stack = bond->member[j];
+      length = RIOSTACK_getOutboundQueueLength(stack);
+      if(RIOSTACK_getLinkIsInitialized(stack) &&
+         (RIOSTACK_getOutboundQueueAvailable(stack) > 0u) &&
+         (length < shortest))
+      {
+        selected = j;
+        shortest = length;
+      }
+      else
+      {
+        /* Don't do anything. */
+      }
+    }
+  }
+  else
+  {
+    /* Don't do anything. */
+  }
+
+  if(selected < RIOBOND_MEMBERS_MAX)
+  {
+    RIOSTACK_setOutboundPacket(bond->member[selected], packet);
+    bond->enqueued[selected]++;
+    bond->statusPacketsSent[selected]++;
+    flow->member = selected;
+    flow->sequence = bond->enqueued[selected];
+    bond->next = (uint8_t) ((selected + 1u) % bond->members);
+    returnValue = 1u;
+  }
+  else
+  {
+    returnValue = 0u;
+  }
+
+  return returnValue;
+}
+
+
+/*************************** end of file **************************************/
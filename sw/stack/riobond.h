@@ -0,0 +1,222 @@
+/******************************************************************************
+ * (C) Copyright 2013-2015 Magnus Rosenius and the Free Software Foundation.
+ *
+ * This file is part of OpenRIO.
+ *
+ * OpenRIO is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenRIO is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Lesser Public License
+ * along with OpenRIO.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+
+/******************************************************************************
+ * Description:
+ * This file contains a bonding layer that uses several stacks connected to the
+ * same link partner as one logical port.
+ *
+ * Transmitter side: Each outbound packet is placed in the outbound queue of
+ * one of the member stacks whose link is initialized. A flow is identified by
+ * the destination and the priority of its packets, and optionally by a part
+ * of the transaction identifier. A flow that has packets that are not yet
+ * acknowledged on a member keeps using that member, so that the packets of
+ * the flow arrive in order. A flow without outstanding packets is placed on
+ * the member with the fewest packets in its outbound queue. If the link of
+ * a member goes down, its flows are moved to the other members. The packets
+ * that were left in the outbound queue of the member are moved first and are
+ * sent again, ahead of the new packets of their flows.
+ *
+ * Receiver side: The bond registers inbound handlers in the member stacks
+ * that record which member each packet was received on. The packets are left
+ * in the inbound queues of the members and are read from the bond in the
+ * order they were received. Since a flow only moves to another member when
+ * all its previous packets have been received, the flows are read in order.
+ *
+ * Aggregate throughput is close to the sum of the members when there are at
+ * least as many active flows as members. A single flow does not use more
+ * than one member at a time.
+ *
+ * \note All packets on the members must be sent and received through the
+ * bond. Inbound handlers that were registered in a member before it was added
+ * are called first, and packets they consume are not seen by the bond.
+ *
+ * Typical usage:
+ *   RIOBOND_open(&bond);
+ *   RIOBOND_addMember(&bond, &stack0);
+ *   RIOBOND_addMember(&bond, &stack1);
+ *   ...
+ *   if(!RIOBOND_setOutboundPacket(&bond, &packet))
+ *   {
+ *     <the member of the flow is full, try again later>
+ *   }
+ *   ...
+ *   if(RIOBOND_getInboundQueueLength(&bond) > 0)
+ *   {
+ *     RIOBOND_getInboundPacket(&bond, &packet);
+ *   }
+ *
+ * Any application specific tailoring needed to compile properly should be done
+ * in rioconfig.h.
+ ******************************************************************************/
+
+#ifndef __RIOBOND_H
+#define __RIOBOND_H
+
+/*******************************************************************************
+ * Include files.
+ *******************************************************************************/
+
+#include "rioconfig.h"
+#include "riopacket.h"
+#include "riostack.h"
+
+
+/*******************************************************************************
+ * Global macros.
+ *******************************************************************************/
+
+/** The largest number of member stacks in a bond. */
+#define RIOBOND_MEMBERS_MAX 4u
+
+/** The number of flows that are tracked is two to the power of this. Flows that are hashed to the same entry are kept in order together. */
+#define RIOBOND_FLOWS_BITS 6u
+#define RIOBOND_FLOWS (1u << RIOBOND_FLOWS_BITS)
+
+/** The number of received packets whose order is recorded, 255 for each member. */
+#define RIOBOND_ORDER_SIZE (RIOBOND_MEMBERS_MAX * 256u)
+
+
+/*******************************************************************************
+ * Global typedefs.
+ *******************************************************************************/
+
+/** A flow that has been placed on a member. */
+/** \internal Note that this type is for internal usage only. */
+typedef struct
+{
+  uint8_t member; /**< The member the last packet of the flow was placed on. */
+  uint32_t sequence; /**< The number of packets placed on the member including the last packet of the flow. */
+} RioBondFlow_t;
+
+/** The structure to keep all the bonding variables. */
+typedef struct
+{
+  RioStack_t *member[RIOBOND_MEMBERS_MAX]; /**< The member stacks. */
+  uint32_t enqueued[RIOBOND_MEMBERS_MAX]; /**< The number of packets placed on each member. */
+  uint8_t members; /**< The number of members. */
+  uint8_t next; /**< The member to start the search for the shortest queue at. */
+  uint8_t tidMask; /**< The part of the transaction identifier that is part of the flow. */
+
+  RioStackInboundHandler_t nextHandler[RIOBOND_MEMBERS_MAX][16]; /**< The inbound handlers of the members that were registered before. */
+  void *nextContext[RIOBOND_MEMBERS_MAX][16]; /**< The contexts of the next handlers. */
+
+  RioBondFlow_t flow[RIOBOND_FLOWS]; /**< The flows. */
+
+  RioPacket_t stranded; /**< A packet taken from a member whose link is down that has not been placed yet. */
+  uint8_t strandedPending; /**< Non-zero if the stranded packet has not been placed yet. */
+
+  uint8_t order[RIOBOND_ORDER_SIZE]; /**< The members that received packets, in the order of reception. */
+  uint16_t orderHead; /**< The position to record the next received packet at. */
+  uint16_t orderTail; /**< The position of the next packet to read. */
+
+  /** The number of packets that has been sent on each member. */
+  uint32_t statusPacketsSent[RIOBOND_MEMBERS_MAX];
+
+  /** The number of flows that has been moved from a member whose link went down. */
+  uint32_t statusFlowsMoved;
+} RioBond_t;
+
+
+/*******************************************************************************
+ * Global function prototypes.
+ *******************************************************************************/
+
+/**
+ * \brief Open a bond.
+ *
+ * \param[in] bond The bond to operate on.
+ */
+void RIOBOND_open(RioBond_t *bond);
+
+/**
+ * \brief Add a member stack to a bond.
+ *
+ * \param[in] bond The bond to operate on.
+ * \param[in] stack The stack to add. It must be opened and should have an
+ * empty outbound queue.
+ * \return Non-zero if the member was added, zero if the bond is full.
+ *
+ * The inbound handlers of all ftypes are registered in the stack. A handler
+ * that was registered in the stack before is kept and is called before the
+ * bond records the packet. If it consumes the packet, the bond never sees it.
+ */
+uint8_t RIOBOND_addMember(RioBond_t *bond, RioStack_t *stack);
+
+/**
+ * \brief Set the part of the transaction identifier that identifies a flow.
+ *
+ * \param[in] bond The bond to operate on.
+ * \param[in] mask The bits of the transaction identifier that are part of
+ * the flow. Zero, the default, means that all packets with the same
+ * destination and priority are kept in order.
+ *
+ * Packets with different values of the masked bits may be reordered, which
+ * lets a single destination use several members. For example, with the mask
+ * 0xc0 an application can use four ranges of transaction identifiers for
+ * independent streams.
+ */
+void RIOBOND_setFlowTidMask(RioBond_t *bond, const uint8_t mask);
+
+/**
+ * \brief Get the number of members with an initialized link.
+ *
+ * \param[in] bond The bond to operate on.
+ * \return The number of members that can send packets.
+ */
+uint8_t RIOBOND_getLinksInitialized(const RioBond_t *bond);
+
+/**
+ * \brief Send a packet.
+ *
+ * \param[in] bond The bond to operate on.
+ * \param[in] packet The packet to send.
+ * \return Non-zero if the packet was placed in the outbound queue of a member,
+ * zero if the member the flow must use is full or no link is initialized.
+ *
+ * Packets left in the outbound queue of a member whose link has gone down are
+ * moved to the other members before the new packet is placed. No new packets
+ * are accepted until all of them have been moved. Packets that were
+ * transmitted but not acknowledged are sent again and may be received twice.
+ */
+uint8_t RIOBOND_setOutboundPacket(RioBond_t *bond, RioPacket_t *packet);
+
+/**
+ * \brief Get the number of received packets.
+ *
+ * \param[in] bond The bond to operate on.
+ * \return The number of packets in the inbound queues of all members.
+ */
+uint16_t RIOBOND_getInboundQueueLength(const RioBond_t *bond);
+
+/**
+ * \brief Get the next received packet.
+ *
+ * \param[in] bond The bond to operate on.
+ * \param[out] packet The received packet.
+ *
+ * \note Call RIOBOND_getInboundQueueLength() first to make sure there is a
+ * packet to read.
+ */
+void RIOBOND_getInboundPacket(RioBond_t *bond, RioPacket_t *packet);
+
+#endif
+
+/*************************** end of file **************************************/
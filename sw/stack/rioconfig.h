@@ -31,6 +31,15 @@
 #define ASSERT(c, s) { if( !(c) ) { ASSERT0( s ); } }
 #endif
 
+/* Atomic operations on 32-bit words used by the lock-free parts, see riopool.c.
+   The defaults use the gcc builtins. On a single-core target without preemption
+   between the users of a pool these can be replaced by plain operations. */
+#define RIO_ATOMIC_LOAD(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define RIO_ATOMIC_CAS(p, expected, desired) \
+  __atomic_compare_exchange_n((p), (expected), (desired), 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+#define RIO_ATOMIC_ADD(p, v) __atomic_add_fetch((p), (v), __ATOMIC_ACQ_REL)
+#define RIO_ATOMIC_SUB(p, v) __atomic_sub_fetch((p), (v), __ATOMIC_ACQ_REL)
+
 /*******************************************************************************
  * Global declarations
  *******************************************************************************/
@@ -0,0 +1,664 @@
+/******************************************************************************
+ * (C) Copyright 2013-2015 Magnus Rosenius and the Free Software Foundation.
+ *
+ * This file is part of OpenRIO.
+ *
+ * OpenRIO is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenRIO is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Lesser Public License
+ * along with OpenRIO.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+/******************************************************************************
+ * Description:
+ * This file contains a configuration space provider for the LP-Serial and
+ * error management registers of a stack.
+ * See riocsr.h for more info.
+ *
+ * Any application specific tailoring needed to compile properly should be done
+ * in rioconfig.h.
+ ******************************************************************************/
+
+/*******************************************************************************
+ * Includes
+ *******************************************************************************/
+
+#include "riocsr.h"
+
+/* Get definitions of ASSERT(), assumed to not return. */
+#include "rioconfig.h"
+
+
+/*******************************************************************************
+ * Local macros
+ *******************************************************************************/
+
+/* Register offsets in the blocks, the blocks only describe port 0. */
+#define LP_SERIAL_HEADER RIOPACKET_LP_SERIAL_REGISTER_BLOCK_HEADER(0ul)
+#define LP_SERIAL_LINK_TIMEOUT RIOPACKET_PORT_LINK_TIMEOUT_CONTROL_CSR(0ul)
+#define LP_SERIAL_GENERAL_CONTROL RIOPACKET_PORT_GENERAL_CONTROL_CSR(0ul)
+#define LP_SERIAL_LOCAL_ACKID RIOPACKET_PORT_N_LOCAL_ACKID_CSR(0ul, 0ul)
+#define LP_SERIAL_ERROR_STATUS RIOPACKET_PORT_N_ERROR_AND_STATUS_CSR(0ul, 0ul)
+#define LP_SERIAL_CONTROL RIOPACKET_PORT_N_CONTROL_CSR(0ul, 0ul)
+#define ERROR_MANAGEMENT_HEADER RIOPACKET_ERROR_MANAGEMENT_EXTENSIONS_BLOCK_HEADER(0ul)
+#define ERROR_MANAGEMENT_PORT_WRITE_TARGET RIOPACKET_PORT_WRITE_TARGET_DEVICE_ID_CSR(0ul)
+#define ERROR_MANAGEMENT_ERROR_DETECT RIOPACKET_PORT_N_ERROR_DETECT_CSR(0ul, 0ul)
+#define ERROR_MANAGEMENT_ERROR_RATE_ENABLE RIOPACKET_PORT_N_ERROR_RATE_ENABLE_CSR(0ul, 0ul)
+
+/* The Port 0 Control CSR of a serial single lane port with input and output 
+   enabled. */
+#define PORT_CONTROL 0x00600001ul
+
+/* The Port N Error and Status CSR bits that are cleared by writing ones. */
+#define ENCOUNTERED_BITS (RIOCSR_INPUT_ERROR_ENCOUNTERED | \
+                          RIOCSR_OUTPUT_ERROR_ENCOUNTERED | \
+                          RIOCSR_OUTPUT_RETRY_ENCOUNTERED)
+
+
+/*******************************************************************************
+ * Local function prototypes
+ *******************************************************************************/
+
+/**
+ * \brief The inbound handler registered in the stack.
+ *
+ * \param[in] context The configuration space provider.
+ * \param[in] stack The stack that received the packet.
+ * \param[in] packet The received MAINTENANCE packet.
+ * \return Non-zero if the packet was handled.
+ */
+static uint8_t inboundHandler(void *context, RioStack_t *stack, const RioPacket_t *packet);
+
+/**
+ * \brief Read a register in the LP-Serial block.
+ *
+ * \param[in] csr The provider to operate on.
+ * \param[in] offset The byte offset of the register in the block.
+ * \return The value of the register.
+ */
+static uint32_t readLpSerial(RioCsr_t *csr, const uint32_t offset);
+
+/**
+ * \brief Write a register in the LP-Serial block.
+ *
+ * \param[in] csr The provider to operate on.
+ * \param[in] offset The byte offset of the register in the block.
+ * \param[in] data The value to write.
+ */
+static void writeLpSerial(RioCsr_t *csr, const uint32_t offset, const uint32_t data);
+
+/**
+ * \brief Read a register in the error management block.
+ *
+ * \param[in] csr The provider to operate on.
+ * \param[in] offset The byte offset of the register in the block.
+ * \return The value of the register.
+ */
+static uint32_t readErrorManagement(RioCsr_t *csr, const uint32_t offset);
+
+/**
+ * \brief Write a register in the error management block.
+ *
+ * \param[in] csr The provider to operate on.
+ * \param[in] offset The byte offset of the register in the block.
+ * \param[in] data The value to write.
+ */
+static void writeErrorManagement(RioCsr_t *csr, const uint32_t offset, const uint32_t data);
+
+/**
+ * \brief Get the number of inbound errors of a stack.
+ *
+ * \param[in] stack The stack to operate on.
+ * \return The sum of the inbound error counters.
+ */
+static uint32_t getInputErrors(const RioStack_t *stack);
+
+/**
+ * \brief Get the number of outbound errors of a stack.
+ *
+ * \param[in] stack The stack to operate on.
+ * \return The sum of the outbound and link-partner error counters.
+ */
+static uint32_t getOutputErrors(const RioStack_t *stack);
+
+/**
+ * \brief Get the error counter of an error detect bit.
+ *
+ * \param[in] stack The stack to operate on.
+ * \param[in] index The index of the error detect bit in errorDetectBits.
+ * \return The number of errors counted for the bit.
+ */
+static uint32_t getErrorCount(const RioStack_t *stack, const uint8_t index);
+
+
+/*******************************************************************************
+ * Local variables
+ *******************************************************************************/
+
+/* The Port N Error Detect CSR bits in the order of getErrorCount(). */
+static const uint32_t errorDetectBits[RIOCSR_ERRORS] =
+{
+  RIOCSR_DETECT_LINK_TIMEOUT,
+  RIOCSR_DETECT_ILLEGAL_CHARACTER,
+  RIOCSR_DETECT_PACKET_SIZE,
+  RIOCSR_DETECT_PACKET_CRC,
+  RIOCSR_DETECT_PACKET_ACKID,
+  RIOCSR_DETECT_PACKET_NOT_ACCEPTED,
+  RIOCSR_DETECT_ACKNOWLEDGE_ACKID,
+  RIOCSR_DETECT_CONTROL_CRC
+};
+
+
+/*******************************************************************************
+ * Global functions
+ *******************************************************************************/
+
+void RIOCSR_open(RioCsr_t *csr, RioStack_t *stack,
+                 const uint32_t lpSerialOffset, const uint32_t errorManagementOffset)
+{
+  uint8_t i;
+
+
+  ASSERT(csr != NULL, "Invalid csr pointer");
+  ASSERT(stack != NULL, "Invalid stack pointer");
+  ASSERT(((lpSerialOffset & 3ul) == 0ul) && (lpSerialOffset < 0x10000ul), 
+         "Invalid LP-Serial offset");
+  ASSERT(((errorManagementOffset & 3ul) == 0ul) && (errorManagementOffset < 0x10000ul), 
+         "Invalid error management offset");
+  ASSERT(((lpSerialOffset + RIOCSR_LP_SERIAL_SIZE) <= errorManagementOffset) ||
+         ((errorManagementOffset + RIOCSR_ERROR_MANAGEMENT_SIZE) <= lpSerialOffset),
+         "Overlapping blocks");
+
+  csr->stack = stack;
+  csr->lpSerialOffset = lpSerialOffset;
+  csr->errorManagementOffset = errorManagementOffset;
+
+  csr->portGeneralControl = 0ul;
+  csr->portWriteTarget = 0ul;
+  csr->errorRateEnable = 0ul;
+
+  csr->inputErrors = getInputErrors(stack);
+  csr->outputErrors = getOutputErrors(stack);
+  csr->outputRetries = stack->statusOutboundPacketRetry;
+  for(i = 0u; i < RIOCSR_ERRORS; i++)
+  {
+    csr->errors[i] = getErrorCount(stack, i);
+  }
+
+  csr->nextHandler = NULL;
+  csr->nextContext = NULL;
+
+  csr->statusReads = 0ul;
+  csr->statusWrites = 0ul;
+  csr->statusDropped = 0ul;
+}
+
+
+void RIOCSR_attach(RioCsr_t *csr, RioStack_t *stack)
+{
+  ASSERT(csr != NULL, "Invalid csr pointer");
+  ASSERT(stack != NULL, "Invalid stack pointer");
+
+  /* Keep the handler that was registered before to forward other maintenance 
+     packets to it. */
+  csr->nextHandler = stack->rxHandler[RIOPACKET_FTYPE_MAINTENANCE];
+  csr->nextContext = stack->rxHandlerContext[RIOPACKET_FTYPE_MAINTENANCE];
+  RIOSTACK_setInboundHandler(stack, RIOPACKET_FTYPE_MAINTENANCE, inboundHandler, csr);
+}
+
+
+uint8_t RIOCSR_read(RioCsr_t *csr, const uint32_t offset, uint32_t *data)
+{
+  uint8_t returnValue;
+
+
+  ASSERT(csr != NULL, "Invalid csr pointer");
+
+  if((offset - csr->lpSerialOffset) < RIOCSR_LP_SERIAL_SIZE)
+  {
+    *data = readLpSerial(csr, (offset - csr->lpSerialOffset) & ~3ul);
+    returnValue = 1u;
+  }
+  else if((offset - csr->errorManagementOffset) < RIOCSR_ERROR_MANAGEMENT_SIZE)
+  {
+    *data = readErrorManagement(csr, (offset - csr->errorManagementOffset) & ~3ul);
+    returnValue = 1u;
+  }
+  else
+  {
+    /* Not in any of the blocks. */
+    returnValue = 0u;
+  }
+
+  return returnValue;
+}
+
+
+uint8_t RIOCSR_write(RioCsr_t *csr, const uint32_t offset, const uint32_t data)
+{
+  uint8_t returnValue;
+
+
+  ASSERT(csr != NULL, "Invalid csr pointer");
+
+  if((offset - csr->lpSerialOffset) < RIOCSR_LP_SERIAL_SIZE)
+  {
+    writeLpSerial(csr, (offset - csr->lpSerialOffset) & ~3ul, data);
+    returnValue = 1u;
+  }
+  else if((offset - csr->errorManagementOffset) < RIOCSR_ERROR_MANAGEMENT_SIZE)
+  {
+    writeErrorManagement(csr, (offset - csr->errorManagementOffset) & ~3ul, data);
+    returnValue = 1u;
+  }
+  else
+  {
+    /* Not in any of the blocks. */
+    returnValue = 0u;
+  }
+
+  return returnValue;
+}
+
+
+uint8_t RIOCSR_receive(RioCsr_t *csr, RioStack_t *stack, const RioPacket_t *packet)
+{
+  uint8_t returnValue;
+  RioPacket_t response;
+  uint16_t dstId;
+  uint16_t srcId;
+  uint8_t hop;
+  uint8_t tid;
+  uint32_t offset;
+  uint32_t data;
+
+
+  ASSERT(csr != NULL, "Invalid csr pointer");
+
+  returnValue = 0u;
+  if((RIOPACKET_getFtype(packet) == RIOPACKET_FTYPE_MAINTENANCE) &&
+     (RIOPACKET_getTt(packet) == (uint8_t) RIOPACKET_TT_16BITS))
+  {
+    switch(RIOPACKET_getTransaction(packet))
+    {
+      case RIOPACKET_TRANSACTION_MAINT_READ_REQUEST:
+        RIOPACKET_getMaintReadRequest(packet, &dstId, &srcId, &hop, &tid, &offset);
+        if(RIOCSR_read(csr, offset, &data))
+        {
+          RIOPACKET_setMaintReadResponse(&response, srcId, dstId, tid, 0u, data);
+          csr->statusReads++;
+          returnValue = 1u;
+        }
+        else
+        {
+          /* Not in any of the blocks. */
+        }
+        break;
+      case RIOPACKET_TRANSACTION_MAINT_WRITE_REQUEST:
+        RIOPACKET_getMaintWriteRequest(packet, &dstId, &srcId, &hop, &tid, &offset, &data);
+        if(RIOCSR_write(csr, offset, data))
+        {
+          RIOPACKET_setMaintWriteResponse(&response, srcId, dstId, tid, 0u);
+          csr->statusWrites++;
+          returnValue = 1u;
+        }
+        else
+        {
+          /* Not in any of the blocks. */
+        }
+        break;
+      default:
+        /* Not a request. */
+        break;
+    }
+  }
+  else
+  {
+    /* Not a maintenance packet. */
+  }
+
+  if(returnValue)
+  {
+    if(RIOSTACK_getOutboundQueueAvailable(stack) > 0u)
+    {
+      RIOSTACK_setOutboundPacket(stack, &response);
+    }
+    else
+    {
+      /* The outbound queue is full, the requester has to retry. */
+      csr->statusDropped++;
+    }
+  }
+  else
+  {
+    /* Don't do anything. */
+  }
+
+  return returnValue;
+}
+
+
+/*******************************************************************************
+ * Local functions
+ *******************************************************************************/
+
+static uint8_t inboundHandler(void *context, RioStack_t *stack, const RioPacket_t *packet)
+{
+  RioCsr_t *csr;
+  uint8_t returnValue;
+
+
+  csr = (RioCsr_t *) context;
+  returnValue = RIOCSR_receive(csr, stack, packet);
+  if((!returnValue) && (csr->nextHandler != NULL))
+  {
+    returnValue = csr->nextHandler(csr->nextContext, stack, packet);
+  }
+  else
+  {
+    /* Don't do anything. */
+  }
+
+  return returnValue;
+}
+
+
+static uint32_t readLpSerial(RioCsr_t *csr, const uint32_t offset)
+{
+  RioStack_t *stack;
+  uint32_t data;
+
+
+  stack = csr->stack;
+  switch(offset)
+  {
+    case LP_SERIAL_HEADER:
+      data = (csr->errorManagementOffset << 16) | RIOCSR_LP_SERIAL_EF_ID;
+      break;
+    case LP_SERIAL_LINK_TIMEOUT:
+      data = (stack->portTimeout & 0x00fffffful) << 8;
+      break;
+    case LP_SERIAL_GENERAL_CONTROL:
+      data = csr->portGeneralControl;
+      break;
+    case LP_SERIAL_LOCAL_ACKID:
+      data = ((uint32_t) stack->rxAckId << 24) | 
+        ((uint32_t) stack->txAckId << 8) | 
+        (uint32_t) stack->txAckIdWindow;
+      break;
+    case LP_SERIAL_ERROR_STATUS:
+      if((stack->rxState == RX_STATE_UNINITIALIZED) || 
+         (stack->rxState == RX_STATE_PORT_INITIALIZED) ||
+         (stack->txState == TX_STATE_UNINITIALIZED) || 
+         (stack->txState == TX_STATE_PORT_INITIALIZED))
+      {
+        data = RIOCSR_PORT_UNINITIALIZED;
+      }
+      else
+      {
+        data = RIOCSR_PORT_OK;
+      }
+
+      if(stack->rxState == RX_STATE_INPUT_ERROR_STOPPED)
+      {
+        data |= RIOCSR_INPUT_ERROR_STOPPED;
+      }
+      else if(stack->rxState == RX_STATE_INPUT_RETRY_STOPPED)
+      {
+        data |= RIOCSR_INPUT_RETRY_STOPPED;
+      }
+      else
+      {
+        /* Don't do anything. */
+      }
+
+      if(stack->txState == TX_STATE_OUTPUT_ERROR_STOPPED)
+      {
+        data |= RIOCSR_OUTPUT_ERROR_STOPPED;
+      }
+      else if(stack->txState == TX_STATE_OUTPUT_RETRY_STOPPED)
+      {
+        data |= RIOCSR_OUTPUT_RETRY_STOPPED;
+      }
+      else
+      {
+        /* Don't do anything. */
+      }
+
+      /* The encountered bits are set until cleared if the counters have 
+         increased. */
+      if(getInputErrors(stack) != csr->inputErrors)
+      {
+        data |= RIOCSR_INPUT_ERROR_ENCOUNTERED;
+      }
+      else
+      {
+        /* Don't do anything. */
+      }
+      if(getOutputErrors(stack) != csr->outputErrors)
+      {
+        data |= RIOCSR_OUTPUT_ERROR_ENCOUNTERED;
+      }
+      else
+      {
+        /* Don't do anything. */
+      }
+      if(stack->statusOutboundPacketRetry != csr->outputRetries)
+      {
+        data |= RIOCSR_OUTPUT_RETRY_ENCOUNTERED;
+      }
+      else
+      {
+        /* Don't do anything. */
+      }
+      break;
+    case LP_SERIAL_CONTROL:
+      data = PORT_CONTROL;
+      break;
+    default:
+      /* Reserved or not implemented. */
+      data = 0ul;
+      break;
+  }
+
+  return data;
+}
+
+
+static void writeLpSerial(RioCsr_t *csr, const uint32_t offset, const uint32_t data)
+{
+  RioStack_t *stack;
+
+
+  stack = csr->stack;
+  switch(offset)
+  {
+    case LP_SERIAL_LINK_TIMEOUT:
+      RIOSTACK_portSetTimeout(stack, data >> 8);
+      break;
+    case LP_SERIAL_GENERAL_CONTROL:
+      csr->portGeneralControl = data;
+      break;
+    case LP_SERIAL_ERROR_STATUS:
+      /* Clear the encountered bits that are written with ones. */
+      if((data & RIOCSR_INPUT_ERROR_ENCOUNTERED) != 0ul)
+      {
+        csr->inputErrors = getInputErrors(stack);
+      }
+      else
+      {
+        /* Don't do anything. */
+      }
+      if((data & RIOCSR_OUTPUT_ERROR_ENCOUNTERED) != 0ul)
+      {
+        csr->outputErrors = getOutputErrors(stack);
+      }
+      else
+      {
+        /* Don't do anything. */
+      }
+      if((data & RIOCSR_OUTPUT_RETRY_ENCOUNTERED) != 0ul)
+      {
+        csr->outputRetries = stack->statusOutboundPacketRetry;
+      }
+      else
+      {
+        /* Don't do anything. */
+      }
+      break;
+    default:
+      /* Read-only, reserved or not implemented. */
+      break;
+  }
+}
+
+
+static uint32_t readErrorManagement(RioCsr_t *csr, const uint32_t offset)
+{
+  uint32_t data;
+  uint8_t i;
+
+
+  switch(offset)
+  {
+    case ERROR_MANAGEMENT_HEADER:
+      /* This is the last block in the extended features list. */
+      data = RIOCSR_ERROR_MANAGEMENT_EF_ID;
+      break;
+    case ERROR_MANAGEMENT_PORT_WRITE_TARGET:
+      data = csr->portWriteTarget;
+      break;
+    case ERROR_MANAGEMENT_ERROR_DETECT:
+      data = 0ul;
+      for(i = 0u; i < RIOCSR_ERRORS; i++)
+      {
+        if(getErrorCount(csr->stack, i) != csr->errors[i])
+        {
+          data |= errorDetectBits[i];
+        }
+        else
+        {
+          /* Don't do anything. */
+        }
+      }
+      break;
+    case ERROR_MANAGEMENT_ERROR_RATE_ENABLE:
+      data = csr->errorRateEnable;
+      break;
+    default:
+      /* Reserved or not implemented. */
+      data = 0ul;
+      break;
+  }
+
+  return data;
+}
+
+
+static void writeErrorManagement(RioCsr_t *csr, const uint32_t offset, const uint32_t data)
+{
+  uint8_t i;
+
+
+  switch(offset)
+  {
+    case ERROR_MANAGEMENT_PORT_WRITE_TARGET:
+      csr->portWriteTarget = data;
+      break;
+    case ERROR_MANAGEMENT_ERROR_DETECT:
+      /* Clear the bits that are written with zeros. */
+      for(i = 0u; i < RIOCSR_ERRORS; i++)
+      {
+        if((data & errorDetectBits[i]) == 0ul)
+        {
+          csr->errors[i] = getErrorCount(csr->stack, i);
+        }
+        else
+        {
+          /* Don't do anything. */
+        }
+      }
+      break;
+    case ERROR_MANAGEMENT_ERROR_RATE_ENABLE:
+      csr->errorRateEnable = data;
+      break;
+    default:
+      /* Read-only, reserved or not implemented. */
+      break;
+  }
+}
+
+
+static uint32_t getInputErrors(const RioStack_t *stack)
+{
+  return stack->statusInboundErrorControlCrc + 
+    stack->statusInboundErrorPacketAckId + 
+    stack->statusInboundErrorPacketCrc + 
+    stack->statusInboundErrorIllegalCharacter + 
+    stack->statusInboundErrorGeneral;
+}
+
+
+static uint32_t getOutputErrors(const RioStack_t *stack)
+{
+  return stack->statusOutboundErrorTimeout + 
+    stack->statusOutboundErrorPacketAccepted + 
+    stack->statusOutboundErrorPacketRetry + 
+    stack->statusPartnerErrorControlCrc + 
+    stack->statusPartnerErrorPacketAckId + 
+    stack->statusPartnerErrorPacketCrc + 
+    stack->statusPartnerErrorIllegalCharacter + 
+    stack->statusPartnerErrorGeneral;
+}
+
+
+static uint32_t getErrorCount(const RioStack_t *stack, const uint8_t index)
+{
+  uint32_t count;
+
+
+  switch(index)
+  {
+    case 0u:
+      count = stack->statusOutboundErrorTimeout;
+      break;
+    case 1u:
+      count = stack->statusInboundErrorIllegalCharacter;
+      break;
+    case 2u:
+      count = stack->statusInboundErrorGeneral;
+      break;
+    case 3u:
+      count = stack->statusInboundErrorPacketCrc;
+      break;
+    case 4u:
+      count = stack->statusInboundErrorPacketAckId;
+      break;
+    case 5u:
+      count = stack->statusPartnerErrorControlCrc + 
+        stack->statusPartnerErrorPacketAckId + 
+        stack->statusPartnerErrorPacketCrc + 
+        stack->statusPartnerErrorIllegalCharacter + 
+        stack->statusPartnerErrorGeneral;
+      break;
+    case 6u:
+      count = stack->statusOutboundErrorPacketAccepted + 
+        stack->statusOutboundErrorPacketRetry;
+      break;
+    default:
+      count = stack->statusInboundErrorControlCrc;
+      break;
+  }
+
+  return count;
+}
+
+/*************************** end of file **************************************/
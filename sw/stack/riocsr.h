@@ -0,0 +1,222 @@
+/******************************************************************************
+ * (C) Copyright 2013-2015 Magnus Rosenius and the Free Software Foundation.
+ *
+ * This file is part of OpenRIO.
+ *
+ * OpenRIO is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenRIO is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Lesser Public License
+ * along with OpenRIO.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+
+/******************************************************************************
+ * Description:
+ * This file contains a configuration space provider that presents the state of
+ * a stack in the standard registers of the LP-Serial and the error management
+ * extended features blocks.
+ *
+ * The LP-Serial block is a generic end point block (EF_ID 0x0001) for one port
+ * and the error management block (EF_ID 0x0007) follows it in the extended
+ * features list. The registers are:
+ * - Port Link Timeout Control CSR, the timeout of RIOSTACK_portSetTimeout().
+ * - Port General Control CSR, a plain register.
+ * - Port 0 Local ackID CSR, the inbound, outstanding and outbound ackIds.
+ * - Port 0 Error and Status CSR, port OK/uninitialized, the input and output
+ *   retry- and error-stopped states and the retry- and error-encountered bits.
+ * - Port 0 Control CSR, a serial single lane port with input and output enabled.
+ * - Port-write Target deviceID CSR, a plain register.
+ * - Port 0 Error Detect CSR, error bits that are set when the corresponding
+ *   status counters of the stack increase.
+ * - Port 0 Error Rate Enable CSR, a plain register.
+ * Other registers in the blocks are read as zero and writes to them are
+ * ignored.
+ *
+ * The encountered bits of the Port 0 Error and Status CSR are cleared by
+ * writing ones to them and the bits of the Port 0 Error Detect CSR are cleared
+ * by writing zeros to them, as in hardware ports. The status counters of the
+ * stack are not changed.
+ *
+ * Maintenance read and write requests to the blocks can be answered directly
+ * from the receiver of a stack, see RIOCSR_attach(). Other maintenance packets
+ * are forwarded to the inbound handler that was registered before, for
+ * example a port-write collector, or placed in the inbound queue.
+ *
+ * Typical usage:
+ *   RIOCSR_open(&csr, &stack, 0x0100, 0x0200);
+ *   RIOCSR_attach(&csr, &stack);
+ *   ...
+ *   if(RIOCSR_read(&csr, offset, &data))
+ *   {
+ *     <the register is provided>
+ *   }
+ *
+ * Any application specific tailoring needed to compile properly should be done
+ * in rioconfig.h.
+ ******************************************************************************/
+
+#ifndef __RIOCSR_H
+#define __RIOCSR_H
+
+/*******************************************************************************
+ * Include files.
+ *******************************************************************************/
+
+#include "rioconfig.h"
+#include "riopacket.h"
+#include "riostack.h"
+
+
+/*******************************************************************************
+ * Global macros.
+ *******************************************************************************/
+
+/** The EF_ID of a generic end point LP-Serial block. */
+#define RIOCSR_LP_SERIAL_EF_ID 0x0001ul
+
+/** The EF_ID of an error management block. */
+#define RIOCSR_ERROR_MANAGEMENT_EF_ID 0x0007ul
+
+/** The size in bytes of the LP-Serial block for one port. */
+#define RIOCSR_LP_SERIAL_SIZE 0x60ul
+
+/** The size in bytes of the error management block for one port. */
+#define RIOCSR_ERROR_MANAGEMENT_SIZE 0x80ul
+
+/** Bits in the Port N Error and Status CSR. */
+#define RIOCSR_PORT_UNINITIALIZED 0x00000001ul
+#define RIOCSR_PORT_OK 0x00000002ul
+#define RIOCSR_INPUT_ERROR_STOPPED 0x00000100ul
+#define RIOCSR_INPUT_ERROR_ENCOUNTERED 0x00000200ul
+#define RIOCSR_INPUT_RETRY_STOPPED 0x00000400ul
+#define RIOCSR_OUTPUT_ERROR_STOPPED 0x00010000ul
+#define RIOCSR_OUTPUT_ERROR_ENCOUNTERED 0x00020000ul
+#define RIOCSR_OUTPUT_RETRY_STOPPED 0x00040000ul
+#define RIOCSR_OUTPUT_RETRY_ENCOUNTERED 0x00100000ul
+
+/** Bits in the Port N Error Detect CSR. */
+#define RIOCSR_DETECT_LINK_TIMEOUT 0x00000001ul
+#define RIOCSR_DETECT_ILLEGAL_CHARACTER 0x00010000ul
+#define RIOCSR_DETECT_PACKET_SIZE 0x00020000ul
+#define RIOCSR_DETECT_PACKET_CRC 0x00040000ul
+#define RIOCSR_DETECT_PACKET_ACKID 0x00080000ul
+#define RIOCSR_DETECT_PACKET_NOT_ACCEPTED 0x00100000ul
+#define RIOCSR_DETECT_ACKNOWLEDGE_ACKID 0x00200000ul
+#define RIOCSR_DETECT_CONTROL_CRC 0x00400000ul
+
+/** The number of error counters that are mapped to the Port N Error Detect CSR. */
+#define RIOCSR_ERRORS 8u
+
+
+/*******************************************************************************
+ * Global typedefs.
+ *******************************************************************************/
+
+/** The structure to keep all the configuration space provider variables. */
+typedef struct
+{
+  RioStack_t *stack; /**< The stack to present. */
+  uint32_t lpSerialOffset; /**< The offset of the LP-Serial block. */
+  uint32_t errorManagementOffset; /**< The offset of the error management block. */
+
+  uint32_t portGeneralControl; /**< The Port General Control CSR. */
+  uint32_t portWriteTarget; /**< The Port-write Target deviceID CSR. */
+  uint32_t errorRateEnable; /**< The Port 0 Error Rate Enable CSR. */
+
+  uint32_t inputErrors; /**< The inbound errors when input error-encountered was cleared. */
+  uint32_t outputErrors; /**< The outbound errors when output error-encountered was cleared. */
+  uint32_t outputRetries; /**< The retries when output retry-encountered was cleared. */
+  uint32_t errors[RIOCSR_ERRORS]; /**< The error counters when the error detect bits were cleared. */
+
+  RioStackInboundHandler_t nextHandler; /**< The maintenance handler to forward other packets to. */
+  void *nextContext; /**< The context of the next handler. */
+
+  /** The number of maintenance read requests that has been answered. */
+  uint32_t statusReads;
+
+  /** The number of maintenance write requests that has been answered. */
+  uint32_t statusWrites;
+
+  /** The number of requests that could not be answered since the outbound queue was full. */
+  uint32_t statusDropped;
+} RioCsr_t;
+
+
+/*******************************************************************************
+ * Global function prototypes.
+ *******************************************************************************/
+
+/**
+ * \brief Open a configuration space provider.
+ *
+ * \param[in] csr The provider to operate on.
+ * \param[in] stack The stack whose state is presented.
+ * \param[in] lpSerialOffset The offset of the LP-Serial block.
+ * \param[in] errorManagementOffset The offset of the error management block.
+ *
+ * The offsets are the extended feature pointers of the blocks and must be 
+ * word aligned and below 0x10000. The error detect and encountered bits are 
+ * cleared.
+ */
+void RIOCSR_open(RioCsr_t *csr, RioStack_t *stack,
+                 const uint32_t lpSerialOffset, const uint32_t errorManagementOffset);
+
+/**
+ * \brief Answer maintenance requests from the receiver of a stack.
+ *
+ * \param[in] csr The provider to operate on.
+ * \param[in] stack The stack to receive maintenance requests from.
+ *
+ * This function registers the provider as the inbound handler of MAINTENANCE 
+ * packets in the stack. Read and write requests to the blocks are answered 
+ * using the outbound queue of the stack. Other maintenance packets are 
+ * forwarded to the handler that was registered before this call, if any.
+ */
+void RIOCSR_attach(RioCsr_t *csr, RioStack_t *stack);
+
+/**
+ * \brief Read a register.
+ *
+ * \param[in] csr The provider to operate on.
+ * \param[in] offset The byte offset of the register in configuration space.
+ * \param[out] data The value of the register.
+ * \return Non-zero if the register is in one of the blocks, zero otherwise.
+ */
+uint8_t RIOCSR_read(RioCsr_t *csr, const uint32_t offset, uint32_t *data);
+
+/**
+ * \brief Write a register.
+ *
+ * \param[in] csr The provider to operate on.
+ * \param[in] offset The byte offset of the register in configuration space.
+ * \param[in] data The value to write.
+ * \return Non-zero if the register is in one of the blocks, zero otherwise.
+ */
+uint8_t RIOCSR_write(RioCsr_t *csr, const uint32_t offset, const uint32_t data);
+
+/**
+ * \brief Answer a received maintenance request.
+ *
+ * \param[in] csr The provider to operate on.
+ * \param[in] stack The stack to send the response on.
+ * \param[in] packet The received packet.
+ * \return Non-zero if the packet was a read or write request to one of the 
+ * blocks, zero otherwise.
+ *
+ * This function is called by the stack when RIOCSR_attach() has been used but 
+ * can also be used to answer requests received from other sources. A request 
+ * is dropped and counted in statusDropped if the outbound queue is full.
+ */
+uint8_t RIOCSR_receive(RioCsr_t *csr, RioStack_t *stack, const RioPacket_t *packet);
+
+#endif
+
+/*************************** end of file **************************************/
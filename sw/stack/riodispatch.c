@@ -0,0 +1,325 @@
+/******************************************************************************
+ * (C) Copyright 2013-2015 Magnus Rosenius and the Free Software Foundation.
+ *
+ * This file is part of OpenRIO.
+ *
+ * OpenRIO is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenRIO is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Lesser Public License
+ * along with OpenRIO.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+/******************************************************************************
+ * Description:
+ * This file contains a dispatcher for inbound RapidIO packets.
+ * See riodispatch.h for more info.
+ *
+ * Any application specific tailoring needed to compile properly should be done
+ * in rioconfig.h.
+ ******************************************************************************/
+
+/*******************************************************************************
+ * Includes
+ *******************************************************************************/
+
+#include "riodispatch.h"
+
+/* Get definitions of ASSERT(), assumed to not return. */
+#include "rioconfig.h"
+
+
+/*******************************************************************************
+ * Local function prototypes
+ *******************************************************************************/
+
+/**
+ * \brief Decode the header fields of a packet.
+ *
+ * \param[in] packet The packet to decode.
+ * \param[out] header The decoded header.
+ */
+static void decodeHeader(const RioPacket_t *packet, RioDispatchHeader_t *header);
+
+/**
+ * \brief Find the handler to use for a packet.
+ *
+ * \param[in] dispatch The dispatcher to operate on.
+ * \param[in] header The decoded header of the packet.
+ * \param[in] packet The packet.
+ * \return The registered handler or NULL if there is none.
+ */
+static const RioDispatchEntry_t *findEntry(const RioDispatch_t *dispatch,
+                                           const RioDispatchHeader_t *header,
+                                           const RioPacket_t *packet);
+
+
+/*******************************************************************************
+ * Global functions
+ *******************************************************************************/
+
+void RIODISPATCH_open(RioDispatch_t *dispatch, RioDispatchHandler_t unhandled, void *context)
+{
+  uint16_t i;
+  uint16_t j;
+
+
+  ASSERT(dispatch != NULL, "Invalid dispatch pointer");
+
+  for(i = 0u; i < 16u; i++)
+  {
+    for(j = 0u; j < 16u; j++)
+    {
+      dispatch->table[i][j].handler = NULL;
+      dispatch->table[i][j].context = NULL;
+    }
+  }
+
+  for(i = 0u; i < RIODISPATCH_MAILBOXES; i++)
+  {
+    dispatch->mailbox[i].handler = NULL;
+    dispatch->mailbox[i].context = NULL;
+  }
+
+  dispatch->doorbellRanges = 0u;
+
+  dispatch->unhandled.handler = unhandled;
+  dispatch->unhandled.context = context;
+
+  dispatch->statusPacketHandled = 0ul;
+  dispatch->statusPacketUnhandled = 0ul;
+}
+
+
+void RIODISPATCH_setHandler(RioDispatch_t *dispatch, const uint8_t ftype, const uint8_t transaction,
+                            RioDispatchHandler_t handler, void *context)
+{
+  ASSERT(dispatch != NULL, "Invalid dispatch pointer");
+  ASSERT(ftype < 16u, "Invalid ftype");
+  ASSERT(transaction < 16u, "Invalid transaction");
+
+  dispatch->table[ftype & 0xfu][transaction & 0xfu].handler = handler;
+  dispatch->table[ftype & 0xfu][transaction & 0xfu].context = context;
+}
+
+
+void RIODISPATCH_setFtypeHandler(RioDispatch_t *dispatch, const uint8_t ftype,
+                                 RioDispatchHandler_t handler, void *context)
+{
+  uint8_t transaction;
+
+
+  for(transaction = 0u; transaction < 16u; transaction++)
+  {
+    RIODISPATCH_setHandler(dispatch, ftype, transaction, handler, context);
+  }
+}
+
+
+void RIODISPATCH_setMailboxHandler(RioDispatch_t *dispatch, const uint8_t mailbox,
+                                   RioDispatchHandler_t handler, void *context)
+{
+  ASSERT(dispatch != NULL, "Invalid dispatch pointer");
+
+  dispatch->mailbox[mailbox].handler = handler;
+  dispatch->mailbox[mailbox].context = context;
+}
+
+
+uint8_t RIODISPATCH_setDoorbellHandler(RioDispatch_t *dispatch, const uint16_t infoMin, const uint16_t infoMax,
+                                       RioDispatchHandler_t handler, void *context)
+{
+  uint8_t returnValue;
+  RioDispatchDoorbellRange_t *range;
+
+
+  ASSERT(dispatch != NULL, "Invalid dispatch pointer");
+  ASSERT(infoMin <= infoMax, "Invalid doorbell range");
+
+  /* Check if there are any unused ranges. */
+  if(dispatch->doorbellRanges < RIODISPATCH_DOORBELL_RANGES_MAX)
+  {
+    /* There is an unused range. */
+    range = &dispatch->doorbell[dispatch->doorbellRanges];
+    range->infoMin = infoMin;
+    range->infoMax = infoMax;
+    range->entry.handler = handler;
+    range->entry.context = context;
+    dispatch->doorbellRanges++;
+    returnValue = 1u;
+  }
+  else
+  {
+    /* All ranges are used. */
+    returnValue = 0u;
+  }
+
+  return returnValue;
+}
+
+
+uint8_t RIODISPATCH_dispatch(RioDispatch_t *dispatch, const RioPacket_t *packet)
+{
+  uint8_t returnValue;
+  RioDispatchHeader_t header;
+  const RioDispatchEntry_t *entry;
+
+
+  ASSERT(dispatch != NULL, "Invalid dispatch pointer");
+  ASSERT(packet != NULL, "Invalid packet pointer");
+
+  decodeHeader(packet, &header);
+  entry = findEntry(dispatch, &header, packet);
+
+  /* Check if the packet has a registered handler. */
+  if(entry != NULL)
+  {
+    /* The packet has a handler. */
+    entry->handler(entry->context, &header, packet);
+    dispatch->statusPacketHandled++;
+    returnValue = 1u;
+  }
+  else
+  {
+    /* The packet does not have a handler. */
+    if(dispatch->unhandled.handler != NULL)
+    {
+      dispatch->unhandled.handler(dispatch->unhandled.context, &header, packet);
+    }
+    else
+    {
+      /* Discard the packet. */
+    }
+    dispatch->statusPacketUnhandled++;
+    returnValue = 0u;
+  }
+
+  return returnValue;
+}
+
+
+uint8_t RIODISPATCH_processInbound(RioDispatch_t *dispatch, RioStack_t *stack, const uint8_t maxPackets)
+{
+  RioPacket_t packet;
+  uint8_t processed;
+
+
+  ASSERT(stack != NULL, "Invalid stack pointer");
+
+  processed = 0u;
+  while((processed < maxPackets) && (RIOSTACK_getInboundQueueLength(stack) > 0u))
+  {
+    RIOSTACK_getInboundPacket(stack, &packet);
+    (void) RIODISPATCH_dispatch(dispatch, &packet);
+    processed++;
+  }
+
+  return processed;
+}
+
+
+/*******************************************************************************
+ * Local functions
+ *******************************************************************************/
+
+static void decodeHeader(const RioPacket_t *packet, RioDispatchHeader_t *header)
+{
+  header->ftype = RIOPACKET_getFtype(packet);
+  header->destination = RIOPACKET_getDestination(packet);
+  header->source = RIOPACKET_getSource(packet);
+
+  /* Only some packets contain a transaction and a tid field. */
+  switch(header->ftype)
+  {
+    case RIOPACKET_FTYPE_REQUEST:
+    case RIOPACKET_FTYPE_WRITE:
+    case RIOPACKET_FTYPE_MAINTENANCE:
+    case RIOPACKET_FTYPE_RESPONSE:
+      header->transaction = RIOPACKET_getTransaction(packet);
+      header->tid = RIOPACKET_getTid(packet);
+      break;
+    case RIOPACKET_FTYPE_DOORBELL:
+      header->transaction = 0u;
+      header->tid = RIOPACKET_getTid(packet);
+      break;
+    default:
+      header->transaction = 0u;
+      header->tid = 0u;
+      break;
+  }
+}
+
+
+static const RioDispatchEntry_t *findEntry(const RioDispatch_t *dispatch,
+                                           const RioDispatchHeader_t *header,
+                                           const RioPacket_t *packet)
+{
+  const RioDispatchEntry_t *entry;
+  uint16_t info;
+  uint8_t i;
+
+
+  entry = NULL;
+
+  /* Check the subtables first. Only packets with 16-bit deviceIds are decoded. */
+  if(RIOPACKET_getTt(packet) != (uint8_t) RIOPACKET_TT_16BITS)
+  {
+    /* Use the ftype/transaction table. */
+  }
+  else if(header->ftype == (uint8_t) RIOPACKET_FTYPE_MESSAGE)
+  {
+    /* Message, check the mailbox handlers. */
+    entry = &dispatch->mailbox[RIOPACKET_getMailbox(packet)];
+  }
+  else if(header->ftype == (uint8_t) RIOPACKET_FTYPE_DOORBELL)
+  {
+    /* Doorbell, check the info ranges. */
+    info = RIOPACKET_getInfo(packet);
+    for(i = 0u; (entry == NULL) && (i < dispatch->doorbellRanges); i++)
+    {
+      if((info >= dispatch->doorbell[i].infoMin) && (info <= dispatch->doorbell[i].infoMax))
+      {
+        entry = &dispatch->doorbell[i].entry;
+      }
+      else
+      {
+        /* Not in this range. */
+      }
+    }
+  }
+  else
+  {
+    /* No subtable for this ftype. */
+  }
+
+  /* Use the ftype/transaction table if there was no match in the subtables. */
+  if((entry == NULL) || (entry->handler == NULL))
+  {
+    entry = &dispatch->table[header->ftype & 0xfu][header->transaction & 0xfu];
+  }
+  else
+  {
+    /* Don't do anything. */
+  }
+
+  /* Return NULL if no handler was registered. */
+  if(entry->handler == NULL)
+  {
+    entry = NULL;
+  }
+  else
+  {
+    /* Don't do anything. */
+  }
+
+  return entry;
+}
+
+/*************************** end of file **************************************/
@@ -0,0 +1,235 @@
+/******************************************************************************
+ * (C) Copyright 2013-2015 Magnus Rosenius and the Free Software Foundation.
+ *
+ * This file is part of OpenRIO.
+ *
+ * OpenRIO is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenRIO is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Lesser Public License
+ * along with OpenRIO.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+/******************************************************************************
+ * Description:
+ * This file contains a dispatcher for inbound RapidIO packets.
+ *
+ * Instead of switching on the ftype and transaction of every received packet,
+ * handlers are registered for the packet types an application supports. A
+ * received packet is then forwarded to its handler using a table lookup on
+ * {ftype, transaction} and one indirect call. The handler gets the decoded
+ * header fields together with the packet.
+ *
+ * MESSAGE packets can be routed on their mailbox and DOORBELL packets on
+ * ranges of their info field. These subtables are checked before the
+ * ftype/transaction table.
+ *
+ * Packets that has no registered handler are forwarded to a default handler.
+ *
+ * Typical usage:
+ *   RIODISPATCH_open(&dispatch, unsupportedHandler, NULL);
+ *   RIODISPATCH_setHandler(&dispatch, RIOPACKET_FTYPE_MAINTENANCE,
+ *                          RIOPACKET_TRANSACTION_MAINT_READ_REQUEST,
+ *                          maintReadHandler, &device);
+ *   RIODISPATCH_setDoorbellHandler(&dispatch, 0x0000, 0x00ff, eventHandler, &events);
+ *   ...
+ *   <bottom-half traffic handling>
+ *   (void) RIODISPATCH_processInbound(&dispatch, &stack, 8);
+ *
+ * Any application specific tailoring needed to compile properly should be done
+ * in rioconfig.h.
+ ******************************************************************************/
+
+#ifndef __RIODISPATCH_H
+#define __RIODISPATCH_H
+
+/*******************************************************************************
+ * Include files.
+ *******************************************************************************/
+
+#include "rioconfig.h"
+#include "riopacket.h"
+#include "riostack.h"
+
+
+/*******************************************************************************
+ * Global macros.
+ *******************************************************************************/
+
+/** The maximum number of doorbell info ranges that can be registered. */
+#ifndef RIODISPATCH_DOORBELL_RANGES_MAX
+#define RIODISPATCH_DOORBELL_RANGES_MAX 8u
+#endif
+
+/** The number of mailboxes that can be addressed by a MESSAGE. */
+#define RIODISPATCH_MAILBOXES 256u
+
+
+/*******************************************************************************
+ * Global typedefs.
+ *******************************************************************************/
+
+/** The decoded header of a packet that is forwarded to a handler. */
+typedef struct
+{
+  uint8_t ftype; /**< The ftype of the packet. */
+  uint8_t transaction; /**< The transaction field, or zero if the packet has none. */
+  uint16_t destination; /**< The destination deviceId. */
+  uint16_t source; /**< The source deviceId. */
+  uint8_t tid; /**< The transaction identifier, or zero if the packet has none. */
+} RioDispatchHeader_t;
+
+/**
+ * \brief A packet handler.
+ *
+ * \param[in] context The context pointer given when the handler was registered.
+ * \param[in] header The decoded header of the packet.
+ * \param[in] packet The packet.
+ */
+typedef void (*RioDispatchHandler_t)(void *context, const RioDispatchHeader_t *header,
+                                     const RioPacket_t *packet);
+
+/** A registered handler. */
+/** \internal Note that this structure is for internal usage only. */
+typedef struct
+{
+  RioDispatchHandler_t handler; /**< The function to call, NULL if not registered. */
+  void *context; /**< The context to call the handler with. */
+} RioDispatchEntry_t;
+
+/** A registered doorbell range handler. */
+/** \internal Note that this structure is for internal usage only. */
+typedef struct
+{
+  uint16_t infoMin; /**< The lowest info value that is handled. */
+  uint16_t infoMax; /**< The highest info value that is handled. */
+  RioDispatchEntry_t entry; /**< The handler for the range. */
+} RioDispatchDoorbellRange_t;
+
+/** The structure to keep all the dispatcher variables. */
+typedef struct
+{
+  RioDispatchEntry_t table[16u][16u]; /**< Handlers indexed by ftype and transaction. */
+  RioDispatchEntry_t mailbox[RIODISPATCH_MAILBOXES]; /**< Handlers indexed by MESSAGE mailbox. */
+  RioDispatchDoorbellRange_t doorbell[RIODISPATCH_DOORBELL_RANGES_MAX]; /**< Handlers for DOORBELL info ranges. */
+  uint8_t doorbellRanges; /**< The number of used doorbell ranges. */
+  RioDispatchEntry_t unhandled; /**< The handler for packets without a registered handler. */
+
+  /** The number of packets that has been forwarded to a registered handler. */
+  uint32_t statusPacketHandled;
+
+  /** The number of packets that has been forwarded to the default handler. */
+  uint32_t statusPacketUnhandled;
+} RioDispatch_t;
+
+
+/*******************************************************************************
+ * Global function prototypes.
+ *******************************************************************************/
+
+/**
+ * \brief Open a dispatcher for operation.
+ *
+ * \param[in] dispatch The dispatcher to operate on.
+ * \param[in] unhandled The handler to call for packets without a registered
+ *            handler. Use NULL to silently discard such packets.
+ * \param[in] context The context to call the unhandled handler with.
+ *
+ * This function removes all registered handlers.
+ */
+void RIODISPATCH_open(RioDispatch_t *dispatch, RioDispatchHandler_t unhandled, void *context);
+
+/**
+ * \brief Register a handler for a ftype and transaction.
+ *
+ * \param[in] dispatch The dispatcher to operate on.
+ * \param[in] ftype The ftype to handle, one of RIOPACKET_FTYPE_XXXX.
+ * \param[in] transaction The transaction to handle, one of RIOPACKET_TRANSACTION_XXXX.
+ * \param[in] handler The function to call. Use NULL to remove a handler.
+ * \param[in] context The context to call the handler with.
+ *
+ * This function registers a handler for a specific transaction of a specific
+ * ftype. A previously registered handler is replaced.
+ */
+void RIODISPATCH_setHandler(RioDispatch_t *dispatch, const uint8_t ftype, const uint8_t transaction,
+                            RioDispatchHandler_t handler, void *context);
+
+/**
+ * \brief Register a handler for all transactions of a ftype.
+ *
+ * \param[in] dispatch The dispatcher to operate on.
+ * \param[in] ftype The ftype to handle, one of RIOPACKET_FTYPE_XXXX.
+ * \param[in] handler The function to call. Use NULL to remove the handlers.
+ * \param[in] context The context to call the handler with.
+ *
+ * This function registers the same handler for all transactions of a ftype. It
+ * should be used for packets that does not contain a transaction field, for
+ * example DOORBELL and MESSAGE.
+ */
+void RIODISPATCH_setFtypeHandler(RioDispatch_t *dispatch, const uint8_t ftype,
+                                 RioDispatchHandler_t handler, void *context);
+
+/**
+ * \brief Register a handler for a MESSAGE mailbox.
+ *
+ * \param[in] dispatch The dispatcher to operate on.
+ * \param[in] mailbox The mailbox to handle, see RIOPACKET_getMessage().
+ * \param[in] handler The function to call. Use NULL to remove the handler.
+ * \param[in] context The context to call the handler with.
+ *
+ * MESSAGE packets to a mailbox without a registered mailbox handler are forwarded
+ * to the handler of the MESSAGE ftype.
+ */
+void RIODISPATCH_setMailboxHandler(RioDispatch_t *dispatch, const uint8_t mailbox,
+                                   RioDispatchHandler_t handler, void *context);
+
+/**
+ * \brief Register a handler for a range of DOORBELL info values.
+ *
+ * \param[in] dispatch The dispatcher to operate on.
+ * \param[in] infoMin The lowest info value to handle.
+ * \param[in] infoMax The highest info value to handle.
+ * \param[in] handler The function to call.
+ * \param[in] context The context to call the handler with.
+ * \return Non-zero if the range was registered, zero if all ranges are used.
+ *
+ * The ranges are checked in the order they were registered and the first
+ * matching range is used. DOORBELL packets that does not match any range are
+ * forwarded to the handler of the DOORBELL ftype.
+ */
+uint8_t RIODISPATCH_setDoorbellHandler(RioDispatch_t *dispatch, const uint16_t infoMin, const uint16_t infoMax,
+                                       RioDispatchHandler_t handler, void *context);
+
+/**
+ * \brief Forward a packet to its handler.
+ *
+ * \param[in] dispatch The dispatcher to operate on.
+ * \param[in] packet The packet to forward.
+ * \return Non-zero if a registered handler was called, zero if the packet was
+ * forwarded to the default handler.
+ */
+uint8_t RIODISPATCH_dispatch(RioDispatch_t *dispatch, const RioPacket_t *packet);
+
+/**
+ * \brief Forward packets from the inbound queue of a stack to their handlers.
+ *
+ * \param[in] dispatch The dispatcher to operate on.
+ * \param[in] stack The stack to read packets from.
+ * \param[in] maxPackets The maximum number of packets to process.
+ * \return The number of packets that was processed.
+ *
+ * This function reads packets from the inbound queue until it is empty or
+ * maxPackets has been processed and forwards each of them to its handler.
+ */
+uint8_t RIODISPATCH_processInbound(RioDispatch_t *dispatch, RioStack_t *stack, const uint8_t maxPackets);
+
+#endif /* __RIODISPATCH_H */
+
+/*************************** end of file **************************************/
@@ -0,0 +1,395 @@
+/******************************************************************************
+ * (C) Copyright 2013-2015 Magnus Rosenius and the Free Software Foundation.
+ *
+ * This file is part of OpenRIO.
+ *
+ * OpenRIO is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenRIO is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Lesser Public License
+ * along with OpenRIO.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+/******************************************************************************
+ * Description:
+ * This file contains an event queue for received DOORBELL packets.
+ * See riodoorbell.h for more info.
+ *
+ * Any application specific tailoring needed to compile properly should be done
+ * in rioconfig.h.
+ ******************************************************************************/
+
+/*******************************************************************************
+ * Includes
+ *******************************************************************************/
+
+#include "riodoorbell.h"
+
+/* Get definitions of ASSERT(), assumed to not return. */
+#include "rioconfig.h"
+
+
+/*******************************************************************************
+ * Local function prototypes
+ *******************************************************************************/
+
+/**
+ * \brief The inbound handler registered in the stack.
+ *
+ * \param[in] context The doorbell event queue.
+ * \param[in] stack The stack that received the packet.
+ * \param[in] packet The received DOORBELL.
+ * \return Non-zero if the doorbell was queued.
+ */
+static uint8_t inboundHandler(void *context, RioStack_t *stack, const RioPacket_t *packet);
+
+/**
+ * \brief Find a queued event to coalesce a doorbell into.
+ *
+ * \param[in] doorbell The doorbell event queue to operate on.
+ * \param[in] source The source deviceId of the doorbell.
+ * \param[in] info The info field of the doorbell.
+ * \param[in] time The current time.
+ * \return The event to coalesce into or NULL if there is none.
+ */
+static RioDoorbellEvent_t *findEvent(RioDoorbell_t *doorbell, 
+                                     const uint16_t source, const uint16_t info, const uint32_t time);
+
+
+/*******************************************************************************
+ * Global functions
+ *******************************************************************************/
+
+void RIODOORBELL_open(RioDoorbell_t *doorbell,
+                      const uint16_t eventsSize, RioDoorbellEvent_t *events,
+                      const uint16_t responsesSize, RioDoorbellResponse_t *responses)
+{
+  ASSERT(doorbell != NULL, "Invalid doorbell pointer");
+  ASSERT((events != NULL) || (eventsSize == 0u), "Invalid events pointer");
+  ASSERT((responses != NULL) || (responsesSize == 0u), "Invalid responses pointer");
+
+  doorbell->events = events;
+  doorbell->eventsSize = eventsSize;
+  doorbell->eventsFront = 0u;
+  doorbell->eventsLength = 0u;
+
+  doorbell->responses = responses;
+  doorbell->responsesSize = responsesSize;
+  doorbell->responsesFront = 0u;
+  doorbell->responsesLength = 0u;
+
+  doorbell->coalesceWindow = 0ul;
+
+  doorbell->ranges = 0u;
+  doorbell->unhandled = NULL;
+  doorbell->unhandledContext = NULL;
+
+  doorbell->statusReceived = 0ul;
+  doorbell->statusCoalesced = 0ul;
+  doorbell->statusOverflow = 0ul;
+}
+
+
+void RIODOORBELL_setCoalescing(RioDoorbell_t *doorbell, const uint32_t window)
+{
+  ASSERT(doorbell != NULL, "Invalid doorbell pointer");
+  doorbell->coalesceWindow = window;
+}
+
+
+uint8_t RIODOORBELL_setHandler(RioDoorbell_t *doorbell, const uint16_t infoMin, const uint16_t infoMax,
+                               RioDoorbellHandler_t handler, void *context)
+{
+  uint8_t returnValue;
+  RioDoorbellRange_t *range;
+
+
+  ASSERT(doorbell != NULL, "Invalid doorbell pointer");
+  ASSERT(infoMin <= infoMax, "Invalid info range");
+
+  /* Check if there are any unused ranges. */
+  if(doorbell->ranges < RIODOORBELL_RANGES_MAX)
+  {
+    /* There is an unused range. */
+    range = &doorbell->range[doorbell->ranges];
+    range->infoMin = infoMin;
+    range->infoMax = infoMax;
+    range->handler = handler;
+    range->context = context;
+    doorbell->ranges++;
+    returnValue = 1u;
+  }
+  else
+  {
+    /* All ranges are used. */
+    returnValue = 0u;
+  }
+
+  return returnValue;
+}
+
+
+void RIODOORBELL_setUnhandled(RioDoorbell_t *doorbell, RioDoorbellHandler_t handler, void *context)
+{
+  ASSERT(doorbell != NULL, "Invalid doorbell pointer");
+  doorbell->unhandled = handler;
+  doorbell->unhandledContext = context;
+}
+
+
+void RIODOORBELL_attach(RioDoorbell_t *doorbell, RioStack_t *stack)
+{
+  ASSERT(doorbell != NULL, "Invalid doorbell pointer");
+  RIOSTACK_setInboundHandler(stack, RIOPACKET_FTYPE_DOORBELL, inboundHandler, doorbell);
+}
+
+
+uint8_t RIODOORBELL_receive(RioDoorbell_t *doorbell, const RioPacket_t *packet, const uint32_t time)
+{
+  uint8_t returnValue;
+  uint16_t destination;
+  uint16_t source;
+  uint8_t tid;
+  uint16_t info;
+  RioDoorbellEvent_t *event;
+  RioDoorbellResponse_t *response;
+
+
+  ASSERT(doorbell != NULL, "Invalid doorbell pointer");
+
+  RIOPACKET_getDoorbell(packet, &destination, &source, &tid, &info);
+
+  /* Find an event to coalesce the doorbell into. */
+  if(doorbell->coalesceWindow != 0ul)
+  {
+    event = findEvent(doorbell, source, info, time);
+  }
+  else
+  {
+    event = NULL;
+  }
+
+  /* Every doorbell must be responded to, check that there is room for both the 
+     response and, if not coalesced, a new event. */
+  if((doorbell->responsesLength < doorbell->responsesSize) &&
+     ((event != NULL) || (doorbell->eventsLength < doorbell->eventsSize)))
+  {
+    /* There is room for the doorbell. */
+
+    if(event != NULL)
+    {
+      /* Coalesce into the found event. */
+      event->tid = tid;
+      if(event->count != 0xffffu)
+      {
+        event->count++;
+      }
+      else
+      {
+        /* Saturate the counter. */
+      }
+      doorbell->statusCoalesced++;
+    }
+    else
+    {
+      /* Create a new event. */
+      event = &doorbell->events[(doorbell->eventsFront + doorbell->eventsLength) % doorbell->eventsSize];
+      event->source = source;
+      event->info = info;
+      event->tid = tid;
+      event->count = 1u;
+      event->time = time;
+      doorbell->eventsLength++;
+    }
+
+    response = &doorbell->responses[(doorbell->responsesFront + doorbell->responsesLength) % 
+                                    doorbell->responsesSize];
+    response->destination = source;
+    response->source = destination;
+    response->tid = tid;
+    doorbell->responsesLength++;
+
+    doorbell->statusReceived++;
+    returnValue = 1u;
+  }
+  else
+  {
+    /* The queues are full. */
+    doorbell->statusOverflow++;
+    returnValue = 0u;
+  }
+
+  return returnValue;
+}
+
+
+uint16_t RIODOORBELL_getEventQueueLength(const RioDoorbell_t *doorbell)
+{
+  ASSERT(doorbell != NULL, "Invalid doorbell pointer");
+  return doorbell->eventsLength;
+}
+
+
+uint16_t RIODOORBELL_getResponseQueueLength(const RioDoorbell_t *doorbell)
+{
+  ASSERT(doorbell != NULL, "Invalid doorbell pointer");
+  return doorbell->responsesLength;
+}
+
+
+void RIODOORBELL_getEvent(RioDoorbell_t *doorbell, RioDoorbellEvent_t *event)
+{
+  ASSERT(doorbell != NULL, "Invalid doorbell pointer");
+
+  if(doorbell->eventsLength > 0u)
+  {
+    *event = doorbell->events[doorbell->eventsFront];
+    doorbell->eventsFront = (uint16_t) ((doorbell->eventsFront + 1u) % doorbell->eventsSize);
+    doorbell->eventsLength--;
+  }
+  else
+  {
+    ASSERT0("Reading from empty doorbell event queue.");
+  }
+}
+
+
+uint16_t RIODOORBELL_process(RioDoorbell_t *doorbell, const uint16_t maxEvents)
+{
+  RioDoorbellEvent_t event;
+  RioDoorbellHandler_t handler;
+  void *context;
+  uint16_t processed;
+  uint8_t i;
+
+
+  ASSERT(doorbell != NULL, "Invalid doorbell pointer");
+
+  processed = 0u;
+  while((processed < maxEvents) && (doorbell->eventsLength > 0u))
+  {
+    RIODOORBELL_getEvent(doorbell, &event);
+
+    /* Find the range the event belongs to. */
+    handler = doorbell->unhandled;
+    context = doorbell->unhandledContext;
+    for(i = 0u; i < doorbell->ranges; i++)
+    {
+      if((event.info >= doorbell->range[i].infoMin) && (event.info <= doorbell->range[i].infoMax))
+      {
+        handler = doorbell->range[i].handler;
+        context = doorbell->range[i].context;
+        break;
+      }
+      else
+      {
+        /* Not in this range. */
+      }
+    }
+
+    if(handler != NULL)
+    {
+      handler(context, &event);
+    }
+    else
+    {
+      /* Discard the event. */
+    }
+    processed++;
+  }
+
+  return processed;
+}
+
+
+uint16_t RIODOORBELL_sendResponses(RioDoorbell_t *doorbell, RioStack_t *stack)
+{
+  RioPacket_t packet;
+  RioDoorbellResponse_t *response;
+  uint16_t sent;
+
+
+  ASSERT(doorbell != NULL, "Invalid doorbell pointer");
+
+  sent = 0u;
+  while((doorbell->responsesLength > 0u) && (RIOSTACK_getOutboundQueueAvailable(stack) > 0u))
+  {
+    response = &doorbell->responses[doorbell->responsesFront];
+    RIOPACKET_setResponseNoPayload(&packet, response->destination, response->source, 
+                                   response->tid, RIOPACKET_RESPONSE_STATUS_DONE);
+    RIOSTACK_setOutboundPacket(stack, &packet);
+
+    doorbell->responsesFront = (uint16_t) ((doorbell->responsesFront + 1u) % doorbell->responsesSize);
+    doorbell->responsesLength--;
+    sent++;
+  }
+
+  return sent;
+}
+
+
+/*******************************************************************************
+ * Local functions
+ *******************************************************************************/
+
+static uint8_t inboundHandler(void *context, RioStack_t *stack, const RioPacket_t *packet)
+{
+  uint8_t returnValue;
+
+
+  /* Doorbells with other deviceId sizes are left in the inbound queue. */
+  if(RIOPACKET_getTt(packet) == (uint8_t) RIOPACKET_TT_16BITS)
+  {
+    returnValue = RIODOORBELL_receive((RioDoorbell_t *) context, packet, stack->portTime);
+  }
+  else
+  {
+    returnValue = 0u;
+  }
+
+  return returnValue;
+}
+
+
+static RioDoorbellEvent_t *findEvent(RioDoorbell_t *doorbell, 
+                                     const uint16_t source, const uint16_t info, const uint32_t time)
+{
+  RioDoorbellEvent_t *event;
+  RioDoorbellEvent_t *found;
+  uint16_t i;
+
+
+  /* Search from the newest event since the events are ordered by their time and 
+     no older event can be within the window once one event is outside it. */
+  found = NULL;
+  i = doorbell->eventsLength;
+  while((found == NULL) && (i > 0u))
+  {
+    i--;
+    event = &doorbell->events[(doorbell->eventsFront + i) % doorbell->eventsSize];
+    if((time - event->time) >= doorbell->coalesceWindow)
+    {
+      /* Outside the window. */
+      break;
+    }
+    else if((event->source == source) && (event->info == info))
+    {
+      found = event;
+    }
+    else
+    {
+      /* Not the same doorbell. */
+    }
+  }
+
+  return found;
+}
+
+/*************************** end of file **************************************/
@@ -0,0 +1,282 @@
+/******************************************************************************
+ * (C) Copyright 2013-2015 Magnus Rosenius and the Free Software Foundation.
+ *
+ * This file is part of OpenRIO.
+ *
+ * OpenRIO is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenRIO is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Lesser Public License
+ * along with OpenRIO.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+/******************************************************************************
+ * Description:
+ * This file contains an event queue for received DOORBELL packets.
+ *
+ * Doorbells are taken directly from the receiver of a stack as soon as they
+ * have been received and are stored as compact events containing the source,
+ * info and tid fields. The inbound packet queue of the stack is then only used
+ * for other packets and a burst of doorbells does not consume the buffers
+ * needed for data traffic.
+ *
+ * Every received doorbell is answered with a RESPONSE with status DONE. The
+ * responses are kept in a separate queue and are sent in batches when there is
+ * room in the outbound queue of the stack. If the event queue or the response
+ * queue is full, the doorbell is placed in the inbound queue of the stack as
+ * any other packet.
+ *
+ * Doorbells with the same source and info field received within a configurable
+ * time window can optionally be coalesced into one event. The event then
+ * contains the number of doorbells it represents.
+ *
+ * The events are forwarded to handlers registered for ranges of the info
+ * field.
+ *
+ * Typical usage:
+ *   RIODOORBELL_open(&doorbell, EVENTS, events, RESPONSES, responses);
+ *   RIODOORBELL_setCoalescing(&doorbell, 100);
+ *   RIODOORBELL_setHandler(&doorbell, 0x0000, 0x00ff, interruptHandler, &device);
+ *   RIODOORBELL_attach(&doorbell, &stack);
+ *   ...
+ *   <bottom-half traffic handling>
+ *   (void) RIODOORBELL_process(&doorbell, 8);
+ *   (void) RIODOORBELL_sendResponses(&doorbell, &stack);
+ *
+ * Any application specific tailoring needed to compile properly should be done
+ * in rioconfig.h.
+ ******************************************************************************/
+
+#ifndef __RIODOORBELL_H
+#define __RIODOORBELL_H
+
+/*******************************************************************************
+ * Include files.
+ *******************************************************************************/
+
+#include "rioconfig.h"
+#include "riopacket.h"
+#include "riostack.h"
+
+
+/*******************************************************************************
+ * Global macros.
+ *******************************************************************************/
+
+/** The maximum number of info ranges that can be registered. */
+#ifndef RIODOORBELL_RANGES_MAX
+#define RIODOORBELL_RANGES_MAX 8u
+#endif
+
+
+/*******************************************************************************
+ * Global typedefs.
+ *******************************************************************************/
+
+/** A received doorbell. */
+typedef struct
+{
+  uint16_t source; /**< The source deviceId of the doorbell. */
+  uint16_t info; /**< The info field of the doorbell. */
+  uint8_t tid; /**< The transaction identifier of the latest received doorbell. */
+  uint16_t count; /**< The number of doorbells this event represents. */
+  uint32_t time; /**< The time when the first doorbell was received. */
+} RioDoorbellEvent_t;
+
+/** A response that is waiting to be sent. */
+/** \internal Note that this structure is for internal usage only. */
+typedef struct
+{
+  uint16_t destination; /**< The source deviceId of the doorbell. */
+  uint16_t source; /**< The destination deviceId of the doorbell. */
+  uint8_t tid; /**< The transaction identifier of the doorbell. */
+} RioDoorbellResponse_t;
+
+/**
+ * \brief A doorbell event handler.
+ *
+ * \param[in] context The context pointer given when the handler was registered.
+ * \param[in] event The doorbell event.
+ */
+typedef void (*RioDoorbellHandler_t)(void *context, const RioDoorbellEvent_t *event);
+
+/** A registered info range handler. */
+/** \internal Note that this structure is for internal usage only. */
+typedef struct
+{
+  uint16_t infoMin; /**< The lowest info value that is handled. */
+  uint16_t infoMax; /**< The highest info value that is handled. */
+  RioDoorbellHandler_t handler; /**< The function to call. */
+  void *context; /**< The context to call the handler with. */
+} RioDoorbellRange_t;
+
+/** The structure to keep all the doorbell variables. */
+typedef struct
+{
+  RioDoorbellEvent_t *events; /**< The storage of the event queue. */
+  uint16_t eventsSize; /**< The number of events that fits in the event queue. */
+  uint16_t eventsFront; /**< The index of the oldest event. */
+  uint16_t eventsLength; /**< The number of events in the event queue. */
+
+  RioDoorbellResponse_t *responses; /**< The storage of the response queue. */
+  uint16_t responsesSize; /**< The number of responses that fits in the response queue. */
+  uint16_t responsesFront; /**< The index of the oldest response. */
+  uint16_t responsesLength; /**< The number of responses in the response queue. */
+
+  uint32_t coalesceWindow; /**< The time to coalesce doorbells within, zero to not coalesce. */
+
+  RioDoorbellRange_t range[RIODOORBELL_RANGES_MAX]; /**< Handlers for info ranges. */
+  uint8_t ranges; /**< The number of used info ranges. */
+  RioDoorbellHandler_t unhandled; /**< The handler for events outside all ranges. */
+  void *unhandledContext; /**< The context to call the unhandled handler with. */
+
+  /** The number of doorbells that has been received. */
+  uint32_t statusReceived;
+
+  /** The number of doorbells that has been coalesced into an existing event. */
+  uint32_t statusCoalesced;
+
+  /** The number of doorbells that did not fit and was left in the inbound queue. */
+  uint32_t statusOverflow;
+} RioDoorbell_t;
+
+
+/*******************************************************************************
+ * Global function prototypes.
+ *******************************************************************************/
+
+/**
+ * \brief Open a doorbell event queue for operation.
+ *
+ * \param[in] doorbell The doorbell event queue to operate on.
+ * \param[in] eventsSize The number of events in the events storage.
+ * \param[in] events The storage to use for events.
+ * \param[in] responsesSize The number of responses in the responses storage.
+ * \param[in] responses The storage to use for pending responses.
+ *
+ * This function empties the queues, removes all handlers and turns off
+ * coalescing.
+ */
+void RIODOORBELL_open(RioDoorbell_t *doorbell,
+                      const uint16_t eventsSize, RioDoorbellEvent_t *events,
+                      const uint16_t responsesSize, RioDoorbellResponse_t *responses);
+
+/**
+ * \brief Set the coalescing time window.
+ *
+ * \param[in] doorbell The doorbell event queue to operate on.
+ * \param[in] window The time window to use, in the same unit as RIOSTACK_portSetTime().
+ * Zero turns off coalescing.
+ *
+ * A doorbell with the same source and info as a queued event that was first
+ * received less than window time units ago is merged into that event instead
+ * of creating a new one. The doorbell is still responded to.
+ */
+void RIODOORBELL_setCoalescing(RioDoorbell_t *doorbell, const uint32_t window);
+
+/**
+ * \brief Register a handler for a range of info values.
+ *
+ * \param[in] doorbell The doorbell event queue to operate on.
+ * \param[in] infoMin The lowest info value to handle.
+ * \param[in] infoMax The highest info value to handle.
+ * \param[in] handler The function to call.
+ * \param[in] context The context to call the handler with.
+ * \return Non-zero if the range was registered, zero if all ranges are used.
+ *
+ * The ranges are checked in the order they were registered and the first
+ * matching range is used.
+ */
+uint8_t RIODOORBELL_setHandler(RioDoorbell_t *doorbell, const uint16_t infoMin, const uint16_t infoMax,
+                               RioDoorbellHandler_t handler, void *context);
+
+/**
+ * \brief Register a handler for events outside all info ranges.
+ *
+ * \param[in] doorbell The doorbell event queue to operate on.
+ * \param[in] handler The function to call. Use NULL to silently discard such events.
+ * \param[in] context The context to call the handler with.
+ */
+void RIODOORBELL_setUnhandled(RioDoorbell_t *doorbell, RioDoorbellHandler_t handler, void *context);
+
+/**
+ * \brief Start receiving doorbells from a stack.
+ *
+ * \param[in] doorbell The doorbell event queue to operate on.
+ * \param[in] stack The stack to receive doorbells from.
+ *
+ * This function registers the doorbell event queue as the inbound handler of 
+ * DOORBELL packets in the stack.
+ */
+void RIODOORBELL_attach(RioDoorbell_t *doorbell, RioStack_t *stack);
+
+/**
+ * \brief Add a received doorbell to the event queue.
+ *
+ * \param[in] doorbell The doorbell event queue to operate on.
+ * \param[in] packet The received DOORBELL packet.
+ * \param[in] time The current time.
+ * \return Non-zero if the doorbell was queued, zero if the queues are full.
+ *
+ * This function is called by the stack when RIODOORBELL_attach() has been used
+ * but can also be used to add doorbells received from other sources.
+ */
+uint8_t RIODOORBELL_receive(RioDoorbell_t *doorbell, const RioPacket_t *packet, const uint32_t time);
+
+/**
+ * \brief Get the number of events in the event queue.
+ *
+ * \param[in] doorbell The doorbell event queue to operate on.
+ * \return The number of events that are waiting to be processed.
+ */
+uint16_t RIODOORBELL_getEventQueueLength(const RioDoorbell_t *doorbell);
+
+/**
+ * \brief Get the number of responses waiting to be sent.
+ *
+ * \param[in] doorbell The doorbell event queue to operate on.
+ * \return The number of responses that are waiting to be sent.
+ */
+uint16_t RIODOORBELL_getResponseQueueLength(const RioDoorbell_t *doorbell);
+
+/**
+ * \brief Get the oldest event from the event queue.
+ *
+ * \param[in] doorbell The doorbell event queue to operate on.
+ * \param[out] event The oldest event.
+ *
+ * \note Calling this function when the event queue is empty will raise an assert.
+ */
+void RIODOORBELL_getEvent(RioDoorbell_t *doorbell, RioDoorbellEvent_t *event);
+
+/**
+ * \brief Forward events to their handlers.
+ *
+ * \param[in] doorbell The doorbell event queue to operate on.
+ * \param[in] maxEvents The maximum number of events to process.
+ * \return The number of events that was processed.
+ */
+uint16_t RIODOORBELL_process(RioDoorbell_t *doorbell, const uint16_t maxEvents);
+
+/**
+ * \brief Send pending responses.
+ *
+ * \param[in] doorbell The doorbell event queue to operate on.
+ * \param[in] stack The stack to send the responses on.
+ * \return The number of responses that was sent.
+ *
+ * This function places as many pending responses as fits in the outbound queue
+ * of the stack.
+ */
+uint16_t RIODOORBELL_sendResponses(RioDoorbell_t *doorbell, RioStack_t *stack);
+
+#endif /* __RIODOORBELL_H */
+
+/*************************** end of file **************************************/
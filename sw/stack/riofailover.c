@@ -0,0 +1,190 @@
+/******************************************************************************
+ * (C) Copyright 2013-2015 Magnus Rosenius and the Free Software Foundation.
+ *
+ * This file is part of OpenRIO.
+ *
+ * OpenRIO is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenRIO is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Lesser Public License
+ * along with OpenRIO.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+
+/******************************************************************************
+ * Description:
+ * This file contains a failover manager for a stack with a hot standby stack.
+ * See riofailover.h for more info.
+ *
+ * Any application specific tailoring needed to compile properly should be done
+ * in rioconfig.h.
+ ******************************************************************************/
+
+/*******************************************************************************
+ * Includes
+ *******************************************************************************/
+
+#include "riofailover.h"
+
+/* Get definitions of ASSERT(), assumed to not return. */
+#include "rioconfig.h"
+
+
+/*******************************************************************************
+ * Global functions
+ *******************************************************************************/
+
+void RIOFAILOVER_open(RioFailover_t *failover, RioStack_t *primary, RioStack_t *standby)
+{
+  ASSERT(failover != NULL, "Invalid failover pointer");
+  ASSERT((primary != NULL) && (standby != NULL), "Invalid stack pointer");
+  ASSERT(primary != standby, "The same stack cannot be used twice");
+
+  failover->stack[0] = primary;
+  failover->stack[1] = standby;
+  failover->active = 0u;
+  failover->moving = 0u;
+
+  failover->statusFailovers = 0ul;
+  failover->statusPacketsMoved = 0ul;
+  failover->statusPacketsResent = 0ul;
+}
+
+
+RioStack_t *RIOFAILOVER_getActive(const RioFailover_t *failover)
+{
+  return failover->stack[failover->active];
+}
+
+
+uint8_t RIOFAILOVER_getMoving(const RioFailover_t *failover)
+{
+  return failover->moving;
+}
+
+
+uint32_t RIOFAILOVER_process(RioFailover_t *failover)
+{
+  RioPacket_t packet;
+  RioStack_t *failed;
+  RioStack_t *active;
+  uint32_t moved;
+
+
+  ASSERT(failover != NULL, "Invalid failover pointer");
+
+  /* Switch to the standby stack if the port of the active stack is down. */
+  if((!failover->moving) &&
+     (!RIOSTACK_portGetStatus(failover->stack[failover->active])) &&
+     RIOSTACK_getLinkIsInitialized(failover->stack[failover->active ^ 1u]))
+  {
+    failover->active ^= 1u;
+    failover->moving = 1u;
+    failover->statusFailovers++;
+  }
+  else
+  {
+    /* Don't do anything. */
+  }
+
+  moved = 0ul;
+  if(failover->moving)
+  {
+    /* Move the packets of the failed stack in the order they were sent, the
+       unacknowledged ones are returned first. */
+    failed = failover->stack[failover->active ^ 1u];
+    active = failover->stack[failover->active];
+    while((!RIOSTACK_portGetStatus(failed)) &&
+          (RIOSTACK_getOutboundQueueLength(failed) > 0u) &&
+          (RIOSTACK_getOutboundQueueAvailable(active) > 0u))
+    {
+      if(RIOSTACK_getOutboundPacket(failed, &packet))
+      {
+        failover->statusPacketsResent++;
+      }
+      else
+      {
+        /* Don't do anything. */
+      }
+      RIOSTACK_setOutboundPacket(active, &packet);
+      moved++;
+    }
+    failover->statusPacketsMoved += moved;
+
+    /* New packets are accepted when all the old have left the failed stack. */
+    if(RIOSTACK_getOutboundQueueLength(failed) == 0u)
+    {
+      failover->moving = 0u;
+    }
+    else
+    {
+      /* Don't do anything. */
+    }
+  }
+  else
+  {
+    /* Don't do anything. */
+  }
+
+  return moved;
+}
+
+
+uint8_t RIOFAILOVER_setOutboundPacket(RioFailover_t *failover, RioPacket_t *packet)
+{
+  uint8_t returnValue;
+  RioStack_t *active;
+
+
+  ASSERT(failover != NULL, "Invalid failover pointer");
+
+  active = failover->stack[failover->active];
+  if((!failover->moving) && RIOSTACK_portGetStatus(active) &&
+     (RIOSTACK_getOutboundQueueAvailable(active) > 0u))
+  {
+    RIOSTACK_setOutboundPacket(active, packet);
+    returnValue = 1u;
+  }
+  else
+  {
+    returnValue = 0u;
+  }
+
+  return returnValue;
+}
+
+
+uint16_t RIOFAILOVER_getInboundQueueLength(const RioFailover_t *failover)
+{
+  return (uint16_t) RIOSTACK_getInboundQueueLength(failover->stack[0]) +
+    (uint16_t) RIOSTACK_getInboundQueueLength(failover->stack[1]);
+}
+
+
+void RIOFAILOVER_getInboundPacket(RioFailover_t *failover, RioPacket_t *packet)
+{
+  RioStack_t *standby;
+
+
+  ASSERT(failover != NULL, "Invalid failover pointer");
+
+  /* Packets on the stack that is not active were received before the failover. */
+  standby = failover->stack[failover->active ^ 1u];
+  if(RIOSTACK_getInboundQueueLength(standby) > 0u)
+  {
+    RIOSTACK_getInboundPacket(standby, packet);
+  }
+  else
+  {
+    RIOSTACK_getInboundPacket(failover->stack[failover->active], packet);
+  }
+}
+
+/*************************** end of file **************************************/
@@ -0,0 +1,178 @@
+/******************************************************************************
+ * (C) Copyright 2013-2015 Magnus Rosenius and the Free Software Foundation.
+ *
+ * This file is part of OpenRIO.
+ *
+ * OpenRIO is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenRIO is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Lesser Public License
+ * along with OpenRIO.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+
+/******************************************************************************
+ * Description:
+ * This file contains a failover manager that uses one stack as the active
+ * link and another stack, connected to the same link partner, as a hot
+ * standby.
+ *
+ * Packets are sent on the active stack only. When the port of the active
+ * stack goes down, see RIOSTACK_portSetStatus(), and the link of the standby
+ * stack is initialized, the standby stack becomes the active stack. The
+ * packets of the failed stack that were transmitted but not acknowledged and
+ * the packets that were not transmitted yet are then moved to the new active
+ * stack in the order they were sent. This way, the packets are recovered in
+ * the time it takes to detect that the port is down instead of after the
+ * response timeouts of the application.
+ *
+ * A packet that was transmitted but not acknowledged may have been received
+ * by the link partner before the link went down, so it may be received twice.
+ * The number of such packets is counted in statusPacketsResent.
+ *
+ * Receiver side: Packets that were received on the failed stack are read
+ * before the packets that are received on the new active stack.
+ *
+ * When the port of the failed stack is initialized again it becomes the
+ * standby stack.
+ *
+ * \note All packets on the stacks must be sent and received through the
+ * failover manager. The port of the failed stack must not be initialized
+ * again until RIOFAILOVER_process() has moved all its packets, see
+ * RIOFAILOVER_getMoving().
+ *
+ * Typical usage:
+ *   RIOFAILOVER_open(&failover, &primaryStack, &standbyStack);
+ *   while(1)
+ *   {
+ *     <run the ports of the stacks>
+ *     RIOFAILOVER_process(&failover);
+ *     if(!RIOFAILOVER_setOutboundPacket(&failover, &packet))
+ *     {
+ *       <the active stack is full, try again later>
+ *     }
+ *     if(RIOFAILOVER_getInboundQueueLength(&failover) > 0)
+ *     {
+ *       RIOFAILOVER_getInboundPacket(&failover, &packet);
+ *     }
+ *   }
+ *
+ * Any application specific tailoring needed to compile properly should be done
+ * in rioconfig.h.
+ ******************************************************************************/
+
+#ifndef __RIOFAILOVER_H
+#define __RIOFAILOVER_H
+
+/*******************************************************************************
+ * Include files.
+ *******************************************************************************/
+
+#include "rioconfig.h"
+#include "riopacket.h"
+#include "riostack.h"
+
+
+/*******************************************************************************
+ * Global typedefs.
+ *******************************************************************************/
+
+/** The structure to keep all the failover variables. */
+typedef struct
+{
+  RioStack_t *stack[2]; /**< The two stacks. */
+  uint8_t active; /**< The index of the active stack. */
+  uint8_t moving; /**< Non-zero while packets are moved from the failed stack. */
+
+  /** The number of times the standby stack has become the active stack. */
+  uint32_t statusFailovers;
+
+  /** The number of packets that has been moved from a failed stack. */
+  uint32_t statusPacketsMoved;
+
+  /** The number of moved packets that had been transmitted but not acknowledged. */
+  uint32_t statusPacketsResent;
+} RioFailover_t;
+
+
+/*******************************************************************************
+ * Global function prototypes.
+ *******************************************************************************/
+
+/**
+ * \brief Open a failover manager.
+ *
+ * \param[in] failover The failover manager to operate on.
+ * \param[in] primary The stack to use as the active stack.
+ * \param[in] standby The stack to use as the standby stack.
+ */
+void RIOFAILOVER_open(RioFailover_t *failover, RioStack_t *primary, RioStack_t *standby);
+
+/**
+ * \brief Get the active stack.
+ *
+ * \param[in] failover The failover manager to operate on.
+ * \return The stack that packets are sent on.
+ */
+RioStack_t *RIOFAILOVER_getActive(const RioFailover_t *failover);
+
+/**
+ * \brief Check if packets are being moved from a failed stack.
+ *
+ * \param[in] failover The failover manager to operate on.
+ * \return Non-zero if the failed stack still has packets to move.
+ */
+uint8_t RIOFAILOVER_getMoving(const RioFailover_t *failover);
+
+/**
+ * \brief Check for a failed active stack and move its packets.
+ *
+ * \param[in] failover The failover manager to operate on.
+ * \return The number of packets that was moved.
+ *
+ * This function should be called regularly, for example after the ports of
+ * the stacks have been run. Packets are moved as long as there is room in the
+ * outbound queue of the new active stack, remaining packets are moved by later
+ * calls.
+ */
+uint32_t RIOFAILOVER_process(RioFailover_t *failover);
+
+/**
+ * \brief Add a packet to the outbound queue of the active stack.
+ *
+ * \param[in] failover The failover manager to operate on.
+ * \param[in] packet The packet to send.
+ * \return Non-zero if the packet was queued, zero if the active stack is full,
+ * its port is down or packets are still being moved to it.
+ */
+uint8_t RIOFAILOVER_setOutboundPacket(RioFailover_t *failover, RioPacket_t *packet);
+
+/**
+ * \brief Get the number of received packets.
+ *
+ * \param[in] failover The failover manager to operate on.
+ * \return The number of packets in the inbound queues of both stacks.
+ */
+uint16_t RIOFAILOVER_getInboundQueueLength(const RioFailover_t *failover);
+
+/**
+ * \brief Get, remove and return a received packet.
+ *
+ * \param[in] failover The failover manager to operate on.
+ * \param[out] packet The packet to receive to.
+ *
+ * Packets in the inbound queue of the stack that is not active are read
+ * first since they were received before the failover.
+ */
+void RIOFAILOVER_getInboundPacket(RioFailover_t *failover, RioPacket_t *packet);
+
+#endif
+
+/*************************** end of file **************************************/
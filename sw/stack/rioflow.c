@@ -0,0 +1,479 @@
+/******************************************************************************
+ * (C) Copyright 2013-2015 Magnus Rosenius and the Free Software Foundation.
+ *
+ * This file is part of OpenRIO.
+ *
+ * OpenRIO is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenRIO is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Lesser Public License
+ * along with OpenRIO.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+
+/******************************************************************************
+ * Description:
+ * This file contains end-to-end flow control using flow control packets.
+ * See rioflow.h for more info.
+ *
+ * Any application specific tailoring needed to compile properly should be done
+ * in rioconfig.h.
+ ******************************************************************************/
+
+/*******************************************************************************
+ * Includes
+ *******************************************************************************/
+
+#include "rioflow.h"
+
+/* Get definitions of ASSERT(), assumed to not return. */
+#include "rioconfig.h"
+
+
+/*******************************************************************************
+ * Local function prototypes
+ *******************************************************************************/
+
+/**
+ * \brief The inbound handler registered in the stack.
+ *
+ * \param[in] context The flow control.
+ * \param[in] stack The stack the packet was received on.
+ * \param[in] packet The received packet.
+ * \return Non-zero if the packet was consumed.
+ */
+static uint8_t inboundHandler(void *context, RioStack_t *stack, const RioPacket_t *packet);
+
+/**
+ * \brief The congestion handler registered in the stack.
+ *
+ * \param[in] context The flow control.
+ * \param[in] stack The congested stack.
+ * \param[in] congested Non-zero if the inbound queue is congested.
+ * \param[in] packet The packet that was received while congested.
+ */
+static void congestionHandler(void *context, RioStack_t *stack, 
+                              const uint8_t congested, const RioPacket_t *packet);
+
+/**
+ * \brief Find a stopped flow.
+ *
+ * \param[in] flow The flow control to operate on.
+ * \param[in] destination The destination of the flow.
+ * \param[in] flowId The flow.
+ * \return The index of the flow or blockedLength if it is not stopped.
+ */
+static uint16_t findBlocked(const RioFlow_t *flow, const uint16_t destination, const uint8_t flowId);
+
+/**
+ * \brief Remove a stopped flow.
+ *
+ * \param[in] flow The flow control to operate on.
+ * \param[in] index The index of the flow.
+ */
+static void removeBlocked(RioFlow_t *flow, const uint16_t index);
+
+/**
+ * \brief Send pending XOFF and XON packets.
+ *
+ * \param[in] flow The flow control to operate on.
+ * \param[in] stack The stack to send on.
+ */
+static void sendFlowControl(RioFlow_t *flow, RioStack_t *stack);
+
+
+/*******************************************************************************
+ * Global functions
+ *******************************************************************************/
+
+void RIOFLOW_open(RioFlow_t *flow, const uint16_t deviceId,
+                  const uint16_t sourcesSize, RioFlowSource_t *sources,
+                  const uint16_t blockedSize, RioFlowBlocked_t *blocked,
+                  RioPool_t *pool, const uint16_t pendingSize, RioPoolHandle_t *pending)
+{
+  ASSERT(flow != NULL, "Invalid flow pointer");
+  ASSERT((sourcesSize == 0u) || (sources != NULL), "Invalid sources pointer");
+  ASSERT((blockedSize == 0u) || (blocked != NULL), "Invalid blocked pointer");
+  ASSERT((pendingSize == 0u) || ((pending != NULL) && (pool != NULL)), "Invalid pending pointer");
+
+  flow->deviceId = deviceId;
+
+  flow->sources = sources;
+  flow->sourcesSize = sourcesSize;
+  flow->sourcesLength = 0u;
+
+  flow->blocked = blocked;
+  flow->blockedSize = blockedSize;
+  flow->blockedLength = 0u;
+  flow->timeout = 0ul;
+
+  flow->pool = pool;
+  flow->pending = pending;
+  flow->pendingSize = pendingSize;
+  flow->pendingLength = 0u;
+
+  flow->statusXoffSent = 0ul;
+  flow->statusXonSent = 0ul;
+  flow->statusXoffReceived = 0ul;
+  flow->statusXonReceived = 0ul;
+  flow->statusXoffTimeout = 0ul;
+  flow->statusOverflow = 0ul;
+}
+
+
+void RIOFLOW_setTimeout(RioFlow_t *flow, const uint32_t timeout)
+{
+  ASSERT(flow != NULL, "Invalid flow pointer");
+  flow->timeout = timeout;
+}
+
+
+void RIOFLOW_attach(RioFlow_t *flow, RioStack_t *stack, const uint8_t xoffLevel, const uint8_t xonLevel)
+{
+  ASSERT(flow != NULL, "Invalid flow pointer");
+  RIOSTACK_setInboundHandler(stack, RIOPACKET_FTYPE_FLOW_CONTROL, inboundHandler, flow);
+  RIOSTACK_setCongestionHandler(stack, xoffLevel, xonLevel, congestionHandler, flow);
+}
+
+
+uint8_t RIOFLOW_receive(RioFlow_t *flow, const RioPacket_t *packet, const uint32_t time)
+{
+  uint8_t returnValue;
+  uint16_t dstId;
+  uint16_t srcId;
+  uint8_t xon;
+  uint8_t flowId;
+  uint16_t tgtdestId;
+  uint16_t index;
+
+
+  ASSERT(flow != NULL, "Invalid flow pointer");
+
+  if((RIOPACKET_getFtype(packet) == (uint8_t) RIOPACKET_FTYPE_FLOW_CONTROL) &&
+     (RIOPACKET_getTt(packet) == (uint8_t) RIOPACKET_TT_16BITS))
+  {
+    RIOPACKET_getFlowControl(packet, &dstId, &srcId, &xon, &flowId, &tgtdestId);
+    index = findBlocked(flow, tgtdestId, flowId);
+    if(xon == 0u)
+    {
+      /* XOFF, stop the flow or restart the timeout if it is already stopped. */
+      flow->statusXoffReceived++;
+      if(index < flow->blockedLength)
+      {
+        flow->blocked[index].time = time;
+      }
+      else if(flow->blockedLength < flow->blockedSize)
+      {
+        flow->blocked[flow->blockedLength].destination = tgtdestId;
+        flow->blocked[flow->blockedLength].flowId = flowId;
+        flow->blocked[flow->blockedLength].time = time;
+        flow->blockedLength++;
+      }
+      else
+      {
+        /* No room to remember the flow, it cannot be stopped. */
+        flow->statusOverflow++;
+      }
+    }
+    else
+    {
+      /* XON, resume the flow. */
+      flow->statusXonReceived++;
+      if(index < flow->blockedLength)
+      {
+        removeBlocked(flow, index);
+      }
+      else
+      {
+        /* The flow was not stopped. */
+      }
+    }
+    returnValue = 1u;
+  }
+  else
+  {
+    /* Not a flow control packet. */
+    returnValue = 0u;
+  }
+
+  return returnValue;
+}
+
+
+uint8_t RIOFLOW_isBlocked(const RioFlow_t *flow, const uint16_t destination, const uint8_t flowId)
+{
+  uint8_t returnValue;
+  uint16_t i;
+
+
+  ASSERT(flow != NULL, "Invalid flow pointer");
+
+  /* An XOFF stops the flow and all lower flows to the same destination. */
+  returnValue = 0u;
+  for(i = 0u; (returnValue == 0u) && (i < flow->blockedLength); i++)
+  {
+    if((flow->blocked[i].destination == destination) && (flow->blocked[i].flowId >= flowId))
+    {
+      returnValue = 1u;
+    }
+    else
+    {
+      /* Not stopped by this XOFF. */
+    }
+  }
+
+  return returnValue;
+}
+
+
+uint8_t RIOFLOW_setOutboundPacketHandle(RioFlow_t *flow, const RioPoolHandle_t handle)
+{
+  uint8_t returnValue;
+
+
+  ASSERT(flow != NULL, "Invalid flow pointer");
+
+  if(flow->pendingLength < flow->pendingSize)
+  {
+    flow->pending[flow->pendingLength] = handle;
+    flow->pendingLength++;
+    returnValue = 1u;
+  }
+  else
+  {
+    /* The pending queue is full. */
+    returnValue = 0u;
+  }
+
+  return returnValue;
+}
+
+
+uint16_t RIOFLOW_getPendingQueueLength(const RioFlow_t *flow)
+{
+  ASSERT(flow != NULL, "Invalid flow pointer");
+  return flow->pendingLength;
+}
+
+
+uint16_t RIOFLOW_transmit(RioFlow_t *flow, RioStack_t *stack)
+{
+  RioPacket_t *packet;
+  uint16_t i;
+  uint16_t kept;
+  uint16_t moved;
+
+
+  ASSERT(flow != NULL, "Invalid flow pointer");
+
+  /* Flow control packets has the highest priority. */
+  sendFlowControl(flow, stack);
+
+  /* Resume flows where the XON seems to have been lost. */
+  if(flow->timeout != 0ul)
+  {
+    i = 0u;
+    while(i < flow->blockedLength)
+    {
+      if((stack->portTime - flow->blocked[i].time) >= flow->timeout)
+      {
+        flow->statusXoffTimeout++;
+        removeBlocked(flow, i);
+      }
+      else
+      {
+        i++;
+      }
+    }
+  }
+  else
+  {
+    /* Wait forever for XON. */
+  }
+
+  /* Move the packets of flows that are not stopped and compact the pending queue. 
+     The packets that are kept stay in the same order. */
+  kept = 0u;
+  moved = 0u;
+  for(i = 0u; i < flow->pendingLength; i++)
+  {
+    packet = RIOPOOL_getPacket(flow->pool, flow->pending[i]);
+    if((RIOSTACK_getOutboundQueueAvailable(stack) > 0u) &&
+       (RIOFLOW_isBlocked(flow, RIOPACKET_getDestination(packet), RIOPACKET_getPriority(packet)) == 0u))
+    {
+      RIOSTACK_setOutboundPacketHandle(stack, flow->pool, flow->pending[i]);
+      moved++;
+    }
+    else
+    {
+      flow->pending[kept] = flow->pending[i];
+      kept++;
+    }
+  }
+  flow->pendingLength = kept;
+
+  return moved;
+}
+
+
+/*******************************************************************************
+ * Local functions
+ *******************************************************************************/
+
+static uint8_t inboundHandler(void *context, RioStack_t *stack, const RioPacket_t *packet)
+{
+  return RIOFLOW_receive((RioFlow_t *) context, packet, stack->portTime);
+}
+
+
+static void congestionHandler(void *context, RioStack_t *stack, 
+                              const uint8_t congested, const RioPacket_t *packet)
+{
+  RioFlow_t *flow;
+  RioFlowSource_t *source;
+  uint16_t srcId;
+  uint8_t flowId;
+  uint8_t found;
+  uint16_t i;
+
+
+  (void) stack;
+  flow = (RioFlow_t *) context;
+
+  /* The sources are changed here and in sendFlowControl() without locking, the 
+     stack and the flow control are used from the same context. */
+  if(congested != 0u)
+  {
+    /* Stop the source of the packet unless it has already been stopped. */
+    srcId = RIOPACKET_getSource(packet);
+    flowId = RIOPACKET_getPriority(packet);
+    found = 0u;
+    for(i = 0u; (found == 0u) && (i < flow->sourcesLength); i++)
+    {
+      source = &flow->sources[i];
+      if((source->source == srcId) && (source->flowId == flowId))
+      {
+        /* Make sure an XON that has not been sent yet is not sent. */
+        source->state = (source->state == RIOFLOW_SOURCE_XON_PENDING) ? 
+          RIOFLOW_SOURCE_XOFF_SENT : source->state;
+        found = 1u;
+      }
+      else
+      {
+        /* Not this source. */
+      }
+    }
+
+    if(found == 0u)
+    {
+      if(flow->sourcesLength < flow->sourcesSize)
+      {
+        source = &flow->sources[flow->sourcesLength];
+        source->source = srcId;
+        source->flowId = flowId;
+        source->state = RIOFLOW_SOURCE_XOFF_PENDING;
+        flow->sourcesLength++;
+      }
+      else
+      {
+        /* No room, the link partner has to retry packets from this source. */
+        flow->statusOverflow++;
+      }
+    }
+    else
+    {
+      /* Don't do anything. */
+    }
+  }
+  else
+  {
+    /* Resume all sources. Sources that has not been sent an XOFF yet are forgotten. */
+    i = 0u;
+    while(i < flow->sourcesLength)
+    {
+      if(flow->sources[i].state == RIOFLOW_SOURCE_XOFF_PENDING)
+      {
+        flow->sourcesLength--;
+        flow->sources[i] = flow->sources[flow->sourcesLength];
+      }
+      else
+      {
+        flow->sources[i].state = RIOFLOW_SOURCE_XON_PENDING;
+        i++;
+      }
+    }
+  }
+}
+
+
+static uint16_t findBlocked(const RioFlow_t *flow, const uint16_t destination, const uint8_t flowId)
+{
+  uint16_t i;
+
+
+  for(i = 0u; i < flow->blockedLength; i++)
+  {
+    if((flow->blocked[i].destination == destination) && (flow->blocked[i].flowId == flowId))
+    {
+      break;
+    }
+    else
+    {
+      /* Not this flow. */
+    }
+  }
+
+  return i;
+}
+
+
+static void removeBlocked(RioFlow_t *flow, const uint16_t index)
+{
+  flow->blockedLength--;
+  flow->blocked[index] = flow->blocked[flow->blockedLength];
+}
+
+
+static void sendFlowControl(RioFlow_t *flow, RioStack_t *stack)
+{
+  RioPacket_t packet;
+  RioFlowSource_t *source;
+  uint16_t i;
+
+
+  i = 0u;
+  while((i < flow->sourcesLength) && (RIOSTACK_getOutboundQueueAvailable(stack) > 0u))
+  {
+    source = &flow->sources[i];
+    if(source->state == RIOFLOW_SOURCE_XOFF_PENDING)
+    {
+      RIOPACKET_setFlowControl(&packet, source->source, flow->deviceId, 0u, source->flowId, flow->deviceId);
+      RIOSTACK_setOutboundPacket(stack, &packet);
+      source->state = RIOFLOW_SOURCE_XOFF_SENT;
+      flow->statusXoffSent++;
+      i++;
+    }
+    else if(source->state == RIOFLOW_SOURCE_XON_PENDING)
+    {
+      RIOPACKET_setFlowControl(&packet, source->source, flow->deviceId, 1u, source->flowId, flow->deviceId);
+      RIOSTACK_setOutboundPacket(stack, &packet);
+      flow->statusXonSent++;
+      flow->sourcesLength--;
+      flow->sources[i] = flow->sources[flow->sourcesLength];
+    }
+    else
+    {
+      /* The XOFF has already been sent. */
+      i++;
+    }
+  }
+}
+
+/*************************** end of file **************************************/
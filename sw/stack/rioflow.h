@@ -0,0 +1,252 @@
+/******************************************************************************
+ * (C) Copyright 2013-2015 Magnus Rosenius and the Free Software Foundation.
+ *
+ * This file is part of OpenRIO.
+ *
+ * OpenRIO is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenRIO is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Lesser Public License
+ * along with OpenRIO.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+
+/******************************************************************************
+ * Description:
+ * This file contains end-to-end flow control using flow control packets (ftype 7).
+ *
+ * When the inbound queue of an endpoint is full, the link partner has to retry 
+ * packets. The retried packets then back up into the switches and block flows 
+ * to other endpoints as well. Flow control instead stops the flows at their 
+ * sources before the inbound queue is full.
+ *
+ * Receiver side: When a packet is placed in the inbound queue of a stack and 
+ * the queue contains more packets than the XOFF level, an XOFF is sent to the 
+ * source of the packet. When the application has read packets so that the 
+ * queue contains no more than the XON level, an XON is sent to all sources 
+ * that has been stopped.
+ *
+ * Transmitter side: Outbound packets are placed in a pending queue instead of 
+ * directly in the outbound queue of the stack. A flow is identified by the 
+ * destination and the priority of its packets. When an XOFF is received, the 
+ * packets of the stopped flow, and of flows to the same destination with lower 
+ * priority, are kept in the pending queue while packets of other flows are 
+ * moved to the stack. The flow is resumed when an XON is received or when the 
+ * XOFF has timed out, in case the XON was lost.
+ *
+ * Typical usage:
+ *   RIOPOOL_open(&pool, POOL_SIZE, entries);
+ *   RIOFLOW_open(&flow, deviceId, SOURCES, sources, BLOCKED, blocked, &pool, PENDING, pending);
+ *   RIOFLOW_setTimeout(&flow, 10000);
+ *   RIOFLOW_attach(&flow, &stack, 6, 2);
+ *   ...
+ *   handle = RIOPOOL_allocate(&pool);
+ *   RIOPACKET_setNwrite(RIOPOOL_getPacket(&pool, handle), ...);
+ *   if(!RIOFLOW_setOutboundPacketHandle(&flow, handle))
+ *   {
+ *     <pending queue full, try again later>
+ *   }
+ *   ...
+ *   <bottom-half traffic handling>
+ *   (void) RIOFLOW_transmit(&flow, &stack);
+ *
+ * Any application specific tailoring needed to compile properly should be done
+ * in rioconfig.h.
+ ******************************************************************************/
+
+#ifndef __RIOFLOW_H
+#define __RIOFLOW_H
+
+/*******************************************************************************
+ * Include files.
+ *******************************************************************************/
+
+#include "rioconfig.h"
+#include "riopacket.h"
+#include "riopool.h"
+#include "riostack.h"
+
+
+/*******************************************************************************
+ * Global typedefs.
+ *******************************************************************************/
+
+/** The state of a source that has been stopped. */
+/** \internal Note that this type is for internal usage only. */
+typedef enum
+{
+  RIOFLOW_SOURCE_XOFF_PENDING=0,  /**< An XOFF should be sent. */
+  RIOFLOW_SOURCE_XOFF_SENT=1,     /**< An XOFF has been sent. */
+  RIOFLOW_SOURCE_XON_PENDING=2    /**< An XON should be sent. */
+} RioFlowSourceState_t;
+
+/** A source that has been told to stop. */
+typedef struct
+{
+  uint16_t source; /**< The deviceId of the source. */
+  uint8_t flowId; /**< The flow that was stopped. */
+  RioFlowSourceState_t state; /**< The state of the source. */
+} RioFlowSource_t;
+
+/** A flow that has been stopped by a destination. */
+typedef struct
+{
+  uint16_t destination; /**< The deviceId of the congested destination. */
+  uint8_t flowId; /**< The highest flow that was stopped. */
+  uint32_t time; /**< The time the XOFF was received. */
+} RioFlowBlocked_t;
+
+/** The structure to keep all the flow control variables. */
+typedef struct
+{
+  uint16_t deviceId; /**< The deviceId to use as source of flow control packets. */
+
+  RioFlowSource_t *sources; /**< The storage of stopped sources. */
+  uint16_t sourcesSize; /**< The number of sources in the storage. */
+  uint16_t sourcesLength; /**< The number of used sources. */
+
+  RioFlowBlocked_t *blocked; /**< The storage of stopped flows. */
+  uint16_t blockedSize; /**< The number of flows in the storage. */
+  uint16_t blockedLength; /**< The number of stopped flows. */
+  uint32_t timeout; /**< The time a flow is stopped without an XON, zero to wait forever. */
+
+  RioPool_t *pool; /**< The pool the pending packets are allocated from. */
+  RioPoolHandle_t *pending; /**< The queue of pending outbound packets. */
+  uint16_t pendingSize; /**< The number of packets that fits in the pending queue. */
+  uint16_t pendingLength; /**< The number of pending packets. */
+
+  /** The number of XOFF that has been sent. */
+  uint32_t statusXoffSent;
+
+  /** The number of XON that has been sent. */
+  uint32_t statusXonSent;
+
+  /** The number of XOFF that has been received. */
+  uint32_t statusXoffReceived;
+
+  /** The number of XON that has been received. */
+  uint32_t statusXonReceived;
+
+  /** The number of stopped flows that has been resumed without an XON. */
+  uint32_t statusXoffTimeout;
+
+  /** The number of flow control events that was lost since the storage was full. */
+  uint32_t statusOverflow;
+} RioFlow_t;
+
+
+/*******************************************************************************
+ * Global function prototypes.
+ *******************************************************************************/
+
+/**
+ * \brief Open flow control for operation.
+ *
+ * \param[in] flow The flow control to operate on.
+ * \param[in] deviceId The deviceId of this endpoint.
+ * \param[in] sourcesSize The number of elements in the sources storage.
+ * \param[in] sources The storage of sources that are stopped by this endpoint.
+ * \param[in] blockedSize The number of elements in the blocked storage.
+ * \param[in] blocked The storage of flows that are stopped by other endpoints.
+ * \param[in] pool The pool outbound packets are allocated from.
+ * \param[in] pendingSize The number of elements in the pending storage.
+ * \param[in] pending The storage of pending outbound packets.
+ */
+void RIOFLOW_open(RioFlow_t *flow, const uint16_t deviceId,
+                  const uint16_t sourcesSize, RioFlowSource_t *sources,
+                  const uint16_t blockedSize, RioFlowBlocked_t *blocked,
+                  RioPool_t *pool, const uint16_t pendingSize, RioPoolHandle_t *pending);
+
+/**
+ * \brief Set the time to wait for an XON.
+ *
+ * \param[in] flow The flow control to operate on.
+ * \param[in] timeout The time a flow is stopped if no XON is received. Zero, the 
+ *            default, waits forever. The unit is the same as RIOSTACK_portSetTime().
+ */
+void RIOFLOW_setTimeout(RioFlow_t *flow, const uint32_t timeout);
+
+/**
+ * \brief Start flow control on a stack.
+ *
+ * \param[in] flow The flow control to operate on.
+ * \param[in] stack The stack to use.
+ * \param[in] xoffLevel The inbound queue length where sources are stopped.
+ * \param[in] xonLevel The inbound queue length where sources are resumed.
+ *
+ * This function registers the congestion handler and the inbound handler of flow 
+ * control packets in the stack.
+ *
+ * \note The congestion handler adds sources from RIOSTACK_portAddSymbol() and 
+ * RIOFLOW_transmit() removes them without any locking. Both must be called from 
+ * the same execution context.
+ */
+void RIOFLOW_attach(RioFlow_t *flow, RioStack_t *stack, const uint8_t xoffLevel, const uint8_t xonLevel);
+
+/**
+ * \brief Receive a flow control packet.
+ *
+ * \param[in] flow The flow control to operate on.
+ * \param[in] packet The received packet.
+ * \param[in] time The current time.
+ * \return Non-zero if the packet was a flow control packet, zero otherwise.
+ */
+uint8_t RIOFLOW_receive(RioFlow_t *flow, const RioPacket_t *packet, const uint32_t time);
+
+/**
+ * \brief Check if a flow is stopped.
+ *
+ * \param[in] flow The flow control to operate on.
+ * \param[in] destination The destination of the flow.
+ * \param[in] flowId The flow, the priority of the packets.
+ * \return Non-zero if the flow is stopped.
+ */
+uint8_t RIOFLOW_isBlocked(const RioFlow_t *flow, const uint16_t destination, const uint8_t flowId);
+
+/**
+ * \brief Add a pooled packet to the pending queue.
+ *
+ * \param[in] flow The flow control to operate on.
+ * \param[in] handle The packet to send.
+ * \return Non-zero if the packet was queued, zero if the pending queue is full.
+ *
+ * The reference held by the caller is handed over if the packet was queued, 
+ * otherwise it is kept by the caller.
+ */
+uint8_t RIOFLOW_setOutboundPacketHandle(RioFlow_t *flow, const RioPoolHandle_t handle);
+
+/**
+ * \brief Get the number of pending outbound packets.
+ *
+ * \param[in] flow The flow control to operate on.
+ * \return The number of packets in the pending queue.
+ */
+uint16_t RIOFLOW_getPendingQueueLength(const RioFlow_t *flow);
+
+/**
+ * \brief Move packets to the outbound queue of a stack.
+ *
+ * \param[in] flow The flow control to operate on.
+ * \param[in] stack The stack to send on.
+ * \return The number of pending packets that was moved to the stack.
+ *
+ * This function first sends pending XOFF and XON packets, then resumes flows 
+ * whose XOFF has timed out and last moves pending packets of flows that are 
+ * not stopped to the outbound queue of the stack. The order of the packets 
+ * within a flow is kept.
+ *
+ * \note This function must be called from the same execution context as 
+ * RIOSTACK_portAddSymbol() of the stack the flow control is attached to.
+ */
+uint16_t RIOFLOW_transmit(RioFlow_t *flow, RioStack_t *stack);
+
+#endif /* __RIOFLOW_H */
+
+/*************************** end of file **************************************/
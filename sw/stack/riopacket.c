@@ -46,6 +46,9 @@
 /*lint -e961 Macros are needed due to performance reasons. They are also 
   trivial and clarifies the code. */
 /*lint -e750 Allow unused macros for future usage. */
+#define VC_GET(p) (uint8_t) (((p)[0u] >> 25u) & 0x1u)
+#define PRIO_GET(p) (uint8_t) (((p)[0u] >> 22u) & 0x3u)
+#define TT_GET(p) (uint8_t) (((p)[0u] >> 20u) & 0x3u)
 #define FTYPE_GET(p) (uint8_t) (((p)[0u] >> 16u) & 0xfu)
 #define DESTID_GET(p) (uint16_t) ((p)[0u] & 0xffffu)
 #define SRCID_GET(p) (uint16_t) (((p)[1u] >> 16u) & 0xffffu)
@@ -66,11 +69,24 @@
 #define WDPTR_GET(p) (uint8_t) (((p)[2u] >> 2u) & 0x1u)
 #define DOUBLE_WORD_MSB_GET(p, i) (uint32_t) ((p)[3u+((2u*(i))+0u)])
 #define DOUBLE_WORD_LSB_GET(p, i) (uint32_t) ((p)[3u+((2u*(i))+1u)])
+#define SWRITE_ADDRESS_GET(p) (uint32_t) (((p)[1u] << 16u) | (((p)[2u] >> 16u) & 0xfff8u))
+#define COS_GET(p) (uint8_t) (((p)[1u] >> 8u) & 0xffu)
+#define SEGMENT_GET(p) (uint8_t) (((p)[1u] >> 6u) & 0x3u)
+#define ODD_GET(p) (uint8_t) (((p)[1u] >> 1u) & 0x1u)
+#define PAD_GET(p) (uint8_t) ((p)[1u] & 0x1u)
+#define STREAMID_GET(p) (uint16_t) (((p)[2u] >> 16u) & 0xffffu)
+#define XON_GET(p) (uint8_t) (((p)[1u] >> 15u) & 0x1u)
+#define FLOWID_GET(p) (uint8_t) (((p)[1u] >> 8u) & 0x7fu)
+#define TGTDESTID_GET(p) (uint16_t) ((((p)[1u] << 8u) & 0xff00u) | (((p)[2u] >> 24u) & 0xffu))
 /*lint -restore */
 
 /* The maximum size of a packet that does not contain two CRCs. */
 #define PACKET_SIZE_EMBEDDED_CRC ((uint8_t) 20u)
 
+/* The number of packets to calculate the crc of at the same time in 
+   RIOPACKET_validBatch(). */
+#define BATCH_LANES 8u
+
 /*******************************************************************************
  * Local function prototypes
  *******************************************************************************/
@@ -82,6 +98,15 @@ static uint16_t getPacketPayload(const uint32_t packet[], const uint16_t payload
 static uint8_t setPacketPayload(uint32_t packet[], const uint16_t payloadOffset, 
                                 const uint16_t dataOffset, 
                                 const uint16_t dataSize, const uint8_t data[]);
+static uint8_t setPacketPayloadAligned(uint32_t packet[], const uint16_t payloadOffset, 
+                                       const uint16_t dataOffset, 
+                                       const uint16_t dataSize, const uint8_t data[],
+                                       const uint16_t alignment);
+static uint16_t getDataStreamingPayloadSize(const RioPacket_t *packet, const uint16_t payloadOffset);
+static uint8_t setPacketPayloadWords(uint32_t packet[], const uint16_t payloadIndex, uint16_t crc,
+                                     const uint16_t dataSize, const uint8_t data[]);
+static void setNwriteTemplate(RioPacketTemplate_t *packetTemplate, const uint8_t transaction, 
+                              const uint16_t dstId, const uint16_t srcId, const uint16_t payloadSize);
 
 /* Functions to help in conversions between rdsize/wrsize and size/offset. */
 static uint16_t rdsizeGet(const uint32_t address, const uint16_t size);
@@ -91,6 +116,34 @@ static void rdsizeToOffset(uint8_t rdsize, uint8_t wdptr,
 static void wrsizeToOffset(uint8_t wrsize, uint8_t wdptr, 
                            uint8_t *offset, uint16_t *size);
 
+/* Functions to help set and get headers of any transport type and address size. */
+static uint16_t idSizeGet(const uint8_t tt);
+static uint16_t addressSizeGet(const RioPacketAddressSize_t addressSize);
+static uint16_t setTransportExt(uint8_t header[], const RioPacketTt_t tt, const uint8_t ftype,
+                                const uint32_t dstId, const uint32_t srcId);
+static uint16_t setAddressExt(uint8_t header[], uint16_t index, 
+                              const RioPacketAddressSize_t addressSize,
+                              const uint64_t address, const uint8_t wdptr);
+static uint8_t setPacketExt(uint32_t packet[], const uint8_t header[], const uint16_t headerSize,
+                            const uint16_t dataOffset, const uint16_t dataSize, const uint8_t data[]);
+static void setWriteExt(RioPacket_t *packet, 
+                        const RioPacketTt_t tt, const RioPacketAddressSize_t addressSize,
+                        const uint8_t transaction, const uint32_t dstId, const uint32_t srcId, 
+                        const uint8_t tid, const uint64_t address, 
+                        const uint16_t payloadSize, const uint8_t *payload);
+static uint32_t getHeaderBytes(const uint32_t packet[], uint16_t index, const uint16_t size);
+static uint16_t getAddressExt(const uint32_t packet[], const uint16_t index, 
+                              const RioPacketAddressSize_t addressSize, uint64_t *address);
+static uint16_t getPayloadSizeExt(const RioPacket_t *packet, const uint16_t headerSize);
+
+/* Functions to help change an encoded packet. */
+static uint16_t crcIndexGet(const RioPacket_t *packet, const RioPacketAddressSize_t addressSize);
+static void patchBytes(RioPacket_t *packet, const uint16_t crcIndex, 
+                       uint16_t index, const uint16_t size, uint32_t value);
+static void patchWord(RioPacket_t *packet, const uint16_t crcIndex, 
+                      const uint16_t index, const uint32_t mask, const uint32_t value);
+static uint16_t crcShift(const uint16_t crc, const uint16_t halfWords);
+
 
 
 /*******************************************************************************
@@ -140,7 +193,7 @@ uint8_t RIOPACKET_valid(const RioPacket_t *packet)
     crc = RIOPACKET_crc32((uint32_t) (packet->payload[0] & 0x03fffffful), 0xffffu);
 
     /* Check if the packet contains an embedded crc. */
-    if(packet->size < PACKET_SIZE_EMBEDDED_CRC)
+    if(packet->size <= PACKET_SIZE_EMBEDDED_CRC)
     {
       /* The packet contains only one trailing crc. */
       for(i = 1u; i < packet->size; i++)
@@ -187,6 +240,99 @@ uint8_t RIOPACKET_valid(const RioPacket_t *packet)
 }
 
 
+uint32_t RIOPACKET_validBatch(const RioPacket_t *packets[], const uint32_t n, uint32_t results[])
+{
+  uint32_t returnValue;
+  const uint32_t *payload[BATCH_LANES];
+  uint8_t size[BATCH_LANES];
+  uint8_t ok[BATCH_LANES];
+  uint16_t crc[BATCH_LANES];
+  uint8_t sizeMax;
+  uint32_t lanes;
+  uint32_t base;
+  uint32_t lane;
+  uint32_t i;
+
+
+  ASSERT(packets != NULL, "Invalid packets pointer");
+  ASSERT(results != NULL, "Invalid results pointer");
+
+  for(i = 0u; i < ((n+31u)/32u); i++)
+  {
+    results[i] = 0ul;
+  }
+
+  returnValue = 0u;
+  for(base = 0u; base < n; base += lanes)
+  {
+    lanes = ((n - base) < BATCH_LANES) ? (n - base) : BATCH_LANES;
+
+    /* Check the sizes and calculate the crc on the first words, disregard the ackIds. */
+    sizeMax = 0u;
+    for(lane = 0u; lane < lanes; lane++)
+    {
+      ASSERT(packets[base+lane] != NULL, "Invalid packet pointer");
+
+      payload[lane] = packets[base+lane]->payload;
+      size[lane] = packets[base+lane]->size;
+      if((size[lane] >= RIOPACKET_SIZE_MIN) && (size[lane] <= RIOPACKET_SIZE_MAX))
+      {
+        ok[lane] = 1u;
+        crc[lane] = RIOPACKET_crc32((uint32_t) (payload[lane][0] & 0x03fffffful), 0xffffu);
+        sizeMax = (size[lane] > sizeMax) ? size[lane] : sizeMax;
+      }
+      else
+      {
+        /* The packet does not have a valid length. */
+        ok[lane] = 0u;
+        size[lane] = 0u;
+      }
+    }
+
+    /* Calculate the crc of all the packets one word at a time. */
+    for(i = 1u; i < sizeMax; i++)
+    {
+      for(lane = 0u; lane < lanes; lane++)
+      {
+        if(i < size[lane])
+        {
+          /* Check the embedded crc before it is included in the calculation. */
+          if((i == PACKET_SIZE_EMBEDDED_CRC) && (crc[lane] != ((uint16_t) (payload[lane][i] >> 16))))
+          {
+            ok[lane] = 0u;
+          }
+          else
+          {
+            /* Don't do anything. */
+          }
+          crc[lane] = RIOPACKET_crc32(payload[lane][i], crc[lane]);
+        }
+        else
+        {
+          /* The packet has ended. */
+        }
+      }
+    }
+
+    /* Check the trailing crcs. */
+    for(lane = 0u; lane < lanes; lane++)
+    {
+      if(ok[lane] && (crc[lane] == 0x0000u))
+      {
+        results[(base+lane)/32u] |= 1ul << ((base+lane)%32u);
+        returnValue++;
+      }
+      else
+      {
+        /* The packet is not valid. */
+      }
+    }
+  }
+
+  return returnValue;
+}
+
+
 uint16_t RIOPACKET_serialize(const RioPacket_t *packet, const uint16_t size, uint8_t buffer[])
 {
   uint16_t returnValue;
@@ -345,6 +491,30 @@ void RIOPACKET_toString(RioPacket_t *packet, char *buffer)
       }
       break;
 
+    case RIOPACKET_FTYPE_STREAMING_WRITE:
+      /**************************************************************************************
+       * An SWRITE has been received.
+       **************************************************************************************/
+      {
+        uint32_t address;
+        uint16_t payloadSize;
+        uint8_t payload[256];
+        uint32_t index;
+        uint32_t i;
+
+
+        RIOPACKET_getSwrite(packet, &destId, &srcId, &address, &payloadSize, payload);
+
+        index = sprintf(&buffer[0], 
+                        "SWRITE: dstid=%04x srcid=%04x address=%08x payloadSize=%04x ", 
+                        destId, srcId, address, payloadSize);
+        for(i = 0; i < payloadSize; i++)
+        {
+          index += sprintf(&buffer[index], "%02x", payload[i]);
+        }
+      }
+      break;
+
     case RIOPACKET_FTYPE_MAINTENANCE:
       /**************************************************************************************
        * A maintenance packet has been received.
@@ -414,6 +584,23 @@ void RIOPACKET_toString(RioPacket_t *packet, char *buffer)
       }
       break;
 
+    case RIOPACKET_FTYPE_FLOW_CONTROL:
+      /**************************************************************************************
+       * A flow control packet has been received.
+       **************************************************************************************/
+      {
+        uint8_t xon;
+        uint8_t flowId;
+        uint16_t tgtdestId;
+
+
+        RIOPACKET_getFlowControl(packet, &destId, &srcId, &xon, &flowId, &tgtdestId);
+        sprintf(buffer, 
+                "FLOW_CONTROL: dstid=%04x srcid=%04x %s flowid=%02x tgtdestid=%04x", 
+                destId, srcId, (xon != 0u) ? "XON" : "XOFF", flowId, tgtdestId);
+      }
+      break;
+
     case RIOPACKET_FTYPE_DOORBELL:
       /**************************************************************************************
        * A doorbell packet has been received.
@@ -522,33 +709,246 @@ uint8_t RIOPACKET_getFtype(const RioPacket_t *packet)
 
 uint16_t RIOPACKET_getDestination(const RioPacket_t *packet)
 {
+  uint16_t returnValue;
+
+
   ASSERT(packet != NULL, "Invalid packet pointer");
 
-  return (uint16_t) DESTID_GET(packet->payload);
+  /* Use the fixed field position for the common 16-bit deviceIds. */
+  if(TT_GET(packet->payload) == (uint8_t) RIOPACKET_TT_16BITS)
+  {
+    returnValue = DESTID_GET(packet->payload);
+  }
+  else
+  {
+    returnValue = (uint16_t) RIOPACKET_getDestinationExt(packet);
+  }
+
+  return returnValue;
 }
 
 
 uint16_t RIOPACKET_getSource(const RioPacket_t *packet)
 {
+  uint16_t returnValue;
+
+
+  ASSERT(packet != NULL, "Invalid packet pointer");
+
+  /* Use the fixed field position for the common 16-bit deviceIds. */
+  if(TT_GET(packet->payload) == (uint8_t) RIOPACKET_TT_16BITS)
+  {
+    returnValue = SRCID_GET(packet->payload);
+  }
+  else
+  {
+    returnValue = (uint16_t) RIOPACKET_getSourceExt(packet);
+  }
+
+  return returnValue;
+}
+
+
+uint8_t RIOPACKET_getTt(const RioPacket_t *packet)
+{
+  ASSERT(packet != NULL, "Invalid packet pointer");
+
+  return TT_GET(packet->payload);
+}
+
+
+uint32_t RIOPACKET_getDestinationExt(const RioPacket_t *packet)
+{
+  ASSERT(packet != NULL, "Invalid packet pointer");
+
+  /* ackId(4:0)|0|vc|crf|prio(1:0)|tt(1:0)|ftype(3:0)|destinationId|sourceId */
+  return getHeaderBytes(packet->payload, 2u, idSizeGet(TT_GET(packet->payload)));
+}
+
+
+uint32_t RIOPACKET_getSourceExt(const RioPacket_t *packet)
+{
+  uint16_t idSize;
+
+
   ASSERT(packet != NULL, "Invalid packet pointer");
 
-  return (uint16_t) SRCID_GET(packet->payload);
+  idSize = idSizeGet(TT_GET(packet->payload));
+  return getHeaderBytes(packet->payload, 2u+idSize, idSize);
 }
 
 
 uint8_t RIOPACKET_getTransaction(const RioPacket_t *packet)
 {
+  uint8_t returnValue;
+
+
   ASSERT(packet != NULL, "Invalid packet pointer");
 
-  return (uint8_t) TRANSACTION_GET(packet->payload);
+  /* The transaction field follows directly after the deviceIds. */
+  if(TT_GET(packet->payload) == (uint8_t) RIOPACKET_TT_16BITS)
+  {
+    returnValue = TRANSACTION_GET(packet->payload);
+  }
+  else
+  {
+    returnValue = (uint8_t) (getHeaderBytes(packet->payload, 
+                                            2u+(2u*idSizeGet(TT_GET(packet->payload))), 1u) >> 4);
+  }
+
+  return returnValue;
 }
 
 
 uint8_t RIOPACKET_getTid(const RioPacket_t *packet)
 {
+  uint8_t returnValue;
+
+
+  ASSERT(packet != NULL, "Invalid packet pointer");
+
+  /* The tid field follows directly after the transaction field. */
+  if(TT_GET(packet->payload) == (uint8_t) RIOPACKET_TT_16BITS)
+  {
+    returnValue = TID_GET(packet->payload);
+  }
+  else
+  {
+    returnValue = (uint8_t) getHeaderBytes(packet->payload, 
+                                           3u+(2u*idSizeGet(TT_GET(packet->payload))), 1u);
+  }
+
+  return returnValue;
+}
+
+
+uint8_t RIOPACKET_getPriority(const RioPacket_t *packet)
+{
+  ASSERT(packet != NULL, "Invalid packet pointer");
+
+  return PRIO_GET(packet->payload);
+}
+
+
+uint8_t RIOPACKET_getVc(const RioPacket_t *packet)
+{
+  ASSERT(packet != NULL, "Invalid packet pointer");
+
+  return VC_GET(packet->payload);
+}
+
+
+uint8_t RIOPACKET_getMailbox(const RioPacket_t *packet)
+{
+  uint8_t mailbox;
+
+
+  ASSERT(packet != NULL, "Invalid packet pointer");
+  ASSERT(TT_GET(packet->payload) == (uint8_t) RIOPACKET_TT_16BITS, "Unsupported transport type");
+
+  mailbox = XMBOX_GET(packet->payload);
+  mailbox <<= 2;
+  mailbox |= LETTER_GET(packet->payload);
+  mailbox <<= 2;
+  mailbox |= MBOX_GET(packet->payload);
+
+  return mailbox;
+}
+
+
+uint16_t RIOPACKET_getInfo(const RioPacket_t *packet)
+{
+  ASSERT(packet != NULL, "Invalid packet pointer");
+  ASSERT(TT_GET(packet->payload) == (uint8_t) RIOPACKET_TT_16BITS, "Unsupported transport type");
+
+  return INFO_GET(packet->payload);
+}
+
+
+uint8_t RIOPACKET_getCos(const RioPacket_t *packet)
+{
+  ASSERT(packet != NULL, "Invalid packet pointer");
+  ASSERT(TT_GET(packet->payload) == (uint8_t) RIOPACKET_TT_16BITS, "Unsupported transport type");
+
+  return COS_GET(packet->payload);
+}
+
+
+uint8_t RIOPACKET_getSegment(const RioPacket_t *packet)
+{
+  ASSERT(packet != NULL, "Invalid packet pointer");
+  ASSERT(TT_GET(packet->payload) == (uint8_t) RIOPACKET_TT_16BITS, "Unsupported transport type");
+
+  return SEGMENT_GET(packet->payload);
+}
+
+
+uint16_t RIOPACKET_getStreamId(const RioPacket_t *packet)
+{
+  uint16_t streamId;
+
+
+  ASSERT(packet != NULL, "Invalid packet pointer");
+  ASSERT(TT_GET(packet->payload) == (uint8_t) RIOPACKET_TT_16BITS, "Unsupported transport type");
+
+  if(SEGMENT_GET(packet->payload) != (uint8_t) RIOPACKET_SEGMENT_CONTINUATION)
+  {
+    streamId = STREAMID_GET(packet->payload);
+  }
+  else
+  {
+    streamId = 0u;
+  }
+
+  return streamId;
+}
+
+
+void RIOPACKET_patchHeader(RioPacket_t *packet, const RioPacketField_t field, const uint32_t value)
+{
+  RIOPACKET_patchHeaderExt(packet, RIOPACKET_ADDRESS_34BITS, field, value);
+}
+
+
+void RIOPACKET_patchHeaderExt(RioPacket_t *packet, const RioPacketAddressSize_t addressSize,
+                              const RioPacketField_t field, const uint32_t value)
+{
+  uint16_t idSize;
+  uint16_t crcIndex;
+
+
   ASSERT(packet != NULL, "Invalid packet pointer");
+  ASSERT((packet->size >= RIOPACKET_SIZE_MIN) && (packet->size <= RIOPACKET_SIZE_MAX), 
+         "Invalid packet size");
 
-  return (uint8_t) TID_GET(packet->payload);
+  crcIndex = crcIndexGet(packet, addressSize);
+  idSize = idSizeGet(TT_GET(packet->payload));
+  switch(field)
+  {
+    case RIOPACKET_FIELD_PRIORITY:
+      ASSERT(value <= 3ul, "Invalid priority");
+      patchWord(packet, crcIndex, 0u, 0x00c00000ul, value << 22);
+      break;
+    case RIOPACKET_FIELD_VC:
+      ASSERT(value <= 1ul, "Invalid virtual channel");
+      patchWord(packet, crcIndex, 0u, 0x02000000ul, value << 25);
+      break;
+    case RIOPACKET_FIELD_DESTINATION:
+      ASSERT((idSize == 4u) || ((value >> (8u*idSize)) == 0ul), "Invalid deviceId");
+      patchBytes(packet, crcIndex, 2u, idSize, value);
+      break;
+    case RIOPACKET_FIELD_SOURCE:
+      ASSERT((idSize == 4u) || ((value >> (8u*idSize)) == 0ul), "Invalid deviceId");
+      patchBytes(packet, crcIndex, 2u+idSize, idSize, value);
+      break;
+    case RIOPACKET_FIELD_TID:
+      ASSERT(value <= 0xfful, "Invalid tid");
+      patchBytes(packet, crcIndex, 3u+(2u*idSize), 1u, value);
+      break;
+    default:
+      ASSERT0("Invalid field");
+      break;
+  }
 }
 
 
@@ -602,6 +1002,7 @@ void RIOPACKET_getMaintReadRequest(const RioPacket_t *packet,
                                    uint8_t *tid, uint32_t *offset)
 {
   ASSERT(packet != NULL, "Invalid packet pointer");
+  ASSERT(TT_GET(packet->payload) == (uint8_t) RIOPACKET_TT_16BITS, "Unsupported transport type");
   ASSERT(dstId != NULL, "Invalid dstId pointer");
   ASSERT(srcId != NULL, "Invalid srcId pointer");
   ASSERT(hop != NULL, "Invalid hop pointer");
@@ -673,6 +1074,7 @@ void RIOPACKET_getMaintReadResponse(const RioPacket_t *packet,
                                     uint32_t *data)
 {
   ASSERT(packet != NULL, "Invalid packet pointer");
+  ASSERT(TT_GET(packet->payload) == (uint8_t) RIOPACKET_TT_16BITS, "Unsupported transport type");
   ASSERT(dstId != NULL, "Invalid dstId pointer");
   ASSERT(srcId != NULL, "Invalid srcId pointer");
   ASSERT(tid != NULL, "Invalid tid pointer");
@@ -748,6 +1150,7 @@ void RIOPACKET_getMaintWriteRequest(const RioPacket_t *packet,
                                     uint8_t *tid, uint32_t *offset, uint32_t *data)
 {
   ASSERT(packet != NULL, "Invalid packet pointer");
+  ASSERT(TT_GET(packet->payload) == (uint8_t) RIOPACKET_TT_16BITS, "Unsupported transport type");
   ASSERT(dstId != NULL, "Invalid dstId pointer");
   ASSERT(srcId != NULL, "Invalid srcId pointer");
   ASSERT(hop != NULL, "Invalid hop pointer");
@@ -811,6 +1214,7 @@ void RIOPACKET_getMaintWriteResponse(const RioPacket_t *packet,
                                      uint8_t *tid, uint8_t *status)
 {
   ASSERT(packet != NULL, "Invalid packet pointer");
+  ASSERT(TT_GET(packet->payload) == (uint8_t) RIOPACKET_TT_16BITS, "Unsupported transport type");
   ASSERT(dstId != NULL, "Invalid dstId pointer");
   ASSERT(srcId != NULL, "Invalid srcId pointer");
   ASSERT(tid != NULL, "Invalid tid pointer");
@@ -891,6 +1295,7 @@ void RIOPACKET_getMaintPortWrite(const RioPacket_t *packet,
                                  uint32_t *logicalTransportErrorDetect)
 {
   ASSERT(packet != NULL, "Invalid packet pointer");
+  ASSERT(TT_GET(packet->payload) == (uint8_t) RIOPACKET_TT_16BITS, "Unsupported transport type");
   ASSERT(dstId != NULL, "Invalid dstId pointer");
   ASSERT(srcId != NULL, "Invalid srcId pointer");
   ASSERT(componentTag != NULL, "Invalid componentTag pointer");
@@ -975,6 +1380,7 @@ void RIOPACKET_getNwrite(const RioPacket_t *packet, uint16_t *dstId, uint16_t *s
 
 
   ASSERT(packet != NULL, "Invalid packet pointer");
+  ASSERT(TT_GET(packet->payload) == (uint8_t) RIOPACKET_TT_16BITS, "Unsupported transport type");
   ASSERT(dstId != NULL, "Invalid dstId pointer");
   ASSERT(srcId != NULL, "Invalid srcId pointer");
   ASSERT(address != NULL, "Invalid address pointer");
@@ -1066,6 +1472,7 @@ void RIOPACKET_getNwriteR(const RioPacket_t *packet, uint16_t *dstId, uint16_t *
 
 
   ASSERT(packet != NULL, "Invalid packet pointer");
+  ASSERT(TT_GET(packet->payload) == (uint8_t) RIOPACKET_TT_16BITS, "Unsupported transport type");
   ASSERT(dstId != NULL, "Invalid dstId pointer");
   ASSERT(srcId != NULL, "Invalid srcId pointer");
   ASSERT(tid != NULL, "Invalid tid pointer");
@@ -1096,388 +1503,440 @@ void RIOPACKET_getNwriteR(const RioPacket_t *packet, uint16_t *dstId, uint16_t *
 
 
 /*******************************************************************************************
- * Logical I/O NREAD functions.
+ * Logical I/O SWRITE functions.
  *******************************************************************************************/
 
-void RIOPACKET_setNread(RioPacket_t *packet, uint16_t dstId, uint16_t srcId, uint8_t tid, 
-                        uint32_t address, uint16_t payloadSize)
+void RIOPACKET_setSwrite(RioPacket_t *packet, uint16_t dstId, uint16_t srcId,
+                         uint32_t address, uint16_t payloadSize, const uint8_t *payload)
 {
   uint32_t content;
-  uint16_t crc = 0xffffu;
-  uint16_t rdsize;
 
 
   ASSERT(packet != NULL, "Invalid packet pointer");
+  ASSERT(payload != NULL, "Invalid payload pointer");
+  ASSERT(payloadSize <= 256u, "Invalid payload size");
 
-  /* Convert the address and size to the rdsize field and check if the combination is valid. */
-  rdsize = rdsizeGet(address, payloadSize);
-  if(rdsize != 0xffffu)
+  /* Check that the address and size are double-word aligned. */
+  if(((address & 0x7ul) == 0ul) && ((payloadSize & 0x7u) == 0u) && (payloadSize != 0u))
   {
-    /* The address and size field combination is valid. */
+    /* The address and size are valid. */
 
     /* ackId(4:0)|0|vc|crf|prio(1:0)|tt(1:0)|ftype(3:0)|destinationId(15:0) */
     /* ackId is set when the packet is transmitted. */
     content = ((uint32_t) RIOPACKET_TT_16BITS) << 20;
-    content |= ((uint32_t) RIOPACKET_FTYPE_REQUEST) << 16;
+    content |= ((uint32_t) RIOPACKET_FTYPE_STREAMING_WRITE) << 16;
     content |= (uint32_t) dstId;
-    crc = RIOPACKET_crc32(content, crc);
     packet->payload[0] = content;
 
-    /* sourceId(15:0)|transaction(3:0)|rdsize(3:0)|srcTID(7:0) */
+    /* sourceId(15:0)|address(28:13) */
     content = ((uint32_t) srcId) << 16;
-    content |= ((uint32_t) RIOPACKET_TRANSACTION_REQUEST_NREAD) << 12;
-    content |= (uint32_t) (((uint32_t) rdsize) & 0x0f00ul);
-    content |= (uint32_t) tid;
-    crc = RIOPACKET_crc32(content, crc);
+    content |= (uint32_t) (address >> 16);
     packet->payload[1] = content;
 
-    /* address(28:0)|wdptr|xamsbs(1:0) */
-    /* rdsize also contains wdptr in the lower nibble. */
+    /* address(12:0)|rsrv|xamsbs(1:0)|<payload> */
     /* REMARK: Note that xamsbs cannot be used if the address is a word. If the 2 msb bits in the 
        34-bit address should be used, another mechanism to set it should be used. */
-    content = (uint32_t) (address & 0xfffffff8ul);
-    content |= (uint32_t) ((((uint32_t) rdsize) & 0x000ful) << 2);
-    crc = RIOPACKET_crc32(content, crc);
+    content = (uint32_t) ((address & 0x0000fff8ul) << 16);
     packet->payload[2] = content;
 
-    /* crc(15:0)|pad(15:0) */
-    content = ((uint32_t) crc) << 16;
-    packet->payload[3] = content;
-
-    /* Set the size of the packet. */
-    packet->size = 4u;
+    /* Place the payload buffer into the payload of the packet directly after the 
+       header half-word. */
+    /* This function also calculates the CRC. */
+    packet->size = setPacketPayload(&(packet->payload[0]), 10u, 0u, payloadSize, payload);
   }
   else
   {
-    /* The address and size field combination is not valid. */
+    /* The address and size are not double-word aligned. */
     /* Cannot create a packet from these arguments, indicate this by setting the packet size to zero. */
     packet->size = 0u;
   }
 }
 
 
-void RIOPACKET_getNread(const RioPacket_t *packet, uint16_t *dstId, uint16_t *srcId, uint8_t *tid, 
-                        uint32_t *address, uint16_t *payloadSize)
+void RIOPACKET_getSwrite(const RioPacket_t *packet, uint16_t *dstId, uint16_t *srcId, 
+                         uint32_t *address, uint16_t *payloadSize, uint8_t *payload)
 {
-  uint8_t rdsize;
-  uint8_t wdptr;
-  uint8_t offset = 0u;
-  uint16_t size = 0u;
+  uint16_t size;
 
 
   ASSERT(packet != NULL, "Invalid packet pointer");
+  ASSERT(TT_GET(packet->payload) == (uint8_t) RIOPACKET_TT_16BITS, "Unsupported transport type");
   ASSERT(dstId != NULL, "Invalid dstId pointer");
   ASSERT(srcId != NULL, "Invalid srcId pointer");
-  ASSERT(tid != NULL, "Invalid tid pointer");
   ASSERT(address != NULL, "Invalid address pointer");
   ASSERT(payloadSize != NULL, "Invalid payloadSize pointer");
-
-  rdsize = RDSIZE_GET(packet->payload);
-  wdptr = WDPTR_GET(packet->payload);
-  rdsizeToOffset(rdsize, wdptr, &offset, &size);
+  ASSERT(payload != NULL, "Invalid payload pointer");
 
   *dstId = DESTID_GET(packet->payload);
   *srcId = SRCID_GET(packet->payload);
-  *tid = TID_GET(packet->payload);
-  *address = ADDRESS_GET(packet->payload) | offset;
-  *payloadSize = size;
-}
-
-
-
-/*******************************************************************************************
- * Logical message passing DOORBELL and MESSAGE functions.
- *******************************************************************************************/
-
-void RIOPACKET_setDoorbell(RioPacket_t *packet, uint16_t dstId, uint16_t srcId, uint8_t tid, 
-                           uint16_t info)
-{
-  uint32_t content;
-  uint16_t crc = 0xffffu;
-
-
-  ASSERT(packet != NULL, "Invalid packet pointer");
-
-  /* ackId(4:0)|0|vc|crf|prio(1:0)|tt(1:0)|ftype(3:0)|destinationId(15:0) */
-  /* ackId is set when the packet is transmitted. */
-  content = ((uint32_t) RIOPACKET_TT_16BITS) << 20;
-  content |= ((uint32_t) RIOPACKET_FTYPE_DOORBELL) << 16;
-  content |= (uint32_t) dstId;
-  crc = RIOPACKET_crc32(content, crc);
-  packet->payload[0] = content;
-
-  /* sourceId(15:0)|rsrv(7:0)|srcTID(7:0) */
-  content = ((uint32_t) srcId) << 16;
-  content |= (uint32_t) tid;
-  crc = RIOPACKET_crc32(content, crc);
-  packet->payload[1] = content;
+  *address = SWRITE_ADDRESS_GET(packet->payload);
 
-  /* infoMSB(7:0)|infoLSB(7:0)|crc(15:0) */
-  content = ((uint32_t) info) << 16;
-  crc = RIOPACKET_crc16(info, crc);
-  content |= crc;
-  packet->payload[2] = content;
+  /* Remove the header, the CRC and, for long packets, the embedded CRC and the 
+     padding from the packet size. */
+  size = 4u * ((uint16_t) packet->size);
+  if(packet->size > PACKET_SIZE_EMBEDDED_CRC)
+  {
+    size -= 16u;
+  }
+  else
+  {
+    size -= 12u;
+  }
 
-  /* Set the size of the packet. */
-  packet->size = 3u;
+  *payloadSize = getPacketPayload(&(packet->payload[0]), 10u, 0u, size, payload);
 }
 
 
-void RIOPACKET_getDoorbell(const RioPacket_t *packet, uint16_t *dstId, uint16_t *srcId, uint8_t *tid, 
-                           uint16_t *info)
+void RIOPACKET_setWrite(RioPacket_t *packet, uint16_t dstId, uint16_t srcId,
+                        uint32_t address, uint16_t payloadSize, const uint8_t *payload)
 {
-  ASSERT(packet != NULL, "Invalid packet pointer");
-  ASSERT(dstId != NULL, "Invalid dstId pointer");
-  ASSERT(srcId != NULL, "Invalid srcId pointer");
-  ASSERT(tid != NULL, "Invalid tid pointer");
-  ASSERT(info != NULL, "Invalid info pointer");
-
-  *dstId = DESTID_GET(packet->payload);
-  *srcId = SRCID_GET(packet->payload);
-  *tid = TID_GET(packet->payload);
-  *info = INFO_GET(packet->payload);
+  /* Use the smaller SWRITE header when the alignment allows it. */
+  if(((address & 0x7ul) == 0ul) && ((payloadSize & 0x7u) == 0u) && (payloadSize != 0u))
+  {
+    RIOPACKET_setSwrite(packet, dstId, srcId, address, payloadSize, payload);
+  }
+  else
+  {
+    RIOPACKET_setNwrite(packet, dstId, srcId, address, payloadSize, payload);
+  }
 }
 
 
-void RIOPACKET_setMessage(RioPacket_t *packet, uint16_t dstId, uint16_t srcId, uint8_t mailbox, 
-                          uint16_t payloadSize, const uint8_t *payload)
+/*******************************************************************************************
+ * Logical I/O NREAD functions.
+ *******************************************************************************************/
+
+void RIOPACKET_setNread(RioPacket_t *packet, uint16_t dstId, uint16_t srcId, uint8_t tid, 
+                        uint32_t address, uint16_t payloadSize)
 {
   uint32_t content;
+  uint16_t crc = 0xffffu;
+  uint16_t rdsize;
 
 
   ASSERT(packet != NULL, "Invalid packet pointer");
-  ASSERT(payloadSize <= 256u, "Invalid payload size");
 
-  /* Make sure that the message payload size is larger than zero. */
-  if((payloadSize > 0u) && (payloadSize <= 256u))
+  /* Convert the address and size to the rdsize field and check if the combination is valid. */
+  rdsize = rdsizeGet(address, payloadSize);
+  if(rdsize != 0xffffu)
   {
-    /* The payload size is larger than zero. */
+    /* The address and size field combination is valid. */
 
     /* ackId(4:0)|0|vc|crf|prio(1:0)|tt(1:0)|ftype(3:0)|destinationId(15:0) */
     /* ackId is set when the packet is transmitted. */
     content = ((uint32_t) RIOPACKET_TT_16BITS) << 20;
-    content |= ((uint32_t) RIOPACKET_FTYPE_MESSAGE) << 16;
+    content |= ((uint32_t) RIOPACKET_FTYPE_REQUEST) << 16;
     content |= (uint32_t) dstId;
+    crc = RIOPACKET_crc32(content, crc);
     packet->payload[0] = content;
-  
-    /* sourceId(15:0)|msglen(3:0)|ssize(3:0)|letter(1:0)|mbox(1:0)|msgseg(3:0)/xmbox(3:0) */
+
+    /* sourceId(15:0)|transaction(3:0)|rdsize(3:0)|srcTID(7:0) */
     content = ((uint32_t) srcId) << 16;
-    if(payloadSize <= 8u)
-    {
-      content |= (uint32_t) 0x00000900ul;
-    }
-    else if(payloadSize <= 16u)
-    {
-      content |= (uint32_t) 0x00000a00ul;
-    }
-    else if(payloadSize <= 32u)
-    {
-      content |= (uint32_t) 0x00000b00ul;
-    }
-    else if(payloadSize <= 64u)
-    {
-      content |= (uint32_t) 0x00000c00ul;
-    }
-    else if(payloadSize <= 128u)
-    {
-      content |= (uint32_t) 0x00000d00ul;
-    }
-    else
-    {
-      content |= (uint32_t) 0x00000e00ul;
-    }
-    content |= (uint32_t) ((((uint32_t) mailbox) & 0xful) << 4);
-    content |= (uint32_t) (((uint32_t) mailbox) >> 4);
+    content |= ((uint32_t) RIOPACKET_TRANSACTION_REQUEST_NREAD) << 12;
+    content |= (uint32_t) (((uint32_t) rdsize) & 0x0f00ul);
+    content |= (uint32_t) tid;
+    crc = RIOPACKET_crc32(content, crc);
     packet->payload[1] = content;
 
-    /* Place data buffer into the payload of the packet and set the size. */
-    packet->size = setPacketPayload(&(packet->payload[0]), 8u, 0u, payloadSize, payload);
+    /* address(28:0)|wdptr|xamsbs(1:0) */
+    /* rdsize also contains wdptr in the lower nibble. */
+    /* REMARK: Note that xamsbs cannot be used if the address is a word. If the 2 msb bits in the 
+       34-bit address should be used, another mechanism to set it should be used. */
+    content = (uint32_t) (address & 0xfffffff8ul);
+    content |= (uint32_t) ((((uint32_t) rdsize) & 0x000ful) << 2);
+    crc = RIOPACKET_crc32(content, crc);
+    packet->payload[2] = content;
+
+    /* crc(15:0)|pad(15:0) */
+    content = ((uint32_t) crc) << 16;
+    packet->payload[3] = content;
+
+    /* Set the size of the packet. */
+    packet->size = 4u;
   }
   else
   {
-    /* The payload size is not allowed. */
-    /* Unable to create the new packet. */
+    /* The address and size field combination is not valid. */
+    /* Cannot create a packet from these arguments, indicate this by setting the packet size to zero. */
     packet->size = 0u;
   }
 }
 
 
-void RIOPACKET_getMessage(const RioPacket_t *packet, uint16_t *dstId, uint16_t *srcId, uint8_t *mailbox, 
-                          uint16_t *payloadSize, uint8_t *payload)
+void RIOPACKET_getNread(const RioPacket_t *packet, uint16_t *dstId, uint16_t *srcId, uint8_t *tid, 
+                        uint32_t *address, uint16_t *payloadSize)
 {
+  uint8_t rdsize;
+  uint8_t wdptr;
+  uint8_t offset = 0u;
+  uint16_t size = 0u;
+
+
   ASSERT(packet != NULL, "Invalid packet pointer");
+  ASSERT(TT_GET(packet->payload) == (uint8_t) RIOPACKET_TT_16BITS, "Unsupported transport type");
   ASSERT(dstId != NULL, "Invalid dstId pointer");
   ASSERT(srcId != NULL, "Invalid srcId pointer");
-  ASSERT(mailbox != NULL, "Invalid mailbox pointer");
+  ASSERT(tid != NULL, "Invalid tid pointer");
+  ASSERT(address != NULL, "Invalid address pointer");
   ASSERT(payloadSize != NULL, "Invalid payloadSize pointer");
-  ASSERT(payload != NULL, "Invalid payload pointer");
+
+  rdsize = RDSIZE_GET(packet->payload);
+  wdptr = WDPTR_GET(packet->payload);
+  rdsizeToOffset(rdsize, wdptr, &offset, &size);
 
   *dstId = DESTID_GET(packet->payload);
   *srcId = SRCID_GET(packet->payload);
-  *mailbox = XMBOX_GET(packet->payload);
-  *mailbox <<= 2;
-  *mailbox |= LETTER_GET(packet->payload);
-  *mailbox <<= 2;
-  *mailbox |= MBOX_GET(packet->payload);
-  *payloadSize = getPacketPayload(&(packet->payload[0]), 8u, 0u, 
-                                  (((uint16_t) packet->size)-3u)*4u, payload);
+  *tid = TID_GET(packet->payload);
+  *address = ADDRESS_GET(packet->payload) | offset;
+  *payloadSize = size;
 }
 
 
 
-
 /*******************************************************************************************
- * Logical I/O RESPONSE-DONE-PAYLOAD, RESPONSE-DONE, RESPONSE-RETRY and RESPONSE-ERROR 
- * functions.
+ * Logical I/O ATOMIC functions.
  *******************************************************************************************/
 
-void RIOPACKET_setResponseNoPayload(RioPacket_t *packet, 
-                                    uint16_t dstId, uint16_t srcId, 
-                                    uint8_t tid, uint8_t status)
+void RIOPACKET_setAtomicRequest(RioPacket_t *packet, uint16_t dstId, uint16_t srcId, uint8_t tid, 
+                                uint8_t transaction, uint32_t address)
 {
   uint32_t content;
   uint16_t crc = 0xffffu;
+  uint16_t rdsize;
 
 
   ASSERT(packet != NULL, "Invalid packet pointer");
+  ASSERT((transaction >= (uint8_t) RIOPACKET_TRANSACTION_REQUEST_ATOMIC_INC) &&
+         (transaction <= (uint8_t) RIOPACKET_TRANSACTION_REQUEST_ATOMIC_CLR), "Invalid transaction");
 
-  /* ackId(4:0)|0|vc|crf|prio(1:0)|tt(1:0)|ftype(3:0)|destinationId(15:0) */
-  /* ackId is set when the packet is transmitted. */
-  content = ((uint32_t) RIOPACKET_TT_16BITS) << 20;
-  content |= ((uint32_t) RIOPACKET_FTYPE_RESPONSE) << 16;
-  content |= (uint32_t) dstId;
-  crc = RIOPACKET_crc32(content, crc);
-  packet->payload[0] = content;
+  /* Only word operands are supported. */
+  if((address & 0x3ul) == 0ul)
+  {
+    /* The address is word aligned. */
+    rdsize = rdsizeGet(address, 4u);
 
-  /* sourceId(15:0)|transaction(3:0)|status(3:0)|targetTID(7:0) */
-  content = ((uint32_t) srcId) << 16;
-  content |= ((uint32_t) RIOPACKET_TRANSACTION_RESPONSE_NO_PAYLOAD) << 12; /*lint !e835 !e845 The constant value is zero. */
-  content |= (uint32_t) ((((uint32_t) status) & 0xful) << 8);
-  content |= (uint32_t) tid;
-  crc = RIOPACKET_crc32(content, crc);
-  packet->payload[1] = content;
+    /* ackId(4:0)|0|vc|crf|prio(1:0)|tt(1:0)|ftype(3:0)|destinationId(15:0) */
+    /* ackId is set when the packet is transmitted. */
+    content = ((uint32_t) RIOPACKET_TT_16BITS) << 20;
+    content |= ((uint32_t) RIOPACKET_FTYPE_REQUEST) << 16;
+    content |= (uint32_t) dstId;
+    crc = RIOPACKET_crc32(content, crc);
+    packet->payload[0] = content;
 
-  /* crc(15:0)|pad(15:0) */
-  content = ((uint32_t) crc) << 16;
-  packet->payload[2] = content;
+    /* sourceId(15:0)|transaction(3:0)|rdsize(3:0)|srcTID(7:0) */
+    content = ((uint32_t) srcId) << 16;
+    content |= ((uint32_t) transaction & 0xful) << 12;
+    content |= (uint32_t) (((uint32_t) rdsize) & 0x0f00ul);
+    content |= (uint32_t) tid;
+    crc = RIOPACKET_crc32(content, crc);
+    packet->payload[1] = content;
 
-  /* Set the size of the packet. */
-  packet->size = 3u;
+    /* address(28:0)|wdptr|xamsbs(1:0) */
+    /* rdsize also contains wdptr in the lower nibble. */
+    content = (uint32_t) (address & 0xfffffff8ul);
+    content |= (uint32_t) ((((uint32_t) rdsize) & 0x000ful) << 2);
+    crc = RIOPACKET_crc32(content, crc);
+    packet->payload[2] = content;
+
+    /* crc(15:0)|pad(15:0) */
+    content = ((uint32_t) crc) << 16;
+    packet->payload[3] = content;
+
+    /* Set the size of the packet. */
+    packet->size = 4u;
+  }
+  else
+  {
+    /* The address is not word aligned. */
+    /* Cannot create a packet from these arguments, indicate this by setting the packet size to zero. */
+    packet->size = 0u;
+  }
 }
 
 
-void RIOPACKET_getResponseNoPayload(const RioPacket_t *packet, 
-                                    uint16_t *dstId, uint16_t *srcId, 
-                                    uint8_t *tid, uint8_t *status)
+uint16_t RIOPACKET_getAtomicRequest(const RioPacket_t *packet, uint16_t *dstId, uint16_t *srcId, uint8_t *tid, 
+                                    uint8_t *transaction, uint32_t *address)
 {
+  uint8_t offset = 0u;
+  uint16_t size = 0u;
+
+
   ASSERT(packet != NULL, "Invalid packet pointer");
+  ASSERT(TT_GET(packet->payload) == (uint8_t) RIOPACKET_TT_16BITS, "Unsupported transport type");
   ASSERT(dstId != NULL, "Invalid dstId pointer");
   ASSERT(srcId != NULL, "Invalid srcId pointer");
   ASSERT(tid != NULL, "Invalid tid pointer");
-  ASSERT(status != NULL, "Invalid status pointer");
+  ASSERT(transaction != NULL, "Invalid transaction pointer");
+  ASSERT(address != NULL, "Invalid address pointer");
+
+  rdsizeToOffset(RDSIZE_GET(packet->payload), WDPTR_GET(packet->payload), &offset, &size);
 
   *dstId = DESTID_GET(packet->payload);
   *srcId = SRCID_GET(packet->payload);
   *tid = TID_GET(packet->payload);
-  *status = STATUS_GET(packet->payload);
-}
+  *transaction = TRANSACTION_GET(packet->payload);
+  *address = ADDRESS_GET(packet->payload) | offset;
 
+  return size;
+}
 
 
-void RIOPACKET_setResponseWithPayload(RioPacket_t *packet, 
-                                      uint16_t dstId, uint16_t srcId, 
-                                      uint8_t tid, uint8_t offset, 
-                                      uint16_t payloadSize, const uint8_t *payload)
+void RIOPACKET_setAtomicWrite(RioPacket_t *packet, uint16_t dstId, uint16_t srcId, uint8_t tid, 
+                              uint8_t transaction, uint32_t address, uint32_t data, uint32_t compare)
 {
   uint32_t content;
+  uint16_t wrsize;
+  uint8_t payload[8];
 
 
   ASSERT(packet != NULL, "Invalid packet pointer");
-  ASSERT(payload != NULL, "Invalid payload pointer");
-  ASSERT(payloadSize <= 256u, "Invalid payload size");
+  ASSERT((transaction >= (uint8_t) RIOPACKET_TRANSACTION_WRITE_ATOMIC_SWAP) &&
+         (transaction <= (uint8_t) RIOPACKET_TRANSACTION_WRITE_ATOMIC_TEST_AND_SWAP), "Invalid transaction");
 
-  /* ackId(4:0)|0|vc|crf|prio(1:0)|tt(1:0)|ftype(3:0)|destinationId(15:0) */
-  /* ackId is set when the packet is transmitted. */
-  content = ((uint32_t) RIOPACKET_TT_16BITS) << 20;
-  content |= ((uint32_t) RIOPACKET_FTYPE_RESPONSE) << 16;
-  content |= (uint32_t) dstId;
-  packet->payload[0] = content;
-    
-  /* sourceId(15:0)|transaction(3:0)|status(3:0)|targetTID(7:0) */
-  /* status=DONE is 0. */
-  content = ((uint32_t) srcId) << 16;
-  content |= ((uint32_t) RIOPACKET_TRANSACTION_RESPONSE_WITH_PAYLOAD) << 12;
-  content |= (uint32_t) tid;
-  packet->payload[1] = content;
+  /* Only word operands are supported. */
+  if((address & 0x3ul) == 0ul)
+  {
+    /* The address is word aligned. */
+    wrsize = wrsizeGet(address, 4u);
 
-  packet->size = setPacketPayload(&(packet->payload[0]), 8u, ((uint16_t) offset) & 0x7u, 
-                                  payloadSize, payload);
+    /* ackId(4:0)|0|vc|crf|prio(1:0)|tt(1:0)|ftype(3:0)|destinationId(15:0) */
+    /* ackId is set when the packet is transmitted. */
+    content = ((uint32_t) RIOPACKET_TT_16BITS) << 20;
+    content |= ((uint32_t) RIOPACKET_FTYPE_WRITE) << 16;
+    content |= (uint32_t) dstId;
+    packet->payload[0] = content;
+
+    /* sourceId(15:0)|transaction(3:0)|wrsize(3:0)|srcTID(7:0) */
+    content = ((uint32_t) srcId) << 16;
+    content |= ((uint32_t) transaction & 0xful) << 12;
+    content |= (uint32_t) (((uint32_t) wrsize) & 0x00000f00ul); 
+    content |= (uint32_t) tid;
+    packet->payload[1] = content;
+
+    /* address(28:0)|wdptr|xamsbs(1:0) */
+    /* wrsize also contains wdptr in the lower nibble. */
+    content = (uint32_t) (address & 0xfffffff8ul);
+    content |= (uint32_t) ((((uint32_t) wrsize) & 0x000ful) << 2);
+    packet->payload[2] = content;
+
+    /* Place the operands into the payload of the packet. */
+    /* This function also calculates the CRC. */
+    if(transaction == (uint8_t) RIOPACKET_TRANSACTION_WRITE_ATOMIC_COMPARE_AND_SWAP)
+    {
+      payload[0] = (uint8_t) (compare >> 24);
+      payload[1] = (uint8_t) (compare >> 16);
+      payload[2] = (uint8_t) (compare >> 8);
+      payload[3] = (uint8_t) compare;
+      payload[4] = (uint8_t) (data >> 24);
+      payload[5] = (uint8_t) (data >> 16);
+      payload[6] = (uint8_t) (data >> 8);
+      payload[7] = (uint8_t) data;
+      packet->size = setPacketPayload(&(packet->payload[0]), 12u, 0u, 8u, payload);
+    }
+    else
+    {
+      payload[0] = (uint8_t) (data >> 24);
+      payload[1] = (uint8_t) (data >> 16);
+      payload[2] = (uint8_t) (data >> 8);
+      payload[3] = (uint8_t) data;
+      packet->size = setPacketPayload(&(packet->payload[0]), 12u, (uint16_t) (address & 0x7ul), 
+                                      4u, payload);
+    }
+  }
+  else
+  {
+    /* The address is not word aligned. */
+    /* Cannot create a packet from these arguments, indicate this by setting the packet size to zero. */
+    packet->size = 0u;
+  }
 }
 
 
-uint16_t RIOPACKET_getResponseWithPayload(const RioPacket_t *packet, 
-                                          uint16_t *dstId, uint16_t *srcId, 
-                                          uint8_t *tid, uint8_t offset, 
-                                          uint16_t payloadSize, uint8_t *payload)
+uint16_t RIOPACKET_getAtomicWrite(const RioPacket_t *packet, uint16_t *dstId, uint16_t *srcId, uint8_t *tid, 
+                                  uint8_t *transaction, uint32_t *address, uint32_t *data, uint32_t *compare)
 {
-  uint16_t returnValue ;
+  uint8_t offset = 0u;
+  uint16_t size = 0u;
+  uint8_t payload[8];
+
 
-  
   ASSERT(packet != NULL, "Invalid packet pointer");
+  ASSERT(TT_GET(packet->payload) == (uint8_t) RIOPACKET_TT_16BITS, "Unsupported transport type");
   ASSERT(dstId != NULL, "Invalid dstId pointer");
   ASSERT(srcId != NULL, "Invalid srcId pointer");
   ASSERT(tid != NULL, "Invalid tid pointer");
-  ASSERT(payload != NULL, "Invalid payload pointer");
+  ASSERT(transaction != NULL, "Invalid transaction pointer");
+  ASSERT(address != NULL, "Invalid address pointer");
+  ASSERT(data != NULL, "Invalid data pointer");
+  ASSERT(compare != NULL, "Invalid compare pointer");
+
+  wrsizeToOffset(WRSIZE_GET(packet->payload), WDPTR_GET(packet->payload), &offset, &size);
 
   *dstId = DESTID_GET(packet->payload);
   *srcId = SRCID_GET(packet->payload);
   *tid = TID_GET(packet->payload);
-  if(payloadSize != 0u)
+  *transaction = TRANSACTION_GET(packet->payload);
+  *address = ADDRESS_GET(packet->payload) | offset;
+
+  if(*transaction == (uint8_t) RIOPACKET_TRANSACTION_WRITE_ATOMIC_COMPARE_AND_SWAP)
   {
-    returnValue =
-      getPacketPayload(&(packet->payload[0]), 8u, ((uint16_t) offset) & 0x7u, 
-                       payloadSize, payload);
+    (void) getPacketPayload(&(packet->payload[0]), 12u, 0u, 8u, payload);
+    *compare = ((uint32_t) payload[0] << 24) | ((uint32_t) payload[1] << 16) | 
+      ((uint32_t) payload[2] << 8) | (uint32_t) payload[3];
+    *data = ((uint32_t) payload[4] << 24) | ((uint32_t) payload[5] << 16) | 
+      ((uint32_t) payload[6] << 8) | (uint32_t) payload[7];
   }
   else
   {
-    returnValue =
-      getPacketPayload(&(packet->payload[0]), 8u, ((uint16_t) offset) & 0x7u, 
-                       (((uint16_t) packet->size)-3u)*4u, payload);
+    (void) getPacketPayload(&(packet->payload[0]), 12u, (uint16_t) offset, 4u, payload);
+    *compare = 0ul;
+    *data = ((uint32_t) payload[0] << 24) | ((uint32_t) payload[1] << 16) | 
+      ((uint32_t) payload[2] << 8) | (uint32_t) payload[3];
   }
 
-  return returnValue;
+  return size;
 }
 
 
-void RIOPACKET_setResponseMessage(RioPacket_t *packet, 
-                                  uint16_t dstId, uint16_t srcId, 
-                                  uint8_t mailbox, uint8_t status)
+
+/*******************************************************************************************
+ * Logical message passing DOORBELL and MESSAGE functions.
+ *******************************************************************************************/
+
+void RIOPACKET_setFlowControl(RioPacket_t *packet, uint16_t dstId, uint16_t srcId, 
+                              uint8_t xon, uint8_t flowId, uint16_t tgtdestId)
 {
   uint32_t content;
   uint16_t crc = 0xffffu;
 
 
   ASSERT(packet != NULL, "Invalid packet pointer");
+  ASSERT(flowId < 128u, "Invalid flowId");
 
   /* ackId(4:0)|0|vc|crf|prio(1:0)|tt(1:0)|ftype(3:0)|destinationId(15:0) */
   /* ackId is set when the packet is transmitted. */
-  content = ((uint32_t) RIOPACKET_TT_16BITS) << 20;
-  content |= ((uint32_t) RIOPACKET_FTYPE_RESPONSE) << 16;
+  /* Flow control packets are sent with crf set and the highest priority. */
+  content = 0x01c00000ul;
+  content |= ((uint32_t) RIOPACKET_TT_16BITS) << 20;
+  content |= ((uint32_t) RIOPACKET_FTYPE_FLOW_CONTROL) << 16;
   content |= (uint32_t) dstId;
   crc = RIOPACKET_crc32(content, crc);
   packet->payload[0] = content;
 
-  /* sourceId(15:0)|transaction(3:0)|status(3:0)|letter(1:0|mbox(1:0)|msgseg(3:0) */
+  /* sourceId(15:0)|xon/xoff|flowId(6:0)|tgtdestId(15:8) */
   content = ((uint32_t) srcId) << 16;
-  content |= ((uint32_t) RIOPACKET_TRANSACTION_RESPONSE_MESSAGE_RESPONSE) << 12;
-  content |= (uint32_t) ((((uint32_t) status) & 0xful) << 8);
-  content |= (uint32_t) ((((uint32_t) mailbox) & 0xful) << 4);
-  content |= (uint32_t) (((uint32_t) mailbox) >> 4);
+  content |= (xon != 0u) ? 0x00008000ul : 0x00000000ul;
+  content |= ((uint32_t) flowId & 0x7ful) << 8;
+  content |= ((uint32_t) tgtdestId) >> 8;
   crc = RIOPACKET_crc32(content, crc);
   packet->payload[1] = content;
 
-  /* crc(15:0)|pad(15:0) */
-  content = ((uint32_t) crc) << 16;
+  /* tgtdestId(7:0)|soc|rsrv(6:0)|crc(15:0) */
+  /* The source of congestion is an endpoint. */
+  content = ((uint32_t) tgtdestId & 0xfful) << 24;
+  content |= 0x00800000ul;
+  crc = RIOPACKET_crc16((uint16_t) (content >> 16), crc);
+  content |= crc;
   packet->payload[2] = content;
 
   /* Set the size of the packet. */
@@ -1485,166 +1944,926 @@ void RIOPACKET_setResponseMessage(RioPacket_t *packet,
 }
 
 
-void RIOPACKET_getResponseMessage(const RioPacket_t *packet, 
-                                  uint16_t *dstId, uint16_t *srcId, 
-                                  uint8_t *mailbox, uint8_t *status)
+void RIOPACKET_getFlowControl(const RioPacket_t *packet, uint16_t *dstId, uint16_t *srcId, 
+                              uint8_t *xon, uint8_t *flowId, uint16_t *tgtdestId)
 {
   ASSERT(packet != NULL, "Invalid packet pointer");
+  ASSERT(TT_GET(packet->payload) == (uint8_t) RIOPACKET_TT_16BITS, "Unsupported transport type");
   ASSERT(dstId != NULL, "Invalid dstId pointer");
   ASSERT(srcId != NULL, "Invalid srcId pointer");
-  ASSERT(mailbox != NULL, "Invalid mailbox pointer");
-  ASSERT(status != NULL, "Invalid status pointer");
+  ASSERT(xon != NULL, "Invalid xon pointer");
+  ASSERT(flowId != NULL, "Invalid flowId pointer");
+  ASSERT(tgtdestId != NULL, "Invalid tgtdestId pointer");
 
   *dstId = DESTID_GET(packet->payload);
   *srcId = SRCID_GET(packet->payload);
-  *mailbox = XMBOX_GET(packet->payload);
-  *mailbox <<= 2;
-  *mailbox |= LETTER_GET(packet->payload);
-  *mailbox <<= 2;
-  *mailbox |= MBOX_GET(packet->payload);
-  *status = STATUS_GET(packet->payload);
+  *xon = XON_GET(packet->payload);
+  *flowId = FLOWID_GET(packet->payload);
+  *tgtdestId = TGTDESTID_GET(packet->payload);
 }
 
 
-uint16_t RIOPACKET_crc16(const uint16_t data, const uint16_t crc)
+void RIOPACKET_setDoorbell(RioPacket_t *packet, uint16_t dstId, uint16_t srcId, uint8_t tid, 
+                           uint16_t info)
 {
-  static const uint16_t crcTable[] = {
-    0x0000u, 0x1021u, 0x2042u, 0x3063u, 0x4084u, 0x50a5u, 0x60c6u, 0x70e7u,
-    0x8108u, 0x9129u, 0xa14au, 0xb16bu, 0xc18cu, 0xd1adu, 0xe1ceu, 0xf1efu,
-    0x1231u, 0x0210u, 0x3273u, 0x2252u, 0x52b5u, 0x4294u, 0x72f7u, 0x62d6u,
-    0x9339u, 0x8318u, 0xb37bu, 0xa35au, 0xd3bdu, 0xc39cu, 0xf3ffu, 0xe3deu,
-    0x2462u, 0x3443u, 0x0420u, 0x1401u, 0x64e6u, 0x74c7u, 0x44a4u, 0x5485u,
-    0xa56au, 0xb54bu, 0x8528u, 0x9509u, 0xe5eeu, 0xf5cfu, 0xc5acu, 0xd58du,
-    0x3653u, 0x2672u, 0x1611u, 0x0630u, 0x76d7u, 0x66f6u, 0x5695u, 0x46b4u,
-    0xb75bu, 0xa77au, 0x9719u, 0x8738u, 0xf7dfu, 0xe7feu, 0xd79du, 0xc7bcu,
-    0x48c4u, 0x58e5u, 0x6886u, 0x78a7u, 0x0840u, 0x1861u, 0x2802u, 0x3823u,
-    0xc9ccu, 0xd9edu, 0xe98eu, 0xf9afu, 0x8948u, 0x9969u, 0xa90au, 0xb92bu,
-    0x5af5u, 0x4ad4u, 0x7ab7u, 0x6a96u, 0x1a71u, 0x0a50u, 0x3a33u, 0x2a12u,
-    0xdbfdu, 0xcbdcu, 0xfbbfu, 0xeb9eu, 0x9b79u, 0x8b58u, 0xbb3bu, 0xab1au,
-    0x6ca6u, 0x7c87u, 0x4ce4u, 0x5cc5u, 0x2c22u, 0x3c03u, 0x0c60u, 0x1c41u,
-    0xedaeu, 0xfd8fu, 0xcdecu, 0xddcdu, 0xad2au, 0xbd0bu, 0x8d68u, 0x9d49u,
-    0x7e97u, 0x6eb6u, 0x5ed5u, 0x4ef4u, 0x3e13u, 0x2e32u, 0x1e51u, 0x0e70u,
-    0xff9fu, 0xefbeu, 0xdfddu, 0xcffcu, 0xbf1bu, 0xaf3au, 0x9f59u, 0x8f78u,
-    0x9188u, 0x81a9u, 0xb1cau, 0xa1ebu, 0xd10cu, 0xc12du, 0xf14eu, 0xe16fu,
-    0x1080u, 0x00a1u, 0x30c2u, 0x20e3u, 0x5004u, 0x4025u, 0x7046u, 0x6067u,
-    0x83b9u, 0x9398u, 0xa3fbu, 0xb3dau, 0xc33du, 0xd31cu, 0xe37fu, 0xf35eu,
-    0x02b1u, 0x1290u, 0x22f3u, 0x32d2u, 0x4235u, 0x5214u, 0x6277u, 0x7256u,
-    0xb5eau, 0xa5cbu, 0x95a8u, 0x8589u, 0xf56eu, 0xe54fu, 0xd52cu, 0xc50du,
-    0x34e2u, 0x24c3u, 0x14a0u, 0x0481u, 0x7466u, 0x6447u, 0x5424u, 0x4405u,
-    0xa7dbu, 0xb7fau, 0x8799u, 0x97b8u, 0xe75fu, 0xf77eu, 0xc71du, 0xd73cu,
-    0x26d3u, 0x36f2u, 0x0691u, 0x16b0u, 0x6657u, 0x7676u, 0x4615u, 0x5634u,
-    0xd94cu, 0xc96du, 0xf90eu, 0xe92fu, 0x99c8u, 0x89e9u, 0xb98au, 0xa9abu,
-    0x5844u, 0x4865u, 0x7806u, 0x6827u, 0x18c0u, 0x08e1u, 0x3882u, 0x28a3u,
-    0xcb7du, 0xdb5cu, 0xeb3fu, 0xfb1eu, 0x8bf9u, 0x9bd8u, 0xabbbu, 0xbb9au,
-    0x4a75u, 0x5a54u, 0x6a37u, 0x7a16u, 0x0af1u, 0x1ad0u, 0x2ab3u, 0x3a92u,
-    0xfd2eu, 0xed0fu, 0xdd6cu, 0xcd4du, 0xbdaau, 0xad8bu, 0x9de8u, 0x8dc9u,
-    0x7c26u, 0x6c07u, 0x5c64u, 0x4c45u, 0x3ca2u, 0x2c83u, 0x1ce0u, 0x0cc1u,
-    0xef1fu, 0xff3eu, 0xcf5du, 0xdf7cu, 0xaf9bu, 0xbfbau, 0x8fd9u, 0x9ff8u,
-    0x6e17u, 0x7e36u, 0x4e55u, 0x5e74u, 0x2e93u, 0x3eb2u, 0x0ed1u, 0x1ef0u
-  };
+  uint32_t content;
+  uint16_t crc = 0xffffu;
 
-  uint16_t result;
-  uint8_t index;
-  
 
-  result = crc;
-  index = (uint8_t) ((data >> 8) ^ (result >> 8));
-  result = (uint16_t) (crcTable[index] ^ (uint16_t)(result << 8));
-  index = (uint8_t) ((data) ^ (result >> 8));
-  result = (uint16_t) (crcTable[index] ^ (uint16_t)(result << 8));
+  ASSERT(packet != NULL, "Invalid packet pointer");
 
-  return result;
-}
+  /* ackId(4:0)|0|vc|crf|prio(1:0)|tt(1:0)|ftype(3:0)|destinationId(15:0) */
+  /* ackId is set when the packet is transmitted. */
+  content = ((uint32_t) RIOPACKET_TT_16BITS) << 20;
+  content |= ((uint32_t) RIOPACKET_FTYPE_DOORBELL) << 16;
+  content |= (uint32_t) dstId;
+  crc = RIOPACKET_crc32(content, crc);
+  packet->payload[0] = content;
 
+  /* sourceId(15:0)|rsrv(7:0)|srcTID(7:0) */
+  content = ((uint32_t) srcId) << 16;
+  content |= (uint32_t) tid;
+  crc = RIOPACKET_crc32(content, crc);
+  packet->payload[1] = content;
 
-uint16_t RIOPACKET_crc32(const uint32_t data, uint16_t crc)
-{
-  crc = RIOPACKET_crc16((uint16_t) (data >> 16), crc);
-  crc = RIOPACKET_crc16((uint16_t) (data), crc);
-  return crc;
+  /* infoMSB(7:0)|infoLSB(7:0)|crc(15:0) */
+  content = ((uint32_t) info) << 16;
+  crc = RIOPACKET_crc16(info, crc);
+  content |= crc;
+  packet->payload[2] = content;
+
+  /* Set the size of the packet. */
+  packet->size = 3u;
 }
 
 
-uint32_t RIOPACKET_getWritePacketSize(uint32_t address, uint32_t size)
+void RIOPACKET_getDoorbell(const RioPacket_t *packet, uint16_t *dstId, uint16_t *srcId, uint8_t *tid, 
+                           uint16_t *info)
 {
-  uint32_t returnValue;
+  ASSERT(packet != NULL, "Invalid packet pointer");
+  ASSERT(TT_GET(packet->payload) == (uint8_t) RIOPACKET_TT_16BITS, "Unsupported transport type");
+  ASSERT(dstId != NULL, "Invalid dstId pointer");
+  ASSERT(srcId != NULL, "Invalid srcId pointer");
+  ASSERT(tid != NULL, "Invalid tid pointer");
+  ASSERT(info != NULL, "Invalid info pointer");
 
-  if(size > 0u)
-  {
-    switch(address%8u)
-    {
-      case 0:
-        if(size >= 256u)
-        {
-          returnValue = 256u;
-        }
-        else if(size >= 8u)
-        {
-          returnValue = size - (size % 8u);
-        }
-        else
-        {
-          returnValue = size;
-        }
-        break;
+  *dstId = DESTID_GET(packet->payload);
+  *srcId = SRCID_GET(packet->payload);
+  *tid = TID_GET(packet->payload);
+  *info = INFO_GET(packet->payload);
+}
 
-      case 1:
-        if(size >= 7u)
-        {
-          returnValue = 7u;
-        }
-        else
-        {
-          returnValue = 1u;
-        }
-        break;
 
-      case 2:
-        if(size >= 6u)
-        {
-          returnValue = 6u;
-        }
-        else if(size >= 2u)
-        {
-          returnValue = 2u;
-        }
-        else
-        {
-          returnValue = 1u;
-        }
-        break;
+void RIOPACKET_setMessage(RioPacket_t *packet, uint16_t dstId, uint16_t srcId, uint8_t mailbox, 
+                          uint16_t payloadSize, const uint8_t *payload)
+{
+  uint32_t content;
 
-      case 3:
-        if(size >= 5u)
-        {
-          returnValue = 5u;
-        }
-        else
-        {
-          returnValue = 1u;
-        }
-        break;
 
-      case 4:
-        if(size >= 4u)
-        {
-          returnValue = 4u;
-        }
-        else if(size >= 2u)
-        {
-          returnValue = 2u;
-        }
-        else
-        {
-          returnValue = 1u;
-        }
-        break;
+  ASSERT(packet != NULL, "Invalid packet pointer");
+  ASSERT(payloadSize <= 256u, "Invalid payload size");
 
-      case 5:
-        if(size >= 3u)
-        {
-          returnValue = 3u;
-        }
+  /* Make sure that the message payload size is larger than zero. */
+  if((payloadSize > 0u) && (payloadSize <= 256u))
+  {
+    /* The payload size is larger than zero. */
+
+    /* ackId(4:0)|0|vc|crf|prio(1:0)|tt(1:0)|ftype(3:0)|destinationId(15:0) */
+    /* ackId is set when the packet is transmitted. */
+    content = ((uint32_t) RIOPACKET_TT_16BITS) << 20;
+    content |= ((uint32_t) RIOPACKET_FTYPE_MESSAGE) << 16;
+    content |= (uint32_t) dstId;
+    packet->payload[0] = content;
+  
+    /* sourceId(15:0)|msglen(3:0)|ssize(3:0)|letter(1:0)|mbox(1:0)|msgseg(3:0)/xmbox(3:0) */
+    content = ((uint32_t) srcId) << 16;
+    if(payloadSize <= 8u)
+    {
+      content |= (uint32_t) 0x00000900ul;
+    }
+    else if(payloadSize <= 16u)
+    {
+      content |= (uint32_t) 0x00000a00ul;
+    }
+    else if(payloadSize <= 32u)
+    {
+      content |= (uint32_t) 0x00000b00ul;
+    }
+    else if(payloadSize <= 64u)
+    {
+      content |= (uint32_t) 0x00000c00ul;
+    }
+    else if(payloadSize <= 128u)
+    {
+      content |= (uint32_t) 0x00000d00ul;
+    }
+    else
+    {
+      content |= (uint32_t) 0x00000e00ul;
+    }
+    content |= (uint32_t) ((((uint32_t) mailbox) & 0xful) << 4);
+    content |= (uint32_t) (((uint32_t) mailbox) >> 4);
+    packet->payload[1] = content;
+
+    /* Place data buffer into the payload of the packet and set the size. */
+    packet->size = setPacketPayload(&(packet->payload[0]), 8u, 0u, payloadSize, payload);
+  }
+  else
+  {
+    /* The payload size is not allowed. */
+    /* Unable to create the new packet. */
+    packet->size = 0u;
+  }
+}
+
+
+void RIOPACKET_getMessage(const RioPacket_t *packet, uint16_t *dstId, uint16_t *srcId, uint8_t *mailbox, 
+                          uint16_t *payloadSize, uint8_t *payload)
+{
+  ASSERT(packet != NULL, "Invalid packet pointer");
+  ASSERT(TT_GET(packet->payload) == (uint8_t) RIOPACKET_TT_16BITS, "Unsupported transport type");
+  ASSERT(dstId != NULL, "Invalid dstId pointer");
+  ASSERT(srcId != NULL, "Invalid srcId pointer");
+  ASSERT(mailbox != NULL, "Invalid mailbox pointer");
+  ASSERT(payloadSize != NULL, "Invalid payloadSize pointer");
+  ASSERT(payload != NULL, "Invalid payload pointer");
+
+  *dstId = DESTID_GET(packet->payload);
+  *srcId = SRCID_GET(packet->payload);
+  *mailbox = XMBOX_GET(packet->payload);
+  *mailbox <<= 2;
+  *mailbox |= LETTER_GET(packet->payload);
+  *mailbox <<= 2;
+  *mailbox |= MBOX_GET(packet->payload);
+  *payloadSize = getPacketPayload(&(packet->payload[0]), 8u, 0u, 
+                                  (((uint16_t) packet->size)-3u)*4u, payload);
+}
+
+
+
+
+/*******************************************************************************************
+ * Logical data streaming functions.
+ *******************************************************************************************/
+
+void RIOPACKET_setDataStreaming(RioPacket_t *packet, uint16_t dstId, uint16_t srcId, 
+                                uint8_t cos, uint8_t segment, uint16_t streamId,
+                                uint16_t payloadSize, const uint8_t *payload)
+{
+  uint32_t content;
+  uint16_t payloadOffset;
+
+
+  ASSERT(packet != NULL, "Invalid packet pointer");
+  ASSERT(payload != NULL, "Invalid payload pointer");
+  ASSERT(payloadSize <= 256u, "Invalid payload size");
+  ASSERT(segment <= (uint8_t) RIOPACKET_SEGMENT_SINGLE, "Invalid segment");
+
+  /* ackId(4:0)|0|vc|crf|prio(1:0)|tt(1:0)|ftype(3:0)|destinationId(15:0) */
+  /* ackId is set when the packet is transmitted. */
+  content = ((uint32_t) RIOPACKET_TT_16BITS) << 20;
+  content |= ((uint32_t) RIOPACKET_FTYPE_DATA_STREAMING) << 16;
+  content |= (uint32_t) dstId;
+  packet->payload[0] = content;
+
+  /* sourceId(15:0)|cos(7:0)|S|E|rsrv(2:0)|xh|O|P */
+  /* O is set if the payload contains an odd number of half-words and P if the 
+     last half-word contains a pad byte. */
+  content = ((uint32_t) srcId) << 16;
+  content |= ((uint32_t) cos) << 8;
+  content |= (((uint32_t) segment) & 0x3ul) << 6;
+  content |= (uint32_t) ((((payloadSize+1u) >> 1) & 0x1u) << 1);
+  content |= (uint32_t) (payloadSize & 0x1u);
+  packet->payload[1] = content;
+
+  /* Only start, end and single segments contain the streamID/length field. */
+  if(segment != (uint8_t) RIOPACKET_SEGMENT_CONTINUATION)
+  {
+    /* streamID(15:0)|<payload> */
+    packet->payload[2] = ((uint32_t) streamId) << 16;
+    payloadOffset = 10u;
+  }
+  else
+  {
+    /* <payload> */
+    payloadOffset = 8u;
+  }
+
+  /* Place the payload buffer into the payload of the packet. The payload is padded 
+     to a half-word. This function also calculates the CRC. */
+  packet->size = setPacketPayloadAligned(&(packet->payload[0]), payloadOffset, 0u, 
+                                         payloadSize, payload, 2u);
+}
+
+
+void RIOPACKET_getDataStreaming(const RioPacket_t *packet, uint16_t *dstId, uint16_t *srcId, 
+                                uint8_t *cos, uint8_t *segment, uint16_t *streamId,
+                                uint16_t *payloadSize, uint8_t *payload)
+{
+  uint16_t payloadOffset;
+
+
+  ASSERT(packet != NULL, "Invalid packet pointer");
+  ASSERT(TT_GET(packet->payload) == (uint8_t) RIOPACKET_TT_16BITS, "Unsupported transport type");
+  ASSERT(dstId != NULL, "Invalid dstId pointer");
+  ASSERT(srcId != NULL, "Invalid srcId pointer");
+  ASSERT(cos != NULL, "Invalid cos pointer");
+  ASSERT(segment != NULL, "Invalid segment pointer");
+  ASSERT(streamId != NULL, "Invalid streamId pointer");
+  ASSERT(payloadSize != NULL, "Invalid payloadSize pointer");
+  ASSERT(payload != NULL, "Invalid payload pointer");
+
+  *dstId = DESTID_GET(packet->payload);
+  *srcId = SRCID_GET(packet->payload);
+  *cos = COS_GET(packet->payload);
+  *segment = SEGMENT_GET(packet->payload);
+  if(*segment != (uint8_t) RIOPACKET_SEGMENT_CONTINUATION)
+  {
+    *streamId = STREAMID_GET(packet->payload);
+    payloadOffset = 10u;
+  }
+  else
+  {
+    *streamId = 0u;
+    payloadOffset = 8u;
+  }
+
+  *payloadSize = getPacketPayload(&(packet->payload[0]), payloadOffset, 0u, 
+                                  getDataStreamingPayloadSize(packet, payloadOffset), payload);
+}
+
+
+uint16_t RIOPACKET_getDataStreamingSize(const RioPacket_t *packet)
+{
+  uint16_t payloadOffset;
+
+
+  ASSERT(packet != NULL, "Invalid packet pointer");
+  ASSERT(TT_GET(packet->payload) == (uint8_t) RIOPACKET_TT_16BITS, "Unsupported transport type");
+
+  if(SEGMENT_GET(packet->payload) != (uint8_t) RIOPACKET_SEGMENT_CONTINUATION)
+  {
+    payloadOffset = 10u;
+  }
+  else
+  {
+    payloadOffset = 8u;
+  }
+
+  return getDataStreamingPayloadSize(packet, payloadOffset);
+}
+
+
+/*******************************************************************************************
+ * Logical I/O RESPONSE-DONE-PAYLOAD, RESPONSE-DONE, RESPONSE-RETRY and RESPONSE-ERROR 
+ * functions.
+ *******************************************************************************************/
+
+void RIOPACKET_setResponseNoPayload(RioPacket_t *packet, 
+                                    uint16_t dstId, uint16_t srcId, 
+                                    uint8_t tid, uint8_t status)
+{
+  uint32_t content;
+  uint16_t crc = 0xffffu;
+
+
+  ASSERT(packet != NULL, "Invalid packet pointer");
+
+  /* ackId(4:0)|0|vc|crf|prio(1:0)|tt(1:0)|ftype(3:0)|destinationId(15:0) */
+  /* ackId is set when the packet is transmitted. */
+  content = ((uint32_t) RIOPACKET_TT_16BITS) << 20;
+  content |= ((uint32_t) RIOPACKET_FTYPE_RESPONSE) << 16;
+  content |= (uint32_t) dstId;
+  crc = RIOPACKET_crc32(content, crc);
+  packet->payload[0] = content;
+
+  /* sourceId(15:0)|transaction(3:0)|status(3:0)|targetTID(7:0) */
+  content = ((uint32_t) srcId) << 16;
+  content |= ((uint32_t) RIOPACKET_TRANSACTION_RESPONSE_NO_PAYLOAD) << 12; /*lint !e835 !e845 The constant value is zero. */
+  content |= (uint32_t) ((((uint32_t) status) & 0xful) << 8);
+  content |= (uint32_t) tid;
+  crc = RIOPACKET_crc32(content, crc);
+  packet->payload[1] = content;
+
+  /* crc(15:0)|pad(15:0) */
+  content = ((uint32_t) crc) << 16;
+  packet->payload[2] = content;
+
+  /* Set the size of the packet. */
+  packet->size = 3u;
+}
+
+
+void RIOPACKET_getResponseNoPayload(const RioPacket_t *packet, 
+                                    uint16_t *dstId, uint16_t *srcId, 
+                                    uint8_t *tid, uint8_t *status)
+{
+  ASSERT(packet != NULL, "Invalid packet pointer");
+  ASSERT(TT_GET(packet->payload) == (uint8_t) RIOPACKET_TT_16BITS, "Unsupported transport type");
+  ASSERT(dstId != NULL, "Invalid dstId pointer");
+  ASSERT(srcId != NULL, "Invalid srcId pointer");
+  ASSERT(tid != NULL, "Invalid tid pointer");
+  ASSERT(status != NULL, "Invalid status pointer");
+
+  *dstId = DESTID_GET(packet->payload);
+  *srcId = SRCID_GET(packet->payload);
+  *tid = TID_GET(packet->payload);
+  *status = STATUS_GET(packet->payload);
+}
+
+
+
+void RIOPACKET_setResponseWithPayload(RioPacket_t *packet, 
+                                      uint16_t dstId, uint16_t srcId, 
+                                      uint8_t tid, uint8_t offset, 
+                                      uint16_t payloadSize, const uint8_t *payload)
+{
+  uint32_t content;
+
+
+  ASSERT(packet != NULL, "Invalid packet pointer");
+  ASSERT(payload != NULL, "Invalid payload pointer");
+  ASSERT(payloadSize <= 256u, "Invalid payload size");
+
+  /* ackId(4:0)|0|vc|crf|prio(1:0)|tt(1:0)|ftype(3:0)|destinationId(15:0) */
+  /* ackId is set when the packet is transmitted. */
+  content = ((uint32_t) RIOPACKET_TT_16BITS) << 20;
+  content |= ((uint32_t) RIOPACKET_FTYPE_RESPONSE) << 16;
+  content |= (uint32_t) dstId;
+  packet->payload[0] = content;
+    
+  /* sourceId(15:0)|transaction(3:0)|status(3:0)|targetTID(7:0) */
+  /* status=DONE is 0. */
+  content = ((uint32_t) srcId) << 16;
+  content |= ((uint32_t) RIOPACKET_TRANSACTION_RESPONSE_WITH_PAYLOAD) << 12;
+  content |= (uint32_t) tid;
+  packet->payload[1] = content;
+
+  packet->size = setPacketPayload(&(packet->payload[0]), 8u, ((uint16_t) offset) & 0x7u, 
+                                  payloadSize, payload);
+}
+
+
+uint16_t RIOPACKET_getResponseWithPayload(const RioPacket_t *packet, 
+                                          uint16_t *dstId, uint16_t *srcId, 
+                                          uint8_t *tid, uint8_t offset, 
+                                          uint16_t payloadSize, uint8_t *payload)
+{
+  uint16_t returnValue ;
+
+  
+  ASSERT(packet != NULL, "Invalid packet pointer");
+  ASSERT(TT_GET(packet->payload) == (uint8_t) RIOPACKET_TT_16BITS, "Unsupported transport type");
+  ASSERT(dstId != NULL, "Invalid dstId pointer");
+  ASSERT(srcId != NULL, "Invalid srcId pointer");
+  ASSERT(tid != NULL, "Invalid tid pointer");
+  ASSERT(payload != NULL, "Invalid payload pointer");
+
+  *dstId = DESTID_GET(packet->payload);
+  *srcId = SRCID_GET(packet->payload);
+  *tid = TID_GET(packet->payload);
+  if(payloadSize != 0u)
+  {
+    returnValue =
+      getPacketPayload(&(packet->payload[0]), 8u, ((uint16_t) offset) & 0x7u, 
+                       payloadSize, payload);
+  }
+  else
+  {
+    returnValue =
+      getPacketPayload(&(packet->payload[0]), 8u, ((uint16_t) offset) & 0x7u, 
+                       (((uint16_t) packet->size)-3u)*4u, payload);
+  }
+
+  return returnValue;
+}
+
+
+void RIOPACKET_setResponseMessage(RioPacket_t *packet, 
+                                  uint16_t dstId, uint16_t srcId, 
+                                  uint8_t mailbox, uint8_t status)
+{
+  uint32_t content;
+  uint16_t crc = 0xffffu;
+
+
+  ASSERT(packet != NULL, "Invalid packet pointer");
+
+  /* ackId(4:0)|0|vc|crf|prio(1:0)|tt(1:0)|ftype(3:0)|destinationId(15:0) */
+  /* ackId is set when the packet is transmitted. */
+  content = ((uint32_t) RIOPACKET_TT_16BITS) << 20;
+  content |= ((uint32_t) RIOPACKET_FTYPE_RESPONSE) << 16;
+  content |= (uint32_t) dstId;
+  crc = RIOPACKET_crc32(content, crc);
+  packet->payload[0] = content;
+
+  /* sourceId(15:0)|transaction(3:0)|status(3:0)|letter(1:0|mbox(1:0)|msgseg(3:0) */
+  content = ((uint32_t) srcId) << 16;
+  content |= ((uint32_t) RIOPACKET_TRANSACTION_RESPONSE_MESSAGE_RESPONSE) << 12;
+  content |= (uint32_t) ((((uint32_t) status) & 0xful) << 8);
+  content |= (uint32_t) ((((uint32_t) mailbox) & 0xful) << 4);
+  content |= (uint32_t) (((uint32_t) mailbox) >> 4);
+  crc = RIOPACKET_crc32(content, crc);
+  packet->payload[1] = content;
+
+  /* crc(15:0)|pad(15:0) */
+  content = ((uint32_t) crc) << 16;
+  packet->payload[2] = content;
+
+  /* Set the size of the packet. */
+  packet->size = 3u;
+}
+
+
+void RIOPACKET_getResponseMessage(const RioPacket_t *packet, 
+                                  uint16_t *dstId, uint16_t *srcId, 
+                                  uint8_t *mailbox, uint8_t *status)
+{
+  ASSERT(packet != NULL, "Invalid packet pointer");
+  ASSERT(TT_GET(packet->payload) == (uint8_t) RIOPACKET_TT_16BITS, "Unsupported transport type");
+  ASSERT(dstId != NULL, "Invalid dstId pointer");
+  ASSERT(srcId != NULL, "Invalid srcId pointer");
+  ASSERT(mailbox != NULL, "Invalid mailbox pointer");
+  ASSERT(status != NULL, "Invalid status pointer");
+
+  *dstId = DESTID_GET(packet->payload);
+  *srcId = SRCID_GET(packet->payload);
+  *mailbox = XMBOX_GET(packet->payload);
+  *mailbox <<= 2;
+  *mailbox |= LETTER_GET(packet->payload);
+  *mailbox <<= 2;
+  *mailbox |= MBOX_GET(packet->payload);
+  *status = STATUS_GET(packet->payload);
+}
+
+
+/*******************************************************************************************
+ * Extended transport and address functions.
+ * These functions builds and decodes packets with 8-bit, 16-bit or 32-bit deviceIds and 
+ * 34-bit, 50-bit or 66-bit addresses. The header is assembled as a byte string since the 
+ * field positions depends on both the transport type and the address size.
+ *******************************************************************************************/
+
+void RIOPACKET_setNreadExt(RioPacket_t *packet, 
+                           RioPacketTt_t tt, RioPacketAddressSize_t addressSize,
+                           uint32_t dstId, uint32_t srcId, uint8_t tid, 
+                           uint64_t address, uint16_t payloadSize)
+{
+  uint8_t header[20];
+  uint16_t index;
+  uint16_t rdsize;
+
+
+  ASSERT(packet != NULL, "Invalid packet pointer");
+
+  /* Convert the address and size to the rdsize field and check if the combination is valid. */
+  rdsize = rdsizeGet((uint32_t) address, payloadSize);
+  if(rdsize != 0xffffu)
+  {
+    /* The address and size field combination is valid. */
+
+    /* ackId(4:0)|0|vc|crf|prio(1:0)|tt(1:0)|ftype(3:0)|destinationId|sourceId */
+    index = setTransportExt(header, tt, (uint8_t) RIOPACKET_FTYPE_REQUEST, dstId, srcId);
+
+    /* transaction(3:0)|rdsize(3:0)|srcTID(7:0) */
+    header[index] = (uint8_t) ((((uint8_t) RIOPACKET_TRANSACTION_REQUEST_NREAD) << 4) | 
+                               ((rdsize >> 8) & 0xfu));
+    header[index+1u] = tid;
+
+    /* extended_address_msb|address(28:0)|wdptr|xamsbs(1:0) */
+    /* rdsize also contains wdptr in the lower nibble. */
+    index = setAddressExt(header, index+2u, addressSize, address, (uint8_t) (rdsize & 0xfu));
+
+    /* An NREAD has no payload, only the header and the CRC. */
+    packet->size = setPacketExt(packet->payload, header, index, 0u, 0u, header);
+  }
+  else
+  {
+    /* The address and size field combination is not valid. */
+    /* Cannot create a packet from these arguments, indicate this by setting the packet size to zero. */
+    packet->size = 0u;
+  }
+}
+
+
+void RIOPACKET_getNreadExt(const RioPacket_t *packet, RioPacketAddressSize_t addressSize,
+                           uint32_t *dstId, uint32_t *srcId, uint8_t *tid, 
+                           uint64_t *address, uint16_t *payloadSize)
+{
+  uint16_t index;
+  uint8_t offset = 0u;
+  uint16_t size = 0u;
+
+
+  ASSERT(packet != NULL, "Invalid packet pointer");
+  ASSERT(dstId != NULL, "Invalid dstId pointer");
+  ASSERT(srcId != NULL, "Invalid srcId pointer");
+  ASSERT(tid != NULL, "Invalid tid pointer");
+  ASSERT(address != NULL, "Invalid address pointer");
+  ASSERT(payloadSize != NULL, "Invalid payloadSize pointer");
+
+  *dstId = RIOPACKET_getDestinationExt(packet);
+  *srcId = RIOPACKET_getSourceExt(packet);
+
+  index = 2u + (2u*idSizeGet(TT_GET(packet->payload)));
+  *tid = (uint8_t) getHeaderBytes(packet->payload, index+1u, 1u);
+  (void) getAddressExt(packet->payload, index+2u, addressSize, address);
+
+  rdsizeToOffset((uint8_t) (getHeaderBytes(packet->payload, index, 1u) & 0xful), 
+                 (uint8_t) ((*address >> 2) & 0x1u), &offset, &size);
+  *address = (*address & ~((uint64_t) 0x7u)) | offset;
+  *payloadSize = size;
+}
+
+
+void RIOPACKET_setNwriteExt(RioPacket_t *packet, 
+                            RioPacketTt_t tt, RioPacketAddressSize_t addressSize,
+                            uint32_t dstId, uint32_t srcId, 
+                            uint64_t address, uint16_t payloadSize, const uint8_t *payload)
+{
+  /* The reserved field is placed where NWRITER has its tid. */
+  setWriteExt(packet, tt, addressSize, (uint8_t) RIOPACKET_TRANSACTION_WRITE_NWRITE, 
+              dstId, srcId, 0u, address, payloadSize, payload);
+}
+
+
+void RIOPACKET_getNwriteExt(const RioPacket_t *packet, RioPacketAddressSize_t addressSize,
+                            uint32_t *dstId, uint32_t *srcId, 
+                            uint64_t *address, uint16_t *payloadSize, uint8_t *payload)
+{
+  uint8_t tid;
+
+
+  /* The reserved field is placed where NWRITER has its tid. */
+  RIOPACKET_getNwriteRExt(packet, addressSize, dstId, srcId, &tid, address, payloadSize, payload);
+}
+
+
+void RIOPACKET_setNwriteRExt(RioPacket_t *packet, 
+                             RioPacketTt_t tt, RioPacketAddressSize_t addressSize,
+                             uint32_t dstId, uint32_t srcId, uint8_t tid, 
+                             uint64_t address, uint16_t payloadSize, const uint8_t *payload)
+{
+  setWriteExt(packet, tt, addressSize, (uint8_t) RIOPACKET_TRANSACTION_WRITE_NWRITER, 
+              dstId, srcId, tid, address, payloadSize, payload);
+}
+
+
+void RIOPACKET_getNwriteRExt(const RioPacket_t *packet, RioPacketAddressSize_t addressSize,
+                             uint32_t *dstId, uint32_t *srcId, uint8_t *tid, 
+                             uint64_t *address, uint16_t *payloadSize, uint8_t *payload)
+{
+  uint16_t transaction;
+  uint16_t index;
+  uint8_t offset = 0u;
+  uint16_t size = 0u;
+
+
+  ASSERT(packet != NULL, "Invalid packet pointer");
+  ASSERT(dstId != NULL, "Invalid dstId pointer");
+  ASSERT(srcId != NULL, "Invalid srcId pointer");
+  ASSERT(tid != NULL, "Invalid tid pointer");
+  ASSERT(address != NULL, "Invalid address pointer");
+  ASSERT(payloadSize != NULL, "Invalid payloadSize pointer");
+  ASSERT(payload != NULL, "Invalid payload pointer");
+
+  *dstId = RIOPACKET_getDestinationExt(packet);
+  *srcId = RIOPACKET_getSourceExt(packet);
+
+  transaction = 2u + (2u*idSizeGet(TT_GET(packet->payload)));
+  *tid = (uint8_t) getHeaderBytes(packet->payload, transaction+1u, 1u);
+  index = getAddressExt(packet->payload, transaction+2u, addressSize, address);
+
+  wrsizeToOffset((uint8_t) (getHeaderBytes(packet->payload, transaction, 1u) & 0xful), 
+                 (uint8_t) ((*address >> 2) & 0x1u), &offset, &size);
+  *address = (*address & ~((uint64_t) 0x7u)) | offset;
+
+  if(size > 16u)
+  {
+    size = getPayloadSizeExt(packet, index);
+  }
+  else
+  {
+    /* The size already contains the correct value. */
+  }
+
+  *payloadSize = getPacketPayload(&(packet->payload[0]), index, (uint16_t) offset, size, payload);
+}
+
+
+void RIOPACKET_setResponseNoPayloadExt(RioPacket_t *packet, RioPacketTt_t tt,
+                                       uint32_t dstId, uint32_t srcId, 
+                                       uint8_t tid, uint8_t status)
+{
+  uint8_t header[12];
+  uint16_t index;
+
+
+  ASSERT(packet != NULL, "Invalid packet pointer");
+
+  /* ackId(4:0)|0|vc|crf|prio(1:0)|tt(1:0)|ftype(3:0)|destinationId|sourceId */
+  index = setTransportExt(header, tt, (uint8_t) RIOPACKET_FTYPE_RESPONSE, dstId, srcId);
+
+  /* transaction(3:0)|status(3:0)|targetTID(7:0) */
+  header[index] = (uint8_t) ((((uint8_t) RIOPACKET_TRANSACTION_RESPONSE_NO_PAYLOAD) << 4) | 
+                             (status & 0xfu));
+  header[index+1u] = tid;
+
+  packet->size = setPacketExt(packet->payload, header, index+2u, 0u, 0u, header);
+}
+
+
+void RIOPACKET_getResponseNoPayloadExt(const RioPacket_t *packet, 
+                                       uint32_t *dstId, uint32_t *srcId, 
+                                       uint8_t *tid, uint8_t *status)
+{
+  uint16_t index;
+
+
+  ASSERT(packet != NULL, "Invalid packet pointer");
+  ASSERT(dstId != NULL, "Invalid dstId pointer");
+  ASSERT(srcId != NULL, "Invalid srcId pointer");
+  ASSERT(tid != NULL, "Invalid tid pointer");
+  ASSERT(status != NULL, "Invalid status pointer");
+
+  *dstId = RIOPACKET_getDestinationExt(packet);
+  *srcId = RIOPACKET_getSourceExt(packet);
+
+  index = 2u + (2u*idSizeGet(TT_GET(packet->payload)));
+  *status = (uint8_t) (getHeaderBytes(packet->payload, index, 1u) & 0xful);
+  *tid = (uint8_t) getHeaderBytes(packet->payload, index+1u, 1u);
+}
+
+
+void RIOPACKET_setResponseWithPayloadExt(RioPacket_t *packet, RioPacketTt_t tt,
+                                         uint32_t dstId, uint32_t srcId, 
+                                         uint8_t tid, uint8_t offset, 
+                                         uint16_t payloadSize, const uint8_t *payload)
+{
+  uint8_t header[12];
+  uint16_t index;
+
+
+  ASSERT(packet != NULL, "Invalid packet pointer");
+  ASSERT(payload != NULL, "Invalid payload pointer");
+  ASSERT(payloadSize <= 256u, "Invalid payload size");
+
+  /* ackId(4:0)|0|vc|crf|prio(1:0)|tt(1:0)|ftype(3:0)|destinationId|sourceId */
+  index = setTransportExt(header, tt, (uint8_t) RIOPACKET_FTYPE_RESPONSE, dstId, srcId);
+
+  /* transaction(3:0)|status(3:0)|targetTID(7:0) */
+  /* status=DONE is 0. */
+  header[index] = (uint8_t) (((uint8_t) RIOPACKET_TRANSACTION_RESPONSE_WITH_PAYLOAD) << 4);
+  header[index+1u] = tid;
+
+  packet->size = setPacketExt(packet->payload, header, index+2u, 
+                              ((uint16_t) offset) & 0x7u, payloadSize, payload);
+}
+
+
+uint16_t RIOPACKET_getResponseWithPayloadExt(const RioPacket_t *packet, 
+                                             uint32_t *dstId, uint32_t *srcId, 
+                                             uint8_t *tid, uint8_t offset, 
+                                             uint16_t payloadSize, uint8_t *payload)
+{
+  uint16_t index;
+  uint16_t size;
+
+
+  ASSERT(packet != NULL, "Invalid packet pointer");
+  ASSERT(dstId != NULL, "Invalid dstId pointer");
+  ASSERT(srcId != NULL, "Invalid srcId pointer");
+  ASSERT(tid != NULL, "Invalid tid pointer");
+  ASSERT(payload != NULL, "Invalid payload pointer");
+
+  *dstId = RIOPACKET_getDestinationExt(packet);
+  *srcId = RIOPACKET_getSourceExt(packet);
+
+  index = 2u + (2u*idSizeGet(TT_GET(packet->payload)));
+  *tid = (uint8_t) getHeaderBytes(packet->payload, index+1u, 1u);
+  index += 2u;
+
+  if(payloadSize != 0u)
+  {
+    size = payloadSize;
+  }
+  else
+  {
+    size = getPayloadSizeExt(packet, index) - (((uint16_t) offset) & 0x7u);
+  }
+
+  return getPacketPayload(&(packet->payload[0]), index, ((uint16_t) offset) & 0x7u, size, payload);
+}
+
+
+/*******************************************************************************************
+ * Packet template functions.
+ *******************************************************************************************/
+
+void RIOPACKET_setNwriteTemplate(RioPacketTemplate_t *packetTemplate,
+                                 uint16_t dstId, uint16_t srcId, uint16_t payloadSize)
+{
+  ASSERT(packetTemplate != NULL, "Invalid template pointer");
+
+  /* The tid field is reserved, the address is the first varying field. */
+  setNwriteTemplate(packetTemplate, RIOPACKET_TRANSACTION_WRITE_NWRITE, dstId, srcId, payloadSize);
+  packetTemplate->fixed = 2u;
+  packetTemplate->crc = RIOPACKET_crc32(packetTemplate->header[1], packetTemplate->crc);
+}
+
+
+void RIOPACKET_setNwriteRTemplate(RioPacketTemplate_t *packetTemplate,
+                                  uint16_t dstId, uint16_t srcId, uint16_t payloadSize)
+{
+  ASSERT(packetTemplate != NULL, "Invalid template pointer");
+
+  /* The tid is the first varying field. */
+  setNwriteTemplate(packetTemplate, RIOPACKET_TRANSACTION_WRITE_NWRITER, dstId, srcId, payloadSize);
+}
+
+
+void RIOPACKET_setNwriteFromTemplate(RioPacket_t *packet, const RioPacketTemplate_t *packetTemplate,
+                                     uint8_t tid, uint32_t address, const uint8_t *payload)
+{
+  uint16_t crc;
+
+
+  ASSERT(packet != NULL, "Invalid packet pointer");
+  ASSERT(packetTemplate != NULL, "Invalid template pointer");
+  ASSERT(payload != NULL, "Invalid payload pointer");
+  ASSERT((address & 0x7ul) == 0ul, "Invalid address alignment");
+
+  if(packetTemplate->size != 0u)
+  {
+    /* Continue the crc from the header words that are the same in all packets. */
+    crc = packetTemplate->crc;
+    packet->payload[0] = packetTemplate->header[0];
+    if(packetTemplate->fixed == 2u)
+    {
+      /* sourceId(15:0)|transaction(3:0)|wrsize(3:0)|reserved(7:0) */
+      packet->payload[1] = packetTemplate->header[1];
+    }
+    else
+    {
+      /* sourceId(15:0)|transaction(3:0)|wrsize(3:0)|srcTID(7:0) */
+      packet->payload[1] = packetTemplate->header[1] | (uint32_t) tid;
+      crc = RIOPACKET_crc32(packet->payload[1], crc);
+    }
+
+    /* address(28:0)|wdptr|xamsbs(1:0) */
+    packet->payload[2] = packetTemplate->header[2] | address;
+    crc = RIOPACKET_crc32(packet->payload[2], crc);
+
+    packet->size = setPacketPayloadWords(&(packet->payload[0]), 3u, crc, 
+                                         packetTemplate->payloadSize, payload);
+  }
+  else
+  {
+    /* The template is invalid. */
+    packet->size = 0u;
+  }
+}
+
+
+uint16_t RIOPACKET_crc16(const uint16_t data, const uint16_t crc)
+{
+  static const uint16_t crcTable[] = {
+    0x0000u, 0x1021u, 0x2042u, 0x3063u, 0x4084u, 0x50a5u, 0x60c6u, 0x70e7u,
+    0x8108u, 0x9129u, 0xa14au, 0xb16bu, 0xc18cu, 0xd1adu, 0xe1ceu, 0xf1efu,
+    0x1231u, 0x0210u, 0x3273u, 0x2252u, 0x52b5u, 0x4294u, 0x72f7u, 0x62d6u,
+    0x9339u, 0x8318u, 0xb37bu, 0xa35au, 0xd3bdu, 0xc39cu, 0xf3ffu, 0xe3deu,
+    0x2462u, 0x3443u, 0x0420u, 0x1401u, 0x64e6u, 0x74c7u, 0x44a4u, 0x5485u,
+    0xa56au, 0xb54bu, 0x8528u, 0x9509u, 0xe5eeu, 0xf5cfu, 0xc5acu, 0xd58du,
+    0x3653u, 0x2672u, 0x1611u, 0x0630u, 0x76d7u, 0x66f6u, 0x5695u, 0x46b4u,
+    0xb75bu, 0xa77au, 0x9719u, 0x8738u, 0xf7dfu, 0xe7feu, 0xd79du, 0xc7bcu,
+    0x48c4u, 0x58e5u, 0x6886u, 0x78a7u, 0x0840u, 0x1861u, 0x2802u, 0x3823u,
+    0xc9ccu, 0xd9edu, 0xe98eu, 0xf9afu, 0x8948u, 0x9969u, 0xa90au, 0xb92bu,
+    0x5af5u, 0x4ad4u, 0x7ab7u, 0x6a96u, 0x1a71u, 0x0a50u, 0x3a33u, 0x2a12u,
+    0xdbfdu, 0xcbdcu, 0xfbbfu, 0xeb9eu, 0x9b79u, 0x8b58u, 0xbb3bu, 0xab1au,
+    0x6ca6u, 0x7c87u, 0x4ce4u, 0x5cc5u, 0x2c22u, 0x3c03u, 0x0c60u, 0x1c41u,
+    0xedaeu, 0xfd8fu, 0xcdecu, 0xddcdu, 0xad2au, 0xbd0bu, 0x8d68u, 0x9d49u,
+    0x7e97u, 0x6eb6u, 0x5ed5u, 0x4ef4u, 0x3e13u, 0x2e32u, 0x1e51u, 0x0e70u,
+    0xff9fu, 0xefbeu, 0xdfddu, 0xcffcu, 0xbf1bu, 0xaf3au, 0x9f59u, 0x8f78u,
+    0x9188u, 0x81a9u, 0xb1cau, 0xa1ebu, 0xd10cu, 0xc12du, 0xf14eu, 0xe16fu,
+    0x1080u, 0x00a1u, 0x30c2u, 0x20e3u, 0x5004u, 0x4025u, 0x7046u, 0x6067u,
+    0x83b9u, 0x9398u, 0xa3fbu, 0xb3dau, 0xc33du, 0xd31cu, 0xe37fu, 0xf35eu,
+    0x02b1u, 0x1290u, 0x22f3u, 0x32d2u, 0x4235u, 0x5214u, 0x6277u, 0x7256u,
+    0xb5eau, 0xa5cbu, 0x95a8u, 0x8589u, 0xf56eu, 0xe54fu, 0xd52cu, 0xc50du,
+    0x34e2u, 0x24c3u, 0x14a0u, 0x0481u, 0x7466u, 0x6447u, 0x5424u, 0x4405u,
+    0xa7dbu, 0xb7fau, 0x8799u, 0x97b8u, 0xe75fu, 0xf77eu, 0xc71du, 0xd73cu,
+    0x26d3u, 0x36f2u, 0x0691u, 0x16b0u, 0x6657u, 0x7676u, 0x4615u, 0x5634u,
+    0xd94cu, 0xc96du, 0xf90eu, 0xe92fu, 0x99c8u, 0x89e9u, 0xb98au, 0xa9abu,
+    0x5844u, 0x4865u, 0x7806u, 0x6827u, 0x18c0u, 0x08e1u, 0x3882u, 0x28a3u,
+    0xcb7du, 0xdb5cu, 0xeb3fu, 0xfb1eu, 0x8bf9u, 0x9bd8u, 0xabbbu, 0xbb9au,
+    0x4a75u, 0x5a54u, 0x6a37u, 0x7a16u, 0x0af1u, 0x1ad0u, 0x2ab3u, 0x3a92u,
+    0xfd2eu, 0xed0fu, 0xdd6cu, 0xcd4du, 0xbdaau, 0xad8bu, 0x9de8u, 0x8dc9u,
+    0x7c26u, 0x6c07u, 0x5c64u, 0x4c45u, 0x3ca2u, 0x2c83u, 0x1ce0u, 0x0cc1u,
+    0xef1fu, 0xff3eu, 0xcf5du, 0xdf7cu, 0xaf9bu, 0xbfbau, 0x8fd9u, 0x9ff8u,
+    0x6e17u, 0x7e36u, 0x4e55u, 0x5e74u, 0x2e93u, 0x3eb2u, 0x0ed1u, 0x1ef0u
+  };
+
+  uint16_t result;
+  uint8_t index;
+  
+
+  result = crc;
+  index = (uint8_t) ((data >> 8) ^ (result >> 8));
+  result = (uint16_t) (crcTable[index] ^ (uint16_t)(result << 8));
+  index = (uint8_t) ((data) ^ (result >> 8));
+  result = (uint16_t) (crcTable[index] ^ (uint16_t)(result << 8));
+
+  return result;
+}
+
+
+uint16_t RIOPACKET_crc32(const uint32_t data, uint16_t crc)
+{
+  crc = RIOPACKET_crc16((uint16_t) (data >> 16), crc);
+  crc = RIOPACKET_crc16((uint16_t) (data), crc);
+  return crc;
+}
+
+
+uint32_t RIOPACKET_getWritePacketSize(uint32_t address, uint32_t size)
+{
+  uint32_t returnValue;
+
+  if(size > 0u)
+  {
+    switch(address%8u)
+    {
+      case 0:
+        if(size >= 256u)
+        {
+          returnValue = 256u;
+        }
+        else if(size >= 8u)
+        {
+          returnValue = size - (size % 8u);
+        }
+        else
+        {
+          returnValue = size;
+        }
+        break;
+
+      case 1:
+        if(size >= 7u)
+        {
+          returnValue = 7u;
+        }
+        else
+        {
+          returnValue = 1u;
+        }
+        break;
+
+      case 2:
+        if(size >= 6u)
+        {
+          returnValue = 6u;
+        }
+        else if(size >= 2u)
+        {
+          returnValue = 2u;
+        }
+        else
+        {
+          returnValue = 1u;
+        }
+        break;
+
+      case 3:
+        if(size >= 5u)
+        {
+          returnValue = 5u;
+        }
+        else
+        {
+          returnValue = 1u;
+        }
+        break;
+
+      case 4:
+        if(size >= 4u)
+        {
+          returnValue = 4u;
+        }
+        else if(size >= 2u)
+        {
+          returnValue = 2u;
+        }
+        else
+        {
+          returnValue = 1u;
+        }
+        break;
+
+      case 5:
+        if(size >= 3u)
+        {
+          returnValue = 3u;
+        }
         else
         {
           returnValue = 1u;
@@ -1828,7 +3047,8 @@ uint32_t RIOPACKET_getReadPacketSize(uint32_t address, uint32_t size)
  * \brief Move the payload part of a packet to a user defined storage.
  *
  * \param[in] packet The address of a full RapidIO packet including headers.
- * \param[in] payloadOffset The word offset where the payload starts in the packet.
+ * \param[in] payloadOffset The byte offset where the payload starts in the packet. 
+ * Must be half-word aligned.
  * \param[in] dataOffset The byte offset in the first word to start copy data from.
  * \param[in] dataSize The number of bytes to copy.
  * \param[out] data The buffer to store the resulting payload.
@@ -1851,6 +3071,17 @@ static uint16_t getPacketPayload(const uint32_t packet[], const uint16_t payload
   packetIndex = payloadOffset;
   payloadIndex = 0u;
   dataIndex = 0u;
+
+  /* If the payload starts inside a word, remove the header bytes from it. */
+  if((packetIndex & 0x3u) != 0u)
+  {
+    content = packet[packetIndex>>2] << (8u*((packetIndex & 0x3u)-1u));
+  }
+  else
+  {
+    /* The first word is read below. */
+  }
+
   while(dataIndex < dataSize)
   {
     /* Check if a new word should be read from the inbound queue. */
@@ -1888,13 +3119,36 @@ static uint16_t getPacketPayload(const uint32_t packet[], const uint16_t payload
  * \brief Move a user defined storage into the payload part of a packet.
  *
  * \param[in] packet The address of a full RapidIO packet including headers.
- * \param[in] payloadOffset The word offset where the payload starts in the packet.
+ * \param[in] payloadOffset The byte offset where the payload starts in the packet. 
+ * Must be half-word aligned.
  * \param[in] dataOffset The byte offset in the first word to start copy data to.
  * \param[in] dataSize The number of bytes to copy.
  * \param[in] data The buffer to store in the packet.
+ *
+ * The payload is padded to an even double-word.
  */
 static uint8_t setPacketPayload(uint32_t packet[], const uint16_t payloadOffset, const uint16_t dataOffset, 
                                 const uint16_t dataSize, const uint8_t data[])
+{
+  return setPacketPayloadAligned(packet, payloadOffset, dataOffset, dataSize, data, 8u);
+}
+
+
+/**
+ * \brief Move a user defined storage into the payload part of a packet.
+ *
+ * \param[in] packet The address of a full RapidIO packet including headers.
+ * \param[in] payloadOffset The byte offset where the payload starts in the packet. 
+ * Must be half-word aligned.
+ * \param[in] dataOffset The byte offset in the first word to start copy data to.
+ * \param[in] dataSize The number of bytes to copy.
+ * \param[in] data The buffer to store in the packet.
+ * \param[in] alignment The number of bytes to pad the payload to a multiple of. Must 
+ * be a power of two.
+ */
+static uint8_t setPacketPayloadAligned(uint32_t packet[], const uint16_t payloadOffset, const uint16_t dataOffset, 
+                                       const uint16_t dataSize, const uint8_t data[],
+                                       const uint16_t alignment)
 {
   uint16_t crc = 0xffffu;
   uint32_t content = 0u;
@@ -1910,11 +3164,22 @@ static uint8_t setPacketPayload(uint32_t packet[], const uint16_t payloadOffset,
   /***************************************************
    * Calculate the CRC for the packet header.
    ***************************************************/
-  for(packetIndex = 0u; packetIndex < payloadOffset; packetIndex += 4u)
+  for(packetIndex = 0u; (packetIndex+4u) <= payloadOffset; packetIndex += 4u)
   {
     crc = RIOPACKET_crc32(packet[packetIndex>>2], crc);
   }
 
+  /* If the header ends inside a word, start with the header bytes of that word. */
+  if(packetIndex < payloadOffset)
+  {
+    content = packet[packetIndex>>2] >> (8u*(4u-(payloadOffset & 0x3u)));
+    packetIndex = payloadOffset;
+  }
+  else
+  {
+    /* The payload starts on a word boundary. */
+  }
+
   /***************************************************
    * Pad the data before the actual data is written.
    ***************************************************/
@@ -1970,12 +3235,29 @@ static uint8_t setPacketPayload(uint32_t packet[], const uint16_t payloadOffset,
   }
 
   /***************************************************
-   * Pad the data to an even double word.
+   * Pad the data to the alignment. The padding may 
+   * also pass the embedded CRC.
    ***************************************************/
-  while((payloadIndex & 0x7u) != 0u)
+  while((payloadIndex & (alignment-1u)) != 0u)
   {
     content <<= 8;
 
+    if(packetIndex == 80u)
+    {
+      /* CRC MSB. */
+      content |= ((uint32_t) crc) >> 8;
+    }
+    else if(packetIndex == 81u)
+    {
+      /* CRC LSB. */
+      content |= (uint32_t) (((uint32_t) crc) & 0xfful);
+    }
+    else
+    {
+      /* Padding. */
+      payloadIndex++;
+    }
+
     if((packetIndex & 0x3u) == 3u)
     {
       crc = RIOPACKET_crc32(content, crc);
@@ -1983,7 +3265,6 @@ static uint8_t setPacketPayload(uint32_t packet[], const uint16_t payloadOffset,
     }
 
     packetIndex++;
-    payloadIndex++;
   }
 
   /***************************************************
@@ -1996,18 +3277,195 @@ static uint8_t setPacketPayload(uint32_t packet[], const uint16_t payloadOffset,
   }
   else
   {
-    /* double-wordN-LSB|crc(15:0) */
+    /* double-wordN-LSB|crc(15:0) */
+    content &= (uint32_t) 0x0000fffful;
+    crc = RIOPACKET_crc16((uint16_t) content, crc);
+    content <<= 16;
+    content |= crc;
+  }
+  packet[packetIndex>>2] = content;
+
+  return (uint8_t) ((packetIndex>>2) + 1u);
+}
+
+
+
+/**
+ * \brief Move a user defined storage into a word aligned payload of a packet.
+ *
+ * \param[in] packet The address of a full RapidIO packet including headers.
+ * \param[in] payloadIndex The word index where the payload starts in the packet.
+ * \param[in] crc The crc of the packet header.
+ * \param[in] dataSize The number of bytes to copy. Must be a multiple of eight.
+ * \param[in] data The buffer to store in the packet.
+ * \return The size of the packet in words.
+ *
+ * This function works as setPacketPayload() without a data offset but 
+ * continues from an already calculated header crc and moves two bytes at a 
+ * time.
+ */
+static uint8_t setPacketPayloadWords(uint32_t packet[], const uint16_t payloadIndex, uint16_t crc,
+                                     const uint16_t dataSize, const uint8_t data[])
+{
+  uint32_t content = 0u;
+  uint16_t packetIndex;
+  uint16_t dataIndex;
+
+
+  ASSERT((dataSize & 0x7u) == 0u, "Invalid data size");
+
+  /* Count half-words in the packet. */
+  packetIndex = 2u*payloadIndex;
+  dataIndex = 0u;
+  while(dataIndex < dataSize)
+  {
+    content <<= 16;
+
+    if(packetIndex == (2u*((uint16_t) PACKET_SIZE_EMBEDDED_CRC)))
+    {
+      /* Embedded CRC. */
+      content |= (uint32_t) crc;
+    }
+    else
+    {
+      /* Data content. */
+      content |= (((uint32_t) data[dataIndex]) << 8) | (uint32_t) data[dataIndex+1u];
+      dataIndex += 2u;
+    }
+
+    if((packetIndex & 0x1u) == 1u)
+    {
+      crc = RIOPACKET_crc32(content, crc);
+      packet[packetIndex>>1] = content;
+    }
+    else
+    {
+      /* Don't do anything. */
+    }
+
+    packetIndex++;
+  }
+
+  if((packetIndex & 0x1u) == 0u)
+  {
+    /* crc(15:0)|pad(15:0) */
+    content = ((uint32_t) crc) << 16;
+  }
+  else
+  {
+    /* data(15:0)|crc(15:0) */
     content &= (uint32_t) 0x0000fffful;
     crc = RIOPACKET_crc16((uint16_t) content, crc);
-    content <<= 16;
-    content |= crc;
+    content = (content << 16) | (uint32_t) crc;
   }
-  packet[packetIndex>>2] = content;
+  packet[packetIndex>>1] = content;
 
-  return (uint8_t) ((packetIndex>>2) + 1u);
+  return (uint8_t) ((packetIndex>>1) + 1u);
+}
+
+
+/**
+ * \brief Set the header of an NWRITE or NWRITER template.
+ *
+ * \param[in] packetTemplate The template to operate on.
+ * \param[in] transaction The transaction type of the packets.
+ * \param[in] dstId The deviceId to use as destination in the packets.
+ * \param[in] srcId The deviceId to use as source in the packets.
+ * \param[in] payloadSize The number of bytes to write in each packet.
+ *
+ * The crc of the first header word is calculated.
+ */
+static void setNwriteTemplate(RioPacketTemplate_t *packetTemplate, const uint8_t transaction, 
+                              const uint16_t dstId, const uint16_t srcId, const uint16_t payloadSize)
+{
+  uint16_t wrsize;
+
+
+  ASSERT(payloadSize <= 256u, "Invalid payload size");
+
+  /* The address is double-word aligned and only the size determines wrsize. */
+  wrsize = ((payloadSize & 0x7u) == 0u) ? wrsizeGet(0ul, payloadSize) : 0xffffu;
+
+  /* ackId(4:0)|0|vc|crf|prio(1:0)|tt(1:0)|ftype(3:0)|destinationId(15:0) */
+  packetTemplate->header[0] = ((uint32_t) RIOPACKET_TT_16BITS) << 20;
+  packetTemplate->header[0] |= ((uint32_t) RIOPACKET_FTYPE_WRITE) << 16;
+  packetTemplate->header[0] |= (uint32_t) dstId;
+
+  /* sourceId(15:0)|transaction(3:0)|wrsize(3:0)|srcTID(7:0) */
+  packetTemplate->header[1] = ((uint32_t) srcId) << 16;
+  packetTemplate->header[1] |= ((uint32_t) transaction) << 12;
+  packetTemplate->header[1] |= (uint32_t) (((uint32_t) wrsize) & 0x00000f00ul);
+
+  /* address(28:0)|wdptr|xamsbs(1:0) */
+  packetTemplate->header[2] = (uint32_t) ((((uint32_t) wrsize) & 0x0000000ful) << 2);
+
+  packetTemplate->crc = RIOPACKET_crc32(packetTemplate->header[0], 0xffffu);
+  packetTemplate->fixed = 1u;
+  packetTemplate->payloadSize = payloadSize;
+  if(wrsize != 0xffffu)
+  {
+    /* Header, payload and crc, an embedded crc shares its word with the last crc. */
+    packetTemplate->size = (uint8_t) (3u + (payloadSize/4u) + 1u);
+  }
+  else
+  {
+    /* The size cannot be written in one packet. */
+    packetTemplate->size = 0u;
+  }
 }
 
 
+/**
+ * \brief Get the number of payload bytes in a data streaming segment.
+ *
+ * \param[in] packet The packet to operate on.
+ * \param[in] payloadOffset The byte offset where the payload starts in the packet.
+ * \return The number of payload bytes.
+ *
+ * The packet size does not directly give the payload size since the packet may 
+ * contain an embedded CRC and padding. Find the combination that is consistent 
+ * with the odd and pad bits.
+ */
+static uint16_t getDataStreamingPayloadSize(const RioPacket_t *packet, const uint16_t payloadOffset)
+{
+  uint16_t available;
+  uint16_t halfWords;
+  uint16_t returnValue;
+  uint8_t found;
+  uint8_t embeddedCrc;
+  uint8_t pad;
+
+
+  /* Remove the header and the trailing CRC. */
+  available = (uint16_t) (2u*((uint16_t) packet->size)) - (payloadOffset/2u) - 1u;
+
+  returnValue = 0u;
+  found = 0u;
+  for(embeddedCrc = 0u; (!found) && (embeddedCrc < 2u); embeddedCrc++)
+  {
+    for(pad = 0u; (!found) && (pad < 2u) && ((embeddedCrc + pad) <= available); pad++)
+    {
+      /* Remove the embedded CRC and the padding. */
+      halfWords = available - embeddedCrc - pad;
+
+      if(((halfWords & 0x1u) == ODD_GET(packet->payload)) &&
+         (embeddedCrc == (uint8_t) ((payloadOffset + (2u*halfWords)) > 80u)) &&
+         (pad == (uint8_t) ((((payloadOffset/2u) + halfWords + embeddedCrc + 1u) & 0x1u))))
+      {
+        /* The combination is consistent. */
+        returnValue = (uint16_t) (2u*halfWords) - (uint16_t) PAD_GET(packet->payload);
+        found = 1u;
+      }
+      else
+      {
+        /* Try the next combination. */
+      }
+    }
+  }
+
+  return returnValue;
+}
+
 
 /**
  * \brief Calculate the rdsize and wdptr values used in NREAD from an address and a size.
@@ -2737,114 +4195,722 @@ static uint16_t wrsizeGet(const uint32_t address, const uint16_t size)
       /* Only even double-word address are valid. */
       if((address & 0x7ul) == 0ul)
       {
-        wdptr = 1u;
-        wrsize = 0xfu;
+        wdptr = 1u;
+        wrsize = 0xfu;
+      }
+      else
+      {
+        /* Not supported by protocol. */
+        wdptr = 0xffu;
+        wrsize = 0xffu;
+      }
+      break;
+
+    default:
+      /* Not supported by protocol. */
+      wdptr = 0xffu;
+      wrsize = 0xffu;
+      break;
+  }
+  
+  returnValue = ((uint16_t) wrsize) << 8;
+  returnValue |= (uint16_t) wdptr;
+  
+  return returnValue;
+}
+
+
+/**
+ * \brief Calculate an offset and a size based on wrsize and wdptr values.
+ *
+ * \param[in] wrsize An wrsize with a value from the standard.
+ * \param[in] wdptr An wdptr with a value from the standard.
+ * \param[out] offset A byte offset into a double-word corresponding to (wrsize,wdptr).
+ * \param[out] size The number of bytes  corresponding to (wrsize,wdptr).
+ *
+ * \note See the RapidIO 3.1, part1, table 4-4 for details.
+ */
+static void wrsizeToOffset(uint8_t wrsize, uint8_t wdptr, uint8_t *offset, uint16_t *size)
+{
+  ASSERT(offset != NULL, "Invalid offset pointer");
+  ASSERT(size != NULL, "Invalid size pointer");
+
+  switch(wrsize)
+  {
+    case 0:
+    case 1:
+    case 2:
+    case 3:
+      *offset = (uint8_t) (wdptr << 2);
+      *offset |= wrsize;
+      *size = 1u;
+      break;
+
+    case 4:
+    case 6:
+      *offset = (uint8_t) (wdptr << 2);
+      *offset |= wrsize & 0x02u;
+      *size = 2u;
+      break;
+
+    case 5:
+      *offset = (uint8_t) (wdptr * 5u);
+      *size = 3u;
+      break;
+
+    case 7:
+      *offset = (uint8_t) (wdptr * 3u);
+      *size = 5u;
+      break;
+
+    case 8:
+      *offset = (uint8_t) (wdptr * 4u);
+      *size = 4u;
+      break;
+
+    case 9:
+      *offset = (uint8_t) (wdptr * 2u);
+      *size = 6u;
+      break;
+
+    case 10:
+      *offset = (uint8_t) (wdptr * 1u);
+      *size = 7u;
+      break;
+
+    case 11:
+      *offset = 0u;
+      *size = 8u + (8u*((uint16_t) wdptr));
+      break;
+
+    case 12:
+      *offset = 0u;
+      *size = 32u + (32u*((uint16_t) wdptr));
+      break;
+
+    case 13:
+      *offset = 0u;
+      *size = 128u*((uint16_t) wdptr);
+      break;
+
+    case 14:
+      *offset = 0u;
+      *size = 0u;
+      break;
+
+    default:
+      *offset = 0u;
+      *size = 256u*((uint16_t) wdptr);
+      break;
+  }
+}
+
+
+/**
+ * \brief Get the number of bytes in a deviceId.
+ *
+ * \param[in] tt The transport type of the packet.
+ * \return The number of bytes used by each deviceId in the header.
+ *
+ * The reserved transport type is treated as 16-bit deviceIds.
+ */
+static uint16_t idSizeGet(const uint8_t tt)
+{
+  uint16_t returnValue;
+
+
+  switch(tt)
+  {
+    case RIOPACKET_TT_8BITS:
+      returnValue = 1u;
+      break;
+    case RIOPACKET_TT_32BITS:
+      returnValue = 4u;
+      break;
+    default:
+      returnValue = 2u;
+      break;
+  }
+
+  return returnValue;
+}
+
+
+/**
+ * \brief Get the number of extended address bytes preceding the 32 least significant 
+ * address bits.
+ *
+ * \param[in] addressSize The address size, one of RIOPACKET_ADDRESS_XXXX.
+ * \return The number of extended address bytes.
+ */
+static uint16_t addressSizeGet(const RioPacketAddressSize_t addressSize)
+{
+  uint16_t returnValue;
+
+
+  switch(addressSize)
+  {
+    case RIOPACKET_ADDRESS_50BITS:
+      returnValue = 2u;
+      break;
+    case RIOPACKET_ADDRESS_66BITS:
+      returnValue = 4u;
+      break;
+    default:
+      returnValue = 0u;
+      break;
+  }
+
+  return returnValue;
+}
+
+
+/**
+ * \brief Write the transport header to a header byte array.
+ *
+ * \param[out] header The byte array to write the header to.
+ * \param[in] tt The transport type to use.
+ * \param[in] ftype The ftype of the packet.
+ * \param[in] dstId The destination deviceId.
+ * \param[in] srcId The source deviceId.
+ * \return The index of the first byte after the source deviceId.
+ */
+static uint16_t setTransportExt(uint8_t header[], const RioPacketTt_t tt, const uint8_t ftype,
+                                const uint32_t dstId, const uint32_t srcId)
+{
+  uint16_t idSize;
+  uint16_t index;
+  uint16_t i;
+
+
+  ASSERT((tt == RIOPACKET_TT_8BITS) || (tt == RIOPACKET_TT_16BITS) || (tt == RIOPACKET_TT_32BITS),
+         "Invalid transport type");
+
+  /* ackId(4:0)|0|vc|crf|prio(1:0)|tt(1:0)|ftype(3:0) */
+  /* ackId is set when the packet is transmitted. */
+  header[0] = 0u;
+  header[1] = (uint8_t) ((((uint8_t) tt) << 4) | (ftype & 0xfu));
+
+  /* destinationId|sourceId */
+  idSize = idSizeGet((uint8_t) tt);
+  index = 2u;
+  for(i = idSize; i > 0u; i--)
+  {
+    header[index] = (uint8_t) (dstId >> (8u*(i-1u)));
+    index++;
+  }
+  for(i = idSize; i > 0u; i--)
+  {
+    header[index] = (uint8_t) (srcId >> (8u*(i-1u)));
+    index++;
+  }
+
+  return index;
+}
+
+
+/**
+ * \brief Write an address to a header byte array.
+ *
+ * \param[out] header The byte array to write the address to.
+ * \param[in] index The index in the header to write the address to.
+ * \param[in] addressSize The address size to use.
+ * \param[in] address The byte address.
+ * \param[in] wdptr The wdptr bit to set.
+ * \return The index of the first byte after the address.
+ *
+ * The two most significant bits of a 66-bit address are always set to zero.
+ */
+static uint16_t setAddressExt(uint8_t header[], uint16_t index, 
+                              const RioPacketAddressSize_t addressSize,
+                              const uint64_t address, const uint8_t wdptr)
+{
+  uint32_t content;
+  uint16_t i;
+
+
+  /* extended_address_msb */
+  for(i = addressSizeGet(addressSize); i > 0u; i--)
+  {
+    header[index] = (uint8_t) (address >> (32u+(8u*(i-1u))));
+    index++;
+  }
+
+  /* address(28:0)|wdptr|xamsbs(1:0) */
+  content = (uint32_t) (address & 0xfffffff8ul);
+  content |= (uint32_t) ((((uint32_t) wdptr) & 0x1ul) << 2);
+  if(addressSize == RIOPACKET_ADDRESS_34BITS)
+  {
+    content |= (uint32_t) ((address >> 32) & 0x3u);
+  }
+  else if(addressSize == RIOPACKET_ADDRESS_50BITS)
+  {
+    content |= (uint32_t) ((address >> 48) & 0x3u);
+  }
+  else
+  {
+    /* The address bits 65:64 cannot be represented. */
+  }
+  for(i = 4u; i > 0u; i--)
+  {
+    header[index] = (uint8_t) (content >> (8u*(i-1u)));
+    index++;
+  }
+
+  return index;
+}
+
+
+/**
+ * \brief Move a header byte array and a payload into a packet.
+ *
+ * \param[in] packet The packet payload to write to.
+ * \param[in] header The header bytes.
+ * \param[in] headerSize The number of header bytes. Must be even.
+ * \param[in] dataOffset The byte offset in the first double-word to start copy data to.
+ * \param[in] dataSize The number of payload bytes.
+ * \param[in] data The payload bytes.
+ * \return The number of words in the packet or zero if the packet does not fit.
+ */
+static uint8_t setPacketExt(uint32_t packet[], const uint8_t header[], const uint16_t headerSize,
+                            const uint16_t dataOffset, const uint16_t dataSize, const uint8_t data[])
+{
+  uint8_t returnValue;
+  uint32_t content;
+  uint16_t index;
+
+
+  /* Calculate where the trailing CRC ends up before anything is written. */
+  index = headerSize + ((dataOffset + dataSize + 7u) & 0xfff8u);
+  if((index > headerSize) && (index > 80u))
+  {
+    /* The packet contains an embedded CRC. */
+    index += 2u;
+  }
+  else
+  {
+    /* Don't do anything. */
+  }
+
+  if(((index >> 2) + 1u) <= (uint16_t) RIOPACKET_SIZE_MAX)
+  {
+    /* The packet fits. */
+
+    /* Place the header bytes in the packet words, a partial last word is filled from 
+       the most significant byte. */
+    content = 0ul;
+    for(index = 0u; index < headerSize; index++)
+    {
+      content = (content << 8) | header[index];
+      if((index & 0x3u) == 3u)
+      {
+        packet[index>>2] = content;
       }
       else
       {
-        /* Not supported by protocol. */
-        wdptr = 0xffu;
-        wrsize = 0xffu;
+        /* Don't do anything. */
       }
-      break;
+    }
+    if((headerSize & 0x3u) != 0u)
+    {
+      packet[headerSize>>2] = content << (8u*(4u-(headerSize & 0x3u)));
+    }
+    else
+    {
+      /* Don't do anything. */
+    }
 
-    default:
-      /* Not supported by protocol. */
-      wdptr = 0xffu;
-      wrsize = 0xffu;
-      break;
+    /* Place the payload after the header. */
+    /* This function also calculates the CRC. */
+    returnValue = setPacketPayloadAligned(packet, headerSize, dataOffset, dataSize, data, 8u);
   }
-  
-  returnValue = ((uint16_t) wrsize) << 8;
-  returnValue |= (uint16_t) wdptr;
-  
+  else
+  {
+    /* The packet is too large. */
+    returnValue = 0u;
+  }
+
   return returnValue;
 }
 
 
 /**
- * \brief Calculate an offset and a size based on wrsize and wdptr values.
+ * \brief Set a packet to contain an NWRITE or an NWRITER.
  *
- * \param[in] wrsize An wrsize with a value from the standard.
- * \param[in] wdptr An wdptr with a value from the standard.
- * \param[out] offset A byte offset into a double-word corresponding to (wrsize,wdptr).
- * \param[out] size The number of bytes  corresponding to (wrsize,wdptr).
+ * \param[in] packet The packet to operate on.
+ * \param[in] tt The transport type.
+ * \param[in] addressSize The address size.
+ * \param[in] transaction The transaction to set.
+ * \param[in] dstId The destination deviceId.
+ * \param[in] srcId The source deviceId.
+ * \param[in] tid The transaction identifier or the reserved field.
+ * \param[in] address The byte address to write to.
+ * \param[in] payloadSize The number of bytes to write.
+ * \param[in] payload The bytes to write.
+ */
+static void setWriteExt(RioPacket_t *packet, 
+                        const RioPacketTt_t tt, const RioPacketAddressSize_t addressSize,
+                        const uint8_t transaction, const uint32_t dstId, const uint32_t srcId, 
+                        const uint8_t tid, const uint64_t address, 
+                        const uint16_t payloadSize, const uint8_t *payload)
+{
+  uint8_t header[20];
+  uint16_t index;
+  uint16_t wrsize;
+
+
+  ASSERT(packet != NULL, "Invalid packet pointer");
+  ASSERT(payload != NULL, "Invalid payload pointer");
+  ASSERT(payloadSize <= 256u, "Invalid payload size");
+
+  /* Convert the address and size to the wrsize field and check if the combination is valid. */
+  wrsize = wrsizeGet((uint32_t) address, payloadSize);
+  if(wrsize != 0xffffu)
+  {
+    /* The address and size field combination is valid. */
+
+    /* ackId(4:0)|0|vc|crf|prio(1:0)|tt(1:0)|ftype(3:0)|destinationId|sourceId */
+    index = setTransportExt(header, tt, (uint8_t) RIOPACKET_FTYPE_WRITE, dstId, srcId);
+
+    /* transaction(3:0)|wrsize(3:0)|srcTID(7:0) */
+    header[index] = (uint8_t) ((transaction << 4) | ((wrsize >> 8) & 0xfu));
+    header[index+1u] = tid;
+
+    /* extended_address_msb|address(28:0)|wdptr|xamsbs(1:0) */
+    /* wrsize also contains wdptr in the lower nibble. */
+    index = setAddressExt(header, index+2u, addressSize, address, (uint8_t) (wrsize & 0xfu));
+
+    /* Place the header and the payload into the packet. */
+    /* This function also calculates the CRC. */
+    packet->size = setPacketExt(packet->payload, header, index, 
+                                (uint16_t) (address & 0x7u), payloadSize, payload);
+  }
+  else
+  {
+    /* The address and size field combination is not valid. */
+    /* Cannot create a packet from these arguments, indicate this by setting the packet size to zero. */
+    packet->size = 0u;
+  }
+}
+
+
+/**
+ * \brief Read a big-endian field from the header of a packet.
  *
- * \note See the RapidIO 3.1, part1, table 4-4 for details.
+ * \param[in] packet The packet payload to read from.
+ * \param[in] index The byte index of the first byte of the field.
+ * \param[in] size The number of bytes in the field, at most four.
+ * \return The field.
  */
-static void wrsizeToOffset(uint8_t wrsize, uint8_t wdptr, uint8_t *offset, uint16_t *size)
+static uint32_t getHeaderBytes(const uint32_t packet[], uint16_t index, const uint16_t size)
 {
-  ASSERT(offset != NULL, "Invalid offset pointer");
-  ASSERT(size != NULL, "Invalid size pointer");
+  uint32_t returnValue;
+  uint16_t i;
 
-  switch(wrsize)
+
+  returnValue = 0ul;
+  for(i = 0u; i < size; i++)
   {
-    case 0:
-    case 1:
-    case 2:
-    case 3:
-      *offset = (uint8_t) (wdptr << 2);
-      *offset |= wrsize;
-      *size = 1u;
-      break;
+    returnValue <<= 8;
+    returnValue |= (packet[index>>2] >> (8u*(3u-(index & 0x3u)))) & 0xfful;
+    index++;
+  }
 
-    case 4:
-    case 6:
-      *offset = (uint8_t) (wdptr << 2);
-      *offset |= wrsize & 0x02u;
-      *size = 2u;
-      break;
+  return returnValue;
+}
 
-    case 5:
-      *offset = (uint8_t) (wdptr * 5u);
-      *size = 3u;
-      break;
 
-    case 7:
-      *offset = (uint8_t) (wdptr * 3u);
-      *size = 5u;
-      break;
+/**
+ * \brief Read an address from the header of a packet.
+ *
+ * \param[in] packet The packet payload to read from.
+ * \param[in] index The byte index of the address.
+ * \param[in] addressSize The address size used in the packet.
+ * \param[out] address The address including the wdptr and xamsbs bits in the 
+ * three least significant bits.
+ * \return The index of the first byte after the address.
+ */
+static uint16_t getAddressExt(const uint32_t packet[], const uint16_t index, 
+                              const RioPacketAddressSize_t addressSize, uint64_t *address)
+{
+  uint16_t extendedSize;
+  uint32_t content;
 
-    case 8:
-      *offset = (uint8_t) (wdptr * 4u);
-      *size = 4u;
-      break;
 
-    case 9:
-      *offset = (uint8_t) (wdptr * 2u);
-      *size = 6u;
-      break;
+  extendedSize = addressSizeGet(addressSize);
+  content = getHeaderBytes(packet, index+extendedSize, 4u);
 
-    case 10:
-      *offset = (uint8_t) (wdptr * 1u);
-      *size = 7u;
-      break;
+  /* extended_address_msb|address(28:0)|wdptr|xamsbs(1:0) */
+  *address = ((uint64_t) getHeaderBytes(packet, index, extendedSize)) << 32;
+  if(addressSize == RIOPACKET_ADDRESS_34BITS)
+  {
+    *address |= ((uint64_t) (content & 0x3ul)) << 32;
+  }
+  else if(addressSize == RIOPACKET_ADDRESS_50BITS)
+  {
+    *address |= ((uint64_t) (content & 0x3ul)) << 48;
+  }
+  else
+  {
+    /* The address bits 65:64 cannot be represented. */
+  }
+  *address |= (uint64_t) (content & 0xfffffffcul);
 
-    case 11:
-      *offset = 0u;
-      *size = 8u + (8u*((uint16_t) wdptr));
-      break;
+  return index + extendedSize + 4u;
+}
 
-    case 12:
-      *offset = 0u;
-      *size = 32u + (32u*((uint16_t) wdptr));
-      break;
 
-    case 13:
-      *offset = 0u;
-      *size = 128u*((uint16_t) wdptr);
-      break;
+/**
+ * \brief Get the number of payload bytes in a packet with a header of any size.
+ *
+ * \param[in] packet The packet to operate on.
+ * \param[in] headerSize The number of header bytes.
+ * \return The number of payload bytes, padded to an even double-word.
+ *
+ * The packet contains the header, the payload, an embedded CRC if the packet 
+ * is long and a trailing CRC that may be padded.
+ */
+static uint16_t getPayloadSizeExt(const RioPacket_t *packet, const uint16_t headerSize)
+{
+  uint16_t size;
+
+
+  size = 4u * ((uint16_t) packet->size);
+  if(size >= (headerSize + 2u))
+  {
+    size -= headerSize + 2u;
+    if((headerSize + size) > 82u)
+    {
+      /* Remove the embedded CRC. */
+      size -= 2u;
+    }
+    else
+    {
+      /* Don't do anything. */
+    }
+    size &= 0xfff8u;
+  }
+  else
+  {
+    /* The packet is too short to contain any payload. */
+    size = 0u;
+  }
+
+  return size;
+}
 
-    case 14:
-      *offset = 0u;
-      *size = 0u;
-      break;
 
+/**
+ * \brief Change bytes in the header of an encoded packet and update its crc.
+ *
+ * \param[in] packet The packet to operate on.
+ * \param[in] crcIndex The half-word index of the crc that covers the header.
+ * \param[in] index The byte index of the first byte to change.
+ * \param[in] size The number of bytes to change.
+ * \param[in] value The new bytes, the last byte in the least significant bits.
+ */
+static void patchBytes(RioPacket_t *packet, const uint16_t crcIndex, 
+                       uint16_t index, const uint16_t size, uint32_t value)
+{
+  uint16_t i;
+  uint32_t shift;
+
+
+  /* Change one byte at a time starting with the last one. */
+  index += size;
+  for(i = 0u; i < size; i++)
+  {
+    index--;
+    shift = 8ul*(3ul-(uint32_t) (index & 0x3u));
+    patchWord(packet, crcIndex, index>>2, 0xfful << shift, (value & 0xfful) << shift);
+    value >>= 8;
+  }
+}
+
+
+/**
+ * \brief Find the crc that covers the header of an encoded packet.
+ *
+ * \param[in] packet The packet to operate on.
+ * \param[in] addressSize The address size used in the packet.
+ * \return The half-word index of the crc.
+ *
+ * Packets longer than 80 bytes use the embedded crc. In shorter packets the 
+ * trailing crc is followed by a pad if the header, the payload and the crc 
+ * contain an odd number of half-words. The payload is a number of 
+ * double-words except in data streaming packets where the O-bit tells if it 
+ * has an odd number of half-words, so the layout of the header decides where 
+ * the crc is. The content of the crc half-word cannot be used to tell since a 
+ * crc of zero is valid.
+ */
+static uint16_t crcIndexGet(const RioPacket_t *packet, const RioPacketAddressSize_t addressSize)
+{
+  uint16_t idSize;
+  uint16_t index;
+  uint32_t flags;
+  uint16_t crcIndex;
+
+
+  /* Get the number of bytes in the header. */
+  idSize = idSizeGet(TT_GET(packet->payload));
+  index = 2u + (2u*idSize);
+  switch(FTYPE_GET(packet->payload))
+  {
+    case RIOPACKET_FTYPE_REQUEST:
+    case RIOPACKET_FTYPE_WRITE:
+      /* transaction(3:0)|size(3:0)|srcTID(7:0)|address */
+      index += 6u + addressSizeGet(addressSize);
+      break;
+    case RIOPACKET_FTYPE_STREAMING_WRITE:
+      /* address */
+      index += 4u + addressSizeGet(addressSize);
+      break;
+    case RIOPACKET_FTYPE_FLOW_CONTROL:
+      /* xon/xoff|flowId(6:0)|tgtdestId|soc|rsrv(6:0) */
+      index += 2u + idSize;
+      break;
+    case RIOPACKET_FTYPE_MAINTENANCE:
+      /* transaction(3:0)|size(3:0)|tid(7:0)|hopcount(7:0)|configOffset(20:0)|wdptr|rsrv(1:0) */
+      index += 6u;
+      break;
+    case RIOPACKET_FTYPE_DATA_STREAMING:
+      /* cos(7:0)|S|E|rsrv(2:0)|xh|O|P|streamID(15:0) */
+      /* Count a payload with an odd number of half-words as one more header half-word. */
+      flags = getHeaderBytes(packet->payload, index+1u, 1u);
+      index += (((flags >> 6) & 0x3ul) != (uint32_t) RIOPACKET_SEGMENT_CONTINUATION) ? 4u : 2u;
+      index += (uint16_t) (2ul*((flags >> 1) & 0x1ul));
+      break;
+    case RIOPACKET_FTYPE_DOORBELL:
+      /* rsrv(7:0)|srcTID(7:0)|info(15:0) */
+      index += 4u;
+      break;
+    case RIOPACKET_FTYPE_MESSAGE:
+    case RIOPACKET_FTYPE_RESPONSE:
+      /* transaction(3:0)|status(3:0)|targetTID(7:0) or msglen(3:0)|ssize(3:0)|letter|mbox|msgseg */
+      index += 2u;
+      break;
     default:
-      *offset = 0u;
-      *size = 256u*((uint16_t) wdptr);
+      ASSERT0("Unsupported ftype");
       break;
   }
+
+  if(packet->size > PACKET_SIZE_EMBEDDED_CRC)
+  {
+    /* The embedded crc. */
+    crcIndex = 2u*((uint16_t) PACKET_SIZE_EMBEDDED_CRC);
+  }
+  else if((index & 0x2u) == 0u)
+  {
+    /* crc(15:0)|pad(15:0) */
+    crcIndex = (2u*((uint16_t) packet->size)) - 2u;
+  }
+  else
+  {
+    /* data(15:0)|crc(15:0) */
+    crcIndex = (2u*((uint16_t) packet->size)) - 1u;
+  }
+
+  return crcIndex;
+}
+
+
+/**
+ * \brief Change bits in a word of an encoded packet and update its crc.
+ *
+ * \param[in] packet The packet to operate on.
+ * \param[in] crcIndex The half-word index of the crc that covers the word.
+ * \param[in] index The index of the word to change.
+ * \param[in] mask The bits to change.
+ * \param[in] value The new bits.
+ *
+ * The crc of the changed packet is the old crc xor the crc, with zero as 
+ * initial value, of the changed bits followed by zeros up to the crc.
+ */
+static void patchWord(RioPacket_t *packet, const uint16_t crcIndex, 
+                      const uint16_t index, const uint32_t mask, const uint32_t value)
+{
+  uint32_t difference;
+  uint16_t crc;
+
+
+  ASSERT((2u*index)+2u <= crcIndex, "Patching the crc");
+
+  difference = (packet->payload[index] ^ value) & mask;
+  if(difference != 0ul)
+  {
+    packet->payload[index] ^= difference;
+
+    crc = crcShift(RIOPACKET_crc32(difference, 0u), crcIndex - ((2u*index)+2u));
+    if((crcIndex & 0x1u) == 0u)
+    {
+      packet->payload[crcIndex>>1] ^= ((uint32_t) crc) << 16;
+    }
+    else
+    {
+      packet->payload[crcIndex>>1] ^= (uint32_t) crc;
+    }
+  }
+  else
+  {
+    /* Nothing changed. */
+  }
+}
+
+
+/**
+ * \brief Update a crc with zero half-words in constant time.
+ *
+ * \param[in] crc The crc to update.
+ * \param[in] halfWords The number of zero half-words, at most 39.
+ * \return The crc after the zero half-words, the same as calling 
+ * RIOPACKET_crc16(0, crc) halfWords times.
+ *
+ * Updating a crc with a zero half-word multiplies it with x^16 modulo the 
+ * generator polynom. Multiply with the precalculated x^(16*halfWords) instead.
+ */
+static uint16_t crcShift(const uint16_t crc, const uint16_t halfWords)
+{
+  static const uint16_t powerTable[] = {
+    0x0001u, 0x1021u, 0x3730u, 0xaa51u, 0xb861u, 0xeb23u, 0xd849u, 0x4563u,
+    0xaefcu, 0x10e2u, 0xde1fu, 0xd5f6u, 0x650bu, 0x45b4u, 0x1566u, 0xf0e6u,
+    0x8e29u, 0x8ddcu, 0x6735u, 0xf44bu, 0x26aau, 0xb8e0u, 0x6a8au, 0xd423u,
+    0xcde2u, 0xbd64u, 0x4473u, 0x8ffcu, 0x2535u, 0x9fe5u, 0xa55eu, 0x59b0u,
+    0x13fcu, 0x78b3u, 0x1648u, 0x6019u, 0x8832u, 0x8420u, 0xf33eu, 0x910fu
+  };
+
+  uint16_t power;
+  uint16_t result;
+  uint8_t i;
+
+
+  ASSERT(halfWords < (sizeof(powerTable)/sizeof(powerTable[0])), "Invalid distance to crc");
+
+  /* Carry-less multiplication, reduce with the generator polynom while 
+     shifting. */
+  power = powerTable[halfWords];
+  result = 0u;
+  for(i = 0u; i < 16u; i++)
+  {
+    if((result & 0x8000u) != 0u)
+    {
+      result = (uint16_t) ((uint16_t) (result << 1) ^ 0x1021u);
+    }
+    else
+    {
+      result = (uint16_t) (result << 1);
+    }
+
+    if((power & (0x8000u >> i)) != 0u)
+    {
+      result ^= crc;
+    }
+    else
+    {
+      /* Don't do anything. */
+    }
+  }
+
+  return result;
 }
 
 /*************************** end of file **************************************/
@@ -29,6 +29,12 @@
  * bit-sizes, i.e. double-word=64-bit, word=32-bit, half-word=16-bit, 
  * byte=8-bit.
  *
+ * The functions that set and get a complete packet, e.g.
+ * RIOPACKET_setDoorbell() and RIOPACKET_getDoorbell(), use a fixed layout with
+ * 16-bit deviceIds. The getters assert that the packet has that transport
+ * type; check RIOPACKET_getTt() before calling them on received packets. The
+ * functions named *Ext() handle the other transport types.
+ *
  * Any application specific tailoring needed to compile properly should be done 
  * in rioconfig.h.
  *
@@ -50,8 +56,9 @@
  * Global macros.
  *******************************************************************************/
 
-/* The maximum size of a RapidIO packet in words (32-bit). */
-#define RIOPACKET_SIZE_MIN ((uint8_t) 3u)
+/* The minimum and maximum size of a RapidIO packet in words (32-bit). */
+/* The shortest packet is a response without payload using 8-bit deviceIds. */
+#define RIOPACKET_SIZE_MIN ((uint8_t) 2u)
 #define RIOPACKET_SIZE_MAX ((uint8_t) 69u)
 
 /* Configuration space offsets. */
@@ -130,15 +137,29 @@ typedef enum
 /* Packet tt constants (2-bits). */
 typedef enum
 {
-  RIOPACKET_TT_16BITS = 1
+  RIOPACKET_TT_8BITS = 0,
+  RIOPACKET_TT_16BITS = 1,
+  RIOPACKET_TT_32BITS = 2
 } RioPacketTt_t;
 
+/* Extended address size constants. The address size of a request is not 
+   contained in the packet, it is configured in the endpoints. */
+typedef enum
+{
+  RIOPACKET_ADDRESS_34BITS = 0,
+  RIOPACKET_ADDRESS_50BITS = 1,
+  RIOPACKET_ADDRESS_66BITS = 3
+} RioPacketAddressSize_t;
+
 /* Packet ftype constants (4-bits). */
 typedef enum
 {
   RIOPACKET_FTYPE_REQUEST=0x2,
   RIOPACKET_FTYPE_WRITE=0x5,
+  RIOPACKET_FTYPE_STREAMING_WRITE=0x6,
+  RIOPACKET_FTYPE_FLOW_CONTROL=0x7,
   RIOPACKET_FTYPE_MAINTENANCE=0x8,
+  RIOPACKET_FTYPE_DATA_STREAMING=0x9,
   RIOPACKET_FTYPE_DOORBELL=0xa,
   RIOPACKET_FTYPE_MESSAGE=0xb,
   RIOPACKET_FTYPE_RESPONSE=0xd
@@ -158,13 +179,20 @@ typedef enum
 typedef enum
 {
   RIOPACKET_TRANSACTION_WRITE_NWRITE=4ul,
-  RIOPACKET_TRANSACTION_WRITE_NWRITER=5ul
+  RIOPACKET_TRANSACTION_WRITE_NWRITER=5ul,
+  RIOPACKET_TRANSACTION_WRITE_ATOMIC_SWAP=12ul,
+  RIOPACKET_TRANSACTION_WRITE_ATOMIC_COMPARE_AND_SWAP=13ul,
+  RIOPACKET_TRANSACTION_WRITE_ATOMIC_TEST_AND_SWAP=14ul
 } RioPacketTransactionWrite_t;
 
 /* Request packet transaction types. */
 typedef enum
 {
-  RIOPACKET_TRANSACTION_REQUEST_NREAD=4ul
+  RIOPACKET_TRANSACTION_REQUEST_NREAD=4ul,
+  RIOPACKET_TRANSACTION_REQUEST_ATOMIC_INC=12ul,
+  RIOPACKET_TRANSACTION_REQUEST_ATOMIC_DEC=13ul,
+  RIOPACKET_TRANSACTION_REQUEST_ATOMIC_SET=14ul,
+  RIOPACKET_TRANSACTION_REQUEST_ATOMIC_CLR=15ul
 } RioPacketTransactionRequest_t;
 
 /* Response packet transaction types. */
@@ -183,6 +211,25 @@ typedef enum
   RIOPACKET_RESPONSE_STATUS_ERROR=7ul
 } RioPacketResponseStatus_t;
 
+/* Data streaming segment types, the S and E bits. */
+typedef enum
+{
+  RIOPACKET_SEGMENT_CONTINUATION=0ul,
+  RIOPACKET_SEGMENT_END=1ul,
+  RIOPACKET_SEGMENT_START=2ul,
+  RIOPACKET_SEGMENT_SINGLE=3ul
+} RioPacketSegment_t;
+
+/* Header fields that can be changed in an encoded packet. */
+typedef enum
+{
+  RIOPACKET_FIELD_PRIORITY,
+  RIOPACKET_FIELD_DESTINATION,
+  RIOPACKET_FIELD_SOURCE,
+  RIOPACKET_FIELD_TID,
+  RIOPACKET_FIELD_VC
+} RioPacketField_t;
+
 
 /*******************************************************************************
  * Global typedefs
@@ -196,6 +243,17 @@ typedef struct
   uint32_t payload[RIOPACKET_SIZE_MAX];
 } RioPacket_t;
 
+/* The structure containing a precalculated packet header, see 
+   RIOPACKET_setNwriteTemplate(). */
+typedef struct
+{
+  uint32_t header[3]; /**< The header words with the varying fields set to zero. */
+  uint16_t crc; /**< The crc of the header words that are the same in all packets. */
+  uint8_t fixed; /**< The number of header words that are the same in all packets. */
+  uint8_t size; /**< The size in words of the packets, zero if the template is invalid. */
+  uint16_t payloadSize; /**< The number of payload bytes in the packets. */
+} RioPacketTemplate_t;
+
 
 
 /*******************************************************************************
@@ -248,6 +306,26 @@ void RIOPACKET_append(RioPacket_t *packet, uint32_t word);
 uint8_t RIOPACKET_valid(const RioPacket_t *packet);
 
 
+/**
+ * \brief Check if several packets are valid RapidIO packets.
+ *
+ * \param[in] packets The packets to operate on.
+ * \param[in] n The number of packets.
+ * \param[out] results A bitmap where bit i%32 in word i/32 is set if packet i is 
+ * valid. Must have room for (n+31)/32 words, all of them are written.
+ * \return The number of valid packets.
+ *
+ * This function makes the same checks as RIOPACKET_valid() but calculates the 
+ * crc of several packets at the same time. The crc of one packet is a chain 
+ * where each step depends on the previous one while the chains of different 
+ * packets are independent, interleaving them lets the processor work on 
+ * several chains at once. This gives a higher throughput when many packets 
+ * are validated, for example when a gateway receives packets from many 
+ * sources. The packets can have any size.
+ */
+uint32_t RIOPACKET_validBatch(const RioPacket_t *packets[], const uint32_t n, uint32_t results[]);
+
+
 /**
  * \brief Convert (serializes) a packet into an array of bytes.
  *
@@ -344,6 +422,35 @@ uint16_t RIOPACKET_getSource(const RioPacket_t *packet);
 uint8_t RIOPACKET_getTransaction(const RioPacket_t *packet);
 
 
+/**
+ * \brief Return the transport type of a packet.
+ *
+ * \param[in] packet The packet to operate on.
+ * \return The tt field of the packet, one of RIOPACKET_TT_XXXX.
+ *
+ * This function gets the size of the deviceIds used in a packet.
+ */
+uint8_t RIOPACKET_getTt(const RioPacket_t *packet);
+
+
+/**
+ * \brief Return the destination deviceId of a packet with any transport type.
+ *
+ * \param[in] packet The packet to operate on.
+ * \return The destination deviceId of the packet.
+ */
+uint32_t RIOPACKET_getDestinationExt(const RioPacket_t *packet);
+
+
+/**
+ * \brief Return the source deviceId of a packet with any transport type.
+ *
+ * \param[in] packet The packet to operate on.
+ * \return The source deviceId of the packet.
+ */
+uint32_t RIOPACKET_getSourceExt(const RioPacket_t *packet);
+
+
 /**
  * \brief Return the transaction identifier of a packet.
  *
@@ -356,6 +463,140 @@ uint8_t RIOPACKET_getTransaction(const RioPacket_t *packet);
  */
 uint8_t RIOPACKET_getTid(const RioPacket_t *packet);
 
+
+/**
+ * \brief Return the priority of a packet.
+ *
+ * \param[in] packet The packet to operate on.
+ * \return The priority of the packet.
+ *
+ * This function gets the prio field of a packet.
+ */
+uint8_t RIOPACKET_getPriority(const RioPacket_t *packet);
+
+
+/**
+ * \brief Return the virtual channel of a packet.
+ *
+ * \param[in] packet The packet to operate on.
+ * \return The virtual channel of the packet, zero or one.
+ *
+ * This function gets the vc bit of a packet.
+ */
+uint8_t RIOPACKET_getVc(const RioPacket_t *packet);
+
+
+/**
+ * \brief Return the mailbox of a MESSAGE packet.
+ *
+ * \param[in] packet The packet to operate on.
+ * \return The mailbox of the packet.
+ *
+ * This function gets the mailbox of a MESSAGE using the same mapping as 
+ * RIOPACKET_getMessage(), {xmbox(3:0), letter(1:0), mbox(1:0)}.
+ *
+ * \note Only MESSAGE packets contain a mailbox.
+ */
+uint8_t RIOPACKET_getMailbox(const RioPacket_t *packet);
+
+
+/**
+ * \brief Return the info field of a DOORBELL packet.
+ *
+ * \param[in] packet The packet to operate on.
+ * \return The info field of the packet.
+ *
+ * This function gets the information field of a DOORBELL without decoding the 
+ * rest of the packet.
+ *
+ * \note Only DOORBELL packets contain an info field.
+ */
+uint16_t RIOPACKET_getInfo(const RioPacket_t *packet);
+
+
+/**
+ * \brief Return the class of service of a data streaming segment.
+ *
+ * \param[in] packet The packet to operate on.
+ * \return The class of service of the packet.
+ *
+ * \note Only data streaming packets contain a class of service.
+ */
+uint8_t RIOPACKET_getCos(const RioPacket_t *packet);
+
+
+/**
+ * \brief Return the segment type of a data streaming segment.
+ *
+ * \param[in] packet The packet to operate on.
+ * \return The segment type of the packet, one of RIOPACKET_SEGMENT_XXXX.
+ *
+ * \note Only data streaming packets contain a segment type.
+ */
+uint8_t RIOPACKET_getSegment(const RioPacket_t *packet);
+
+
+/**
+ * \brief Return the streamID or length field of a data streaming segment.
+ *
+ * \param[in] packet The packet to operate on.
+ * \return The streamID for start and single segments, the length for end 
+ * segments and zero for continuation segments.
+ *
+ * This function gets the streamID without decoding the rest of the packet so 
+ * that a receiver can decide where to place the payload before it is copied.
+ *
+ * \note Only data streaming packets contain a streamID.
+ */
+uint16_t RIOPACKET_getStreamId(const RioPacket_t *packet);
+
+
+/**
+ * \brief Change a header field of an encoded packet.
+ *
+ * \param[in] packet The packet to operate on.
+ * \param[in] field The field to change, one of RIOPACKET_FIELD_XXXX.
+ * \param[in] value The new value of the field.
+ *
+ * This function changes the priority, the virtual channel, the destination or 
+ * source deviceId or the transaction identifier of a packet of any transport 
+ * type and updates the crc of the packet without reading the rest of it. Since 
+ * the crc is linear, the change of the crc only depends on the changed bits 
+ * and their distance to the crc. 
+ *
+ * Only the crc that covers the header is changed. In packets that are longer 
+ * than 80 bytes it is the embedded crc. The crc calculation continues over the 
+ * embedded crc, and a crc that is calculated over its own value is zero, so the 
+ * trailing crc only depends on the words after the embedded crc and is kept.
+ *
+ * This is useful when forwarding or re-targeting packets. The packet must 
+ * have a valid crc, the result for a packet with an invalid crc is another 
+ * packet with an invalid crc.
+ *
+ * \note The position of the trailing crc of short packets depends on the 
+ * length of the header. Packets with an address are assumed to use 34-bit 
+ * addresses, use RIOPACKET_patchHeaderExt() for other address sizes.
+ *
+ * \note The transaction identifier is the byte after the transaction field, 
+ * see RIOPACKET_getTid().
+ */
+void RIOPACKET_patchHeader(RioPacket_t *packet, const RioPacketField_t field, const uint32_t value);
+
+/**
+ * \brief Change a header field of an encoded packet with any address size.
+ *
+ * \param[in] packet The packet to operate on.
+ * \param[in] addressSize The address size used by the packet, one of RIOPACKET_ADDRESS_XXXX.
+ * \param[in] field The field to change, one of RIOPACKET_FIELD_XXXX.
+ * \param[in] value The new value of the field.
+ *
+ * This function is the same as RIOPACKET_patchHeader() but for packets with 
+ * 50-bit or 66-bit addresses. The address size is not part of the packet and 
+ * is needed to find the crc. It is not used for packets without an address.
+ */
+void RIOPACKET_patchHeaderExt(RioPacket_t *packet, const RioPacketAddressSize_t addressSize,
+                              const RioPacketField_t field, const uint32_t value);
+
 /**
  * \brief Set the packet to contain a maintenance read request.
  *
@@ -673,6 +914,71 @@ void RIOPACKET_getNwriteR(const RioPacket_t *packet,
                           uint32_t *address, uint16_t *payloadSize, uint8_t *payload);
 
 
+/**
+ * \brief Set a packet to contain an SWRITE.
+ *
+ * \param[in] packet The packet to operate on.
+ * \param[in] dstId The deviceId to use as destination in the packet.
+ * \param[in] srcId The deviceId to use as source in the packet.
+ * \param[in] address The byte address into IO-space to write to.
+ * \param[in] payloadSize The number of bytes to write. This must be a multiple of 
+ * eight and the largest allowed size is 256 bytes.
+ * \param[in] payload A pointer to the array of bytes to write.
+ *
+ * This function sets the content of a packet to an SWRITE containing a request 
+ * to write the number of bytes specified by payloadSize to the address specified by the
+ * address argument. An SWRITE has a smaller header than an NWRITE and any number 
+ * of double-words can be written but it does not support sub-double-word 
+ * writes.
+ *
+ * \note The address is a byte address and must be double-word aligned. The packet will 
+ * be empty if the address or payloadSize is not double-word aligned.
+ */
+void RIOPACKET_setSwrite(RioPacket_t *packet, 
+                         uint16_t dstId, uint16_t srcId, 
+                         uint32_t address, uint16_t payloadSize, const uint8_t *payload);
+
+
+/**
+ * \brief Get entries from an SWRITE.
+ *
+ * \param[in] packet The packet to operate on.
+ * \param[out] dstId The destination deviceId in this packet.
+ * \param[out] srcId The source deviceId in this packet.
+ * \param[out] address The byte address into IO-space requested to be written.
+ * \param[out] payloadSize The number of bytes requested to be written.
+ * \param[out] payload The data requested to be written.
+ *
+ * This function returns the content of a packet as if it contained an SWRITE.
+ *
+ * \note The address is a byte address.
+ */
+void RIOPACKET_getSwrite(const RioPacket_t *packet, 
+                         uint16_t *dstId, uint16_t *srcId, 
+                         uint32_t *address, uint16_t *payloadSize, uint8_t *payload);
+
+
+/**
+ * \brief Set a packet to contain a write without response.
+ *
+ * \param[in] packet The packet to operate on.
+ * \param[in] dstId The deviceId to use as destination in the packet.
+ * \param[in] srcId The deviceId to use as source in the packet.
+ * \param[in] address The byte address into IO-space to write to.
+ * \param[in] payloadSize The number of bytes to write. The largest allowed size is 256 bytes.
+ * \param[in] payload A pointer to the array of bytes to write.
+ *
+ * This function sets the content of a packet to an SWRITE if the address and 
+ * payloadSize are double-word aligned and to an NWRITE otherwise.
+ *
+ * \note The NWRITE restrictions on address/payloadSize combinations apply when the 
+ * address or payloadSize is not double-word aligned. 
+ */
+void RIOPACKET_setWrite(RioPacket_t *packet, 
+                        uint16_t dstId, uint16_t srcId, 
+                        uint32_t address, uint16_t payloadSize, const uint8_t *payload);
+
+
 /**
  * \brief Set a packet to contain an NREAD.
  *
@@ -719,6 +1025,138 @@ void RIOPACKET_getNread(const RioPacket_t *packet,
                         uint32_t *address, uint16_t *payloadSize);
 
 
+/**
+ * \brief Set a packet to contain an atomic request without data.
+ *
+ * \param[in] packet The packet to operate on.
+ * \param[in] dstId The deviceId to use as destination in the packet.
+ * \param[in] srcId The deviceId to use as source in the packet.
+ * \param[in] tid The transaction id to set in the response.
+ * \param[in] transaction The operation to perform, one of RIOPACKET_TRANSACTION_REQUEST_ATOMIC_XXXX.
+ * \param[in] address The byte address of the 32-bit word to operate on.
+ *
+ * This function sets the content of a packet to an ATOMIC increment, decrement, set 
+ * or clear request. The target responds with the value the word had before the 
+ * operation.
+ *
+ * \note Only 32-bit operands are supported. The packet will be empty if the address 
+ * is not word aligned.
+ */
+void RIOPACKET_setAtomicRequest(RioPacket_t *packet, 
+                                uint16_t dstId, uint16_t srcId, 
+                                uint8_t tid, uint8_t transaction, 
+                                uint32_t address);
+
+
+/**
+ * \brief Get entries from an atomic request without data.
+ *
+ * \param[in] packet The packet to operate on.
+ * \param[out] dstId The destination deviceId in this packet.
+ * \param[out] srcId The source deviceId in this packet.
+ * \param[out] tid The transaction id in this packet.
+ * \param[out] transaction The requested operation.
+ * \param[out] address The byte address of the word to operate on.
+ * \return The size of the operand in bytes.
+ *
+ * This function returns the content of a packet as if it contained an ATOMIC 
+ * increment, decrement, set or clear request.
+ */
+uint16_t RIOPACKET_getAtomicRequest(const RioPacket_t *packet, 
+                                    uint16_t *dstId, uint16_t *srcId, 
+                                    uint8_t *tid, uint8_t *transaction, 
+                                    uint32_t *address);
+
+
+/**
+ * \brief Set a packet to contain an atomic request with data.
+ *
+ * \param[in] packet The packet to operate on.
+ * \param[in] dstId The deviceId to use as destination in the packet.
+ * \param[in] srcId The deviceId to use as source in the packet.
+ * \param[in] tid The transaction id to set in the response.
+ * \param[in] transaction The operation to perform, one of RIOPACKET_TRANSACTION_WRITE_ATOMIC_XXXX.
+ * \param[in] address The byte address of the 32-bit word to operate on.
+ * \param[in] data The value to write.
+ * \param[in] compare The value to compare with, only used by compare-and-swap.
+ *
+ * This function sets the content of a packet to an ATOMIC swap, compare-and-swap 
+ * or test-and-swap request. The target responds with the value the word had before 
+ * the operation.
+ *
+ * For swap and test-and-swap the payload contains data placed in the double-word 
+ * at the position of the address. For compare-and-swap the payload double-word 
+ * contains compare followed by data.
+ *
+ * \note Only 32-bit operands are supported. The packet will be empty if the address 
+ * is not word aligned.
+ */
+void RIOPACKET_setAtomicWrite(RioPacket_t *packet, 
+                              uint16_t dstId, uint16_t srcId, 
+                              uint8_t tid, uint8_t transaction, 
+                              uint32_t address, uint32_t data, uint32_t compare);
+
+
+/**
+ * \brief Get entries from an atomic request with data.
+ *
+ * \param[in] packet The packet to operate on.
+ * \param[out] dstId The destination deviceId in this packet.
+ * \param[out] srcId The source deviceId in this packet.
+ * \param[out] tid The transaction id in this packet.
+ * \param[out] transaction The requested operation.
+ * \param[out] address The byte address of the word to operate on.
+ * \param[out] data The value to write.
+ * \param[out] compare The value to compare with. Only valid for compare-and-swap.
+ * \return The size of the operand in bytes.
+ *
+ * This function returns the content of a packet as if it contained an ATOMIC swap, 
+ * compare-and-swap or test-and-swap request.
+ */
+uint16_t RIOPACKET_getAtomicWrite(const RioPacket_t *packet, 
+                                  uint16_t *dstId, uint16_t *srcId, 
+                                  uint8_t *tid, uint8_t *transaction, 
+                                  uint32_t *address, uint32_t *data, uint32_t *compare);
+
+
+/**
+ * \brief Set a packet to contain a flow control XON or XOFF.
+ *
+ * \param[in] packet The packet to operate on.
+ * \param[in] dstId The deviceId to use as destination in the packet, the source 
+ * of the congesting flow.
+ * \param[in] srcId The deviceId to use as source in the packet.
+ * \param[in] xon Non-zero to resume the flow, zero to stop it.
+ * \param[in] flowId The flow to stop or resume. The flowId of a flow is the 
+ * priority of its packets.
+ * \param[in] tgtdestId The destination of the congesting flow.
+ *
+ * This function sets the content of a packet to a flow control packet sent by 
+ * a congested endpoint. Flow control packets are sent with the highest priority.
+ */
+void RIOPACKET_setFlowControl(RioPacket_t *packet,
+                              uint16_t dstId, uint16_t srcId, 
+                              uint8_t xon, uint8_t flowId, uint16_t tgtdestId);
+
+
+/**
+ * \brief Get entries from a flow control packet.
+ *
+ * \param[in] packet The packet to operate on.
+ * \param[out] dstId The destination deviceId in this packet.
+ * \param[out] srcId The source deviceId in this packet.
+ * \param[out] xon Non-zero if the packet is an XON, zero for an XOFF.
+ * \param[out] flowId The flow to stop or resume.
+ * \param[out] tgtdestId The destination of the congesting flow.
+ *
+ * This function returns the content of a packet as if it contained a flow 
+ * control packet.
+ */
+void RIOPACKET_getFlowControl(const RioPacket_t *packet,
+                              uint16_t *dstId, uint16_t *srcId, 
+                              uint8_t *xon, uint8_t *flowId, uint16_t *tgtdestId);
+
+
 /**
  * \brief Set a packet to contain a DOORBELL.
  *
@@ -803,6 +1241,66 @@ void RIOPACKET_getMessage(const RioPacket_t *packet,
                           uint16_t *payloadSize, uint8_t *payload); 
 
 
+/**
+ * \brief Set a packet to contain a data streaming segment.
+ *
+ * \param[in] packet The packet to operate on.
+ * \param[in] dstId The deviceId to use as destination in the packet.
+ * \param[in] srcId The deviceId to use as source in the packet.
+ * \param[in] cos The class of service of the stream.
+ * \param[in] segment The type of segment, one of RIOPACKET_SEGMENT_XXXX.
+ * \param[in] streamId The streamID for start and single segments, the total length of 
+ * the PDU for end segments and ignored for continuation segments. A length of zero 
+ * means 65536 bytes.
+ * \param[in] payloadSize The number of bytes in the segment. The largest allowed size 
+ * is 256 bytes.
+ * \param[in] payload A pointer to the payload of the segment.
+ *
+ * This function sets the content of a packet to a data streaming segment. A PDU 
+ * is sent as either one single segment or as a start segment followed by any number 
+ * of continuation segments and an end segment.
+ *
+ * \note Start and continuation segments should contain exactly the MTU number of 
+ * bytes.
+ */
+void RIOPACKET_setDataStreaming(RioPacket_t *packet,
+                                uint16_t dstId, uint16_t srcId, 
+                                uint8_t cos, uint8_t segment, uint16_t streamId,
+                                uint16_t payloadSize, const uint8_t *payload);
+
+
+/**
+ * \brief Get entries from a data streaming segment.
+ *
+ * \param[in] packet The packet to operate on.
+ * \param[out] dstId The destination deviceId in this packet.
+ * \param[out] srcId The source deviceId in this packet.
+ * \param[out] cos The class of service in this packet.
+ * \param[out] segment The type of segment, one of RIOPACKET_SEGMENT_XXXX.
+ * \param[out] streamId The streamID for start and single segments, the length for end 
+ * segments and zero for continuation segments.
+ * \param[out] payloadSize The number of bytes in the segment.
+ * \param[out] payload The payload of the segment. Use RIOPACKET_getDataStreamingSize() 
+ * to check that it fits before calling this function.
+ *
+ * This function returns the content of a packet as if it contained a data 
+ * streaming segment.
+ */
+void RIOPACKET_getDataStreaming(const RioPacket_t *packet,
+                                uint16_t *dstId, uint16_t *srcId, 
+                                uint8_t *cos, uint8_t *segment, uint16_t *streamId,
+                                uint16_t *payloadSize, uint8_t *payload);
+
+
+/**
+ * \brief Get the number of payload bytes in a data streaming segment.
+ *
+ * \param[in] packet The packet to operate on.
+ * \return The number of payload bytes.
+ */
+uint16_t RIOPACKET_getDataStreamingSize(const RioPacket_t *packet);
+
+
 /**
  * \brief Set a packet to contain a RESPONSE without payload.
  *
@@ -954,6 +1452,263 @@ void RIOPACKET_getResponseMessage(const RioPacket_t *packet,
                                   uint16_t *dstId, uint16_t *srcId, 
                                   uint8_t *mailbox, uint8_t *status);
 
+
+/**
+ * \brief Set a packet to contain an NREAD using any transport type and address size.
+ *
+ * \param[in] packet The packet to operate on.
+ * \param[in] tt The transport type, one of RIOPACKET_TT_XXXX.
+ * \param[in] addressSize The address size, one of RIOPACKET_ADDRESS_XXXX.
+ * \param[in] dstId The deviceId to use as destination in the packet.
+ * \param[in] srcId The deviceId to use as source in the packet.
+ * \param[in] tid The transaction identifier to set in the packet.
+ * \param[in] address The byte address to read from.
+ * \param[in] payloadSize The number of bytes to read.
+ *
+ * This function works as RIOPACKET_setNread() but places the deviceIds and the 
+ * address in the header format selected by tt and addressSize.
+ *
+ * \note The two most significant bits of a 66-bit address cannot be set and are 
+ * always zero.
+ *
+ * \note If the address and size combination is not valid, the packet size is set to zero.
+ */
+void RIOPACKET_setNreadExt(RioPacket_t *packet, 
+                           RioPacketTt_t tt, RioPacketAddressSize_t addressSize,
+                           uint32_t dstId, uint32_t srcId, uint8_t tid, 
+                           uint64_t address, uint16_t payloadSize);
+
+
+/**
+ * \brief Get entries from an NREAD using any transport type and address size.
+ *
+ * \param[in] packet The packet to operate on.
+ * \param[in] addressSize The address size used by the packet, one of RIOPACKET_ADDRESS_XXXX.
+ * \param[out] dstId The destination deviceId in this packet.
+ * \param[out] srcId The source deviceId in this packet.
+ * \param[out] tid The transaction identifier in this packet.
+ * \param[out] address The byte address to read from.
+ * \param[out] payloadSize The number of bytes to read.
+ *
+ * This function returns the content of a packet as if it contained an NREAD. 
+ * The transport type is read from the packet.
+ */
+void RIOPACKET_getNreadExt(const RioPacket_t *packet, RioPacketAddressSize_t addressSize,
+                           uint32_t *dstId, uint32_t *srcId, uint8_t *tid, 
+                           uint64_t *address, uint16_t *payloadSize);
+
+
+/**
+ * \brief Set a packet to contain an NWRITE using any transport type and address size.
+ *
+ * \param[in] packet The packet to operate on.
+ * \param[in] tt The transport type, one of RIOPACKET_TT_XXXX.
+ * \param[in] addressSize The address size, one of RIOPACKET_ADDRESS_XXXX.
+ * \param[in] dstId The deviceId to use as destination in the packet.
+ * \param[in] srcId The deviceId to use as source in the packet.
+ * \param[in] address The byte address to write to.
+ * \param[in] payloadSize The number of bytes to write.
+ * \param[in] payload A pointer to the array of bytes to write.
+ *
+ * This function works as RIOPACKET_setNwrite() but places the deviceIds and the 
+ * address in the header format selected by tt and addressSize.
+ *
+ * \note If the address and size combination is not valid or if the packet 
+ * becomes too large, the packet size is set to zero.
+ */
+void RIOPACKET_setNwriteExt(RioPacket_t *packet, 
+                            RioPacketTt_t tt, RioPacketAddressSize_t addressSize,
+                            uint32_t dstId, uint32_t srcId, 
+                            uint64_t address, uint16_t payloadSize, const uint8_t *payload);
+
+
+/**
+ * \brief Get entries from an NWRITE using any transport type and address size.
+ *
+ * \param[in] packet The packet to operate on.
+ * \param[in] addressSize The address size used by the packet, one of RIOPACKET_ADDRESS_XXXX.
+ * \param[out] dstId The destination deviceId in this packet.
+ * \param[out] srcId The source deviceId in this packet.
+ * \param[out] address The byte address to write to.
+ * \param[out] payloadSize The number of bytes to write.
+ * \param[out] payload The bytes to write.
+ *
+ * This function returns the content of a packet as if it contained an NWRITE. 
+ * The transport type is read from the packet.
+ */
+void RIOPACKET_getNwriteExt(const RioPacket_t *packet, RioPacketAddressSize_t addressSize,
+                            uint32_t *dstId, uint32_t *srcId, 
+                            uint64_t *address, uint16_t *payloadSize, uint8_t *payload);
+
+
+/**
+ * \brief Set a packet to contain an NWRITER using any transport type and address size.
+ *
+ * \param[in] packet The packet to operate on.
+ * \param[in] tt The transport type, one of RIOPACKET_TT_XXXX.
+ * \param[in] addressSize The address size, one of RIOPACKET_ADDRESS_XXXX.
+ * \param[in] dstId The deviceId to use as destination in the packet.
+ * \param[in] srcId The deviceId to use as source in the packet.
+ * \param[in] tid The transaction identifier to set in the packet.
+ * \param[in] address The byte address to write to.
+ * \param[in] payloadSize The number of bytes to write.
+ * \param[in] payload A pointer to the array of bytes to write.
+ *
+ * This function works as RIOPACKET_setNwriteR() but places the deviceIds and the 
+ * address in the header format selected by tt and addressSize.
+ */
+void RIOPACKET_setNwriteRExt(RioPacket_t *packet, 
+                             RioPacketTt_t tt, RioPacketAddressSize_t addressSize,
+                             uint32_t dstId, uint32_t srcId, uint8_t tid, 
+                             uint64_t address, uint16_t payloadSize, const uint8_t *payload);
+
+
+/**
+ * \brief Get entries from an NWRITER using any transport type and address size.
+ *
+ * \param[in] packet The packet to operate on.
+ * \param[in] addressSize The address size used by the packet, one of RIOPACKET_ADDRESS_XXXX.
+ * \param[out] dstId The destination deviceId in this packet.
+ * \param[out] srcId The source deviceId in this packet.
+ * \param[out] tid The transaction identifier in this packet.
+ * \param[out] address The byte address to write to.
+ * \param[out] payloadSize The number of bytes to write.
+ * \param[out] payload The bytes to write.
+ *
+ * This function returns the content of a packet as if it contained an NWRITER. 
+ * The transport type is read from the packet.
+ */
+void RIOPACKET_getNwriteRExt(const RioPacket_t *packet, RioPacketAddressSize_t addressSize,
+                             uint32_t *dstId, uint32_t *srcId, uint8_t *tid, 
+                             uint64_t *address, uint16_t *payloadSize, uint8_t *payload);
+
+
+/**
+ * \brief Set a packet to contain a RESPONSE without payload using any transport type.
+ *
+ * \param[in] packet The packet to operate on.
+ * \param[in] tt The transport type, one of RIOPACKET_TT_XXXX.
+ * \param[in] dstId The deviceId to use as destination in the packet.
+ * \param[in] srcId The deviceId to use as source in the packet.
+ * \param[in] tid The transaction identifier to set in the packet.
+ * \param[in] status The status to set in the packet, one of RIOPACKET_RESPONSE_STATUS_XXXX.
+ */
+void RIOPACKET_setResponseNoPayloadExt(RioPacket_t *packet, RioPacketTt_t tt,
+                                       uint32_t dstId, uint32_t srcId, 
+                                       uint8_t tid, uint8_t status);
+
+
+/**
+ * \brief Get entries from a RESPONSE without payload using any transport type.
+ *
+ * \param[in] packet The packet to operate on.
+ * \param[out] dstId The destination deviceId in this packet.
+ * \param[out] srcId The source deviceId in this packet.
+ * \param[out] tid The transaction identifier in this packet.
+ * \param[out] status The status in this packet.
+ */
+void RIOPACKET_getResponseNoPayloadExt(const RioPacket_t *packet, 
+                                       uint32_t *dstId, uint32_t *srcId, 
+                                       uint8_t *tid, uint8_t *status);
+
+
+/**
+ * \brief Set a packet to contain a RESPONSE with payload using any transport type.
+ *
+ * \param[in] packet The packet to operate on.
+ * \param[in] tt The transport type, one of RIOPACKET_TT_XXXX.
+ * \param[in] dstId The deviceId to use as destination in the packet.
+ * \param[in] srcId The deviceId to use as source in the packet.
+ * \param[in] tid The transaction identifier to set in the packet.
+ * \param[in] offset The offset into the double-word where the payload starts, 
+ * the address of the request.
+ * \param[in] payloadSize The number of bytes in the payload.
+ * \param[in] payload A pointer to the payload.
+ *
+ * This function works as RIOPACKET_setResponseWithPayload().
+ */
+void RIOPACKET_setResponseWithPayloadExt(RioPacket_t *packet, RioPacketTt_t tt,
+                                         uint32_t dstId, uint32_t srcId, 
+                                         uint8_t tid, uint8_t offset, 
+                                         uint16_t payloadSize, const uint8_t *payload);
+
+
+/**
+ * \brief Get entries from a RESPONSE with payload using any transport type.
+ *
+ * \param[in] packet The packet to operate on.
+ * \param[out] dstId The destination deviceId in this packet.
+ * \param[out] srcId The source deviceId in this packet.
+ * \param[out] tid The transaction identifier in this packet.
+ * \param[in] offset The offset into the double-word where the payload starts.
+ * \param[in] payloadSize The number of bytes to read, zero to read the whole payload.
+ * \param[out] payload The payload.
+ * \return The number of bytes read.
+ *
+ * This function works as RIOPACKET_getResponseWithPayload().
+ */
+uint16_t RIOPACKET_getResponseWithPayloadExt(const RioPacket_t *packet, 
+                                             uint32_t *dstId, uint32_t *srcId, 
+                                             uint8_t *tid, uint8_t offset, 
+                                             uint16_t payloadSize, uint8_t *payload);
+
+/**
+ * \brief Set a template for NWRITE packets.
+ *
+ * \param[in] packetTemplate The template to operate on.
+ * \param[in] dstId The deviceId to use as destination in the packets.
+ * \param[in] srcId The deviceId to use as source in the packets.
+ * \param[in] payloadSize The number of bytes to write in each packet. Must be 
+ * a multiple of eight and at most 256 bytes.
+ *
+ * A template contains the header and the crc of the header of packets that 
+ * are sent many times with the same shape. Packets are created from the 
+ * template with RIOPACKET_setNwriteFromTemplate() which only writes the 
+ * address and the payload and continues the crc from the header.
+ *
+ * \note The template is invalid, and its packets empty, if the payloadSize 
+ * cannot be written to a double-word aligned address in one packet.
+ */
+void RIOPACKET_setNwriteTemplate(RioPacketTemplate_t *packetTemplate,
+                                 uint16_t dstId, uint16_t srcId, uint16_t payloadSize);
+
+
+/**
+ * \brief Set a template for NWRITER packets.
+ *
+ * \param[in] packetTemplate The template to operate on.
+ * \param[in] dstId The deviceId to use as destination in the packets.
+ * \param[in] srcId The deviceId to use as source in the packets.
+ * \param[in] payloadSize The number of bytes to write in each packet. Must be 
+ * a multiple of eight and at most 256 bytes.
+ *
+ * This function works as RIOPACKET_setNwriteTemplate() but the packets are 
+ * NWRITER that contain a transaction identifier.
+ */
+void RIOPACKET_setNwriteRTemplate(RioPacketTemplate_t *packetTemplate,
+                                  uint16_t dstId, uint16_t srcId, uint16_t payloadSize);
+
+
+/**
+ * \brief Set a packet to contain an NWRITE or NWRITER from a template.
+ *
+ * \param[in] packet The packet to operate on.
+ * \param[in] packetTemplate The template to use, see RIOPACKET_setNwriteTemplate() 
+ * and RIOPACKET_setNwriteRTemplate().
+ * \param[in] tid The transaction identifier to set in an NWRITER packet. Not used 
+ * for NWRITE packets.
+ * \param[in] address The byte address in IO-space to write to. Must be double-word 
+ * aligned.
+ * \param[in] payload A pointer to the array of bytes to write. The number of 
+ * bytes is given by the template.
+ *
+ * The packet is identical to a packet created by RIOPACKET_setNwrite() or 
+ * RIOPACKET_setNwriteR() with the same arguments.
+ */
+void RIOPACKET_setNwriteFromTemplate(RioPacket_t *packet, const RioPacketTemplate_t *packetTemplate,
+                                     uint8_t tid, uint32_t address, const uint8_t *payload);
+
+
 /**
  * \brief Calculate a new CRC16 value.
  *
@@ -0,0 +1,890 @@
+/******************************************************************************
+ * (C) Copyright 2013-2015 Magnus Rosenius and the Free Software Foundation.
+ *
+ * This file is part of OpenRIO.
+ *
+ * OpenRIO is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenRIO is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Lesser Public License
+ * along with OpenRIO.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+/******************************************************************************
+ * Description:
+ * This file contains a software 8b/10b physical coding sublayer.
+ * See riopcs.h for more info.
+ *
+ * Any application specific tailoring needed to compile properly should be done
+ * in rioconfig.h.
+ ******************************************************************************/
+
+/*******************************************************************************
+ * Includes
+ *******************************************************************************/
+
+#include "riopcs.h"
+
+/* Get definitions of ASSERT(), assumed to not return. */
+#include "rioconfig.h"
+
+
+/*******************************************************************************
+ * Local macros
+ *******************************************************************************/
+
+/* The running disparities. */
+#define DISPARITY_MINUS 0u
+#define DISPARITY_PLUS 1u
+
+/* Encode table entries, the code group, the running disparity after it and
+   a flag for characters that cannot be encoded. */
+#define ENCODE_INDEX(disparity, character) (((uint16_t) (disparity) << 9) | (character))
+#define ENCODE_CODE_GROUP(entry) ((entry) & 0x3ffu)
+#define ENCODE_DISPARITY(entry) ((uint8_t) ((entry) >> 15))
+#define ENCODE_INVALID 0x4000u
+
+/* Decode table entries, the character, if the code group is valid when
+   received with negative and positive running disparity and the running
+   disparity after it. */
+#define DECODE_CHARACTER(entry) ((entry) & 0x1ffu)
+#define DECODE_VALID(disparity) (0x0400u << (disparity))
+#define DECODE_DISPARITY_SHIFT(disparity) (12u + (disparity))
+
+/* The stype1 field of a control symbol. Link-request and all lower stype1
+   values delimits packets and are sent with PD instead of SC. */
+#define DELIMITER_STYPE1(data) ((uint8_t) (((data) >> 8) & 0x07u))
+#define DELIMITER_STYPE1_MAX 4u
+
+/* The comma patterns, the first seven bits of K28.1, K28.5 and K28.7. */
+#define COMMA_MINUS 0x1fu
+#define COMMA_PLUS 0x60u
+
+
+/*******************************************************************************
+ * Local typedefs
+ *******************************************************************************/
+
+
+/*******************************************************************************
+ * Global declarations
+ *******************************************************************************/
+
+
+/*******************************************************************************
+ * Local declarations
+ *******************************************************************************/
+
+/* The 5b/6b encodings as abcdei when the running disparity is negative. */
+static const uint8_t encode5b6b[32] =
+{
+  0x27u, 0x1du, 0x2du, 0x31u, 0x35u, 0x29u, 0x19u, 0x38u,
+  0x39u, 0x25u, 0x15u, 0x34u, 0x0du, 0x2cu, 0x1cu, 0x17u,
+  0x1bu, 0x23u, 0x13u, 0x32u, 0x0bu, 0x2au, 0x1au, 0x3au,
+  0x33u, 0x26u, 0x16u, 0x36u, 0x0eu, 0x2eu, 0x1eu, 0x2bu
+};
+
+/* The 3b/4b encodings as fghj when the running disparity is negative. */
+static const uint8_t encode3b4b[8] =
+{
+  0x0bu, 0x09u, 0x05u, 0x0cu, 0x0du, 0x0au, 0x06u, 0x0eu
+};
+
+/* The tables used to encode and decode, created when the first PCS is opened. */
+static uint8_t tablesCreated = 0u;
+static uint16_t encodeTable[1024];
+static uint16_t decodeTable[1024];
+
+
+/*******************************************************************************
+ * Local function prototypes
+ *******************************************************************************/
+
+/**
+ * \brief Create the encode and decode tables.
+ */
+static void createTables(void);
+
+/**
+ * \brief Encode a character using the 8b/10b rules.
+ *
+ * \param[in] character The character to encode.
+ * \param[in] disparity The running disparity before the code group.
+ * \return The code group.
+ */
+static uint16_t encodeCharacter(const uint16_t character, const uint8_t disparity);
+
+/**
+ * \brief Get the running disparity after a sub-block.
+ *
+ * \param[in] subBlock The bits of the sub-block.
+ * \param[in] size The number of bits in the sub-block, six or four.
+ * \param[in] disparity The running disparity before the sub-block.
+ * \return The running disparity after the sub-block.
+ */
+static uint8_t subBlockDisparity(const uint8_t subBlock, const uint8_t size, const uint8_t disparity);
+
+/**
+ * \brief Count the ones in a sub-block.
+ *
+ * \param[in] value The bits to count.
+ * \return The number of ones.
+ */
+static uint8_t ones(uint8_t value);
+
+/**
+ * \brief Get the next character of the idle sequence.
+ *
+ * \param[in] pcs The PCS to operate on.
+ * \return The character to send.
+ */
+static uint16_t idleCharacter(RioPcs_t *pcs);
+
+/**
+ * \brief Advance the pseudo random generator and the A-counter one character.
+ *
+ * \param[in] pcs The PCS to operate on.
+ */
+static void idleClock(RioPcs_t *pcs);
+
+/**
+ * \brief Encode one character in the transmitter.
+ *
+ * \param[in] pcs The PCS to operate on.
+ * \param[in] character The character to encode.
+ * \return The code group.
+ */
+static uint16_t transmitCharacter(RioPcs_t *pcs, const uint16_t character);
+
+/**
+ * \brief Decode one code group in the receiver.
+ *
+ * \param[in] pcs The PCS to operate on.
+ * \param[in] codeGroup The code group to decode.
+ * \return The character, marked with RIOPCS_CHARACTER_ERROR if it was not valid.
+ */
+static uint16_t receiveCodeGroup(RioPcs_t *pcs, const uint16_t codeGroup);
+
+/**
+ * \brief Handle a receive error.
+ *
+ * \param[in] pcs The PCS to operate on.
+ * \param[out] symbol The error symbol to deliver.
+ * \return The number of symbols that was written.
+ *
+ * One error symbol is delivered and then data characters are discarded until
+ * the receiver is symbol aligned again.
+ */
+static uint32_t receiveError(RioPcs_t *pcs, RioSymbol_t *symbol);
+
+
+/*******************************************************************************
+ * Global functions
+ *******************************************************************************/
+
+void RIOPCS_open(RioPcs_t *pcs)
+{
+  ASSERT(pcs != NULL, "Invalid pcs pointer");
+
+  if(!tablesCreated)
+  {
+    createTables();
+    tablesCreated = 1u;
+  }
+  else
+  {
+    /* Don't do anything. */
+  }
+
+  pcs->txDisparity = DISPARITY_MINUS;
+  pcs->txLfsr = 0x01u;
+  pcs->txIdleCounter = 0u;
+  pcs->txIdlePrevious = 0u;
+  pcs->txCcsCounter = 0ul;
+
+  pcs->rxDisparity = DISPARITY_MINUS;
+  pcs->rxCounter = 0u;
+  pcs->rxDiscard = 0u;
+  pcs->rxSymbol.type = RIOSTACK_SYMBOL_TYPE_IDLE;
+  pcs->rxSymbol.data = 0ul;
+
+  pcs->statusTxCcs = 0ul;
+  pcs->statusRxIdle = 0ul;
+  pcs->statusRxCodeError = 0ul;
+  pcs->statusRxDisparityError = 0ul;
+  pcs->statusRxSymbolError = 0ul;
+}
+
+
+void RIOPCS_encodeCharacters(RioPcs_t *pcs, const uint32_t count,
+                             const uint16_t *characters, uint16_t *codeGroups)
+{
+  uint32_t i;
+
+
+  for(i = 0ul; i < count; i++)
+  {
+    codeGroups[i] = transmitCharacter(pcs, characters[i]);
+  }
+}
+
+
+uint32_t RIOPCS_decodeCharacters(RioPcs_t *pcs, const uint32_t count,
+                                 const uint16_t *codeGroups, uint16_t *characters)
+{
+  uint32_t i;
+  uint32_t errors;
+
+
+  errors = 0ul;
+  for(i = 0ul; i < count; i++)
+  {
+    characters[i] = receiveCodeGroup(pcs, codeGroups[i]);
+    errors += (characters[i] >> 9);
+  }
+
+  return errors;
+}
+
+
+uint32_t RIOPCS_encodeSymbols(RioPcs_t *pcs, const uint32_t count,
+                              const RioSymbol_t *symbols, uint16_t *codeGroups)
+{
+  uint32_t i;
+  uint32_t index;
+  uint32_t data;
+
+
+  index = 0ul;
+  for(i = 0ul; i < count; i++)
+  {
+    /* Check if it is time to send a clock compensation sequence. */
+    if(pcs->txCcsCounter >= RIOPCS_CCS_INTERVAL)
+    {
+      /* Send K, R, R, R between the symbols. */
+      codeGroups[index++] = transmitCharacter(pcs, RIOPCS_K);
+      codeGroups[index++] = transmitCharacter(pcs, RIOPCS_R);
+      codeGroups[index++] = transmitCharacter(pcs, RIOPCS_R);
+      codeGroups[index++] = transmitCharacter(pcs, RIOPCS_R);
+      pcs->txIdlePrevious = 1u;
+      pcs->txCcsCounter = 0ul;
+      pcs->statusTxCcs++;
+    }
+    else
+    {
+      /* Don't do anything. */
+    }
+
+    data = symbols[i].data;
+    switch(symbols[i].type)
+    {
+      case RIOSTACK_SYMBOL_TYPE_CONTROL:
+        /* Send the three octets of the control symbol after a delimiter. */
+        if(DELIMITER_STYPE1(data) <= DELIMITER_STYPE1_MAX)
+        {
+          codeGroups[index++] = transmitCharacter(pcs, RIOPCS_PD);
+        }
+        else
+        {
+          codeGroups[index++] = transmitCharacter(pcs, RIOPCS_SC);
+        }
+        codeGroups[index++] = transmitCharacter(pcs, (uint16_t) ((data >> 16) & 0xffu));
+        codeGroups[index++] = transmitCharacter(pcs, (uint16_t) ((data >> 8) & 0xffu));
+        codeGroups[index++] = transmitCharacter(pcs, (uint16_t) (data & 0xffu));
+        pcs->txIdlePrevious = 0u;
+        break;
+      case RIOSTACK_SYMBOL_TYPE_DATA:
+        /* Send the four octets of the data symbol. */
+        codeGroups[index++] = transmitCharacter(pcs, (uint16_t) ((data >> 24) & 0xffu));
+        codeGroups[index++] = transmitCharacter(pcs, (uint16_t) ((data >> 16) & 0xffu));
+        codeGroups[index++] = transmitCharacter(pcs, (uint16_t) ((data >> 8) & 0xffu));
+        codeGroups[index++] = transmitCharacter(pcs, (uint16_t) (data & 0xffu));
+        pcs->txIdlePrevious = 0u;
+        break;
+      default:
+        /* Send four characters of the idle sequence. */
+        codeGroups[index++] = transmitCharacter(pcs, idleCharacter(pcs));
+        codeGroups[index++] = transmitCharacter(pcs, idleCharacter(pcs));
+        codeGroups[index++] = transmitCharacter(pcs, idleCharacter(pcs));
+        codeGroups[index++] = transmitCharacter(pcs, idleCharacter(pcs));
+        break;
+    }
+    pcs->txCcsCounter += 4ul;
+  }
+
+  return index;
+}
+
+
+uint32_t RIOPCS_decodeSymbols(RioPcs_t *pcs, const uint32_t count,
+                              const uint16_t *codeGroups, RioSymbol_t *symbols)
+{
+  uint32_t i;
+  uint32_t index;
+  uint16_t character;
+
+
+  index = 0ul;
+  for(i = 0ul; i < count; i++)
+  {
+    character = receiveCodeGroup(pcs, codeGroups[i]);
+
+    if(character < RIOPCS_CHARACTER_K)
+    {
+      /* Data character. */
+      if(!pcs->rxDiscard)
+      {
+        /* Add it to the current symbol, a data symbol starts if there is no
+           current symbol. */
+        if(pcs->rxCounter == 0u)
+        {
+          pcs->rxSymbol.type = RIOSTACK_SYMBOL_TYPE_DATA;
+          pcs->rxSymbol.data = 0ul;
+        }
+        else
+        {
+          /* Don't do anything. */
+        }
+        pcs->rxSymbol.data = (pcs->rxSymbol.data << 8) | character;
+        pcs->rxCounter++;
+
+        /* Check if the symbol is complete. */
+        if(pcs->rxCounter == 4u)
+        {
+          symbols[index++] = pcs->rxSymbol;
+          pcs->rxCounter = 0u;
+        }
+        else
+        {
+          /* Don't do anything. */
+        }
+      }
+      else
+      {
+        /* Not symbol aligned, discard the character. */
+      }
+    }
+    else if(character < RIOPCS_CHARACTER_ERROR)
+    {
+      /* Special character, a symbol that has been started is not complete. */
+      if(pcs->rxCounter != 0u)
+      {
+        index += receiveError(pcs, &symbols[index]);
+      }
+      else
+      {
+        /* Don't do anything. */
+      }
+
+      if((character == RIOPCS_SC) || (character == RIOPCS_PD))
+      {
+        /* Start of a control symbol. */
+        pcs->rxSymbol.type = RIOSTACK_SYMBOL_TYPE_CONTROL;
+        pcs->rxSymbol.data = 0ul;
+        pcs->rxCounter = 1u;
+        pcs->rxDiscard = 0u;
+      }
+      else if((character == RIOPCS_K) || (character == RIOPCS_A) || (character == RIOPCS_R))
+      {
+        /* Idle character, the receiver is symbol aligned after it. */
+        pcs->rxDiscard = 0u;
+        pcs->statusRxIdle++;
+      }
+      else
+      {
+        /* Special character that is not used. */
+        index += receiveError(pcs, &symbols[index]);
+      }
+    }
+    else
+    {
+      /* Invalid code group or disparity error. */
+      index += receiveError(pcs, &symbols[index]);
+    }
+  }
+
+  return index;
+}
+
+
+uint32_t RIOPCS_transmit(RioPcs_t *pcs, RioStack_t *stack,
+                         const uint32_t symbols, uint16_t *codeGroups)
+{
+  RioSymbol_t s;
+  uint32_t i;
+  uint32_t index;
+
+
+  ASSERT(stack != NULL, "Invalid stack pointer");
+
+  index = 0ul;
+  for(i = 0ul; i < symbols; i++)
+  {
+    s = RIOSTACK_portGetSymbol(stack);
+    index += RIOPCS_encodeSymbols(pcs, 1ul, &s, &codeGroups[index]);
+  }
+
+  return index;
+}
+
+
+void RIOPCS_receive(RioPcs_t *pcs, RioStack_t *stack,
+                    const uint32_t count, const uint16_t *codeGroups)
+{
+  RioSymbol_t s[4];
+  uint32_t i;
+  uint32_t j;
+  uint32_t symbols;
+
+
+  ASSERT(stack != NULL, "Invalid stack pointer");
+
+  /* Decode a few code groups at a time. */
+  for(i = 0ul; i < count; i += 4ul)
+  {
+    symbols = RIOPCS_decodeSymbols(pcs, ((count - i) < 4ul) ? (count - i) : 4ul, &codeGroups[i], s);
+    for(j = 0ul; j < symbols; j++)
+    {
+      RIOSTACK_portAddSymbol(stack, s[j]);
+    }
+  }
+}
+
+
+uint32_t RIOPCS_findComma(const uint32_t bitCount, const uint8_t *bits)
+{
+  uint32_t offset;
+  uint32_t window;
+  uint32_t i;
+
+
+  /* Shift the bits into a window and compare the seven oldest bits of a code
+     group sized window with the comma patterns. */
+  offset = bitCount;
+  window = 0ul;
+  for(i = 0ul; (offset == bitCount) && (i < bitCount); i++)
+  {
+    window = (window << 1) | ((bits[i >> 3] >> (7u - (i & 7u))) & 1u);
+    if(i >= 6ul)
+    {
+      if(((window & 0x7fu) == COMMA_MINUS) || ((window & 0x7fu) == COMMA_PLUS))
+      {
+        offset = i - 6ul;
+      }
+      else
+      {
+        /* Don't do anything. */
+      }
+    }
+    else
+    {
+      /* Don't do anything. */
+    }
+  }
+
+  return offset;
+}
+
+
+void RIOPCS_unpackBits(const uint32_t bitOffset, const uint32_t count,
+                       const uint8_t *bits, uint16_t *codeGroups)
+{
+  uint32_t i;
+  uint32_t bit;
+  uint32_t word;
+
+
+  bit = bitOffset;
+  for(i = 0ul; i < count; i++)
+  {
+    /* Get the three bytes that contains the code group and shift it down. */
+    word = ((uint32_t) bits[bit >> 3] << 16) | ((uint32_t) bits[(bit >> 3) + 1u] << 8);
+    if((bit & 7u) > 6u)
+    {
+      word |= bits[(bit >> 3) + 2u];
+    }
+    else
+    {
+      /* The code group ends in the second byte. */
+    }
+    codeGroups[i] = (uint16_t) ((word >> (14u - (bit & 7u))) & 0x3ffu);
+    bit += 10ul;
+  }
+}
+
+
+void RIOPCS_packBits(const uint32_t count, const uint16_t *codeGroups, uint8_t *bits)
+{
+  uint32_t i;
+  uint32_t index;
+  uint32_t window;
+  uint8_t windowBits;
+
+
+  index = 0ul;
+  window = 0ul;
+  windowBits = 0u;
+  for(i = 0ul; i < count; i++)
+  {
+    window = (window << 10) | (codeGroups[i] & 0x3ffu);
+    windowBits += 10u;
+    while(windowBits >= 8u)
+    {
+      windowBits -= 8u;
+      bits[index++] = (uint8_t) (window >> windowBits);
+    }
+  }
+
+  if(windowBits > 0u)
+  {
+    bits[index] = (uint8_t) (window << (8u - windowBits));
+  }
+  else
+  {
+    /* Don't do anything. */
+  }
+}
+
+
+/*******************************************************************************
+ * Local functions
+ *******************************************************************************/
+
+static void createTables(void)
+{
+  uint16_t character;
+  uint16_t codeGroup;
+  uint8_t disparity;
+  uint8_t after;
+  uint8_t x;
+  uint8_t y;
+  uint16_t i;
+
+
+  /* Mark all code groups as invalid with the running disparity given by the
+     sub-blocks to make it possible to continue after errors. */
+  for(i = 0u; i < 1024u; i++)
+  {
+    decodeTable[i] = RIOPCS_CHARACTER_ERROR;
+    for(disparity = DISPARITY_MINUS; disparity <= DISPARITY_PLUS; disparity++)
+    {
+      after = subBlockDisparity((uint8_t) (i >> 4), 6u, disparity);
+      after = subBlockDisparity((uint8_t) (i & 0xfu), 4u, after);
+      decodeTable[i] |= (uint16_t) ((uint16_t) after << DECODE_DISPARITY_SHIFT(disparity));
+    }
+  }
+
+  /* Encode all characters with both running disparities and mark the code
+     groups as valid. */
+  for(i = 0u; i < 512u; i++)
+  {
+    character = i;
+    x = (uint8_t) (character & 0x1fu);
+    y = (uint8_t) ((character >> 5) & 0x07u);
+    for(disparity = DISPARITY_MINUS; disparity <= DISPARITY_PLUS; disparity++)
+    {
+      if((character < RIOPCS_CHARACTER_K) ||
+         (x == 28u) || ((y == 7u) && ((x == 23u) || (x == 27u) || (x == 29u) || (x == 30u))))
+      {
+        codeGroup = encodeCharacter(character, disparity);
+        after = subBlockDisparity((uint8_t) (codeGroup >> 4), 6u, disparity);
+        after = subBlockDisparity((uint8_t) (codeGroup & 0xfu), 4u, after);
+        encodeTable[ENCODE_INDEX(disparity, character)] = (uint16_t) (codeGroup | ((uint16_t) after << 15));
+
+        decodeTable[codeGroup] &= (uint16_t) ~(RIOPCS_CHARACTER_ERROR | 0x1ffu);
+        decodeTable[codeGroup] |= (uint16_t) (character | DECODE_VALID(disparity));
+      }
+      else
+      {
+        /* Not a valid special character. */
+        encodeTable[ENCODE_INDEX(disparity, character)] = ENCODE_INVALID;
+      }
+    }
+  }
+}
+
+
+static uint16_t encodeCharacter(const uint16_t character, const uint8_t disparity)
+{
+  uint8_t x;
+  uint8_t y;
+  uint8_t k;
+  uint8_t sixB;
+  uint8_t fourB;
+  uint8_t middle;
+  uint16_t codeGroup;
+
+
+  x = (uint8_t) (character & 0x1fu);
+  y = (uint8_t) ((character >> 5) & 0x07u);
+  k = (uint8_t) ((character & RIOPCS_CHARACTER_K) != 0u);
+
+  /* Special characters are encoded as with negative running disparity and
+     complemented when the running disparity is positive. */
+  if(k)
+  {
+    middle = DISPARITY_MINUS;
+  }
+  else
+  {
+    middle = disparity;
+  }
+
+  /* Get the 6b sub-block. */
+  if(k && (x == 28u))
+  {
+    sixB = 0x0fu;
+  }
+  else
+  {
+    sixB = encode5b6b[x];
+  }
+  if(middle == DISPARITY_PLUS)
+  {
+    if(ones(sixB) != 3u)
+    {
+      sixB = (uint8_t) (~sixB & 0x3fu);
+    }
+    else if(x == 7u)
+    {
+      sixB = 0x07u;
+    }
+    else
+    {
+      /* Neutral sub-blocks are the same in both disparities. */
+    }
+  }
+  else
+  {
+    /* Don't do anything. */
+  }
+  middle = subBlockDisparity(sixB, 6u, middle);
+
+  /* Get the 4b sub-block, use the alternate encoding of D.x.7 to avoid runs
+     of five equal bits. */
+  if((y == 7u) &&
+     (k ||
+      ((middle == DISPARITY_MINUS) && ((x == 17u) || (x == 18u) || (x == 20u))) ||
+      ((middle == DISPARITY_PLUS) && ((x == 11u) || (x == 13u) || (x == 14u)))))
+  {
+    fourB = 0x07u;
+  }
+  else
+  {
+    fourB = encode3b4b[y];
+  }
+  if(middle == DISPARITY_PLUS)
+  {
+    if(ones(fourB) != 2u)
+    {
+      fourB = (uint8_t) (~fourB & 0x0fu);
+    }
+    else if(y == 3u)
+    {
+      fourB = 0x03u;
+    }
+    else
+    {
+      /* Neutral sub-blocks are the same in both disparities. */
+    }
+  }
+  else
+  {
+    /* Don't do anything. */
+  }
+
+  codeGroup = (uint16_t) (((uint16_t) sixB << 4) | fourB);
+  if(k && (disparity == DISPARITY_PLUS))
+  {
+    codeGroup = (uint16_t) (~codeGroup & 0x3ffu);
+  }
+  else
+  {
+    /* Don't do anything. */
+  }
+
+  return codeGroup;
+}
+
+
+static uint8_t subBlockDisparity(const uint8_t subBlock, const uint8_t size, const uint8_t disparity)
+{
+  uint8_t n;
+  uint8_t result;
+
+
+  n = ones(subBlock);
+  if((2u*n) > size)
+  {
+    result = DISPARITY_PLUS;
+  }
+  else if((2u*n) < size)
+  {
+    result = DISPARITY_MINUS;
+  }
+  else if(((size == 6u) && (subBlock == 0x07u)) || ((size == 4u) && (subBlock == 0x03u)))
+  {
+    result = DISPARITY_PLUS;
+  }
+  else if(((size == 6u) && (subBlock == 0x38u)) || ((size == 4u) && (subBlock == 0x0cu)))
+  {
+    result = DISPARITY_MINUS;
+  }
+  else
+  {
+    result = disparity;
+  }
+
+  return result;
+}
+
+
+static uint8_t ones(uint8_t value)
+{
+  uint8_t n;
+
+
+  n = 0u;
+  while(value != 0u)
+  {
+    n += (uint8_t) (value & 1u);
+    value >>= 1;
+  }
+
+  return n;
+}
+
+
+static uint16_t idleCharacter(RioPcs_t *pcs)
+{
+  uint16_t character;
+
+
+  /* The first idle character is always K, then A when the A-counter expires
+     and otherwise K or R randomly. */
+  if(!pcs->txIdlePrevious)
+  {
+    character = RIOPCS_K;
+  }
+  else if(pcs->txIdleCounter == 0u)
+  {
+    character = RIOPCS_A;
+  }
+  else if((pcs->txLfsr & 1u) != 0u)
+  {
+    character = RIOPCS_K;
+  }
+  else
+  {
+    character = RIOPCS_R;
+  }
+  pcs->txIdlePrevious = 1u;
+
+  return character;
+}
+
+
+static void idleClock(RioPcs_t *pcs)
+{
+  uint8_t q;
+
+
+  /* Reload the A-counter with 16-31 from the pseudo random number when it
+     expires, otherwise count down. */
+  if(pcs->txIdleCounter == 0u)
+  {
+    pcs->txIdleCounter = (uint8_t) (0x10u |
+                                    (((pcs->txLfsr >> 6) & 1u) << 3) |
+                                    (((pcs->txLfsr >> 4) & 1u) << 2) |
+                                    (((pcs->txLfsr >> 3) & 1u) << 1) |
+                                    ((pcs->txLfsr >> 1) & 1u));
+  }
+  else
+  {
+    pcs->txIdleCounter--;
+  }
+
+  /* Step the pseudo random number generator. */
+  q = (uint8_t) (~((pcs->txLfsr >> 7) ^ (pcs->txLfsr >> 6) ^ pcs->txLfsr) & 1u);
+  pcs->txLfsr = (uint8_t) ((pcs->txLfsr << 1) | q);
+}
+
+
+static uint16_t transmitCharacter(RioPcs_t *pcs, const uint16_t character)
+{
+  uint16_t entry;
+
+
+  entry = encodeTable[ENCODE_INDEX(pcs->txDisparity, character & 0x1ffu)];
+  ASSERT((entry & ENCODE_INVALID) == 0u, "Invalid special character");
+  pcs->txDisparity = ENCODE_DISPARITY(entry);
+  idleClock(pcs);
+
+  return ENCODE_CODE_GROUP(entry);
+}
+
+
+static uint16_t receiveCodeGroup(RioPcs_t *pcs, const uint16_t codeGroup)
+{
+  uint16_t entry;
+  uint16_t character;
+
+
+  entry = decodeTable[codeGroup & 0x3ffu];
+  character = DECODE_CHARACTER(entry);
+
+  /* Check that the code group is valid with the current running disparity. */
+  if((entry & DECODE_VALID(pcs->rxDisparity)) != 0u)
+  {
+    /* The code group is valid. */
+  }
+  else if((entry & DECODE_VALID(1u - pcs->rxDisparity)) != 0u)
+  {
+    /* The code group is valid with the other running disparity. Continue
+       with the running disparity the code group was sent with. */
+    pcs->rxDisparity = (uint8_t) (1u - pcs->rxDisparity);
+    character |= RIOPCS_CHARACTER_ERROR;
+    pcs->statusRxDisparityError++;
+  }
+  else
+  {
+    /* The code group is not valid. */
+    character = RIOPCS_CHARACTER_ERROR;
+    pcs->statusRxCodeError++;
+  }
+  pcs->rxDisparity = (uint8_t) ((entry >> DECODE_DISPARITY_SHIFT(pcs->rxDisparity)) & 1u);
+
+  return character;
+}
+
+static uint32_t receiveError(RioPcs_t *pcs, RioSymbol_t *symbol)
+{
+  uint32_t returnValue;
+
+
+  if(!pcs->rxDiscard)
+  {
+    symbol->type = RIOSTACK_SYMBOL_TYPE_ERROR;
+    symbol->data = 0ul;
+    pcs->rxDiscard = 1u;
+    pcs->statusRxSymbolError++;
+    returnValue = 1ul;
+  }
+  else
+  {
+    /* An error symbol has already been delivered. */
+    returnValue = 0ul;
+  }
+  pcs->rxCounter = 0u;
+
+  return returnValue;
+}
+
+/*************************** end of file **************************************/
@@ -0,0 +1,260 @@
+/******************************************************************************
+ * (C) Copyright 2013-2015 Magnus Rosenius and the Free Software Foundation.
+ *
+ * This file is part of OpenRIO.
+ *
+ * OpenRIO is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenRIO is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Lesser Public License
+ * along with OpenRIO.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+
+/******************************************************************************
+ * Description:
+ * This file contains a software physical coding sublayer (PCS) for a 1x serial
+ * RapidIO link. It converts between the RioSymbols of riostack and 8b/10b
+ * encoded code groups, the same way as the PCS in
+ * rtl/vhdl/srio_pcs_struct.vhd.
+ *
+ * Characters are stored in uint16_t where the lower eight bits are the octet
+ * and RIOPCS_CHARACTER_K is set for special characters. Code groups are stored
+ * in the ten lower bits of uint16_t as abcdeifghj, where a is bit 9 and the
+ * first bit on the line. The encoding is table driven and the running
+ * disparity is kept across calls.
+ *
+ * The transmitter sends control symbols as a SC or PD character followed by
+ * the three octets of the control symbol, data symbols as four data characters
+ * and idle symbols as four characters from the idle sequence (K, A and R)
+ * generated the same way as idle_generator. A clock compensation sequence
+ * (K, R, R, R) is inserted between symbols every RIOPCS_CCS_INTERVAL
+ * characters.
+ *
+ * The receiver removes all idle characters and delivers control and data
+ * symbols. An invalid code group, a disparity error or an unexpected character
+ * delivers one error symbol and the receiver discards data characters until it
+ * is symbol aligned again on the next special character.
+ *
+ * Serial bitstreams, for example captured from hardware, can be converted to
+ * code groups using RIOPCS_findComma() and RIOPCS_unpackBits().
+ *
+ * Typical usage:
+ *   RIOPCS_open(&pcs);
+ *   n = RIOPCS_transmit(&pcs, &stack, SYMBOLS, codeGroups);
+ *   <send n code groups>
+ *   <receive m code groups>
+ *   RIOPCS_receive(&pcs, &stack, m, codeGroups);
+ *
+ * Any application specific tailoring needed to compile properly should be done
+ * in rioconfig.h.
+ ******************************************************************************/
+
+#ifndef __RIOPCS_H
+#define __RIOPCS_H
+
+/*******************************************************************************
+ * Include files.
+ *******************************************************************************/
+
+#include "rioconfig.h"
+#include "riostack.h"
+
+
+/*******************************************************************************
+ * Global macros.
+ *******************************************************************************/
+
+/** Flag in a character that marks a special (K) character. */
+#define RIOPCS_CHARACTER_K 0x100u
+
+/** Flag in a decoded character that marks an invalid code group or a disparity error. */
+#define RIOPCS_CHARACTER_ERROR 0x200u
+
+/** The special characters used by serial RapidIO. */
+#define RIOPCS_K (RIOPCS_CHARACTER_K | 0xbcu)  /**< K28.5, idle and comma. */
+#define RIOPCS_A (RIOPCS_CHARACTER_K | 0xfbu)  /**< K27.7, idle alignment. */
+#define RIOPCS_R (RIOPCS_CHARACTER_K | 0xfdu)  /**< K29.7, idle skip. */
+#define RIOPCS_SC (RIOPCS_CHARACTER_K | 0x1cu) /**< K28.0, start of control symbol. */
+#define RIOPCS_PD (RIOPCS_CHARACTER_K | 0x7cu) /**< K28.3, packet delimiter control symbol. */
+
+/** The number of characters between clock compensation sequences. */
+#define RIOPCS_CCS_INTERVAL 4096u
+
+/** The largest number of code groups that RIOPCS_encodeSymbols() creates from a number of symbols. */
+#define RIOPCS_CODE_GROUPS_MAX(symbols) (4u*(symbols) + 4u*((4u*(symbols))/RIOPCS_CCS_INTERVAL + 1u))
+
+
+/*******************************************************************************
+ * Global typedefs.
+ *******************************************************************************/
+
+/** The structure to keep all the PCS variables. */
+typedef struct
+{
+  /* Transmitter variables. */
+  uint8_t txDisparity;
+  uint8_t txLfsr;
+  uint8_t txIdleCounter;
+  uint8_t txIdlePrevious;
+  uint32_t txCcsCounter;
+
+  /* Receiver variables. */
+  uint8_t rxDisparity;
+  uint8_t rxCounter;
+  uint8_t rxDiscard;
+  RioSymbol_t rxSymbol;
+
+  /** The number of clock compensation sequences that has been transmitted. */
+  uint32_t statusTxCcs;
+
+  /** The number of idle characters that has been received. */
+  uint32_t statusRxIdle;
+
+  /** The number of invalid code groups that has been received. */
+  uint32_t statusRxCodeError;
+
+  /** The number of code groups that has been received with the wrong disparity. */
+  uint32_t statusRxDisparityError;
+
+  /** The number of error symbols that has been delivered. */
+  uint32_t statusRxSymbolError;
+} RioPcs_t;
+
+
+/*******************************************************************************
+ * Global function prototypes.
+ *******************************************************************************/
+
+/**
+ * \brief Open a PCS.
+ *
+ * \param[in] pcs The PCS to operate on.
+ *
+ * Both directions starts with negative running disparity.
+ */
+void RIOPCS_open(RioPcs_t *pcs);
+
+/**
+ * \brief Encode characters into code groups.
+ *
+ * \param[in] pcs The PCS to operate on.
+ * \param[in] count The number of characters to encode.
+ * \param[in] characters The characters to encode.
+ * \param[out] codeGroups The encoded code groups, count entries are written.
+ *
+ * Only the twelve valid special characters may be encoded.
+ */
+void RIOPCS_encodeCharacters(RioPcs_t *pcs, const uint32_t count,
+                             const uint16_t *characters, uint16_t *codeGroups);
+
+/**
+ * \brief Decode code groups into characters.
+ *
+ * \param[in] pcs The PCS to operate on.
+ * \param[in] count The number of code groups to decode.
+ * \param[in] codeGroups The code groups to decode.
+ * \param[out] characters The decoded characters, count entries are written.
+ * \return The number of characters that was marked with RIOPCS_CHARACTER_ERROR.
+ */
+uint32_t RIOPCS_decodeCharacters(RioPcs_t *pcs, const uint32_t count,
+                                 const uint16_t *codeGroups, uint16_t *characters);
+
+/**
+ * \brief Encode symbols into code groups.
+ *
+ * \param[in] pcs The PCS to operate on.
+ * \param[in] count The number of symbols to encode.
+ * \param[in] symbols The symbols to encode.
+ * \param[out] codeGroups The encoded code groups. Must have room for
+ * RIOPCS_CODE_GROUPS_MAX(count) entries.
+ * \return The number of code groups that was written.
+ *
+ * Only the lower 24 bits of control symbols are encoded, the extended ackId 
+ * byte is not transferred.
+ */
+uint32_t RIOPCS_encodeSymbols(RioPcs_t *pcs, const uint32_t count,
+                              const RioSymbol_t *symbols, uint16_t *codeGroups);
+
+/**
+ * \brief Decode code groups into symbols.
+ *
+ * \param[in] pcs The PCS to operate on.
+ * \param[in] count The number of code groups to decode.
+ * \param[in] codeGroups The code groups to decode.
+ * \param[out] symbols The decoded symbols. Must have room for count entries.
+ * \return The number of symbols that was written.
+ *
+ * A symbol that is not complete when the code groups ends is completed by the
+ * next call.
+ */
+uint32_t RIOPCS_decodeSymbols(RioPcs_t *pcs, const uint32_t count,
+                              const uint16_t *codeGroups, RioSymbol_t *symbols);
+
+/**
+ * \brief Get symbols from a stack and encode them.
+ *
+ * \param[in] pcs The PCS to operate on.
+ * \param[in] stack The stack to get symbols from.
+ * \param[in] symbols The number of symbols to get.
+ * \param[out] codeGroups The encoded code groups. Must have room for
+ * RIOPCS_CODE_GROUPS_MAX(symbols) entries.
+ * \return The number of code groups that was written.
+ */
+uint32_t RIOPCS_transmit(RioPcs_t *pcs, RioStack_t *stack,
+                         const uint32_t symbols, uint16_t *codeGroups);
+
+/**
+ * \brief Decode code groups and add the symbols to a stack.
+ *
+ * \param[in] pcs The PCS to operate on.
+ * \param[in] stack The stack to add the symbols to.
+ * \param[in] count The number of code groups.
+ * \param[in] codeGroups The code groups to decode.
+ */
+void RIOPCS_receive(RioPcs_t *pcs, RioStack_t *stack,
+                    const uint32_t count, const uint16_t *codeGroups);
+
+/**
+ * \brief Find the first comma in a serial bitstream.
+ *
+ * \param[in] bitCount The number of bits in the bitstream.
+ * \param[in] bits The bitstream. The first bit is the most significant bit of
+ * the first byte.
+ * \return The bit offset of the code group that contains the comma or
+ * bitCount if no comma was found.
+ */
+uint32_t RIOPCS_findComma(const uint32_t bitCount, const uint8_t *bits);
+
+/**
+ * \brief Get code groups from a serial bitstream.
+ *
+ * \param[in] bitOffset The bit offset of the first code group.
+ * \param[in] count The number of code groups to get.
+ * \param[in] bits The bitstream. The first bit is the most significant bit of
+ * the first byte.
+ * \param[out] codeGroups The code groups.
+ */
+void RIOPCS_unpackBits(const uint32_t bitOffset, const uint32_t count,
+                       const uint8_t *bits, uint16_t *codeGroups);
+
+/**
+ * \brief Create a serial bitstream from code groups.
+ *
+ * \param[in] count The number of code groups.
+ * \param[in] codeGroups The code groups.
+ * \param[out] bits The bitstream. Must have room for (10*count+7)/8 bytes.
+ * Unused bits in the last byte are set to zero.
+ */
+void RIOPCS_packBits(const uint32_t count, const uint16_t *codeGroups, uint8_t *bits);
+
+#endif
+
+/*************************** end of file **************************************/
@@ -0,0 +1,225 @@
+/******************************************************************************
+ * (C) Copyright 2013-2015 Magnus Rosenius and the Free Software Foundation.
+ *
+ * This file is part of OpenRIO.
+ *
+ * OpenRIO is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenRIO is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Lesser Public License
+ * along with OpenRIO.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+/******************************************************************************
+ * Description:
+ * This file contains a fixed capacity pool of RapidIO packets.
+ * See riopool.h for more info.
+ *
+ * The free list is a stack of element indexes. The head of the stack is kept
+ * in one 32-bit word together with a tag that is incremented on every
+ * modification to avoid the ABA-problem when the head is updated using
+ * compare-and-swap.
+ *
+ * Any application specific tailoring needed to compile properly should be done
+ * in rioconfig.h.
+ ******************************************************************************/
+
+/*******************************************************************************
+ * Includes
+ *******************************************************************************/
+
+#include "riopool.h"
+
+/* Get definitions of ASSERT() and the atomic operations. */
+#include "rioconfig.h"
+
+
+/*******************************************************************************
+ * Local macro definitions
+ *******************************************************************************/
+
+/*lint -save */
+/*lint -e961 Macros are needed due to performance reasons. They are also
+  trivial and clarifies the code. */
+/* Macros to access the parts of the free list head. */
+#define FREE_LIST_INDEX_GET(head) ((uint16_t) ((head) & 0x0000fffful))
+#define FREE_LIST_TAG_GET(head) ((uint16_t) ((head) >> 16))
+#define FREE_LIST_CREATE(tag, index) ((((uint32_t) (tag)) << 16) | ((uint32_t) (index)))
+/*lint -restore */
+
+/* The index used to mark the end of the free list. */
+#define FREE_LIST_END ((uint16_t) 0xffffu)
+
+
+/*******************************************************************************
+ * Global functions
+ *******************************************************************************/
+
+void RIOPOOL_open(RioPool_t *pool, const uint16_t size, RioPoolEntry_t *entries)
+{
+  uint16_t i;
+
+
+  ASSERT(pool != NULL, "Invalid pool pointer");
+  ASSERT((entries != NULL) || (size == 0u), "Invalid entries pointer");
+  ASSERT(size <= RIOPOOL_SIZE_MAX, "Too many entries");
+
+  /* Link all the elements into the free list. */
+  for(i = 0u; i < size; i++)
+  {
+    entries[i].packet.size = 0u;
+    entries[i].references = 0ul;
+    if((i+1u) < size)
+    {
+      entries[i].next = (uint32_t) i + 1ul;
+    }
+    else
+    {
+      entries[i].next = (uint32_t) FREE_LIST_END;
+    }
+  }
+
+  pool->size = size;
+  pool->available = size;
+  pool->entries = entries;
+  if(size > 0u)
+  {
+    pool->freeList = FREE_LIST_CREATE(0u, 0u);
+  }
+  else
+  {
+    pool->freeList = FREE_LIST_CREATE(0u, FREE_LIST_END);
+  }
+}
+
+
+uint16_t RIOPOOL_getAvailable(const RioPool_t *pool)
+{
+  ASSERT(pool != NULL, "Invalid pool pointer");
+  return (uint16_t) RIO_ATOMIC_LOAD(&pool->available);
+}
+
+
+RioPoolHandle_t RIOPOOL_allocate(RioPool_t *pool)
+{
+  RioPoolHandle_t handle;
+  uint32_t head;
+  uint32_t next;
+  uint16_t index;
+
+
+  ASSERT(pool != NULL, "Invalid pool pointer");
+
+  /* Pop the first element from the free list. Retry if another context
+     has modified the list while the next element was read. */
+  head = RIO_ATOMIC_LOAD(&pool->freeList);
+  do
+  {
+    index = FREE_LIST_INDEX_GET(head);
+    if(index != FREE_LIST_END)
+    {
+      next = FREE_LIST_CREATE(FREE_LIST_TAG_GET(head)+1u,
+                              FREE_LIST_INDEX_GET(pool->entries[index].next));
+    }
+    else
+    {
+      /* The pool is empty. */
+      next = head;
+    }
+  } while((index != FREE_LIST_END) && (!RIO_ATOMIC_CAS(&pool->freeList, &head, next)));
+
+  /* Check if an element was found. */
+  if(index != FREE_LIST_END)
+  {
+    /* An element was removed from the free list. */
+    (void) RIO_ATOMIC_SUB(&pool->available, 1ul);
+    pool->entries[index].references = 1ul;
+    pool->entries[index].packet.size = 0u;
+    handle = (RioPoolHandle_t) index;
+  }
+  else
+  {
+    /* No free elements. */
+    handle = RIOPOOL_HANDLE_INVALID;
+  }
+
+  return handle;
+}
+
+
+RioPacket_t *RIOPOOL_getPacket(RioPool_t *pool, const RioPoolHandle_t handle)
+{
+  ASSERT(pool != NULL, "Invalid pool pointer");
+  ASSERT(handle < pool->size, "Invalid handle");
+  return &pool->entries[handle].packet;
+}
+
+
+uint32_t RIOPOOL_getReferences(const RioPool_t *pool, const RioPoolHandle_t handle)
+{
+  ASSERT(pool != NULL, "Invalid pool pointer");
+  ASSERT(handle < pool->size, "Invalid handle");
+  return RIO_ATOMIC_LOAD(&pool->entries[handle].references);
+}
+
+
+void RIOPOOL_retain(RioPool_t *pool, const RioPoolHandle_t handle)
+{
+  ASSERT(pool != NULL, "Invalid pool pointer");
+  ASSERT(handle < pool->size, "Invalid handle");
+  ASSERT(pool->entries[handle].references != 0ul, "Retaining a free packet");
+
+  (void) RIO_ATOMIC_ADD(&pool->entries[handle].references, 1ul);
+}
+
+
+void RIOPOOL_release(RioPool_t *pool, const RioPoolHandle_t handle)
+{
+  uint32_t head;
+  uint32_t next;
+
+
+  ASSERT(pool != NULL, "Invalid pool pointer");
+  ASSERT(handle < pool->size, "Invalid handle");
+
+  /* Check that the packet is in use. */
+  if(RIO_ATOMIC_LOAD(&pool->entries[handle].references) != 0ul)
+  {
+    /* The packet is in use. */
+
+    /* Remove the reference and check if this was the last one. */
+    if(RIO_ATOMIC_SUB(&pool->entries[handle].references, 1ul) == 0ul)
+    {
+      /* The last reference was removed. */
+
+      /* Push the element first in the free list. */
+      head = RIO_ATOMIC_LOAD(&pool->freeList);
+      do
+      {
+        pool->entries[handle].next = (uint32_t) FREE_LIST_INDEX_GET(head);
+        next = FREE_LIST_CREATE(FREE_LIST_TAG_GET(head)+1u, handle);
+      } while(!RIO_ATOMIC_CAS(&pool->freeList, &head, next));
+
+      (void) RIO_ATOMIC_ADD(&pool->available, 1ul);
+    }
+    else
+    {
+      /* There are more references. */
+      /* Don't do anything. */
+    }
+  }
+  else
+  {
+    /* The packet has already been released. */
+    ASSERT0("Releasing a free packet");
+  }
+}
+
+/*************************** end of file **************************************/
@@ -0,0 +1,180 @@
+/******************************************************************************
+ * (C) Copyright 2013-2015 Magnus Rosenius and the Free Software Foundation.
+ *
+ * This file is part of OpenRIO.
+ *
+ * OpenRIO is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenRIO is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Lesser Public License
+ * along with OpenRIO.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+/******************************************************************************
+ * Description:
+ * This file contains a fixed capacity pool of RapidIO packets.
+ * The packets are stored in a user supplied array and are referenced using
+ * small integer handles. Allocation and release are O(1) and does not take any
+ * locks, the free list is updated using the compare-and-swap primitive defined
+ * in rioconfig.h which makes it possible to allocate and release packets from
+ * different execution contexts, for example an interrupt handler and a task.
+ *
+ * Each allocated packet has a reference count. A packet that should be sent to
+ * several destinations or be kept while also being queued somewhere else can
+ * be retained once for every extra user instead of being copied. The packet is
+ * returned to the pool when the last reference is released.
+ *
+ * The packet builders in riopacket.h are used directly on pooled packets:
+ *   handle = RIOPOOL_allocate(&pool);
+ *   if(handle != RIOPOOL_HANDLE_INVALID)
+ *   {
+ *     RIOPACKET_setDoorbell(RIOPOOL_getPacket(&pool, handle), ...);
+ *     RIOSTACK_setOutboundPacketHandle(stack, &pool, handle);
+ *   }
+ *
+ * If packets of very different sizes are used, one pool per size class can be
+ * opened and the application can choose the pool to allocate from. A stack can
+ * queue packets from up to RIOSTACK_POOLS pools at the same time.
+ *
+ * Any application specific tailoring needed to compile properly should be done
+ * in rioconfig.h.
+ ******************************************************************************/
+
+#ifndef __RIOPOOL_H
+#define __RIOPOOL_H
+
+/*******************************************************************************
+ * Include files.
+ *******************************************************************************/
+
+#include "rioconfig.h"
+#include "riopacket.h"
+
+
+/*******************************************************************************
+ * Global macros.
+ *******************************************************************************/
+
+/** The value returned when no packet could be allocated. */
+#define RIOPOOL_HANDLE_INVALID ((RioPoolHandle_t) 0xffffu)
+
+/** The maximum number of packets a pool can contain. */
+#define RIOPOOL_SIZE_MAX ((uint16_t) 0xfffeu)
+
+
+/*******************************************************************************
+ * Global typedefs.
+ *******************************************************************************/
+
+/** A reference to a packet in a pool. */
+typedef uint16_t RioPoolHandle_t;
+
+/** An element in a pool. */
+/** \internal Note that the fields other than packet are for internal usage only. */
+typedef struct
+{
+  RioPacket_t packet; /**< The packet content. */
+  uint32_t references; /**< The number of references to the packet, zero when it is free. */
+  uint32_t next; /**< The next free element when the element is free. */
+} RioPoolEntry_t;
+
+/** The structure to keep all the pool variables. */
+typedef struct
+{
+  uint16_t size; /**< The number of elements in the pool. */
+  uint32_t available; /**< The number of free elements in the pool. */
+  uint32_t freeList; /**< The first free element (15:0) and a modification tag (31:16). */
+  RioPoolEntry_t *entries; /**< The user supplied elements. */
+} RioPool_t;
+
+
+/*******************************************************************************
+ * Global function prototypes.
+ *******************************************************************************/
+
+/**
+ * \brief Open a packet pool for operation.
+ *
+ * \param[in] pool The pool to operate on.
+ * \param[in] size The number of elements in the entries argument.
+ * \param[in] entries The elements to store packets in.
+ *
+ * This function initializes a pool and places all elements in the free list.
+ *
+ * \note The pool must not be used by other execution contexts while it is
+ * opened.
+ */
+void RIOPOOL_open(RioPool_t *pool, const uint16_t size, RioPoolEntry_t *entries);
+
+/**
+ * \brief Get the number of free packets in a pool.
+ *
+ * \param[in] pool The pool to operate on.
+ * \return The number of packets that can be allocated.
+ */
+uint16_t RIOPOOL_getAvailable(const RioPool_t *pool);
+
+/**
+ * \brief Allocate a packet.
+ *
+ * \param[in] pool The pool to operate on.
+ * \return A handle to the allocated packet or RIOPOOL_HANDLE_INVALID if the
+ * pool is empty.
+ *
+ * This function removes a packet from the free list and sets its reference
+ * count to one. The packet content is initialized to an empty packet.
+ */
+RioPoolHandle_t RIOPOOL_allocate(RioPool_t *pool);
+
+/**
+ * \brief Get the packet referenced by a handle.
+ *
+ * \param[in] pool The pool to operate on.
+ * \param[in] handle A handle returned by RIOPOOL_allocate().
+ * \return A pointer to the packet.
+ *
+ * The returned pointer is valid until the last reference to the handle has
+ * been released.
+ */
+RioPacket_t *RIOPOOL_getPacket(RioPool_t *pool, const RioPoolHandle_t handle);
+
+/**
+ * \brief Get the number of references to a packet.
+ *
+ * \param[in] pool The pool to operate on.
+ * \param[in] handle A handle returned by RIOPOOL_allocate().
+ * \return The number of references, zero if the packet is free.
+ */
+uint32_t RIOPOOL_getReferences(const RioPool_t *pool, const RioPoolHandle_t handle);
+
+/**
+ * \brief Add a reference to a packet.
+ *
+ * \param[in] pool The pool to operate on.
+ * \param[in] handle A handle returned by RIOPOOL_allocate().
+ *
+ * Every call to this function must be matched by a call to RIOPOOL_release().
+ */
+void RIOPOOL_retain(RioPool_t *pool, const RioPoolHandle_t handle);
+
+/**
+ * \brief Remove a reference to a packet.
+ *
+ * \param[in] pool The pool to operate on.
+ * \param[in] handle A handle returned by RIOPOOL_allocate().
+ *
+ * The packet is returned to the pool when the last reference is released and
+ * the handle must not be used after that.
+ */
+void RIOPOOL_release(RioPool_t *pool, const RioPoolHandle_t handle);
+
+#endif /* __RIOPOOL_H */
+
+/*************************** end of file **************************************/
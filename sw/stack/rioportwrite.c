@@ -0,0 +1,362 @@
+/******************************************************************************
+ * (C) Copyright 2013-2015 Magnus Rosenius and the Free Software Foundation.
+ *
+ * This file is part of OpenRIO.
+ *
+ * OpenRIO is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenRIO is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Lesser Public License
+ * along with OpenRIO.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+
+/******************************************************************************
+ * Description:
+ * This file contains a collector for received maintenance port-write packets.
+ * See rioportwrite.h for more info.
+ *
+ * Any application specific tailoring needed to compile properly should be done
+ * in rioconfig.h.
+ ******************************************************************************/
+
+/*******************************************************************************
+ * Includes
+ *******************************************************************************/
+
+#include "rioportwrite.h"
+
+/* Get definitions of ASSERT(), assumed to not return. */
+#include "rioconfig.h"
+
+
+/*******************************************************************************
+ * Local function prototypes
+ *******************************************************************************/
+
+/**
+ * \brief The inbound handler registered in the stack.
+ *
+ * \param[in] context The port-write collector.
+ * \param[in] stack The stack that received the packet.
+ * \param[in] packet The received MAINTENANCE packet.
+ * \return Non-zero if the packet was a port-write.
+ */
+static uint8_t inboundHandler(void *context, RioStack_t *stack, const RioPacket_t *packet);
+
+/**
+ * \brief Count a port-write from a source.
+ *
+ * \param[in] portWrite The port-write collector to operate on.
+ * \param[in] source The source deviceId of the port-write.
+ */
+static void countSource(RioPortWrite_t *portWrite, const uint16_t source);
+
+/**
+ * \brief Update the number of tokens in the rate limiter.
+ *
+ * \param[in] portWrite The port-write collector to operate on.
+ * \param[in] time The current time.
+ */
+static void updateTokens(RioPortWrite_t *portWrite, const uint32_t time);
+
+
+/*******************************************************************************
+ * Global functions
+ *******************************************************************************/
+
+void RIOPORTWRITE_open(RioPortWrite_t *portWrite,
+                       const uint16_t eventsSize, RioPortWriteEvent_t *events,
+                       const uint16_t sourcesSize, RioPortWriteSource_t *sources)
+{
+  ASSERT(portWrite != NULL, "Invalid port-write pointer");
+  ASSERT((events != NULL) || (eventsSize == 0u), "Invalid events pointer");
+  ASSERT((sources != NULL) || (sourcesSize == 0u), "Invalid sources pointer");
+
+  portWrite->events = events;
+  portWrite->eventsSize = eventsSize;
+  portWrite->eventsFront = 0u;
+  portWrite->eventsLength = 0u;
+
+  portWrite->sources = sources;
+  portWrite->sourcesSize = sourcesSize;
+  portWrite->sourcesUsed = 0u;
+
+  portWrite->window = 0ul;
+
+  portWrite->ratePeriod = 0ul;
+  portWrite->rateBurst = 0u;
+  portWrite->rateTokens = 0u;
+  portWrite->rateTime = 0ul;
+
+  portWrite->statusReceived = 0ul;
+  portWrite->statusAggregated = 0ul;
+  portWrite->statusDropped = 0ul;
+}
+
+
+void RIOPORTWRITE_setWindow(RioPortWrite_t *portWrite, const uint32_t window)
+{
+  ASSERT(portWrite != NULL, "Invalid port-write pointer");
+  portWrite->window = window;
+}
+
+
+void RIOPORTWRITE_setRateLimit(RioPortWrite_t *portWrite, const uint32_t period, const uint16_t burst)
+{
+  ASSERT(portWrite != NULL, "Invalid port-write pointer");
+  ASSERT((period == 0ul) || (burst > 0u), "Invalid burst size");
+
+  portWrite->ratePeriod = period;
+  portWrite->rateBurst = burst;
+  portWrite->rateTokens = burst;
+}
+
+
+void RIOPORTWRITE_attach(RioPortWrite_t *portWrite, RioStack_t *stack)
+{
+  ASSERT(portWrite != NULL, "Invalid port-write pointer");
+  RIOSTACK_setInboundHandler(stack, RIOPACKET_FTYPE_MAINTENANCE, inboundHandler, portWrite);
+}
+
+
+uint8_t RIOPORTWRITE_receive(RioPortWrite_t *portWrite, const RioPacket_t *packet, const uint32_t time)
+{
+  uint8_t returnValue;
+  RioPortWriteEvent_t received;
+  RioPortWriteEvent_t *event;
+  uint16_t destination;
+  uint16_t i;
+
+
+  ASSERT(portWrite != NULL, "Invalid port-write pointer");
+
+  /* Check if the packet is a port-write. */
+  if((RIOPACKET_getFtype(packet) == RIOPACKET_FTYPE_MAINTENANCE) &&
+     (RIOPACKET_getTt(packet) == (uint8_t) RIOPACKET_TT_16BITS) &&
+     (RIOPACKET_getTransaction(packet) == RIOPACKET_TRANSACTION_MAINT_PORT_WRITE_REQUEST))
+  {
+    /* Port-write. */
+    RIOPACKET_getMaintPortWrite(packet, &destination, &received.source,
+                                &received.componentTag, &received.portErrorDetect,
+                                &received.implementationSpecific, &received.portId,
+                                &received.logicalTransportErrorDetect);
+    countSource(portWrite, received.source);
+    portWrite->statusReceived++;
+
+    /* Find an undelivered event with the same key. */
+    event = NULL;
+    for(i = 0u; (event == NULL) && (i < portWrite->eventsLength); i++)
+    {
+      event = &portWrite->events[(portWrite->eventsFront + i) % portWrite->eventsSize];
+      if((event->source != received.source) ||
+         (event->componentTag != received.componentTag) ||
+         (event->portId != received.portId) ||
+         (event->portErrorDetect != received.portErrorDetect))
+      {
+        event = NULL;
+      }
+      else
+      {
+        /* Found a matching event. */
+      }
+    }
+
+    if(event != NULL)
+    {
+      /* Aggregate into the found event. */
+      event->implementationSpecific = received.implementationSpecific;
+      event->logicalTransportErrorDetect |= received.logicalTransportErrorDetect;
+      if(event->count != 0xffffu)
+      {
+        event->count++;
+      }
+      else
+      {
+        /* Saturate the counter. */
+      }
+      portWrite->statusAggregated++;
+    }
+    else if(portWrite->eventsLength < portWrite->eventsSize)
+    {
+      /* Create a new event. */
+      received.count = 1u;
+      received.time = time;
+      portWrite->events[(portWrite->eventsFront + portWrite->eventsLength) % portWrite->eventsSize] = received;
+      portWrite->eventsLength++;
+    }
+    else
+    {
+      /* The event queue is full. */
+      portWrite->statusDropped++;
+    }
+
+    returnValue = 1u;
+  }
+  else
+  {
+    /* Not a port-write. */
+    returnValue = 0u;
+  }
+
+  return returnValue;
+}
+
+
+uint16_t RIOPORTWRITE_getEventQueueLength(const RioPortWrite_t *portWrite)
+{
+  ASSERT(portWrite != NULL, "Invalid port-write pointer");
+  return portWrite->eventsLength;
+}
+
+
+uint32_t RIOPORTWRITE_getSourceCount(const RioPortWrite_t *portWrite, const uint16_t source)
+{
+  uint32_t count;
+  uint16_t i;
+
+
+  ASSERT(portWrite != NULL, "Invalid port-write pointer");
+
+  count = 0ul;
+  for(i = 0u; i < portWrite->sourcesUsed; i++)
+  {
+    if(portWrite->sources[i].source == source)
+    {
+      count = portWrite->sources[i].count;
+    }
+    else
+    {
+      /* Don't do anything. */
+    }
+  }
+
+  return count;
+}
+
+
+uint8_t RIOPORTWRITE_poll(RioPortWrite_t *portWrite, const uint32_t time, RioPortWriteEvent_t *event)
+{
+  uint8_t returnValue;
+  RioPortWriteEvent_t *oldest;
+
+
+  ASSERT(portWrite != NULL, "Invalid port-write pointer");
+
+  updateTokens(portWrite, time);
+
+  returnValue = 0u;
+  if(portWrite->eventsLength > 0u)
+  {
+    /* There are events. */
+
+    /* Check if the window of the oldest event has passed and if the rate 
+       limit allows another event. */
+    oldest = &portWrite->events[portWrite->eventsFront];
+    if(((time - oldest->time) >= portWrite->window) &&
+       ((portWrite->ratePeriod == 0ul) || (portWrite->rateTokens > 0u)))
+    {
+      /* Deliver the event. */
+      *event = *oldest;
+      portWrite->eventsFront = (uint16_t) ((portWrite->eventsFront + 1u) % portWrite->eventsSize);
+      portWrite->eventsLength--;
+      if(portWrite->ratePeriod != 0ul)
+      {
+        portWrite->rateTokens--;
+      }
+      else
+      {
+        /* No rate limit. */
+      }
+      returnValue = 1u;
+    }
+    else
+    {
+      /* Not allowed to deliver yet. */
+    }
+  }
+  else
+  {
+    /* No events. */
+  }
+
+  return returnValue;
+}
+
+
+/*******************************************************************************
+ * Local functions
+ *******************************************************************************/
+
+static uint8_t inboundHandler(void *context, RioStack_t *stack, const RioPacket_t *packet)
+{
+  return RIOPORTWRITE_receive((RioPortWrite_t *) context, packet, stack->portTime);
+}
+
+
+static void countSource(RioPortWrite_t *portWrite, const uint16_t source)
+{
+  uint16_t i;
+
+
+  /* Find the counter of the source. */
+  for(i = 0u; (i < portWrite->sourcesUsed) && (portWrite->sources[i].source != source); i++)
+  {
+    /* Don't do anything. */
+  }
+
+  if(i < portWrite->sourcesUsed)
+  {
+    /* Found the counter. */
+    portWrite->sources[i].count++;
+  }
+  else if(portWrite->sourcesUsed < portWrite->sourcesSize)
+  {
+    /* New source. */
+    portWrite->sources[i].source = source;
+    portWrite->sources[i].count = 1ul;
+    portWrite->sourcesUsed++;
+  }
+  else
+  {
+    /* No room for more sources. */
+  }
+}
+
+
+static void updateTokens(RioPortWrite_t *portWrite, const uint32_t time)
+{
+  uint32_t generated;
+
+
+  if(portWrite->ratePeriod != 0ul)
+  {
+    /* Add one token for every period that has passed since the last update. */
+    generated = (time - portWrite->rateTime) / portWrite->ratePeriod;
+    if(generated >= (uint32_t) (portWrite->rateBurst - portWrite->rateTokens))
+    {
+      /* The bucket is full. */
+      portWrite->rateTokens = portWrite->rateBurst;
+      portWrite->rateTime = time;
+    }
+    else
+    {
+      /* Keep the remainder of the current period. */
+      portWrite->rateTokens += (uint16_t) generated;
+      portWrite->rateTime += generated * portWrite->ratePeriod;
+    }
+  }
+  else
+  {
+    /* No rate limit. */
+  }
+}
+
+/*************************** end of file **************************************/
@@ -0,0 +1,220 @@
+/******************************************************************************
+ * (C) Copyright 2013-2015 Magnus Rosenius and the Free Software Foundation.
+ *
+ * This file is part of OpenRIO.
+ *
+ * OpenRIO is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenRIO is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Lesser Public License
+ * along with OpenRIO.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+
+/******************************************************************************
+ * Description:
+ * This file contains a collector for received maintenance port-write packets.
+ *
+ * Switches send port-writes when errors are detected on their ports. During
+ * link flaps the same error may be reported a large number of times. The
+ * collector takes the port-writes directly from the receiver of a stack and
+ * aggregates them into events keyed on the source deviceId, the componentTag,
+ * the portId and the portErrorDetect bits. An event collects port-writes with
+ * the same key during a time window before it can be read by the application.
+ * Port-writes with the same key as an event that has not yet been read are
+ * counted in that event.
+ *
+ * The events are delivered at a limited rate using a token bucket. If the
+ * event table is full, port-writes that does not match an existing event are
+ * dropped and counted.
+ *
+ * The number of port-writes received from each source is also counted.
+ *
+ * Typical usage:
+ *   RIOPORTWRITE_open(&portWrite, EVENTS, events, SOURCES, sources);
+ *   RIOPORTWRITE_setWindow(&portWrite, 1000);
+ *   RIOPORTWRITE_setRateLimit(&portWrite, 100, 4);
+ *   RIOPORTWRITE_attach(&portWrite, &stack);
+ *   ...
+ *   while(RIOPORTWRITE_poll(&portWrite, time, &event))
+ *   {
+ *     <handle error>
+ *   }
+ *
+ * Any application specific tailoring needed to compile properly should be done
+ * in rioconfig.h.
+ ******************************************************************************/
+
+#ifndef __RIOPORTWRITE_H
+#define __RIOPORTWRITE_H
+
+/*******************************************************************************
+ * Include files.
+ *******************************************************************************/
+
+#include "rioconfig.h"
+#include "riopacket.h"
+#include "riostack.h"
+
+
+/*******************************************************************************
+ * Global typedefs.
+ *******************************************************************************/
+
+/** Aggregated port-writes. */
+typedef struct
+{
+  uint16_t source; /**< The source deviceId of the port-writes. */
+  uint32_t componentTag; /**< The componentTag of the port-writes. */
+  uint8_t portId; /**< The portId of the port-writes. */
+  uint32_t portErrorDetect; /**< The Port N Error Detect CSR of the port-writes. */
+  uint32_t implementationSpecific; /**< The implementation specific value of the latest port-write. */
+  uint32_t logicalTransportErrorDetect; /**< The Logical/Transport Layer Error Detect CSR of 
+                                             all the port-writes or'ed together. */
+  uint16_t count; /**< The number of port-writes this event represents. */
+  uint32_t time; /**< The time when the first port-write was received. */
+} RioPortWriteEvent_t;
+
+/** A port-write counter for a source. */
+typedef struct
+{
+  uint16_t source; /**< The source deviceId. */
+  uint32_t count; /**< The number of port-writes received from the source. */
+} RioPortWriteSource_t;
+
+/** The structure to keep all the port-write collector variables. */
+typedef struct
+{
+  RioPortWriteEvent_t *events; /**< The storage of the event queue. */
+  uint16_t eventsSize; /**< The number of events that fits in the event queue. */
+  uint16_t eventsFront; /**< The index of the oldest event. */
+  uint16_t eventsLength; /**< The number of events in the event queue. */
+
+  RioPortWriteSource_t *sources; /**< The storage of the source counters. */
+  uint16_t sourcesSize; /**< The number of source counters that fits in the storage. */
+  uint16_t sourcesUsed; /**< The number of used source counters. */
+
+  uint32_t window; /**< The time to aggregate port-writes before delivering an event. */
+
+  uint32_t ratePeriod; /**< The time to generate one token, zero to not limit the rate. */
+  uint16_t rateBurst; /**< The maximum number of tokens. */
+  uint16_t rateTokens; /**< The current number of tokens. */
+  uint32_t rateTime; /**< The time when the tokens were last updated. */
+
+  /** The number of port-writes that has been received. */
+  uint32_t statusReceived;
+
+  /** The number of port-writes that was counted in an existing event. */
+  uint32_t statusAggregated;
+
+  /** The number of port-writes that was dropped since the event queue was full. */
+  uint32_t statusDropped;
+} RioPortWrite_t;
+
+
+/*******************************************************************************
+ * Global function prototypes.
+ *******************************************************************************/
+
+/**
+ * \brief Open a port-write collector for operation.
+ *
+ * \param[in] portWrite The port-write collector to operate on.
+ * \param[in] eventsSize The number of events in the events storage.
+ * \param[in] events The storage to use for events.
+ * \param[in] sourcesSize The number of counters in the sources storage.
+ * \param[in] sources The storage to use for source counters.
+ *
+ * This function empties the event queue and clears all counters. The window 
+ * is set to zero and the rate is not limited.
+ */
+void RIOPORTWRITE_open(RioPortWrite_t *portWrite,
+                       const uint16_t eventsSize, RioPortWriteEvent_t *events,
+                       const uint16_t sourcesSize, RioPortWriteSource_t *sources);
+
+/**
+ * \brief Set the aggregation window.
+ *
+ * \param[in] portWrite The port-write collector to operate on.
+ * \param[in] window The time an event collects port-writes before it can be 
+ *            delivered, in the same unit as RIOSTACK_portSetTime().
+ */
+void RIOPORTWRITE_setWindow(RioPortWrite_t *portWrite, const uint32_t window);
+
+/**
+ * \brief Set the rate limit of delivered events.
+ *
+ * \param[in] portWrite The port-write collector to operate on.
+ * \param[in] period The time between delivered events. Zero turns off the rate limit.
+ * \param[in] burst The number of events that can be delivered at once after an 
+ *            idle period.
+ *
+ * The bucket is filled when this function is called.
+ */
+void RIOPORTWRITE_setRateLimit(RioPortWrite_t *portWrite, const uint32_t period, const uint16_t burst);
+
+/**
+ * \brief Start receiving port-writes from a stack.
+ *
+ * \param[in] portWrite The port-write collector to operate on.
+ * \param[in] stack The stack to receive port-writes from.
+ *
+ * This function registers the collector as the inbound handler of MAINTENANCE 
+ * packets in the stack. Maintenance packets that are not port-writes are 
+ * placed in the inbound queue.
+ */
+void RIOPORTWRITE_attach(RioPortWrite_t *portWrite, RioStack_t *stack);
+
+/**
+ * \brief Add a received port-write to the collector.
+ *
+ * \param[in] portWrite The port-write collector to operate on.
+ * \param[in] packet The received packet.
+ * \param[in] time The current time.
+ * \return Non-zero if the packet was a port-write, zero otherwise.
+ *
+ * This function is called by the stack when RIOPORTWRITE_attach() has been used
+ * but can also be used to add port-writes received from other sources.
+ */
+uint8_t RIOPORTWRITE_receive(RioPortWrite_t *portWrite, const RioPacket_t *packet, const uint32_t time);
+
+/**
+ * \brief Get the number of events that has not been delivered.
+ *
+ * \param[in] portWrite The port-write collector to operate on.
+ * \return The number of events in the event queue.
+ */
+uint16_t RIOPORTWRITE_getEventQueueLength(const RioPortWrite_t *portWrite);
+
+/**
+ * \brief Get the number of port-writes received from a source.
+ *
+ * \param[in] portWrite The port-write collector to operate on.
+ * \param[in] source The source deviceId.
+ * \return The number of port-writes received from the source.
+ *
+ * \note Sources received when all source counters are used are not counted.
+ */
+uint32_t RIOPORTWRITE_getSourceCount(const RioPortWrite_t *portWrite, const uint16_t source);
+
+/**
+ * \brief Get the next event to deliver.
+ *
+ * \param[in] portWrite The port-write collector to operate on.
+ * \param[in] time The current time.
+ * \param[out] event The delivered event.
+ * \return Non-zero if an event was delivered, zero if there is no event whose 
+ * window has passed or if the rate limit has been reached.
+ */
+uint8_t RIOPORTWRITE_poll(RioPortWrite_t *portWrite, const uint32_t time, RioPortWriteEvent_t *event);
+
+#endif /* __RIOPORTWRITE_H */
+
+/*************************** end of file **************************************/
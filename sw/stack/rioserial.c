@@ -0,0 +1,458 @@
+/******************************************************************************
+ * (C) Copyright 2013-2015 Magnus Rosenius and the Free Software Foundation.
+ *
+ * This file is part of OpenRIO.
+ *
+ * OpenRIO is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenRIO is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Lesser Public License
+ * along with OpenRIO.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+/******************************************************************************
+ * Description:
+ * This file contains a port driver for POSIX serial devices.
+ * See rioserial.h for more info.
+ ******************************************************************************/
+
+/*******************************************************************************
+ * Includes
+ *******************************************************************************/
+
+/* Get the pseudo terminal and clock functions. */
+#ifndef _XOPEN_SOURCE
+#define _XOPEN_SOURCE 600
+#endif
+#ifndef _DEFAULT_SOURCE
+#define _DEFAULT_SOURCE
+#endif
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "rioserial.h"
+
+/* Get definitions of ASSERT(), assumed to not return. */
+#include "rioconfig.h"
+
+
+/*******************************************************************************
+ * Local function prototypes
+ *******************************************************************************/
+
+/**
+ * \brief Set a terminal to raw mode.
+ *
+ * \param[in] fd The terminal.
+ * \param[in] baudrate The baudrate to use or zero to keep the current.
+ * \return Non-zero if the terminal was configured.
+ */
+static uint8_t setRaw(const int fd, const uint32_t baudrate);
+
+/**
+ * \brief Get the speed constant of a baudrate.
+ *
+ * \param[in] baudrate The baudrate.
+ * \return The speed constant or B0 if the baudrate is not supported.
+ */
+static speed_t getSpeed(const uint32_t baudrate);
+
+/**
+ * \brief Check if a failed read or write should be retried later.
+ *
+ * \return Non-zero if the call would have blocked or was interrupted.
+ */
+static uint8_t isTemporary(void);
+
+
+/*******************************************************************************
+ * Global functions
+ *******************************************************************************/
+
+uint8_t RIOSERIAL_open(RioSerial_t *serial, RioStack_t *stack,
+                       const char *device, const uint32_t baudrate)
+{
+  uint8_t returnValue;
+  int fd;
+
+
+  ASSERT(device != NULL, "Invalid device pointer");
+
+  fd = open(device, O_RDWR | O_NOCTTY | O_NONBLOCK);
+  if(fd >= 0)
+  {
+    if(setRaw(fd, baudrate) && RIOSERIAL_attach(serial, stack, fd))
+    {
+      serial->baudrate = baudrate;
+      returnValue = 1u;
+    }
+    else
+    {
+      (void) close(fd);
+      returnValue = 0u;
+    }
+  }
+  else
+  {
+    /* The device could not be opened. */
+    returnValue = 0u;
+  }
+
+  return returnValue;
+}
+
+
+uint8_t RIOSERIAL_openPty(RioSerial_t *master, RioStack_t *masterStack,
+                          RioSerial_t *slave, RioStack_t *slaveStack)
+{
+  uint8_t returnValue;
+  int masterFd;
+  int slaveFd;
+  char *name;
+
+
+  returnValue = 0u;
+  masterFd = posix_openpt(O_RDWR | O_NOCTTY);
+  if(masterFd >= 0)
+  {
+    name = NULL;
+    if((grantpt(masterFd) == 0) && (unlockpt(masterFd) == 0))
+    {
+      name = ptsname(masterFd);
+    }
+    else
+    {
+      /* Don't do anything. */
+    }
+
+    slaveFd = (name != NULL) ? open(name, O_RDWR | O_NOCTTY | O_NONBLOCK) : -1;
+    if(slaveFd >= 0)
+    {
+      /* The line discipline is on the slave side. */
+      if(setRaw(slaveFd, 0ul) &&
+         RIOSERIAL_attach(master, masterStack, masterFd) &&
+         RIOSERIAL_attach(slave, slaveStack, slaveFd))
+      {
+        returnValue = 1u;
+      }
+      else
+      {
+        (void) close(slaveFd);
+      }
+    }
+    else
+    {
+      /* Don't do anything. */
+    }
+
+    if(!returnValue)
+    {
+      (void) close(masterFd);
+    }
+    else
+    {
+      /* Don't do anything. */
+    }
+  }
+  else
+  {
+    /* No pseudo terminal available. */
+  }
+
+  return returnValue;
+}
+
+
+uint8_t RIOSERIAL_attach(RioSerial_t *serial, RioStack_t *stack, const int fd)
+{
+  uint8_t returnValue;
+  int flags;
+
+
+  ASSERT(serial != NULL, "Invalid serial pointer");
+  ASSERT(stack != NULL, "Invalid stack pointer");
+
+  flags = fcntl(fd, F_GETFL);
+  if((flags >= 0) && (fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0))
+  {
+    serial->fd = fd;
+    serial->stack = stack;
+    RIOUART_open(&serial->uart);
+    serial->baudrate = 0ul;
+    serial->txQueueSize = RIOSERIAL_TX_QUEUE_SIZE;
+    serial->txLength = 0ul;
+    serial->txOffset = 0ul;
+
+    serial->statusReadCalls = 0ul;
+    serial->statusWriteCalls = 0ul;
+    serial->statusBytesRead = 0ul;
+    serial->statusBytesWritten = 0ul;
+
+    RIOSTACK_portSetStatus(stack, 1u);
+    returnValue = 1u;
+  }
+  else
+  {
+    returnValue = 0u;
+  }
+
+  return returnValue;
+}
+
+
+void RIOSERIAL_close(RioSerial_t *serial)
+{
+  ASSERT(serial != NULL, "Invalid serial pointer");
+
+  if(serial->fd >= 0)
+  {
+    RIOSTACK_portSetStatus(serial->stack, 0u);
+    (void) close(serial->fd);
+    serial->fd = -1;
+  }
+  else
+  {
+    /* Already closed. */
+  }
+}
+
+
+void RIOSERIAL_setTxQueueSize(RioSerial_t *serial, const uint32_t size)
+{
+  ASSERT(size >= RIOUART_SYMBOL_SIZE_MAX, "Too small queue size");
+
+  serial->txQueueSize = size;
+}
+
+
+uint8_t RIOSERIAL_process(RioSerial_t *serial, const uint32_t time)
+{
+  uint8_t returnValue;
+  ssize_t length;
+  uint32_t room;
+  int queued;
+
+
+  ASSERT(serial != NULL, "Invalid serial pointer");
+
+  returnValue = 1u;
+  RIOSTACK_portSetTime(serial->stack, time);
+
+  /* Read and decode until there is nothing more to read. */
+  do
+  {
+    length = read(serial->fd, serial->rxBuffer, RIOSERIAL_BUFFER_SIZE);
+    if(length > 0)
+    {
+      serial->statusReadCalls++;
+      serial->statusBytesRead += (uint32_t) length;
+      RIOUART_receive(&serial->uart, serial->stack, (uint32_t) length, serial->rxBuffer);
+    }
+    else if((length < 0) && !isTemporary())
+    {
+      returnValue = 0u;
+    }
+    else
+    {
+      /* Nothing more to read. */
+    }
+  } while(length == (ssize_t) RIOSERIAL_BUFFER_SIZE);
+
+  /* Encode new symbols when the previous have been written. Only fill the
+     output queue of the device up to its configured size. */
+  if(returnValue && (serial->txOffset == serial->txLength))
+  {
+    if(ioctl(serial->fd, TIOCOUTQ, &queued) != 0)
+    {
+      queued = 0;
+    }
+    else
+    {
+      /* Don't do anything. */
+    }
+
+    room = ((uint32_t) queued < serial->txQueueSize) ? (serial->txQueueSize - (uint32_t) queued) : 0ul;
+    room = (room < RIOSERIAL_BUFFER_SIZE) ? room : RIOSERIAL_BUFFER_SIZE;
+    serial->txLength = RIOUART_transmit(serial->stack, room, serial->txBuffer);
+    serial->txOffset = 0ul;
+  }
+  else
+  {
+    /* Don't do anything. */
+  }
+
+  /* Write as much as the device accepts. */
+  if(returnValue && (serial->txOffset < serial->txLength))
+  {
+    length = write(serial->fd, &serial->txBuffer[serial->txOffset], serial->txLength - serial->txOffset);
+    if(length > 0)
+    {
+      serial->statusWriteCalls++;
+      serial->statusBytesWritten += (uint32_t) length;
+      serial->txOffset += (uint32_t) length;
+    }
+    else if((length < 0) && !isTemporary())
+    {
+      returnValue = 0u;
+    }
+    else
+    {
+      /* The device is full, try again later. */
+    }
+  }
+  else
+  {
+    /* Don't do anything. */
+  }
+
+  return returnValue;
+}
+
+
+void RIOSERIAL_wait(RioSerial_t *serial, const uint32_t timeout)
+{
+  struct pollfd fds;
+  uint32_t drain;
+
+
+  ASSERT(serial != NULL, "Invalid serial pointer");
+
+  fds.fd = serial->fd;
+  fds.events = POLLIN;
+  fds.revents = 0;
+  drain = timeout;
+  if(serial->txOffset < serial->txLength)
+  {
+    /* Wait until the device can accept the pending bytes. */
+    fds.events |= POLLOUT;
+  }
+  else if(serial->baudrate != 0ul)
+  {
+    /* Wake up when half of the output queue has been sent, ten bits per byte. */
+    drain = (5000ul * serial->txQueueSize) / serial->baudrate + 1ul;
+  }
+  else
+  {
+    /* Don't do anything. */
+  }
+
+  (void) poll(&fds, 1, (int) ((drain < timeout) ? drain : timeout));
+}
+
+
+uint32_t RIOSERIAL_getTime(void)
+{
+  struct timespec now;
+
+
+  (void) clock_gettime(CLOCK_MONOTONIC, &now);
+
+  return (uint32_t) ((uint32_t) now.tv_sec * 1000ul + (uint32_t) (now.tv_nsec / 1000000l));
+}
+
+
+/*******************************************************************************
+ * Local functions
+ *******************************************************************************/
+
+static uint8_t setRaw(const int fd, const uint32_t baudrate)
+{
+  uint8_t returnValue;
+  struct termios settings;
+  speed_t speed;
+
+
+  returnValue = 0u;
+  if(tcgetattr(fd, &settings) == 0)
+  {
+    cfmakeraw(&settings);
+    settings.c_cflag |= (CLOCAL | CREAD);
+    settings.c_cflag &= ~(CSTOPB | CRTSCTS);
+    settings.c_iflag &= ~(IXON | IXOFF | IXANY);
+    settings.c_cc[VMIN] = 0;
+    settings.c_cc[VTIME] = 0;
+
+    if(baudrate != 0ul)
+    {
+      speed = getSpeed(baudrate);
+      if((speed == B0) ||
+         (cfsetispeed(&settings, speed) != 0) || (cfsetospeed(&settings, speed) != 0))
+      {
+        errno = EINVAL;
+      }
+      else if(tcsetattr(fd, TCSANOW, &settings) == 0)
+      {
+        returnValue = 1u;
+      }
+      else
+      {
+        /* The settings could not be applied. */
+      }
+    }
+    else if(tcsetattr(fd, TCSANOW, &settings) == 0)
+    {
+      returnValue = 1u;
+    }
+    else
+    {
+      /* The settings could not be applied. */
+    }
+  }
+  else
+  {
+    /* Not a terminal. */
+  }
+
+  return returnValue;
+}
+
+
+static speed_t getSpeed(const uint32_t baudrate)
+{
+  speed_t speed;
+
+
+  switch(baudrate)
+  {
+    case 9600ul: speed = B9600; break;
+    case 19200ul: speed = B19200; break;
+    case 38400ul: speed = B38400; break;
+    case 57600ul: speed = B57600; break;
+    case 115200ul: speed = B115200; break;
+    case 230400ul: speed = B230400; break;
+#ifdef B460800
+    case 460800ul: speed = B460800; break;
+    case 921600ul: speed = B921600; break;
+    case 1000000ul: speed = B1000000; break;
+    case 1500000ul: speed = B1500000; break;
+    case 2000000ul: speed = B2000000; break;
+    case 3000000ul: speed = B3000000; break;
+    case 4000000ul: speed = B4000000; break;
+#endif
+    default: speed = B0; break;
+  }
+
+  return speed;
+}
+
+
+static uint8_t isTemporary(void)
+{
+  return (uint8_t) ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR));
+}
+
+/*************************** end of file **************************************/
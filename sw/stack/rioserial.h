@@ -0,0 +1,196 @@
+/******************************************************************************
+ * (C) Copyright 2013-2015 Magnus Rosenius and the Free Software Foundation.
+ *
+ * This file is part of OpenRIO.
+ *
+ * OpenRIO is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenRIO is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Lesser Public License
+ * along with OpenRIO.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+
+/******************************************************************************
+ * Description:
+ * This file contains a port driver that connects a stack to a POSIX serial
+ * device using the UART codec in riouart.h.
+ *
+ * The device is used in raw, non-blocking mode. Each call to
+ * RIOSERIAL_process() updates the time of the stack, reads and decodes all
+ * bytes that are available and encodes symbols from the stack until the output
+ * queue of the device contains RIOSERIAL_TX_QUEUE_SIZE bytes. This way, the
+ * number of system calls depends on the number of bytes that are transferred
+ * in each call instead of the number of bytes on the line, and the latency
+ * added by the output queue is bounded.
+ *
+ * The port is initialized in the stack when the device is opened.
+ * RIOSERIAL_openPty() connects two stacks using a pseudo terminal pair which
+ * is useful for testing.
+ *
+ * Typical usage:
+ *   RIOSERIAL_open(&serial, &stack, "/dev/ttyUSB0", 3000000ul);
+ *   RIOSTACK_portSetTimeout(&stack, 100);
+ *   while(1)
+ *   {
+ *     RIOSERIAL_process(&serial, RIOSERIAL_getTime());
+ *     <use the stack>
+ *     RIOSERIAL_wait(&serial, 10);
+ *   }
+ *
+ * This file requires a POSIX system.
+ ******************************************************************************/
+
+#ifndef __RIOSERIAL_H
+#define __RIOSERIAL_H
+
+/*******************************************************************************
+ * Include files.
+ *******************************************************************************/
+
+#include "rioconfig.h"
+#include "riostack.h"
+#include "riouart.h"
+
+
+/*******************************************************************************
+ * Global macros.
+ *******************************************************************************/
+
+/** The size of the receive and transmit buffers. */
+#define RIOSERIAL_BUFFER_SIZE 4096u
+
+/** The default number of bytes to keep in the output queue of the device. */
+#define RIOSERIAL_TX_QUEUE_SIZE 512u
+
+
+/*******************************************************************************
+ * Global typedefs.
+ *******************************************************************************/
+
+/** The structure to keep all the driver variables. */
+typedef struct
+{
+  int fd;
+  RioStack_t *stack;
+  RioUart_t uart;
+  uint32_t baudrate;
+  uint32_t txQueueSize;
+  uint32_t txLength;
+  uint32_t txOffset;
+  uint8_t rxBuffer[RIOSERIAL_BUFFER_SIZE];
+  uint8_t txBuffer[RIOSERIAL_BUFFER_SIZE];
+
+  /** The number of read() calls that returned data. */
+  uint32_t statusReadCalls;
+
+  /** The number of write() calls that accepted data. */
+  uint32_t statusWriteCalls;
+
+  /** The number of bytes that has been read. */
+  uint32_t statusBytesRead;
+
+  /** The number of bytes that has been written. */
+  uint32_t statusBytesWritten;
+} RioSerial_t;
+
+
+/*******************************************************************************
+ * Global function prototypes.
+ *******************************************************************************/
+
+/**
+ * \brief Open a serial device.
+ *
+ * \param[in] serial The driver to operate on.
+ * \param[in] stack The stack to connect the device to.
+ * \param[in] device The path of the device.
+ * \param[in] baudrate The baudrate to use.
+ * \return Non-zero if the device was opened, zero otherwise and errno is set.
+ *
+ * The device is set to raw mode with eight data bits, no parity and no flow
+ * control.
+ */
+uint8_t RIOSERIAL_open(RioSerial_t *serial, RioStack_t *stack,
+                       const char *device, const uint32_t baudrate);
+
+/**
+ * \brief Connect two stacks using a pseudo terminal pair.
+ *
+ * \param[in] master The driver to use for the master side.
+ * \param[in] masterStack The stack to connect to the master side.
+ * \param[in] slave The driver to use for the slave side.
+ * \param[in] slaveStack The stack to connect to the slave side.
+ * \return Non-zero if the pair was opened, zero otherwise and errno is set.
+ */
+uint8_t RIOSERIAL_openPty(RioSerial_t *master, RioStack_t *masterStack,
+                          RioSerial_t *slave, RioStack_t *slaveStack);
+
+/**
+ * \brief Connect a stack to an already open file descriptor.
+ *
+ * \param[in] serial The driver to operate on.
+ * \param[in] stack The stack to connect the file descriptor to.
+ * \param[in] fd The file descriptor. It is set to non-blocking and is closed
+ * by RIOSERIAL_close().
+ * \return Non-zero if the file descriptor was attached, zero otherwise and
+ * errno is set.
+ */
+uint8_t RIOSERIAL_attach(RioSerial_t *serial, RioStack_t *stack, const int fd);
+
+/**
+ * \brief Close a driver.
+ *
+ * \param[in] serial The driver to operate on.
+ *
+ * The port of the stack is set to uninitialized.
+ */
+void RIOSERIAL_close(RioSerial_t *serial);
+
+/**
+ * \brief Set the number of bytes to keep in the output queue of the device.
+ *
+ * \param[in] serial The driver to operate on.
+ * \param[in] size The number of bytes. Larger values use fewer system calls but
+ * adds latency.
+ */
+void RIOSERIAL_setTxQueueSize(RioSerial_t *serial, const uint32_t size);
+
+/**
+ * \brief Transfer symbols between the device and the stack.
+ *
+ * \param[in] serial The driver to operate on.
+ * \param[in] time The current time, given to RIOSTACK_portSetTime().
+ * \return Non-zero if the device is working, zero if a read or write failed
+ * and errno is set.
+ */
+uint8_t RIOSERIAL_process(RioSerial_t *serial, const uint32_t time);
+
+/**
+ * \brief Wait until there is something to do for the driver.
+ *
+ * \param[in] serial The driver to operate on.
+ * \param[in] timeout The longest time to wait in milliseconds.
+ *
+ * Returns when data can be read, when pending data can be written or when
+ * the output queue has had time to drain to half of its size.
+ */
+void RIOSERIAL_wait(RioSerial_t *serial, const uint32_t timeout);
+
+/**
+ * \brief Get the current time.
+ *
+ * \return A monotonic time in milliseconds.
+ */
+uint32_t RIOSERIAL_getTime(void);
+
+#endif
+
+/*************************** end of file **************************************/
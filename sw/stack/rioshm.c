@@ -0,0 +1,573 @@
+/******************************************************************************
+ * (C) Copyright 2013-2015 Magnus Rosenius and the Free Software Foundation.
+ *
+ * This file is part of OpenRIO.
+ *
+ * OpenRIO is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenRIO is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Lesser Public License
+ * along with OpenRIO.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+
+/******************************************************************************
+ * Description:
+ * This file contains a port driver for links in shared memory.
+ * See rioshm.h for more info.
+ ******************************************************************************/
+
+/*******************************************************************************
+ * Includes
+ *******************************************************************************/
+
+/* Get the shared memory and system call functions. */
+#ifndef _XOPEN_SOURCE
+#define _XOPEN_SOURCE 600
+#endif
+#ifndef _DEFAULT_SOURCE
+#define _DEFAULT_SOURCE
+#endif
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+#include "rioshm.h"
+
+/* Get definitions of ASSERT(), assumed to not return. */
+#include "rioconfig.h"
+
+
+/*******************************************************************************
+ * Local macros
+ *******************************************************************************/
+
+/* The value that marks an initialized segment, "RIO" and a version. */
+#define RIOSHM_MAGIC 0x52494f01ul
+
+/* The number of symbols to move between the stack and a ring at a time. */
+#define PROCESS_BATCH 64u
+
+/* The number of idle symbols to get from the stack in one call when a status
+   symbol is needed. The stack sends one after at most this many. */
+#define IDLE_LIMIT 256u
+
+/* The index in a ring of a position. */
+#define RING_INDEX(position) ((position) & (RIOSHM_RING_SIZE - 1u))
+
+
+/*******************************************************************************
+ * Local function prototypes
+ *******************************************************************************/
+
+/**
+ * \brief Map a shared memory object and set up a driver.
+ *
+ * \param[in] shm The driver to operate on.
+ * \param[in] stack The stack to connect to the link.
+ * \param[in] fd The shared memory object.
+ * \return Non-zero if the object was mapped.
+ */
+static uint8_t map(RioShm_t *shm, RioStack_t *stack, const int fd);
+
+/**
+ * \brief Sleep until the events of a ring has changed.
+ *
+ * \param[in] ring The ring to wait on.
+ * \param[in] events The events that was seen.
+ * \param[in] timeout The longest time to wait in milliseconds.
+ */
+static void sleepOnRing(RioShmRing_t *ring, const uint32_t events, const uint32_t timeout);
+
+/**
+ * \brief Tell the other side that something has happened.
+ *
+ * \param[in] shm The driver that has written or read symbols.
+ *
+ * The other side is only woken up with a system call if it sleeps.
+ */
+static void notify(RioShm_t *shm);
+
+
+/*******************************************************************************
+ * Global functions
+ *******************************************************************************/
+
+uint8_t RIOSHM_open(RioShm_t *shm, RioStack_t *stack, const char *name)
+{
+  uint8_t returnValue;
+  int fd;
+
+
+  ASSERT(name != NULL, "Invalid name pointer");
+
+  fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+  if(fd >= 0)
+  {
+    /* The segment did not exist, create it. */
+    returnValue = RIOSHM_create(shm, stack, fd);
+    if(!returnValue)
+    {
+      (void) close(fd);
+      (void) shm_unlink(name);
+    }
+    else
+    {
+      /* Don't do anything. */
+    }
+  }
+  else if(errno == EEXIST)
+  {
+    /* The segment exists, attach to it. */
+    fd = shm_open(name, O_RDWR, 0);
+    if(fd >= 0)
+    {
+      returnValue = RIOSHM_attach(shm, stack, fd);
+      if(!returnValue)
+      {
+        (void) close(fd);
+      }
+      else
+      {
+        /* Don't do anything. */
+      }
+    }
+    else
+    {
+      returnValue = 0u;
+    }
+  }
+  else
+  {
+    /* The segment could not be opened. */
+    returnValue = 0u;
+  }
+
+  return returnValue;
+}
+
+
+uint8_t RIOSHM_create(RioShm_t *shm, RioStack_t *stack, const int fd)
+{
+  uint8_t returnValue;
+  RioShmSegment_t *segment;
+
+
+  if((ftruncate(fd, (off_t) sizeof(RioShmSegment_t)) == 0) && map(shm, stack, fd))
+  {
+    segment = shm->segment;
+    segment->size = (uint32_t) sizeof(RioShmSegment_t);
+    segment->attached = 0ul;
+    memset(segment->ring, 0, sizeof(segment->ring));
+
+    /* Publish the segment when it is initialized. */
+    __atomic_store_n(&segment->magic, RIOSHM_MAGIC, __ATOMIC_RELEASE);
+
+    shm->txRing = &segment->ring[0];
+    shm->rxRing = &segment->ring[1];
+    RIOSTACK_portSetStatus(stack, 1u);
+    returnValue = 1u;
+  }
+  else
+  {
+    returnValue = 0u;
+  }
+
+  return returnValue;
+}
+
+
+uint8_t RIOSHM_attach(RioShm_t *shm, RioStack_t *stack, const int fd)
+{
+  uint8_t returnValue;
+  RioShmSegment_t *segment;
+  struct stat status;
+  uint32_t attached;
+
+
+  returnValue = 0u;
+  if(fstat(fd, &status) == 0)
+  {
+    if(status.st_size < (off_t) sizeof(RioShmSegment_t))
+    {
+      /* The segment has not been created yet. */
+      errno = EAGAIN;
+    }
+    else if(map(shm, stack, fd))
+    {
+      segment = shm->segment;
+      attached = 0ul;
+      if(__atomic_load_n(&segment->magic, __ATOMIC_ACQUIRE) == 0ul)
+      {
+        errno = EAGAIN;
+      }
+      else if((segment->magic != RIOSHM_MAGIC) || (segment->size != sizeof(RioShmSegment_t)))
+      {
+        errno = EINVAL;
+      }
+      else if(!__atomic_compare_exchange_n(&segment->attached, &attached, 1ul, 0,
+                                           __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+      {
+        errno = EBUSY;
+      }
+      else
+      {
+        shm->txRing = &segment->ring[1];
+        shm->rxRing = &segment->ring[0];
+        RIOSTACK_portSetStatus(stack, 1u);
+        returnValue = 1u;
+      }
+
+      if(!returnValue)
+      {
+        (void) munmap(segment, sizeof(RioShmSegment_t));
+        shm->fd = -1;
+      }
+      else
+      {
+        /* Don't do anything. */
+      }
+    }
+    else
+    {
+      /* The segment could not be mapped. */
+    }
+  }
+  else
+  {
+    /* Not a valid file descriptor. */
+  }
+
+  return returnValue;
+}
+
+
+void RIOSHM_close(RioShm_t *shm)
+{
+  ASSERT(shm != NULL, "Invalid shm pointer");
+
+  if(shm->fd >= 0)
+  {
+    RIOSTACK_portSetStatus(shm->stack, 0u);
+    (void) munmap(shm->segment, sizeof(RioShmSegment_t));
+    (void) close(shm->fd);
+    shm->fd = -1;
+  }
+  else
+  {
+    /* Already closed. */
+  }
+}
+
+
+void RIOSHM_setTxQueueSize(RioShm_t *shm, const uint32_t size)
+{
+  ASSERT((size > 0ul) && (size <= RIOSHM_RING_SIZE), "Invalid queue size");
+
+  shm->txQueueSize = size;
+}
+
+
+uint32_t RIOSHM_process(RioShm_t *shm, const uint32_t time)
+{
+  RioSymbol_t s[PROCESS_BATCH];
+  RioSymbol_t symbol;
+  uint32_t count;
+  uint32_t length;
+  uint32_t received;
+  uint32_t queued;
+  uint32_t room;
+  uint32_t idle;
+  uint32_t idleLimit;
+  uint8_t available;
+  uint32_t i;
+
+
+  ASSERT(shm != NULL, "Invalid shm pointer");
+
+  count = 0ul;
+  RIOSTACK_portSetTime(shm->stack, time);
+
+  /* Add the received symbols to the stack. Stop after one ring of symbols to
+     return even if the other side is faster. */
+  received = 0ul;
+  do
+  {
+    length = RIOSHM_receive(shm, PROCESS_BATCH, s);
+    for(i = 0ul; i < length; i++)
+    {
+      RIOSTACK_portAddSymbol(shm->stack, s[i]);
+    }
+    received += length;
+  } while((length == PROCESS_BATCH) && (received < RIOSHM_RING_SIZE));
+  count += received;
+
+  /* Fill the transmit ring up to its configured size. Idle symbols are not
+     needed by the other side and are dropped, stop when the stack has
+     nothing to send. The stack only sends status symbols after a number of
+     idle symbols, continue through them during link initialization and
+     when the application has freed inbound buffers, otherwise the other
+     side would not know that it may send more packets. */
+  if(__atomic_load_n(&shm->segment->attached, __ATOMIC_ACQUIRE))
+  {
+    queued = shm->txRing->head - __atomic_load_n(&shm->txRing->tail, __ATOMIC_ACQUIRE);
+    room = (queued < shm->txQueueSize) ? (shm->txQueueSize - queued) : 0ul;
+    length = 0ul;
+    idle = 0ul;
+    available = RIOSTACK_getInboundQueueAvailable(shm->stack);
+    if((!RIOSTACK_getLinkIsInitialized(shm->stack)) || (available > shm->rxAvailable))
+    {
+      idleLimit = IDLE_LIMIT;
+    }
+    else
+    {
+      idleLimit = 1ul;
+    }
+    while((room > 0ul) && (idle < idleLimit))
+    {
+      symbol = RIOSTACK_portGetSymbol(shm->stack);
+      if(symbol.type != RIOSTACK_SYMBOL_TYPE_IDLE)
+      {
+        s[length] = symbol;
+        length++;
+        room--;
+
+        if(length == PROCESS_BATCH)
+        {
+          count += RIOSHM_send(shm, length, s);
+          length = 0ul;
+        }
+        else
+        {
+          /* Don't do anything. */
+        }
+      }
+      else
+      {
+        idle++;
+      }
+    }
+    count += RIOSHM_send(shm, length, s);
+
+    /* Remember the buffers the other side has been told about. */
+    if(room > 0ul)
+    {
+      shm->rxAvailable = available;
+    }
+    else
+    {
+      /* The status might not have been sent. */
+    }
+  }
+  else
+  {
+    /* Nobody is listening yet. */
+  }
+
+  return count;
+}
+
+
+void RIOSHM_wait(RioShm_t *shm, const uint32_t timeout)
+{
+  RioShmRing_t *ring;
+  uint32_t events;
+
+
+  ASSERT(shm != NULL, "Invalid shm pointer");
+
+  ring = shm->rxRing;
+  events = __atomic_load_n(&ring->events, __ATOMIC_ACQUIRE);
+  if(__atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) == ring->tail)
+  {
+    /* Tell the other side to wake us up and check again that nothing has
+       happened before it could see it. */
+    __atomic_store_n(&ring->waiting, 1ul, __ATOMIC_SEQ_CST);
+    if(__atomic_load_n(&ring->events, __ATOMIC_SEQ_CST) == events)
+    {
+      sleepOnRing(ring, events, timeout);
+    }
+    else
+    {
+      /* Don't do anything. */
+    }
+    __atomic_store_n(&ring->waiting, 0ul, __ATOMIC_RELAXED);
+  }
+  else
+  {
+    /* There are symbols to read already. */
+  }
+}
+
+
+uint32_t RIOSHM_send(RioShm_t *shm, const uint32_t count, const RioSymbol_t *symbols)
+{
+  RioShmRing_t *ring;
+  uint32_t head;
+  uint32_t room;
+  uint32_t length;
+  uint32_t i;
+
+
+  ASSERT(shm != NULL, "Invalid shm pointer");
+
+  ring = shm->txRing;
+  head = ring->head;
+  room = RIOSHM_RING_SIZE - (head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE));
+  length = (count < room) ? count : room;
+
+  for(i = 0ul; i < length; i++)
+  {
+    ring->symbol[RING_INDEX(head + i)].type = (uint32_t) symbols[i].type;
+    ring->symbol[RING_INDEX(head + i)].data = symbols[i].data;
+  }
+
+  if(length > 0ul)
+  {
+    __atomic_store_n(&ring->head, head + length, __ATOMIC_RELEASE);
+    shm->statusSymbolsSent += length;
+
+    notify(shm);
+  }
+  else
+  {
+    /* Don't do anything. */
+  }
+
+  return length;
+}
+
+
+uint32_t RIOSHM_receive(RioShm_t *shm, const uint32_t count, RioSymbol_t *symbols)
+{
+  RioShmRing_t *ring;
+  uint32_t tail;
+  uint32_t available;
+  uint32_t length;
+  uint32_t i;
+
+
+  ASSERT(shm != NULL, "Invalid shm pointer");
+
+  ring = shm->rxRing;
+  tail = ring->tail;
+  available = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) - tail;
+  length = (count < available) ? count : available;
+
+  for(i = 0ul; i < length; i++)
+  {
+    symbols[i].type = (RioSymbolType_t) ring->symbol[RING_INDEX(tail + i)].type;
+    symbols[i].data = ring->symbol[RING_INDEX(tail + i)].data;
+  }
+
+  if(length > 0ul)
+  {
+    __atomic_store_n(&ring->tail, tail + length, __ATOMIC_RELEASE);
+    shm->statusSymbolsReceived += length;
+
+    /* The other side might wait for room in its transmit ring. */
+    notify(shm);
+  }
+  else
+  {
+    /* Don't do anything. */
+  }
+
+  return length;
+}
+
+
+/*******************************************************************************
+ * Local functions
+ *******************************************************************************/
+
+static uint8_t map(RioShm_t *shm, RioStack_t *stack, const int fd)
+{
+  uint8_t returnValue;
+  void *address;
+
+
+  ASSERT(shm != NULL, "Invalid shm pointer");
+  ASSERT(stack != NULL, "Invalid stack pointer");
+
+  address = mmap(NULL, sizeof(RioShmSegment_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if(address != MAP_FAILED)
+  {
+    shm->fd = fd;
+    shm->stack = stack;
+    shm->segment = (RioShmSegment_t *) address;
+    shm->txQueueSize = RIOSHM_TX_QUEUE_SIZE;
+    shm->rxAvailable = 0u;
+    shm->statusSymbolsSent = 0ul;
+    shm->statusSymbolsReceived = 0ul;
+    returnValue = 1u;
+  }
+  else
+  {
+    returnValue = 0u;
+  }
+
+  return returnValue;
+}
+
+
+static void sleepOnRing(RioShmRing_t *ring, const uint32_t events, const uint32_t timeout)
+{
+#ifdef __linux__
+  struct timespec duration;
+
+
+  duration.tv_sec = (time_t) (timeout / 1000ul);
+  duration.tv_nsec = (long) (timeout % 1000ul) * 1000000l;
+  (void) syscall(SYS_futex, &ring->events, FUTEX_WAIT, events, &duration, NULL, 0);
+#else
+  uint32_t i;
+
+
+  for(i = 0ul; (i < timeout) && (__atomic_load_n(&ring->events, __ATOMIC_ACQUIRE) == events); i++)
+  {
+    (void) poll(NULL, 0, 1);
+  }
+#endif
+}
+
+
+static void notify(RioShm_t *shm)
+{
+  RioShmRing_t *ring;
+
+
+  /* The other side sleeps on the ring it reads from. */
+  ring = shm->txRing;
+  (void) __atomic_add_fetch(&ring->events, 1ul, __ATOMIC_SEQ_CST);
+  if(__atomic_load_n(&ring->waiting, __ATOMIC_SEQ_CST))
+  {
+    __atomic_store_n(&ring->waiting, 0ul, __ATOMIC_RELAXED);
+#ifdef __linux__
+    (void) syscall(SYS_futex, &ring->events, FUTEX_WAKE, 1, NULL, NULL, 0);
+#endif
+  }
+  else
+  {
+    /* Don't do anything. */
+  }
+}
+
+/*************************** end of file **************************************/
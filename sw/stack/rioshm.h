@@ -0,0 +1,257 @@
+/******************************************************************************
+ * (C) Copyright 2013-2015 Magnus Rosenius and the Free Software Foundation.
+ *
+ * This file is part of OpenRIO.
+ *
+ * OpenRIO is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenRIO is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Lesser Public License
+ * along with OpenRIO.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+
+/******************************************************************************
+ * Description:
+ * This file contains a port driver that connects two stacks in different
+ * processes using shared memory.
+ *
+ * The shared memory segment contains one single-producer single-consumer ring
+ * of symbols for each direction. Each side of the link writes symbols it gets
+ * from its stack into one ring and adds the symbols it reads from the other
+ * ring to its stack. Idle symbols are not written into the rings since the
+ * stacks ignore them when received. Symbols are fetched from the stack until
+ * the transmit ring is filled to its configured size or the stack has nothing
+ * more to send. A process that has nothing to do can
+ * sleep in RIOSHM_wait() until the other side writes symbols to it or makes
+ * room for more symbols.
+ *
+ * Each call to RIOSHM_process() moves all available symbols in one batch per
+ * direction, so the read and write positions of the rings are only updated
+ * once per call.
+ *
+ * The segment is either created from a name with RIOSHM_open(), where the
+ * first process creates the segment and the second attaches to it, or from
+ * a file descriptor from shm_open() or memfd_create() that is shared by
+ * other means, for example inherited over fork(), using RIOSHM_create() and
+ * RIOSHM_attach().
+ *
+ * Typical usage:
+ *   RIOSHM_open(&shm, &stack, "/riolink");
+ *   RIOSTACK_portSetTimeout(&stack, 100);
+ *   while(1)
+ *   {
+ *     <use the stack>
+ *     if(RIOSHM_process(&shm, <time>) == 0)
+ *     {
+ *       RIOSHM_wait(&shm, 10);
+ *     }
+ *   }
+ *
+ * This file requires a POSIX system. The sleeping in RIOSHM_wait() uses
+ * futexes on Linux and polls on other systems.
+ ******************************************************************************/
+
+#ifndef __RIOSHM_H
+#define __RIOSHM_H
+
+/*******************************************************************************
+ * Include files.
+ *******************************************************************************/
+
+#include "rioconfig.h"
+#include "riostack.h"
+
+
+/*******************************************************************************
+ * Global macros.
+ *******************************************************************************/
+
+/** The number of symbols in each ring. Must be a power of two. */
+#define RIOSHM_RING_SIZE 4096u
+
+/** The default number of symbols to keep in the transmit ring. */
+#define RIOSHM_TX_QUEUE_SIZE 256u
+
+/** The size of a cache line, used to keep the ring positions apart. */
+#define RIOSHM_CACHE_LINE_SIZE 64u
+
+
+/*******************************************************************************
+ * Global typedefs.
+ *******************************************************************************/
+
+/** A symbol as it is stored in a ring. */
+typedef struct
+{
+  uint32_t type;
+  uint32_t data;
+} RioShmSymbol_t;
+
+/** A ring of symbols in the shared memory. */
+typedef struct
+{
+  /* Written by the producer only. */
+  uint32_t head;
+  uint8_t padding0[RIOSHM_CACHE_LINE_SIZE - sizeof(uint32_t)];
+
+  /* Written by the consumer only. */
+  uint32_t tail;
+  uint8_t padding1[RIOSHM_CACHE_LINE_SIZE - sizeof(uint32_t)];
+
+  /* Counted up by the producer when it has written to this ring or read from
+     the ring in the other direction. */
+  uint32_t events;
+
+  /* Set by the consumer when it sleeps, cleared by the producer. */
+  uint32_t waiting;
+  uint8_t padding2[RIOSHM_CACHE_LINE_SIZE - 2u*sizeof(uint32_t)];
+
+  RioShmSymbol_t symbol[RIOSHM_RING_SIZE];
+} RioShmRing_t;
+
+/** The layout of the shared memory segment. */
+typedef struct
+{
+  uint32_t magic;
+  uint32_t size;
+  uint32_t attached;
+  uint8_t padding[RIOSHM_CACHE_LINE_SIZE - 3u*sizeof(uint32_t)];
+
+  /* The ring written by the creator and the ring written by the attacher. */
+  RioShmRing_t ring[2];
+} RioShmSegment_t;
+
+/** The structure to keep all the driver variables. */
+typedef struct
+{
+  int fd;
+  RioStack_t *stack;
+  RioShmSegment_t *segment;
+  RioShmRing_t *txRing;
+  RioShmRing_t *rxRing;
+  uint32_t txQueueSize;
+  uint8_t rxAvailable;
+
+  /** The number of symbols that has been written to the transmit ring. */
+  uint32_t statusSymbolsSent;
+
+  /** The number of symbols that has been read from the receive ring. */
+  uint32_t statusSymbolsReceived;
+} RioShm_t;
+
+
+/*******************************************************************************
+ * Global function prototypes.
+ *******************************************************************************/
+
+/**
+ * \brief Create or attach to a named shared memory segment.
+ *
+ * \param[in] shm The driver to operate on.
+ * \param[in] stack The stack to connect to the link.
+ * \param[in] name The name of the segment, see shm_open().
+ * \return Non-zero if the segment was opened, zero otherwise and errno is set.
+ *
+ * The first process that opens a name creates the segment and the second
+ * attaches to it. If the second process opens the name before the first has
+ * initialized the segment, the call fails with errno set to EAGAIN and can be
+ * retried. The name can be removed with shm_unlink() when both sides are open.
+ */
+uint8_t RIOSHM_open(RioShm_t *shm, RioStack_t *stack, const char *name);
+
+/**
+ * \brief Create a new segment in a shared memory object.
+ *
+ * \param[in] shm The driver to operate on.
+ * \param[in] stack The stack to connect to the link.
+ * \param[in] fd The shared memory object. It is resized to hold the segment
+ * and is closed by RIOSHM_close().
+ * \return Non-zero if the segment was created, zero otherwise and errno is set.
+ *
+ * No symbols are transmitted until the other side has attached.
+ */
+uint8_t RIOSHM_create(RioShm_t *shm, RioStack_t *stack, const int fd);
+
+/**
+ * \brief Attach to a segment created by RIOSHM_create() in another driver.
+ *
+ * \param[in] shm The driver to operate on.
+ * \param[in] stack The stack to connect to the link.
+ * \param[in] fd The shared memory object. It is closed by RIOSHM_close().
+ * \return Non-zero if the segment was attached, zero otherwise and errno is
+ * set. Only one driver may attach to a segment.
+ */
+uint8_t RIOSHM_attach(RioShm_t *shm, RioStack_t *stack, const int fd);
+
+/**
+ * \brief Close a driver.
+ *
+ * \param[in] shm The driver to operate on.
+ *
+ * The port of the stack is set to uninitialized.
+ */
+void RIOSHM_close(RioShm_t *shm);
+
+/**
+ * \brief Set the number of symbols to keep in the transmit ring.
+ *
+ * \param[in] shm The driver to operate on.
+ * \param[in] size The number of symbols, at most RIOSHM_RING_SIZE. Larger
+ * values allows the other side to sleep longer but adds latency.
+ */
+void RIOSHM_setTxQueueSize(RioShm_t *shm, const uint32_t size);
+
+/**
+ * \brief Transfer symbols between the rings and the stack.
+ *
+ * \param[in] shm The driver to operate on.
+ * \param[in] time The current time, given to RIOSTACK_portSetTime().
+ * \return The number of symbols that was transferred in both directions.
+ */
+uint32_t RIOSHM_process(RioShm_t *shm, const uint32_t time);
+
+/**
+ * \brief Wait until the other side has written or read symbols.
+ *
+ * \param[in] shm The driver to operate on.
+ * \param[in] timeout The longest time to wait in milliseconds.
+ *
+ * Returns directly if there are symbols to read, otherwise when the other
+ * side writes symbols or reads symbols, making room in the transmit ring.
+ */
+void RIOSHM_wait(RioShm_t *shm, const uint32_t timeout);
+
+/**
+ * \brief Write symbols to the transmit ring.
+ *
+ * \param[in] shm The driver to operate on.
+ * \param[in] count The number of symbols to write.
+ * \param[in] symbols The symbols to write.
+ * \return The number of symbols that fitted in the ring.
+ *
+ * This function is used by RIOSHM_process() but can also be used to connect
+ * the ring to something else than a stack.
+ */
+uint32_t RIOSHM_send(RioShm_t *shm, const uint32_t count, const RioSymbol_t *symbols);
+
+/**
+ * \brief Read symbols from the receive ring.
+ *
+ * \param[in] shm The driver to operate on.
+ * \param[in] count The largest number of symbols to read.
+ * \param[out] symbols The read symbols.
+ * \return The number of symbols that was read.
+ */
+uint32_t RIOSHM_receive(RioShm_t *shm, const uint32_t count, RioSymbol_t *symbols);
+
+#endif
+
+/*************************** end of file **************************************/
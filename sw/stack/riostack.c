@@ -23,9 +23,8 @@
  * the 2.2 version, part 6, of the standard. 
  * A number of limitations exist:
  * - Only short control symbols (24-bit) are supported.
- * - No multicast symbols.
  * - No timestamp symbols.
- * - No VC.
+ * - Only VC0 and VC1 are supported as virtual channels.
  * - No priority.
  *
  * Any application specific tailoring needed to compile properly should be done 
@@ -57,8 +56,32 @@
     maintenance packet is sent when not allowed. */
 #define MAX_PACKET_ERROR_RETRIES 3u
 
-/* Macro to update 5-bit ackId counters. */
-#define MASK_5BITS(x) ((uint8_t) ((x) & 0x1fu))
+/* Macro to update ackId counters, 5-bit or 6-bit depending on the negotiated mode. */
+#define MASK_ACKID(stack, x) ((uint8_t) ((x) & (stack)->ackIdMask))
+
+/* The bit position of the ackId in the first word of a packet. */
+#define ACKID_SHIFT(stack) (((stack)->ackIdMask == 0x1fu) ? 27u : 26u)
+
+/* Macro to get the virtual channel from the first word of a packet. */
+#define PACKET_VC_GET(data) ((uint8_t) (((data) >> 25) & 0x00000001u))
+
+/* Macros to set and get the extended ackId byte of a control symbol. 
+   marker(5:0)|parameter0(5)|supported */
+#define EXTENDED_MARKER 0xa8000000ul
+#define EXTENDED_MARKER_MASK 0xfc000000ul
+#define EXTENDED_PARAMETER0(parameter0) ((((uint32_t) (parameter0)) & 0x20ul) << 20)
+#define EXTENDED_SUPPORTED 0x01000000ul
+#define EXTENDED_VALID(data) (((data) & EXTENDED_MARKER_MASK) == EXTENDED_MARKER)
+#define EXTENDED_PARAMETER0_GET(data) ((uint8_t) (((data) >> 20) & 0x20u))
+
+/* Marker in the size of an outbound queue element that holds a pool handle 
+   in its first word instead of the packet. The index of the pool in txPool is 
+   kept above the handle. */
+#define QUEUE_HANDLE 0x80000000ul
+#define QUEUE_SIZE_GET(size) ((size) & ~QUEUE_HANDLE)
+#define QUEUE_HANDLE_SET(pool, handle) ((((uint32_t) (pool)) << 16) | ((uint32_t) (handle)))
+#define QUEUE_HANDLE_POOL_GET(data) ((uint8_t) ((data) >> 16))
+#define QUEUE_HANDLE_GET(data) ((RioPoolHandle_t) ((data) & 0xfffful))
 
 /* Macros to get entries from a control symbol. */
 #define STYPE0_GET(data) ((uint8_t) (((data) >> 21) & 0x00000007u))
@@ -73,6 +96,17 @@
 /* Transmitter frame states. */
 #define TX_FRAME_START                  ((uint8_t)0u)
 #define TX_FRAME_BODY                   ((uint8_t)1u)
+#define TX_FRAME_STOMP                  ((uint8_t)2u)
+
+/* Snapshot cursor modes. */
+#define SNAPSHOT_MODE_SIZE              ((uint8_t)0u)
+#define SNAPSHOT_MODE_WRITE             ((uint8_t)1u)
+#define SNAPSHOT_MODE_CHECK             ((uint8_t)2u)
+#define SNAPSHOT_MODE_RESTORE           ((uint8_t)3u)
+
+/* Check if a snapshot is read into a stack. The stack is left unchanged when 
+   the size is calculated or a snapshot is written. */
+#define SNAPSHOT_READ(cursor) ((cursor)->mode >= SNAPSHOT_MODE_CHECK)
 
 /* Control symbol constants. */
 typedef enum
@@ -116,6 +150,18 @@ typedef enum
  * Local typedefs
  *******************************************************************************/
 
+/* The position in a snapshot that is being written or read. The same functions 
+   are used to calculate the size, to write, to check and to restore a snapshot 
+   to make sure that the fields are always in the same order. */
+typedef struct
+{
+  uint8_t mode;
+  uint8_t valid;
+  uint32_t index;
+  uint32_t size;
+  uint8_t *buffer;
+} SnapshotCursor_t;
+
 
 
 /*******************************************************************************
@@ -142,6 +188,7 @@ static void handleErrorSymbol(RioStack_t *stack);
 static void handleErrorPacketCrc(RioStack_t *stack);
 
 static void handleStatus(RioStack_t *stack, const uint8_t ackId, const uint8_t bufferStatus);
+static void handleVcStatus(RioStack_t *stack, const uint8_t vc, const uint8_t bufferStatus);
 static void handlePacketAccepted(RioStack_t *stack, const uint8_t ackId, const uint8_t bufferStatus);
 static void handlePacketRetry(RioStack_t *stack, const uint8_t ackId, const uint8_t bufferStatus);
 static void handlePacketNotAccepted(RioStack_t *stack, const uint8_t arbitrary, const uint8_t cause);
@@ -151,6 +198,8 @@ static void handleEndOfPacket(RioStack_t *stack);
 static void handleLinkRequest(RioStack_t *stack, LinkRequestCmd_t cmd);
 static void handleNewPacketStart(RioStack_t *stack);
 static void handleNewPacketEnd(RioStack_t *stack);
+static void handleEarlyWord(RioStack_t *stack, const uint32_t symbol);
+static void handleEarlyAbort(RioStack_t *stack);
 
 /**
  * \brief Create a control symbol.
@@ -168,6 +217,9 @@ static void handleNewPacketEnd(RioStack_t *stack);
 static RioSymbol_t createControlSymbol(const stype0_t stype0,
                                        const uint8_t parameter0, const uint8_t parameter1,
                                        const stype1_t stype1, const uint8_t cmd);
+static RioSymbol_t createControlSymbolExtended(const RioStack_t *stack, const stype0_t stype0,
+                                               const uint8_t parameter0, const uint8_t parameter1,
+                                               const stype1_t stype1, const uint8_t cmd);
 
 /**
  * \brief Function to calculate ITU-CRC5, polynomial=0x15.
@@ -186,6 +238,60 @@ static uint8_t crc5(const uint32_t data, const uint8_t crc);
  */
 static uint8_t getBufferStatus(const RioStack_t *stack);
 
+/**
+ * \brief Get status of the VC1 receiver queue to report to peer.
+ *
+ * \param[in] stack The stack to work on.
+ * \return Available size of queue, limited to 5 bits.
+ */
+static uint8_t getVcBufferStatus(const RioStack_t *stack);
+
+/**
+ * \brief Create a control symbol with a buffer status.
+ *
+ * \param[in] stack The stack to work on.
+ * \param[in] stype1 The stype1 value.
+ * \return A control symbol with a status-control-symbol or, if the VC1 buffer 
+ * status has changed since it was last sent, a VC_STATUS-control-symbol as stype0.
+ */
+static RioSymbol_t createStatusSymbol(RioStack_t *stack, const stype1_t stype1);
+
+/**
+ * \brief Check if there is a packet that can be started.
+ *
+ * \param[in] stack The stack to work on.
+ * \return Non-zero if the packet at the window of the outbound queue can be sent.
+ *
+ * When virtual channels are used, the next packet is first moved from the 
+ * virtual channel queues to the outbound queue if there is none to send.
+ */
+static uint8_t schedulePacket(RioStack_t *stack);
+
+/**
+ * \brief Get the queue that the current inbound packet is received to.
+ *
+ * \param[in] stack The stack to work on.
+ * \return The inbound queue of the virtual channel of the packet.
+ */
+static RioQueue_t *getInboundQueue(RioStack_t *stack);
+
+/**
+ * \brief Release the pooled packet of an outbound queue element.
+ *
+ * \param[in] stack The stack to work on.
+ * \param[in] element The element that is about to be removed from its queue.
+ *
+ * Elements that contain a copy of the packet are left as they are.
+ */
+static void releaseOutboundElement(RioStack_t *stack, const uint32_t *element);
+
+/**
+ * \brief Remove the oldest packet from the outbound queue.
+ *
+ * \param[in] stack The stack to work on.
+ */
+static void dequeueOutbound(RioStack_t *stack);
+
 /**
  * \brief Create a queue with a specified size and a buffer attached to it.
  *
@@ -285,6 +391,18 @@ static void queueBackSetContent(RioQueue_t q, const uint32_t index, const uint32
  */
 static uint32_t *queueGetBackBuffer(RioQueue_t q );
 
+/**
+ * \brief Get a packet view of the newest element.
+ *
+ * \param[in] q The queue to operate on.
+ * \return A pointer to the element as a packet.
+ *
+ * The elements have the same layout as a RioPacket_t but the size is kept in a 
+ * full word. The size of the view must be set before it is used and the size 
+ * of the element must be set after the view has been used.
+ */
+static RioPacket_t *queueGetBackPacket(RioQueue_t q );
+
 /**
  * \brief Get the size of the oldest element.
  * \param[in] q The queue to operate on.
@@ -293,12 +411,12 @@ static uint32_t *queueGetBackBuffer(RioQueue_t q );
 static uint32_t queueFrontGetSize(RioQueue_t q );
 
 /**
- * \brief Get the content of the oldest element at specified index.
+ * \brief Get a pointer to the element to transmit next, including its size.
+ *
  * \param[in] q The queue to operate on.
- * \param[in] index The index into the element to get the content from.
- * \return content of element at index position.
+ * \return A pointer to the element, the size is in the first word.
  */
-static uint32_t queueGetFrontContent(RioQueue_t q, const uint32_t index);
+static uint32_t *queueGetFrontElement(const RioQueue_t q);
 
 /**
  * \brief Get a pointer to the buffer of the oldest element.
@@ -308,6 +426,96 @@ static uint32_t queueGetFrontContent(RioQueue_t q, const uint32_t index);
  */
 static uint32_t *queueGetFrontBuffer(RioQueue_t q );
 
+/**
+ * \brief Get a pointer to the oldest element in a queue, also if it is in the window.
+ *
+ * \param[in] q The queue to operate on.
+ * \return A pointer to the element, the size is in the first word.
+ */
+static uint32_t *queueGetOldestElement(const RioQueue_t q);
+
+/**
+ * \brief Get a pointer to the packet of an outbound queue element.
+ *
+ * \param[in] element The element, the size is in the first word.
+ * \param[in] pools The pools of the elements that hold a handle.
+ * \return A pointer to the first word of the packet.
+ */
+static uint32_t *elementGetContent(uint32_t *element, RioPool_t *const pools[]);
+
+/**
+ * \brief Get a pointer to the last added element, including its size.
+ *
+ * \param[in] q The queue to operate on.
+ * \return A pointer to the element, the size is in the first word.
+ */
+static uint32_t *queueGetNewestElement(const RioQueue_t q);
+
+/**
+ * \brief Check if the element to transmit next is the last added element.
+ *
+ * \param[in] q The queue to operate on.
+ * \return Non-zero if the window is at the last added element.
+ */
+static uint8_t queueWindowNewest(const RioQueue_t q);
+
+/**
+ * \brief Remove the last added element.
+ *
+ * \param[in] q The queue to operate on.
+ * \return The updated queue.
+ *
+ * The element must not be in the window.
+ */
+static RioQueue_t queueRemoveNewest(RioQueue_t q);
+
+/**
+ * \brief Get the number of packets of a virtual channel in a queue.
+ *
+ * \param[in] q The queue to operate on.
+ * \param[in] pools The pools of the elements that hold a handle.
+ * \param[in] vc The virtual channel to count.
+ * \return The number of elements where the vc bit of the header is vc.
+ */
+static uint8_t queueCountVc(const RioQueue_t q, RioPool_t *const pools[], const uint8_t vc);
+
+/* Snapshot functions. */
+
+/**
+ * \brief Transfer all the state of a stack to or from a snapshot.
+ *
+ * \param[in] cursor The snapshot position and mode.
+ * \param[in] stack The stack to transfer. Only changed when reading a snapshot.
+ */
+static void snapshotStack(SnapshotCursor_t *cursor, RioStack_t *stack);
+
+/**
+ * \brief Transfer a queue and its packets to or from a snapshot.
+ *
+ * \param[in] cursor The snapshot position and mode.
+ * \param[in] q The queue to transfer. Only changed when reading a snapshot.
+ * \param[in] partial The number of words of a partially received packet at 
+ * the back of the queue. Only used when writing a snapshot.
+ */
+static void snapshotQueue(SnapshotCursor_t *cursor, RioQueue_t *q, const uint32_t partial);
+
+/**
+ * \brief Transfer a 32-bit word to or from a snapshot.
+ *
+ * \param[in] cursor The snapshot position and mode.
+ * \param[in] value The value to write or to read into.
+ */
+static void snapshotWord(SnapshotCursor_t *cursor, uint32_t *value);
+
+/**
+ * \brief Transfer an 8-bit value to or from a snapshot.
+ *
+ * \param[in] cursor The snapshot position and mode.
+ * \param[in] value The value to write or to read into. Only changed when reading 
+ * a snapshot.
+ */
+static void snapshotByte(SnapshotCursor_t *cursor, uint8_t *value);
+
 /*******************************************************************************
  * Global functions
  *******************************************************************************/
@@ -316,10 +524,27 @@ void RIOSTACK_open(RioStack_t *stack, void *private,
                    const uint32_t rxPacketBufferSize, uint32_t *rxPacketBuffer, 
                    const uint32_t txPacketBufferSize, uint32_t *txPacketBuffer)
 {
+  uint8_t i;
+
+
+  /* The inbound queue elements are given to the packet handlers as packets. */
+  ASSERT(sizeof(RioPacket_t) == (RIOSTACK_BUFFER_SIZE*sizeof(uint32_t)), "Unsupported packet layout");
+
   /* Port time and timeout limit. */
   stack->portTime = 0u;
   stack->portTimeout = 0u;
 
+  /* Use 5-bit ackIds until extended ackIds are enabled and negotiated. */
+  stack->ackIdExtendedEnable = 0u;
+  stack->ackIdExtendedPartner = 0u;
+  stack->ackIdMask = 0x1fu;
+
+  /* Use the default link training. */
+  stack->trainingInterval = RIOSTACK_TRAINING_INTERVAL;
+  stack->trainingIntervalReceived = RIOSTACK_TRAINING_INTERVAL_RECEIVED;
+  stack->trainingStatusTx = RIOSTACK_TRAINING_STATUS_TX;
+  stack->trainingStatusRx = RIOSTACK_TRAINING_STATUS_RX;
+
   /* Setup the receiver. */
   stack->rxState = RX_STATE_UNINITIALIZED;
   stack->rxCounter = 0u;
@@ -329,6 +554,22 @@ void RIOSTACK_open(RioStack_t *stack, void *private,
   stack->rxAckIdAcked = 0u;
   stack->rxErrorCause = PACKET_NOT_ACCEPTED_CAUSE_RESERVED;
   stack->rxQueue = queueCreate((uint8_t) (rxPacketBufferSize/RIOSTACK_BUFFER_SIZE), rxPacketBuffer);
+  for(i = 0u; i < 16u; i++)
+  {
+    stack->rxHandler[i] = NULL;
+    stack->rxHandlerContext[i] = NULL;
+  }
+  stack->rxXoffLevel = 0u;
+  stack->rxXonLevel = 0u;
+  stack->rxCongested = 0u;
+  stack->rxCongestionHandler = NULL;
+  stack->rxCongestionContext = NULL;
+  stack->rxEarlyHandler = NULL;
+  stack->rxEarlyContext = NULL;
+  stack->rxEarlyHeaderSize = 1u;
+  stack->rxEarlyStarted = 0u;
+  stack->rxMulticastEventHandler = NULL;
+  stack->rxMulticastEventContext = NULL;
 
   /* Setup the transmitter. */
   stack->txState = TX_STATE_UNINITIALIZED;
@@ -339,6 +580,27 @@ void RIOSTACK_open(RioStack_t *stack, void *private,
   stack->txAckIdWindow = 0u;
   stack->txPacketErrorCounter = 0u;
   stack->txQueue = queueCreate((uint8_t) (txPacketBufferSize/RIOSTACK_BUFFER_SIZE), txPacketBuffer);
+  for(i = 0u; i < RIOSTACK_POOLS; i++)
+  {
+    stack->txPool[i] = NULL;
+  }
+  stack->txPoolPackets = 0u;
+  stack->txCutThrough = 0u;
+  stack->txMulticastEvent = 0u;
+
+  /* Virtual channels are not used until they are given queues. */
+  stack->vcEnable = 0u;
+  stack->rxVcQueue = queueCreate(0u, NULL);
+  stack->rxVc = 0u;
+  stack->rxVcBufferStatusSent = 0u;
+  for(i = 0u; i < RIOSTACK_VC_COUNT; i++)
+  {
+    stack->txVcQueue[i] = queueCreate(0u, NULL);
+    stack->txVcWeight[i] = 1u;
+    stack->txVcCredit[i] = 1u;
+  }
+  stack->txVc = 0u;
+  stack->txVcBufferStatus = 0u;
 
   /* Setup status counters for inbound direction. */
   stack->statusInboundPacketComplete = 0ul;
@@ -372,6 +634,137 @@ void RIOSTACK_open(RioStack_t *stack, void *private,
 
 
 
+uint32_t RIOSTACK_getSnapshotSize(const RioStack_t *stack)
+{
+  SnapshotCursor_t cursor;
+  uint32_t word;
+
+
+  cursor.mode = SNAPSHOT_MODE_SIZE;
+  cursor.valid = 1u;
+  cursor.index = 0ul;
+  cursor.size = 0ul;
+  cursor.buffer = NULL;
+
+  /* The header is magic, version and size. */
+  word = 0ul;
+  snapshotWord(&cursor, &word);
+  snapshotWord(&cursor, &word);
+  snapshotWord(&cursor, &word);
+  snapshotStack(&cursor, (RioStack_t *) stack); /*lint !e929 The stack is not changed in this mode. */
+
+  return cursor.index;
+}
+
+
+
+uint32_t RIOSTACK_snapshot(const RioStack_t *stack, const uint32_t size, uint8_t *buffer)
+{
+  SnapshotCursor_t cursor;
+  uint32_t word;
+  uint32_t length;
+
+
+  length = RIOSTACK_getSnapshotSize(stack);
+  if((length <= size) && (stack->txCutThrough == 0u) && (stack->txPoolPackets == 0u))
+  {
+    cursor.mode = SNAPSHOT_MODE_WRITE;
+    cursor.valid = 1u;
+    cursor.index = 0ul;
+    cursor.size = size;
+    cursor.buffer = buffer;
+
+    word = RIOSTACK_SNAPSHOT_MAGIC;
+    snapshotWord(&cursor, &word);
+    word = RIOSTACK_SNAPSHOT_VERSION;
+    snapshotWord(&cursor, &word);
+    snapshotWord(&cursor, &length);
+    snapshotStack(&cursor, (RioStack_t *) stack); /*lint !e929 The stack is not changed in this mode. */
+  }
+  else
+  {
+    /* The buffer is too small or a packet is being written. */
+    length = 0ul;
+  }
+
+  return length;
+}
+
+
+
+uint8_t RIOSTACK_restore(RioStack_t *stack, const uint32_t size, const uint8_t *buffer)
+{
+  SnapshotCursor_t cursor;
+  RioStack_t restored;
+  uint32_t magic;
+  uint32_t version;
+  uint32_t length;
+  uint8_t mode;
+  uint8_t i;
+
+
+  /* Check the whole snapshot before anything is changed, then restore it. */
+  for(mode = SNAPSHOT_MODE_CHECK; mode <= SNAPSHOT_MODE_RESTORE; mode++)
+  {
+    cursor.mode = mode;
+    cursor.valid = 1u;
+    cursor.index = 0ul;
+    cursor.size = size;
+    cursor.buffer = (uint8_t *) buffer; /*lint !e929 The buffer is only read in this mode. */
+
+    snapshotWord(&cursor, &magic);
+    snapshotWord(&cursor, &version);
+    snapshotWord(&cursor, &length);
+    if(cursor.valid && (magic == RIOSTACK_SNAPSHOT_MAGIC) &&
+       (version == RIOSTACK_SNAPSHOT_VERSION) && (length <= size) &&
+       (stack->txPoolPackets == 0u))
+    {
+      cursor.size = length;
+      restored = *stack;
+      snapshotStack(&cursor, &restored);
+      if(cursor.valid && (cursor.index == length))
+      {
+        if(mode == SNAPSHOT_MODE_RESTORE)
+        {
+          /* A snapshot never contains a packet that is being written and the 
+             early handler has not seen the partially received packet. */
+          restored.txCutThrough = 0u;
+          restored.rxEarlyStarted = 0u;
+
+          /* A snapshot never contains packets from a pool. */
+          for(i = 0u; i < RIOSTACK_POOLS; i++)
+          {
+            restored.txPool[i] = NULL;
+          }
+          restored.txPoolPackets = 0u;
+          *stack = restored;
+        }
+        else
+        {
+          /* Don't do anything. */
+        }
+      }
+      else
+      {
+        /* The content is not valid. */
+        cursor.valid = 0u;
+        break;
+      }
+    }
+    else
+    {
+      /* The header is not valid or the outbound queue holds pool handles 
+         that would be lost. */
+      cursor.valid = 0u;
+      break;
+    }
+  }
+
+  return cursor.valid;
+}
+
+
+
 /*******************************************************************************************
  * Stack status and queue access functions.
  * Note that status counters are accessed directly in the stack-structure.
@@ -399,36 +792,69 @@ uint8_t RIOSTACK_getStatus(const RioStack_t *stack)
 
 uint8_t RIOSTACK_getOutboundQueueLength(const RioStack_t *stack)
 {
-  return queueLength(stack->txQueue);
+  /* The virtual channel queues are empty when they are not used. */
+  return (uint8_t) (queueLength(stack->txQueue) + 
+                    queueLength(stack->txVcQueue[0]) + queueLength(stack->txVcQueue[1]));
 }
 
 
 
 uint8_t RIOSTACK_getOutboundQueueAvailable(const RioStack_t *stack)
 {
-  return queueAvailable(stack->txQueue);
+  return RIOSTACK_getOutboundQueueAvailableVc(stack, 0u);
+}
+
+
+
+uint8_t RIOSTACK_getOutboundQueueAvailableVc(const RioStack_t *stack, const uint8_t vc)
+{
+  uint8_t available;
+
+
+  if(vc >= RIOSTACK_VC_COUNT)
+  {
+    available = 0u;
+    ASSERT0("Invalid virtual channel.");
+  }
+  else if(stack->vcEnable != 0u)
+  {
+    available = queueAvailable(stack->txVcQueue[vc]);
+  }
+  else
+  {
+    available = (vc == 0u) ? queueAvailable(stack->txQueue) : 0u;
+  }
+
+  return available;
 }
 
 
 
 void RIOSTACK_setOutboundPacket(RioStack_t *stack, RioPacket_t *packet)
 {
+  RioQueue_t *queue;
   uint32_t *src, *dst;
   uint32_t size;
   uint32_t i;
 
-  if(queueAvailable(stack->txQueue) > 0u)
+  /* Select the queue of the virtual channel of the packet. */
+  queue = (stack->vcEnable != 0u) ? &stack->txVcQueue[PACKET_VC_GET(packet->payload[0])] : &stack->txQueue;
+  if(stack->txCutThrough != 0u)
+  {
+    ASSERT0("An outbound packet is being written.");
+  }
+  else if(queueAvailable(*queue) > 0u)
   {
     src = &packet->payload[0];
-    dst = queueGetBackBuffer(stack->txQueue);
+    dst = queueGetBackBuffer(*queue);
     size = packet->size;
     for(i = 0u; i < size; i++)
     {
       dst[i] = src[i]; /*lint !e960 This is not pointer arithmetics. */
     }
 
-    queueBackSetSize(stack->txQueue, size);
-    stack->txQueue = queueEnqueue(stack->txQueue);
+    queueBackSetSize(*queue, size);
+    *queue = queueEnqueue(*queue);
   }
   else
   {
@@ -438,96 +864,501 @@ void RIOSTACK_setOutboundPacket(RioStack_t *stack, RioPacket_t *packet)
 
 
 
-uint8_t RIOSTACK_getInboundQueueLength(const RioStack_t *stack)
-{
-  return queueLength(stack->rxQueue);
-}
-
-
-
-uint8_t RIOSTACK_getInboundQueueAvailable(const RioStack_t *stack)
-{
-  return queueAvailable(stack->rxQueue);
-}
-
-
-
-void RIOSTACK_getInboundPacket(RioStack_t *stack, RioPacket_t *packet)
+uint8_t RIOSTACK_getOutboundPacket(RioStack_t *stack, RioPacket_t *packet)
 {
-  uint32_t *src, *dst;
+  RioQueue_t *queue;
+  uint32_t *element, *src, *dst;
   uint8_t size;
   uint8_t i;
+  uint8_t transmitted;
 
 
-  if(!queueEmpty(stack->rxQueue)) /*lint !e961 This is a boolean expression. */
+  /* The packets that are waiting in the virtual channel queues are returned 
+     after the ones in the outbound queue. */
+  if(!queueEmpty(stack->txQueue)) /*lint !e961 This is a boolean expression. */
   {
-    src = queueGetFrontBuffer(stack->rxQueue);
-    dst = &packet->payload[0];
-    size = (uint8_t) queueFrontGetSize(stack->rxQueue);
-    for(i = 0u; i < size; i++)
-    {
-      dst[i] = src[i]; /*lint !e960 This is not pointer arithmetics. */
-    }
-
-    packet->size = size;
-    stack->rxQueue = queueDequeue(stack->rxQueue);
+    queue = &stack->txQueue;
+  }
+  else if(!queueEmpty(stack->txVcQueue[0])) /*lint !e961 This is a boolean expression. */
+  {
+    queue = &stack->txVcQueue[0];
   }
   else
   {
-    ASSERT0("Reading from empty reception queue.");
+    queue = &stack->txVcQueue[1];
   }
-}
-
 
+  transmitted = 0u;
+  if(stack->txState == TX_STATE_UNINITIALIZED)
+  {
+    if(!queueEmpty(*queue)) /*lint !e961 This is a boolean expression. */
+    {
+      /* The packets in the window has been transmitted but not acknowledged. */
+      transmitted = (uint8_t) (queue->windowSize != 0u);
+
+      element = queueGetOldestElement(*queue);
+      src = elementGetContent(element, stack->txPool);
+      dst = &packet->payload[0];
+      size = (uint8_t) QUEUE_SIZE_GET(element[0]);
+      for(i = 0u; i < size; i++)
+      {
+        dst[i] = src[i]; /*lint !e960 This is not pointer arithmetics. */
+      }
 
-/*******************************************************************************************
- * Packet port functions.
- *******************************************************************************************/
+      packet->size = size;
+      releaseOutboundElement(stack, element);
+      *queue = queueDequeue(*queue);
+    }
+    else
+    {
+      ASSERT0("Reading from empty transmission queue.");
+    }
+  }
+  else
+  {
+    ASSERT0("Reading from transmission queue of an active port.");
+  }
 
-void RIOSTACK_portSetTime(RioStack_t *stack, const uint32_t timer)
-{
-  stack->portTime = timer;
+  return transmitted;
 }
 
 
 
-void RIOSTACK_portSetTimeout(RioStack_t *stack, const uint32_t timer)
+void RIOSTACK_setOutboundPacketHandle(RioStack_t *stack, RioPool_t *pool, const RioPoolHandle_t handle)
 {
-  stack->portTimeout = timer;
-}
+  RioQueue_t *queue;
+  RioPacket_t *packet;
+  uint8_t index;
 
 
+  /* Select the queue of the virtual channel of the packet. */
+  packet = RIOPOOL_getPacket(pool, handle);
+  queue = (stack->vcEnable != 0u) ? &stack->txVcQueue[PACKET_VC_GET(packet->payload[0])] : &stack->txQueue;
 
-void RIOSTACK_portSetStatus(RioStack_t *stack, const uint8_t initialized)
-{
-  /* REMARK: Clean the queues here as well??? */
-  if (initialized)
+  /* Find the pool among the ones that has been used or take a free entry. */
+  for(index = 0u; (index < RIOSTACK_POOLS) && (stack->txPool[index] != pool) && (stack->txPool[index] != NULL); index++)
   {
-    stack->rxState = RX_STATE_PORT_INITIALIZED;
-    stack->rxCounter = 0u;
-    stack->rxCrc = 0xffffu;
-    stack->rxStatusReceived = 0u;
-    stack->rxAckId = 0u;
-    stack->rxAckIdAcked = 0u;
-    stack->rxErrorCause = PACKET_NOT_ACCEPTED_CAUSE_RESERVED;
+    /* Don't do anything. */
+  }
 
-    stack->txState = TX_STATE_PORT_INITIALIZED;
-    stack->txCounter = 0u;
-    stack->txStatusCounter = 0u;
-    stack->txFrameState = TX_FRAME_START;
-    stack->txAckId = 0u;
-    stack->txAckIdWindow = 0u;
+  if(stack->txCutThrough != 0u)
+  {
+    ASSERT0("An outbound packet is being written.");
+  }
+  else if(index == RIOSTACK_POOLS)
+  {
+    ASSERT0("Outbound packets from too many pools.");
+  }
+  else if(queueAvailable(*queue) > 0u)
+  {
+    /* Keep the reference in the queue instead of the packet, it is released 
+       when the packet has been acknowledged. */
+    queueGetBackBuffer(*queue)[0] = QUEUE_HANDLE_SET(index, handle); /*lint !e960 This is not pointer arithmetics. */
+    queueBackSetSize(*queue, QUEUE_HANDLE | packet->size);
+    *queue = queueEnqueue(*queue);
+    stack->txPool[index] = pool;
+    stack->txPoolPackets++;
   }
   else
   {
-    stack->rxState = RX_STATE_UNINITIALIZED;
-    stack->txState = TX_STATE_UNINITIALIZED;
+    ASSERT0("Transmission queue packet overflow.");
   }
 }
 
 
 
-void RIOSTACK_portAddSymbol(RioStack_t *stack, const RioSymbol_t symbol)
+void RIOSTACK_startOutboundPacket(RioStack_t *stack)
+{
+  if(stack->txCutThrough != 0u)
+  {
+    ASSERT0("An outbound packet is already being written.");
+  }
+  else if(queueAvailable(stack->txQueue) > 0u)
+  {
+    /* The size of the element is the number of words the transmitter can send. */
+    queueBackSetSize(stack->txQueue, 0u);
+    stack->txQueue = queueEnqueue(stack->txQueue);
+    stack->txCutThrough = 1u;
+  }
+  else
+  {
+    ASSERT0("Transmission queue packet overflow.");
+  }
+}
+
+
+
+void RIOSTACK_appendOutboundPacket(RioStack_t *stack, const uint32_t count, const uint32_t *words)
+{
+  uint32_t *element;
+  uint32_t size;
+  uint32_t i;
+
+
+  element = queueGetNewestElement(stack->txQueue);
+  size = element[0];
+  if(stack->txCutThrough == 0u)
+  {
+    ASSERT0("No outbound packet is being written.");
+  }
+  else if((size + count) <= RIOPACKET_SIZE_MAX)
+  {
+    for(i = 0u; i < count; i++)
+    {
+      element[size+i+1u] = words[i]; /*lint !e960 This is not pointer arithmetics. */
+    }
+
+    /* Let the transmitter send the new words. */
+    element[0] = size + count;
+  }
+  else
+  {
+    ASSERT0("Outbound packet too large.");
+  }
+}
+
+
+
+void RIOSTACK_endOutboundPacket(RioStack_t *stack)
+{
+  if(stack->txCutThrough == 0u)
+  {
+    ASSERT0("No outbound packet is being written.");
+  }
+  else if(queueGetNewestElement(stack->txQueue)[0] >= RIOPACKET_SIZE_MIN)
+  {
+    /* The transmitter ends the packet when all words have been sent. */
+    stack->txCutThrough = 0u;
+  }
+  else
+  {
+    ASSERT0("Outbound packet too small.");
+  }
+}
+
+
+
+void RIOSTACK_abortOutboundPacket(RioStack_t *stack)
+{
+  if(stack->txCutThrough != 0u)
+  {
+    /* Check if the transmitter has started to send the packet. */
+    if((stack->txFrameState == TX_FRAME_BODY) && queueWindowNewest(stack->txQueue))
+    {
+      /* Make the link partner discard what it has received. */
+      stack->txFrameState = TX_FRAME_STOMP;
+    }
+    else
+    {
+      /* The packet has not been sent, just remove it. */
+    }
+
+    stack->txQueue = queueRemoveNewest(stack->txQueue);
+    stack->txCutThrough = 0u;
+  }
+  else
+  {
+    ASSERT0("No outbound packet is being written.");
+  }
+}
+
+
+
+uint8_t RIOSTACK_getInboundQueueLength(const RioStack_t *stack)
+{
+  return queueLength(stack->rxQueue);
+}
+
+
+
+uint8_t RIOSTACK_getInboundQueueAvailable(const RioStack_t *stack)
+{
+  return queueAvailable(stack->rxQueue);
+}
+
+
+
+uint8_t RIOSTACK_getInboundQueueLengthVc(const RioStack_t *stack, const uint8_t vc)
+{
+  return queueLength((vc == 0u) ? stack->rxQueue : stack->rxVcQueue);
+}
+
+
+
+void RIOSTACK_getInboundPacket(RioStack_t *stack, RioPacket_t *packet)
+{
+  RIOSTACK_getInboundPacketVc(stack, 0u, packet);
+}
+
+
+
+void RIOSTACK_getInboundPacketVc(RioStack_t *stack, const uint8_t vc, RioPacket_t *packet)
+{
+  RioQueue_t *queue;
+  uint32_t *src, *dst;
+  uint8_t size;
+  uint8_t i;
+
+
+  queue = (vc == 0u) ? &stack->rxQueue : &stack->rxVcQueue;
+  if(!queueEmpty(*queue)) /*lint !e961 This is a boolean expression. */
+  {
+    src = queueGetFrontBuffer(*queue);
+    dst = &packet->payload[0];
+    size = (uint8_t) queueFrontGetSize(*queue);
+    for(i = 0u; i < size; i++)
+    {
+      dst[i] = src[i]; /*lint !e960 This is not pointer arithmetics. */
+    }
+
+    packet->size = size;
+    *queue = queueDequeue(*queue);
+
+    /* Check if the inbound queue has drained enough to end a congestion. */
+    if((vc == 0u) && (stack->rxCongested != 0u) && (queueLength(stack->rxQueue) <= stack->rxXonLevel))
+    {
+      stack->rxCongested = 0u;
+      stack->rxCongestionHandler(stack->rxCongestionContext, stack, 0u, NULL);
+    }
+    else
+    {
+      /* Don't do anything. */
+    }
+  }
+  else
+  {
+    ASSERT0("Reading from empty reception queue.");
+  }
+}
+
+
+
+RioPoolHandle_t RIOSTACK_getInboundPacketHandle(RioStack_t *stack, RioPool_t *pool)
+{
+  RioPoolHandle_t handle;
+
+
+  /* Check if there is a packet to read. */
+  if(!queueEmpty(stack->rxQueue)) /*lint !e961 This is a boolean expression. */
+  {
+    /* There is a packet to read. */
+
+    /* Allocate a packet to read into. */
+    handle = RIOPOOL_allocate(pool);
+    if(handle != RIOPOOL_HANDLE_INVALID)
+    {
+      /* A packet was allocated. */
+      RIOSTACK_getInboundPacket(stack, RIOPOOL_getPacket(pool, handle));
+    }
+    else
+    {
+      /* The pool is empty. */
+      /* Leave the packet in the inbound queue. */
+    }
+  }
+  else
+  {
+    /* No packet to read. */
+    handle = RIOPOOL_HANDLE_INVALID;
+    ASSERT0("Reading from empty reception queue.");
+  }
+
+  return handle;
+}
+
+
+
+void RIOSTACK_setInboundHandler(RioStack_t *stack, const uint8_t ftype, 
+                                RioStackInboundHandler_t handler, void *context)
+{
+  ASSERT(ftype < 16u, "Invalid ftype");
+
+  stack->rxHandler[ftype & 0xfu] = handler;
+  stack->rxHandlerContext[ftype & 0xfu] = context;
+}
+
+
+
+void RIOSTACK_setCongestionHandler(RioStack_t *stack, const uint8_t xoffLevel, const uint8_t xonLevel,
+                                   RioStackCongestionHandler_t handler, void *context)
+{
+  ASSERT(xonLevel < xoffLevel, "Invalid congestion levels");
+
+  stack->rxXoffLevel = xoffLevel;
+  stack->rxXonLevel = xonLevel;
+  stack->rxCongested = 0u;
+  stack->rxCongestionHandler = handler;
+  stack->rxCongestionContext = context;
+}
+
+
+
+void RIOSTACK_setEarlyHandler(RioStack_t *stack, const uint8_t headerSize, 
+                              RioStackEarlyHandler_t handler, void *context)
+{
+  ASSERT((headerSize >= 1u) && (headerSize <= 3u), "Invalid header size");
+
+  stack->rxEarlyHeaderSize = headerSize;
+  stack->rxEarlyHandler = handler;
+  stack->rxEarlyContext = context;
+}
+
+
+
+void RIOSTACK_setVirtualChannels(RioStack_t *stack,
+                                 const uint32_t txPacketBufferSize0, uint32_t *txPacketBuffer0,
+                                 const uint32_t txPacketBufferSize1, uint32_t *txPacketBuffer1,
+                                 const uint32_t rxPacketBufferSize1, uint32_t *rxPacketBuffer1)
+{
+  if(stack->txState == TX_STATE_UNINITIALIZED)
+  {
+    stack->vcEnable = 1u;
+    stack->txVcQueue[0] = queueCreate((uint8_t) (txPacketBufferSize0/RIOSTACK_BUFFER_SIZE), txPacketBuffer0);
+    stack->txVcQueue[1] = queueCreate((uint8_t) (txPacketBufferSize1/RIOSTACK_BUFFER_SIZE), txPacketBuffer1);
+    stack->rxVcQueue = queueCreate((uint8_t) (rxPacketBufferSize1/RIOSTACK_BUFFER_SIZE), rxPacketBuffer1);
+  }
+  else
+  {
+    ASSERT0("Virtual channels set on an active port.");
+  }
+}
+
+
+
+void RIOSTACK_setVirtualChannelWeight(RioStack_t *stack, const uint8_t vc, const uint8_t weight)
+{
+  if((vc < RIOSTACK_VC_COUNT) && (weight > 0u))
+  {
+    stack->txVcWeight[vc] = weight;
+    stack->txVcCredit[vc] = weight;
+  }
+  else
+  {
+    ASSERT0("Invalid virtual channel weight.");
+  }
+}
+
+
+
+void RIOSTACK_sendMulticastEvent(RioStack_t *stack)
+{
+  stack->txMulticastEvent = 1u;
+}
+
+
+
+void RIOSTACK_setMulticastEventHandler(RioStack_t *stack, 
+                                       RioStackMulticastEventHandler_t handler, void *context)
+{
+  stack->rxMulticastEventHandler = handler;
+  stack->rxMulticastEventContext = context;
+}
+
+
+
+/*******************************************************************************************
+ * Packet port functions.
+ *******************************************************************************************/
+
+void RIOSTACK_portSetTime(RioStack_t *stack, const uint32_t timer)
+{
+  stack->portTime = timer;
+}
+
+
+
+void RIOSTACK_setExtendedAckId(RioStack_t *stack, const uint8_t enable)
+{
+  stack->ackIdExtendedEnable = (uint8_t) (enable != 0u);
+}
+
+
+
+uint8_t RIOSTACK_getExtendedAckId(const RioStack_t *stack)
+{
+  return (uint8_t) (stack->ackIdMask != 0x1fu);
+}
+
+
+
+void RIOSTACK_setLinkTraining(RioStack_t *stack, const uint8_t interval, const uint8_t intervalReceived, 
+                              const uint8_t statusTx, const uint8_t statusRx)
+{
+  stack->trainingInterval = interval;
+  stack->trainingIntervalReceived = intervalReceived;
+  stack->trainingStatusTx = (statusTx > RIOSTACK_TRAINING_STATUS_TX) ? statusTx : RIOSTACK_TRAINING_STATUS_TX;
+  stack->trainingStatusRx = (statusRx > RIOSTACK_TRAINING_STATUS_RX) ? statusRx : RIOSTACK_TRAINING_STATUS_RX;
+}
+
+
+
+void RIOSTACK_setLinkTrainingFast(RioStack_t *stack)
+{
+  RIOSTACK_setLinkTraining(stack, 0u, 0u, RIOSTACK_TRAINING_STATUS_TX, RIOSTACK_TRAINING_STATUS_RX);
+}
+
+
+
+void RIOSTACK_portSetTimeout(RioStack_t *stack, const uint32_t timer)
+{
+  stack->portTimeout = timer;
+}
+
+
+
+void RIOSTACK_portSetStatus(RioStack_t *stack, const uint8_t initialized)
+{
+  /* REMARK: Clean the queues here as well??? */
+  if (initialized)
+  {
+    stack->rxState = RX_STATE_PORT_INITIALIZED;
+    stack->rxCounter = 0u;
+    stack->rxCrc = 0xffffu;
+    stack->rxStatusReceived = 0u;
+    stack->rxAckId = 0u;
+    stack->rxAckIdAcked = 0u;
+    stack->rxErrorCause = PACKET_NOT_ACCEPTED_CAUSE_RESERVED;
+
+    stack->txState = TX_STATE_PORT_INITIALIZED;
+    stack->txCounter = 0u;
+    stack->txStatusCounter = 0u;
+    stack->txFrameState = TX_FRAME_START;
+    stack->txAckId = 0u;
+    stack->txAckIdWindow = 0u;
+
+    /* Packets that were not acknowledged before the port went down are sent again. */
+    stack->txQueue = queueWindowReset(stack->txQueue);
+
+    /* The VC1 buffer status is exchanged again after the link initialization. 
+       Use a status that cannot be sent to force it to be sent. */
+    stack->rxVc = 0u;
+    stack->rxVcBufferStatusSent = 0xffu;
+    stack->txVcBufferStatus = 0u;
+
+    /* The ackId size is negotiated again during the link initialization. */
+    stack->ackIdExtendedPartner = 0u;
+    stack->ackIdMask = 0x1fu;
+  }
+  else
+  {
+    stack->rxState = RX_STATE_UNINITIALIZED;
+    stack->txState = TX_STATE_UNINITIALIZED;
+  }
+
+  /* A packet that was being received is lost. */
+  handleEarlyAbort(stack);
+}
+
+
+
+uint8_t RIOSTACK_portGetStatus(const RioStack_t *stack)
+{
+  return (uint8_t) (stack->txState != TX_STATE_UNINITIALIZED);
+}
+
+
+
+void RIOSTACK_portAddSymbol(RioStack_t *stack, const RioSymbol_t symbol)
 {
   stype0_t stype0;
   uint8_t parameter0;
@@ -559,6 +1390,20 @@ void RIOSTACK_portAddSymbol(RioStack_t *stack, const RioSymbol_t symbol)
         /* Get the content of the control symbol. */
         stype0 = (stype0_t) STYPE0_GET(symbol.data);
         parameter0 = PARAMETER0_GET(symbol.data);
+
+        /* Check if the control symbol contains extended ackId information. */
+        if(EXTENDED_VALID(symbol.data))
+        {
+          /* Add the most significant ackId bit and note if the link-partner 
+             supports extended ackIds. */
+          parameter0 |= EXTENDED_PARAMETER0_GET(symbol.data);
+          stack->ackIdExtendedPartner = (uint8_t) ((symbol.data & EXTENDED_SUPPORTED) != 0u);
+        }
+        else
+        {
+          /* The link-partner uses 5-bit ackIds. */
+          stack->ackIdExtendedPartner = 0u;
+        }
         parameter1 = PARAMETER1_GET(symbol.data);
         stype1 = (stype1_t) STYPE1_GET(symbol.data);            
         cmd = CMD_GET(symbol.data);
@@ -591,6 +1436,9 @@ void RIOSTACK_portAddSymbol(RioStack_t *stack, const RioSymbol_t symbol)
     /* The receiver is uninitialied. */
     /* Discard all incoming symbols. */
   }
+
+  /* Check if the symbol made the receiver discard a packet that has been reported. */
+  handleEarlyAbort(stack);
 }
 
 
@@ -615,19 +1463,19 @@ RioSymbol_t RIOSTACK_portGetSymbol(RioStack_t *stack )
        ******************************************************************************/
       
       /* Check if an idle symbol or a status control symbol should be sent. */
-      if(((stack->rxStatusReceived == 0u) && (stack->txCounter == 255u)) ||
-         ((stack->rxStatusReceived == 1u) && (stack->txCounter >= 15u)))
+      if(((stack->rxStatusReceived == 0u) && (stack->txCounter >= stack->trainingInterval)) ||
+         ((stack->rxStatusReceived == 1u) && (stack->txCounter >= stack->trainingIntervalReceived)))
       {
         /* A control symbol should be sent. */
 
         /* Create a new status symbol and reset the transmission counter. */
         stack->txCounter = 0u;
         bufferStatus = getBufferStatus(stack);
-        s = createControlSymbol(STYPE0_STATUS, stack->rxAckId, bufferStatus, STYPE1_NOP, 0u);
+        s = createControlSymbolExtended(stack, STYPE0_STATUS, stack->rxAckId, bufferStatus, STYPE1_NOP, 0u);
 
         /* Check if the receiver has received any error-free status and that we 
-           have sent at least 15 status control symbols. */
-        if((stack->rxStatusReceived == 1u) && (stack->txStatusCounter < 15u))
+           have sent enough status control symbols. */
+        if((stack->rxStatusReceived == 1u) && (stack->txStatusCounter < stack->trainingStatusTx))
         {
           /* Has not sent enough status control symbols. */
           stack->txStatusCounter++;
@@ -646,7 +1494,7 @@ RioSymbol_t RIOSTACK_portGetSymbol(RioStack_t *stack )
       }
 
       /* Check if we are ready to set the transmitter in a link initialized state. */
-      if ((stack->rxState == RX_STATE_LINK_INITIALIZED) && (stack->txStatusCounter == 15u))
+      if ((stack->rxState == RX_STATE_LINK_INITIALIZED) && (stack->txStatusCounter >= stack->trainingStatusTx))
       {
         /* Ready to go to link initialized. */
         stack->txState = TX_STATE_LINK_INITIALIZED;
@@ -668,8 +1516,18 @@ RioSymbol_t RIOSTACK_portGetSymbol(RioStack_t *stack )
        * the receiver has received complete packets.
        ******************************************************************************/
 
-      /* Check if the receiver wants to acknowledge a packet. */
-      if(stack->rxAckId == stack->rxAckIdAcked)
+      /* Check if a multicast-event should be sent or if the receiver wants to 
+         acknowledge a packet. */
+      if(stack->txMulticastEvent != 0u)
+      {
+        /* A multicast-event should be sent. */
+        /* Send it at once, also if a packet is being sent. The packet continues 
+           with the next symbol. */
+        s = createStatusSymbol(stack, STYPE1_MULTICAST_EVENT);
+        stack->txMulticastEvent = 0u;
+        stack->txStatusCounter = 0u;
+      }
+      else if(stack->rxAckId == stack->rxAckIdAcked)
       {
         /* The receiver does not want to acknowledge a packet. */
 
@@ -685,19 +1543,21 @@ RioSymbol_t RIOSTACK_portGetSymbol(RioStack_t *stack )
             /* A packet transmission is ongoing. */
 
             /* Check if the packet has been completly sent. */
-            if(stack->txCounter != queueFrontGetSize(stack->txQueue))
+            /* A packet that is still being written has only been sent up to the words 
+               that has been added so far. */
+            if(stack->txCounter != QUEUE_SIZE_GET(queueFrontGetSize(stack->txQueue)))
             {
               /* The packet has not been completly sent. */
 
               /* Create a new data symbol to transmit. */
               s.type = RIOSTACK_SYMBOL_TYPE_DATA;
-              s.data = queueGetFrontContent(stack->txQueue, (uint32_t)stack->txCounter);
+              s.data = elementGetContent(queueGetFrontElement(stack->txQueue), stack->txPool)[stack->txCounter]; /*lint !e960 This is not pointer arithmetics. */
               
               /* Check if this is the first symbol in a packet. */
               if (stack->txCounter == 0u)
               {
                 /* Place the correct ackId in the right place. */
-                s.data |= (uint32_t)stack->txAckIdWindow << 27;
+                s.data |= (uint32_t)stack->txAckIdWindow << ACKID_SHIFT(stack);
               }
               else
               {
@@ -710,27 +1570,42 @@ RioSymbol_t RIOSTACK_portGetSymbol(RioStack_t *stack )
               /* A status control symbol was not sent. Update the status counter. */
               stack->txStatusCounter++;
             }
+            else if((stack->txCutThrough != 0u) && queueWindowNewest(stack->txQueue))
+            {
+              /* The packet is still being written, wait for more words. */
+
+              /* Check if a status control symbol must be transmitted. */
+              if(stack->txStatusCounter < 255u)
+              {
+                /* Send an idle-symbol. */
+                s.type = RIOSTACK_SYMBOL_TYPE_IDLE;
+                stack->txStatusCounter++;
+              }
+              else
+              {
+                /* Create a status control symbol. */
+                s = createStatusSymbol(stack, STYPE1_NOP);
+                stack->txStatusCounter = 0u;
+              }
+            }
             else 
             {
               /* The packet has been sent. */
 
               /* Save the timeout time and update to the next ackId. */
               stack->txFrameTimeout[stack->txAckIdWindow] = stack->portTime;
-              stack->txAckIdWindow = MASK_5BITS(stack->txAckIdWindow + 1u);
+              stack->txAckIdWindow = MASK_ACKID(stack, stack->txAckIdWindow + 1u);
               stack->txQueue = queueWindowNext(stack->txQueue);
 
               /* Check if there are more packets pending to be sent. */
               /* Also check that there are buffer available at the receiver and that not too many 
                  packets are outstanding. */
-              if((!queueWindowEmpty(stack->txQueue)) &&  /*lint !e961 Boolean expression. */
-                 (stack->txBufferStatus > 0u) &&
-                 (MASK_5BITS(stack->txAckIdWindow - stack->txAckId) != 31u))
+              if(schedulePacket(stack))
               {
                 /* More pending packets. */
 
                 /* Create a control symbol to signal that the new packet has started. */
-                bufferStatus = getBufferStatus(stack);
-                s = createControlSymbol(STYPE0_STATUS, stack->rxAckId, bufferStatus, STYPE1_START_OF_PACKET, 0u);
+                s = createStatusSymbol(stack, STYPE1_START_OF_PACKET);
 
                 /* Restart transmission counter. */
                 stack->txCounter = 0u;
@@ -740,8 +1615,7 @@ RioSymbol_t RIOSTACK_portGetSymbol(RioStack_t *stack )
                 /* No more pending packets. */
 
                 /* Create a control symbol to signal that the packet has ended. */
-                bufferStatus = getBufferStatus(stack);
-                s = createControlSymbol(STYPE0_STATUS, stack->rxAckId, bufferStatus, STYPE1_END_OF_PACKET, 0u);
+                s = createStatusSymbol(stack, STYPE1_END_OF_PACKET);
 
                 /* Go back to wait for a new frame. */
                 stack->txFrameState = TX_FRAME_START;
@@ -751,6 +1625,18 @@ RioSymbol_t RIOSTACK_portGetSymbol(RioStack_t *stack )
               stack->txStatusCounter = 0u;
             }
           }
+          else if(stack->txFrameState == TX_FRAME_STOMP)
+          {
+            /* A packet that was being sent has been aborted. */
+
+            /* Send a stomp control symbol to make the link partner discard it. The ackId 
+               is used again for the next packet. */
+            s = createStatusSymbol(stack, STYPE1_STOMP);
+            stack->txFrameState = TX_FRAME_START;
+
+            /* A status control symbol has been sent. Reset the status counter. */
+            stack->txStatusCounter = 0u;
+          }
           else
           {
             /* No packet is being sent. */
@@ -758,15 +1644,12 @@ RioSymbol_t RIOSTACK_portGetSymbol(RioStack_t *stack )
             /* Check if there are any pending packets to start sending. */
             /* Also check that there are buffer available at the receiver and that not too many 
                packets are outstanding. */
-            if((!queueWindowEmpty(stack->txQueue)) && /*lint !e961 Boolean expression. */
-               (stack->txBufferStatus > 0u) &&
-               (MASK_5BITS(stack->txAckIdWindow - stack->txAckId) != 31u))
+            if(schedulePacket(stack))
             {
               /* There is a pending packet to send. */
 
               /* Send a start-of-packet control symbol to start to send the packet. */
-              bufferStatus = getBufferStatus(stack);
-              s = createControlSymbol(STYPE0_STATUS, stack->rxAckId, bufferStatus, STYPE1_START_OF_PACKET, 0u);
+              s = createStatusSymbol(stack, STYPE1_START_OF_PACKET);
               stack->txFrameState = TX_FRAME_BODY;
               stack->txCounter = 0u;
 
@@ -778,7 +1661,9 @@ RioSymbol_t RIOSTACK_portGetSymbol(RioStack_t *stack )
               /* There are no pending packets to send. */
 
               /* Check if a status control symbol must be transmitted. */
-              if(stack->txStatusCounter < 255u)
+              /* A changed VC1 buffer status is sent at once. */
+              if((stack->txStatusCounter < 255u) && 
+                 ((stack->vcEnable == 0u) || (getVcBufferStatus(stack) == stack->rxVcBufferStatusSent)))
               {
                 /* Not required to send a status control symbol. */
 
@@ -791,8 +1676,7 @@ RioSymbol_t RIOSTACK_portGetSymbol(RioStack_t *stack )
                 /* Must send a status control symbol. */
 
                 /* Create a status control symbol. */
-                bufferStatus = getBufferStatus(stack);
-                s = createControlSymbol(STYPE0_STATUS, stack->rxAckId, bufferStatus, STYPE1_NOP, 0u);
+                s = createStatusSymbol(stack, STYPE1_NOP);
 
                 /* A status control symbol has been sent. Reset the status counter. */
                 stack->txStatusCounter = 0u;
@@ -807,7 +1691,7 @@ RioSymbol_t RIOSTACK_portGetSymbol(RioStack_t *stack )
 
           /* Send link-request-symbol (input-status). */
           bufferStatus = getBufferStatus(stack);
-          s = createControlSymbol(STYPE0_STATUS, stack->rxAckId, bufferStatus, STYPE1_LINK_REQUEST, (uint8_t) LINK_REQUEST_INPUT_STATUS);
+          s = createControlSymbolExtended(stack, STYPE0_STATUS, stack->rxAckId, bufferStatus, STYPE1_LINK_REQUEST, (uint8_t) LINK_REQUEST_INPUT_STATUS);
 
           /* Save the time when this was transmitted. */
           stack->txFrameTimeout[stack->txAckId] = stack->portTime;
@@ -824,8 +1708,8 @@ RioSymbol_t RIOSTACK_portGetSymbol(RioStack_t *stack )
       {
         /* The receiver wants us to send an acknowledgment. */
         bufferStatus = getBufferStatus(stack);
-        s = createControlSymbol(STYPE0_PACKET_ACCEPTED, stack->rxAckIdAcked, bufferStatus, STYPE1_NOP, 0u);
-        stack->rxAckIdAcked = MASK_5BITS(stack->rxAckIdAcked + 1u);
+        s = createControlSymbolExtended(stack, STYPE0_PACKET_ACCEPTED, stack->rxAckIdAcked, bufferStatus, STYPE1_NOP, 0u);
+        stack->rxAckIdAcked = MASK_ACKID(stack, stack->rxAckIdAcked + 1u);
 
         /* A status control symbol was not sent. Update the status counter. */
         stack->txStatusCounter++;
@@ -847,7 +1731,7 @@ RioSymbol_t RIOSTACK_portGetSymbol(RioStack_t *stack )
 
         /* Send a packet-retry symbol to tell the link partner to retry the last frame. */
         bufferStatus = getBufferStatus(stack);
-        s = createControlSymbol(STYPE0_PACKET_RETRY, stack->rxAckId, bufferStatus, STYPE1_NOP, 0u);
+        s = createControlSymbolExtended(stack, STYPE0_PACKET_RETRY, stack->rxAckId, bufferStatus, STYPE1_NOP, 0u);
 
         /* Proceed with normal transmission. */
         stack->txState = TX_STATE_LINK_INITIALIZED;
@@ -859,8 +1743,8 @@ RioSymbol_t RIOSTACK_portGetSymbol(RioStack_t *stack )
       {
         /* The receiver wants us to send an acknowledgment. */
         bufferStatus = getBufferStatus(stack);
-        s = createControlSymbol(STYPE0_PACKET_ACCEPTED, stack->rxAckIdAcked, bufferStatus, STYPE1_NOP, 0u);
-        stack->rxAckIdAcked = MASK_5BITS(stack->rxAckIdAcked + 1u);
+        s = createControlSymbolExtended(stack, STYPE0_PACKET_ACCEPTED, stack->rxAckIdAcked, bufferStatus, STYPE1_NOP, 0u);
+        stack->rxAckIdAcked = MASK_ACKID(stack, stack->rxAckIdAcked + 1u);
 
         /* A status control symbol was not sent. Update the status counter. */
         stack->txStatusCounter++;
@@ -875,7 +1759,7 @@ RioSymbol_t RIOSTACK_portGetSymbol(RioStack_t *stack )
        ******************************************************************************/
 
       /* Send a packet-not-accepted symbol to indicate an error on the link. */
-      s = createControlSymbol(STYPE0_PACKET_NOT_ACCEPTED, 0u, (uint8_t) stack->rxErrorCause, 
+      s = createControlSymbolExtended(stack, STYPE0_PACKET_NOT_ACCEPTED, 0u, (uint8_t) stack->rxErrorCause, 
                               STYPE1_NOP, 0u);
 
       /* Proceed with normal transmission. */
@@ -893,7 +1777,7 @@ RioSymbol_t RIOSTACK_portGetSymbol(RioStack_t *stack )
        * Note that the link-request that caused this response also makes the receiver enter the normal operational state.
        ******************************************************************************/
 
-      s = createControlSymbol(STYPE0_LINK_RESPONSE, stack->rxAckId, LINK_RESPONSE_PORT_STATUS_OK, STYPE1_NOP, 0u);
+      s = createControlSymbolExtended(stack, STYPE0_LINK_RESPONSE, stack->rxAckId, LINK_RESPONSE_PORT_STATUS_OK, STYPE1_NOP, 0u);
 
       /* Proceed with normal transmission. */
       stack->txState = TX_STATE_LINK_INITIALIZED;
@@ -914,7 +1798,7 @@ RioSymbol_t RIOSTACK_portGetSymbol(RioStack_t *stack )
 
       /* Send a restart-from-retry symbol to acknowledge. */
       bufferStatus = getBufferStatus(stack);
-      s = createControlSymbol(STYPE0_STATUS, stack->rxAckId, bufferStatus, STYPE1_RESTART_FROM_RETRY, 0u);
+      s = createControlSymbolExtended(stack, STYPE0_STATUS, stack->rxAckId, bufferStatus, STYPE1_RESTART_FROM_RETRY, 0u);
 
       /* Restart the current frame and proceed with normal operation. */
       stack->txFrameState = TX_FRAME_START;
@@ -946,7 +1830,7 @@ RioSymbol_t RIOSTACK_portGetSymbol(RioStack_t *stack )
 
         /* Send link-request-symbol (input-status). */
         bufferStatus = getBufferStatus(stack);
-        s = createControlSymbol(STYPE0_STATUS, stack->rxAckId, bufferStatus,
+        s = createControlSymbolExtended(stack, STYPE0_STATUS, stack->rxAckId, bufferStatus,
                                 STYPE1_LINK_REQUEST, (uint8_t) LINK_REQUEST_INPUT_STATUS);
 
         /* Save the time when this was transmitted. */
@@ -980,7 +1864,7 @@ RioSymbol_t RIOSTACK_portGetSymbol(RioStack_t *stack )
 
             /* Send link-request-symbol (input-status). */
             bufferStatus = getBufferStatus(stack);
-            s = createControlSymbol(STYPE0_STATUS, stack->rxAckId, bufferStatus,
+            s = createControlSymbolExtended(stack, STYPE0_STATUS, stack->rxAckId, bufferStatus,
                                     STYPE1_LINK_REQUEST, (uint8_t) LINK_REQUEST_INPUT_STATUS);
             
             /* Save the time when this was transmitted. */
@@ -1060,6 +1944,10 @@ static void handleStype0(RioStack_t *stack, stype0_t stype0, uint8_t parameter0,
         break;
 
       case STYPE0_VC_STATUS:
+        /* The link partner has sent the buffer status of a virtual channel. */
+        handleVcStatus(stack, parameter0, parameter1);
+        break;
+
       case STYPE0_RESERVED:
       case STYPE0_IMPLEMENTATION_DEFINED:
       default:
@@ -1082,13 +1970,25 @@ static void handleStype0(RioStack_t *stack, stype0_t stype0, uint8_t parameter0,
       stack->rxStatusReceived = 1u;
             
       /* Check if enough status control symbols has been received. */
-      if(stack->rxCounter == 7u)
+      if(stack->rxCounter >= stack->trainingStatusRx)
       {
         /* Enough correct status control symbols has been received without 
            errors in between. */
 
+        /* Select the ackId size. Both link-partners has now received status 
+           control symbols from each other indicating if extended ackIds are 
+           supported and will make the same choice. */
+        if((stack->ackIdExtendedEnable != 0u) && (stack->ackIdExtendedPartner != 0u))
+        {
+          stack->ackIdMask = 0x3fu;
+        }
+        else
+        {
+          stack->ackIdMask = 0x1fu;
+        }
+
         /* Setup the transmitter with the content of the symbol. */
-        stack->txAckId = parameter0;
+        stack->txAckId = MASK_ACKID(stack, parameter0);
         stack->txAckIdWindow = stack->txAckId;
         stack->txBufferStatus = parameter1;
 
@@ -1172,6 +2072,18 @@ static void handleStype1(RioStack_t *stack, stype1_t stype1, uint8_t cmd)
       break;
 
     case STYPE1_MULTICAST_EVENT:
+      /* A multicast-event has been received. */
+      /* Report the time it was received. */
+      if(stack->rxMulticastEventHandler != NULL)
+      {
+        stack->rxMulticastEventHandler(stack->rxMulticastEventContext, stack, stack->portTime);
+      }
+      else
+      {
+        /* Discard it. */
+      }
+      break;
+
     case STYPE1_RESERVED:
     default:
       /* Unsupported symbol received. */
@@ -1194,7 +2106,7 @@ static void handleDataSymbol(RioStack_t *stack, uint32_t symbol)
       /* A packet has been started. */
 
       /* Check if the ackId is correct on the first part of the packet. */
-      if((stack->rxCounter > 1u) || (((uint8_t)(symbol >> 27)) == stack->rxAckId))
+      if((stack->rxCounter > 1u) || (((uint8_t)(symbol >> ACKID_SHIFT(stack))) == stack->rxAckId))
       {
         /* The ackId is the expected one. */
 
@@ -1205,6 +2117,9 @@ static void handleDataSymbol(RioStack_t *stack, uint32_t symbol)
           /* Start to calculate the CRC of the packet. */
           /* Note that the ackId should not be included in the CRC calculation. */
           stack->rxCrc = RIOPACKET_crc32(symbol & (uint32_t)0x03fffffful, 0xffffu);
+
+          /* Receive the packet to the queue of its virtual channel. */
+          stack->rxVc = (stack->vcEnable != 0u) ? PACKET_VC_GET(symbol) : 0u;
         }
         else
         {
@@ -1213,9 +2128,32 @@ static void handleDataSymbol(RioStack_t *stack, uint32_t symbol)
           stack->rxCrc = RIOPACKET_crc32(symbol, stack->rxCrc);
         }
 
-        /* Save the new data in the packet queue and update the reception counter. */
-        queueBackSetContent(stack->rxQueue, (uint32_t)stack->rxCounter - (uint32_t)1ul, symbol);
-        stack->rxCounter++;
+        /* Check if there is a buffer to receive the packet to. Without virtual 
+           channels, this has already been checked when the packet started. */
+        if(queueAvailable(*getInboundQueue(stack)) > 0u)
+        {
+          /* Save the new data in the packet queue and update the reception counter. */
+          queueBackSetContent(*getInboundQueue(stack), (uint32_t)stack->rxCounter - (uint32_t)1ul, symbol);
+          stack->rxCounter++;
+
+          /* Check if the packet should be reported before it is complete. */
+          if(stack->rxEarlyHandler != NULL)
+          {
+            handleEarlyWord(stack, symbol);
+          }
+          else
+          {
+            /* Don't do anything. */
+          }
+        }
+        else
+        {
+          /* There are no buffers available for the virtual channel. */
+          /* Go to input retry stopped state. */
+          stack->statusInboundPacketRetry++;
+          stack->txState = TX_STATE_SEND_PACKET_RETRY;
+          stack->rxState = RX_STATE_INPUT_RETRY_STOPPED;
+        }
       }
       else
       {
@@ -1287,6 +2225,22 @@ static void handleStatus(RioStack_t *stack, const uint8_t ackId, const uint8_t b
 
 
 
+static void handleVcStatus(RioStack_t *stack, const uint8_t vc, const uint8_t bufferStatus)
+{
+  /* Update the VC1 buffer status of the link partner. */
+  /* Only VC1 has its own buffers. */
+  if(vc == 1u)
+  {
+    stack->txVcBufferStatus = bufferStatus;
+  }
+  else
+  {
+    /* Don't do anything. */
+  }
+}
+
+
+
 static void handlePacketAccepted(RioStack_t *stack, const uint8_t ackId, const uint8_t bufferStatus)
 {
   uint32_t linkLatency;
@@ -1306,8 +2260,8 @@ static void handlePacketAccepted(RioStack_t *stack, const uint8_t ackId, const u
 
     /* Remove the packet from the outbound queue and restart the transmission for
        a new packet. */
-    stack->txQueue = queueDequeue(stack->txQueue);
-    stack->txAckId = MASK_5BITS(stack->txAckId + 1u);
+    dequeueOutbound(stack);
+    stack->txAckId = MASK_ACKID(stack, stack->txAckId + 1u);
     stack->txPacketErrorCounter = 0u;
     stack->statusOutboundPacketComplete++;
   }
@@ -1396,8 +2350,8 @@ static void handleLinkResponse(RioStack_t *stack, const uint8_t ackId, const uin
 
     /* Calculate the number of packets that has not received an acknowledge on our side and 
        on the link-partner side. */
-    window = MASK_5BITS(stack->txAckIdWindow - stack->txAckId);
-    windowReceived = MASK_5BITS(ackId - stack->txAckId);
+    window = MASK_ACKID(stack, stack->txAckIdWindow - stack->txAckId);
+    windowReceived = MASK_ACKID(stack, ackId - stack->txAckId);
 
     /* Check if the link-partners response is acceptable. */
     if(windowReceived <= window)
@@ -1407,8 +2361,8 @@ static void handleLinkResponse(RioStack_t *stack, const uint8_t ackId, const uin
       /* Remove entries in the queue that the link-partner has sent acknowledges for that has been lost. */
       while(stack->txAckId != ackId)
       {
-        stack->txQueue = queueDequeue(stack->txQueue);
-        stack->txAckId = MASK_5BITS(stack->txAckId + 1u);
+        dequeueOutbound(stack);
+        stack->txAckId = MASK_ACKID(stack, stack->txAckId + 1u);
         stack->txPacketErrorCounter = 0u;
         stack->statusOutboundPacketComplete++;
       }
@@ -1424,7 +2378,7 @@ static void handleLinkResponse(RioStack_t *stack, const uint8_t ackId, const uin
       {
         /* Rejected too many times. */
         /* Remove the packet but dont update the ackId. */
-        stack->txQueue = queueDequeue(stack->txQueue);
+        dequeueOutbound(stack);
         stack->txPacketErrorCounter = 0u;
       }
       
@@ -1463,7 +2417,7 @@ static void handleStartOfPacket(RioStack_t *stack)
     /* This indicates an implicit end-of-packet symbol and signals the previous packet as ready. */
 
     /* Check if the packet is long enough to contain a complete packet. */
-    if(stack->rxCounter > 3u)
+    if(stack->rxCounter > RIOPACKET_SIZE_MIN)
     {
       /* Packet long enough to process. */
     
@@ -1508,7 +2462,7 @@ static void handleStartOfPacket(RioStack_t *stack)
 static void handleEndOfPacket(RioStack_t *stack)
 {
   /* Check if the packet is long enough to contain a complete packet. */
-  if(stack->rxCounter > 3u)
+  if(stack->rxCounter > RIOPACKET_SIZE_MIN)
   {
     /* Packet long enough to process. */
     
@@ -1532,159 +2486,745 @@ static void handleEndOfPacket(RioStack_t *stack)
   }
   else
   {
-    /* The packet is too short. */
-    /* Packet error. Enter input-error-stopped state. */
-    stack->txState = TX_STATE_SEND_PACKET_NOT_ACCEPTED;
-    stack->rxState = RX_STATE_INPUT_ERROR_STOPPED;
-    stack->rxErrorCause = PACKET_NOT_ACCEPTED_CAUSE_GENERAL;
-    stack->statusInboundErrorGeneral++;
+    /* The packet is too short. */
+    /* Packet error. Enter input-error-stopped state. */
+    stack->txState = TX_STATE_SEND_PACKET_NOT_ACCEPTED;
+    stack->rxState = RX_STATE_INPUT_ERROR_STOPPED;
+    stack->rxErrorCause = PACKET_NOT_ACCEPTED_CAUSE_GENERAL;
+    stack->statusInboundErrorGeneral++;
+  }
+}
+
+
+
+static void handleNewPacketStart(RioStack_t *stack)
+{
+  /* Check if there are buffers available to store the new frame. */
+  /* With virtual channels, the queue is not known until the first word has 
+     been received. */
+  if ((stack->vcEnable != 0u) || (queueAvailable(stack->rxQueue) > 0u))
+  {
+    /* There are buffers available to accept the new packet. */
+
+    /* Update the reception counter to indicate the frame has started. */
+    stack->rxCounter = 1u;
+  }
+  else
+  {
+    /* There are no buffers available. */
+    /* Go to input retry stopped state. */
+    stack->statusInboundPacketRetry++;
+    stack->txState = TX_STATE_SEND_PACKET_RETRY;
+    stack->rxState = RX_STATE_INPUT_RETRY_STOPPED;
+  }
+}
+
+
+
+static void handleNewPacketEnd(RioStack_t *stack)
+{
+  RioPacket_t *packet;
+  RioQueue_t *queue;
+  uint8_t ftype;
+  uint8_t consumed;
+
+
+  /* Let the handlers read the packet where it was received. */
+  queue = getInboundQueue(stack);
+  packet = queueGetBackPacket(*queue);
+  packet->size = stack->rxCounter - 1u;
+
+  /* Check if the packet has been reported to the early handler. */
+  if(stack->rxEarlyStarted != 0u)
+  {
+    /* Tell the early handler that the packet is correct. */
+    stack->rxEarlyStarted = 0u;
+    consumed = (stack->rxEarlyHandler != NULL) ? 
+      stack->rxEarlyHandler(stack->rxEarlyContext, stack, RIOSTACK_EARLY_END, 0u, NULL) : 0u;
+  }
+  else
+  {
+    /* The packet has not been reported. */
+    consumed = 0u;
+  }
+
+  /* Check if there is a handler registered for this type of packet. */
+  ftype = (uint8_t) ((packet->payload[0] >> 16) & 0xfu);
+  if(consumed)
+  {
+    /* The early handler has taken care of the packet. */
+  }
+  else if(stack->rxHandler[ftype] != NULL)
+  {
+    /* There is a handler for the packet. */
+    /* Let the handler process the packet before it is placed in the queue. */
+    consumed = stack->rxHandler[ftype](stack->rxHandlerContext[ftype], stack, packet);
+  }
+  else
+  {
+    /* No handler. */
+    consumed = 0u;
+  }
+
+  /* Forward the packet to the top of the stack if it was not consumed. */
+  if(!consumed)
+  {
+    /* Check if the source of the packet should be told that the queue is congested 
+       when the packet has been placed in it. */
+    /* Only the VC0 queue is watched. */
+    if((stack->rxVc == 0u) && (stack->rxCongestionHandler != NULL) && 
+       ((queueLength(stack->rxQueue) + 1u) >= stack->rxXoffLevel))
+    {
+      /* The queue is congested. */
+      stack->rxCongested = 1u;
+      stack->rxCongestionHandler(stack->rxCongestionContext, stack, 1u, packet);
+    }
+    else
+    {
+      /* Don't do anything. */
+    }
+
+    /* Save the size of the packet and place it in the queue. */
+    queueBackSetSize(*queue, (uint32_t)stack->rxCounter - (uint32_t)1ul);
+    *queue = queueEnqueue(*queue);
+  }
+  else
+  {
+    /* The buffer is reused for the next packet. */
+  }
+
+  /* Make sure the CRC is reset to an invalid value to avoid a packet 
+     accidentally being accepted. */
+  stack->rxCrc = 0xffffu;
+
+  /* Reset the reception counter. */
+  stack->rxCounter = 0u;
+
+  /* Update the ackId for the receiver. */
+  stack->rxAckId = MASK_ACKID(stack, stack->rxAckId + 1u);
+
+  /* Update status counter. */
+  stack->statusInboundPacketComplete++;
+}
+
+
+
+static void handleEarlyWord(RioStack_t *stack, const uint32_t symbol)
+{
+  uint32_t header[3];
+  uint32_t *buffer;
+  uint8_t size;
+  uint8_t i;
+
+
+  size = stack->rxCounter - 1u;
+  if(size == stack->rxEarlyHeaderSize)
+  {
+    /* The header has been received. */
+    /* Remove the ackId since it is not part of the packet. */
+    buffer = queueGetBackBuffer(*getInboundQueue(stack));
+    for(i = 0u; i < size; i++)
+    {
+      header[i] = buffer[i]; /*lint !e960 This is not pointer arithmetics. */
+    }
+    header[0] &= (uint32_t) 0x03fffffful;
+
+    stack->rxEarlyStarted = 1u;
+    (void) stack->rxEarlyHandler(stack->rxEarlyContext, stack, RIOSTACK_EARLY_HEADER, size, header);
+  }
+  else if((size > stack->rxEarlyHeaderSize) && (stack->rxEarlyStarted != 0u))
+  {
+    /* A word after the header has been received. */
+    (void) stack->rxEarlyHandler(stack->rxEarlyContext, stack, RIOSTACK_EARLY_WORD, 1u, &symbol);
+  }
+  else
+  {
+    /* The header is not complete or was not reported. */
+  }
+}
+
+
+
+static void handleEarlyAbort(RioStack_t *stack)
+{
+  /* A reported packet is lost if the reception was cancelled or the receiver 
+     left the normal state before the packet was complete. */
+  if((stack->rxEarlyStarted != 0u) &&
+     ((stack->rxCounter == 0u) || (stack->rxState != RX_STATE_LINK_INITIALIZED)))
+  {
+    stack->rxEarlyStarted = 0u;
+    if(stack->rxEarlyHandler != NULL)
+    {
+      (void) stack->rxEarlyHandler(stack->rxEarlyContext, stack, RIOSTACK_EARLY_ABORT, 0u, NULL);
+    }
+    else
+    {
+      /* The handler has been removed. */
+    }
+  }
+  else
+  {
+    /* Don't do anything. */
+  }
+}
+
+
+
+static void handleLinkRequest(RioStack_t *stack, LinkRequestCmd_t cmd)
+{
+  /* Check the command of the link-request. */
+  if(cmd == LINK_REQUEST_INPUT_STATUS)
+  {
+    /* Input-status requested. */
+    /* Return input port status. */
+
+    /* Force the transmitter to send a link-response-symbol. */
+    stack->txState = TX_STATE_SEND_LINK_RESPONSE;
+  }
+  else if(cmd == LINK_REQUEST_RESET_DEVICE)
+  {
+    /* Reset-device requested. */
+    /* REMARK: Support this??? */
+  }
+  else
+  {
+    /* Unrecognized command. */
+    /* Don't do anything. */
+  }
+
+  /* Always cancel an ongoing frame when a link-request has been received. */
+  stack->rxCounter = 0u;
+
+  /* Receiving this indicates the link partner having encountered a potential problem. */
+  /* Count the number of times this happens. */
+  stack->statusPartnerLinkRequest++;
+}
+
+
+
+/*
+ * Create a 24-bit control symbol. The format is:
+ * stype0(2:0)|parameter0(4:0)|parameter1(4:0)|stype1(2:0)|cmd(2:0)|crc5(4:0)
+ * See RapidIO 3.1, part6, chapter 3 for more details.
+ */
+static RioSymbol_t createControlSymbol(const stype0_t stype0,
+                                       const uint8_t parameter0, const uint8_t parameter1,
+                                       const stype1_t stype1, const uint8_t cmd)
+{
+  RioSymbol_t s;
+
+  s.type = RIOSTACK_SYMBOL_TYPE_CONTROL;
+
+  s.data = ((uint32_t)stype0 & (uint32_t)0x07ul) << 21;
+  s.data |= ((uint32_t)parameter0 & (uint32_t)0x1ful) << 16;
+  s.data |= ((uint32_t)parameter1 & (uint32_t)0x1ful) << 11;
+  s.data |= ((uint32_t)stype1 & (uint32_t)0x07ul) << 8;
+  s.data |= ((uint32_t)cmd & (uint32_t)0x7ul) << 5;
+  s.data |= crc5(s.data, 0x1fu);
+
+  return s;
+}
+
+
+
+/*
+ * Create a control symbol to transmit. If extended ackIds are enabled, the unused 
+ * byte is used to indicate this to the link-partner and to carry the most 
+ * significant bit of parameter0. The format of the extended byte is:
+ * marker(5:0)|parameter0(5)|supported
+ * The 24-bit control symbol is not affected and a link-partner that does not 
+ * support extended ackIds can ignore the byte.
+ */
+static RioSymbol_t createControlSymbolExtended(const RioStack_t *stack, const stype0_t stype0,
+                                               const uint8_t parameter0, const uint8_t parameter1,
+                                               const stype1_t stype1, const uint8_t cmd)
+{
+  RioSymbol_t s;
+
+  s = createControlSymbol(stype0, parameter0, parameter1, stype1, cmd);
+  if(stack->ackIdExtendedEnable != 0u)
+  {
+    s.data |= EXTENDED_MARKER | EXTENDED_SUPPORTED | EXTENDED_PARAMETER0(parameter0);
+  }
+  else
+  {
+    /* Don't do anything. */
+  }
+
+  return s;
+}
+
+
+
+static uint8_t crc5(const uint32_t data, const uint8_t crc)
+{
+  static const uint8_t crcTable[] = {
+    0x00u, 0x15u, 0x1fu, 0x0au, 0x0bu, 0x1eu, 0x14u, 0x01u,
+    0x16u, 0x03u, 0x09u, 0x1cu, 0x1du, 0x08u, 0x02u, 0x17u,
+    0x19u, 0x0cu, 0x06u, 0x13u, 0x12u, 0x07u, 0x0du, 0x18u,
+    0x0fu, 0x1au, 0x10u, 0x05u, 0x04u, 0x11u, 0x1bu, 0x0eu
+  };
+
+  uint8_t result;
+  uint8_t index;
+  
+  result = crc;
+  index  = (uint8_t)((data >> 19) & (uint32_t)0x1ful) ^ result;
+  result = crcTable[index];
+  index  = (uint8_t)((data >> 14) & (uint32_t)0x1ful) ^ result;
+  result = crcTable[index];
+  index  = (uint8_t)((data >> 9) & (uint32_t)0x1ful) ^ result;
+  result = crcTable[index];
+  index  = (uint8_t)((data >> 4) & (uint32_t)0x1eul) ^ result;
+  result = crcTable[index];
+
+  return result;
+}
+
+
+
+static uint8_t getBufferStatus(const RioStack_t *stack)
+{
+  uint8_t status;
+
+
+  status = queueAvailable(stack->rxQueue);
+  if(status > 31u)
+  {
+    status = 31u;
+  }
+
+  return status;
+}
+
+
+
+static uint8_t getVcBufferStatus(const RioStack_t *stack)
+{
+  uint8_t status;
+
+
+  status = queueAvailable(stack->rxVcQueue);
+  if(status > 31u)
+  {
+    status = 31u;
+  }
+
+  return status;
+}
+
+
+
+static RioSymbol_t createStatusSymbol(RioStack_t *stack, const stype1_t stype1)
+{
+  RioSymbol_t s;
+  uint8_t bufferStatus;
+
+
+  /* Check if the VC1 buffer status should be sent instead of the VC0 status. */
+  bufferStatus = getVcBufferStatus(stack);
+  if((stack->vcEnable != 0u) && (bufferStatus != stack->rxVcBufferStatusSent))
+  {
+    /* The VC1 buffer status has changed. */
+    s = createControlSymbolExtended(stack, STYPE0_VC_STATUS, 1u, bufferStatus, stype1, 0u);
+    stack->rxVcBufferStatusSent = bufferStatus;
+  }
+  else
+  {
+    /* Send the ackId and the buffer status of VC0. */
+    bufferStatus = getBufferStatus(stack);
+    s = createControlSymbolExtended(stack, STYPE0_STATUS, stack->rxAckId, bufferStatus, stype1, 0u);
   }
+
+  return s;
 }
 
 
 
-static void handleNewPacketStart(RioStack_t *stack)
+static void releaseOutboundElement(RioStack_t *stack, const uint32_t *element)
 {
-  /* Check if there are buffers available to store the new frame. */
-  if (queueAvailable(stack->rxQueue) > 0u)
+  if((element[0] & QUEUE_HANDLE) != 0u)
   {
-    /* There are buffers available to accept the new packet. */
-
-    /* Update the reception counter to indicate the frame has started. */
-    stack->rxCounter = 1u;
+    RIOPOOL_release(stack->txPool[QUEUE_HANDLE_POOL_GET(element[1])], QUEUE_HANDLE_GET(element[1]));
+    stack->txPoolPackets--;
   }
   else
   {
-    /* There are no buffers available. */
-    /* Go to input retry stopped state. */
-    stack->statusInboundPacketRetry++;
-    stack->txState = TX_STATE_SEND_PACKET_RETRY;
-    stack->rxState = RX_STATE_INPUT_RETRY_STOPPED;
+    /* The packet was copied into the queue. */
   }
 }
 
 
 
-static void handleNewPacketEnd(RioStack_t *stack)
+static uint8_t schedulePacket(RioStack_t *stack)
 {
-  /* Save the size of the packet. */
-  queueBackSetSize(stack->rxQueue, (uint32_t)stack->rxCounter - (uint32_t)1ul);
+  uint32_t *src, *dst;
+  uint32_t size;
+  uint32_t i;
+  uint8_t vc;
+  uint8_t status;
+  uint8_t scheduled;
+  uint8_t turns;
+  uint8_t ready;
 
-  /* Always forward the packet to the top of the stack. */
-  stack->rxQueue = queueEnqueue(stack->rxQueue);
 
-  /* Make sure the CRC is reset to an invalid value to avoid a packet 
-     accidentally being accepted. */
-  stack->rxCrc = 0xffffu;
+  /* Check that not too many packets are outstanding. */
+  ready = (uint8_t) (MASK_ACKID(stack, stack->txAckIdWindow - stack->txAckId) != stack->ackIdMask);
 
-  /* Reset the reception counter. */
-  stack->rxCounter = 0u;
+  /* Check if a packet should be taken from the virtual channels. It is not 
+     possible while a packet is being written since it must stay the newest 
+     in the outbound queue. */
+  if((stack->vcEnable != 0u) && ready && queueWindowEmpty(stack->txQueue) && 
+     (queueAvailable(stack->txQueue) > 0u) && (stack->txCutThrough == 0u))
+  {
+    /* Let the virtual channels send their weight in packets in turn. A virtual 
+       channel that has nothing to send or where the link-partner has no 
+       buffers available gives the turn to the next. The buffer status of the 
+       link-partner does not include the packets that are not yet acknowledged. */
+    scheduled = 0u;
+    for(turns = 0u; (turns <= RIOSTACK_VC_COUNT) && (scheduled == 0u); turns++)
+    {
+      vc = stack->txVc;
+      status = (vc == 0u) ? stack->txBufferStatus : stack->txVcBufferStatus;
+      if((stack->txVcCredit[vc] > 0u) && (!queueEmpty(stack->txVcQueue[vc])) && /*lint !e961 Boolean expression. */
+         (status > queueCountVc(stack->txQueue, stack->txPool, vc)))
+      {
+        /* Move the packet, or the handle of a pooled packet, to the outbound queue. */
+        src = queueGetFrontBuffer(stack->txVcQueue[vc]);
+        dst = queueGetBackBuffer(stack->txQueue);
+        size = queueFrontGetSize(stack->txVcQueue[vc]);
+        for(i = 0u; i < (((size & QUEUE_HANDLE) != 0u) ? 1u : size); i++)
+        {
+          dst[i] = src[i]; /*lint !e960 This is not pointer arithmetics. */
+        }
+        queueBackSetSize(stack->txQueue, size);
+        stack->txQueue = queueEnqueue(stack->txQueue);
+        stack->txVcQueue[vc] = queueDequeue(stack->txVcQueue[vc]);
+        stack->txVcCredit[vc]--;
+        scheduled = 1u;
+      }
+      else
+      {
+        /* Give the turn to the next virtual channel. */
+        stack->txVc = (uint8_t) ((vc + 1u) % RIOSTACK_VC_COUNT);
+        stack->txVcCredit[stack->txVc] = stack->txVcWeight[stack->txVc];
+      }
+    }
+  }
+  else
+  {
+    /* Don't do anything. */
+  }
 
-  /* Update the ackId for the receiver. */
-  stack->rxAckId = MASK_5BITS(stack->rxAckId + 1u);
+  /* Check if there is a packet to send. Without virtual channels, there must 
+     also be buffers available at the link-partner. */
+  return (uint8_t) (ready && (!queueWindowEmpty(stack->txQueue)) && /*lint !e961 Boolean expression. */
+                    ((stack->vcEnable != 0u) || (stack->txBufferStatus > 0u)));
+}
 
-  /* Update status counter. */
-  stack->statusInboundPacketComplete++;
+
+
+static RioQueue_t *getInboundQueue(RioStack_t *stack)
+{
+  return (stack->rxVc != 0u) ? &stack->rxVcQueue : &stack->rxQueue;
 }
 
 
 
-static void handleLinkRequest(RioStack_t *stack, LinkRequestCmd_t cmd)
+static void dequeueOutbound(RioStack_t *stack)
 {
-  /* Check the command of the link-request. */
-  if(cmd == LINK_REQUEST_INPUT_STATUS)
-  {
-    /* Input-status requested. */
-    /* Return input port status. */
+  releaseOutboundElement(stack, queueGetOldestElement(stack->txQueue));
+  stack->txQueue = queueDequeue(stack->txQueue);
+}
 
-    /* Force the transmitter to send a link-response-symbol. */
-    stack->txState = TX_STATE_SEND_LINK_RESPONSE;
+
+
+/*******************************************************************************************
+ * Internal snapshot functions.
+ *******************************************************************************************/
+
+static void snapshotStack(SnapshotCursor_t *cursor, RioStack_t *stack)
+{
+  uint32_t rxState;
+  uint32_t rxCrc;
+  uint32_t rxErrorCause;
+  uint32_t txState;
+  uint32_t txStatusCounter;
+  uint32_t partial;
+  uint32_t i;
+
+
+  /* Receiver variables. */
+  rxState = (uint32_t) stack->rxState;
+  snapshotWord(cursor, &rxState);
+  snapshotByte(cursor, &stack->rxCounter);
+  rxCrc = stack->rxCrc;
+  snapshotWord(cursor, &rxCrc);
+  snapshotByte(cursor, &stack->rxStatusReceived);
+  snapshotByte(cursor, &stack->rxAckId);
+  snapshotByte(cursor, &stack->rxAckIdAcked);
+  rxErrorCause = (uint32_t) stack->rxErrorCause;
+  snapshotWord(cursor, &rxErrorCause);
+  snapshotByte(cursor, &stack->rxXoffLevel);
+  snapshotByte(cursor, &stack->rxXonLevel);
+  snapshotByte(cursor, &stack->rxCongested);
+  snapshotByte(cursor, &stack->rxVc);
+  snapshotByte(cursor, &stack->rxVcBufferStatusSent);
+
+  /* The words of a partially received packet are stored in the back of the inbound queue 
+     of its virtual channel. */
+  partial = (stack->rxCounter > 1u) ? ((uint32_t) stack->rxCounter - 1ul) : 0ul;
+  partial = (partial < RIOPACKET_SIZE_MAX) ? partial : RIOPACKET_SIZE_MAX;
+  snapshotQueue(cursor, &stack->rxQueue, (stack->rxVc == 0u) ? partial : 0ul);
+  snapshotQueue(cursor, &stack->rxVcQueue, (stack->rxVc != 0u) ? partial : 0ul);
+
+  /* Transmitter variables. */
+  txState = (uint32_t) stack->txState;
+  snapshotWord(cursor, &txState);
+  snapshotByte(cursor, &stack->txCounter);
+  txStatusCounter = stack->txStatusCounter;
+  snapshotWord(cursor, &txStatusCounter);
+  snapshotByte(cursor, &stack->txFrameState);
+  for(i = 0ul; i < RIOSTACK_ACKID_MAX; i++)
+  {
+    snapshotWord(cursor, &stack->txFrameTimeout[i]);
   }
-  else if(cmd == LINK_REQUEST_RESET_DEVICE)
+  snapshotByte(cursor, &stack->txAckId);
+  snapshotByte(cursor, &stack->txAckIdWindow);
+  snapshotByte(cursor, &stack->txBufferStatus);
+  snapshotByte(cursor, &stack->txPacketErrorCounter);
+  snapshotQueue(cursor, &stack->txQueue, 0ul);
+  for(i = 0ul; i < RIOSTACK_VC_COUNT; i++)
   {
-    /* Reset-device requested. */
-    /* REMARK: Support this??? */
+    snapshotByte(cursor, &stack->txVcWeight[i]);
+    snapshotByte(cursor, &stack->txVcCredit[i]);
+    snapshotQueue(cursor, &stack->txVcQueue[i], 0ul);
+  }
+  snapshotByte(cursor, &stack->txVc);
+  snapshotByte(cursor, &stack->txVcBufferStatus);
+  snapshotByte(cursor, &stack->txMulticastEvent);
+
+  /* Common protocol stack variables. */
+  snapshotByte(cursor, &stack->vcEnable);
+  snapshotByte(cursor, &stack->ackIdExtendedEnable);
+  snapshotByte(cursor, &stack->ackIdExtendedPartner);
+  snapshotByte(cursor, &stack->ackIdMask);
+  snapshotByte(cursor, &stack->trainingInterval);
+  snapshotByte(cursor, &stack->trainingIntervalReceived);
+  snapshotByte(cursor, &stack->trainingStatusTx);
+  snapshotByte(cursor, &stack->trainingStatusRx);
+  snapshotWord(cursor, &stack->portTime);
+  snapshotWord(cursor, &stack->portTimeout);
+
+  /* Status counters. */
+  snapshotWord(cursor, &stack->statusInboundPacketComplete);
+  snapshotWord(cursor, &stack->statusInboundPacketRetry);
+  snapshotWord(cursor, &stack->statusInboundErrorControlCrc);
+  snapshotWord(cursor, &stack->statusInboundErrorPacketAckId);
+  snapshotWord(cursor, &stack->statusInboundErrorPacketCrc);
+  snapshotWord(cursor, &stack->statusInboundErrorIllegalCharacter);
+  snapshotWord(cursor, &stack->statusInboundErrorGeneral);
+  snapshotWord(cursor, &stack->statusInboundErrorPacketUnsupported);
+  snapshotWord(cursor, &stack->statusOutboundPacketComplete);
+  snapshotWord(cursor, &stack->statusOutboundLinkLatencyMax);
+  snapshotWord(cursor, &stack->statusOutboundPacketRetry);
+  snapshotWord(cursor, &stack->statusOutboundErrorTimeout);
+  snapshotWord(cursor, &stack->statusOutboundErrorPacketAccepted);
+  snapshotWord(cursor, &stack->statusOutboundErrorPacketRetry);
+  snapshotWord(cursor, &stack->statusPartnerLinkRequest);
+  snapshotWord(cursor, &stack->statusPartnerErrorControlCrc);
+  snapshotWord(cursor, &stack->statusPartnerErrorPacketAckId);
+  snapshotWord(cursor, &stack->statusPartnerErrorPacketCrc);
+  snapshotWord(cursor, &stack->statusPartnerErrorIllegalCharacter);
+  snapshotWord(cursor, &stack->statusPartnerErrorGeneral);
+
+  /* Set the variables that are not stored in their own type. */
+  if(SNAPSHOT_READ(cursor))
+  {
+    stack->rxState = (RioReceiverState_t) rxState;
+    stack->rxCrc = (uint16_t) rxCrc;
+    stack->rxErrorCause = (RioStackPacketNotAcceptedCause_t) rxErrorCause;
+    stack->txState = (RioTransmitterState_t) txState;
+    stack->txStatusCounter = (uint16_t) txStatusCounter;
   }
   else
   {
-    /* Unrecognized command. */
-    /* Don't do anything. */
+    /* The stack is only read. */
   }
 
-  /* Always cancel an ongoing frame when a link-request has been received. */
-  stack->rxCounter = 0u;
-
-  /* Receiving this indicates the link partner having encountered a potential problem. */
-  /* Count the number of times this happens. */
-  stack->statusPartnerLinkRequest++;
+  /* Check that a read snapshot can be used by the stack. */
+  if((stack->rxState > RX_STATE_INPUT_ERROR_STOPPED) ||
+     (stack->txState > TX_STATE_OUTPUT_ERROR_STOPPED) ||
+     ((stack->ackIdMask != 0x1fu) && (stack->ackIdMask != 0x3fu)) ||
+     (stack->rxAckId > stack->ackIdMask) || (stack->rxAckIdAcked > stack->ackIdMask) ||
+     (stack->txAckId > stack->ackIdMask) || (stack->txAckIdWindow > stack->ackIdMask) ||
+     (stack->rxVc >= RIOSTACK_VC_COUNT) || (stack->txVc >= RIOSTACK_VC_COUNT))
+  {
+    cursor->valid = 0u;
+  }
+  else
+  {
+    /* Don't do anything. */
+  }
 }
 
 
 
-/*
- * Create a 24-bit control symbol. The format is:
- * stype0(2:0)|parameter0(4:0)|parameter1(4:0)|stype1(2:0)|cmd(2:0)|crc5(4:0)
- * See RapidIO 3.1, part6, chapter 3 for more details.
- */
-static RioSymbol_t createControlSymbol(const stype0_t stype0,
-                                       const uint8_t parameter0, const uint8_t parameter1,
-                                       const stype1_t stype1, const uint8_t cmd)
+static void snapshotQueue(SnapshotCursor_t *cursor, RioQueue_t *q, const uint32_t partial)
 {
-  RioSymbol_t s;
-
-  s.type = RIOSTACK_SYMBOL_TYPE_CONTROL;
+  RioQueue_t restored;
+  uint32_t *element;
+  uint32_t length;
+  uint32_t words;
+  uint32_t word;
+  uint32_t i;
+  uint32_t j;
+
+
+  /* The queue must have the same size as the one the snapshot was taken of. */
+  restored = *q;
+  snapshotByte(cursor, &restored.size);
+  snapshotByte(cursor, &restored.available);
+  snapshotByte(cursor, &restored.windowSize);
+  snapshotByte(cursor, &restored.windowIndex);
+  snapshotByte(cursor, &restored.frontIndex);
+  snapshotByte(cursor, &restored.backIndex);
+  length = (uint32_t) restored.size - (uint32_t) restored.available;
+  if((restored.size != q->size) || (restored.available > restored.size) ||
+     (restored.windowSize > length) ||
+     ((restored.size != 0u) &&
+      ((restored.frontIndex >= restored.size) ||
+       (restored.backIndex != ((restored.frontIndex + length) % restored.size)) ||
+       (restored.windowIndex != ((restored.frontIndex + restored.windowSize) % restored.size)))))
+  {
+    cursor->valid = 0u;
+  }
+  else
+  {
+    /* Transfer the packets from the front and then the partially received 
+       packet at the back. The size of the partial packet is not stored in the 
+       queue. */
+    for(i = 0ul; (i <= length) && cursor->valid; i++)
+    {
+      if(i < length)
+      {
+        element = q->buffer_p + (RIOSTACK_BUFFER_SIZE*((restored.frontIndex + i) % restored.size)); /*lint !e960 The buffer_p acts as an array of packets. */
+        words = element[0];
+        snapshotWord(cursor, &words);
+        if((words <= RIOPACKET_SIZE_MAX) && (cursor->mode == SNAPSHOT_MODE_RESTORE))
+        {
+          element[0] = words;
+        }
+        else
+        {
+          /* Don't do anything. */
+        }
+      }
+      else
+      {
+        element = q->buffer_p + (RIOSTACK_BUFFER_SIZE*restored.backIndex); /*lint !e960 The buffer_p acts as an array of packets. */
+        words = partial;
+        snapshotWord(cursor, &words);
+        if((words != 0ul) && (restored.size == 0u))
+        {
+          cursor->valid = 0u;
+        }
+        else
+        {
+          /* Don't do anything. */
+        }
+      }
 
-  s.data = ((uint32_t)stype0 & (uint32_t)0x07ul) << 21;
-  s.data |= ((uint32_t)parameter0 & (uint32_t)0x1ful) << 16;
-  s.data |= ((uint32_t)parameter1 & (uint32_t)0x1ful) << 11;
-  s.data |= ((uint32_t)stype1 & (uint32_t)0x07ul) << 8;
-  s.data |= ((uint32_t)cmd & (uint32_t)0x7ul) << 5;
-  s.data |= crc5(s.data, 0x1fu);
+      if((words > RIOPACKET_SIZE_MAX) || (!cursor->valid))
+      {
+        cursor->valid = 0u;
+      }
+      else
+      {
+        for(j = 1ul; j <= words; j++)
+        {
+          word = element[j];
+          snapshotWord(cursor, &word);
+          if(cursor->mode == SNAPSHOT_MODE_RESTORE)
+          {
+            element[j] = word;
+          }
+          else
+          {
+            /* Don't do anything. */
+          }
+        }
+      }
+    }
 
-  return s;
+    if(SNAPSHOT_READ(cursor))
+    {
+      *q = restored;
+    }
+    else
+    {
+      /* The queue is only read. */
+    }
+  }
 }
 
 
 
-static uint8_t crc5(const uint32_t data, const uint8_t crc)
+static void snapshotWord(SnapshotCursor_t *cursor, uint32_t *value)
 {
-  static const uint8_t crcTable[] = {
-    0x00u, 0x15u, 0x1fu, 0x0au, 0x0bu, 0x1eu, 0x14u, 0x01u,
-    0x16u, 0x03u, 0x09u, 0x1cu, 0x1du, 0x08u, 0x02u, 0x17u,
-    0x19u, 0x0cu, 0x06u, 0x13u, 0x12u, 0x07u, 0x0du, 0x18u,
-    0x0fu, 0x1au, 0x10u, 0x05u, 0x04u, 0x11u, 0x1bu, 0x0eu
-  };
+  uint8_t *octet;
 
-  uint8_t result;
-  uint8_t index;
-  
-  result = crc;
-  index  = (uint8_t)((data >> 19) & (uint32_t)0x1ful) ^ result;
-  result = crcTable[index];
-  index  = (uint8_t)((data >> 14) & (uint32_t)0x1ful) ^ result;
-  result = crcTable[index];
-  index  = (uint8_t)((data >> 9) & (uint32_t)0x1ful) ^ result;
-  result = crcTable[index];
-  index  = (uint8_t)((data >> 4) & (uint32_t)0x1eul) ^ result;
-  result = crcTable[index];
 
-  return result;
+  if(cursor->mode == SNAPSHOT_MODE_SIZE)
+  {
+    /* Only count the words. */
+  }
+  else if((cursor->index + 4ul) > cursor->size)
+  {
+    /* The snapshot is too short. */
+    cursor->valid = 0u;
+  }
+  else
+  {
+    octet = &cursor->buffer[cursor->index]; /*lint !e960 The buffer is an array of octets. */
+    if(cursor->mode == SNAPSHOT_MODE_WRITE)
+    {
+      octet[0] = (uint8_t) (*value >> 24);
+      octet[1] = (uint8_t) (*value >> 16);
+      octet[2] = (uint8_t) (*value >> 8);
+      octet[3] = (uint8_t) *value;
+    }
+    else
+    {
+      *value = ((uint32_t) octet[0] << 24) | ((uint32_t) octet[1] << 16) |
+        ((uint32_t) octet[2] << 8) | (uint32_t) octet[3];
+    }
+  }
+
+  cursor->index += 4ul;
 }
 
 
 
-static uint8_t getBufferStatus(const RioStack_t *stack)
+static void snapshotByte(SnapshotCursor_t *cursor, uint8_t *value)
 {
-  uint8_t status;
+  uint32_t word;
 
 
-  status = queueAvailable(stack->rxQueue);
-  if(status > 31u)
+  word = *value;
+  snapshotWord(cursor, &word);
+  if(word > 0xfful)
   {
-    status = 31u;
+    cursor->valid = 0u;
+  }
+  else if(SNAPSHOT_READ(cursor))
+  {
+    *value = (uint8_t) word;
+  }
+  else
+  {
+    /* The value is only read. */
   }
-
-  return status;
 }
 
 
@@ -1815,9 +3355,9 @@ static uint32_t queueFrontGetSize(RioQueue_t q)
 
 
 
-static uint32_t queueGetFrontContent(const RioQueue_t q, const uint32_t index)
+static uint32_t *queueGetFrontElement(const RioQueue_t q)
 {
-  return (q.buffer_p+(RIOSTACK_BUFFER_SIZE*q.windowIndex))[index+1u]; /*lint !e960 The buffer_p acts as an array of packets. */
+  return q.buffer_p+(RIOSTACK_BUFFER_SIZE*q.windowIndex); /*lint !e960 The buffer_p acts as an array of packets. */
 }
 
 
@@ -1833,5 +3373,99 @@ static uint32_t *queueGetBackBuffer(const RioQueue_t q )
 {
   return &((q.buffer_p+(RIOSTACK_BUFFER_SIZE*q.backIndex))[1u]); /*lint !e960 The buffer_p acts as an array of packets. */
 }
+
+
+
+static RioPacket_t *queueGetBackPacket(const RioQueue_t q )
+{
+  return (RioPacket_t *) (q.buffer_p+(RIOSTACK_BUFFER_SIZE*q.backIndex)); /*lint !e960 !e740 The buffer_p acts as an array of packets. */
+}
+
+
+
+static uint32_t *queueGetOldestElement(const RioQueue_t q)
+{
+  return q.buffer_p+(RIOSTACK_BUFFER_SIZE*q.frontIndex); /*lint !e960 The buffer_p acts as an array of packets. */
+}
+
+
+
+static uint32_t *queueGetNewestElement(const RioQueue_t q)
+{
+  uint8_t index;
+
+  index = (q.backIndex == 0u) ? (q.size - 1u) : (q.backIndex - 1u);
+  return q.buffer_p+(RIOSTACK_BUFFER_SIZE*index); /*lint !e960 The buffer_p acts as an array of packets. */
+}
+
+
+
+static uint32_t *elementGetContent(uint32_t *element, RioPool_t *const pools[])
+{
+  uint32_t *content;
+
+  if((element[0] & QUEUE_HANDLE) != 0u)
+  {
+    content = &RIOPOOL_getPacket(pools[QUEUE_HANDLE_POOL_GET(element[1])], QUEUE_HANDLE_GET(element[1]))->payload[0];
+  }
+  else
+  {
+    content = &element[1];
+  }
+
+  return content;
+}
+
+
+
+static uint8_t queueWindowNewest(const RioQueue_t q)
+{
+  /* The window is at the newest element if it is the only one not in the window. */
+  return (uint8_t) ((q.available + q.windowSize + 1u) == q.size);
+}
+
+
+
+static RioQueue_t queueRemoveNewest(RioQueue_t q)
+{
+  if(q.backIndex == 0u)
+  {
+    q.backIndex = q.size;
+  }
+  q.backIndex--;
+  q.available++;
+  return q;
+}
+
+
+
+static uint8_t queueCountVc(const RioQueue_t q, RioPool_t *const pools[], const uint8_t vc)
+{
+  uint8_t count;
+  uint8_t index;
+  uint8_t i;
+
+  count = 0u;
+  index = q.frontIndex;
+  for(i = 0u; i < queueLength(q); i++)
+  {
+    if(PACKET_VC_GET(elementGetContent(q.buffer_p+(RIOSTACK_BUFFER_SIZE*index), pools)[0u]) == vc) /*lint !e960 The buffer_p acts as an array of packets. */
+    {
+      count++;
+    }
+    else
+    {
+      /* Don't do anything. */
+    }
+
+    index++;
+    if(index == q.size)
+    {
+      index = 0u;
+    }
+  }
+
+  return count;
+}
  
 /*************************** end of file **************************************/
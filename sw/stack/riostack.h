@@ -101,6 +101,32 @@
  *   }
  *   ...
  *
+ * Transmitting packets while they are received (cut-through):
+ *   if(RIOSTACK_getOutboundQueueAvailable(stack) > 0)
+ *   {
+ *     RIOSTACK_startOutboundPacket(stack);
+ *     while(<more words>)
+ *     {
+ *       RIOSTACK_appendOutboundPacket(stack, count, words);
+ *     }
+ *     RIOSTACK_endOutboundPacket(stack);
+ *     or
+ *     RIOSTACK_abortOutboundPacket(stack);
+ *   }
+ *
+ * Using virtual channels:
+ *   RIOSTACK_setVirtualChannels(stack, ...);
+ *   RIOPACKET_patchHeader(packet, RIOPACKET_FIELD_VC, 1);
+ *   if(RIOSTACK_getOutboundQueueAvailableVc(stack, 1) > 0)
+ *   {
+ *     RIOSTACK_setOutboundPacket(stack, packet);
+ *   }
+ *   ...
+ *   if(RIOSTACK_getInboundQueueLengthVc(stack, 1) > 0)
+ *   {
+ *     RIOSTACK_getInboundPacketVc(stack, 1, packet);
+ *   }
+ *
  * Any application specific tailoring needed to compile properly should be done 
  * in rioconfig.h.
  *******************************************************************************/
@@ -113,6 +139,7 @@
  *******************************************************************************/
 
 #include "riopacket.h"
+#include "riopool.h"
 
 
 /*******************************************************************************
@@ -123,6 +150,37 @@
     in words (32-bit). */
 #define RIOSTACK_BUFFER_SIZE (RIOPACKET_SIZE_MAX+1u)
 
+/** The number of ackIds when extended ackIds are used. */
+#define RIOSTACK_ACKID_MAX 64u
+
+/** The number of virtual channels, VC0 and VC1. */
+#define RIOSTACK_VC_COUNT 2u
+
+/** The number of packet pools that outbound packets can be queued from. */
+#define RIOSTACK_POOLS 4u
+
+/** The first word of a stack snapshot, "RIOS". */
+#define RIOSTACK_SNAPSHOT_MAGIC 0x52494f53ul
+
+/** The version of the stack snapshot format. */
+#define RIOSTACK_SNAPSHOT_VERSION 4ul
+
+/** The default number of idle symbols between status-control-symbols during 
+    link initialization until a status-control-symbol has been received. */
+#define RIOSTACK_TRAINING_INTERVAL 255u
+
+/** The default number of idle symbols between status-control-symbols during 
+    link initialization after a status-control-symbol has been received. */
+#define RIOSTACK_TRAINING_INTERVAL_RECEIVED 15u
+
+/** The minimum number of status-control-symbols to transmit during link 
+    initialization after a status-control-symbol has been received. */
+#define RIOSTACK_TRAINING_STATUS_TX 15u
+
+/** The minimum number of error-free status-control-symbols to receive in a 
+    row, besides the one that completes the link initialization. */
+#define RIOSTACK_TRAINING_STATUS_RX 7u
+
 
 /** Define the different types of RioSymbols. */
 typedef enum 
@@ -139,6 +197,9 @@ typedef enum
  * Idle symbol: Sent when nothing else to send. Does not use the data field.
  * Control symbol: Sent when starting, ending and acknowleding a packet. Data 
  * is right aligned, (Unused, C0, C1, C2) where C0 is transmitted/received first.
+ * The unused byte carries the extended ackId information when extended ackIds 
+ * are enabled, see RIOSTACK_setExtendedAckId(). Ports that cannot transfer it 
+ * should set it to zero.
  * Data symbol: Sent to transfer packets. Uses the full data field, (D0, D1, 
  * D2, D3) where D0 is transmitted/received first.
  * Error symbols are created when a symbols could not be created and the stack 
@@ -215,8 +276,82 @@ typedef enum
 
 
 
+/* Forward declaration to allow handlers to refer to the stack structure. */
+struct RioStack;
+
+/**
+ * \brief A handler for received packets.
+ *
+ * \param[in] context The context pointer given when the handler was registered.
+ * \param[in] stack The stack that received the packet.
+ * \param[in] packet The received packet.
+ * \return Non-zero if the packet was consumed by the handler and should not be 
+ * placed in the inbound queue, zero otherwise.
+ *
+ * \note The handler is called from RIOSTACK_portAddSymbol() and should return quickly. 
+ * The packet is read from the inbound queue and is only valid during the call.
+ */
+typedef uint8_t (*RioStackInboundHandler_t)(void *context, struct RioStack *stack, const RioPacket_t *packet);
+
+/**
+ * \brief A handler for inbound queue congestion.
+ *
+ * \param[in] context The context pointer given when the handler was registered.
+ * \param[in] stack The stack with the congested inbound queue.
+ * \param[in] congested Non-zero when a packet has been placed in the inbound queue 
+ * at or above the XOFF level, zero when the queue has drained to the XON level.
+ * \param[in] packet The packet that is placed in the queue when congested, NULL otherwise. 
+ * It is only valid during the call.
+ *
+ * \note The handler is called from RIOSTACK_portAddSymbol() and 
+ * RIOSTACK_getInboundPacket() and should return quickly.
+ */
+typedef void (*RioStackCongestionHandler_t)(void *context, struct RioStack *stack, 
+                                            const uint8_t congested, const RioPacket_t *packet);
+
+/** The events of an inbound packet that are reported before the packet is complete. */
+typedef enum
+{
+  RIOSTACK_EARLY_HEADER, /**< The first words of the packet have been received. */
+  RIOSTACK_EARLY_WORD, /**< A word after the header has been received. */
+  RIOSTACK_EARLY_END, /**< The packet has been received with a correct crc. */
+  RIOSTACK_EARLY_ABORT /**< The packet was not received correctly and must be discarded. */
+} RioStackEarlyEvent_t;
+
+/**
+ * \brief A handler for inbound packets that are still being received.
+ *
+ * \param[in] context The context pointer given when the handler was registered.
+ * \param[in] stack The stack that is receiving the packet.
+ * \param[in] event What has happened to the packet.
+ * \param[in] size The number of words, the header size for RIOSTACK_EARLY_HEADER, 
+ * one for RIOSTACK_EARLY_WORD and zero otherwise.
+ * \param[in] words The received words. The ackId of the first word is set to zero.
+ * \return For RIOSTACK_EARLY_END, non-zero if the packet was consumed by the handler 
+ * and should not be delivered, zero otherwise. Ignored for the other events.
+ *
+ * \note The handler is called from RIOSTACK_portAddSymbol() and should return quickly.
+ * The words have not been checked by the crc until RIOSTACK_EARLY_END.
+ */
+typedef uint8_t (*RioStackEarlyHandler_t)(void *context, struct RioStack *stack, 
+                                          const RioStackEarlyEvent_t event, 
+                                          const uint8_t size, const uint32_t *words);
+
+/**
+ * \brief A handler for received multicast-event-control-symbols.
+ *
+ * \param[in] context The context pointer given when the handler was registered.
+ * \param[in] stack The stack that received the multicast-event.
+ * \param[in] portTime The port time when the multicast-event was received.
+ *
+ * \note The handler is called from RIOSTACK_portAddSymbol() and should return quickly.
+ */
+typedef void (*RioStackMulticastEventHandler_t)(void *context, struct RioStack *stack, 
+                                                const uint32_t portTime);
+
+
 /** The structure to keep all the RapidIO stack variables. */
-typedef struct
+typedef struct RioStack
 {
   /* Receiver variables. */
   RioReceiverState_t rxState; /**< The state of the receiver. */
@@ -227,20 +362,55 @@ typedef struct
   uint8_t rxAckIdAcked; /**< The ackId that has been acknowledged. Indicates to the transmitter to send packet-accepted. */
   RioStackPacketNotAcceptedCause_t rxErrorCause; /**< The cause of a packet not being accepted to send by the transmitter. */
   RioQueue_t rxQueue; /**< The inbound queue of packets. */
+  RioStackInboundHandler_t rxHandler[16]; /**< Handlers for received packets indexed by ftype. */
+  void *rxHandlerContext[16]; /**< The contexts to call the received packet handlers with. */
+  uint8_t rxXoffLevel; /**< The inbound queue length where congestion is signalled. */
+  uint8_t rxXonLevel; /**< The inbound queue length where congestion is cleared. */
+  uint8_t rxCongested; /**< Non-zero if the inbound queue is congested. */
+  RioStackCongestionHandler_t rxCongestionHandler; /**< The handler for inbound queue congestion. */
+  void *rxCongestionContext; /**< The context to call the congestion handler with. */
+  RioStackEarlyHandler_t rxEarlyHandler; /**< The handler for packets that are still being received. */
+  void *rxEarlyContext; /**< The context to call the early handler with. */
+  uint8_t rxEarlyHeaderSize; /**< The number of words to receive before the early handler is called. */
+  uint8_t rxEarlyStarted; /**< Non-zero if the header of the current packet has been reported. */
+  RioStackMulticastEventHandler_t rxMulticastEventHandler; /**< The handler for received multicast-events. */
+  void *rxMulticastEventContext; /**< The context to call the multicast-event handler with. */
 
   /* Transmitter variables. */
   RioTransmitterState_t txState; /**< The state of the transmitter. */
   uint8_t txCounter; /**< Counter for keeping track of the current outbound packet position. */
   uint16_t txStatusCounter; /**< Counter for keeping track of the number of status-control-symbols transmitted at startup. */
   uint8_t txFrameState; /**< The state of the outbound packet, i.e. what to send next. */
-  uint32_t txFrameTimeout[32]; /**< An array of timestamps mapping to when the packet with ackId was transmitted. */
+  uint32_t txFrameTimeout[RIOSTACK_ACKID_MAX]; /**< An array of timestamps mapping to when the packet with ackId was transmitted. */
   uint8_t txAckId; /**< The ackId that is awaiting a packet-accepted. */
   uint8_t txAckIdWindow; /**< The ackId that was las transmitted. */
   uint8_t txBufferStatus; /**< The buffer status of the link-partner. */
   uint8_t txPacketErrorCounter;
   RioQueue_t txQueue; /**< The outbound queue of packets. */
+  RioPool_t *txPool[RIOSTACK_POOLS]; /**< The pools of the packets that are queued by handle. */
+  uint16_t txPoolPackets; /**< The number of packets that are queued by handle. */
+  uint8_t txCutThrough; /**< Non-zero if the newest packet in the outbound queue is still being written. */
+  uint8_t txMulticastEvent; /**< Non-zero if a multicast-event should be sent. */
+
+  /* Virtual channel variables. */
+  uint8_t vcEnable; /**< Non-zero if packets are sorted into virtual channels. */
+  RioQueue_t rxVcQueue; /**< The inbound queue of VC1 packets. */
+  uint8_t rxVc; /**< The virtual channel of the current inbound packet. */
+  uint8_t rxVcBufferStatusSent; /**< The VC1 buffer status that was last sent to the link-partner. */
+  RioQueue_t txVcQueue[RIOSTACK_VC_COUNT]; /**< The outbound packets that are waiting to be scheduled. */
+  uint8_t txVcWeight[RIOSTACK_VC_COUNT]; /**< The number of packets to send from each virtual channel in turn. */
+  uint8_t txVcCredit[RIOSTACK_VC_COUNT]; /**< The number of packets left to send in the current turn. */
+  uint8_t txVc; /**< The virtual channel that has the turn. */
+  uint8_t txVcBufferStatus; /**< The VC1 buffer status of the link-partner. */
 
   /* Common protocol stack variables. */
+  uint8_t ackIdExtendedEnable; /**< Non-zero if extended ackIds should be negotiated with the link-partner. */
+  uint8_t ackIdExtendedPartner; /**< Non-zero if the link-partner has indicated support for extended ackIds. */
+  uint8_t ackIdMask; /**< The mask for ackId counters, 0x1f or 0x3f if extended ackIds are used. */
+  uint8_t trainingInterval; /**< The idle symbols between status-control-symbols until a status has been received. */
+  uint8_t trainingIntervalReceived; /**< The idle symbols between status-control-symbols after a status has been received. */
+  uint8_t trainingStatusTx; /**< The number of status-control-symbols to transmit during link initialization. */
+  uint8_t trainingStatusRx; /**< The number of status-control-symbols to receive during link initialization. */
   uint32_t portTime; /**< The current time to use. */
   uint32_t portTimeout; /**< The time to use as timeout. */
 
@@ -364,6 +534,62 @@ void RIOSTACK_open(RioStack_t *stack, void *private,
                    const uint32_t rxPacketBufferSize, uint32_t *rxPacketBuffer, 
                    const uint32_t txPacketBufferSize, uint32_t *txPacketBuffer);
 
+/**
+ * \brief Get the size of a snapshot of the stack.
+ *
+ * \param[in] stack The stack to operate on.
+ * \return The number of bytes that RIOSTACK_snapshot() needs.
+ *
+ * The size depends on the number of packets in the queues.
+ */
+uint32_t RIOSTACK_getSnapshotSize(const RioStack_t *stack);
+
+/**
+ * \brief Save the state of the stack.
+ *
+ * \param[in] stack The stack to operate on.
+ * \param[in] size The size of the buffer in bytes.
+ * \param[out] buffer The buffer to write the snapshot to.
+ * \return The number of bytes that was written or zero if the buffer is too small, 
+ * if a packet started with RIOSTACK_startOutboundPacket() has not been ended or 
+ * if the outbound queue holds packets added with RIOSTACK_setOutboundPacketHandle().
+ *
+ * This function saves the receiver and transmitter states, the ackIds, the 
+ * timestamps of the outstanding packets, the packets in the queues including 
+ * a partially received packet and the status counters. The snapshot is a 
+ * sequence of 32-bit big-endian words that starts with RIOSTACK_SNAPSHOT_MAGIC, 
+ * RIOSTACK_SNAPSHOT_VERSION and the size of the snapshot. It can be kept in a 
+ * file or a shared memory segment and restored by another process using 
+ * RIOSTACK_restore().
+ *
+ * Handlers, their contexts and the private user data are not saved.
+ *
+ * \note The snapshot must be taken between calls to the port functions. The 
+ * link partner sees the time until the stack is restored as a pause on the 
+ * link. If the pause is longer than the timeouts of the link, the normal 
+ * error recovery is used to resynchronize the link.
+ */
+uint32_t RIOSTACK_snapshot(const RioStack_t *stack, const uint32_t size, uint8_t *buffer);
+
+/**
+ * \brief Restore the state of the stack from a snapshot.
+ *
+ * \param[in] stack The stack to operate on.
+ * \param[in] size The size of the buffer in bytes.
+ * \param[in] buffer The snapshot written by RIOSTACK_snapshot().
+ * \return Non-zero if the stack was restored, zero if the snapshot is not 
+ * valid or the outbound queue holds packets added with 
+ * RIOSTACK_setOutboundPacketHandle(), and the stack is left unchanged.
+ *
+ * The stack must have been opened with RIOSTACK_open() using queues of the same 
+ * sizes as the stack the snapshot was taken of. Handlers and private user data 
+ * that was set after RIOSTACK_open() is kept.
+ *
+ * \note The port time is restored. The time given to RIOSTACK_portSetTime() 
+ * afterwards should continue from the time of the snapshot.
+ */
+uint8_t RIOSTACK_restore(RioStack_t *stack, const uint32_t size, const uint8_t *buffer);
+
 /*******************************************************************************************
  * Stack status functions.
  * Note that status counters are access directly in the stack-structure.
@@ -392,7 +618,8 @@ uint8_t RIOSTACK_getStatus(const RioStack_t *stack);
  * \return Returns the number of pending outbound packets.
  *
  * This function checks the outbound queue and returns the number of packets 
- * that are pending to be transmitted onto the link.
+ * that are pending to be transmitted onto the link. The packets that are 
+ * waiting in the virtual channel queues are included.
  */
 uint8_t RIOSTACK_getOutboundQueueLength(const RioStack_t *stack);
 
@@ -407,6 +634,19 @@ uint8_t RIOSTACK_getOutboundQueueLength(const RioStack_t *stack);
  */
 uint8_t RIOSTACK_getOutboundQueueAvailable(const RioStack_t *stack);
 
+/**
+ * \brief Get the number of available outbound packets of a virtual channel.
+ *
+ * \param[in] stack The stack to operate on.
+ * \param[in] vc The virtual channel.
+ * \return Returns the number of available outbound packets.
+ *
+ * This function returns the number of packets of the virtual channel that can 
+ * be added before its queue is full. Without virtual channels, VC0 is the 
+ * outbound queue and VC1 has no room.
+ */
+uint8_t RIOSTACK_getOutboundQueueAvailableVc(const RioStack_t *stack, const uint8_t vc);
+
 /**
  * \brief Add a packet to the outbound queue.
  *
@@ -421,10 +661,115 @@ uint8_t RIOSTACK_getOutboundQueueAvailable(const RioStack_t *stack);
  * \note Call RIOSTACK_outboundQueueAvailable() before this function is called to make sure
  * the outbound queue has transmission buffers available.
  *
+ * \note When virtual channels are used, the packet is added to the queue of 
+ * the virtual channel in its header, see RIOSTACK_getOutboundQueueAvailableVc().
+ *
  * \note Use RIOSTACK_getStatus() to know when a packet is allowed to be transmitted.
  */
 void RIOSTACK_setOutboundPacket(RioStack_t *stack, RioPacket_t *packet);
 
+/**
+ * \brief Add a pooled packet to the outbound queue.
+ *
+ * \param[in] stack The stack to operate on.
+ * \param[in] pool The pool the packet was allocated from.
+ * \param[in] handle The packet to send.
+ *
+ * This function sends a packet that has been allocated from a packet pool 
+ * without copying it. Only the handle is placed in the outbound queue and the 
+ * reference held by the caller is handed over to the stack. The reference is 
+ * released when the packet has been acknowledged by the link-partner or when it 
+ * is read back with RIOSTACK_getOutboundPacket(). The packet must not be changed 
+ * until then. Use RIOPOOL_retain() before calling this function to keep the 
+ * packet, for example to send it on several stacks.
+ *
+ * \note Packets can be queued from up to RIOSTACK_POOLS different pools, for 
+ * example one pool for each size class. A pool is remembered until the stack 
+ * is opened again.
+ *
+ * \note The same restrictions as for RIOSTACK_setOutboundPacket() apply.
+ */
+void RIOSTACK_setOutboundPacketHandle(RioStack_t *stack, RioPool_t *pool, const RioPoolHandle_t handle);
+
+/**
+ * \brief Start to add a packet to the outbound queue before all of it is known.
+ *
+ * \param[in] stack The stack to operate on.
+ *
+ * This function adds an empty packet to the outbound queue. Its words are added 
+ * using RIOSTACK_appendOutboundPacket() and the transmitter starts to send them 
+ * as soon as the packet is first in line. When the transmitter has sent all 
+ * the words that has been added so far, it sends idle-symbols until more words 
+ * are added or the packet is ended. This is used to forward packets as they 
+ * are received, for example in a switch or a bridge, where the latency is 
+ * otherwise the time to receive the whole packet.
+ *
+ * The packet is ended with RIOSTACK_endOutboundPacket() or removed with 
+ * RIOSTACK_abortOutboundPacket(). No other packets can be added to the queue 
+ * until then.
+ *
+ * \note Call RIOSTACK_getOutboundQueueAvailable() before this function is 
+ * called to make sure the outbound queue has transmission buffers available.
+ *
+ * \note The words are sent at the rate of RIOSTACK_portGetSymbol(). If the 
+ * words are added slower, the packet occupies the link for longer than needed.
+ */
+void RIOSTACK_startOutboundPacket(RioStack_t *stack);
+
+/**
+ * \brief Add words to a packet started with RIOSTACK_startOutboundPacket().
+ *
+ * \param[in] stack The stack to operate on.
+ * \param[in] count The number of words to add.
+ * \param[in] words The words to add, in the same format as the payload of a 
+ * RioPacket_t including the crc.
+ *
+ * \note The packet can contain at most RIOPACKET_SIZE_MAX words.
+ */
+void RIOSTACK_appendOutboundPacket(RioStack_t *stack, const uint32_t count, const uint32_t *words);
+
+/**
+ * \brief End a packet started with RIOSTACK_startOutboundPacket().
+ *
+ * \param[in] stack The stack to operate on.
+ *
+ * The packet is sent as if it had been added with RIOSTACK_setOutboundPacket().
+ * The words must contain a valid packet, it is not checked.
+ */
+void RIOSTACK_endOutboundPacket(RioStack_t *stack);
+
+/**
+ * \brief Remove a packet started with RIOSTACK_startOutboundPacket().
+ *
+ * \param[in] stack The stack to operate on.
+ *
+ * This function is used when the packet cannot be completed, for example when 
+ * the packet that is forwarded turns out to be corrupt. If the transmitter has 
+ * started to send the packet, a stomp-control-symbol is sent to make the link 
+ * partner discard it. The ackId of the packet is used by the next packet.
+ */
+void RIOSTACK_abortOutboundPacket(RioStack_t *stack);
+
+/**
+ * \brief Remove and return the oldest packet from the outbound queue of a port that is down.
+ *
+ * \param[in] stack The stack to operate on.
+ * \param[out] packet The packet to copy the outbound packet to.
+ * \return Non-zero if the packet has been transmitted but was not acknowledged
+ * when the port went down, zero if it has not been transmitted.
+ *
+ * This function is used to move the packets of a failed link to another stack. 
+ * Packets that have been transmitted but not acknowledged are returned first, 
+ * in the order they were sent, followed by the packets that have not been 
+ * transmitted yet. A packet that has been transmitted may have been received 
+ * by the link partner even if the acknowledge was lost.
+ *
+ * \note The port must have been set to uninitialized using 
+ * RIOSTACK_portSetStatus() before this function is called. Use 
+ * RIOSTACK_getOutboundQueueLength() to know how many packets there are.
+ */
+uint8_t RIOSTACK_getOutboundPacket(RioStack_t *stack, RioPacket_t *packet);
+
 /**
  * \brief Get the number of pending inbound packets.
  *
@@ -447,6 +792,18 @@ uint8_t RIOSTACK_getInboundQueueLength(const RioStack_t *stack);
  */
 uint8_t RIOSTACK_getInboundQueueAvailable(const RioStack_t *stack);
 
+/**
+ * \brief Get the number of pending inbound packets of a virtual channel.
+ *
+ * \param[in] stack The stack to operate on.
+ * \param[in] vc The virtual channel.
+ * \return Returns the number of pending inbound packets.
+ *
+ * The inbound queue is used for VC0 and the queue given to 
+ * RIOSTACK_setVirtualChannels() for VC1.
+ */
+uint8_t RIOSTACK_getInboundQueueLengthVc(const RioStack_t *stack, const uint8_t vc);
+
 /**
  * \brief Get, remove and return a packet from the inbound queue.
  *
@@ -458,6 +815,243 @@ uint8_t RIOSTACK_getInboundQueueAvailable(const RioStack_t *stack);
  */
 void RIOSTACK_getInboundPacket(RioStack_t *stack, RioPacket_t *packet);
 
+/**
+ * \brief Get, remove and return a packet from the inbound queue of a virtual channel.
+ *
+ * \param[in] stack The stack to operate on.
+ * \param[in] vc The virtual channel.
+ * \param[in] packet The packet to receive to.
+ *
+ * RIOSTACK_getInboundPacket() is the same as this function for VC0.
+ */
+void RIOSTACK_getInboundPacketVc(RioStack_t *stack, const uint8_t vc, RioPacket_t *packet);
+
+/**
+ * \brief Get, remove and return a packet from the inbound queue into a pool.
+ *
+ * \param[in] stack The stack to operate on.
+ * \param[in] pool The pool to allocate the packet from.
+ * \return A handle to the received packet or RIOPOOL_HANDLE_INVALID if the pool 
+ * is empty.
+ *
+ * This function allocates a packet from a pool and moves a packet from the inbound 
+ * packet queue to it. The packet is left in the inbound queue if the pool is empty. 
+ * The caller owns the returned reference.
+ */
+RioPoolHandle_t RIOSTACK_getInboundPacketHandle(RioStack_t *stack, RioPool_t *pool);
+
+/**
+ * \brief Set a handler for received packets of a ftype.
+ *
+ * \param[in] stack The stack to operate on.
+ * \param[in] ftype The ftype of the packets to handle.
+ * \param[in] handler The function to call when a packet has been received. Use NULL 
+ *            to remove a handler.
+ * \param[in] context The context to call the handler with.
+ *
+ * This function registers a handler that is called as soon as a packet of the given 
+ * ftype has been received, before it is placed in the inbound queue. If the handler 
+ * consumes the packet, the inbound queue buffer is immediately reused. This is used 
+ * for packets that are handled in bulk, for example doorbells, to avoid that they 
+ * occupy the inbound queue.
+ */
+void RIOSTACK_setInboundHandler(RioStack_t *stack, const uint8_t ftype, 
+                                RioStackInboundHandler_t handler, void *context);
+
+/**
+ * \brief Set a handler for inbound queue congestion.
+ *
+ * \param[in] stack The stack to operate on.
+ * \param[in] xoffLevel The inbound queue length where congestion starts.
+ * \param[in] xonLevel The inbound queue length where congestion ends. Must be 
+ *            lower than xoffLevel.
+ * \param[in] handler The function to call. Use NULL to remove the handler.
+ * \param[in] context The context to call the handler with.
+ *
+ * This function registers a handler that is called for every packet that is placed 
+ * in the inbound queue when it contains xoffLevel packets or more. The handler is 
+ * called again, without a packet, when the application has read packets from the 
+ * queue so that it contains xonLevel packets or less. This is used to ask the 
+ * sources to stop sending before the queue is full and the link partner has to 
+ * retry packets, see rioflow.h.
+ */
+void RIOSTACK_setCongestionHandler(RioStack_t *stack, const uint8_t xoffLevel, const uint8_t xonLevel,
+                                   RioStackCongestionHandler_t handler, void *context);
+
+/**
+ * \brief Set a handler for inbound packets that are still being received.
+ *
+ * \param[in] stack The stack to operate on.
+ * \param[in] headerSize The number of words to receive before the handler is 
+ *            called, one to three.
+ * \param[in] handler The function to call. Use NULL to remove the handler.
+ * \param[in] context The context to call the handler with.
+ *
+ * This function registers a handler that is called with RIOSTACK_EARLY_HEADER as 
+ * soon as the first headerSize words of a packet have been received, before the 
+ * packet crc has been checked. The first word contains the ftype and the 
+ * destination of 8-bit and 16-bit deviceIds, the second word is needed for 
+ * 32-bit deviceIds. This lets a forwarding node choose an output port and start 
+ * to send the packet, see RIOSTACK_startOutboundPacket(), while the rest of the 
+ * packet is received. The rest of the words, including the crcs, are then given 
+ * one at a time with RIOSTACK_EARLY_WORD.
+ *
+ * When the packet is complete and its crc is correct, the handler is called with 
+ * RIOSTACK_EARLY_END and the packet is then delivered as usual unless the handler 
+ * consumed it. If the packet is not completed, for example due to a crc error, a 
+ * stomp-control-symbol or a link error, the handler is called with 
+ * RIOSTACK_EARLY_ABORT as soon as the stack knows it and the packet is never 
+ * delivered. Exactly one of these events follows every RIOSTACK_EARLY_HEADER.
+ */
+void RIOSTACK_setEarlyHandler(RioStack_t *stack, const uint8_t headerSize, 
+                              RioStackEarlyHandler_t handler, void *context);
+
+/**
+ * \brief Use virtual channels.
+ *
+ * \param[in] stack The stack to operate on.
+ * \param[in] txPacketBufferSize0 The size of the VC0 outbound queue in words.
+ * \param[in] txPacketBuffer0 The VC0 outbound queue.
+ * \param[in] txPacketBufferSize1 The size of the VC1 outbound queue in words.
+ * \param[in] txPacketBuffer1 The VC1 outbound queue.
+ * \param[in] rxPacketBufferSize1 The size of the VC1 inbound queue in words.
+ * \param[in] rxPacketBuffer1 The VC1 inbound queue.
+ *
+ * Packets are sorted into VC0 and VC1 using the vc bit of their headers, see 
+ * RIOPACKET_patchHeader(). Each virtual channel has its own queues so that a 
+ * bulk flow on one of them cannot occupy the buffers of the other.
+ *
+ * Outbound packets wait in the queue of their virtual channel until the 
+ * transmitter is about to start a new packet. It then takes the next packet 
+ * from the virtual channels in turn, see RIOSTACK_setVirtualChannelWeight(), 
+ * skipping virtual channels where the link-partner has no buffers available. 
+ * The outbound queue given to RIOSTACK_open() holds the packets that are being 
+ * sent and waiting to be acknowledged. A packet is therefore only delayed by 
+ * the packet that is being sent when it is added. Packets written with 
+ * RIOSTACK_startOutboundPacket() are put directly in the outbound queue.
+ *
+ * Inbound VC0 packets are placed in the inbound queue given to RIOSTACK_open() 
+ * and VC1 packets in the queue given here. The buffer status of VC0 is sent in 
+ * the usual control symbols. The buffer status of VC1 is sent in 
+ * VC_STATUS-control-symbols whenever it changes. VC1 packets are not sent until 
+ * the link-partner has sent a VC_STATUS-control-symbol, so both link-partners 
+ * must use virtual channels. Packets are still acknowledged in order using the 
+ * common ackIds of the link.
+ *
+ * \note This must be called after RIOSTACK_open() and before 
+ * RIOSTACK_portSetStatus() initializes the port.
+ */
+void RIOSTACK_setVirtualChannels(RioStack_t *stack,
+                                 const uint32_t txPacketBufferSize0, uint32_t *txPacketBuffer0,
+                                 const uint32_t txPacketBufferSize1, uint32_t *txPacketBuffer1,
+                                 const uint32_t rxPacketBufferSize1, uint32_t *rxPacketBuffer1);
+
+/**
+ * \brief Set the share of the link of a virtual channel.
+ *
+ * \param[in] stack The stack to operate on.
+ * \param[in] vc The virtual channel.
+ * \param[in] weight The number of packets the virtual channel can send in a 
+ *            row when the other virtual channel also has packets to send, at 
+ *            least one. The default is one.
+ */
+void RIOSTACK_setVirtualChannelWeight(RioStack_t *stack, const uint8_t vc, const uint8_t weight);
+
+/**
+ * \brief Send a multicast-event-control-symbol.
+ *
+ * \param[in] stack The stack to operate on.
+ *
+ * The multicast-event is sent as the next symbol from RIOSTACK_portGetSymbol() 
+ * when the link is initialized, also if a packet is being sent. It is not 
+ * delayed by queued packets which makes it suitable to distribute time ticks. 
+ * A multicast-event that has not been sent yet is only sent once if this 
+ * function is called again.
+ */
+void RIOSTACK_sendMulticastEvent(RioStack_t *stack);
+
+/**
+ * \brief Set a handler for received multicast-event-control-symbols.
+ *
+ * \param[in] stack The stack to operate on.
+ * \param[in] handler The function to call. Use NULL to remove the handler.
+ * \param[in] context The context to call the handler with.
+ *
+ * The handler is called with the port time as soon as a multicast-event has 
+ * been received. The precision of the time is set by how often 
+ * RIOSTACK_portSetTime() is called, update it before each symbol is added to 
+ * get the time of the symbol.
+ */
+void RIOSTACK_setMulticastEventHandler(RioStack_t *stack, 
+                                       RioStackMulticastEventHandler_t handler, void *context);
+
+/**
+ * \brief Enable negotiation of extended ackIds.
+ *
+ * \param[in] stack The stack to operate on.
+ * \param[in] enable Non-zero to negotiate 6-bit ackIds, zero to always use 5-bit ackIds.
+ *
+ * With 5-bit ackIds at most 31 packets can be outstanding on the link, which may 
+ * not cover the round-trip time of long or slow links. When enabled, the stack 
+ * indicates support for 6-bit ackIds in the unused byte of its control symbols. 
+ * If the link-partner also indicates support during link initialization, 6-bit 
+ * ackIds are used in control symbols and packet headers and up to 63 packets can 
+ * be outstanding. Otherwise the link falls back to 5-bit ackIds.
+ *
+ * \note This must be set before RIOSTACK_portSetStatus() initializes the port. 
+ * The port must transfer all 32 bits of control symbols for the negotiation to 
+ * succeed. RIOUART_encodeSymbols() and RIOPCS_encodeSymbols() only transfer the 
+ * 24 bits of the control symbol itself, so a link that uses these codecs always 
+ * falls back to 5-bit ackIds.
+ */
+void RIOSTACK_setExtendedAckId(RioStack_t *stack, const uint8_t enable);
+
+/**
+ * \brief Check if extended ackIds are used.
+ *
+ * \param[in] stack The stack to operate on.
+ * \return Non-zero if 6-bit ackIds has been negotiated with the link-partner.
+ */
+uint8_t RIOSTACK_getExtendedAckId(const RioStack_t *stack);
+
+/**
+ * \brief Set the link training parameters.
+ *
+ * \param[in] stack The stack to operate on.
+ * \param[in] interval The number of idle symbols to send between 
+ * status-control-symbols until a status-control-symbol has been received.
+ * \param[in] intervalReceived The number of idle symbols to send between 
+ * status-control-symbols after a status-control-symbol has been received.
+ * \param[in] statusTx The number of status-control-symbols to send after a 
+ * status-control-symbol has been received.
+ * \param[in] statusRx The number of error-free status-control-symbols to 
+ * receive in a row before the one that completes the link initialization.
+ *
+ * The defaults are RIOSTACK_TRAINING_INTERVAL, 
+ * RIOSTACK_TRAINING_INTERVAL_RECEIVED, RIOSTACK_TRAINING_STATUS_TX and 
+ * RIOSTACK_TRAINING_STATUS_RX. The status counts are raised to these values if 
+ * they are lower, since they are the minimums of the standard. The intervals 
+ * can be lowered to make the link initialize faster on slow links, for example 
+ * a UART, at the cost of more control symbols on the link.
+ *
+ * \note This must be set before RIOSTACK_portSetStatus() initializes the port.
+ */
+void RIOSTACK_setLinkTraining(RioStack_t *stack, const uint8_t interval, const uint8_t intervalReceived, 
+                              const uint8_t statusTx, const uint8_t statusRx);
+
+/**
+ * \brief Use fast link training.
+ *
+ * \param[in] stack The stack to operate on.
+ *
+ * Status-control-symbols are sent back-to-back during link initialization and 
+ * only the minimum number of status-control-symbols of the standard are 
+ * required. The link partner does not need to use fast link training.
+ *
+ * \note This must be set before RIOSTACK_portSetStatus() initializes the port.
+ */
+void RIOSTACK_setLinkTrainingFast(RioStack_t *stack);
+
 /*******************************************************************************************
  * Port functions (backend API towards physical device)
  *******************************************************************************************/
@@ -505,9 +1099,24 @@ void RIOSTACK_portSetTimeout(RioStack_t *stack, const uint32_t timer);
  * symbols are ready to accept other symbols than idle-symbols. If the
  * encoding/decoding loses synchronization then this function should be called
  * with an argument equal to zero to force the stack to resynchronize the link.
+ *
+ * Packets that were transmitted but not acknowledged when the port went down are 
+ * transmitted again when the port is initialized. They can also be removed 
+ * using RIOSTACK_getOutboundPacket() while the port is down.
  */
 void RIOSTACK_portSetStatus(RioStack_t *stack, const uint8_t initialized);
 
+/**
+ * \brief Get a ports status.
+ * 
+ * \param[in] stack The stack to operate on.
+ * \return Non-zero if the port is initialized, zero if it is uninitialized.
+ *
+ * The port is uninitialized when RIOSTACK_portSetStatus() has been called with 
+ * an argument equal to zero or when the stack has given up on the link.
+ */
+uint8_t RIOSTACK_portGetStatus(const RioStack_t *stack);
+
 /**
  * \brief Add a new symbol to the RapidIO stack.
  *
@@ -0,0 +1,429 @@
+/******************************************************************************
+ * (C) Copyright 2013-2015 Magnus Rosenius and the Free Software Foundation.
+ *
+ * This file is part of OpenRIO.
+ *
+ * OpenRIO is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenRIO is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Lesser Public License
+ * along with OpenRIO.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+
+/******************************************************************************
+ * Description:
+ * This file contains segmentation and reassembly of data streaming PDUs.
+ * See riostream.h for more info.
+ *
+ * Any application specific tailoring needed to compile properly should be done
+ * in rioconfig.h.
+ ******************************************************************************/
+
+/*******************************************************************************
+ * Includes
+ *******************************************************************************/
+
+#include "riostream.h"
+
+/* Get definitions of ASSERT(), assumed to not return. */
+#include "rioconfig.h"
+
+
+/*******************************************************************************
+ * Local function prototypes
+ *******************************************************************************/
+
+/**
+ * \brief The inbound handler registered in the stack.
+ *
+ * \param[in] context The receiver.
+ * \param[in] stack The stack the packet was received on.
+ * \param[in] packet The received packet.
+ * \return Non-zero if the packet was consumed.
+ */
+static uint8_t inboundHandler(void *context, RioStack_t *stack, const RioPacket_t *packet);
+
+/**
+ * \brief Find the PDU that is being received from a source.
+ *
+ * \param[in] rx The receiver to operate on.
+ * \param[in] dstId The destination deviceId of the segment.
+ * \param[in] srcId The source deviceId of the segment.
+ * \param[in] cos The class of service of the segment.
+ * \return The PDU or NULL if no PDU is being received.
+ */
+static RioStreamPdu_t *findPdu(RioStreamRx_t *rx, 
+                               const uint16_t dstId, const uint16_t srcId, const uint8_t cos);
+
+/**
+ * \brief Start to receive a new PDU.
+ *
+ * \param[in] rx The receiver to operate on.
+ * \param[in] dstId The destination deviceId of the segment.
+ * \param[in] srcId The source deviceId of the segment.
+ * \param[in] cos The class of service of the segment.
+ * \param[in] streamId The streamID of the segment.
+ * \return The PDU or NULL if the PDU should be discarded.
+ */
+static RioStreamPdu_t *startPdu(RioStreamRx_t *rx, 
+                                const uint16_t dstId, const uint16_t srcId, const uint8_t cos,
+                                const uint16_t streamId);
+
+/**
+ * \brief Hand a PDU back to the application.
+ *
+ * \param[in] rx The receiver to operate on.
+ * \param[in] pdu The PDU.
+ * \param[in] status The status of the PDU.
+ */
+static void completePdu(RioStreamRx_t *rx, RioStreamPdu_t *pdu, const RioStreamStatus_t status);
+
+
+/*******************************************************************************
+ * Global functions
+ *******************************************************************************/
+
+void RIOSTREAM_txOpen(RioStreamTx_t *tx, const uint16_t dstId, const uint16_t srcId, 
+                      const uint8_t cos, const uint16_t streamId, const uint16_t mtu,
+                      const uint32_t length, const uint8_t *pdu)
+{
+  ASSERT(tx != NULL, "Invalid tx pointer");
+  ASSERT((mtu >= RIOSTREAM_MTU_MIN) && (mtu <= RIOSTREAM_MTU_MAX) && ((mtu & 3u) == 0u), 
+         "Invalid mtu");
+  ASSERT((length > 0ul) && (length <= RIOSTREAM_PDU_SIZE_MAX), "Invalid PDU length");
+
+  tx->dstId = dstId;
+  tx->srcId = srcId;
+  tx->cos = cos;
+  tx->streamId = streamId;
+  tx->mtu = mtu;
+  tx->pdu = pdu;
+  tx->length = length;
+  tx->offset = 0ul;
+}
+
+
+uint8_t RIOSTREAM_txIsDone(const RioStreamTx_t *tx)
+{
+  ASSERT(tx != NULL, "Invalid tx pointer");
+  return (tx->offset >= tx->length) ? 1u : 0u;
+}
+
+
+uint8_t RIOSTREAM_txGetSegment(RioStreamTx_t *tx, RioPacket_t *packet)
+{
+  uint8_t returnValue;
+  uint32_t remaining;
+  uint16_t size;
+  uint8_t segment;
+  uint16_t field;
+
+
+  ASSERT(tx != NULL, "Invalid tx pointer");
+
+  remaining = tx->length - tx->offset;
+  if(remaining == 0ul)
+  {
+    /* All segments has been created. */
+    returnValue = 0u;
+  }
+  else
+  {
+    /* Create the next segment. */
+    if(remaining > tx->mtu)
+    {
+      /* More segments will follow. */
+      size = tx->mtu;
+      if(tx->offset == 0ul)
+      {
+        segment = (uint8_t) RIOPACKET_SEGMENT_START;
+        field = tx->streamId;
+      }
+      else
+      {
+        segment = (uint8_t) RIOPACKET_SEGMENT_CONTINUATION;
+        field = 0u;
+      }
+    }
+    else
+    {
+      /* This is the last segment. */
+      size = (uint16_t) remaining;
+      if(tx->offset == 0ul)
+      {
+        segment = (uint8_t) RIOPACKET_SEGMENT_SINGLE;
+        field = tx->streamId;
+      }
+      else
+      {
+        /* A length of 65536 is sent as zero. */
+        segment = (uint8_t) RIOPACKET_SEGMENT_END;
+        field = (uint16_t) (tx->length & 0xfffful);
+      }
+    }
+
+    RIOPACKET_setDataStreaming(packet, tx->dstId, tx->srcId, tx->cos, segment, field, 
+                               size, &tx->pdu[tx->offset]);
+    tx->offset += size;
+    returnValue = 1u;
+  }
+
+  return returnValue;
+}
+
+
+uint16_t RIOSTREAM_txSend(RioStreamTx_t *tx, RioStack_t *stack)
+{
+  RioPacket_t packet;
+  uint16_t sent;
+
+
+  sent = 0u;
+  while((RIOSTACK_getOutboundQueueAvailable(stack) > 0u) && 
+        (RIOSTREAM_txGetSegment(tx, &packet) != 0u))
+  {
+    RIOSTACK_setOutboundPacket(stack, &packet);
+    sent++;
+  }
+
+  return sent;
+}
+
+
+void RIOSTREAM_rxOpen(RioStreamRx_t *rx, const uint16_t pdusSize, RioStreamPdu_t *pdus,
+                      RioStreamAllocate_t allocate, RioStreamComplete_t complete, void *context)
+{
+  uint16_t i;
+
+
+  ASSERT(rx != NULL, "Invalid rx pointer");
+  ASSERT((pdusSize == 0u) || (pdus != NULL), "Invalid pdus pointer");
+  ASSERT(allocate != NULL, "Invalid allocate function");
+  ASSERT(complete != NULL, "Invalid complete function");
+
+  rx->pdus = pdus;
+  rx->pdusSize = pdusSize;
+  rx->allocate = allocate;
+  rx->complete = complete;
+  rx->context = context;
+
+  for(i = 0u; i < pdusSize; i++)
+  {
+    pdus[i].active = 0u;
+  }
+
+  rx->statusPduComplete = 0ul;
+  rx->statusPduError = 0ul;
+  rx->statusSegmentDiscarded = 0ul;
+}
+
+
+void RIOSTREAM_rxAttach(RioStreamRx_t *rx, RioStack_t *stack)
+{
+  ASSERT(rx != NULL, "Invalid rx pointer");
+  RIOSTACK_setInboundHandler(stack, RIOPACKET_FTYPE_DATA_STREAMING, inboundHandler, rx);
+}
+
+
+uint8_t RIOSTREAM_rxReceive(RioStreamRx_t *rx, const RioPacket_t *packet)
+{
+  uint8_t returnValue;
+  RioStreamPdu_t *pdu;
+  uint16_t dstId;
+  uint16_t srcId;
+  uint8_t cos;
+  uint8_t segment;
+  uint16_t field;
+  uint16_t size;
+  uint32_t length;
+
+
+  ASSERT(rx != NULL, "Invalid rx pointer");
+
+  if((RIOPACKET_getFtype(packet) != (uint8_t) RIOPACKET_FTYPE_DATA_STREAMING) ||
+     (RIOPACKET_getTt(packet) != (uint8_t) RIOPACKET_TT_16BITS))
+  {
+    /* Not a data streaming segment with 16-bit deviceIds. */
+    returnValue = 0u;
+  }
+  else
+  {
+    /* Data streaming segment. */
+    dstId = RIOPACKET_getDestination(packet);
+    srcId = RIOPACKET_getSource(packet);
+    cos = RIOPACKET_getCos(packet);
+    segment = RIOPACKET_getSegment(packet);
+    size = RIOPACKET_getDataStreamingSize(packet);
+
+    pdu = findPdu(rx, dstId, srcId, cos);
+    if((segment == (uint8_t) RIOPACKET_SEGMENT_START) || (segment == (uint8_t) RIOPACKET_SEGMENT_SINGLE))
+    {
+      /* A new PDU starts, abort any unfinished PDU from the same source. */
+      if(pdu != NULL)
+      {
+        completePdu(rx, pdu, RIOSTREAM_STATUS_ABORTED);
+      }
+      else
+      {
+        /* Don't do anything. */
+      }
+      pdu = startPdu(rx, dstId, srcId, cos, RIOPACKET_getStreamId(packet));
+    }
+    else
+    {
+      /* Don't do anything. */
+    }
+
+    if(pdu == NULL)
+    {
+      /* No PDU to add the segment to. */
+      rx->statusSegmentDiscarded++;
+    }
+    else if((pdu->length + size) > pdu->size)
+    {
+      /* The segment does not fit in the buffer. */
+      rx->statusSegmentDiscarded++;
+      completePdu(rx, pdu, RIOSTREAM_STATUS_OVERFLOW);
+    }
+    else
+    {
+      /* Copy the payload directly into the buffer of the application. */
+      RIOPACKET_getDataStreaming(packet, &dstId, &srcId, &cos, &segment, &field, 
+                                 &size, &pdu->buffer[pdu->length]);
+      pdu->length += size;
+
+      if(segment == (uint8_t) RIOPACKET_SEGMENT_SINGLE)
+      {
+        completePdu(rx, pdu, RIOSTREAM_STATUS_OK);
+      }
+      else if(segment == (uint8_t) RIOPACKET_SEGMENT_END)
+      {
+        /* Check the length against the end segment, zero means 65536. */
+        length = (field == 0u) ? RIOSTREAM_PDU_SIZE_MAX : field;
+        completePdu(rx, pdu, (pdu->length == length) ? RIOSTREAM_STATUS_OK : RIOSTREAM_STATUS_LENGTH);
+      }
+      else
+      {
+        /* More segments will follow. */
+      }
+    }
+
+    returnValue = 1u;
+  }
+
+  return returnValue;
+}
+
+
+/*******************************************************************************
+ * Local functions
+ *******************************************************************************/
+
+static uint8_t inboundHandler(void *context, RioStack_t *stack, const RioPacket_t *packet)
+{
+  (void) stack;
+  return RIOSTREAM_rxReceive((RioStreamRx_t *) context, packet);
+}
+
+
+static RioStreamPdu_t *findPdu(RioStreamRx_t *rx, 
+                               const uint16_t dstId, const uint16_t srcId, const uint8_t cos)
+{
+  RioStreamPdu_t *found;
+  uint16_t i;
+
+
+  found = NULL;
+  for(i = 0u; (found == NULL) && (i < rx->pdusSize); i++)
+  {
+    if((rx->pdus[i].active != 0u) && 
+       (rx->pdus[i].srcId == srcId) && (rx->pdus[i].dstId == dstId) && (rx->pdus[i].cos == cos))
+    {
+      found = &rx->pdus[i];
+    }
+    else
+    {
+      /* Not this PDU. */
+    }
+  }
+
+  return found;
+}
+
+
+static RioStreamPdu_t *startPdu(RioStreamRx_t *rx, 
+                                const uint16_t dstId, const uint16_t srcId, const uint8_t cos,
+                                const uint16_t streamId)
+{
+  RioStreamPdu_t *found;
+  uint16_t i;
+
+
+  /* Find an unused PDU. */
+  found = NULL;
+  for(i = 0u; (found == NULL) && (i < rx->pdusSize); i++)
+  {
+    if(rx->pdus[i].active == 0u)
+    {
+      found = &rx->pdus[i];
+    }
+    else
+    {
+      /* This PDU is used. */
+    }
+  }
+
+  if(found != NULL)
+  {
+    /* Ask the application where to place the PDU. */
+    found->dstId = dstId;
+    found->srcId = srcId;
+    found->cos = cos;
+    found->streamId = streamId;
+    found->length = 0ul;
+    found->size = 0ul;
+    found->status = RIOSTREAM_STATUS_OK;
+    found->buffer = rx->allocate(rx->context, found, &found->size);
+    if(found->buffer != NULL)
+    {
+      found->active = 1u;
+    }
+    else
+    {
+      /* The application does not want the PDU. */
+      found = NULL;
+    }
+  }
+  else
+  {
+    /* All PDUs are used. */
+  }
+
+  return found;
+}
+
+
+static void completePdu(RioStreamRx_t *rx, RioStreamPdu_t *pdu, const RioStreamStatus_t status)
+{
+  pdu->status = status;
+  pdu->active = 0u;
+  if(status == RIOSTREAM_STATUS_OK)
+  {
+    rx->statusPduComplete++;
+  }
+  else
+  {
+    rx->statusPduError++;
+  }
+  rx->complete(rx->context, pdu);
+}
+
+/*************************** end of file **************************************/
@@ -0,0 +1,247 @@
+/******************************************************************************
+ * (C) Copyright 2013-2015 Magnus Rosenius and the Free Software Foundation.
+ *
+ * This file is part of OpenRIO.
+ *
+ * OpenRIO is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenRIO is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Lesser Public License
+ * along with OpenRIO.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+
+/******************************************************************************
+ * Description:
+ * This file contains segmentation and reassembly of data streaming PDUs.
+ *
+ * Data streaming (ftype 9) transfers PDUs of up to 64KiB as a sequence of 
+ * segments. A PDU that fits in one segment is sent as a single segment, 
+ * otherwise it is sent as a start segment, any number of continuation 
+ * segments and an end segment. All segments except the last contain exactly 
+ * MTU bytes. The start segment carries a streamID and the end segment the 
+ * total length of the PDU.
+ *
+ * The segments of a PDU are identified by their source, destination and class 
+ * of service. Segments from PDUs with different identification can be 
+ * interleaved, segments from one PDU must arrive in order.
+ *
+ * The transmitter reads the segment payloads directly from the PDU buffer of 
+ * the application. The receiver asks the application for a buffer when a new 
+ * PDU starts and copies the segment payloads directly from the received 
+ * packets into it. When the PDU is complete, or if it fails, the buffer is 
+ * handed back to the application.
+ *
+ * Typical usage:
+ *   Transmitter:
+ *   RIOSTREAM_txOpen(&tx, 0x0002, 0x0001, cos, streamId, 256, length, pdu);
+ *   while(!RIOSTREAM_txIsDone(&tx))
+ *   {
+ *     (void) RIOSTREAM_txSend(&tx, &stack);
+ *     <run the stack>
+ *   }
+ *
+ *   Receiver:
+ *   RIOSTREAM_rxOpen(&rx, CONTEXTS, contexts, allocateBuffer, pduReceived, &application);
+ *   RIOSTREAM_rxAttach(&rx, &stack);
+ *
+ * Any application specific tailoring needed to compile properly should be done
+ * in rioconfig.h.
+ ******************************************************************************/
+
+#ifndef __RIOSTREAM_H
+#define __RIOSTREAM_H
+
+/*******************************************************************************
+ * Include files.
+ *******************************************************************************/
+
+#include "rioconfig.h"
+#include "riopacket.h"
+#include "riostack.h"
+
+
+/*******************************************************************************
+ * Global macros.
+ *******************************************************************************/
+
+/** The largest PDU that can be transferred. */
+#define RIOSTREAM_PDU_SIZE_MAX 65536ul
+
+/** The smallest allowed MTU. */
+#define RIOSTREAM_MTU_MIN 32u
+
+/** The largest allowed MTU. */
+#define RIOSTREAM_MTU_MAX 256u
+
+
+/*******************************************************************************
+ * Global typedefs.
+ *******************************************************************************/
+
+/** The status of a received PDU. */
+typedef enum
+{
+  RIOSTREAM_STATUS_OK=0,          /**< The PDU was received correctly. */
+  RIOSTREAM_STATUS_OVERFLOW=1,    /**< The PDU did not fit in the buffer. */
+  RIOSTREAM_STATUS_LENGTH=2,      /**< The received length does not match the end segment. */
+  RIOSTREAM_STATUS_ABORTED=3      /**< A new PDU started before the end segment was received. */
+} RioStreamStatus_t;
+
+/** The transmitter of one PDU. */
+typedef struct
+{
+  uint16_t dstId; /**< The destination deviceId. */
+  uint16_t srcId; /**< The source deviceId. */
+  uint8_t cos; /**< The class of service. */
+  uint16_t streamId; /**< The streamID. */
+  uint16_t mtu; /**< The number of bytes in each segment. */
+  const uint8_t *pdu; /**< The PDU to send. */
+  uint32_t length; /**< The length of the PDU. */
+  uint32_t offset; /**< The number of bytes that has been segmented. */
+} RioStreamTx_t;
+
+/** A PDU that is being received. */
+typedef struct
+{
+  uint8_t active; /**< Non-zero if a PDU is being received. */
+  uint16_t dstId; /**< The destination deviceId. */
+  uint16_t srcId; /**< The source deviceId. */
+  uint8_t cos; /**< The class of service. */
+  uint16_t streamId; /**< The streamID. */
+  uint8_t *buffer; /**< The buffer the PDU is received into. */
+  uint32_t size; /**< The size of the buffer. */
+  uint32_t length; /**< The number of bytes that has been received. */
+  RioStreamStatus_t status; /**< The status of the PDU. */
+} RioStreamPdu_t;
+
+/**
+ * \brief Get a buffer to receive a PDU into.
+ *
+ * \param[in] context The context pointer given when the receiver was opened.
+ * \param[in] pdu The identification of the PDU that starts.
+ * \param[out] size The size of the returned buffer.
+ * \return The buffer to use or NULL to discard the PDU.
+ */
+typedef uint8_t *(*RioStreamAllocate_t)(void *context, const RioStreamPdu_t *pdu, uint32_t *size);
+
+/**
+ * \brief Receive a completed PDU.
+ *
+ * \param[in] context The context pointer given when the receiver was opened.
+ * \param[in] pdu The PDU. The buffer is handed back to the application.
+ */
+typedef void (*RioStreamComplete_t)(void *context, const RioStreamPdu_t *pdu);
+
+/** The structure to keep all the receiver variables. */
+typedef struct
+{
+  RioStreamPdu_t *pdus; /**< The storage of PDUs being received. */
+  uint16_t pdusSize; /**< The number of PDUs that can be received at the same time. */
+  RioStreamAllocate_t allocate; /**< The function to get buffers from. */
+  RioStreamComplete_t complete; /**< The function to hand received PDUs to. */
+  void *context; /**< The context to call the functions with. */
+
+  /** The number of PDUs that has been received correctly. */
+  uint32_t statusPduComplete;
+
+  /** The number of PDUs that has been received with errors. */
+  uint32_t statusPduError;
+
+  /** The number of segments that was discarded. */
+  uint32_t statusSegmentDiscarded;
+} RioStreamRx_t;
+
+
+/*******************************************************************************
+ * Global function prototypes.
+ *******************************************************************************/
+
+/**
+ * \brief Open a transmitter for a PDU.
+ *
+ * \param[in] tx The transmitter to operate on.
+ * \param[in] dstId The destination deviceId.
+ * \param[in] srcId The source deviceId.
+ * \param[in] cos The class of service.
+ * \param[in] streamId The streamID.
+ * \param[in] mtu The number of bytes in each segment. Must be a multiple of four 
+ *            between RIOSTREAM_MTU_MIN and RIOSTREAM_MTU_MAX.
+ * \param[in] length The length of the PDU, at most RIOSTREAM_PDU_SIZE_MAX.
+ * \param[in] pdu The PDU to send. It must be kept until all segments has been created.
+ */
+void RIOSTREAM_txOpen(RioStreamTx_t *tx, const uint16_t dstId, const uint16_t srcId, 
+                      const uint8_t cos, const uint16_t streamId, const uint16_t mtu,
+                      const uint32_t length, const uint8_t *pdu);
+
+/**
+ * \brief Check if all segments of a PDU has been created.
+ *
+ * \param[in] tx The transmitter to operate on.
+ * \return Non-zero if all segments has been created.
+ */
+uint8_t RIOSTREAM_txIsDone(const RioStreamTx_t *tx);
+
+/**
+ * \brief Create the next segment of a PDU.
+ *
+ * \param[in] tx The transmitter to operate on.
+ * \param[out] packet The segment.
+ * \return Non-zero if a segment was created, zero if all segments has been created.
+ */
+uint8_t RIOSTREAM_txGetSegment(RioStreamTx_t *tx, RioPacket_t *packet);
+
+/**
+ * \brief Send segments of a PDU.
+ *
+ * \param[in] tx The transmitter to operate on.
+ * \param[in] stack The stack to send the segments on.
+ * \return The number of segments that was placed in the outbound queue.
+ *
+ * This function places as many segments as fits in the outbound queue of the stack.
+ */
+uint16_t RIOSTREAM_txSend(RioStreamTx_t *tx, RioStack_t *stack);
+
+/**
+ * \brief Open a receiver for operation.
+ *
+ * \param[in] rx The receiver to operate on.
+ * \param[in] pdusSize The number of PDUs in the pdus storage.
+ * \param[in] pdus The storage to use for PDUs being received.
+ * \param[in] allocate The function to call to get a buffer for a new PDU.
+ * \param[in] complete The function to call when a PDU has been received or has failed.
+ * \param[in] context The context to call the functions with.
+ */
+void RIOSTREAM_rxOpen(RioStreamRx_t *rx, const uint16_t pdusSize, RioStreamPdu_t *pdus,
+                      RioStreamAllocate_t allocate, RioStreamComplete_t complete, void *context);
+
+/**
+ * \brief Start receiving segments from a stack.
+ *
+ * \param[in] rx The receiver to operate on.
+ * \param[in] stack The stack to receive segments from.
+ *
+ * This function registers the receiver as the inbound handler of data streaming 
+ * packets in the stack.
+ */
+void RIOSTREAM_rxAttach(RioStreamRx_t *rx, RioStack_t *stack);
+
+/**
+ * \brief Receive a segment.
+ *
+ * \param[in] rx The receiver to operate on.
+ * \param[in] packet The received packet.
+ * \return Non-zero if the packet was a data streaming segment, zero otherwise.
+ */
+uint8_t RIOSTREAM_rxReceive(RioStreamRx_t *rx, const RioPacket_t *packet);
+
+#endif /* __RIOSTREAM_H */
+
+/*************************** end of file **************************************/
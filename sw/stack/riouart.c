@@ -0,0 +1,263 @@
+/******************************************************************************
+ * (C) Copyright 2013-2015 Magnus Rosenius and the Free Software Foundation.
+ *
+ * This file is part of OpenRIO.
+ *
+ * OpenRIO is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenRIO is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Lesser Public License
+ * along with OpenRIO.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+/******************************************************************************
+ * Description:
+ * This file contains a codec for RioSymbols on an 8-bit UART channel.
+ * See riouart.h for more info.
+ *
+ * Any application specific tailoring needed to compile properly should be done
+ * in rioconfig.h.
+ ******************************************************************************/
+
+/*******************************************************************************
+ * Includes
+ *******************************************************************************/
+
+#include "riouart.h"
+
+/* Get definitions of ASSERT(), assumed to not return. */
+#include "rioconfig.h"
+
+
+/*******************************************************************************
+ * Local macros
+ *******************************************************************************/
+
+/* The value to xor stuffed octets with. */
+#define STUFFING_MASK 0x20u
+
+/* The number of symbols to decode at a time when adding them to a stack. */
+#define RECEIVE_BATCH 64u
+
+
+/*******************************************************************************
+ * Local function prototypes
+ *******************************************************************************/
+
+/**
+ * \brief Add an octet to a buffer, stuff it if needed.
+ *
+ * \param[in] octet The octet to add.
+ * \param[out] buffer The buffer to add the octet to.
+ * \return The number of bytes that was written.
+ */
+static uint32_t encodeOctet(const uint8_t octet, uint8_t *buffer);
+
+
+/*******************************************************************************
+ * Global functions
+ *******************************************************************************/
+
+void RIOUART_open(RioUart_t *uart)
+{
+  ASSERT(uart != NULL, "Invalid uart pointer");
+
+  uart->rxCounter = 0u;
+  uart->rxEscape = 0u;
+  uart->rxData = 0ul;
+
+  uart->statusRxError = 0ul;
+}
+
+
+uint32_t RIOUART_encodeSymbols(const uint32_t count, const RioSymbol_t *symbols, uint8_t *buffer)
+{
+  uint32_t i;
+  uint32_t index;
+  uint32_t data;
+
+
+  index = 0ul;
+  for(i = 0ul; i < count; i++)
+  {
+    data = symbols[i].data;
+    switch(symbols[i].type)
+    {
+      case RIOSTACK_SYMBOL_TYPE_CONTROL:
+        /* Send the three octets and terminate with a flag. */
+        index += encodeOctet((uint8_t) (data >> 16), &buffer[index]);
+        index += encodeOctet((uint8_t) (data >> 8), &buffer[index]);
+        index += encodeOctet((uint8_t) data, &buffer[index]);
+        buffer[index++] = RIOUART_FLAG;
+        break;
+      case RIOSTACK_SYMBOL_TYPE_DATA:
+        /* Send the four octets. */
+        index += encodeOctet((uint8_t) (data >> 24), &buffer[index]);
+        index += encodeOctet((uint8_t) (data >> 16), &buffer[index]);
+        index += encodeOctet((uint8_t) (data >> 8), &buffer[index]);
+        index += encodeOctet((uint8_t) data, &buffer[index]);
+        break;
+      default:
+        /* Send a flag. */
+        buffer[index++] = RIOUART_FLAG;
+        break;
+    }
+  }
+
+  return index;
+}
+
+
+uint32_t RIOUART_decodeSymbols(RioUart_t *uart, const uint32_t count,
+                               const uint8_t *buffer, RioSymbol_t *symbols)
+{
+  uint32_t i;
+  uint32_t index;
+  uint8_t incoming;
+
+
+  index = 0ul;
+  for(i = 0ul; i < count; i++)
+  {
+    incoming = buffer[i];
+
+    if(incoming == RIOUART_FLAG)
+    {
+      /* A flag ends a control symbol or is an idle symbol. */
+      if(uart->rxCounter == 0u)
+      {
+        symbols[index].type = RIOSTACK_SYMBOL_TYPE_IDLE;
+      }
+      else if(uart->rxCounter == 3u)
+      {
+        symbols[index].type = RIOSTACK_SYMBOL_TYPE_CONTROL;
+      }
+      else
+      {
+        symbols[index].type = RIOSTACK_SYMBOL_TYPE_ERROR;
+        uart->statusRxError++;
+      }
+      symbols[index].data = uart->rxData;
+      index++;
+
+      uart->rxData = 0ul;
+      uart->rxCounter = 0u;
+      uart->rxEscape = 0u;
+    }
+    else if(incoming == RIOUART_ESCAPE)
+    {
+      /* The next octet is stuffed. */
+      uart->rxEscape = 1u;
+    }
+    else
+    {
+      /* Octet in a symbol. */
+      if(uart->rxEscape)
+      {
+        incoming ^= STUFFING_MASK;
+        uart->rxEscape = 0u;
+      }
+      else
+      {
+        /* Don't do anything. */
+      }
+
+      uart->rxData = (uart->rxData << 8) | incoming;
+      uart->rxCounter++;
+
+      /* Check if a data symbol is complete. */
+      if(uart->rxCounter == 4u)
+      {
+        symbols[index].type = RIOSTACK_SYMBOL_TYPE_DATA;
+        symbols[index].data = uart->rxData;
+        index++;
+
+        uart->rxData = 0ul;
+        uart->rxCounter = 0u;
+      }
+      else
+      {
+        /* Don't do anything. */
+      }
+    }
+  }
+
+  return index;
+}
+
+
+uint32_t RIOUART_transmit(RioStack_t *stack, const uint32_t size, uint8_t *buffer)
+{
+  RioSymbol_t s;
+  uint32_t index;
+
+
+  ASSERT(stack != NULL, "Invalid stack pointer");
+
+  index = 0ul;
+  while((size - index) >= RIOUART_SYMBOL_SIZE_MAX)
+  {
+    s = RIOSTACK_portGetSymbol(stack);
+    index += RIOUART_encodeSymbols(1ul, &s, &buffer[index]);
+  }
+
+  return index;
+}
+
+
+void RIOUART_receive(RioUart_t *uart, RioStack_t *stack,
+                     const uint32_t count, const uint8_t *buffer)
+{
+  RioSymbol_t s[RECEIVE_BATCH];
+  uint32_t i;
+  uint32_t j;
+  uint32_t length;
+  uint32_t symbols;
+
+
+  ASSERT(stack != NULL, "Invalid stack pointer");
+
+  for(i = 0ul; i < count; i += length)
+  {
+    length = ((count - i) < RECEIVE_BATCH) ? (count - i) : RECEIVE_BATCH;
+    symbols = RIOUART_decodeSymbols(uart, length, &buffer[i], s);
+    for(j = 0ul; j < symbols; j++)
+    {
+      RIOSTACK_portAddSymbol(stack, s[j]);
+    }
+  }
+}
+
+
+/*******************************************************************************
+ * Local functions
+ *******************************************************************************/
+
+static uint32_t encodeOctet(const uint8_t octet, uint8_t *buffer)
+{
+  uint32_t returnValue;
+
+
+  if((octet != RIOUART_FLAG) && (octet != RIOUART_ESCAPE))
+  {
+    buffer[0] = octet;
+    returnValue = 1ul;
+  }
+  else
+  {
+    buffer[0] = RIOUART_ESCAPE;
+    buffer[1] = octet ^ STUFFING_MASK;
+    returnValue = 2ul;
+  }
+
+  return returnValue;
+}
+
+/*************************** end of file **************************************/
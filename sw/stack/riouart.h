@@ -0,0 +1,156 @@
+/******************************************************************************
+ * (C) Copyright 2013-2015 Magnus Rosenius and the Free Software Foundation.
+ *
+ * This file is part of OpenRIO.
+ *
+ * OpenRIO is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenRIO is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Lesser Public License
+ * along with OpenRIO.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+
+/******************************************************************************
+ * Description:
+ * This file contains a codec that serializes and deserializes RioSymbols onto
+ * and from an 8-bit UART transmission channel.
+ *
+ * The encoding is the same as in sw/codec/riocodecuart.c and
+ * rtl/vhdl/RioPcsUart.vhd. Idle symbols are sent as a flag (0x7e), control
+ * symbols as their three octets followed by a flag and data symbols as their
+ * four octets. Octets that are equal to the flag or the escape character
+ * (0x7d) are sent as the escape character followed by the octet xor 0x20.
+ *
+ * Unlike riocodecuart.c, the state is kept in a RioUart_t and whole buffers
+ * are encoded and decoded in one call to make it possible to use few system
+ * calls when the codec is connected to a device, see rioserial.h.
+ *
+ * Typical usage:
+ *   RIOUART_open(&uart);
+ *   n = RIOUART_transmit(&stack, sizeof(buffer), buffer);
+ *   <send n bytes>
+ *   <receive m bytes>
+ *   RIOUART_receive(&uart, &stack, m, buffer);
+ *
+ * Any application specific tailoring needed to compile properly should be done
+ * in rioconfig.h.
+ ******************************************************************************/
+
+#ifndef __RIOUART_H
+#define __RIOUART_H
+
+/*******************************************************************************
+ * Include files.
+ *******************************************************************************/
+
+#include "rioconfig.h"
+#include "riostack.h"
+
+
+/*******************************************************************************
+ * Global macros.
+ *******************************************************************************/
+
+/** The flag that ends control symbols and is sent as idle symbol. */
+#define RIOUART_FLAG 0x7eu
+
+/** The escape character that precedes stuffed octets. */
+#define RIOUART_ESCAPE 0x7du
+
+/** The largest number of bytes that one symbol is encoded into. */
+#define RIOUART_SYMBOL_SIZE_MAX 8u
+
+
+/*******************************************************************************
+ * Global typedefs.
+ *******************************************************************************/
+
+/** The structure to keep all the codec variables. */
+typedef struct
+{
+  /* Receiver variables. */
+  uint8_t rxCounter;
+  uint8_t rxEscape;
+  uint32_t rxData;
+
+  /** The number of error symbols that has been decoded. */
+  uint32_t statusRxError;
+} RioUart_t;
+
+
+/*******************************************************************************
+ * Global function prototypes.
+ *******************************************************************************/
+
+/**
+ * \brief Open a codec.
+ *
+ * \param[in] uart The codec to operate on.
+ */
+void RIOUART_open(RioUart_t *uart);
+
+/**
+ * \brief Encode symbols into bytes.
+ *
+ * \param[in] count The number of symbols to encode.
+ * \param[in] symbols The symbols to encode.
+ * \param[out] buffer The encoded bytes. Must have room for
+ * RIOUART_SYMBOL_SIZE_MAX*count bytes.
+ * \return The number of bytes that was written.
+ *
+ * Error symbols are encoded as idle symbols. Only the lower 24 bits of control 
+ * symbols are encoded, the extended ackId byte is not transferred.
+ */
+uint32_t RIOUART_encodeSymbols(const uint32_t count, const RioSymbol_t *symbols, uint8_t *buffer);
+
+/**
+ * \brief Decode bytes into symbols.
+ *
+ * \param[in] uart The codec to operate on.
+ * \param[in] count The number of bytes to decode.
+ * \param[in] buffer The bytes to decode.
+ * \param[out] symbols The decoded symbols. Must have room for count entries.
+ * \return The number of symbols that was written.
+ *
+ * A symbol that is not complete when the bytes ends is completed by the next
+ * call. A flag that ends a symbol with one or two octets is decoded as an
+ * error symbol.
+ */
+uint32_t RIOUART_decodeSymbols(RioUart_t *uart, const uint32_t count,
+                               const uint8_t *buffer, RioSymbol_t *symbols);
+
+/**
+ * \brief Get symbols from a stack and encode them.
+ *
+ * \param[in] stack The stack to get symbols from.
+ * \param[in] size The size of the buffer.
+ * \param[out] buffer The encoded bytes.
+ * \return The number of bytes that was written.
+ *
+ * Symbols are fetched from the stack as long as the largest encoded symbol
+ * fits in the buffer.
+ */
+uint32_t RIOUART_transmit(RioStack_t *stack, const uint32_t size, uint8_t *buffer);
+
+/**
+ * \brief Decode bytes and add the symbols to a stack.
+ *
+ * \param[in] uart The codec to operate on.
+ * \param[in] stack The stack to add the symbols to.
+ * \param[in] count The number of bytes.
+ * \param[in] buffer The bytes to decode.
+ */
+void RIOUART_receive(RioUart_t *uart, RioStack_t *stack,
+                     const uint32_t count, const uint8_t *buffer);
+
+#endif
+
+/*************************** end of file **************************************/
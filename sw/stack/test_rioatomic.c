@@ -0,0 +1,231 @@
+/******************************************************************************
+ * (C) Copyright 2013-2015 Magnus Rosenius and the Free Software Foundation.
+ *
+ * This file is part of OpenRIO.
+ *
+ * OpenRIO is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenRIO is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Lesser Public License
+ * along with OpenRIO.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+
+/******************************************************************************
+ * Description:
+ * Unit tests for rioatomic.c.
+ ******************************************************************************/
+
+
+#define MODULE_TEST
+#include "rioatomic.c"
+#include "riopacket.c"
+#include <CUnit/CUnit.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define PrintS(s) printf(s "\n")
+
+#define TESTSTART(s) printf(s "...")
+#define TESTEND printf(" done.\n");
+
+#define TESTCOND(got) CU_ASSERT(got)
+#define TESTEXPR(got, expected) CU_ASSERT_EQUAL((got), (expected))
+
+#define BASE 0x00100000ul
+#define WORDS 4
+
+int TEST_numExpectedAssertsRemaining = 0;
+
+static RioAtomic_t atomic;
+static uint32_t memory[WORDS];
+
+/* Execute a request and return the old value from the response. */
+static uint32_t execute(const RioPacket_t *request, uint32_t address)
+{
+  RioPacket_t response;
+  uint16_t dstid;
+  uint16_t srcid;
+  uint8_t tid;
+  uint8_t payload[4];
+
+  TESTEXPR(RIOATOMIC_execute(&atomic, request, &response), 1);
+  TESTCOND(RIOPACKET_valid(&response));
+  TESTEXPR(RIOPACKET_getTransaction(&response), RIOPACKET_TRANSACTION_RESPONSE_WITH_PAYLOAD);
+  TESTEXPR(RIOPACKET_getResponseWithPayload(&response, &dstid, &srcid, &tid, 
+                                            address & 0x7, 4, payload), 4);
+  TESTEXPR(dstid, 0x0002);
+  TESTEXPR(srcid, 0x0001);
+  TESTEXPR(tid, 0x42);
+
+  return ((uint32_t) payload[0] << 24) | ((uint32_t) payload[1] << 16) | 
+    ((uint32_t) payload[2] << 8) | (uint32_t) payload[3];
+}
+
+/*******************************************************************************
+ * Module test for this file.
+ *******************************************************************************/
+
+static void allTests(void)
+{
+  RioPacket_t request;
+  RioPacket_t response;
+  uint16_t dstid;
+  uint16_t srcid;
+  uint8_t tid;
+  uint8_t status;
+  uint8_t payload[4] = {0, 0, 0, 0};
+
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("TG_rioatomic");
+  PrintS("----------------------------------------------------------------------");
+  PrintS("TG_rioatomic-TC1");
+  PrintS("Description: Test execution of atomic operations.");
+  PrintS("Requirement: XXXXX");
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 1:");
+  PrintS("Action: Execute increment, decrement, set and clear requests.");
+  PrintS("Result: The memory should be updated and the old value returned.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_rioatomic-TC1-Step1");
+  /******************************************************************************/
+
+  memory[0] = 0x00000010ul;
+  memory[1] = 0x00000000ul;
+  memory[2] = 0x12345678ul;
+  memory[3] = 0x87654321ul;
+  RIOATOMIC_open(&atomic, BASE, sizeof(memory), memory);
+
+  RIOPACKET_setAtomicRequest(&request, 0x0001, 0x0002, 0x42, RIOPACKET_TRANSACTION_REQUEST_ATOMIC_INC, BASE);
+  TESTEXPR(execute(&request, BASE), 0x00000010ul);
+  TESTEXPR(execute(&request, BASE), 0x00000011ul);
+  TESTEXPR(memory[0], 0x00000012ul);
+
+  RIOPACKET_setAtomicRequest(&request, 0x0001, 0x0002, 0x42, RIOPACKET_TRANSACTION_REQUEST_ATOMIC_DEC, BASE+4);
+  TESTEXPR(execute(&request, BASE+4), 0x00000000ul);
+  TESTEXPR(memory[1], 0xfffffffful);
+
+  RIOPACKET_setAtomicRequest(&request, 0x0001, 0x0002, 0x42, RIOPACKET_TRANSACTION_REQUEST_ATOMIC_SET, BASE+8);
+  TESTEXPR(execute(&request, BASE+8), 0x12345678ul);
+  TESTEXPR(memory[2], 0xfffffffful);
+
+  RIOPACKET_setAtomicRequest(&request, 0x0001, 0x0002, 0x42, RIOPACKET_TRANSACTION_REQUEST_ATOMIC_CLR, BASE+12);
+  TESTEXPR(execute(&request, BASE+12), 0x87654321ul);
+  TESTEXPR(memory[3], 0x00000000ul);
+
+  TESTEXPR(atomic.statusExecuted, 5);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 2:");
+  PrintS("Action: Execute swap, compare-and-swap and test-and-swap requests.");
+  PrintS("Result: The memory should be updated if the condition is met and the ");
+  PrintS("old value returned.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_rioatomic-TC1-Step2");
+  /******************************************************************************/
+
+  RIOPACKET_setAtomicWrite(&request, 0x0001, 0x0002, 0x42, RIOPACKET_TRANSACTION_WRITE_ATOMIC_SWAP, 
+                           BASE+4, 0xdeadbeef, 0);
+  TESTEXPR(execute(&request, BASE+4), 0xfffffffful);
+  TESTEXPR(memory[1], 0xdeadbeeful);
+
+  RIOPACKET_setAtomicWrite(&request, 0x0001, 0x0002, 0x42, RIOPACKET_TRANSACTION_WRITE_ATOMIC_COMPARE_AND_SWAP, 
+                           BASE+4, 0x01234567, 0xdeadbeef);
+  TESTEXPR(execute(&request, BASE+4), 0xdeadbeeful);
+  TESTEXPR(memory[1], 0x01234567ul);
+  TESTEXPR(execute(&request, BASE+4), 0x01234567ul);
+  TESTEXPR(memory[1], 0x01234567ul);
+
+  RIOPACKET_setAtomicWrite(&request, 0x0001, 0x0002, 0x42, RIOPACKET_TRANSACTION_WRITE_ATOMIC_TEST_AND_SWAP, 
+                           BASE+12, 0x00000001, 0);
+  TESTEXPR(execute(&request, BASE+12), 0x00000000ul);
+  TESTEXPR(memory[3], 0x00000001ul);
+  RIOPACKET_setAtomicWrite(&request, 0x0001, 0x0002, 0x42, RIOPACKET_TRANSACTION_WRITE_ATOMIC_TEST_AND_SWAP, 
+                           BASE+12, 0x00000002, 0);
+  TESTEXPR(execute(&request, BASE+12), 0x00000001ul);
+  TESTEXPR(memory[3], 0x00000001ul);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 3:");
+  PrintS("Action: Execute requests outside the window and other packets.");
+  PrintS("Result: Requests outside the window should be answered with ERROR and ");
+  PrintS("other packets should be ignored.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_rioatomic-TC1-Step3");
+  /******************************************************************************/
+
+  RIOPACKET_setAtomicRequest(&request, 0x0001, 0x0002, 0x42, RIOPACKET_TRANSACTION_REQUEST_ATOMIC_INC, BASE+16);
+  TESTEXPR(RIOATOMIC_execute(&atomic, &request, &response), 1);
+  RIOPACKET_getResponseNoPayload(&response, &dstid, &srcid, &tid, &status);
+  TESTEXPR(RIOPACKET_getFtype(&response), RIOPACKET_FTYPE_RESPONSE);
+  TESTEXPR(dstid, 0x0002);
+  TESTEXPR(srcid, 0x0001);
+  TESTEXPR(tid, 0x42);
+  TESTEXPR(status, RIOPACKET_RESPONSE_STATUS_ERROR);
+
+  RIOPACKET_setAtomicWrite(&request, 0x0001, 0x0002, 0x42, RIOPACKET_TRANSACTION_WRITE_ATOMIC_SWAP, 
+                           BASE-4, 0, 0);
+  TESTEXPR(RIOATOMIC_execute(&atomic, &request, &response), 1);
+  RIOPACKET_getResponseNoPayload(&response, &dstid, &srcid, &tid, &status);
+  TESTEXPR(status, RIOPACKET_RESPONSE_STATUS_ERROR);
+  TESTEXPR(atomic.statusError, 2);
+
+  RIOPACKET_setNread(&request, 0x0001, 0x0002, 0x42, BASE, 4);
+  TESTEXPR(RIOATOMIC_execute(&atomic, &request, &response), 0);
+  RIOPACKET_setNwrite(&request, 0x0001, 0x0002, BASE, 4, payload);
+  TESTEXPR(RIOATOMIC_execute(&atomic, &request, &response), 0);
+  RIOPACKET_setDoorbell(&request, 0x0001, 0x0002, 0x42, 0x1234);
+  TESTEXPR(RIOATOMIC_execute(&atomic, &request, &response), 0);
+  TESTEXPR(atomic.statusExecuted, 10);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+}
+
+CU_ErrorCode addTests( void )
+{
+  if( CUE_SUCCESS != CU_initialize_registry() )
+  {
+    return CU_get_error();
+  }
+
+  CU_pSuite suite = CU_add_suite( "RIOATOMICTEST", NULL, NULL );
+  if( NULL == suite )
+  {
+    CU_cleanup_registry();
+    return CU_get_error();
+  }
+
+  CU_add_test( suite, "allTests", &allTests );
+
+  return CUE_SUCCESS;
+}
+
+
+int main(int argc, char argv[])
+{
+  addTests();
+  CU_basic_run_tests();
+  return CU_get_error();
+}
+
+
+/*************************** end of file **************************************/
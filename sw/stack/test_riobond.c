@@ -0,0 +1,515 @@
+/******************************************************************************
+ * (C) Copyright 2013-2015 Magnus Rosenius and the Free Software Foundation.
+ *
+ * This file is part of OpenRIO.
+ *
+ * OpenRIO is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenRIO is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Lesser Public License
+ * along with OpenRIO.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+
+/******************************************************************************
+ * Description:
+ * Unit tests for riobond.c.
+ ******************************************************************************/
+
+
+#define MODULE_TEST
+#include <CUnit/CUnit.h>
+#include <stdio.h>
+#include <string.h>
+#include "riobond.c"
+#include "riostack.c"
+#include "riopacket.c"
+#include "riopool.c"
+
+#define PrintS(s) printf(s "\n")
+
+#define TESTSTART(s) printf(s "...")
+#define TESTEND printf(" done.\n");
+
+#define TESTCOND(got) CU_ASSERT(got)
+#define TESTEXPR(got, expected) CU_ASSERT_EQUAL((got), (expected))
+
+#define QUEUE_LENGTH 8
+#define MEMBERS 4
+#define PACKETS 400
+#define FLOWS 16
+#define TICKS_MAX 10000000ul
+
+int TEST_numExpectedAssertsRemaining = 0;
+
+static RioBond_t bondA;
+static RioBond_t bondB;
+
+static RioStack_t stackA[MEMBERS];
+static uint32_t rxPacketBufferA[MEMBERS][RIOSTACK_BUFFER_SIZE * QUEUE_LENGTH];
+static uint32_t txPacketBufferA[MEMBERS][RIOSTACK_BUFFER_SIZE * QUEUE_LENGTH];
+static RioStack_t stackB[MEMBERS];
+static uint32_t rxPacketBufferB[MEMBERS][RIOSTACK_BUFFER_SIZE * QUEUE_LENGTH];
+static uint32_t txPacketBufferB[MEMBERS][RIOSTACK_BUFFER_SIZE * QUEUE_LENGTH];
+
+static uint8_t payload[256];
+static uint32_t txSequence[FLOWS];
+static uint32_t rxSequence[FLOWS];
+static uint32_t outOfOrder;
+static uint32_t lost;
+static uint32_t doorbellsConsumed;
+
+/* An inbound handler that consumes all doorbells. */
+static uint8_t consumeDoorbell(void *context, RioStack_t *stack, const RioPacket_t *packet)
+{
+  (void) context;
+  (void) stack;
+  (void) packet;
+  doorbellsConsumed++;
+  return 1;
+}
+
+/* Exchange symbols on the links that are up. */
+static void runLinks(uint8_t members, int symbols)
+{
+  int i;
+  uint8_t j;
+
+  for(i = 0; i < symbols; i++)
+  {
+    for(j = 0; j < members; j++)
+    {
+      RIOSTACK_portAddSymbol(&stackB[j], RIOSTACK_portGetSymbol(&stackA[j]));
+      RIOSTACK_portAddSymbol(&stackA[j], RIOSTACK_portGetSymbol(&stackB[j]));
+    }
+  }
+}
+
+/* Open bonds with a number of members and bring up their links. */
+static void startBonds(uint8_t members)
+{
+  uint8_t i;
+
+  RIOBOND_open(&bondA);
+  RIOBOND_open(&bondB);
+  for(i = 0; i < members; i++)
+  {
+    RIOSTACK_open(&stackA[i], NULL,
+        RIOSTACK_BUFFER_SIZE*QUEUE_LENGTH, rxPacketBufferA[i],
+        RIOSTACK_BUFFER_SIZE*QUEUE_LENGTH, txPacketBufferA[i]);
+    RIOSTACK_open(&stackB[i], NULL,
+        RIOSTACK_BUFFER_SIZE*QUEUE_LENGTH, rxPacketBufferB[i],
+        RIOSTACK_BUFFER_SIZE*QUEUE_LENGTH, txPacketBufferB[i]);
+    RIOSTACK_portSetTimeout(&stackA[i], 1000);
+    RIOSTACK_portSetTimeout(&stackB[i], 1000);
+    RIOSTACK_portSetStatus(&stackA[i], 1);
+    RIOSTACK_portSetStatus(&stackB[i], 1);
+    TESTCOND(RIOBOND_addMember(&bondA, &stackA[i]));
+    TESTCOND(RIOBOND_addMember(&bondB, &stackB[i]));
+  }
+
+  while((RIOBOND_getLinksInitialized(&bondA) != members) ||
+        (RIOBOND_getLinksInitialized(&bondB) != members))
+  {
+    runLinks(members, 1);
+  }
+
+  memset(txSequence, 0, sizeof(txSequence));
+  memset(rxSequence, 0, sizeof(rxSequence));
+  outOfOrder = 0;
+  lost = 0;
+}
+
+/* Read the received NWRITE packets and check that each flow is in order. The 
+   destination is the flow and the address is eight times the sequence 
+   number. Count 
+   the packets that are missing. */
+static uint32_t receiveNwrites(void)
+{
+  RioPacket_t packet;
+  uint16_t dstId;
+  uint16_t srcId;
+  uint32_t address;
+  uint16_t size;
+  uint8_t data[256];
+  uint32_t received;
+
+  received = 0;
+  while(RIOBOND_getInboundQueueLength(&bondB) > 0)
+  {
+    RIOBOND_getInboundPacket(&bondB, &packet);
+    RIOPACKET_getNwrite(&packet, &dstId, &srcId, &address, &size, data);
+    address >>= 3;
+    if((dstId >= FLOWS) || (address < rxSequence[dstId]))
+    {
+      outOfOrder++;
+    }
+    else
+    {
+      lost += address - rxSequence[dstId];
+      rxSequence[dstId] = address + 1;
+    }
+    received++;
+  }
+
+  return received;
+}
+
+/* Send NWRITE packets on a number of flows over the bond and return the 
+   number of link symbols it took to receive them. */
+static uint32_t sendNwrites(uint8_t members, uint32_t packets, uint16_t flows)
+{
+  RioPacket_t packet;
+  uint32_t ticks;
+  uint32_t sent;
+  uint32_t received;
+  uint16_t flow;
+
+  sent = 0;
+  received = 0;
+  for(ticks = 0; (received < packets) && (ticks < TICKS_MAX); ticks++)
+  {
+    while(sent < packets)
+    {
+      flow = (uint16_t) (sent % flows);
+      RIOPACKET_setNwrite(&packet, flow, 0xffff, txSequence[flow] << 3, sizeof(payload), payload);
+      if(RIOBOND_setOutboundPacket(&bondA, &packet))
+      {
+        txSequence[flow]++;
+        sent++;
+      }
+      else
+      {
+        break;
+      }
+    }
+
+    runLinks(members, 1);
+    received += receiveNwrites();
+  }
+
+  return ticks;
+}
+
+/*******************************************************************************
+ * Module test for this file.
+ *******************************************************************************/
+
+static void allTests(void)
+{
+  RioPacket_t packet;
+  RioPacket_t packetOther;
+  uint16_t dstId;
+  uint16_t srcId;
+  uint8_t tid;
+  uint16_t info;
+  uint32_t ticks1;
+  uint32_t ticks4;
+  uint32_t sent;
+  uint32_t received;
+  uint32_t i;
+  uint8_t used;
+
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("TG_riobond");
+  PrintS("----------------------------------------------------------------------");
+  PrintS("TG_riobond-TC1");
+  PrintS("Description: Test striping of packets over the members of a bond.");
+  PrintS("Requirement: XXXXX");
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 1:");
+  PrintS("Action: Send NWRITE packets on many flows over a bond with one ");
+  PrintS("        member and over a bond with four members.");
+  PrintS("Result: All packets should be received in order within each flow. ");
+  PrintS("        All members should be used and the transfer should be close ");
+  PrintS("        to four times faster.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riobond-TC1-Step1");
+  /******************************************************************************/
+
+  startBonds(1);
+  ticks1 = sendNwrites(1, PACKETS, FLOWS);
+  TESTCOND(ticks1 < TICKS_MAX);
+  TESTEXPR(outOfOrder, 0);
+  TESTEXPR(lost, 0);
+  TESTEXPR(bondA.statusPacketsSent[0], PACKETS);
+
+  startBonds(MEMBERS);
+  ticks4 = sendNwrites(MEMBERS, PACKETS, FLOWS);
+  TESTCOND(ticks4 < TICKS_MAX);
+  TESTEXPR(outOfOrder, 0);
+  TESTEXPR(lost, 0);
+  for(i = 0; i < FLOWS; i++)
+  {
+    TESTEXPR(rxSequence[i], PACKETS / FLOWS);
+  }
+  for(i = 0; i < MEMBERS; i++)
+  {
+    TESTCOND(bondA.statusPacketsSent[i] > PACKETS / (2*MEMBERS));
+  }
+  TESTCOND(ticks4 * 10 < ticks1 * 3);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 2:");
+  PrintS("Action: Send NWRITE packets on one flow over a bond with four members.");
+  PrintS("Result: All packets should be received in order.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riobond-TC1-Step2");
+  /******************************************************************************/
+
+  startBonds(MEMBERS);
+  TESTCOND(sendNwrites(MEMBERS, PACKETS, 1) < TICKS_MAX);
+  TESTEXPR(outOfOrder, 0);
+  TESTEXPR(rxSequence[0], PACKETS);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 3:");
+  PrintS("Action: Send doorbells to one destination with four ranges of ");
+  PrintS("        transaction identifiers with and without a tid mask.");
+  PrintS("Result: Without the mask, all doorbells should be in one flow. With ");
+  PrintS("        the mask, the ranges should be spread over the members and ");
+  PrintS("        each range should be received in order.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riobond-TC1-Step3");
+  /******************************************************************************/
+
+  startBonds(MEMBERS);
+  RIOPACKET_setDoorbell(&packet, 0x0001, 0xffff, 0x00, 0);
+  RIOPACKET_setDoorbell(&packetOther, 0x0001, 0xffff, 0xc0, 0);
+  TESTCOND(getFlow(&bondA, &packet) == getFlow(&bondA, &packetOther));
+  RIOBOND_setFlowTidMask(&bondA, 0xc0);
+  TESTCOND(getFlow(&bondA, &packet) != getFlow(&bondA, &packetOther));
+
+  sent = 0;
+  received = 0;
+  for(i = 0; (received < PACKETS) && (i < TICKS_MAX); i++)
+  {
+    while(sent < PACKETS)
+    {
+      RIOPACKET_setDoorbell(&packet, 0x0001, 0xffff, (uint8_t) ((sent % 4) << 6), (uint16_t) (sent / 4));
+      if(RIOBOND_setOutboundPacket(&bondA, &packet))
+      {
+        sent++;
+      }
+      else
+      {
+        break;
+      }
+    }
+    runLinks(MEMBERS, 1);
+    while(RIOBOND_getInboundQueueLength(&bondB) > 0)
+    {
+      RIOBOND_getInboundPacket(&bondB, &packet);
+      RIOPACKET_getDoorbell(&packet, &dstId, &srcId, &tid, &info);
+      TESTEXPR(info, rxSequence[tid >> 6]);
+      rxSequence[tid >> 6]++;
+      received++;
+    }
+  }
+  TESTEXPR(received, PACKETS);
+  used = 0;
+  for(i = 0; i < MEMBERS; i++)
+  {
+    if(bondA.statusPacketsSent[i] > 0)
+    {
+      used++;
+    }
+  }
+  TESTCOND(used > 1);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("TG_riobond-TC2");
+  PrintS("Description: Test a bond where member links go down.");
+  PrintS("Requirement: XXXXX");
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 1:");
+  PrintS("Action: Take the link of one member down while NWRITE packets are ");
+  PrintS("        sent on many flows.");
+  PrintS("Result: The packets queued on the member and its flows should be ");
+  PrintS("        moved to the other members. All packets should be received in ");
+  PrintS("        order, also when the link comes back and is used again.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riobond-TC2-Step1");
+  /******************************************************************************/
+
+  startBonds(MEMBERS);
+  (void) sendNwrites(MEMBERS, PACKETS / 2, FLOWS);
+  TESTEXPR(outOfOrder, 0);
+
+  /* Queue packets on all members, then take one link down. */
+  for(i = 0; i < FLOWS; i++)
+  {
+    RIOPACKET_setNwrite(&packet, (uint16_t) i, 0xffff, txSequence[i] << 3, sizeof(payload), payload);
+    TESTCOND(RIOBOND_setOutboundPacket(&bondA, &packet));
+    txSequence[i]++;
+  }
+  TESTCOND(RIOSTACK_getOutboundQueueLength(&stackA[1]) > 0);
+  RIOSTACK_portSetStatus(&stackA[1], 0);
+  RIOSTACK_portSetStatus(&stackB[1], 0);
+  TESTEXPR(RIOBOND_getLinksInitialized(&bondA), MEMBERS - 1);
+
+  /* Send more packets on the remaining members. The packets that were queued 
+     on the member are moved ahead of them. */
+  sent = bondA.statusPacketsSent[1];
+  (void) sendNwrites(MEMBERS, PACKETS, FLOWS);
+  for(i = 0; i < 10000; i++)
+  {
+    runLinks(MEMBERS, 1);
+    (void) receiveNwrites();
+  }
+  TESTEXPR(RIOSTACK_getOutboundQueueLength(&stackA[1]), 0);
+  TESTEXPR(outOfOrder, 0);
+  TESTEXPR(lost, 0);
+  TESTCOND(bondA.statusFlowsMoved > 0);
+  TESTEXPR(bondA.statusPacketsSent[1], sent);
+  for(i = 0; i < FLOWS; i++)
+  {
+    TESTEXPR(rxSequence[i], txSequence[i]);
+  }
+
+  /* Bring the link back and check that the member is used again. */
+  RIOSTACK_portSetStatus(&stackA[1], 1);
+  RIOSTACK_portSetStatus(&stackB[1], 1);
+  while(RIOBOND_getLinksInitialized(&bondA) != MEMBERS)
+  {
+    runLinks(MEMBERS, 1);
+  }
+  TESTCOND(sendNwrites(MEMBERS, PACKETS, FLOWS) < TICKS_MAX);
+  TESTEXPR(outOfOrder, 0);
+  TESTEXPR(lost, 0);
+  TESTCOND(bondA.statusPacketsSent[1] > sent);
+  for(i = 0; i < FLOWS; i++)
+  {
+    TESTEXPR(rxSequence[i], txSequence[i]);
+  }
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 2:");
+  PrintS("Action: Take the links of all members down.");
+  PrintS("Result: No packets should be accepted by the bond.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riobond-TC2-Step2");
+  /******************************************************************************/
+
+  for(i = 0; i < MEMBERS; i++)
+  {
+    RIOSTACK_portSetStatus(&stackA[i], 0);
+  }
+  TESTEXPR(RIOBOND_getLinksInitialized(&bondA), 0);
+  RIOPACKET_setNwrite(&packet, 0, 0xffff, 0, sizeof(payload), payload);
+  TESTEXPR(RIOBOND_setOutboundPacket(&bondA, &packet), 0);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("TG_riobond-TC3");
+  PrintS("Description: Test the bond limits.");
+  PrintS("Requirement: XXXXX");
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 1:");
+  PrintS("Action: Add too many members and read from an empty bond.");
+  PrintS("Result: The member should not be added and reading should assert.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riobond-TC3-Step1");
+  /******************************************************************************/
+
+  TESTEXPR(RIOBOND_addMember(&bondB, &stackA[0]), 0);
+  TESTEXPR(RIOBOND_getInboundQueueLength(&bondB), 0);
+  TEST_numExpectedAssertsRemaining = 1;
+  RIOBOND_getInboundPacket(&bondB, &packet);
+  TESTEXPR(TEST_numExpectedAssertsRemaining, 0);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 2:");
+  PrintS("Action: Add members that already have a doorbell handler and send a ");
+  PrintS("        doorbell and an NWRITE.");
+  PrintS("Result: The doorbell should be consumed by the handler and only the ");
+  PrintS("        NWRITE should be read from the bond.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riobond-TC3-Step2");
+  /******************************************************************************/
+
+  startBonds(1);
+  RIOBOND_open(&bondB);
+  RIOSTACK_setInboundHandler(&stackB[0], RIOPACKET_FTYPE_DOORBELL, consumeDoorbell, NULL);
+  TESTCOND(RIOBOND_addMember(&bondB, &stackB[0]));
+  doorbellsConsumed = 0;
+
+  RIOPACKET_setDoorbell(&packet, 0x0001, 0xffff, 0x00, 0x1234);
+  TESTCOND(RIOBOND_setOutboundPacket(&bondA, &packet));
+  RIOPACKET_setNwrite(&packet, 0, 0xffff, 0, sizeof(payload), payload);
+  TESTCOND(RIOBOND_setOutboundPacket(&bondA, &packet));
+  for(i = 0; i < 1000; i++)
+  {
+    runLinks(1, 1);
+  }
+  TESTEXPR(doorbellsConsumed, 1);
+  TESTEXPR(RIOBOND_getInboundQueueLength(&bondB), 1);
+  TESTEXPR(receiveNwrites(), 1);
+  TESTEXPR(outOfOrder, 0);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+}
+
+
+CU_ErrorCode addTests( void )
+{
+  if( CUE_SUCCESS != CU_initialize_registry() )
+  {
+    return CU_get_error();
+  }
+
+  CU_pSuite suite = CU_add_suite( "RIOBONDTEST", NULL, NULL );
+  if( NULL == suite )
+  {
+    CU_cleanup_registry();
+    return CU_get_error();
+  }
+
+  CU_add_test( suite, "allTests", &allTests );
+
+  return CUE_SUCCESS;
+}
+
+
+int main(int argc, char argv[])
+{
+  addTests();
+  CU_basic_run_tests();
+  return CU_get_error();
+}
+
+/*************************** end of file **************************************/
@@ -0,0 +1,493 @@
+/******************************************************************************
+ * (C) Copyright 2013-2015 Magnus Rosenius and the Free Software Foundation.
+ *
+ * This file is part of OpenRIO.
+ *
+ * OpenRIO is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenRIO is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Lesser Public License
+ * along with OpenRIO.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+
+
+/******************************************************************************
+ * Description:
+ * Unit tests for riocsr.c.
+ ******************************************************************************/
+
+
+#define MODULE_TEST
+#include <CUnit/CUnit.h>
+#include <stdio.h>
+#include "riocsr.c"
+#include "riostack.c"
+#include "riopacket.c"
+#include "riopool.c"
+
+#define PrintS(s) printf(s "\n")
+
+#define TESTSTART(s) printf(s "...")
+#define TESTEND printf(" done.\n");
+
+#define TESTCOND(got) CU_ASSERT(got)
+#define TESTEXPR(got, expected) CU_ASSERT_EQUAL((got), (expected))
+
+#define QUEUE_LENGTH 8
+
+#define LP_SERIAL 0x0100ul
+#define ERROR_MANAGEMENT 0x0200ul
+
+int TEST_numExpectedAssertsRemaining = 0;
+
+static RioCsr_t csr;
+static int otherPackets;
+
+#include "test_riolink.h"
+
+/* A maintenance handler registered before the provider. */
+static uint8_t otherHandler(void *context, RioStack_t *stack, const RioPacket_t *packet)
+{
+  TESTCOND(context == &otherPackets);
+  otherPackets++;
+  return 1;
+}
+
+/* Open the stacks and bring up the link. The provider presents stackB. */
+static void startProvider(void)
+{
+  openLink();
+  RIOCSR_open(&csr, &stackB, LP_SERIAL, ERROR_MANAGEMENT);
+  TESTCOND(connectLink());
+}
+
+/* Read a register of stackB from stackA using a maintenance read. */
+static uint32_t maintRead(uint32_t offset)
+{
+  RioPacket_t packet;
+  uint16_t dstId, srcId;
+  uint8_t tid, status;
+  uint32_t data;
+
+  RIOPACKET_setMaintReadRequest(&packet, 0x0002, 0x0001, 0xff, 0x12, offset);
+  RIOSTACK_setOutboundPacket(&stackA, &packet);
+  runLink(200);
+
+  TESTEXPR(RIOSTACK_getInboundQueueLength(&stackA), 1);
+  RIOSTACK_getInboundPacket(&stackA, &packet);
+  TESTEXPR(RIOPACKET_getTransaction(&packet), RIOPACKET_TRANSACTION_MAINT_READ_RESPONSE);
+  RIOPACKET_getMaintReadResponse(&packet, &dstId, &srcId, &tid, &status, &data);
+  TESTEXPR(dstId, 0x0001);
+  TESTEXPR(srcId, 0x0002);
+  TESTEXPR(tid, 0x12);
+  TESTEXPR(status, 0);
+
+  return data;
+}
+
+/* Write a register of stackB from stackA using a maintenance write. */
+static void maintWrite(uint32_t offset, uint32_t data)
+{
+  RioPacket_t packet;
+  uint16_t dstId, srcId;
+  uint8_t tid, status;
+
+  RIOPACKET_setMaintWriteRequest(&packet, 0x0002, 0x0001, 0xff, 0x34, offset, data);
+  RIOSTACK_setOutboundPacket(&stackA, &packet);
+  runLink(200);
+
+  TESTEXPR(RIOSTACK_getInboundQueueLength(&stackA), 1);
+  RIOSTACK_getInboundPacket(&stackA, &packet);
+  TESTEXPR(RIOPACKET_getTransaction(&packet), RIOPACKET_TRANSACTION_MAINT_WRITE_RESPONSE);
+  RIOPACKET_getMaintWriteResponse(&packet, &dstId, &srcId, &tid, &status);
+  TESTEXPR(dstId, 0x0001);
+  TESTEXPR(srcId, 0x0002);
+  TESTEXPR(tid, 0x34);
+  TESTEXPR(status, 0);
+}
+
+/* Read a register using the API. */
+static uint32_t csrRead(uint32_t offset)
+{
+  uint32_t data;
+
+  data = 0xdeadbeef;
+  TESTCOND(RIOCSR_read(&csr, offset, &data));
+
+  return data;
+}
+
+/*******************************************************************************
+ * Module test for this file.
+ *******************************************************************************/
+
+static void allTests(void)
+{
+  RioPacket_t packet;
+  uint32_t data;
+  uint32_t offset;
+  int i;
+
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("TG_riocsr");
+  PrintS("----------------------------------------------------------------------");
+  PrintS("TG_riocsr-TC1");
+  PrintS("Description: Test the registers using the API.");
+  PrintS("Requirement: XXXXX");
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 1:");
+  PrintS("Action: Read the block headers and the registers of an initialized ");
+  PrintS("        link.");
+  PrintS("Result: The extended features list should contain the LP-Serial ");
+  PrintS("        and error management blocks and the port should be OK with ");
+  PrintS("        no errors.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riocsr-TC1-Step1");
+  /******************************************************************************/
+
+  RIOSTACK_open(&stackB, NULL,
+      RIOSTACK_BUFFER_SIZE*QUEUE_LENGTH, rxPacketBufferB,
+      RIOSTACK_BUFFER_SIZE*QUEUE_LENGTH, txPacketBufferB);
+  RIOCSR_open(&csr, &stackB, LP_SERIAL, ERROR_MANAGEMENT);
+  TESTEXPR(csrRead(LP_SERIAL+0x58), RIOCSR_PORT_UNINITIALIZED);
+
+  startProvider();
+
+  TESTEXPR(csrRead(LP_SERIAL), (ERROR_MANAGEMENT << 16) | 0x0001);
+  TESTEXPR(csrRead(ERROR_MANAGEMENT), 0x00000007);
+  TESTEXPR(csrRead(LP_SERIAL+0x20), 1000ul << 8);
+  TESTEXPR(csrRead(LP_SERIAL+0x48), 0);
+  TESTEXPR(csrRead(LP_SERIAL+0x58), RIOCSR_PORT_OK);
+  TESTEXPR(csrRead(LP_SERIAL+0x5c), 0x00600001);
+  TESTEXPR(csrRead(ERROR_MANAGEMENT+0x40), 0);
+
+  /* Unaligned offsets read the register they are in. */
+  TESTEXPR(csrRead(LP_SERIAL+0x5b), RIOCSR_PORT_OK);
+
+  /* Unimplemented registers in the blocks read as zero. */
+  for(offset = 0x04; offset < RIOCSR_LP_SERIAL_SIZE; offset += 4)
+  {
+    if((offset != 0x20) && (offset != 0x3c) && (offset != 0x48) && 
+       (offset != 0x58) && (offset != 0x5c))
+    {
+      TESTEXPR(csrRead(LP_SERIAL+offset), 0);
+    }
+  }
+  TESTEXPR(csrRead(ERROR_MANAGEMENT+0x7c), 0);
+
+  /* Outside of the blocks. */
+  TESTEXPR(RIOCSR_read(&csr, LP_SERIAL-4, &data), 0);
+  TESTEXPR(RIOCSR_read(&csr, LP_SERIAL+RIOCSR_LP_SERIAL_SIZE, &data), 0);
+  TESTEXPR(RIOCSR_read(&csr, ERROR_MANAGEMENT+RIOCSR_ERROR_MANAGEMENT_SIZE, &data), 0);
+  TESTEXPR(RIOCSR_write(&csr, 0x0000, 0), 0);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 2:");
+  PrintS("Action: Write the registers.");
+  PrintS("Result: The plain registers should keep their values, the link ");
+  PrintS("        timeout should be set in the stack and writes to read-only ");
+  PrintS("        registers should be ignored.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riocsr-TC1-Step2");
+  /******************************************************************************/
+
+  TESTCOND(RIOCSR_write(&csr, LP_SERIAL+0x20, 0x00012300));
+  TESTEXPR(stackB.portTimeout, 0x123);
+  TESTEXPR(csrRead(LP_SERIAL+0x20), 0x00012300);
+
+  TESTCOND(RIOCSR_write(&csr, LP_SERIAL+0x3c, 0xe0000000));
+  TESTEXPR(csrRead(LP_SERIAL+0x3c), 0xe0000000);
+  TESTCOND(RIOCSR_write(&csr, ERROR_MANAGEMENT+0x28, 0x00ab0000));
+  TESTEXPR(csrRead(ERROR_MANAGEMENT+0x28), 0x00ab0000);
+  TESTCOND(RIOCSR_write(&csr, ERROR_MANAGEMENT+0x44, 0x00400001));
+  TESTEXPR(csrRead(ERROR_MANAGEMENT+0x44), 0x00400001);
+
+  TESTCOND(RIOCSR_write(&csr, LP_SERIAL, 0xffffffff));
+  TESTEXPR(csrRead(LP_SERIAL), (ERROR_MANAGEMENT << 16) | 0x0001);
+  TESTCOND(RIOCSR_write(&csr, LP_SERIAL+0x48, 0xffffffff));
+  TESTEXPR(csrRead(LP_SERIAL+0x48), 0);
+  TESTCOND(RIOCSR_write(&csr, LP_SERIAL+0x58, 0xffffffff));
+  TESTEXPR(csrRead(LP_SERIAL+0x58), RIOCSR_PORT_OK);
+  TESTCOND(RIOCSR_write(&csr, LP_SERIAL+0x04, 0xffffffff));
+  TESTEXPR(csrRead(LP_SERIAL+0x04), 0);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 3:");
+  PrintS("Action: Open a provider with invalid offsets.");
+  PrintS("Result: An assert should be raised.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riocsr-TC1-Step3");
+  /******************************************************************************/
+
+  TEST_numExpectedAssertsRemaining = 1;
+  RIOCSR_open(&csr, &stackB, 0x10000, ERROR_MANAGEMENT);
+  TESTEXPR(TEST_numExpectedAssertsRemaining, 0);
+
+  TEST_numExpectedAssertsRemaining = 1;
+  RIOCSR_open(&csr, &stackB, LP_SERIAL, LP_SERIAL+0x40);
+  TESTEXPR(TEST_numExpectedAssertsRemaining, 0);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("TG_riocsr-TC2");
+  PrintS("Description: Test the registers using maintenance packets.");
+  PrintS("Requirement: XXXXX");
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 1:");
+  PrintS("Action: Send maintenance read and write requests to the blocks.");
+  PrintS("Result: The requests should be answered by the receiver of the ");
+  PrintS("        stack and not be placed in its inbound queue.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riocsr-TC2-Step1");
+  /******************************************************************************/
+
+  startProvider();
+  RIOCSR_attach(&csr, &stackB);
+
+  TESTEXPR(maintRead(LP_SERIAL), (ERROR_MANAGEMENT << 16) | 0x0001);
+  TESTEXPR(maintRead(LP_SERIAL+0x58), RIOCSR_PORT_OK);
+  maintWrite(LP_SERIAL+0x3c, 0x80000000);
+  TESTEXPR(csr.portGeneralControl, 0x80000000);
+  TESTEXPR(maintRead(LP_SERIAL+0x3c), 0x80000000);
+
+  /* Four requests have been received and answered by stackB before this 
+     one. */
+  TESTEXPR(maintRead(LP_SERIAL+0x48), 0x04000404);
+
+  TESTEXPR(csr.statusReads, 4);
+  TESTEXPR(csr.statusWrites, 1);
+  TESTEXPR(csr.statusDropped, 0);
+  TESTEXPR(RIOSTACK_getInboundQueueLength(&stackB), 0);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 2:");
+  PrintS("Action: Send maintenance packets that are not requests to the ");
+  PrintS("        blocks.");
+  PrintS("Result: The packets should be placed in the inbound queue.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riocsr-TC2-Step2");
+  /******************************************************************************/
+
+  RIOPACKET_setMaintReadRequest(&packet, 0x0002, 0x0001, 0xff, 0x00, 0x0000);
+  RIOSTACK_setOutboundPacket(&stackA, &packet);
+  RIOPACKET_setMaintReadResponse(&packet, 0x0002, 0x0001, 0x00, 0, 0x12345678);
+  RIOSTACK_setOutboundPacket(&stackA, &packet);
+  RIOPACKET_setMaintPortWrite(&packet, 0x0002, 0x0001, 0, 0, 0, 0, 0);
+  RIOSTACK_setOutboundPacket(&stackA, &packet);
+  runLink(300);
+
+  TESTEXPR(RIOSTACK_getInboundQueueLength(&stackA), 0);
+  TESTEXPR(RIOSTACK_getInboundQueueLength(&stackB), 3);
+  TESTEXPR(csr.statusReads, 4);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 3:");
+  PrintS("Action: Attach the provider after another maintenance handler.");
+  PrintS("Result: Requests should be answered and other packets should be ");
+  PrintS("        forwarded to the other handler.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riocsr-TC2-Step3");
+  /******************************************************************************/
+
+  startProvider();
+  otherPackets = 0;
+  RIOSTACK_setInboundHandler(&stackB, RIOPACKET_FTYPE_MAINTENANCE, otherHandler, &otherPackets);
+  RIOCSR_attach(&csr, &stackB);
+
+  RIOPACKET_setMaintPortWrite(&packet, 0x0002, 0x0001, 0xc0de, 0x00080000, 0, 0x03, 0);
+  RIOSTACK_setOutboundPacket(&stackA, &packet);
+  runLink(200);
+  TESTEXPR(maintRead(ERROR_MANAGEMENT), 0x00000007);
+  RIOPACKET_setMaintReadRequest(&packet, 0x0002, 0x0001, 0xff, 0x00, 0x0000);
+  RIOSTACK_setOutboundPacket(&stackA, &packet);
+  runLink(200);
+
+  TESTEXPR(otherPackets, 2);
+  TESTEXPR(csr.statusReads, 1);
+  TESTEXPR(RIOSTACK_getInboundQueueLength(&stackB), 0);
+  TESTEXPR(RIOSTACK_getInboundQueueLength(&stackA), 0);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 4:");
+  PrintS("Action: Send read requests when the outbound queue of the stack is ");
+  PrintS("        full.");
+  PrintS("Result: The requests should be counted as dropped.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riocsr-TC2-Step4");
+  /******************************************************************************/
+
+  RIOPACKET_setDoorbell(&packet, 0x0001, 0x0002, 0, 0);
+  while(RIOSTACK_getOutboundQueueAvailable(&stackB) > 0)
+  {
+    RIOSTACK_setOutboundPacket(&stackB, &packet);
+  }
+  RIOPACKET_setMaintReadRequest(&packet, 0x0002, 0x0001, 0xff, 0x00, LP_SERIAL);
+  TESTCOND(RIOCSR_receive(&csr, &stackB, &packet));
+  TESTEXPR(csr.statusDropped, 1);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("TG_riocsr-TC3");
+  PrintS("Description: Test the error bits.");
+  PrintS("Requirement: XXXXX");
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 1:");
+  PrintS("Action: Send an erroneous symbol to the stack.");
+  PrintS("Result: The port should be input error-stopped and the input ");
+  PrintS("        error-encountered and illegal character bits should be set.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riocsr-TC3-Step1");
+  /******************************************************************************/
+
+  startProvider();
+  RIOSTACK_portAddSymbol(&stackB, (RioSymbol_t) {RIOSTACK_SYMBOL_TYPE_ERROR, 0});
+  TESTEXPR(csrRead(LP_SERIAL+0x58), 
+           RIOCSR_PORT_OK | RIOCSR_INPUT_ERROR_STOPPED | RIOCSR_INPUT_ERROR_ENCOUNTERED);
+  TESTEXPR(csrRead(ERROR_MANAGEMENT+0x40), RIOCSR_DETECT_ILLEGAL_CHARACTER);
+
+  /* The port recovers but the encountered and detected errors remain. */
+  runLink(200);
+  TESTEXPR(csrRead(LP_SERIAL+0x58), RIOCSR_PORT_OK | RIOCSR_INPUT_ERROR_ENCOUNTERED);
+  TESTEXPR(csrRead(ERROR_MANAGEMENT+0x40), RIOCSR_DETECT_ILLEGAL_CHARACTER);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 2:");
+  PrintS("Action: Clear the error bits.");
+  PrintS("Result: The encountered bits should be cleared by writing ones and ");
+  PrintS("        the detect bits by writing zeros.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riocsr-TC3-Step2");
+  /******************************************************************************/
+
+  TESTCOND(RIOCSR_write(&csr, LP_SERIAL+0x58, 0));
+  TESTEXPR(csrRead(LP_SERIAL+0x58), RIOCSR_PORT_OK | RIOCSR_INPUT_ERROR_ENCOUNTERED);
+  TESTCOND(RIOCSR_write(&csr, LP_SERIAL+0x58, RIOCSR_INPUT_ERROR_ENCOUNTERED));
+  TESTEXPR(csrRead(LP_SERIAL+0x58), RIOCSR_PORT_OK);
+
+  TESTCOND(RIOCSR_write(&csr, ERROR_MANAGEMENT+0x40, 0xffffffff));
+  TESTEXPR(csrRead(ERROR_MANAGEMENT+0x40), RIOCSR_DETECT_ILLEGAL_CHARACTER);
+  TESTCOND(RIOCSR_write(&csr, ERROR_MANAGEMENT+0x40, 0));
+  TESTEXPR(csrRead(ERROR_MANAGEMENT+0x40), 0);
+
+  /* The counters of the stack are not changed. */
+  TESTEXPR(stackB.statusInboundErrorIllegalCharacter, 1);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 3:");
+  PrintS("Action: Let the link partner report errors and retries.");
+  PrintS("Result: The output error- and retry-encountered bits and the ");
+  PrintS("        corresponding detect bits should be set.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riocsr-TC3-Step3");
+  /******************************************************************************/
+
+  RIOSTACK_portAddSymbol(&stackA, (RioSymbol_t) {RIOSTACK_SYMBOL_TYPE_ERROR, 0});
+  runLink(200);
+  TESTEXPR(csrRead(LP_SERIAL+0x58), RIOCSR_PORT_OK | RIOCSR_OUTPUT_ERROR_ENCOUNTERED);
+  TESTEXPR(csrRead(ERROR_MANAGEMENT+0x40), RIOCSR_DETECT_PACKET_NOT_ACCEPTED);
+
+  stackB.statusOutboundPacketRetry++;
+  stackB.statusOutboundErrorTimeout++;
+  stackB.statusOutboundErrorPacketAccepted++;
+  stackB.statusInboundErrorControlCrc++;
+  stackB.statusInboundErrorPacketCrc++;
+  stackB.statusInboundErrorPacketAckId++;
+  stackB.statusInboundErrorGeneral++;
+  TESTEXPR(csrRead(LP_SERIAL+0x58), 
+           RIOCSR_PORT_OK | RIOCSR_INPUT_ERROR_ENCOUNTERED |
+           RIOCSR_OUTPUT_ERROR_ENCOUNTERED | RIOCSR_OUTPUT_RETRY_ENCOUNTERED);
+  TESTEXPR(csrRead(ERROR_MANAGEMENT+0x40), 
+           RIOCSR_DETECT_LINK_TIMEOUT | RIOCSR_DETECT_PACKET_SIZE | 
+           RIOCSR_DETECT_PACKET_CRC | RIOCSR_DETECT_PACKET_ACKID | 
+           RIOCSR_DETECT_PACKET_NOT_ACCEPTED | RIOCSR_DETECT_ACKNOWLEDGE_ACKID | 
+           RIOCSR_DETECT_CONTROL_CRC);
+
+  /* Clear one bit at a time. */
+  data = csrRead(ERROR_MANAGEMENT+0x40);
+  for(i = 0; i < 32; i++)
+  {
+    data &= ~(1ul << i);
+    TESTCOND(RIOCSR_write(&csr, ERROR_MANAGEMENT+0x40, data));
+    TESTEXPR(csrRead(ERROR_MANAGEMENT+0x40), data);
+  }
+  TESTCOND(RIOCSR_write(&csr, LP_SERIAL+0x58, 0xffffffff));
+  TESTEXPR(csrRead(LP_SERIAL+0x58), RIOCSR_PORT_OK);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+}
+
+CU_ErrorCode addTests( void )
+{
+  if( CUE_SUCCESS != CU_initialize_registry() )
+  {
+    return CU_get_error();
+  }
+
+  CU_pSuite suite = CU_add_suite( "RIOCSRTEST", NULL, NULL );
+  if( NULL == suite )
+  {
+    CU_cleanup_registry();
+    return CU_get_error();
+  }
+
+  CU_add_test( suite, "allTests", &allTests );
+
+  return CUE_SUCCESS;
+}
+
+
+int main(int argc, char argv[])
+{
+  addTests();
+  CU_basic_run_tests();
+  return CU_get_error();
+}
+
+
+/*************************** end of file **************************************/
@@ -0,0 +1,325 @@
+/******************************************************************************
+ * (C) Copyright 2013-2015 Magnus Rosenius and the Free Software Foundation.
+ *
+ * This file is part of OpenRIO.
+ *
+ * OpenRIO is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenRIO is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Lesser Public License
+ * along with OpenRIO.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+/******************************************************************************
+ * Description:
+ * Unit tests for riodispatch.c.
+ ******************************************************************************/
+
+
+#define MODULE_TEST
+#include "riodispatch.c"
+#include "riostack.c"
+#include "riopacket.c"
+#include "riopool.c"
+#include <CUnit/CUnit.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PrintS(s) printf(s "\n")
+
+#define TESTSTART(s) printf(s "...")
+#define TESTEND printf(" done.\n");
+
+#define TESTCOND(got) CU_ASSERT(got)
+#define TESTEXPR(got, expected) CU_ASSERT_EQUAL((got), (expected))
+
+#define QUEUE_LENGTH 8
+
+int TEST_numExpectedAssertsRemaining = 0;
+
+static RioDispatch_t dispatch;
+
+#include "test_riolink.h"
+
+/* Information about the last handler call. */
+static int handlerCalls;
+static void *handlerContext;
+static RioDispatchHeader_t handlerHeader;
+static RioPacket_t handlerPacket;
+
+static void testHandler(void *context, const RioDispatchHeader_t *header, const RioPacket_t *packet)
+{
+  handlerCalls++;
+  handlerContext = context;
+  handlerHeader = *header;
+  handlerPacket = *packet;
+}
+
+static void handlerClear(void)
+{
+  handlerCalls = 0;
+  handlerContext = NULL;
+  memset(&handlerHeader, 0xff, sizeof(handlerHeader));
+}
+
+/*******************************************************************************
+ * Module test for this file.
+ *******************************************************************************/
+
+static void allTests(void)
+{
+  RioPacket_t packet;
+  uint8_t payload[8];
+  int contexts[4];
+  int i;
+
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("TG_riodispatch");
+  PrintS("----------------------------------------------------------------------");
+  PrintS("TG_riodispatch-TC1");
+  PrintS("Description: Test dispatching of single packets.");
+  PrintS("Requirement: XXXXX");
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 1:");
+  PrintS("Action: Dispatch packets without any registered handlers.");
+  PrintS("Result: The default handler should be called.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riodispatch-TC1-Step1");
+  /******************************************************************************/
+
+  RIODISPATCH_open(&dispatch, testHandler, &contexts[0]);
+
+  handlerClear();
+  RIOPACKET_setMaintReadRequest(&packet, 0x1234, 0x5678, 0xff, 0x9a, 0x00000100);
+  TESTEXPR(RIODISPATCH_dispatch(&dispatch, &packet), 0);
+  TESTEXPR(handlerCalls, 1);
+  TESTEXPR(handlerContext, &contexts[0]);
+  TESTEXPR(handlerHeader.ftype, RIOPACKET_FTYPE_MAINTENANCE);
+  TESTEXPR(handlerHeader.transaction, RIOPACKET_TRANSACTION_MAINT_READ_REQUEST);
+  TESTEXPR(handlerHeader.destination, 0x1234);
+  TESTEXPR(handlerHeader.source, 0x5678);
+  TESTEXPR(handlerHeader.tid, 0x9a);
+  TESTEXPR(handlerPacket.size, packet.size);
+  TESTEXPR(dispatch.statusPacketUnhandled, 1);
+  TESTEXPR(dispatch.statusPacketHandled, 0);
+
+  RIODISPATCH_open(&dispatch, NULL, NULL);
+  handlerClear();
+  TESTEXPR(RIODISPATCH_dispatch(&dispatch, &packet), 0);
+  TESTEXPR(handlerCalls, 0);
+  TESTEXPR(dispatch.statusPacketUnhandled, 1);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 2:");
+  PrintS("Action: Register handlers for ftype/transaction pairs.");
+  PrintS("Result: Only the matching handler should be called with its context and ");
+  PrintS("the decoded header.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riodispatch-TC1-Step2");
+  /******************************************************************************/
+
+  RIODISPATCH_open(&dispatch, NULL, NULL);
+  RIODISPATCH_setHandler(&dispatch, RIOPACKET_FTYPE_MAINTENANCE, RIOPACKET_TRANSACTION_MAINT_READ_REQUEST,
+                         testHandler, &contexts[1]);
+  RIODISPATCH_setHandler(&dispatch, RIOPACKET_FTYPE_RESPONSE, RIOPACKET_TRANSACTION_RESPONSE_NO_PAYLOAD,
+                         testHandler, &contexts[2]);
+
+  handlerClear();
+  RIOPACKET_setMaintReadRequest(&packet, 0x1234, 0x5678, 0xff, 0x9a, 0x00000100);
+  TESTEXPR(RIODISPATCH_dispatch(&dispatch, &packet), 1);
+  TESTEXPR(handlerCalls, 1);
+  TESTEXPR(handlerContext, &contexts[1]);
+
+  handlerClear();
+  RIOPACKET_setResponseNoPayload(&packet, 0x0001, 0x0002, 0x03, RIOPACKET_RESPONSE_STATUS_DONE);
+  TESTEXPR(RIODISPATCH_dispatch(&dispatch, &packet), 1);
+  TESTEXPR(handlerCalls, 1);
+  TESTEXPR(handlerContext, &contexts[2]);
+  TESTEXPR(handlerHeader.ftype, RIOPACKET_FTYPE_RESPONSE);
+  TESTEXPR(handlerHeader.transaction, RIOPACKET_TRANSACTION_RESPONSE_NO_PAYLOAD);
+  TESTEXPR(handlerHeader.destination, 0x0001);
+  TESTEXPR(handlerHeader.source, 0x0002);
+  TESTEXPR(handlerHeader.tid, 0x03);
+
+  handlerClear();
+  RIOPACKET_setMaintWriteRequest(&packet, 0x1234, 0x5678, 0xff, 0x9a, 0x00000100, 0);
+  TESTEXPR(RIODISPATCH_dispatch(&dispatch, &packet), 0);
+  TESTEXPR(handlerCalls, 0);
+
+  RIODISPATCH_setHandler(&dispatch, RIOPACKET_FTYPE_MAINTENANCE, RIOPACKET_TRANSACTION_MAINT_READ_REQUEST,
+                         NULL, NULL);
+  RIOPACKET_setMaintReadRequest(&packet, 0x1234, 0x5678, 0xff, 0x9a, 0x00000100);
+  TESTEXPR(RIODISPATCH_dispatch(&dispatch, &packet), 0);
+  TESTEXPR(handlerCalls, 0);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 3:");
+  PrintS("Action: Register mailbox handlers.");
+  PrintS("Result: Messages should be dispatched on mailbox and fall back to the ");
+  PrintS("ftype handler.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riodispatch-TC1-Step3");
+  /******************************************************************************/
+
+  memset(payload, 0, sizeof(payload));
+  RIODISPATCH_open(&dispatch, NULL, NULL);
+  RIODISPATCH_setMailboxHandler(&dispatch, 0x12, testHandler, &contexts[1]);
+
+  handlerClear();
+  RIOPACKET_setMessage(&packet, 0x0001, 0x0002, 0x12, sizeof(payload), payload);
+  TESTEXPR(RIODISPATCH_dispatch(&dispatch, &packet), 1);
+  TESTEXPR(handlerContext, &contexts[1]);
+  TESTEXPR(handlerHeader.ftype, RIOPACKET_FTYPE_MESSAGE);
+  TESTEXPR(handlerHeader.transaction, 0);
+  TESTEXPR(handlerHeader.tid, 0);
+
+  handlerClear();
+  RIOPACKET_setMessage(&packet, 0x0001, 0x0002, 0x13, sizeof(payload), payload);
+  TESTEXPR(RIODISPATCH_dispatch(&dispatch, &packet), 0);
+  TESTEXPR(handlerCalls, 0);
+
+  RIODISPATCH_setFtypeHandler(&dispatch, RIOPACKET_FTYPE_MESSAGE, testHandler, &contexts[2]);
+  handlerClear();
+  TESTEXPR(RIODISPATCH_dispatch(&dispatch, &packet), 1);
+  TESTEXPR(handlerContext, &contexts[2]);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 4:");
+  PrintS("Action: Register doorbell info ranges.");
+  PrintS("Result: Doorbells should be dispatched to the first matching range and ");
+  PrintS("fall back to the ftype handler.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riodispatch-TC1-Step4");
+  /******************************************************************************/
+
+  RIODISPATCH_open(&dispatch, NULL, NULL);
+  TESTEXPR(RIODISPATCH_setDoorbellHandler(&dispatch, 0x0000, 0x00ff, testHandler, &contexts[1]), 1);
+  TESTEXPR(RIODISPATCH_setDoorbellHandler(&dispatch, 0x0080, 0x01ff, testHandler, &contexts[2]), 1);
+  RIODISPATCH_setFtypeHandler(&dispatch, RIOPACKET_FTYPE_DOORBELL, testHandler, &contexts[3]);
+
+  handlerClear();
+  RIOPACKET_setDoorbell(&packet, 0x0001, 0x0002, 0x03, 0x0080);
+  TESTEXPR(RIODISPATCH_dispatch(&dispatch, &packet), 1);
+  TESTEXPR(handlerContext, &contexts[1]);
+  TESTEXPR(handlerHeader.ftype, RIOPACKET_FTYPE_DOORBELL);
+  TESTEXPR(handlerHeader.tid, 0x03);
+
+  handlerClear();
+  RIOPACKET_setDoorbell(&packet, 0x0001, 0x0002, 0x03, 0x0100);
+  TESTEXPR(RIODISPATCH_dispatch(&dispatch, &packet), 1);
+  TESTEXPR(handlerContext, &contexts[2]);
+
+  handlerClear();
+  RIOPACKET_setDoorbell(&packet, 0x0001, 0x0002, 0x03, 0x0200);
+  TESTEXPR(RIODISPATCH_dispatch(&dispatch, &packet), 1);
+  TESTEXPR(handlerContext, &contexts[3]);
+
+  for(i = 2; i < RIODISPATCH_DOORBELL_RANGES_MAX; i++)
+  {
+    TESTEXPR(RIODISPATCH_setDoorbellHandler(&dispatch, 0x1000, 0x1000, testHandler, NULL), 1);
+  }
+  TESTEXPR(RIODISPATCH_setDoorbellHandler(&dispatch, 0x2000, 0x2000, testHandler, NULL), 0);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("TG_riodispatch-TC2");
+  PrintS("Description: Test dispatching from the inbound queue of a stack.");
+  PrintS("Requirement: XXXXX");
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 1:");
+  PrintS("Action: Send doorbells over a link and process the inbound queue in ");
+  PrintS("batches.");
+  PrintS("Result: No more than the requested number of packets should be processed ");
+  PrintS("in each batch and all packets should be forwarded in order.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riodispatch-TC2-Step1");
+  /******************************************************************************/
+
+  startLink();
+  RIODISPATCH_open(&dispatch, NULL, NULL);
+  RIODISPATCH_setFtypeHandler(&dispatch, RIOPACKET_FTYPE_DOORBELL, testHandler, &contexts[1]);
+
+  for(i = 0; i < 5; i++)
+  {
+    RIOPACKET_setDoorbell(&packet, 0x0001, 0x0002, i, 0x1000+i);
+    RIOSTACK_setOutboundPacket(&stackA, &packet);
+  }
+  runLink(100);
+  TESTEXPR(RIOSTACK_getInboundQueueLength(&stackB), 5);
+  TESTEXPR(RIOSTACK_getOutboundQueueLength(&stackA), 0);
+
+  handlerClear();
+  TESTEXPR(RIODISPATCH_processInbound(&dispatch, &stackB, 3), 3);
+  TESTEXPR(handlerCalls, 3);
+  TESTEXPR(handlerHeader.tid, 2);
+  TESTEXPR(RIOSTACK_getInboundQueueLength(&stackB), 2);
+
+  handlerClear();
+  TESTEXPR(RIODISPATCH_processInbound(&dispatch, &stackB, 3), 2);
+  TESTEXPR(handlerCalls, 2);
+  TESTEXPR(handlerHeader.tid, 4);
+  TESTEXPR(RIOPACKET_getInfo(&handlerPacket), 0x1004);
+  TESTEXPR(RIOSTACK_getInboundQueueLength(&stackB), 0);
+
+  TESTEXPR(RIODISPATCH_processInbound(&dispatch, &stackB, 3), 0);
+  TESTEXPR(dispatch.statusPacketHandled, 5);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+}
+
+CU_ErrorCode addTests( void )
+{
+  if( CUE_SUCCESS != CU_initialize_registry() )
+  {
+    return CU_get_error();
+  }
+
+  CU_pSuite suite = CU_add_suite( "RIODISPATCHTEST", NULL, NULL );
+  if( NULL == suite )
+  {
+    CU_cleanup_registry();
+    return CU_get_error();
+  }
+
+  CU_add_test( suite, "allTests", &allTests );
+
+  return CUE_SUCCESS;
+}
+
+
+int main(int argc, char argv[])
+{
+  addTests();
+  CU_basic_run_tests();
+  return CU_get_error();
+}
+
+
+/*************************** end of file **************************************/
@@ -0,0 +1,364 @@
+/******************************************************************************
+ * (C) Copyright 2013-2015 Magnus Rosenius and the Free Software Foundation.
+ *
+ * This file is part of OpenRIO.
+ *
+ * OpenRIO is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenRIO is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Lesser Public License
+ * along with OpenRIO.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+
+/******************************************************************************
+ * Description:
+ * Unit tests for riodoorbell.c.
+ ******************************************************************************/
+
+
+#define MODULE_TEST
+#include "riodoorbell.c"
+#include "riostack.c"
+#include "riopacket.c"
+#include "riopool.c"
+#include <CUnit/CUnit.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define PrintS(s) printf(s "\n")
+
+#define TESTSTART(s) printf(s "...")
+#define TESTEND printf(" done.\n");
+
+#define TESTCOND(got) CU_ASSERT(got)
+#define TESTEXPR(got, expected) CU_ASSERT_EQUAL((got), (expected))
+
+#define QUEUE_LENGTH 8
+#define EVENTS 4
+#define RESPONSES 6
+
+int TEST_numExpectedAssertsRemaining = 0;
+
+static RioDoorbell_t doorbell;
+static RioDoorbellEvent_t events[EVENTS];
+static RioDoorbellResponse_t responses[RESPONSES];
+
+#include "test_riolink.h"
+
+/* Information about the last handler call. */
+static int handlerCalls;
+static void *handlerContext;
+static RioDoorbellEvent_t handlerEvent;
+
+static void testHandler(void *context, const RioDoorbellEvent_t *event)
+{
+  handlerCalls++;
+  handlerContext = context;
+  handlerEvent = *event;
+}
+
+static void handlerClear(void)
+{
+  handlerCalls = 0;
+  handlerContext = NULL;
+}
+
+/*******************************************************************************
+ * Module test for this file.
+ *******************************************************************************/
+
+static void allTests(void)
+{
+  RioPacket_t packet;
+  RioDoorbellEvent_t event;
+  uint8_t payload[4] = {0x01, 0x02, 0x03, 0x04};
+  int contexts[2];
+  uint16_t dstid;
+  uint16_t srcid;
+  uint8_t tid;
+  uint8_t status;
+  uint16_t info;
+  int i;
+
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("TG_riodoorbell");
+  PrintS("----------------------------------------------------------------------");
+  PrintS("TG_riodoorbell-TC1");
+  PrintS("Description: Test the doorbell event queue.");
+  PrintS("Requirement: XXXXX");
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 1:");
+  PrintS("Action: Receive doorbells until the event queue is full.");
+  PrintS("Result: Every doorbell should create an event and a response. When ");
+  PrintS("the event queue is full the doorbell should be refused.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riodoorbell-TC1-Step1");
+  /******************************************************************************/
+
+  RIODOORBELL_open(&doorbell, EVENTS, events, RESPONSES, responses);
+
+  for(i = 0; i < EVENTS; i++)
+  {
+    RIOPACKET_setDoorbell(&packet, 0x0001, 0x0100+i, i, 0x1000+i);
+    TESTEXPR(RIODOORBELL_receive(&doorbell, &packet, i), 1);
+    TESTEXPR(RIODOORBELL_getEventQueueLength(&doorbell), i+1);
+    TESTEXPR(RIODOORBELL_getResponseQueueLength(&doorbell), i+1);
+  }
+
+  RIOPACKET_setDoorbell(&packet, 0x0001, 0x0100, 0x10, 0x1000);
+  TESTEXPR(RIODOORBELL_receive(&doorbell, &packet, 10), 0);
+  TESTEXPR(RIODOORBELL_getEventQueueLength(&doorbell), EVENTS);
+  TESTEXPR(RIODOORBELL_getResponseQueueLength(&doorbell), EVENTS);
+  TESTEXPR(doorbell.statusReceived, EVENTS);
+  TESTEXPR(doorbell.statusOverflow, 1);
+
+  for(i = 0; i < EVENTS; i++)
+  {
+    RIODOORBELL_getEvent(&doorbell, &event);
+    TESTEXPR(event.source, 0x0100+i);
+    TESTEXPR(event.info, 0x1000+i);
+    TESTEXPR(event.tid, i);
+    TESTEXPR(event.count, 1);
+    TESTEXPR(event.time, i);
+  }
+
+  TEST_numExpectedAssertsRemaining = 1;
+  RIODOORBELL_getEvent(&doorbell, &event);
+  TESTEXPR(TEST_numExpectedAssertsRemaining, 0);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 2:");
+  PrintS("Action: Receive doorbells with coalescing enabled.");
+  PrintS("Result: Doorbells with the same source and info within the window ");
+  PrintS("should be merged into one event but still be responded to.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riodoorbell-TC1-Step2");
+  /******************************************************************************/
+
+  RIODOORBELL_open(&doorbell, EVENTS, events, RESPONSES, responses);
+  RIODOORBELL_setCoalescing(&doorbell, 10);
+
+  RIOPACKET_setDoorbell(&packet, 0x0001, 0x0100, 0x00, 0x1234);
+  TESTEXPR(RIODOORBELL_receive(&doorbell, &packet, 100), 1);
+  RIOPACKET_setDoorbell(&packet, 0x0001, 0x0200, 0x01, 0x1234);
+  TESTEXPR(RIODOORBELL_receive(&doorbell, &packet, 101), 1);
+  RIOPACKET_setDoorbell(&packet, 0x0001, 0x0100, 0x02, 0x1234);
+  TESTEXPR(RIODOORBELL_receive(&doorbell, &packet, 105), 1);
+  RIOPACKET_setDoorbell(&packet, 0x0001, 0x0100, 0x03, 0x1234);
+  TESTEXPR(RIODOORBELL_receive(&doorbell, &packet, 109), 1);
+  TESTEXPR(RIODOORBELL_getEventQueueLength(&doorbell), 2);
+  TESTEXPR(RIODOORBELL_getResponseQueueLength(&doorbell), 4);
+
+  RIOPACKET_setDoorbell(&packet, 0x0001, 0x0100, 0x04, 0x1234);
+  TESTEXPR(RIODOORBELL_receive(&doorbell, &packet, 110), 1);
+  TESTEXPR(RIODOORBELL_getEventQueueLength(&doorbell), 3);
+  TESTEXPR(RIODOORBELL_getResponseQueueLength(&doorbell), 5);
+
+  RIOPACKET_setDoorbell(&packet, 0x0001, 0x0100, 0x05, 0x1234);
+  TESTEXPR(RIODOORBELL_receive(&doorbell, &packet, 111), 1);
+  TESTEXPR(RIODOORBELL_getEventQueueLength(&doorbell), 3);
+  TESTEXPR(RIODOORBELL_getResponseQueueLength(&doorbell), 6);
+  TESTEXPR(doorbell.statusCoalesced, 3);
+
+  /* No room for more responses. */
+  RIOPACKET_setDoorbell(&packet, 0x0001, 0x0100, 0x06, 0x1234);
+  TESTEXPR(RIODOORBELL_receive(&doorbell, &packet, 112), 0);
+  TESTEXPR(doorbell.statusOverflow, 1);
+
+  RIODOORBELL_getEvent(&doorbell, &event);
+  TESTEXPR(event.source, 0x0100);
+  TESTEXPR(event.tid, 0x03);
+  TESTEXPR(event.count, 3);
+  TESTEXPR(event.time, 100);
+  RIODOORBELL_getEvent(&doorbell, &event);
+  TESTEXPR(event.source, 0x0200);
+  TESTEXPR(event.count, 1);
+  RIODOORBELL_getEvent(&doorbell, &event);
+  TESTEXPR(event.source, 0x0100);
+  TESTEXPR(event.tid, 0x05);
+  TESTEXPR(event.count, 2);
+  TESTEXPR(event.time, 110);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 3:");
+  PrintS("Action: Register info range handlers and process events.");
+  PrintS("Result: The events should be forwarded to the handler of the first ");
+  PrintS("matching range or to the unhandled handler.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riodoorbell-TC1-Step3");
+  /******************************************************************************/
+
+  RIODOORBELL_open(&doorbell, EVENTS, events, RESPONSES, responses);
+  TESTEXPR(RIODOORBELL_setHandler(&doorbell, 0x0100, 0x01ff, testHandler, &contexts[0]), 1);
+  TESTEXPR(RIODOORBELL_setHandler(&doorbell, 0x0000, 0xffff, testHandler, &contexts[1]), 1);
+  for(i = 2; i < RIODOORBELL_RANGES_MAX; i++)
+  {
+    TESTEXPR(RIODOORBELL_setHandler(&doorbell, 0, 0, testHandler, NULL), 1);
+  }
+  TESTEXPR(RIODOORBELL_setHandler(&doorbell, 0, 0, testHandler, NULL), 0);
+
+  RIOPACKET_setDoorbell(&packet, 0x0001, 0x0002, 0x03, 0x0180);
+  TESTEXPR(RIODOORBELL_receive(&doorbell, &packet, 0), 1);
+  RIOPACKET_setDoorbell(&packet, 0x0001, 0x0002, 0x04, 0x0280);
+  TESTEXPR(RIODOORBELL_receive(&doorbell, &packet, 0), 1);
+
+  handlerClear();
+  TESTEXPR(RIODOORBELL_process(&doorbell, 1), 1);
+  TESTEXPR(handlerCalls, 1);
+  TESTCOND(handlerContext == &contexts[0]);
+  TESTEXPR(handlerEvent.info, 0x0180);
+  TESTEXPR(handlerEvent.tid, 0x03);
+
+  handlerClear();
+  TESTEXPR(RIODOORBELL_process(&doorbell, 8), 1);
+  TESTEXPR(handlerCalls, 1);
+  TESTCOND(handlerContext == &contexts[1]);
+  TESTEXPR(handlerEvent.info, 0x0280);
+
+  RIODOORBELL_open(&doorbell, EVENTS, events, RESPONSES, responses);
+  RIODOORBELL_setUnhandled(&doorbell, testHandler, &contexts[1]);
+  TESTEXPR(RIODOORBELL_receive(&doorbell, &packet, 0), 1);
+  handlerClear();
+  TESTEXPR(RIODOORBELL_process(&doorbell, 8), 1);
+  TESTEXPR(handlerCalls, 1);
+  TESTCOND(handlerContext == &contexts[1]);
+  TESTEXPR(RIODOORBELL_process(&doorbell, 8), 0);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("TG_riodoorbell-TC2");
+  PrintS("Description: Test doorbells received by a stack.");
+  PrintS("Requirement: XXXXX");
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 1:");
+  PrintS("Action: Send doorbells to a stack with an attached event queue and ");
+  PrintS("send the responses.");
+  PrintS("Result: The doorbells should not be placed in the inbound queue and ");
+  PrintS("every doorbell should be responded to.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riodoorbell-TC2-Step1");
+  /******************************************************************************/
+
+  startLink();
+  RIODOORBELL_open(&doorbell, EVENTS, events, RESPONSES, responses);
+  RIODOORBELL_attach(&doorbell, &stackB);
+
+  for(i = 0; i < 3; i++)
+  {
+    RIOPACKET_setDoorbell(&packet, 0x0002, 0x0001, 0x20+i, 0x5555);
+    RIOSTACK_setOutboundPacket(&stackA, &packet);
+  }
+  RIOPACKET_setNwrite(&packet, 0x0002, 0x0001, 0x00000000, 4, payload);
+  RIOSTACK_setOutboundPacket(&stackA, &packet);
+  runLink(200);
+
+  TESTEXPR(RIOSTACK_getInboundQueueLength(&stackB), 1);
+  TESTEXPR(RIODOORBELL_getEventQueueLength(&doorbell), 3);
+  TESTEXPR(RIODOORBELL_getResponseQueueLength(&doorbell), 3);
+
+  TESTEXPR(RIODOORBELL_sendResponses(&doorbell, &stackB), 3);
+  TESTEXPR(RIODOORBELL_getResponseQueueLength(&doorbell), 0);
+  runLink(200);
+
+  TESTEXPR(RIOSTACK_getInboundQueueLength(&stackA), 3);
+  for(i = 0; i < 3; i++)
+  {
+    RIOSTACK_getInboundPacket(&stackA, &packet);
+    TESTEXPR(RIOPACKET_getFtype(&packet), RIOPACKET_FTYPE_RESPONSE);
+    RIOPACKET_getResponseNoPayload(&packet, &dstid, &srcid, &tid, &status);
+    TESTEXPR(dstid, 0x0001);
+    TESTEXPR(srcid, 0x0002);
+    TESTEXPR(tid, 0x20+i);
+    TESTEXPR(status, RIOPACKET_RESPONSE_STATUS_DONE);
+  }
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 2:");
+  PrintS("Action: Send more doorbells than fits in the event queue.");
+  PrintS("Result: The doorbells that does not fit should be placed in the ");
+  PrintS("inbound queue.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riodoorbell-TC2-Step2");
+  /******************************************************************************/
+
+  RIOSTACK_getInboundPacket(&stackB, &packet);
+  (void) RIODOORBELL_process(&doorbell, 8);
+
+  for(i = 0; i < EVENTS+2; i++)
+  {
+    RIOPACKET_setDoorbell(&packet, 0x0002, 0x0001, 0x30+i, 0x6666);
+    RIOSTACK_setOutboundPacket(&stackA, &packet);
+  }
+  runLink(400);
+
+  TESTEXPR(RIODOORBELL_getEventQueueLength(&doorbell), EVENTS);
+  TESTEXPR(RIOSTACK_getInboundQueueLength(&stackB), 2);
+  TESTEXPR(doorbell.statusOverflow, 2);
+
+  for(i = 0; i < 2; i++)
+  {
+    RIOSTACK_getInboundPacket(&stackB, &packet);
+    RIOPACKET_getDoorbell(&packet, &dstid, &srcid, &tid, &info);
+    TESTEXPR(tid, 0x30+EVENTS+i);
+    TESTEXPR(info, 0x6666);
+  }
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+}
+
+CU_ErrorCode addTests( void )
+{
+  if( CUE_SUCCESS != CU_initialize_registry() )
+  {
+    return CU_get_error();
+  }
+
+  CU_pSuite suite = CU_add_suite( "RIODOORBELLTEST", NULL, NULL );
+  if( NULL == suite )
+  {
+    CU_cleanup_registry();
+    return CU_get_error();
+  }
+
+  CU_add_test( suite, "allTests", &allTests );
+
+  return CUE_SUCCESS;
+}
+
+
+int main(int argc, char argv[])
+{
+  addTests();
+  CU_basic_run_tests();
+  return CU_get_error();
+}
+
+
+/*************************** end of file **************************************/
@@ -0,0 +1,372 @@
+/******************************************************************************
+ * (C) Copyright 2013-2015 Magnus Rosenius and the Free Software Foundation.
+ *
+ * This file is part of OpenRIO.
+ *
+ * OpenRIO is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenRIO is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Lesser Public License
+ * along with OpenRIO.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+
+
+/******************************************************************************
+ * Description:
+ * Unit tests for riofailover.c.
+ ******************************************************************************/
+
+
+#define MODULE_TEST
+#include <CUnit/CUnit.h>
+#include <stdio.h>
+#include "riofailover.c"
+#include "riostack.c"
+#include "riopacket.c"
+#include "riopool.c"
+
+#define PrintS(s) printf(s "\n")
+
+#define TESTSTART(s) printf(s "...")
+#define TESTEND printf(" done.\n");
+
+#define TESTCOND(got) CU_ASSERT(got)
+#define TESTEXPR(got, expected) CU_ASSERT_EQUAL((got), (expected))
+
+#define QUEUE_LENGTH 16
+
+int TEST_numExpectedAssertsRemaining = 0;
+
+static RioFailover_t failoverA;
+static RioFailover_t failoverB;
+
+static RioStack_t stackA[2];
+static uint32_t rxPacketBufferA[2][RIOSTACK_BUFFER_SIZE * 2 * QUEUE_LENGTH];
+static uint32_t txPacketBufferA[2][RIOSTACK_BUFFER_SIZE * QUEUE_LENGTH];
+static RioStack_t stackB[2];
+static uint32_t rxPacketBufferB[2][RIOSTACK_BUFFER_SIZE * 2 * QUEUE_LENGTH];
+static uint32_t txPacketBufferB[2][RIOSTACK_BUFFER_SIZE * QUEUE_LENGTH];
+
+/* Exchange symbols on both links and let the failover managers check them. */
+static void runLinks(int symbols)
+{
+  int i;
+  int j;
+
+  for(i = 0; i < symbols; i++)
+  {
+    for(j = 0; j < 2; j++)
+    {
+      RIOSTACK_portAddSymbol(&stackB[j], RIOSTACK_portGetSymbol(&stackA[j]));
+      RIOSTACK_portAddSymbol(&stackA[j], RIOSTACK_portGetSymbol(&stackB[j]));
+    }
+    (void) RIOFAILOVER_process(&failoverA);
+    (void) RIOFAILOVER_process(&failoverB);
+  }
+}
+
+/* Initialize the ports of a link and run until it is up. */
+static void startLink(int link)
+{
+  RIOSTACK_portSetStatus(&stackA[link], 1);
+  RIOSTACK_portSetStatus(&stackB[link], 1);
+  while(!RIOSTACK_getLinkIsInitialized(&stackA[link]) ||
+        !RIOSTACK_getLinkIsInitialized(&stackB[link]))
+  {
+    runLinks(1);
+  }
+}
+
+/* Set the ports of a link to uninitialized. */
+static void stopLink(int link)
+{
+  RIOSTACK_portSetStatus(&stackA[link], 0);
+  RIOSTACK_portSetStatus(&stackB[link], 0);
+}
+
+/* Open the stacks and the failover managers and bring up both links. The 
+   inbound queues are longer than the outbound queues and the standby stack 
+   of failoverA gets a shorter outbound queue. */
+static void startFailover(uint32_t standbyQueueLength)
+{
+  int i;
+
+  for(i = 0; i < 2; i++)
+  {
+    RIOSTACK_open(&stackA[i], NULL,
+        RIOSTACK_BUFFER_SIZE*2*QUEUE_LENGTH, rxPacketBufferA[i],
+        RIOSTACK_BUFFER_SIZE*((i == 0) ? QUEUE_LENGTH : standbyQueueLength), txPacketBufferA[i]);
+    RIOSTACK_open(&stackB[i], NULL,
+        RIOSTACK_BUFFER_SIZE*2*QUEUE_LENGTH, rxPacketBufferB[i],
+        RIOSTACK_BUFFER_SIZE*QUEUE_LENGTH, txPacketBufferB[i]);
+    RIOSTACK_portSetTimeout(&stackA[i], 1000);
+    RIOSTACK_portSetTimeout(&stackB[i], 1000);
+  }
+  RIOFAILOVER_open(&failoverA, &stackA[0], &stackA[1]);
+  RIOFAILOVER_open(&failoverB, &stackB[0], &stackB[1]);
+
+  startLink(0);
+  startLink(1);
+}
+
+/* Queue doorbells with consecutive info fields. */
+static void sendDoorbells(int packets, uint16_t infoStart)
+{
+  RioPacket_t packet;
+  int i;
+
+  for(i = 0; i < packets; i++)
+  {
+    RIOPACKET_setDoorbell(&packet, 0x0001, 0x0002, (uint8_t) i, (uint16_t) (infoStart+i));
+    TESTCOND(RIOFAILOVER_setOutboundPacket(&failoverA, &packet));
+  }
+}
+
+/* Read a doorbell and return its info field. */
+static uint16_t receiveDoorbell(void)
+{
+  RioPacket_t packet;
+  uint16_t dstid, srcid, info;
+  uint8_t tid;
+
+  RIOFAILOVER_getInboundPacket(&failoverB, &packet);
+  TESTCOND(RIOPACKET_valid(&packet));
+  RIOPACKET_getDoorbell(&packet, &dstid, &srcid, &tid, &info);
+
+  return info;
+}
+
+/* Let stackA[0] transmit without receiving any packet-accepted and return the 
+   number of packets that stackB[0] received. */
+static int transmitOnly(int symbols)
+{
+  int i;
+
+  for(i = 0; i < symbols; i++)
+  {
+    RIOSTACK_portAddSymbol(&stackB[0], RIOSTACK_portGetSymbol(&stackA[0]));
+  }
+
+  return RIOSTACK_getInboundQueueLength(&stackB[0]);
+}
+
+/*******************************************************************************
+ * Module test for this file.
+ *******************************************************************************/
+
+static void allTests(void)
+{
+  RioPacket_t packet;
+  int window;
+  int i;
+
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("TG_riofailover");
+  PrintS("----------------------------------------------------------------------");
+  PrintS("TG_riofailover-TC1");
+  PrintS("Description: Test failover to the standby link.");
+  PrintS("Requirement: XXXXX");
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 1:");
+  PrintS("Action: Send doorbells when no packet-accepted reaches the active ");
+  PrintS("        stack and let its link go down.");
+  PrintS("Result: The standby stack should become active and resend the ");
+  PrintS("        unacknowledged packets followed by the unsent packets. The ");
+  PrintS("        packets should be received in order after the packets that ");
+  PrintS("        were received before the link went down.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riofailover-TC1-Step1");
+  /******************************************************************************/
+
+  startFailover(QUEUE_LENGTH);
+  TESTCOND(RIOFAILOVER_getActive(&failoverA) == &stackA[0]);
+  TESTEXPR(RIOFAILOVER_process(&failoverA), 0);
+
+  sendDoorbells(10, 0x1000);
+  window = transmitOnly(20);
+  TESTCOND(window > 0);
+  TESTCOND(window < 10);
+
+  /* Nothing is accepted when the port of the active stack is down. */
+  stopLink(0);
+  RIOPACKET_setDoorbell(&packet, 0x0001, 0x0002, 0, 0);
+  TESTEXPR(RIOFAILOVER_setOutboundPacket(&failoverA, &packet), 0);
+
+  TESTEXPR(RIOFAILOVER_process(&failoverA), 10);
+  TESTCOND(RIOFAILOVER_getActive(&failoverA) == &stackA[1]);
+  TESTEXPR(RIOFAILOVER_getMoving(&failoverA), 0);
+  TESTEXPR(failoverA.statusFailovers, 1);
+  TESTEXPR(failoverA.statusPacketsMoved, 10);
+  TESTCOND(failoverA.statusPacketsResent >= (uint32_t) window);
+  TESTEXPR(RIOSTACK_getOutboundQueueLength(&stackA[0]), 0);
+
+  sendDoorbells(5, 0x100a);
+  runLinks(1000);
+  TESTCOND(RIOFAILOVER_getActive(&failoverB) == &stackB[1]);
+  TESTEXPR(RIOSTACK_getOutboundQueueLength(&stackA[1]), 0);
+
+  /* The packets received before the failover are read first. */
+  TESTEXPR(RIOFAILOVER_getInboundQueueLength(&failoverB), window+15);
+  for(i = 0; i < window; i++)
+  {
+    TESTEXPR(receiveDoorbell(), 0x1000+i);
+  }
+  for(i = 0; i < 15; i++)
+  {
+    TESTEXPR(receiveDoorbell(), 0x1000+i);
+  }
+  TESTEXPR(RIOFAILOVER_getInboundQueueLength(&failoverB), 0);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 2:");
+  PrintS("Action: Bring the failed link up again and let the active link go ");
+  PrintS("        down.");
+  PrintS("Result: The repaired stack should become the active stack again.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riofailover-TC1-Step2");
+  /******************************************************************************/
+
+  startLink(0);
+  TESTCOND(RIOFAILOVER_getActive(&failoverA) == &stackA[1]);
+  sendDoorbells(5, 0x2000);
+  stopLink(1);
+  runLinks(1000);
+  TESTCOND(RIOFAILOVER_getActive(&failoverA) == &stackA[0]);
+  TESTCOND(RIOFAILOVER_getActive(&failoverB) == &stackB[0]);
+  TESTEXPR(failoverA.statusFailovers, 2);
+  TESTEXPR(failoverA.statusPacketsMoved, 15);
+
+  TESTEXPR(RIOFAILOVER_getInboundQueueLength(&failoverB), 5);
+  for(i = 0; i < 5; i++)
+  {
+    TESTEXPR(receiveDoorbell(), 0x2000+i);
+  }
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("TG_riofailover-TC2");
+  PrintS("Description: Test failover in special cases.");
+  PrintS("Requirement: XXXXX");
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 1:");
+  PrintS("Action: Let the active link go down when the standby link is down.");
+  PrintS("Result: No failover should be done until the standby link is up.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riofailover-TC2-Step1");
+  /******************************************************************************/
+
+  startFailover(QUEUE_LENGTH);
+  stopLink(1);
+  sendDoorbells(4, 0x3000);
+  stopLink(0);
+  runLinks(100);
+  TESTCOND(RIOFAILOVER_getActive(&failoverA) == &stackA[0]);
+  TESTEXPR(failoverA.statusFailovers, 0);
+  TESTEXPR(RIOSTACK_getOutboundQueueLength(&stackA[0]), 4);
+
+  startLink(1);
+  runLinks(1000);
+  TESTCOND(RIOFAILOVER_getActive(&failoverA) == &stackA[1]);
+  TESTEXPR(failoverA.statusFailovers, 1);
+  TESTEXPR(failoverA.statusPacketsResent, 0);
+  TESTEXPR(RIOFAILOVER_getInboundQueueLength(&failoverB), 4);
+  for(i = 0; i < 4; i++)
+  {
+    TESTEXPR(receiveDoorbell(), 0x3000+i);
+  }
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 2:");
+  PrintS("Action: Let the active link go down when it has more packets than ");
+  PrintS("        fits in the outbound queue of the standby stack.");
+  PrintS("Result: The packets should be moved by several calls and no new ");
+  PrintS("        packets should be accepted until all are moved. All packets ");
+  PrintS("        should be received in order.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riofailover-TC2-Step2");
+  /******************************************************************************/
+
+  startFailover(QUEUE_LENGTH/4);
+  sendDoorbells(QUEUE_LENGTH, 0x4000);
+  stopLink(0);
+
+  TESTEXPR(RIOFAILOVER_process(&failoverA), QUEUE_LENGTH/4);
+  TESTEXPR(RIOFAILOVER_getMoving(&failoverA), 1);
+  TESTEXPR(RIOFAILOVER_setOutboundPacket(&failoverA, &packet), 0);
+
+  while(RIOFAILOVER_getMoving(&failoverA))
+  {
+    runLinks(1);
+  }
+  TESTEXPR(failoverA.statusPacketsMoved, QUEUE_LENGTH);
+  for(i = 0; i < QUEUE_LENGTH/4; i++)
+  {
+    RIOPACKET_setDoorbell(&packet, 0x0001, 0x0002, 0, (uint16_t) (0x4000+QUEUE_LENGTH+i));
+    while(!RIOFAILOVER_setOutboundPacket(&failoverA, &packet))
+    {
+      runLinks(1);
+    }
+  }
+
+  runLinks(1000);
+  TESTEXPR(RIOFAILOVER_getInboundQueueLength(&failoverB), QUEUE_LENGTH+QUEUE_LENGTH/4);
+  for(i = 0; i < QUEUE_LENGTH+QUEUE_LENGTH/4; i++)
+  {
+    TESTEXPR(receiveDoorbell(), 0x4000+i);
+  }
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+}
+
+CU_ErrorCode addTests( void )
+{
+  if( CUE_SUCCESS != CU_initialize_registry() )
+  {
+    return CU_get_error();
+  }
+
+  CU_pSuite suite = CU_add_suite( "RIOFAILOVERTEST", NULL, NULL );
+  if( NULL == suite )
+  {
+    CU_cleanup_registry();
+    return CU_get_error();
+  }
+
+  CU_add_test( suite, "allTests", &allTests );
+
+  return CUE_SUCCESS;
+}
+
+
+int main(int argc, char argv[])
+{
+  addTests();
+  CU_basic_run_tests();
+  return CU_get_error();
+}
+
+
+/*************************** end of file **************************************/
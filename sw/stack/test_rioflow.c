@@ -0,0 +1,354 @@
+/******************************************************************************
+ * (C) Copyright 2013-2015 Magnus Rosenius and the Free Software Foundation.
+ *
+ * This file is part of OpenRIO.
+ *
+ * OpenRIO is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenRIO is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Lesser Public License
+ * along with OpenRIO.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+
+/******************************************************************************
+ * Description:
+ * Unit tests for rioflow.c.
+ ******************************************************************************/
+
+
+#define MODULE_TEST
+#include "rioflow.c"
+#include "riostack.c"
+#include "riopacket.c"
+#include "riopool.c"
+#include <CUnit/CUnit.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define PrintS(s) printf(s "\n")
+
+#define TESTSTART(s) printf(s "...")
+#define TESTEND printf(" done.\n");
+
+#define TESTCOND(got) CU_ASSERT(got)
+#define TESTEXPR(got, expected) CU_ASSERT_EQUAL((got), (expected))
+
+#define QUEUE_LENGTH 8
+#define POOL_SIZE 32
+#define SOURCES 2
+#define BLOCKED 2
+#define PENDING 16
+
+int TEST_numExpectedAssertsRemaining = 0;
+
+static RioPool_t pool;
+static RioPoolEntry_t poolEntries[POOL_SIZE];
+
+static RioFlow_t flowA;
+static RioFlowSource_t sourcesA[SOURCES];
+static RioFlowBlocked_t blockedA[BLOCKED];
+static RioPoolHandle_t pendingA[PENDING];
+
+static RioFlow_t flowB;
+static RioFlowSource_t sourcesB[SOURCES];
+static RioFlowBlocked_t blockedB[BLOCKED];
+static RioPoolHandle_t pendingB[PENDING];
+
+#include "test_riolink.h"
+
+/* Queue a pooled NWRITE with a priority in the pending queue. */
+static uint8_t queueNwrite(RioFlow_t *flow, uint16_t dstId, uint8_t prio, uint32_t address)
+{
+  RioPoolHandle_t handle;
+  RioPacket_t *packet;
+  uint8_t payload[4] = {0x01, 0x02, 0x03, 0x04};
+
+  handle = RIOPOOL_allocate(&pool);
+  packet = RIOPOOL_getPacket(&pool, handle);
+  RIOPACKET_setNwrite(packet, dstId, 0x0001, address, 4, payload);
+  packet->payload[0] |= ((uint32_t) prio) << 22;
+  if(!RIOFLOW_setOutboundPacketHandle(flow, handle))
+  {
+    RIOPOOL_release(&pool, handle);
+    return 0;
+  }
+  return 1;
+}
+
+/*******************************************************************************
+ * Module test for this file.
+ *******************************************************************************/
+
+static void allTests(void)
+{
+  RioPacket_t packet;
+  uint16_t dstid;
+  uint16_t srcid;
+  uint32_t address;
+  uint16_t payloadSize;
+  uint8_t payload[256];
+  uint16_t moved;
+  int i;
+
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("TG_rioflow");
+  PrintS("----------------------------------------------------------------------");
+  PrintS("TG_rioflow-TC1");
+  PrintS("Description: Test the transmitter side of flow control.");
+  PrintS("Requirement: XXXXX");
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 1:");
+  PrintS("Action: Receive XOFF and XON for flows to different destinations.");
+  PrintS("Result: An XOFF should stop the flow and all lower flows to the same ");
+  PrintS("destination until an XON is received for it.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_rioflow-TC1-Step1");
+  /******************************************************************************/
+
+  RIOPOOL_open(&pool, POOL_SIZE, poolEntries);
+  RIOFLOW_open(&flowA, 0x0001, SOURCES, sourcesA, BLOCKED, blockedA, &pool, PENDING, pendingA);
+
+  RIOPACKET_setFlowControl(&packet, 0x0001, 0x0002, 0, 1, 0x0002);
+  TESTEXPR(RIOFLOW_receive(&flowA, &packet, 0), 1);
+  TESTEXPR(RIOFLOW_isBlocked(&flowA, 0x0002, 0), 1);
+  TESTEXPR(RIOFLOW_isBlocked(&flowA, 0x0002, 1), 1);
+  TESTEXPR(RIOFLOW_isBlocked(&flowA, 0x0002, 2), 0);
+  TESTEXPR(RIOFLOW_isBlocked(&flowA, 0x0003, 0), 0);
+
+  RIOPACKET_setFlowControl(&packet, 0x0001, 0x0003, 0, 3, 0x0003);
+  TESTEXPR(RIOFLOW_receive(&flowA, &packet, 0), 1);
+  TESTEXPR(RIOFLOW_isBlocked(&flowA, 0x0003, 3), 1);
+
+  RIOPACKET_setFlowControl(&packet, 0x0001, 0x0004, 0, 0, 0x0004);
+  TESTEXPR(RIOFLOW_receive(&flowA, &packet, 0), 1);
+  TESTEXPR(RIOFLOW_isBlocked(&flowA, 0x0004, 0), 0);
+  TESTEXPR(flowA.statusXoffReceived, 3);
+  TESTEXPR(flowA.statusOverflow, 1);
+
+  RIOPACKET_setFlowControl(&packet, 0x0001, 0x0002, 1, 1, 0x0002);
+  TESTEXPR(RIOFLOW_receive(&flowA, &packet, 0), 1);
+  TESTEXPR(RIOFLOW_isBlocked(&flowA, 0x0002, 0), 0);
+  TESTEXPR(RIOFLOW_isBlocked(&flowA, 0x0003, 3), 1);
+  TESTEXPR(flowA.statusXonReceived, 1);
+
+  RIOPACKET_setDoorbell(&packet, 0x0001, 0x0002, 0, 0x1234);
+  TESTEXPR(RIOFLOW_receive(&flowA, &packet, 0), 0);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 2:");
+  PrintS("Action: Transmit pending packets when some flows are stopped.");
+  PrintS("Result: Only the packets of flows that are not stopped should be moved ");
+  PrintS("to the stack and the order within each flow should be kept. The ");
+  PrintS("stopped flows should be resumed when the XOFF times out.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_rioflow-TC1-Step2");
+  /******************************************************************************/
+
+  RIOSTACK_open(&stackA, NULL,
+      RIOSTACK_BUFFER_SIZE*QUEUE_LENGTH, rxPacketBufferA,
+      RIOSTACK_BUFFER_SIZE*QUEUE_LENGTH, txPacketBufferA);
+  RIOPOOL_open(&pool, POOL_SIZE, poolEntries);
+  RIOFLOW_open(&flowA, 0x0001, SOURCES, sourcesA, BLOCKED, blockedA, &pool, 4, pendingA);
+  RIOFLOW_setTimeout(&flowA, 100);
+
+  RIOPACKET_setFlowControl(&packet, 0x0001, 0x0002, 0, 0, 0x0002);
+  TESTEXPR(RIOFLOW_receive(&flowA, &packet, 10), 1);
+
+  TESTEXPR(queueNwrite(&flowA, 0x0002, 0, 0x00000000), 1);
+  TESTEXPR(queueNwrite(&flowA, 0x0003, 0, 0x00000008), 1);
+  TESTEXPR(queueNwrite(&flowA, 0x0002, 1, 0x00000010), 1);
+  TESTEXPR(queueNwrite(&flowA, 0x0002, 0, 0x00000018), 1);
+  TESTEXPR(queueNwrite(&flowA, 0x0003, 0, 0x00000020), 0);
+  TESTEXPR(RIOPOOL_getAvailable(&pool), POOL_SIZE-4);
+  TESTEXPR(RIOFLOW_getPendingQueueLength(&flowA), 4);
+
+  RIOSTACK_portSetTime(&stackA, 50);
+  TESTEXPR(RIOFLOW_transmit(&flowA, &stackA), 2);
+  TESTEXPR(RIOFLOW_getPendingQueueLength(&flowA), 2);
+  TESTEXPR(RIOSTACK_getOutboundQueueLength(&stackA), 2);
+  /* The stack keeps the moved packets until they are acknowledged. */
+  TESTEXPR(RIOPOOL_getAvailable(&pool), POOL_SIZE-4);
+  TESTEXPR(RIOPACKET_getDestination(RIOPOOL_getPacket(&pool, pendingA[0])), 0x0002);
+  TESTEXPR(RIOPACKET_getDestination(RIOPOOL_getPacket(&pool, pendingA[1])), 0x0002);
+  RIOPACKET_getNwrite(RIOPOOL_getPacket(&pool, pendingA[0]), &dstid, &srcid, &address, &payloadSize, payload);
+  TESTEXPR(address, 0x00000000);
+  RIOPACKET_getNwrite(RIOPOOL_getPacket(&pool, pendingA[1]), &dstid, &srcid, &address, &payloadSize, payload);
+  TESTEXPR(address, 0x00000018);
+
+  RIOSTACK_portSetTime(&stackA, 110);
+  TESTEXPR(RIOFLOW_transmit(&flowA, &stackA), 2);
+  TESTEXPR(RIOFLOW_getPendingQueueLength(&flowA), 0);
+  TESTEXPR(flowA.statusXoffTimeout, 1);
+  TESTEXPR(RIOPOOL_getAvailable(&pool), POOL_SIZE-4);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 3:");
+  PrintS("Action: Transmit pending packets when the outbound queue is full.");
+  PrintS("Result: The packets that does not fit should stay in the pending queue.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_rioflow-TC1-Step3");
+  /******************************************************************************/
+
+  RIOSTACK_open(&stackA, NULL,
+      RIOSTACK_BUFFER_SIZE*QUEUE_LENGTH, rxPacketBufferA,
+      RIOSTACK_BUFFER_SIZE*QUEUE_LENGTH, txPacketBufferA);
+  RIOFLOW_open(&flowA, 0x0001, SOURCES, sourcesA, BLOCKED, blockedA, &pool, PENDING, pendingA);
+
+  for(i = 0; i < PENDING; i++)
+  {
+    TESTEXPR(queueNwrite(&flowA, 0x0002, 0, 8*i), 1);
+  }
+  TESTEXPR(queueNwrite(&flowA, 0x0002, 0, 0), 0);
+
+  moved = RIOFLOW_transmit(&flowA, &stackA);
+  TESTEXPR(moved, RIOSTACK_getOutboundQueueLength(&stackA));
+  TESTEXPR(RIOSTACK_getOutboundQueueAvailable(&stackA), 0);
+  TESTEXPR(RIOFLOW_getPendingQueueLength(&flowA), PENDING-moved);
+  RIOPACKET_getNwrite(RIOPOOL_getPacket(&pool, pendingA[0]), &dstid, &srcid, &address, &payloadSize, payload);
+  TESTEXPR(address, 8*moved);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("TG_rioflow-TC2");
+  PrintS("Description: Test flow control between two stacks.");
+  PrintS("Requirement: XXXXX");
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 1:");
+  PrintS("Action: Send packets to a stack that does not read its inbound queue.");
+  PrintS("Result: An XOFF should be sent when the inbound queue reaches the XOFF ");
+  PrintS("level and the rest of the packets should be kept at the source.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_rioflow-TC2-Step1");
+  /******************************************************************************/
+
+  startLink();
+  RIOPOOL_open(&pool, POOL_SIZE, poolEntries);
+  RIOFLOW_open(&flowA, 0x0001, SOURCES, sourcesA, BLOCKED, blockedA, &pool, PENDING, pendingA);
+  RIOFLOW_open(&flowB, 0x0002, SOURCES, sourcesB, BLOCKED, blockedB, &pool, PENDING, pendingB);
+  RIOFLOW_attach(&flowA, &stackA, 6, 2);
+  RIOFLOW_attach(&flowB, &stackB, 4, 1);
+
+  for(i = 0; i < 12; i++)
+  {
+    TESTEXPR(queueNwrite(&flowA, 0x0002, 0, 8*i), 1);
+  }
+
+  TESTEXPR(RIOFLOW_transmit(&flowA, &stackA), QUEUE_LENGTH);
+  runLink(1000);
+  TESTEXPR(RIOSTACK_getInboundQueueLength(&stackB), QUEUE_LENGTH);
+  TESTEXPR(stackB.rxCongested, 1);
+  TESTEXPR(flowB.sourcesLength, 1);
+  TESTEXPR(flowB.sources[0].source, 0x0001);
+  TESTEXPR(flowB.sources[0].state, RIOFLOW_SOURCE_XOFF_PENDING);
+
+  TESTEXPR(RIOFLOW_transmit(&flowB, &stackB), 0);
+  TESTEXPR(flowB.statusXoffSent, 1);
+  runLink(400);
+  TESTEXPR(flowA.statusXoffReceived, 1);
+  TESTEXPR(RIOFLOW_isBlocked(&flowA, 0x0002, 0), 1);
+  TESTEXPR(RIOSTACK_getInboundQueueLength(&stackA), 0);
+
+  TESTEXPR(RIOFLOW_transmit(&flowA, &stackA), 0);
+  TESTEXPR(RIOFLOW_getPendingQueueLength(&flowA), 12-QUEUE_LENGTH);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 2:");
+  PrintS("Action: Read the inbound queue of the congested stack.");
+  PrintS("Result: An XON should be sent when the inbound queue reaches the XON ");
+  PrintS("level and the rest of the packets should be sent.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_rioflow-TC2-Step2");
+  /******************************************************************************/
+
+  for(i = 0; i < QUEUE_LENGTH-1; i++)
+  {
+    TESTEXPR(stackB.rxCongested, 1);
+    RIOSTACK_getInboundPacket(&stackB, &packet);
+    RIOPACKET_getNwrite(&packet, &dstid, &srcid, &address, &payloadSize, payload);
+    TESTEXPR(address, 8*i);
+  }
+  TESTEXPR(stackB.rxCongested, 0);
+  TESTEXPR(flowB.sources[0].state, RIOFLOW_SOURCE_XON_PENDING);
+
+  TESTEXPR(RIOFLOW_transmit(&flowB, &stackB), 0);
+  TESTEXPR(flowB.statusXonSent, 1);
+  TESTEXPR(flowB.sourcesLength, 0);
+  runLink(400);
+  TESTEXPR(flowA.statusXonReceived, 1);
+  TESTEXPR(RIOFLOW_isBlocked(&flowA, 0x0002, 0), 0);
+
+  TESTEXPR(RIOFLOW_transmit(&flowA, &stackA), 12-QUEUE_LENGTH);
+  TESTEXPR(RIOFLOW_getPendingQueueLength(&flowA), 0);
+  runLink(1000);
+  TESTEXPR(RIOSTACK_getInboundQueueLength(&stackB), 12-QUEUE_LENGTH+1);
+
+  for(i = QUEUE_LENGTH-1; i < 12; i++)
+  {
+    RIOSTACK_getInboundPacket(&stackB, &packet);
+    RIOPACKET_getNwrite(&packet, &dstid, &srcid, &address, &payloadSize, payload);
+    TESTEXPR(address, 8*i);
+  }
+
+  /* The source was never told to stop the second time. */
+  TESTEXPR(flowB.statusXoffSent, 1);
+  TESTEXPR(flowB.sourcesLength, 0);
+  TESTEXPR(RIOPOOL_getAvailable(&pool), POOL_SIZE);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+}
+
+CU_ErrorCode addTests( void )
+{
+  if( CUE_SUCCESS != CU_initialize_registry() )
+  {
+    return CU_get_error();
+  }
+
+  CU_pSuite suite = CU_add_suite( "RIOFLOWTEST", NULL, NULL );
+  if( NULL == suite )
+  {
+    CU_cleanup_registry();
+    return CU_get_error();
+  }
+
+  CU_add_test( suite, "allTests", &allTests );
+
+  return CUE_SUCCESS;
+}
+
+
+int main(int argc, char argv[])
+{
+  addTests();
+  CU_basic_run_tests();
+  return CU_get_error();
+}
+
+/*************************** end of file **************************************/
@@ -0,0 +1,97 @@
+/******************************************************************************
+ * (C) Copyright 2013-2015 Magnus Rosenius and the Free Software Foundation.
+ *
+ * This file is part of OpenRIO.
+ *
+ * OpenRIO is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenRIO is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Lesser Public License
+ * along with OpenRIO.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+/******************************************************************************
+ * Description:
+ * A link between two stacks, stackA and stackB, shared by the unit tests.
+ *
+ * Include this file after riostack.c, the TESTCOND() macro and QUEUE_LENGTH,
+ * the number of packets in each queue of the stacks. The symbols are passed
+ * directly between the stacks. A test that passes them through a codec
+ * defines TEST_RIOLINK_CODEC and its own runLink().
+ ******************************************************************************/
+
+#ifndef __TEST_RIOLINK_H
+#define __TEST_RIOLINK_H
+
+/* The number of symbols the link may use to initialize. */
+#define LINK_SYMBOLS_MAX 10000
+
+static RioStack_t stackA;
+static uint32_t rxPacketBufferA[RIOSTACK_BUFFER_SIZE * QUEUE_LENGTH];
+static uint32_t txPacketBufferA[RIOSTACK_BUFFER_SIZE * QUEUE_LENGTH];
+static RioStack_t stackB;
+static uint32_t rxPacketBufferB[RIOSTACK_BUFFER_SIZE * QUEUE_LENGTH];
+static uint32_t txPacketBufferB[RIOSTACK_BUFFER_SIZE * QUEUE_LENGTH];
+
+/* Exchange symbols between two stacks. */
+static void runLink(int symbols);
+
+#ifndef TEST_RIOLINK_CODEC
+static void runLink(int symbols)
+{
+  int i;
+
+  for(i = 0; i < symbols; i++)
+  {
+    RIOSTACK_portAddSymbol(&stackB, RIOSTACK_portGetSymbol(&stackA));
+    RIOSTACK_portAddSymbol(&stackA, RIOSTACK_portGetSymbol(&stackB));
+  }
+}
+#endif
+
+/* Open two stacks without starting the link. */
+static void openLink(void)
+{
+  RIOSTACK_open(&stackA, NULL,
+      RIOSTACK_BUFFER_SIZE*QUEUE_LENGTH, rxPacketBufferA,
+      RIOSTACK_BUFFER_SIZE*QUEUE_LENGTH, txPacketBufferA);
+  RIOSTACK_open(&stackB, NULL,
+      RIOSTACK_BUFFER_SIZE*QUEUE_LENGTH, rxPacketBufferB,
+      RIOSTACK_BUFFER_SIZE*QUEUE_LENGTH, txPacketBufferB);
+  RIOSTACK_portSetTimeout(&stackA, 1000);
+  RIOSTACK_portSetTimeout(&stackB, 1000);
+}
+
+/* Connect the stacks to each other and return non-zero if the link came up. */
+static int connectLink(void)
+{
+  int i;
+
+  RIOSTACK_portSetStatus(&stackA, 1);
+  RIOSTACK_portSetStatus(&stackB, 1);
+  for(i = 0; (i < LINK_SYMBOLS_MAX) &&
+        (!RIOSTACK_getLinkIsInitialized(&stackA) || !RIOSTACK_getLinkIsInitialized(&stackB)); i++)
+  {
+    runLink(1);
+  }
+
+  return RIOSTACK_getLinkIsInitialized(&stackA) && RIOSTACK_getLinkIsInitialized(&stackB);
+}
+
+/* Open two stacks and connect them to each other until the link is up. */
+static void startLink(void)
+{
+  openLink();
+  TESTCOND(connectLink());
+}
+
+#endif
+
+/*************************** end of file **************************************/
@@ -88,6 +88,21 @@ void allTests(void)
   uint32_t implementationSpecific;
   uint8_t portId;
   uint32_t logicalTransportErrorDetect;
+  uint8_t xon;
+  uint8_t flowId;
+  uint16_t tgtdestId;
+  RioPacket_t expected;
+  RioPacketTemplate_t packetTemplate;
+  RioPacket_t batch[100];
+  const RioPacket_t *batchList[100];
+  uint32_t results[4];
+  uint32_t dstidExt, srcidExt;
+  uint64_t addressExt, addressExtExpected, addressMask;
+  uint8_t tt;
+  uint8_t addressSize;
+  const uint8_t ttList[3] = {RIOPACKET_TT_8BITS, RIOPACKET_TT_16BITS, RIOPACKET_TT_32BITS};
+  const uint8_t addressSizeList[3] = {RIOPACKET_ADDRESS_34BITS, RIOPACKET_ADDRESS_50BITS, 
+                                      RIOPACKET_ADDRESS_66BITS};
 
   uint16_t payloadSizeExpected, payloadSize;
   uint8_t payloadExpected[256], payload[256];
@@ -140,6 +155,7 @@ void allTests(void)
   TESTEXPR(RIOPACKET_getDestination(&packet), 0x0001);
   TESTEXPR(RIOPACKET_getSource(&packet), 0xffff);
   TESTEXPR(RIOPACKET_getTid(&packet), 0x00);
+  TESTEXPR(RIOPACKET_getInfo(&packet), 0xdeaf);
   RIOPACKET_getDoorbell(&packet, &dstid, &srcid, &tid, &info);
   TESTEXPR(dstid, 0x0001);
   TESTEXPR(srcid, 0xffff);
@@ -169,6 +185,7 @@ void allTests(void)
   TESTEXPR(RIOPACKET_getDestination(&packet), 0x0001);
   TESTEXPR(RIOPACKET_getSource(&packet), 0xffff);
   TESTEXPR(RIOPACKET_getTid(&packet), 0x00);
+  TESTEXPR(RIOPACKET_getInfo(&packet), 0xdeaf);
   RIOPACKET_getDoorbell(&packet, &dstid, &srcid, &tid, &info);
   TESTEXPR(dstid, 0x0001);
   TESTEXPR(srcid, 0xffff);
@@ -509,6 +526,71 @@ void allTests(void)
   RIOPACKET_getNwriteR(&packet, &dstid, &srcid, &tid, &address, &payloadSize, payload);
   TESTEXPR(payloadSize, 8);
 
+  /* Swrite */
+
+  for(i = 8; i <= 256; i += 8)
+  {
+    memset(payload, 0, sizeof(payload));
+    RIOPACKET_setSwrite(&packet, 0x1234, 0x2345, 0x34567898, i, payloadExpected);
+    RIOPACKET_getSwrite(&packet, &dstid, &srcid, &address, &payloadSize, payload);
+
+    TESTEXPR(RIOPACKET_getFtype(&packet), RIOPACKET_FTYPE_STREAMING_WRITE);
+    TESTCOND(RIOPACKET_valid(&packet));
+    TESTEXPR(dstid, 0x1234);
+    TESTEXPR(srcid, 0x2345);
+    TESTEXPR(address, 0x34567898);
+    TESTEXPR(payloadSize, i);
+    TESTEXPR(memcmp(payload, payloadExpected, i), 0);
+  }
+
+  /* Check that unaligned writes are not allowed. */
+  RIOPACKET_setSwrite(&packet, 0x1234, 0x2345, 0x34567894, 8, payloadExpected);
+  TESTEXPR(RIOPACKET_size(&packet), 0);
+  RIOPACKET_setSwrite(&packet, 0x1234, 0x2345, 0x34567898, 12, payloadExpected);
+  TESTEXPR(RIOPACKET_size(&packet), 0);
+  RIOPACKET_setSwrite(&packet, 0x1234, 0x2345, 0x34567898, 0, payloadExpected);
+  TESTEXPR(RIOPACKET_size(&packet), 0);
+
+  /* Check that SWRITE is used when possible. */
+  RIOPACKET_setWrite(&packet, 0x1234, 0x2345, 0x34567898, 24, payloadExpected);
+  TESTEXPR(RIOPACKET_getFtype(&packet), RIOPACKET_FTYPE_STREAMING_WRITE);
+  TESTEXPR(RIOPACKET_size(&packet), 9);
+  RIOPACKET_setWrite(&packet, 0x1234, 0x2345, 0x34567898, 256, payloadExpected);
+  TESTEXPR(RIOPACKET_getFtype(&packet), RIOPACKET_FTYPE_STREAMING_WRITE);
+  RIOPACKET_setWrite(&packet, 0x1234, 0x2345, 0x34567894, 4, payloadExpected);
+  TESTEXPR(RIOPACKET_getFtype(&packet), RIOPACKET_FTYPE_WRITE);
+  TESTCOND(RIOPACKET_valid(&packet));
+
+  /* Data streaming */
+
+  for(k = RIOPACKET_SEGMENT_CONTINUATION; k <= RIOPACKET_SEGMENT_SINGLE; k++)
+  {
+    for(i = 1; i <= 256; i++)
+    {
+      memset(payload, 0, sizeof(payload));
+      RIOPACKET_setDataStreaming(&packet, 0x1234, 0x2345, 0x56, k, 0xabcd, i, payloadExpected);
+      TESTEXPR(RIOPACKET_getDataStreamingSize(&packet), i);
+      RIOPACKET_getDataStreaming(&packet, &dstid, &srcid, &mailbox, &status, &info, &payloadSize, payload);
+
+      TESTEXPR(RIOPACKET_getFtype(&packet), RIOPACKET_FTYPE_DATA_STREAMING);
+      TESTCOND(RIOPACKET_valid(&packet));
+      TESTEXPR(dstid, 0x1234);
+      TESTEXPR(srcid, 0x2345);
+      TESTEXPR(mailbox, 0x56);
+      TESTEXPR(status, k);
+      if(k == RIOPACKET_SEGMENT_CONTINUATION)
+      {
+        TESTEXPR(info, 0);
+      }
+      else
+      {
+        TESTEXPR(info, 0xabcd);
+      }
+      TESTEXPR(payloadSize, i);
+      TESTEXPR(memcmp(payload, payloadExpected, i), 0);
+    }
+  }
+
   /* Nread */
 
   RIOPACKET_setNread(&packet, 0x1234, 0x2345, 0x45, 0x34567890, payloadSizeExpected);
@@ -522,6 +604,65 @@ void allTests(void)
   TESTEXPR(address, 0x34567890);
   TESTEXPR(payloadSize, payloadSizeExpected);
 
+  /* Atomic request */
+
+  for(i = RIOPACKET_TRANSACTION_REQUEST_ATOMIC_INC; i <= RIOPACKET_TRANSACTION_REQUEST_ATOMIC_CLR; i++)
+  {
+    for(j = 0; j < 8; j += 4)
+    {
+      RIOPACKET_setAtomicRequest(&packet, 0x1234, 0x2345, 0x45, i, 0x34567890+j);
+      payloadSize = RIOPACKET_getAtomicRequest(&packet, &dstid, &srcid, &tid, &offset, &address);
+
+      TESTEXPR(RIOPACKET_getFtype(&packet), RIOPACKET_FTYPE_REQUEST);
+      TESTEXPR(RIOPACKET_getTransaction(&packet), i);
+      TESTCOND(RIOPACKET_valid(&packet));
+      TESTEXPR(dstid, 0x1234);
+      TESTEXPR(srcid, 0x2345);
+      TESTEXPR(tid, 0x45);
+      TESTEXPR(offset, i);
+      TESTEXPR(address, 0x34567890+j);
+      TESTEXPR(payloadSize, 4);
+    }
+  }
+
+  RIOPACKET_setAtomicRequest(&packet, 0x1234, 0x2345, 0x45, RIOPACKET_TRANSACTION_REQUEST_ATOMIC_INC, 0x34567892);
+  TESTEXPR(RIOPACKET_size(&packet), 0);
+
+  /* Atomic write */
+
+  for(i = RIOPACKET_TRANSACTION_WRITE_ATOMIC_SWAP; i <= RIOPACKET_TRANSACTION_WRITE_ATOMIC_TEST_AND_SWAP; i++)
+  {
+    for(j = 0; j < 8; j += 4)
+    {
+      RIOPACKET_setAtomicWrite(&packet, 0x1234, 0x2345, 0x45, i, 0x34567890+j, 0xdeadbeef, 0xcafebabe);
+      payloadSize = RIOPACKET_getAtomicWrite(&packet, &dstid, &srcid, &tid, &offset, &address, &data, &dataExpected);
+
+      TESTEXPR(RIOPACKET_getFtype(&packet), RIOPACKET_FTYPE_WRITE);
+      TESTEXPR(RIOPACKET_getTransaction(&packet), i);
+      TESTEXPR(RIOPACKET_size(&packet), 6);
+      TESTCOND(RIOPACKET_valid(&packet));
+      TESTEXPR(dstid, 0x1234);
+      TESTEXPR(srcid, 0x2345);
+      TESTEXPR(tid, 0x45);
+      TESTEXPR(offset, i);
+      TESTEXPR(address, 0x34567890+j);
+      TESTEXPR(payloadSize, 4);
+      TESTEXPR(data, 0xdeadbeef);
+      if(i == RIOPACKET_TRANSACTION_WRITE_ATOMIC_COMPARE_AND_SWAP)
+      {
+        TESTEXPR(dataExpected, 0xcafebabe);
+      }
+      else
+      {
+        TESTEXPR(dataExpected, 0);
+      }
+    }
+  }
+
+  RIOPACKET_setAtomicWrite(&packet, 0x1234, 0x2345, 0x45, RIOPACKET_TRANSACTION_WRITE_ATOMIC_SWAP, 
+                           0x34567891, 0, 0);
+  TESTEXPR(RIOPACKET_size(&packet), 0);
+
   /* Response without payload */
 
   RIOPACKET_setResponseNoPayload(&packet, 0x1234, 0x2345, 0x34, RIOPACKET_RESPONSE_STATUS_ERROR);
@@ -2899,6 +3040,30 @@ void allTests(void)
   TESTEXPR(tid, 0x45);
   TESTEXPR(info, 0x3456);
 
+  /* Flow control */
+
+  RIOPACKET_setFlowControl(&packet, 0x1234, 0x2345, 0, 0x5a, 0x3456);
+  RIOPACKET_getFlowControl(&packet, &dstid, &srcid, &xon, &flowId, &tgtdestId);
+
+  TESTCOND(RIOPACKET_valid(&packet));
+  TESTEXPR(RIOPACKET_getFtype(&packet), RIOPACKET_FTYPE_FLOW_CONTROL);
+  TESTEXPR(RIOPACKET_getPriority(&packet), 3);
+  TESTEXPR(dstid, 0x1234);
+  TESTEXPR(srcid, 0x2345);
+  TESTEXPR(xon, 0);
+  TESTEXPR(flowId, 0x5a);
+  TESTEXPR(tgtdestId, 0x3456);
+
+  RIOPACKET_setFlowControl(&packet, 0xfedc, 0xba98, 1, 0x01, 0x7654);
+  RIOPACKET_getFlowControl(&packet, &dstid, &srcid, &xon, &flowId, &tgtdestId);
+
+  TESTCOND(RIOPACKET_valid(&packet));
+  TESTEXPR(dstid, 0xfedc);
+  TESTEXPR(srcid, 0xba98);
+  TESTEXPR(xon, 1);
+  TESTEXPR(flowId, 0x01);
+  TESTEXPR(tgtdestId, 0x7654);
+
   /* Message response */
 
   RIOPACKET_setResponseMessage(&packet, 0x1234, 0x2345, 0x45, RIOPACKET_RESPONSE_STATUS_DONE);
@@ -2986,6 +3151,7 @@ void allTests(void)
     TESTEXPR(dstid, dstidExpected);
     TESTEXPR(srcid, srcidExpected);
     TESTEXPR(mailbox, mailboxExpected);
+    TESTEXPR(RIOPACKET_getMailbox(&packet), mailboxExpected);
     TESTEXPR(payloadSize, payloadSizeExpected);
     for(j = 0; j < i; j++)
     {
@@ -2996,6 +3162,735 @@ void allTests(void)
   /******************************************************************************/
   TESTEND;
   /******************************************************************************/
+
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("TG_riopacket-TC5");
+  PrintS("Description: Test packets with 8-bit and 32-bit deviceIds and extended ");
+  PrintS("             addresses.");
+  PrintS("Requirement: XXXXX");
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 1:");
+  PrintS("Action: Create packets with 16-bit deviceIds and 34-bit addresses using ");
+  PrintS("        the extended functions.");
+  PrintS("Result: The packets should be identical to the ones created by the ");
+  PrintS("        ordinary functions.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riopacket-TC5-Step1");
+  /******************************************************************************/
+
+  for(i = 0; i < 256; i++)
+  {
+    payloadExpected[i] = rand();
+  }
+
+  RIOPACKET_setNread(&expected, 0x1234, 0x2345, 0x45, 0x89abcdf0, 16);
+  RIOPACKET_setNreadExt(&packet, RIOPACKET_TT_16BITS, RIOPACKET_ADDRESS_34BITS, 
+                        0x1234, 0x2345, 0x45, 0x89abcdf0, 16);
+  testPacket(__LINE__, "nread", packet, expected);
+
+  RIOPACKET_setNwrite(&expected, 0x1234, 0x2345, 0x89abcdf0, 128, payloadExpected);
+  RIOPACKET_setNwriteExt(&packet, RIOPACKET_TT_16BITS, RIOPACKET_ADDRESS_34BITS, 
+                         0x1234, 0x2345, 0x89abcdf0, 128, payloadExpected);
+  testPacket(__LINE__, "nwrite", packet, expected);
+
+  RIOPACKET_setNwriteR(&expected, 0x1234, 0x2345, 0x45, 0x89abcdf3, 1, payloadExpected);
+  RIOPACKET_setNwriteRExt(&packet, RIOPACKET_TT_16BITS, RIOPACKET_ADDRESS_34BITS, 
+                          0x1234, 0x2345, 0x45, 0x89abcdf3, 1, payloadExpected);
+  testPacket(__LINE__, "nwriter", packet, expected);
+
+  RIOPACKET_setResponseNoPayload(&expected, 0x1234, 0x2345, 0x45, RIOPACKET_RESPONSE_STATUS_ERROR);
+  RIOPACKET_setResponseNoPayloadExt(&packet, RIOPACKET_TT_16BITS, 
+                                    0x1234, 0x2345, 0x45, RIOPACKET_RESPONSE_STATUS_ERROR);
+  testPacket(__LINE__, "response", packet, expected);
+
+  RIOPACKET_setResponseWithPayload(&expected, 0x1234, 0x2345, 0x45, 0, 256, payloadExpected);
+  RIOPACKET_setResponseWithPayloadExt(&packet, RIOPACKET_TT_16BITS, 
+                                      0x1234, 0x2345, 0x45, 0, 256, payloadExpected);
+  testPacket(__LINE__, "response", packet, expected);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 2:");
+  PrintS("Action: Create NREAD, NWRITE and NWRITER with all combinations of ");
+  PrintS("        transport types, address sizes, payload sizes and offsets.");
+  PrintS("Result: The content of the packets should be equal to what was entered ");
+  PrintS("        and the same combinations as for the ordinary functions should ");
+  PrintS("        be rejected.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riopacket-TC5-Step2");
+  /******************************************************************************/
+
+  for(j = 0; j < 3; j++)
+  {
+    tt = ttList[j];
+    for(k = 0; k < 3; k++)
+    {
+      addressSize = addressSizeList[k];
+      if(addressSize == RIOPACKET_ADDRESS_34BITS)
+      {
+        addressMask = 0x3fffffff8ull;
+      }
+      else if(addressSize == RIOPACKET_ADDRESS_50BITS)
+      {
+        addressMask = 0x3fffffffffff8ull;
+      }
+      else
+      {
+        addressMask = 0xfffffffffffffff8ull;
+      }
+
+      for(i = 1; i <= 256; i++)
+      {
+        for(offset = 0; offset < 8; offset++)
+        {
+          dstidExt = ((uint32_t) rand() << 16) ^ (uint32_t) rand();
+          srcidExt = ((uint32_t) rand() << 16) ^ (uint32_t) rand();
+          if(tt == RIOPACKET_TT_8BITS)
+          {
+            dstidExt &= 0xff;
+            srcidExt &= 0xff;
+          }
+          else if(tt == RIOPACKET_TT_16BITS)
+          {
+            dstidExt &= 0xffff;
+            srcidExt &= 0xffff;
+          }
+          tidExpected = rand();
+          addressExtExpected = ((((uint64_t) rand()) << 40) ^ (((uint64_t) rand()) << 20) ^ 
+                                ((uint64_t) rand())) & addressMask;
+          addressExtExpected |= offset;
+
+          /* NREAD */
+          RIOPACKET_setNread(&expected, 0, 0, 0, (uint32_t) addressExtExpected, i);
+          RIOPACKET_setNreadExt(&packet, tt, addressSize, dstidExt, srcidExt, tidExpected, 
+                                addressExtExpected, i);
+          if(expected.size != 0)
+          {
+            TESTCOND(RIOPACKET_valid(&packet));
+            TESTEXPR(RIOPACKET_getTt(&packet), tt);
+            TESTEXPR(RIOPACKET_getFtype(&packet), RIOPACKET_FTYPE_REQUEST);
+            TESTEXPR(RIOPACKET_getTransaction(&packet), RIOPACKET_TRANSACTION_REQUEST_NREAD);
+            TESTEXPR(RIOPACKET_getTid(&packet), tidExpected);
+            TESTEXPR(RIOPACKET_getDestinationExt(&packet), dstidExt);
+            TESTEXPR(RIOPACKET_getSourceExt(&packet), srcidExt);
+            TESTEXPR(RIOPACKET_getDestination(&packet), (uint16_t) dstidExt);
+
+            RIOPACKET_getNread(&expected, &dstid, &srcid, &tid, &address, &payloadSizeExpected);
+            RIOPACKET_getNreadExt(&packet, addressSize, &dstidExt, &srcidExt, &tid, 
+                                  &addressExt, &payloadSize);
+            TESTEXPR(tid, tidExpected);
+            TESTEXPR(addressExt, addressExtExpected);
+            TESTEXPR(payloadSize, payloadSizeExpected);
+          }
+          else
+          {
+            TESTEXPR(packet.size, 0);
+          }
+
+          /* NWRITE */
+          RIOPACKET_setNwrite(&expected, 0, 0, (uint32_t) addressExtExpected, i, payloadExpected);
+          RIOPACKET_setNwriteExt(&packet, tt, addressSize, dstidExt, srcidExt, 
+                                 addressExtExpected, i, payloadExpected);
+          if(expected.size == 0)
+          {
+            TESTEXPR(packet.size, 0);
+          }
+          else if(packet.size == 0)
+          {
+            /* Only the largest header combinations may not fit. */
+            TESTCOND((tt == RIOPACKET_TT_32BITS) && (addressSize != RIOPACKET_ADDRESS_34BITS));
+            TESTCOND(i > 248);
+          }
+          else
+          {
+            TESTCOND(RIOPACKET_valid(&packet));
+            TESTCOND(RIOPACKET_valid(&expected));
+            TESTEXPR(RIOPACKET_getTransaction(&packet), RIOPACKET_TRANSACTION_WRITE_NWRITE);
+            RIOPACKET_getNwrite(&expected, &dstid, &srcid, &address, &payloadSizeExpected, payload);
+
+            memset(payload, 0, sizeof(payload));
+            RIOPACKET_getNwriteExt(&packet, addressSize, &dstidExt, &srcidExt, 
+                                   &addressExt, &payloadSize, payload);
+            TESTEXPR(addressExt, addressExtExpected);
+            TESTEXPR(payloadSize, payloadSizeExpected);
+            TESTCOND(memcmp(payload, payloadExpected, (payloadSize < i) ? payloadSize : i) == 0);
+          }
+
+          /* NWRITER */
+          RIOPACKET_setNwriteRExt(&packet, tt, addressSize, dstidExt, srcidExt, tidExpected, 
+                                  addressExtExpected, i, payloadExpected);
+          if(packet.size != 0)
+          {
+            TESTCOND(RIOPACKET_valid(&packet));
+            TESTEXPR(RIOPACKET_getTransaction(&packet), RIOPACKET_TRANSACTION_WRITE_NWRITER);
+            TESTEXPR(RIOPACKET_getTid(&packet), tidExpected);
+
+            memset(payload, 0, sizeof(payload));
+            dstid = dstidExt;
+            srcid = srcidExt;
+            RIOPACKET_getNwriteRExt(&packet, addressSize, &dstidExt, &srcidExt, &tid, 
+                                    &addressExt, &payloadSize, payload);
+            TESTEXPR((uint16_t) dstidExt, dstid);
+            TESTEXPR((uint16_t) srcidExt, srcid);
+            TESTEXPR(tid, tidExpected);
+            TESTEXPR(addressExt, addressExtExpected);
+            TESTEXPR(payloadSize, payloadSizeExpected);
+            TESTCOND(memcmp(payload, payloadExpected, (payloadSize < i) ? payloadSize : i) == 0);
+          }
+          else
+          {
+            /* Don't do anything. */
+          }
+        }
+      }
+    }
+  }
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 3:");
+  PrintS("Action: Create responses with all transport types.");
+  PrintS("Result: The content of the packets should be equal to what was entered.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riopacket-TC5-Step3");
+  /******************************************************************************/
+
+  RIOPACKET_setResponseNoPayloadExt(&packet, RIOPACKET_TT_8BITS, 0x12, 0x23, 0x45, 
+                                    RIOPACKET_RESPONSE_STATUS_RETRY);
+  TESTCOND(RIOPACKET_valid(&packet));
+  TESTEXPR(packet.size, 2);
+  RIOPACKET_getResponseNoPayloadExt(&packet, &dstidExt, &srcidExt, &tid, &status);
+  TESTEXPR(dstidExt, 0x12);
+  TESTEXPR(srcidExt, 0x23);
+  TESTEXPR(tid, 0x45);
+  TESTEXPR(status, RIOPACKET_RESPONSE_STATUS_RETRY);
+
+  /* The fixed-layout getters only decode 16-bit deviceIds. */
+  TEST_numExpectedAssertsRemaining = 1;
+  RIOPACKET_getResponseNoPayload(&packet, &dstid, &srcid, &tid, &status);
+  TESTEXPR(TEST_numExpectedAssertsRemaining, 0);
+
+  RIOPACKET_setResponseNoPayloadExt(&packet, RIOPACKET_TT_32BITS, 0x12345678, 0x9abcdef0, 0x45, 
+                                    RIOPACKET_RESPONSE_STATUS_ERROR);
+  TESTCOND(RIOPACKET_valid(&packet));
+  TESTEXPR(packet.size, 4);
+  TESTEXPR(RIOPACKET_getTransaction(&packet), RIOPACKET_TRANSACTION_RESPONSE_NO_PAYLOAD);
+  TESTEXPR(RIOPACKET_getTid(&packet), 0x45);
+  RIOPACKET_getResponseNoPayloadExt(&packet, &dstidExt, &srcidExt, &tid, &status);
+  TESTEXPR(dstidExt, 0x12345678);
+  TESTEXPR(srcidExt, 0x9abcdef0);
+  TESTEXPR(tid, 0x45);
+  TESTEXPR(status, RIOPACKET_RESPONSE_STATUS_ERROR);
+
+  for(j = 0; j < 3; j++)
+  {
+    tt = ttList[j];
+    for(i = 1; i <= 256; i++)
+    {
+      if(i < 8)
+      {
+        offset = rand() % (9-i);
+        payloadSizeExpected = i;
+      }
+      else
+      {
+        offset = 0;
+        payloadSizeExpected = (i+7) & ~7;
+      }
+
+      RIOPACKET_setResponseWithPayloadExt(&packet, tt, 0x12, 0x23, 0x45, offset, 
+                                          payloadSizeExpected, payloadExpected);
+      TESTCOND(RIOPACKET_valid(&packet));
+      TESTEXPR(RIOPACKET_getTt(&packet), tt);
+      TESTEXPR(RIOPACKET_getTransaction(&packet), RIOPACKET_TRANSACTION_RESPONSE_WITH_PAYLOAD);
+      TESTEXPR(RIOPACKET_getTid(&packet), 0x45);
+
+      memset(payload, 0, sizeof(payload));
+      payloadSize = RIOPACKET_getResponseWithPayloadExt(&packet, &dstidExt, &srcidExt, &tid, 
+                                                        offset, payloadSizeExpected, payload);
+      TESTEXPR(dstidExt, 0x12);
+      TESTEXPR(srcidExt, 0x23);
+      TESTEXPR(tid, 0x45);
+      TESTEXPR(payloadSize, payloadSizeExpected);
+      TESTCOND(memcmp(payload, payloadExpected, payloadSizeExpected) == 0);
+
+      if(i >= 8)
+      {
+        payloadSize = RIOPACKET_getResponseWithPayloadExt(&packet, &dstidExt, &srcidExt, &tid, 
+                                                          offset, 0, payload);
+        TESTEXPR(payloadSize, payloadSizeExpected);
+      }
+    }
+  }
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 4:");
+  PrintS("Action: Check the packet sizes of the different header formats.");
+  PrintS("Result: 8-bit deviceIds should give the shortest packets and packets ");
+  PrintS("        that does not fit should be rejected.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riopacket-TC5-Step4");
+  /******************************************************************************/
+
+  /* NREAD: 10, 12 and 16 byte headers. */
+  RIOPACKET_setNreadExt(&packet, RIOPACKET_TT_8BITS, RIOPACKET_ADDRESS_34BITS, 
+                        0x12, 0x23, 0x45, 0x100, 8);
+  TESTEXPR(packet.size, 3);
+  RIOPACKET_setNreadExt(&packet, RIOPACKET_TT_16BITS, RIOPACKET_ADDRESS_34BITS, 
+                        0x12, 0x23, 0x45, 0x100, 8);
+  TESTEXPR(packet.size, 4);
+  RIOPACKET_setNreadExt(&packet, RIOPACKET_TT_32BITS, RIOPACKET_ADDRESS_34BITS, 
+                        0x12, 0x23, 0x45, 0x100, 8);
+  TESTEXPR(packet.size, 5);
+  RIOPACKET_setNreadExt(&packet, RIOPACKET_TT_32BITS, RIOPACKET_ADDRESS_66BITS, 
+                        0x12, 0x23, 0x45, 0x100, 8);
+  TESTEXPR(packet.size, 6);
+
+  /* NWRITE: 8 byte payload. */
+  RIOPACKET_setNwriteExt(&packet, RIOPACKET_TT_8BITS, RIOPACKET_ADDRESS_34BITS, 
+                         0x12, 0x23, 0x100, 8, payloadExpected);
+  TESTEXPR(packet.size, 5);
+  RIOPACKET_setNwriteExt(&packet, RIOPACKET_TT_16BITS, RIOPACKET_ADDRESS_34BITS, 
+                         0x12, 0x23, 0x100, 8, payloadExpected);
+  TESTEXPR(packet.size, 6);
+
+  /* The largest header combinations cannot carry 256 bytes. */
+  RIOPACKET_setNwriteExt(&packet, RIOPACKET_TT_16BITS, RIOPACKET_ADDRESS_66BITS, 
+                         0x12, 0x23, 0x100, 256, payloadExpected);
+  TESTEXPR(packet.size, RIOPACKET_SIZE_MAX);
+  TESTCOND(RIOPACKET_valid(&packet));
+  RIOPACKET_setNwriteExt(&packet, RIOPACKET_TT_32BITS, RIOPACKET_ADDRESS_66BITS, 
+                         0x12, 0x23, 0x100, 256, payloadExpected);
+  TESTEXPR(packet.size, 0);
+  RIOPACKET_setNwriteExt(&packet, RIOPACKET_TT_32BITS, RIOPACKET_ADDRESS_66BITS, 
+                         0x12, 0x23, 0x100, 248, payloadExpected);
+  TESTCOND(RIOPACKET_valid(&packet));
+
+  /* The two most significant bits of a 34-bit and a 50-bit address are placed in xamsbs. */
+  RIOPACKET_setNreadExt(&packet, RIOPACKET_TT_8BITS, RIOPACKET_ADDRESS_34BITS, 
+                        0x12, 0x23, 0x45, 0x312345678ull, 1);
+  TESTEXPR((packet.payload[2] >> 16) & 0x3, 0x3);
+  RIOPACKET_setNreadExt(&packet, RIOPACKET_TT_16BITS, RIOPACKET_ADDRESS_50BITS, 
+                        0x1234, 0x2345, 0x45, 0x2abcd12345678ull, 1);
+  TESTEXPR(packet.payload[2], 0xabcd1234);
+  TESTEXPR(packet.payload[3] >> 16, 0x567a);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("TG_riopacket-TC6");
+  PrintS("Description: Test changing header fields of encoded packets.");
+  PrintS("Requirement: XXXXX");
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 1:");
+  PrintS("Action: Change the deviceIds and the tid of NWRITER packets with all ");
+  PrintS("        transport types, address sizes and payload sizes.");
+  PrintS("Result: The packets should be identical to packets created with the ");
+  PrintS("        new field values.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riopacket-TC6-Step1");
+  /******************************************************************************/
+
+  for(j = 0; j < 3; j++)
+  {
+    tt = ttList[j];
+    for(k = 0; k < 3; k++)
+    {
+      addressSize = addressSizeList[k];
+      for(i = 1; i <= 256; i++)
+      {
+        dstidExt = ((uint32_t) rand() << 16) ^ (uint32_t) rand();
+        srcidExt = ((uint32_t) rand() << 16) ^ (uint32_t) rand();
+        if(tt == RIOPACKET_TT_8BITS)
+        {
+          dstidExt &= 0xff;
+          srcidExt &= 0xff;
+        }
+        else if(tt == RIOPACKET_TT_16BITS)
+        {
+          dstidExt &= 0xffff;
+          srcidExt &= 0xffff;
+        }
+        else
+        {
+          /* Use all 32 bits. */
+        }
+
+        RIOPACKET_setNwriteRExt(&expected, tt, addressSize, dstidExt, srcidExt, (uint8_t) i, 
+                                0x1000, (uint16_t) i, payloadExpected);
+        if(expected.size != 0)
+        {
+          RIOPACKET_setNwriteRExt(&packet, tt, addressSize, srcidExt, dstidExt, 0x12, 
+                                  0x1000, (uint16_t) i, payloadExpected);
+          RIOPACKET_patchHeaderExt(&packet, addressSize, RIOPACKET_FIELD_DESTINATION, dstidExt);
+          RIOPACKET_patchHeaderExt(&packet, addressSize, RIOPACKET_FIELD_SOURCE, srcidExt);
+          RIOPACKET_patchHeaderExt(&packet, addressSize, RIOPACKET_FIELD_TID, (uint8_t) i);
+          testPacket(__LINE__, "nwriter", packet, expected);
+        }
+        else
+        {
+          /* The payload does not fit with this header. */
+        }
+      }
+    }
+  }
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 2:");
+  PrintS("Action: Change the deviceIds of doorbells and data streaming segments ");
+  PrintS("        with the crc in both the upper and the lower half-word.");
+  PrintS("Result: The packets should be identical to packets created with the ");
+  PrintS("        new field values.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riopacket-TC6-Step2");
+  /******************************************************************************/
+
+  for(i = 0; i < 1000; i++)
+  {
+    dstidExpected = (uint16_t) rand();
+    srcidExpected = (uint16_t) rand();
+    infoExpected = (uint16_t) rand();
+    RIOPACKET_setDoorbell(&packet, 0xffff, 0x0000, 0x12, infoExpected);
+    RIOPACKET_patchHeader(&packet, RIOPACKET_FIELD_DESTINATION, dstidExpected);
+    RIOPACKET_patchHeader(&packet, RIOPACKET_FIELD_SOURCE, srcidExpected);
+    RIOPACKET_setDoorbell(&expected, dstidExpected, srcidExpected, 0x12, infoExpected);
+    testPacket(__LINE__, "doorbell", packet, expected);
+  }
+
+  for(i = 1; i <= 256; i++)
+  {
+    dstidExpected = (uint16_t) rand();
+    srcidExpected = (uint16_t) rand();
+    RIOPACKET_setDataStreaming(&packet, 0x0000, 0xffff, 0x34, RIOPACKET_SEGMENT_SINGLE, 
+                               0x5678, (uint16_t) ((i+1) & ~1), payloadExpected);
+    RIOPACKET_patchHeader(&packet, RIOPACKET_FIELD_DESTINATION, dstidExpected);
+    RIOPACKET_patchHeader(&packet, RIOPACKET_FIELD_SOURCE, srcidExpected);
+    RIOPACKET_setDataStreaming(&expected, dstidExpected, srcidExpected, 0x34, RIOPACKET_SEGMENT_SINGLE, 
+                               0x5678, (uint16_t) ((i+1) & ~1), payloadExpected);
+    testPacket(__LINE__, "data streaming", packet, expected);
+  }
+
+  /* A packet with the crc in the lower half-word where the crc is zero. */
+  RIOPACKET_setDoorbell(&packet, 0x6a76, 0x0000, 0x00, 0xfc12);
+  TESTEXPR(packet.payload[2] & 0xffff, 0x0000);
+  RIOPACKET_patchHeader(&packet, RIOPACKET_FIELD_DESTINATION, 0x0099);
+  RIOPACKET_setDoorbell(&expected, 0x0099, 0x0000, 0x00, 0xfc12);
+  testPacket(__LINE__, "doorbell", packet, expected);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 3:");
+  PrintS("Action: Change the priority and virtual channel of short and long ");
+  PrintS("        packets.");
+  PrintS("Result: The packets should be valid with the new priority and only ");
+  PrintS("        the first word and the crc covering it should be changed.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riopacket-TC6-Step3");
+  /******************************************************************************/
+
+  for(i = 8; i <= 256; i += 8)
+  {
+    RIOPACKET_setNwrite(&expected, 0x1234, 0x5678, 0x1000, (uint16_t) i, payloadExpected);
+    packet = expected;
+    for(j = 1; j < 4; j++)
+    {
+      RIOPACKET_patchHeader(&packet, RIOPACKET_FIELD_PRIORITY, (uint32_t) j);
+      TESTEXPR(RIOPACKET_getPriority(&packet), j);
+      TESTCOND(RIOPACKET_valid(&packet));
+      for(k = 1; k < packet.size; k++)
+      {
+        if(k != ((packet.size > 20) ? 20 : (packet.size-1)))
+        {
+          TESTEXPR(packet.payload[k], expected.payload[k]);
+        }
+      }
+    }
+    RIOPACKET_patchHeader(&packet, RIOPACKET_FIELD_PRIORITY, 0);
+    testPacket(__LINE__, "nwrite", packet, expected);
+
+    RIOPACKET_patchHeader(&packet, RIOPACKET_FIELD_VC, 1);
+    TESTEXPR(RIOPACKET_getVc(&packet), 1);
+    TESTEXPR(RIOPACKET_getPriority(&packet), 0);
+    TESTCOND(RIOPACKET_valid(&packet));
+    RIOPACKET_patchHeader(&packet, RIOPACKET_FIELD_VC, 0);
+    TESTEXPR(RIOPACKET_getVc(&packet), 0);
+    testPacket(__LINE__, "nwrite", packet, expected);
+  }
+
+  /* The ackId is not covered by the crc and is kept. */
+  RIOPACKET_setDoorbell(&expected, 0x1234, 0x5678, 0x9a, 0xbcde);
+  expected.payload[0] |= 0xf8000000ul;
+  packet = expected;
+  RIOPACKET_patchHeader(&packet, RIOPACKET_FIELD_PRIORITY, 2);
+  TESTEXPR(packet.payload[0] >> 27, 0x1f);
+  TESTCOND(RIOPACKET_valid(&packet));
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 4:");
+  PrintS("Action: Change fields to values that do not fit.");
+  PrintS("Result: Asserts should be raised.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riopacket-TC6-Step4");
+  /******************************************************************************/
+
+  RIOPACKET_setNreadExt(&packet, RIOPACKET_TT_8BITS, RIOPACKET_ADDRESS_34BITS, 
+                        0x12, 0x23, 0x45, 0x100, 8);
+
+  TEST_numExpectedAssertsRemaining = 1;
+  RIOPACKET_patchHeader(&packet, RIOPACKET_FIELD_PRIORITY, 4);
+  TESTEXPR(TEST_numExpectedAssertsRemaining, 0);
+
+  TEST_numExpectedAssertsRemaining = 1;
+  RIOPACKET_patchHeader(&packet, RIOPACKET_FIELD_DESTINATION, 0x100);
+  TESTEXPR(TEST_numExpectedAssertsRemaining, 0);
+
+  TEST_numExpectedAssertsRemaining = 1;
+  RIOPACKET_patchHeader(&packet, RIOPACKET_FIELD_TID, 0x100);
+  TESTEXPR(TEST_numExpectedAssertsRemaining, 0);
+
+  TEST_numExpectedAssertsRemaining = 1;
+  RIOPACKET_patchHeader(&packet, RIOPACKET_FIELD_VC, 2);
+  TESTEXPR(TEST_numExpectedAssertsRemaining, 0);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("TG_riopacket-TC7");
+  PrintS("Description: Test creating packets from templates.");
+  PrintS("Requirement: XXXXX");
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 1:");
+  PrintS("Action: Create NWRITE and NWRITER packets from templates with all ");
+  PrintS("        payload sizes and different addresses and tids.");
+  PrintS("Result: The packets should be identical to packets created with ");
+  PrintS("        RIOPACKET_setNwrite() and RIOPACKET_setNwriteR().");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riopacket-TC7-Step1");
+  /******************************************************************************/
+
+  for(i = 8; i <= 256; i += 8)
+  {
+    dstidExpected = (uint16_t) rand();
+    srcidExpected = (uint16_t) rand();
+
+    RIOPACKET_setNwriteTemplate(&packetTemplate, dstidExpected, srcidExpected, (uint16_t) i);
+    TESTCOND(packetTemplate.size != 0);
+    for(j = 0; j < 4; j++)
+    {
+      addressExpected = ((uint32_t) rand() << 3) & 0x1ffffff8ul;
+      RIOPACKET_setNwrite(&expected, dstidExpected, srcidExpected, addressExpected, 
+                          (uint16_t) i, payloadExpected);
+      RIOPACKET_setNwriteFromTemplate(&packet, &packetTemplate, (uint8_t) j, addressExpected, 
+                                      payloadExpected);
+      TESTEXPR(packet.size, packetTemplate.size);
+      testPacket(__LINE__, "nwrite", packet, expected);
+    }
+
+    RIOPACKET_setNwriteRTemplate(&packetTemplate, dstidExpected, srcidExpected, (uint16_t) i);
+    TESTCOND(packetTemplate.size != 0);
+    for(j = 0; j < 4; j++)
+    {
+      addressExpected = ((uint32_t) rand() << 3) & 0x1ffffff8ul;
+      tidExpected = (uint8_t) rand();
+      RIOPACKET_setNwriteR(&expected, dstidExpected, srcidExpected, tidExpected, addressExpected, 
+                           (uint16_t) i, payloadExpected);
+      RIOPACKET_setNwriteFromTemplate(&packet, &packetTemplate, tidExpected, addressExpected, 
+                                      payloadExpected);
+      TESTEXPR(packet.size, packetTemplate.size);
+      testPacket(__LINE__, "nwriter", packet, expected);
+    }
+  }
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 2:");
+  PrintS("Action: Create templates with payload sizes that cannot be written ");
+  PrintS("        in one packet and use them.");
+  PrintS("Result: The templates and the packets should be invalid.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riopacket-TC7-Step2");
+  /******************************************************************************/
+
+  for(i = 1; i <= 256; i++)
+  {
+    RIOPACKET_setNwrite(&expected, 0x1234, 0x5678, 0x1000, (uint16_t) i, payloadExpected);
+    RIOPACKET_setNwriteTemplate(&packetTemplate, 0x1234, 0x5678, (uint16_t) i);
+    if(((i & 7) == 0) && (expected.size != 0))
+    {
+      TESTEXPR(packetTemplate.size, expected.size);
+    }
+    else
+    {
+      TESTEXPR(packetTemplate.size, 0);
+      packet.size = 1;
+      RIOPACKET_setNwriteFromTemplate(&packet, &packetTemplate, 0, 0x1000, payloadExpected);
+      TESTEXPR(packet.size, 0);
+    }
+  }
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 3:");
+  PrintS("Action: Use a template with an address that is not double-word ");
+  PrintS("        aligned.");
+  PrintS("Result: An assert should be raised.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riopacket-TC7-Step3");
+  /******************************************************************************/
+
+  RIOPACKET_setNwriteTemplate(&packetTemplate, 0x1234, 0x5678, 8);
+
+  TEST_numExpectedAssertsRemaining = 1;
+  RIOPACKET_setNwriteFromTemplate(&packet, &packetTemplate, 0, 0x1004, payloadExpected);
+  TESTEXPR(TEST_numExpectedAssertsRemaining, 0);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("TG_riopacket-TC8");
+  PrintS("Description: Test validating several packets at the same time.");
+  PrintS("Requirement: XXXXX");
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 1:");
+  PrintS("Action: Validate batches of packets with different sizes where some ");
+  PrintS("        of the packets have been corrupted.");
+  PrintS("Result: The bitmap should contain the result of RIOPACKET_valid() for ");
+  PrintS("        each packet and the number of valid packets should be returned.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riopacket-TC8-Step1");
+  /******************************************************************************/
+
+  for(i = 0; i < 100; i++)
+  {
+    switch(rand() % 4)
+    {
+      case 0:
+        RIOPACKET_setDoorbell(&batch[i], (uint16_t) rand(), (uint16_t) rand(), (uint8_t) rand(), 
+                              (uint16_t) rand());
+        break;
+      case 1:
+        RIOPACKET_setNread(&batch[i], (uint16_t) rand(), (uint16_t) rand(), (uint8_t) rand(), 
+                           0x1000, 8);
+        break;
+      default:
+        RIOPACKET_setNwrite(&batch[i], (uint16_t) rand(), (uint16_t) rand(), 0x1000, 
+                            (uint16_t) (8 * (1 + (rand() % 32))), payloadExpected);
+        break;
+    }
+
+    /* The ackId is not covered by the crc. */
+    batch[i].payload[0] |= ((uint32_t) rand() & 0x1ful) << 27;
+
+    switch(rand() % 6)
+    {
+      case 0:
+        /* Corrupt a random word. */
+        batch[i].payload[rand() % batch[i].size] ^= 1ul << (rand() % 26);
+        break;
+      case 1:
+        /* Corrupt the embedded crc or the last word. */
+        batch[i].payload[(batch[i].size > 20) ? 20 : (batch[i].size-1)] ^= 0x00010000ul;
+        break;
+      case 2:
+        /* Invalid size. */
+        batch[i].size = ((rand() % 2) == 0) ? 1 : 70;
+        break;
+      default:
+        /* Keep the packet valid. */
+        break;
+    }
+    batchList[i] = &batch[i];
+  }
+
+  for(i = 0; i <= 100; i += 1 + (i/4))
+  {
+    results[0] = 0xfffffffful;
+    results[1] = 0xfffffffful;
+    results[2] = 0xfffffffful;
+    results[3] = 0xfffffffful;
+    k = 0;
+    for(j = 0; j < i; j++)
+    {
+      k += RIOPACKET_valid(batchList[j]) ? 1 : 0;
+    }
+    TESTEXPR(RIOPACKET_validBatch(batchList, (uint32_t) i, results), k);
+    for(j = 0; j < i; j++)
+    {
+      TESTEXPR((results[j/32] >> (j%32)) & 1, RIOPACKET_valid(batchList[j]) ? 1 : 0);
+    }
+    for(j = i; j < (32*((i+31)/32)); j++)
+    {
+      TESTEXPR((results[j/32] >> (j%32)) & 1, 0);
+    }
+    for(j = (i+31)/32; j < 4; j++)
+    {
+      TESTEXPR(results[j], 0xfffffffful);
+    }
+  }
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 2:");
+  PrintS("Action: Validate a batch of valid packets with all payload sizes.");
+  PrintS("Result: All packets should be valid.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riopacket-TC8-Step2");
+  /******************************************************************************/
+
+  for(i = 0; i < 100; i++)
+  {
+    RIOPACKET_setNwrite(&batch[i], 0x1234, 0x5678, 0x1000, (uint16_t) ((i % 64) * 4 + 4), 
+                        payloadExpected);
+    batchList[i] = &batch[i];
+  }
+
+  TESTEXPR(RIOPACKET_validBatch(batchList, 100, results), 100);
+  TESTEXPR(results[0], 0xfffffffful);
+  TESTEXPR(results[1], 0xfffffffful);
+  TESTEXPR(results[2], 0xfffffffful);
+  TESTEXPR(results[3], 0x0000000ful);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
 }
 
 CU_ErrorCode addTests( void )
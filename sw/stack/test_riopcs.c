@@ -0,0 +1,655 @@
+/******************************************************************************
+ * (C) Copyright 2013-2015 Magnus Rosenius and the Free Software Foundation.
+ *
+ * This file is part of OpenRIO.
+ *
+ * OpenRIO is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenRIO is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Lesser Public License
+ * along with OpenRIO.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+
+/******************************************************************************
+ * Description:
+ * Unit tests for riopcs.c.
+ ******************************************************************************/
+
+
+#define MODULE_TEST
+#include "riopcs.c"
+#include "riostack.c"
+#include "riopacket.c"
+#include "riopool.c"
+#include <CUnit/CUnit.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PrintS(s) printf(s "\n")
+
+#define TESTSTART(s) printf(s "...")
+#define TESTEND printf(" done.\n");
+
+#define TESTCOND(got) CU_ASSERT(got)
+#define TESTEXPR(got, expected) CU_ASSERT_EQUAL((got), (expected))
+
+#define QUEUE_LENGTH 8
+#define SYMBOLS 2000
+
+int TEST_numExpectedAssertsRemaining = 0;
+
+static RioPcs_t pcsA;
+static RioPcs_t pcsB;
+
+static uint16_t characters[4*SYMBOLS];
+static uint16_t decoded[4*SYMBOLS];
+static uint16_t codeGroups[RIOPCS_CODE_GROUPS_MAX(SYMBOLS)];
+static uint16_t unpacked[RIOPCS_CODE_GROUPS_MAX(SYMBOLS)];
+static uint8_t bits[2*RIOPCS_CODE_GROUPS_MAX(SYMBOLS)];
+static RioSymbol_t symbols[SYMBOLS];
+static RioSymbol_t received[RIOPCS_CODE_GROUPS_MAX(SYMBOLS)];
+
+#define TEST_RIOLINK_CODEC
+#include "test_riolink.h"
+
+/* Get the disparity of a code group. */
+static int codeGroupDisparity(uint16_t codeGroup)
+{
+  int i;
+  int d;
+
+  d = 0;
+  for(i = 0; i < 10; i++)
+  {
+    d += ((codeGroup >> i) & 1) ? 1 : -1;
+  }
+  return d;
+}
+
+/* Get the longest run of equal bits in a sequence of code groups. */
+static int longestRun(uint32_t count, const uint16_t *c)
+{
+  uint32_t i;
+  int j;
+  int bit;
+  int last;
+  int run;
+  int longest;
+
+  last = -1;
+  run = 0;
+  longest = 0;
+  for(i = 0; i < count; i++)
+  {
+    for(j = 9; j >= 0; j--)
+    {
+      bit = (c[i] >> j) & 1;
+      run = (bit == last) ? (run + 1) : 1;
+      last = bit;
+      longest = (run > longest) ? run : longest;
+    }
+  }
+  return longest;
+}
+
+/* Remove the first bits of a bitstream. */
+static void shiftBits(uint32_t shift, uint32_t bitCount, uint8_t *b)
+{
+  uint32_t i;
+  uint32_t from;
+
+  for(i = 0; i < bitCount - shift; i++)
+  {
+    from = i + shift;
+    if((b[from >> 3] >> (7 - (from & 7))) & 1)
+    {
+      b[i >> 3] |= (uint8_t) (0x80 >> (i & 7));
+    }
+    else
+    {
+      b[i >> 3] &= (uint8_t) ~(0x80 >> (i & 7));
+    }
+  }
+}
+
+/* Exchange symbols between two stacks through two PCSs. */
+static void runLink(int symbols)
+{
+  uint16_t c[RIOPCS_CODE_GROUPS_MAX(1)];
+  uint32_t n;
+  int i;
+
+  for(i = 0; i < symbols; i++)
+  {
+    n = RIOPCS_transmit(&pcsA, &stackA, 1, c);
+    RIOPCS_receive(&pcsB, &stackB, n, c);
+    n = RIOPCS_transmit(&pcsB, &stackB, 1, c);
+    RIOPCS_receive(&pcsA, &stackA, n, c);
+  }
+}
+
+/*******************************************************************************
+ * Module test for this file.
+ *******************************************************************************/
+
+static void allTests(void)
+{
+  RioPacket_t packet;
+  RioSymbol_t s[4];
+  uint16_t dstid;
+  uint16_t srcid;
+  uint8_t tid;
+  uint16_t info;
+  uint16_t c;
+  uint16_t d;
+  uint32_t n;
+  uint32_t m;
+  uint32_t offset;
+  int disparity;
+  int minimum;
+  int maximum;
+  int i;
+  int j;
+
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("TG_riopcs");
+  PrintS("----------------------------------------------------------------------");
+  PrintS("TG_riopcs-TC1");
+  PrintS("Description: Test 8b/10b encoding and decoding of characters.");
+  PrintS("Requirement: XXXXX");
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 1:");
+  PrintS("Action: Encode characters with known code groups.");
+  PrintS("Result: The code groups and the running disparity should match the ");
+  PrintS("8b/10b tables.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riopcs-TC1-Step1");
+  /******************************************************************************/
+
+  RIOPCS_open(&pcsA);
+
+  /* K28.5 flips the running disparity. */
+  c = RIOPCS_K;
+  RIOPCS_encodeCharacters(&pcsA, 1, &c, &d);
+  TESTEXPR(d, 0x0fa);
+  TESTEXPR(pcsA.txDisparity, DISPARITY_PLUS);
+  RIOPCS_encodeCharacters(&pcsA, 1, &c, &d);
+  TESTEXPR(d, 0x305);
+  TESTEXPR(pcsA.txDisparity, DISPARITY_MINUS);
+
+  /* D.0.0 keeps the running disparity. */
+  c = 0x00;
+  RIOPCS_encodeCharacters(&pcsA, 1, &c, &d);
+  TESTEXPR(d, 0x274);
+  TESTEXPR(pcsA.txDisparity, DISPARITY_MINUS);
+  c = RIOPCS_K;
+  RIOPCS_encodeCharacters(&pcsA, 1, &c, &d);
+  c = 0x00;
+  RIOPCS_encodeCharacters(&pcsA, 1, &c, &d);
+  TESTEXPR(d, 0x18b);
+  TESTEXPR(pcsA.txDisparity, DISPARITY_PLUS);
+  c = RIOPCS_K;
+  RIOPCS_encodeCharacters(&pcsA, 1, &c, &d);
+
+  /* D.21.5 is neutral. */
+  c = 0xb5;
+  RIOPCS_encodeCharacters(&pcsA, 1, &c, &d);
+  TESTEXPR(d, 0x2aa);
+  TESTEXPR(pcsA.txDisparity, DISPARITY_MINUS);
+
+  /* D.7 and D.x.3 changes with the running disparity even if neutral. */
+  c = 0x07;
+  RIOPCS_encodeCharacters(&pcsA, 1, &c, &d);
+  TESTEXPR(d, 0x38b);
+  TESTEXPR(pcsA.txDisparity, DISPARITY_PLUS);
+  RIOPCS_encodeCharacters(&pcsA, 1, &c, &d);
+  TESTEXPR(d, 0x074);
+  c = 0x63;
+  RIOPCS_encodeCharacters(&pcsA, 1, &c, &d);
+  TESTEXPR(d, 0x31c);
+
+  /* The alternate D.x.7 encoding. */
+  RIOPCS_open(&pcsA);
+  c = 0xf1;
+  RIOPCS_encodeCharacters(&pcsA, 1, &c, &d);
+  TESTEXPR(d, 0x237);
+  c = 0xeb;
+  RIOPCS_encodeCharacters(&pcsA, 1, &c, &d);
+  TESTEXPR(d, 0x348);
+
+  /* The special characters of serial RapidIO. */
+  RIOPCS_open(&pcsA);
+  c = RIOPCS_SC;
+  RIOPCS_encodeCharacters(&pcsA, 1, &c, &d);
+  TESTEXPR(d, 0x0f4);
+  c = RIOPCS_PD;
+  RIOPCS_encodeCharacters(&pcsA, 1, &c, &d);
+  TESTEXPR(d, 0x0f3);
+  c = RIOPCS_A;
+  RIOPCS_encodeCharacters(&pcsA, 1, &c, &d);
+  TESTEXPR(d, 0x097);
+  c = RIOPCS_R;
+  RIOPCS_encodeCharacters(&pcsA, 1, &c, &d);
+  TESTEXPR(d, 0x117);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 2:");
+  PrintS("Action: Encode all characters with both running disparities and a ");
+  PrintS("        long random sequence of characters and decode them.");
+  PrintS("Result: All characters should be decoded without errors, the running ");
+  PrintS("        disparity should stay within +-1, there should be no runs ");
+  PrintS("        longer than five bits and commas should only be found in ");
+  PrintS("        K28.1, K28.5 and K28.7.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riopcs-TC1-Step2");
+  /******************************************************************************/
+
+  for(i = 0; i < 2; i++)
+  {
+    for(j = 0; j < 512; j++)
+    {
+      if((j < 256) || ((j & 0x1f) == 28) ||
+         ((j >> 5) == 15 && ((j & 0x1f) == 23 || (j & 0x1f) == 27 ||
+                             (j & 0x1f) == 29 || (j & 0x1f) == 30)))
+      {
+        RIOPCS_open(&pcsA);
+        RIOPCS_open(&pcsB);
+        pcsA.txDisparity = i;
+        pcsB.rxDisparity = i;
+        c = j;
+        RIOPCS_encodeCharacters(&pcsA, 1, &c, &d);
+        TESTEXPR(RIOPCS_decodeCharacters(&pcsB, 1, &d, &c), 0);
+        TESTEXPR(c, j);
+        TESTEXPR(pcsB.rxDisparity, pcsA.txDisparity);
+        disparity = codeGroupDisparity(d);
+        TESTCOND((disparity == 0) || (disparity == ((i == 0) ? 2 : -2)));
+        offset = RIOPCS_findComma(10, (uint8_t[]) {d >> 2, d << 6});
+        if((j == 0x13c) || (j == 0x1bc) || (j == 0x1fc))
+        {
+          TESTEXPR(offset, 0);
+        }
+        else
+        {
+          TESTEXPR(offset, 10);
+        }
+      }
+    }
+  }
+
+  RIOPCS_open(&pcsA);
+  RIOPCS_open(&pcsB);
+  for(i = 0; i < 4*SYMBOLS; i++)
+  {
+    characters[i] = (uint16_t) (rand() & 0xff);
+    if((i % 7) == 0)
+    {
+      characters[i] = RIOPCS_R;
+    }
+  }
+  RIOPCS_encodeCharacters(&pcsA, 4*SYMBOLS, characters, codeGroups);
+  TESTEXPR(RIOPCS_decodeCharacters(&pcsB, 4*SYMBOLS, codeGroups, decoded), 0);
+  TESTCOND(memcmp(characters, decoded, sizeof(characters)) == 0);
+  TESTCOND(longestRun(4*SYMBOLS, codeGroups) <= 5);
+  disparity = 0;
+  minimum = 0;
+  maximum = 0;
+  for(i = 0; i < 4*SYMBOLS; i++)
+  {
+    disparity += codeGroupDisparity(codeGroups[i]);
+    minimum = (disparity < minimum) ? disparity : minimum;
+    maximum = (disparity > maximum) ? disparity : maximum;
+  }
+  TESTEXPR(minimum, 0);
+  TESTEXPR(maximum, 2);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 3:");
+  PrintS("Action: Decode invalid code groups and code groups with the wrong ");
+  PrintS("        disparity. Encode an invalid special character.");
+  PrintS("Result: The errors should be marked and counted and the encoding ");
+  PrintS("        should assert.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riopcs-TC1-Step3");
+  /******************************************************************************/
+
+  RIOPCS_open(&pcsB);
+  d = 0x000;
+  TESTEXPR(RIOPCS_decodeCharacters(&pcsB, 1, &d, &c), 1);
+  TESTEXPR(c, RIOPCS_CHARACTER_ERROR);
+  d = 0x3ff;
+  TESTEXPR(RIOPCS_decodeCharacters(&pcsB, 1, &d, &c), 1);
+  TESTEXPR(pcsB.statusRxCodeError, 2);
+
+  /* D.0.0 with positive disparity when the running disparity is negative. */
+  RIOPCS_open(&pcsB);
+  d = 0x18b;
+  TESTEXPR(RIOPCS_decodeCharacters(&pcsB, 1, &d, &c), 1);
+  TESTEXPR(c, RIOPCS_CHARACTER_ERROR | 0x00);
+  TESTEXPR(pcsB.statusRxDisparityError, 1);
+  TESTEXPR(pcsB.rxDisparity, DISPARITY_PLUS);
+  d = 0x18b;
+  TESTEXPR(RIOPCS_decodeCharacters(&pcsB, 1, &d, &c), 0);
+  TESTEXPR(c, 0x00);
+
+  RIOPCS_open(&pcsA);
+  c = RIOPCS_CHARACTER_K | 0x00;
+  TEST_numExpectedAssertsRemaining = 1;
+  RIOPCS_encodeCharacters(&pcsA, 1, &c, &d);
+  TESTEXPR(TEST_numExpectedAssertsRemaining, 0);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("TG_riopcs-TC2");
+  PrintS("Description: Test encoding and decoding of symbols.");
+  PrintS("Requirement: XXXXX");
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 1:");
+  PrintS("Action: Encode control, data and idle symbols.");
+  PrintS("Result: Packet delimiting control symbols should start with PD and ");
+  PrintS("        other control symbols with SC. Idle symbols should start with ");
+  PrintS("        K. Only control and data symbols should be decoded.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riopcs-TC2-Step1");
+  /******************************************************************************/
+
+  RIOPCS_open(&pcsA);
+  RIOPCS_open(&pcsB);
+  s[0].type = RIOSTACK_SYMBOL_TYPE_CONTROL;
+  s[0].data = 0xab123012;
+  s[1].type = RIOSTACK_SYMBOL_TYPE_IDLE;
+  s[1].data = 0;
+  s[2].type = RIOSTACK_SYMBOL_TYPE_DATA;
+  s[2].data = 0xdeadbeef;
+  s[3].type = RIOSTACK_SYMBOL_TYPE_CONTROL;
+  s[3].data = 0x00123712;
+  n = RIOPCS_encodeSymbols(&pcsA, 4, s, codeGroups);
+  TESTEXPR(n, 16);
+  TESTEXPR(RIOPCS_decodeCharacters(&pcsB, n, codeGroups, decoded), 0);
+  TESTEXPR(decoded[0], RIOPCS_PD);
+  TESTEXPR(decoded[1], 0x12);
+  TESTEXPR(decoded[2], 0x30);
+  TESTEXPR(decoded[3], 0x12);
+  TESTEXPR(decoded[4], RIOPCS_K);
+  for(i = 5; i < 8; i++)
+  {
+    TESTCOND((decoded[i] == RIOPCS_K) || (decoded[i] == RIOPCS_A) || (decoded[i] == RIOPCS_R));
+  }
+  TESTEXPR(decoded[8], 0xde);
+  TESTEXPR(decoded[11], 0xef);
+  TESTEXPR(decoded[12], RIOPCS_SC);
+
+  RIOPCS_open(&pcsB);
+  TESTEXPR(RIOPCS_decodeSymbols(&pcsB, n, codeGroups, received), 3);
+  TESTEXPR(received[0].type, RIOSTACK_SYMBOL_TYPE_CONTROL);
+  TESTEXPR(received[0].data, 0x00123012);
+  TESTEXPR(received[1].type, RIOSTACK_SYMBOL_TYPE_DATA);
+  TESTEXPR(received[1].data, 0xdeadbeef);
+  TESTEXPR(received[2].type, RIOSTACK_SYMBOL_TYPE_CONTROL);
+  TESTEXPR(received[2].data, 0x00123712);
+  TESTEXPR(pcsB.statusRxIdle, 4);
+
+  /* Decode one code group at a time. */
+  RIOPCS_open(&pcsB);
+  m = 0;
+  for(i = 0; i < (int) n; i++)
+  {
+    m += RIOPCS_decodeSymbols(&pcsB, 1, &codeGroups[i], &received[m]);
+  }
+  TESTEXPR(m, 3);
+  TESTEXPR(received[1].data, 0xdeadbeef);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 2:");
+  PrintS("Action: Encode a long sequence of symbols.");
+  PrintS("Result: A clock compensation sequence should be inserted every 4096 ");
+  PrintS("        characters and the idle sequence should contain A at least ");
+  PrintS("        every 32 characters. All symbols should be decoded.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riopcs-TC2-Step2");
+  /******************************************************************************/
+
+  RIOPCS_open(&pcsA);
+  RIOPCS_open(&pcsB);
+  for(i = 0; i < SYMBOLS; i++)
+  {
+    symbols[i].type = RIOSTACK_SYMBOL_TYPE_DATA;
+    symbols[i].data = (uint32_t) rand();
+  }
+  n = RIOPCS_encodeSymbols(&pcsA, SYMBOLS, symbols, codeGroups);
+  TESTEXPR(n, 4*SYMBOLS + 4);
+  TESTEXPR(pcsA.statusTxCcs, 1);
+  RIOPCS_decodeCharacters(&pcsB, 8, &codeGroups[4096], decoded);
+  TESTEXPR(decoded[0], RIOPCS_K);
+  TESTEXPR(decoded[1], RIOPCS_R);
+  TESTEXPR(decoded[2], RIOPCS_R);
+  TESTEXPR(decoded[3], RIOPCS_R);
+  TESTEXPR(decoded[4], symbols[1024].data >> 24);
+
+  RIOPCS_open(&pcsB);
+  TESTEXPR(RIOPCS_decodeSymbols(&pcsB, n, codeGroups, received), SYMBOLS);
+  for(i = 0; i < SYMBOLS; i++)
+  {
+    TESTEXPR(received[i].type, RIOSTACK_SYMBOL_TYPE_DATA);
+    TESTEXPR(received[i].data, symbols[i].data);
+  }
+
+  RIOPCS_open(&pcsA);
+  RIOPCS_open(&pcsB);
+  for(i = 0; i < SYMBOLS; i++)
+  {
+    symbols[i].type = RIOSTACK_SYMBOL_TYPE_IDLE;
+  }
+  n = RIOPCS_encodeSymbols(&pcsA, SYMBOLS, symbols, codeGroups);
+  TESTEXPR(RIOPCS_decodeSymbols(&pcsB, n, codeGroups, received), 0);
+  TESTEXPR(pcsB.statusRxIdle, n);
+  RIOPCS_open(&pcsB);
+  RIOPCS_decodeCharacters(&pcsB, n, codeGroups, decoded);
+  j = 0;
+  maximum = 0;
+  for(i = 0; i < (int) n; i++)
+  {
+    j = (decoded[i] == RIOPCS_A) ? 0 : (j + 1);
+    maximum = (j > maximum) ? j : maximum;
+  }
+  TESTCOND(maximum <= 32);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 3:");
+  PrintS("Action: Decode symbols with an invalid code group in a data symbol, ");
+  PrintS("        a special character inside a symbol and an unused special ");
+  PrintS("        character.");
+  PrintS("Result: One error symbol should be delivered for each error and the ");
+  PrintS("        data characters up to the next special character should be ");
+  PrintS("        discarded.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riopcs-TC2-Step3");
+  /******************************************************************************/
+
+  RIOPCS_open(&pcsA);
+  RIOPCS_open(&pcsB);
+  s[0].type = RIOSTACK_SYMBOL_TYPE_DATA;
+  s[0].data = 0x11223344;
+  s[1].type = RIOSTACK_SYMBOL_TYPE_DATA;
+  s[1].data = 0x55667788;
+  s[2].type = RIOSTACK_SYMBOL_TYPE_IDLE;
+  s[3].type = RIOSTACK_SYMBOL_TYPE_DATA;
+  s[3].data = 0x99aabbcc;
+  n = RIOPCS_encodeSymbols(&pcsA, 2, s, codeGroups);
+  n += RIOPCS_encodeSymbols(&pcsA, 2, &s[2], &codeGroups[n]);
+  codeGroups[1] = 0x000;
+  TESTEXPR(RIOPCS_decodeSymbols(&pcsB, n, codeGroups, received), 2);
+  TESTEXPR(received[0].type, RIOSTACK_SYMBOL_TYPE_ERROR);
+  TESTEXPR(received[1].type, RIOSTACK_SYMBOL_TYPE_DATA);
+  TESTEXPR(received[1].data, 0x99aabbcc);
+  TESTEXPR(pcsB.statusRxSymbolError, 1);
+
+  RIOPCS_open(&pcsA);
+  RIOPCS_open(&pcsB);
+  characters[0] = 0x11;
+  characters[1] = 0x22;
+  characters[2] = RIOPCS_SC;
+  characters[3] = 0x01;
+  characters[4] = 0x02;
+  characters[5] = 0x03;
+  characters[6] = RIOPCS_CHARACTER_K | 0xfe;
+  characters[7] = 0x44;
+  characters[8] = RIOPCS_K;
+  characters[9] = 0x55;
+  characters[10] = 0x66;
+  characters[11] = 0x77;
+  characters[12] = 0x88;
+  RIOPCS_encodeCharacters(&pcsA, 13, characters, codeGroups);
+  TESTEXPR(RIOPCS_decodeSymbols(&pcsB, 13, codeGroups, received), 4);
+  TESTEXPR(received[0].type, RIOSTACK_SYMBOL_TYPE_ERROR);
+  TESTEXPR(received[1].type, RIOSTACK_SYMBOL_TYPE_CONTROL);
+  TESTEXPR(received[1].data, 0x00010203);
+  TESTEXPR(received[2].type, RIOSTACK_SYMBOL_TYPE_ERROR);
+  TESTEXPR(received[3].type, RIOSTACK_SYMBOL_TYPE_DATA);
+  TESTEXPR(received[3].data, 0x55667788);
+  TESTEXPR(pcsB.statusRxSymbolError, 2);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("TG_riopcs-TC3");
+  PrintS("Description: Test serial bitstreams.");
+  PrintS("Requirement: XXXXX");
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 1:");
+  PrintS("Action: Pack code groups into a bitstream that starts with some ");
+  PrintS("        random bits, find the comma and unpack it again.");
+  PrintS("Result: The comma should be found at the first code group and the ");
+  PrintS("        unpacked code groups should be the same as the packed.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riopcs-TC3-Step1");
+  /******************************************************************************/
+
+  for(j = 0; j < 10; j++)
+  {
+    RIOPCS_open(&pcsA);
+    for(i = 0; i < SYMBOLS; i++)
+    {
+      symbols[i].type = ((i % 5) == 0) ? RIOSTACK_SYMBOL_TYPE_IDLE : RIOSTACK_SYMBOL_TYPE_DATA;
+      symbols[i].data = (uint32_t) rand();
+    }
+
+    /* Start the bitstream with j bits that does not contain a comma. */
+    codeGroups[0] = 0x155;
+    n = RIOPCS_encodeSymbols(&pcsA, SYMBOLS, symbols, &codeGroups[1]);
+    RIOPCS_packBits(n + 1, codeGroups, bits);
+    shiftBits(10 - j, 10*(n+1), bits);
+
+    offset = RIOPCS_findComma(10*n + j, bits);
+    TESTEXPR(offset, j);
+    RIOPCS_unpackBits(offset, n, bits, unpacked);
+    TESTCOND(memcmp(&codeGroups[1], unpacked, n*sizeof(uint16_t)) == 0);
+  }
+
+  TESTEXPR(RIOPCS_findComma(10, (uint8_t[]) {0x00, 0x00}), 10);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("TG_riopcs-TC4");
+  PrintS("Description: Test two stacks connected through PCSs.");
+  PrintS("Requirement: XXXXX");
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 1:");
+  PrintS("Action: Initialize the link and send doorbells in both directions.");
+  PrintS("Result: The link should be initialized and the doorbells received.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riopcs-TC4-Step1");
+  /******************************************************************************/
+
+  RIOPCS_open(&pcsA);
+  RIOPCS_open(&pcsB);
+  startLink();
+
+  for(i = 0; i < 3*QUEUE_LENGTH; i++)
+  {
+    RIOPACKET_setDoorbell(&packet, 0x0002, 0x0001, i, 0x1000+i);
+    RIOSTACK_setOutboundPacket(&stackA, &packet);
+    RIOPACKET_setDoorbell(&packet, 0x0001, 0x0002, i, 0x2000+i);
+    RIOSTACK_setOutboundPacket(&stackB, &packet);
+    runLink(50);
+
+    TESTEXPR(RIOSTACK_getInboundQueueLength(&stackB), 1);
+    RIOSTACK_getInboundPacket(&stackB, &packet);
+    RIOPACKET_getDoorbell(&packet, &dstid, &srcid, &tid, &info);
+    TESTEXPR(info, 0x1000+i);
+    TESTEXPR(RIOSTACK_getInboundQueueLength(&stackA), 1);
+    RIOSTACK_getInboundPacket(&stackA, &packet);
+    RIOPACKET_getDoorbell(&packet, &dstid, &srcid, &tid, &info);
+    TESTEXPR(info, 0x2000+i);
+  }
+  TESTEXPR(pcsA.statusRxSymbolError, 0);
+  TESTEXPR(pcsB.statusRxSymbolError, 0);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+}
+
+
+CU_ErrorCode addTests( void )
+{
+  if( CUE_SUCCESS != CU_initialize_registry() )
+  {
+    return CU_get_error();
+  }
+
+  CU_pSuite suite = CU_add_suite( "RIOPCSTEST", NULL, NULL );
+  if( NULL == suite )
+  {
+    CU_cleanup_registry();
+    return CU_get_error();
+  }
+
+  CU_add_test( suite, "allTests", &allTests );
+
+  return CUE_SUCCESS;
+}
+
+
+int main(int argc, char argv[])
+{
+  addTests();
+  CU_basic_run_tests();
+  return CU_get_error();
+}
+
+/*************************** end of file **************************************/
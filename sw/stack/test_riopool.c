@@ -0,0 +1,242 @@
+/******************************************************************************
+ * (C) Copyright 2013-2015 Magnus Rosenius and the Free Software Foundation.
+ *
+ * This file is part of OpenRIO.
+ *
+ * OpenRIO is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenRIO is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Lesser Public License
+ * along with OpenRIO.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+/******************************************************************************
+ * Description:
+ * Unit tests for riopool.c.
+ ******************************************************************************/
+
+
+#define MODULE_TEST
+#include "riopool.c"
+#include "riopacket.c"
+#include <CUnit/CUnit.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define PrintS(s) printf(s "\n")
+
+#define TESTSTART(s) printf(s "...")
+#define TESTEND printf(" done.\n");
+
+#define TESTCOND(got) CU_ASSERT(got)
+#define TESTEXPR(got, expected) CU_ASSERT_EQUAL((got), (expected))
+
+#define POOL_SIZE 8
+
+int TEST_numExpectedAssertsRemaining = 0;
+
+static RioPool_t pool;
+static RioPoolEntry_t poolEntries[POOL_SIZE];
+
+/*******************************************************************************
+ * Module test for this file.
+ *******************************************************************************/
+
+static void allTests(void)
+{
+  RioPoolHandle_t handles[POOL_SIZE];
+  RioPoolHandle_t handle;
+  RioPacket_t *packet;
+  uint16_t dstid;
+  uint16_t srcid;
+  uint8_t tid;
+  uint16_t info;
+  int i;
+  int j;
+
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("TG_riopool");
+  PrintS("----------------------------------------------------------------------");
+  PrintS("TG_riopool-TC1");
+  PrintS("Description: Test allocation and release of packets.");
+  PrintS("Requirement: XXXXX");
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 1:");
+  PrintS("Action: Allocate all packets in a pool.");
+  PrintS("Result: All handles should be unique and the pool should be empty ");
+  PrintS("afterwards.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riopool-TC1-Step1");
+  /******************************************************************************/
+
+  RIOPOOL_open(&pool, POOL_SIZE, poolEntries);
+  TESTEXPR(RIOPOOL_getAvailable(&pool), POOL_SIZE);
+
+  for(i = 0; i < POOL_SIZE; i++)
+  {
+    handles[i] = RIOPOOL_allocate(&pool);
+    TESTCOND(handles[i] < POOL_SIZE);
+    TESTEXPR(RIOPOOL_getReferences(&pool, handles[i]), 1);
+    TESTEXPR(RIOPACKET_size(RIOPOOL_getPacket(&pool, handles[i])), 0);
+    for(j = 0; j < i; j++)
+    {
+      TESTCOND(handles[i] != handles[j]);
+    }
+    TESTEXPR(RIOPOOL_getAvailable(&pool), POOL_SIZE-i-1);
+  }
+
+  TESTEXPR(RIOPOOL_allocate(&pool), RIOPOOL_HANDLE_INVALID);
+  TESTEXPR(RIOPOOL_getAvailable(&pool), 0);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 2:");
+  PrintS("Action: Release all packets and allocate them again.");
+  PrintS("Result: The released packets should be reused, the latest released ");
+  PrintS("first.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riopool-TC1-Step2");
+  /******************************************************************************/
+
+  for(i = 0; i < POOL_SIZE; i++)
+  {
+    RIOPOOL_release(&pool, handles[i]);
+    TESTEXPR(RIOPOOL_getReferences(&pool, handles[i]), 0);
+    TESTEXPR(RIOPOOL_getAvailable(&pool), i+1);
+  }
+
+  for(i = POOL_SIZE-1; i >= 0; i--)
+  {
+    handle = RIOPOOL_allocate(&pool);
+    TESTEXPR(handle, handles[i]);
+  }
+  TESTEXPR(RIOPOOL_allocate(&pool), RIOPOOL_HANDLE_INVALID);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 3:");
+  PrintS("Action: Open an empty pool.");
+  PrintS("Result: No packets should be allocated.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riopool-TC1-Step3");
+  /******************************************************************************/
+
+  RIOPOOL_open(&pool, 0, NULL);
+  TESTEXPR(RIOPOOL_getAvailable(&pool), 0);
+  TESTEXPR(RIOPOOL_allocate(&pool), RIOPOOL_HANDLE_INVALID);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("TG_riopool-TC2");
+  PrintS("Description: Test reference counting.");
+  PrintS("Requirement: XXXXX");
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 1:");
+  PrintS("Action: Build a packet in a pooled packet and retain it.");
+  PrintS("Result: The packet should be kept until all references are released.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riopool-TC2-Step1");
+  /******************************************************************************/
+
+  RIOPOOL_open(&pool, POOL_SIZE, poolEntries);
+
+  handle = RIOPOOL_allocate(&pool);
+  packet = RIOPOOL_getPacket(&pool, handle);
+  RIOPACKET_setDoorbell(packet, 0xdead, 0xbeef, 0xaf, 0x1234);
+
+  RIOPOOL_retain(&pool, handle);
+  RIOPOOL_retain(&pool, handle);
+  TESTEXPR(RIOPOOL_getReferences(&pool, handle), 3);
+
+  RIOPOOL_release(&pool, handle);
+  RIOPOOL_release(&pool, handle);
+  TESTEXPR(RIOPOOL_getReferences(&pool, handle), 1);
+  TESTEXPR(RIOPOOL_getAvailable(&pool), POOL_SIZE-1);
+
+  TESTCOND(RIOPACKET_valid(packet));
+  RIOPACKET_getDoorbell(packet, &dstid, &srcid, &tid, &info);
+  TESTEXPR(dstid, 0xdead);
+  TESTEXPR(srcid, 0xbeef);
+  TESTEXPR(tid, 0xaf);
+  TESTEXPR(info, 0x1234);
+
+  RIOPOOL_release(&pool, handle);
+  TESTEXPR(RIOPOOL_getReferences(&pool, handle), 0);
+  TESTEXPR(RIOPOOL_getAvailable(&pool), POOL_SIZE);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 2:");
+  PrintS("Action: Release a packet that is already free.");
+  PrintS("Result: An assert should be raised and the pool should be unchanged.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riopool-TC2-Step2");
+  /******************************************************************************/
+
+  TEST_numExpectedAssertsRemaining = 1;
+  RIOPOOL_release(&pool, handle);
+  TESTEXPR(TEST_numExpectedAssertsRemaining, 0);
+  TESTEXPR(RIOPOOL_getAvailable(&pool), POOL_SIZE);
+
+  for(i = 0; i < POOL_SIZE; i++)
+  {
+    handles[i] = RIOPOOL_allocate(&pool);
+    TESTCOND(handles[i] != RIOPOOL_HANDLE_INVALID);
+  }
+  TESTEXPR(RIOPOOL_allocate(&pool), RIOPOOL_HANDLE_INVALID);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+}
+
+CU_ErrorCode addTests( void )
+{
+  if( CUE_SUCCESS != CU_initialize_registry() )
+  {
+    return CU_get_error();
+  }
+
+  CU_pSuite suite = CU_add_suite( "RIOPOOLTEST", NULL, NULL );
+  if( NULL == suite )
+  {
+    CU_cleanup_registry();
+    return CU_get_error();
+  }
+
+  CU_add_test( suite, "allTests", &allTests );
+
+  return CUE_SUCCESS;
+}
+
+
+int main(int argc, char argv[])
+{
+  addTests();
+  CU_basic_run_tests();
+  return CU_get_error();
+}
+
+
+/*************************** end of file **************************************/
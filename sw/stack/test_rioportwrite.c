@@ -0,0 +1,252 @@
+/******************************************************************************
+ * (C) Copyright 2013-2015 Magnus Rosenius and the Free Software Foundation.
+ *
+ * This file is part of OpenRIO.
+ *
+ * OpenRIO is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenRIO is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Lesser Public License
+ * along with OpenRIO.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+
+/******************************************************************************
+ * Description:
+ * Unit tests for rioportwrite.c.
+ ******************************************************************************/
+
+
+#define MODULE_TEST
+#include "rioportwrite.c"
+#include "riostack.c"
+#include "riopacket.c"
+#include "riopool.c"
+#include <CUnit/CUnit.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define PrintS(s) printf(s "\n")
+
+#define TESTSTART(s) printf(s "...")
+#define TESTEND printf(" done.\n");
+
+#define TESTCOND(got) CU_ASSERT(got)
+#define TESTEXPR(got, expected) CU_ASSERT_EQUAL((got), (expected))
+
+#define QUEUE_LENGTH 8
+#define EVENTS 4
+#define SOURCES 2
+
+int TEST_numExpectedAssertsRemaining = 0;
+
+static RioPortWrite_t portWrite;
+static RioPortWriteEvent_t events[EVENTS];
+static RioPortWriteSource_t sources[SOURCES];
+
+#include "test_riolink.h"
+
+/*******************************************************************************
+ * Module test for this file.
+ *******************************************************************************/
+
+static void allTests(void)
+{
+  RioPacket_t packet;
+  RioPortWriteEvent_t event;
+  int i;
+
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("TG_rioportwrite");
+  PrintS("----------------------------------------------------------------------");
+  PrintS("TG_rioportwrite-TC1");
+  PrintS("Description: Test aggregation of port-writes.");
+  PrintS("Requirement: XXXXX");
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 1:");
+  PrintS("Action: Receive port-writes with the same and different keys.");
+  PrintS("Result: Port-writes with the same key should be counted in one event. ");
+  PrintS("The events should not be delivered until their window has passed.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_rioportwrite-TC1-Step1");
+  /******************************************************************************/
+
+  RIOPORTWRITE_open(&portWrite, EVENTS, events, SOURCES, sources);
+  RIOPORTWRITE_setWindow(&portWrite, 100);
+
+  for(i = 0; i < 10; i++)
+  {
+    RIOPACKET_setMaintPortWrite(&packet, 0x0000, 0x0100, 0xc0de0000, 0x00000004, i, 3, 1u << i);
+    TESTEXPR(RIOPORTWRITE_receive(&portWrite, &packet, 1000+i), 1);
+  }
+  RIOPACKET_setMaintPortWrite(&packet, 0x0000, 0x0100, 0xc0de0000, 0x00000008, 0, 3, 0);
+  TESTEXPR(RIOPORTWRITE_receive(&portWrite, &packet, 1010), 1);
+  RIOPACKET_setMaintPortWrite(&packet, 0x0000, 0x0100, 0xc0de0000, 0x00000004, 0, 4, 0);
+  TESTEXPR(RIOPORTWRITE_receive(&portWrite, &packet, 1011), 1);
+  RIOPACKET_setMaintPortWrite(&packet, 0x0000, 0x0200, 0xc0de0000, 0x00000004, 0, 3, 0);
+  TESTEXPR(RIOPORTWRITE_receive(&portWrite, &packet, 1012), 1);
+
+  TESTEXPR(RIOPORTWRITE_getEventQueueLength(&portWrite), 4);
+  TESTEXPR(RIOPORTWRITE_getSourceCount(&portWrite, 0x0100), 12);
+  TESTEXPR(RIOPORTWRITE_getSourceCount(&portWrite, 0x0200), 1);
+  TESTEXPR(RIOPORTWRITE_getSourceCount(&portWrite, 0x0300), 0);
+  TESTEXPR(portWrite.statusReceived, 13);
+  TESTEXPR(portWrite.statusAggregated, 9);
+
+  TESTEXPR(RIOPORTWRITE_poll(&portWrite, 1099, &event), 0);
+  TESTEXPR(RIOPORTWRITE_poll(&portWrite, 1100, &event), 1);
+  TESTEXPR(event.source, 0x0100);
+  TESTEXPR(event.componentTag, 0xc0de0000);
+  TESTEXPR(event.portErrorDetect, 0x00000004);
+  TESTEXPR(event.portId, 3);
+  TESTEXPR(event.implementationSpecific, 9);
+  TESTEXPR(event.logicalTransportErrorDetect, 0x3ff);
+  TESTEXPR(event.count, 10);
+  TESTEXPR(event.time, 1000);
+  TESTEXPR(RIOPORTWRITE_poll(&portWrite, 1100, &event), 0);
+  TESTEXPR(RIOPORTWRITE_getEventQueueLength(&portWrite), 3);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 2:");
+  PrintS("Action: Receive port-writes when the event queue and the source ");
+  PrintS("counters are full.");
+  PrintS("Result: Port-writes with new keys should be dropped and new sources ");
+  PrintS("should not be counted.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_rioportwrite-TC1-Step2");
+  /******************************************************************************/
+
+  RIOPACKET_setMaintPortWrite(&packet, 0x0000, 0x0300, 0x00000000, 0x00000001, 0, 0, 0);
+  TESTEXPR(RIOPORTWRITE_receive(&portWrite, &packet, 1101), 1);
+  TESTEXPR(RIOPORTWRITE_getEventQueueLength(&portWrite), 4);
+  TESTEXPR(RIOPORTWRITE_receive(&portWrite, &packet, 1102), 1);
+  TESTEXPR(RIOPORTWRITE_getEventQueueLength(&portWrite), 4);
+  TESTEXPR(portWrite.statusDropped, 0);
+  RIOPACKET_setMaintPortWrite(&packet, 0x0000, 0x0300, 0x00000000, 0x00000002, 0, 0, 0);
+  TESTEXPR(RIOPORTWRITE_receive(&portWrite, &packet, 1103), 1);
+  TESTEXPR(RIOPORTWRITE_getEventQueueLength(&portWrite), 4);
+  TESTEXPR(portWrite.statusDropped, 1);
+  TESTEXPR(RIOPORTWRITE_getSourceCount(&portWrite, 0x0300), 0);
+
+  RIOPACKET_setMaintReadRequest(&packet, 0x0000, 0x0300, 0, 0, 0);
+  TESTEXPR(RIOPORTWRITE_receive(&portWrite, &packet, 1104), 0);
+  TESTEXPR(portWrite.statusReceived, 16);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 3:");
+  PrintS("Action: Deliver events with a rate limit.");
+  PrintS("Result: A burst of events should be delivered and then one event per ");
+  PrintS("period.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_rioportwrite-TC1-Step3");
+  /******************************************************************************/
+
+  RIOPORTWRITE_setRateLimit(&portWrite, 50, 2);
+
+  TESTEXPR(RIOPORTWRITE_poll(&portWrite, 2000, &event), 1);
+  TESTEXPR(event.portErrorDetect, 0x00000008);
+  TESTEXPR(RIOPORTWRITE_poll(&portWrite, 2000, &event), 1);
+  TESTEXPR(event.portId, 4);
+  TESTEXPR(RIOPORTWRITE_poll(&portWrite, 2049, &event), 0);
+  TESTEXPR(RIOPORTWRITE_poll(&portWrite, 2050, &event), 1);
+  TESTEXPR(event.source, 0x0200);
+  TESTEXPR(RIOPORTWRITE_poll(&portWrite, 2050, &event), 0);
+  TESTEXPR(RIOPORTWRITE_poll(&portWrite, 2100, &event), 1);
+  TESTEXPR(event.source, 0x0300);
+  TESTEXPR(event.count, 2);
+  TESTEXPR(RIOPORTWRITE_getEventQueueLength(&portWrite), 0);
+  TESTEXPR(RIOPORTWRITE_poll(&portWrite, 5000, &event), 0);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("TG_rioportwrite-TC2");
+  PrintS("Description: Test port-writes received by a stack.");
+  PrintS("Requirement: XXXXX");
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 1:");
+  PrintS("Action: Send port-writes and a maintenance read to a stack with an ");
+  PrintS("attached collector.");
+  PrintS("Result: The port-writes should be aggregated and the maintenance read ");
+  PrintS("should be placed in the inbound queue.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_rioportwrite-TC2-Step1");
+  /******************************************************************************/
+
+  startLink();
+  RIOPORTWRITE_open(&portWrite, EVENTS, events, SOURCES, sources);
+  RIOPORTWRITE_attach(&portWrite, &stackB);
+
+  for(i = 0; i < 5; i++)
+  {
+    RIOPACKET_setMaintPortWrite(&packet, 0x0000, 0x0001, 0x12345678, 0x80000000, i, 1, 0);
+    RIOSTACK_setOutboundPacket(&stackA, &packet);
+  }
+  RIOPACKET_setMaintReadRequest(&packet, 0x0000, 0x0001, 0xff, 0x2, 0x00000010);
+  RIOSTACK_setOutboundPacket(&stackA, &packet);
+  runLink(400);
+
+  TESTEXPR(RIOSTACK_getInboundQueueLength(&stackB), 1);
+  RIOSTACK_getInboundPacket(&stackB, &packet);
+  TESTEXPR(RIOPACKET_getTransaction(&packet), RIOPACKET_TRANSACTION_MAINT_READ_REQUEST);
+
+  TESTEXPR(RIOPORTWRITE_getEventQueueLength(&portWrite), 1);
+  TESTEXPR(RIOPORTWRITE_getSourceCount(&portWrite, 0x0001), 5);
+  TESTEXPR(RIOPORTWRITE_poll(&portWrite, 0, &event), 1);
+  TESTEXPR(event.componentTag, 0x12345678);
+  TESTEXPR(event.implementationSpecific, 4);
+  TESTEXPR(event.count, 5);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+}
+
+CU_ErrorCode addTests( void )
+{
+  if( CUE_SUCCESS != CU_initialize_registry() )
+  {
+    return CU_get_error();
+  }
+
+  CU_pSuite suite = CU_add_suite( "RIOPORTWRITETEST", NULL, NULL );
+  if( NULL == suite )
+  {
+    CU_cleanup_registry();
+    return CU_get_error();
+  }
+
+  CU_add_test( suite, "allTests", &allTests );
+
+  return CUE_SUCCESS;
+}
+
+
+int main(int argc, char argv[])
+{
+  addTests();
+  CU_basic_run_tests();
+  return CU_get_error();
+}
+
+
+/*************************** end of file **************************************/
@@ -0,0 +1,293 @@
+/******************************************************************************
+ * (C) Copyright 2013-2015 Magnus Rosenius and the Free Software Foundation.
+ *
+ * This file is part of OpenRIO.
+ *
+ * OpenRIO is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenRIO is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Lesser Public License
+ * along with OpenRIO.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+
+/******************************************************************************
+ * Description:
+ * Unit tests for rioserial.c.
+ ******************************************************************************/
+
+
+#define MODULE_TEST
+#include "rioserial.c"
+#include "riouart.c"
+#include "riostack.c"
+#include "riopacket.c"
+#include "riopool.c"
+#include <CUnit/CUnit.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PrintS(s) printf(s "\n")
+
+#define TESTSTART(s) printf(s "...")
+#define TESTEND printf(" done.\n");
+
+#define TESTCOND(got) CU_ASSERT(got)
+#define TESTEXPR(got, expected) CU_ASSERT_EQUAL((got), (expected))
+
+#define QUEUE_LENGTH 8
+#define DOORBELLS 200
+
+int TEST_numExpectedAssertsRemaining = 0;
+
+static RioSerial_t serialA;
+static RioSerial_t serialB;
+
+static RioStack_t stackA;
+static uint32_t rxPacketBufferA[RIOSTACK_BUFFER_SIZE * QUEUE_LENGTH];
+static uint32_t txPacketBufferA[RIOSTACK_BUFFER_SIZE * QUEUE_LENGTH];
+static RioStack_t stackB;
+static uint32_t rxPacketBufferB[RIOSTACK_BUFFER_SIZE * QUEUE_LENGTH];
+static uint32_t txPacketBufferB[RIOSTACK_BUFFER_SIZE * QUEUE_LENGTH];
+
+/* Open both stacks. */
+static void openStacks(void)
+{
+  RIOSTACK_open(&stackA, NULL,
+      RIOSTACK_BUFFER_SIZE*QUEUE_LENGTH, rxPacketBufferA,
+      RIOSTACK_BUFFER_SIZE*QUEUE_LENGTH, txPacketBufferA);
+  RIOSTACK_open(&stackB, NULL,
+      RIOSTACK_BUFFER_SIZE*QUEUE_LENGTH, rxPacketBufferB,
+      RIOSTACK_BUFFER_SIZE*QUEUE_LENGTH, txPacketBufferB);
+  RIOSTACK_portSetTimeout(&stackA, 1000);
+  RIOSTACK_portSetTimeout(&stackB, 1000);
+}
+
+/* Run both drivers until a condition is true or a second has passed. */
+#define RUN_UNTIL(condition)                                          \
+  do                                                                  \
+  {                                                                   \
+    uint32_t start = RIOSERIAL_getTime();                             \
+    while(!(condition) && ((RIOSERIAL_getTime() - start) < 1000u))    \
+    {                                                                 \
+      TESTCOND(RIOSERIAL_process(&serialA, RIOSERIAL_getTime()));     \
+      TESTCOND(RIOSERIAL_process(&serialB, RIOSERIAL_getTime()));     \
+      RIOSERIAL_wait(&serialA, 1);                                    \
+    }                                                                 \
+  } while(0)
+
+/* Send doorbells in both directions and check that they are received. */
+static void sendDoorbells(void)
+{
+  RioPacket_t packet;
+  uint16_t dstid;
+  uint16_t srcid;
+  uint8_t tid;
+  uint16_t info;
+  int sentA;
+  int sentB;
+  int receivedA;
+  int receivedB;
+
+  sentA = 0;
+  sentB = 0;
+  receivedA = 0;
+  receivedB = 0;
+  while((receivedA < DOORBELLS) || (receivedB < DOORBELLS))
+  {
+    if((sentA < DOORBELLS) && (RIOSTACK_getOutboundQueueAvailable(&stackA) > 0))
+    {
+      RIOPACKET_setDoorbell(&packet, 0x0002, 0x0001, sentA, 0x7e00 + sentA);
+      RIOSTACK_setOutboundPacket(&stackA, &packet);
+      sentA++;
+    }
+    if((sentB < DOORBELLS) && (RIOSTACK_getOutboundQueueAvailable(&stackB) > 0))
+    {
+      RIOPACKET_setDoorbell(&packet, 0x0001, 0x0002, sentB, 0x2000 + sentB);
+      RIOSTACK_setOutboundPacket(&stackB, &packet);
+      sentB++;
+    }
+
+    RUN_UNTIL((RIOSTACK_getInboundQueueLength(&stackA) > 0) ||
+              (RIOSTACK_getInboundQueueLength(&stackB) > 0));
+    if((RIOSTACK_getInboundQueueLength(&stackA) == 0) &&
+       (RIOSTACK_getInboundQueueLength(&stackB) == 0))
+    {
+      TESTCOND(0);
+      break;
+    }
+
+    while(RIOSTACK_getInboundQueueLength(&stackB) > 0)
+    {
+      RIOSTACK_getInboundPacket(&stackB, &packet);
+      RIOPACKET_getDoorbell(&packet, &dstid, &srcid, &tid, &info);
+      TESTEXPR(info, 0x7e00 + receivedB);
+      receivedB++;
+    }
+    while(RIOSTACK_getInboundQueueLength(&stackA) > 0)
+    {
+      RIOSTACK_getInboundPacket(&stackA, &packet);
+      RIOPACKET_getDoorbell(&packet, &dstid, &srcid, &tid, &info);
+      TESTEXPR(info, 0x2000 + receivedA);
+      receivedA++;
+    }
+  }
+}
+
+/*******************************************************************************
+ * Module test for this file.
+ *******************************************************************************/
+
+static void allTests(void)
+{
+  int masterFd;
+
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("TG_rioserial");
+  PrintS("----------------------------------------------------------------------");
+  PrintS("TG_rioserial-TC1");
+  PrintS("Description: Test stacks connected with a pseudo terminal pair.");
+  PrintS("Requirement: XXXXX");
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 1:");
+  PrintS("Action: Open a pseudo terminal pair, initialize the link and send ");
+  PrintS("        doorbells in both directions.");
+  PrintS("Result: The link should be initialized, the doorbells received and ");
+  PrintS("        each read and write should transfer many bytes.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_rioserial-TC1-Step1");
+  /******************************************************************************/
+
+  openStacks();
+  TESTCOND(RIOSERIAL_openPty(&serialA, &stackA, &serialB, &stackB));
+  RUN_UNTIL(RIOSTACK_getLinkIsInitialized(&stackA) && RIOSTACK_getLinkIsInitialized(&stackB));
+  TESTCOND(RIOSTACK_getLinkIsInitialized(&stackA));
+  TESTCOND(RIOSTACK_getLinkIsInitialized(&stackB));
+
+  sendDoorbells();
+
+  TESTCOND(serialA.statusBytesWritten > 8*serialA.statusWriteCalls);
+  TESTCOND(serialB.statusBytesWritten > 8*serialB.statusWriteCalls);
+  TESTCOND(serialA.statusBytesRead > 8*serialA.statusReadCalls);
+  TESTCOND(serialB.statusBytesRead > 8*serialB.statusReadCalls);
+  TESTEXPR(serialA.uart.statusRxError, 0);
+  TESTEXPR(serialB.uart.statusRxError, 0);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 2:");
+  PrintS("Action: Close one side of the link.");
+  PrintS("Result: The port of the closed side should be uninitialized and ");
+  PrintS("        closing twice should be harmless.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_rioserial-TC1-Step2");
+  /******************************************************************************/
+
+  RIOSERIAL_close(&serialB);
+  TESTEXPR(RIOSTACK_getStatus(&stackB), 0);
+  RIOSERIAL_close(&serialB);
+  RIOSERIAL_close(&serialA);
+  TESTEXPR(RIOSTACK_getStatus(&stackA), 0);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("TG_rioserial-TC2");
+  PrintS("Description: Test opening serial devices.");
+  PrintS("Requirement: XXXXX");
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 1:");
+  PrintS("Action: Open a device that does not exist, a file that is not a ");
+  PrintS("        terminal and a terminal with an unsupported baudrate.");
+  PrintS("Result: The opening should fail.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_rioserial-TC2-Step1");
+  /******************************************************************************/
+
+  openStacks();
+  TESTEXPR(RIOSERIAL_open(&serialA, &stackA, "/nonexisting/tty", 115200), 0);
+  TESTEXPR(RIOSERIAL_open(&serialA, &stackA, "/dev/null", 115200), 0);
+
+  masterFd = posix_openpt(O_RDWR | O_NOCTTY);
+  TESTCOND(masterFd >= 0);
+  TESTEXPR(grantpt(masterFd), 0);
+  TESTEXPR(unlockpt(masterFd), 0);
+  TESTEXPR(RIOSERIAL_open(&serialB, &stackB, ptsname(masterFd), 1234), 0);
+  TESTEXPR(errno, EINVAL);
+  TESTEXPR(RIOSTACK_getStatus(&stackB), 0);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 2:");
+  PrintS("Action: Open the slave side of a pseudo terminal by name with a ");
+  PrintS("        baudrate and attach the master side. Send doorbells.");
+  PrintS("Result: The link should be initialized and the doorbells received.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_rioserial-TC2-Step2");
+  /******************************************************************************/
+
+  TESTCOND(RIOSERIAL_open(&serialB, &stackB, ptsname(masterFd), 3000000));
+  TESTCOND(RIOSERIAL_attach(&serialA, &stackA, masterFd));
+  RIOSERIAL_setTxQueueSize(&serialA, 64);
+  RIOSERIAL_setTxQueueSize(&serialB, 64);
+  RUN_UNTIL(RIOSTACK_getLinkIsInitialized(&stackA) && RIOSTACK_getLinkIsInitialized(&stackB));
+  TESTCOND(RIOSTACK_getLinkIsInitialized(&stackA));
+  TESTCOND(RIOSTACK_getLinkIsInitialized(&stackB));
+
+  sendDoorbells();
+
+  RIOSERIAL_close(&serialA);
+  RIOSERIAL_close(&serialB);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+}
+
+
+CU_ErrorCode addTests( void )
+{
+  if( CUE_SUCCESS != CU_initialize_registry() )
+  {
+    return CU_get_error();
+  }
+
+  CU_pSuite suite = CU_add_suite( "RIOSERIALTEST", NULL, NULL );
+  if( NULL == suite )
+  {
+    CU_cleanup_registry();
+    return CU_get_error();
+  }
+
+  CU_add_test( suite, "allTests", &allTests );
+
+  return CUE_SUCCESS;
+}
+
+
+int main(int argc, char argv[])
+{
+  addTests();
+  CU_basic_run_tests();
+  return CU_get_error();
+}
+
+/*************************** end of file **************************************/
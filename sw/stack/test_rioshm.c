@@ -0,0 +1,426 @@
+/******************************************************************************
+ * (C) Copyright 2013-2015 Magnus Rosenius and the Free Software Foundation.
+ *
+ * This file is part of OpenRIO.
+ *
+ * OpenRIO is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenRIO is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Lesser Public License
+ * along with OpenRIO.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+
+/******************************************************************************
+ * Description:
+ * Unit tests for rioshm.c.
+ ******************************************************************************/
+
+
+#define MODULE_TEST
+#include "rioshm.c"
+#include "riostack.c"
+#include "riopacket.c"
+#include "riopool.c"
+#include <CUnit/CUnit.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+
+#define PrintS(s) printf(s "\n")
+
+#define TESTSTART(s) printf(s "...")
+#define TESTEND printf(" done.\n");
+
+#define TESTCOND(got) CU_ASSERT(got)
+#define TESTEXPR(got, expected) CU_ASSERT_EQUAL((got), (expected))
+
+#define QUEUE_LENGTH 8
+#define DOORBELLS 1000
+
+int TEST_numExpectedAssertsRemaining = 0;
+
+static RioShm_t shmA;
+static RioShm_t shmB;
+
+static RioStack_t stackA;
+static uint32_t rxPacketBufferA[RIOSTACK_BUFFER_SIZE * QUEUE_LENGTH];
+static uint32_t txPacketBufferA[RIOSTACK_BUFFER_SIZE * QUEUE_LENGTH];
+static RioStack_t stackB;
+static uint32_t rxPacketBufferB[RIOSTACK_BUFFER_SIZE * QUEUE_LENGTH];
+static uint32_t txPacketBufferB[RIOSTACK_BUFFER_SIZE * QUEUE_LENGTH];
+
+/* Get a monotonic time in milliseconds. */
+static uint32_t getTime(void)
+{
+  struct timespec now;
+
+  (void) clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint32_t) ((uint32_t) now.tv_sec * 1000ul + (uint32_t) (now.tv_nsec / 1000000l));
+}
+
+/* Open both stacks. */
+static void openStacks(void)
+{
+  RIOSTACK_open(&stackA, NULL,
+      RIOSTACK_BUFFER_SIZE*QUEUE_LENGTH, rxPacketBufferA,
+      RIOSTACK_BUFFER_SIZE*QUEUE_LENGTH, txPacketBufferA);
+  RIOSTACK_open(&stackB, NULL,
+      RIOSTACK_BUFFER_SIZE*QUEUE_LENGTH, rxPacketBufferB,
+      RIOSTACK_BUFFER_SIZE*QUEUE_LENGTH, txPacketBufferB);
+  RIOSTACK_portSetTimeout(&stackA, 1000);
+  RIOSTACK_portSetTimeout(&stackB, 1000);
+}
+
+/* Get a unique name of a shared memory segment. */
+static const char *getName(const char *suffix)
+{
+  static char name[64];
+
+  snprintf(name, sizeof(name), "/riotest-%d-%s", (int) getpid(), suffix);
+  return name;
+}
+
+/* Send doorbells from stack A and answer them from stack B in another 
+   process. Return the number of answers received. */
+static int sendDoorbells(const int fd)
+{
+  RioPacket_t packet;
+  uint16_t dstid;
+  uint16_t srcid;
+  uint8_t tid;
+  uint16_t info;
+  uint32_t start;
+  pid_t child;
+  int status;
+  int sent;
+  int received;
+
+  child = fork();
+  if(child == 0)
+  {
+    /* Answer all doorbells with the info incremented. Exit when the other 
+       side closes the link or when nothing has happened in a while. */
+    openStacks();
+    if(!RIOSHM_attach(&shmB, &stackB, fd))
+    {
+      _exit(1);
+    }
+    start = getTime();
+    while((getTime() - start) < 5000u)
+    {
+      if((RIOSTACK_getInboundQueueLength(&stackB) > 0) &&
+         (RIOSTACK_getOutboundQueueAvailable(&stackB) > 0))
+      {
+        RIOSTACK_getInboundPacket(&stackB, &packet);
+        RIOPACKET_getDoorbell(&packet, &dstid, &srcid, &tid, &info);
+        if(info == 0xffff)
+        {
+          _exit(0);
+        }
+        RIOPACKET_setDoorbell(&packet, srcid, dstid, tid, info + 1);
+        RIOSTACK_setOutboundPacket(&stackB, &packet);
+        start = getTime();
+      }
+      if(RIOSHM_process(&shmB, getTime()) == 0)
+      {
+        RIOSHM_wait(&shmB, 10);
+      }
+    }
+    _exit(2);
+  }
+
+  sent = 0;
+  received = 0;
+  start = getTime();
+  while((received < DOORBELLS) && ((getTime() - start) < 5000u))
+  {
+    if((sent < DOORBELLS) && (RIOSTACK_getOutboundQueueAvailable(&stackA) > 0))
+    {
+      RIOPACKET_setDoorbell(&packet, 0x0002, 0x0001, sent, sent);
+      RIOSTACK_setOutboundPacket(&stackA, &packet);
+      sent++;
+    }
+    if(RIOSTACK_getInboundQueueLength(&stackA) > 0)
+    {
+      RIOSTACK_getInboundPacket(&stackA, &packet);
+      RIOPACKET_getDoorbell(&packet, &dstid, &srcid, &tid, &info);
+      TESTEXPR(info, received + 1);
+      TESTEXPR(dstid, 0x0001);
+      received++;
+    }
+    if(RIOSHM_process(&shmA, getTime()) == 0)
+    {
+      RIOSHM_wait(&shmA, 10);
+    }
+  }
+
+  /* Tell the other process to exit. */
+  RIOPACKET_setDoorbell(&packet, 0x0002, 0x0001, 0, 0xffff);
+  RIOSTACK_setOutboundPacket(&stackA, &packet);
+  while(waitpid(child, &status, WNOHANG) == 0)
+  {
+    (void) RIOSHM_process(&shmA, getTime());
+    RIOSHM_wait(&shmA, 1);
+  }
+  TESTCOND(WIFEXITED(status));
+  TESTEXPR(WEXITSTATUS(status), 0);
+
+  return received;
+}
+
+/*******************************************************************************
+ * Module test for this file.
+ *******************************************************************************/
+
+static void allTests(void)
+{
+  RioSymbol_t in[RIOSHM_RING_SIZE];
+  RioSymbol_t out[RIOSHM_RING_SIZE];
+  uint32_t i;
+  uint32_t j;
+  uint32_t n;
+  uint32_t start;
+  uint32_t sent;
+  uint32_t received;
+  int fd;
+
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("TG_rioshm");
+  PrintS("----------------------------------------------------------------------");
+  PrintS("TG_rioshm-TC1");
+  PrintS("Description: Test the symbol rings.");
+  PrintS("Requirement: XXXXX");
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 1:");
+  PrintS("Action: Open a named segment twice and fill the rings.");
+  PrintS("Result: The first open should create the segment and the second ");
+  PrintS("        attach to it. The rings should hold RIOSHM_RING_SIZE symbols ");
+  PrintS("        and keep their order.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_rioshm-TC1-Step1");
+  /******************************************************************************/
+
+  openStacks();
+  TESTCOND(RIOSHM_open(&shmA, &stackA, getName("ring")));
+  TESTCOND(RIOSHM_open(&shmB, &stackB, getName("ring")));
+  TESTEXPR(shm_unlink(getName("ring")), 0);
+  TESTCOND(shmA.txRing == &shmA.segment->ring[0]);
+  TESTCOND(shmB.rxRing == &shmB.segment->ring[0]);
+  TESTEXPR(stackA.rxState, RX_STATE_PORT_INITIALIZED);
+  TESTEXPR(stackB.rxState, RX_STATE_PORT_INITIALIZED);
+
+  for(i = 0; i < RIOSHM_RING_SIZE; i++)
+  {
+    in[i].type = RIOSTACK_SYMBOL_TYPE_DATA;
+    in[i].data = i;
+  }
+  TESTEXPR(RIOSHM_send(&shmA, RIOSHM_RING_SIZE, in), RIOSHM_RING_SIZE);
+  TESTEXPR(RIOSHM_send(&shmA, 1, in), 0);
+  TESTEXPR(RIOSHM_receive(&shmA, RIOSHM_RING_SIZE, out), 0);
+  TESTEXPR(RIOSHM_receive(&shmB, RIOSHM_RING_SIZE, out), RIOSHM_RING_SIZE);
+  for(i = 0; i < RIOSHM_RING_SIZE; i++)
+  {
+    TESTEXPR(out[i].type, RIOSTACK_SYMBOL_TYPE_DATA);
+    TESTEXPR(out[i].data, i);
+  }
+  TESTEXPR(RIOSHM_receive(&shmB, RIOSHM_RING_SIZE, out), 0);
+  TESTEXPR(shmA.statusSymbolsSent, RIOSHM_RING_SIZE);
+  TESTEXPR(shmB.statusSymbolsReceived, RIOSHM_RING_SIZE);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 2:");
+  PrintS("Action: Send and receive symbols in uneven batches many times around ");
+  PrintS("        the ring.");
+  PrintS("Result: All symbols should be received in order.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_rioshm-TC1-Step2");
+  /******************************************************************************/
+
+  sent = 0;
+  received = 0;
+  for(i = 0; i < 1000; i++)
+  {
+    for(j = 0; j < 1000; j++)
+    {
+      in[j].type = (RioSymbolType_t) ((sent + j) % 4);
+      in[j].data = (uint32_t) ((sent + j) * 0x9e3779b9ul);
+    }
+    sent += RIOSHM_send(&shmB, 1 + (i * 7) % 1000, in);
+
+    n = RIOSHM_receive(&shmA, 1 + (i * 13) % 1000, out);
+    for(j = 0; j < n; j++)
+    {
+      TESTEXPR(out[j].type, (received + j) % 4);
+      TESTEXPR(out[j].data, (uint32_t) ((received + j) * 0x9e3779b9ul));
+    }
+    received += n;
+  }
+  TESTCOND(sent > 4*RIOSHM_RING_SIZE);
+  TESTEXPR(shmA.rxRing->head - shmA.rxRing->tail, sent - received);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 3:");
+  PrintS("Action: Wait on an empty ring and on a ring with symbols.");
+  PrintS("Result: The wait should time out on the empty ring and return ");
+  PrintS("        directly when there are symbols.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_rioshm-TC1-Step3");
+  /******************************************************************************/
+
+  while(RIOSHM_receive(&shmA, RIOSHM_RING_SIZE, out) > 0);
+  start = getTime();
+  RIOSHM_wait(&shmA, 50);
+  TESTCOND((getTime() - start) >= 40u);
+  TESTEXPR(shmA.rxRing->waiting, 0);
+
+  TESTEXPR(RIOSHM_send(&shmB, 1, in), 1);
+  start = getTime();
+  RIOSHM_wait(&shmA, 1000);
+  TESTCOND((getTime() - start) < 100u);
+
+  RIOSHM_close(&shmA);
+  RIOSHM_close(&shmB);
+  RIOSHM_close(&shmB);
+  TESTEXPR(stackA.rxState, RX_STATE_UNINITIALIZED);
+  TESTEXPR(stackB.rxState, RX_STATE_UNINITIALIZED);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 4:");
+  PrintS("Action: Attach to segments that are not initialized, that are of ");
+  PrintS("        another version and that are already attached.");
+  PrintS("Result: The attach should fail with EAGAIN, EINVAL and EBUSY.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_rioshm-TC1-Step4");
+  /******************************************************************************/
+
+  fd = shm_open(getName("bad"), O_RDWR | O_CREAT | O_EXCL, 0600);
+  TESTCOND(fd >= 0);
+  TESTEXPR(shm_unlink(getName("bad")), 0);
+
+  TESTEXPR(RIOSHM_attach(&shmB, &stackB, fd), 0);
+  TESTEXPR(errno, EAGAIN);
+  TESTEXPR(ftruncate(fd, sizeof(RioShmSegment_t)), 0);
+  TESTEXPR(RIOSHM_attach(&shmB, &stackB, fd), 0);
+  TESTEXPR(errno, EAGAIN);
+
+  TESTCOND(RIOSHM_create(&shmA, &stackA, fd));
+  shmA.segment->magic++;
+  TESTEXPR(RIOSHM_attach(&shmB, &stackB, dup(fd)), 0);
+  TESTEXPR(errno, EINVAL);
+  shmA.segment->magic--;
+
+  TESTCOND(RIOSHM_attach(&shmB, &stackB, dup(fd)));
+  TESTEXPR(RIOSHM_attach(&shmB, &stackB, fd), 0);
+  TESTEXPR(errno, EBUSY);
+  TESTEXPR(stackB.rxState, RX_STATE_PORT_INITIALIZED);
+  RIOSHM_close(&shmA);
+  RIOSHM_close(&shmB);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("TG_rioshm-TC2");
+  PrintS("Description: Test stacks in two processes connected with a link.");
+  PrintS("Requirement: XXXXX");
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 1:");
+  PrintS("Action: Create a segment, let a child process attach to it and ");
+  PrintS("        answer doorbells sent to it.");
+  PrintS("Result: All answers should be received in order.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_rioshm-TC2-Step1");
+  /******************************************************************************/
+
+  openStacks();
+  fd = shm_open(getName("link"), O_RDWR | O_CREAT | O_EXCL, 0600);
+  TESTCOND(fd >= 0);
+  TESTEXPR(shm_unlink(getName("link")), 0);
+  TESTCOND(RIOSHM_create(&shmA, &stackA, fd));
+
+  TESTEXPR(sendDoorbells(fd), DOORBELLS);
+  TESTCOND(RIOSTACK_getLinkIsInitialized(&stackA));
+  TESTCOND(shmA.statusSymbolsSent > 3*DOORBELLS);
+  TESTCOND(shmA.statusSymbolsReceived > 3*DOORBELLS);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 2:");
+  PrintS("Action: Repeat with a transmit queue of one symbol.");
+  PrintS("Result: All answers should be received in order.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_rioshm-TC2-Step2");
+  /******************************************************************************/
+
+  RIOSHM_close(&shmA);
+  openStacks();
+  fd = shm_open(getName("link"), O_RDWR | O_CREAT | O_EXCL, 0600);
+  TESTCOND(fd >= 0);
+  TESTEXPR(shm_unlink(getName("link")), 0);
+  TESTCOND(RIOSHM_create(&shmA, &stackA, fd));
+  RIOSHM_setTxQueueSize(&shmA, 1);
+
+  TESTEXPR(sendDoorbells(fd), DOORBELLS);
+  RIOSHM_close(&shmA);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+}
+
+
+CU_ErrorCode addTests( void )
+{
+  if( CUE_SUCCESS != CU_initialize_registry() )
+  {
+    return CU_get_error();
+  }
+
+  CU_pSuite suite = CU_add_suite( "RIOSHMTEST", NULL, NULL );
+  if( NULL == suite )
+  {
+    CU_cleanup_registry();
+    return CU_get_error();
+  }
+
+  CU_add_test( suite, "allTests", &allTests );
+
+  return CUE_SUCCESS;
+}
+
+
+int main(int argc, char argv[])
+{
+  addTests();
+  CU_basic_run_tests();
+  return CU_get_error();
+}
+
+/*************************** end of file **************************************/
@@ -26,9 +26,11 @@
 #define MODULE_TEST
 #include "riostack.c"
 #include "riopacket.c"
+#include "riopool.c"
 #include <CUnit/CUnit.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #define PrintS(s) printf(s "\n")
 
@@ -47,6 +49,21 @@ static RioStack_t stack;
 static uint32_t rxPacketBuffer[(RIOPACKET_SIZE_MAX + 1) * QUEUE_LENGTH];
 static uint32_t txPacketBuffer[(RIOPACKET_SIZE_MAX + 1) * QUEUE_LENGTH];
 
+/* Two stacks with queues that are larger than the largest ackId window. */
+#define LINK_QUEUE_LENGTH 80
+static RioStack_t stackA;
+static RioStack_t stackB;
+static uint32_t rxPacketBufferA[RIOSTACK_BUFFER_SIZE * LINK_QUEUE_LENGTH];
+static uint32_t txPacketBufferA[RIOSTACK_BUFFER_SIZE * LINK_QUEUE_LENGTH];
+static uint32_t rxPacketBufferB[RIOSTACK_BUFFER_SIZE * LINK_QUEUE_LENGTH];
+static uint32_t txPacketBufferB[RIOSTACK_BUFFER_SIZE * LINK_QUEUE_LENGTH];
+static uint32_t linkControlMask;
+
+#define SNAPSHOT_SIZE_MAX 32768
+static uint8_t snapshotA[SNAPSHOT_SIZE_MAX];
+static uint8_t snapshotB[SNAPSHOT_SIZE_MAX];
+static uint8_t snapshotOther[SNAPSHOT_SIZE_MAX];
+
 static int symbolEquals(RioSymbol_t got, RioSymbol_t expected)
 {
   return got.type == expected.type && got.data == expected.data;
@@ -158,6 +175,133 @@ static void startStack(uint32_t queueSize)
   TESTEXPR(RIOSTACK_getOutboundQueueLength(&stack), 0);
 }
 
+/* Move a symbol between two stacks. Control symbols are masked to simulate ports 
+   that does not transfer the unused byte. */
+static void linkSymbol(RioStack_t *from, RioStack_t *to)
+{
+  RioSymbol_t s;
+
+  s = RIOSTACK_portGetSymbol(from);
+  if(s.type == RIOSTACK_SYMBOL_TYPE_CONTROL)
+  {
+    s.data &= linkControlMask;
+  }
+  RIOSTACK_portAddSymbol(to, s);
+}
+
+/* Exchange symbols between stackA and stackB. */
+static void runLink(int symbols)
+{
+  int i;
+
+  for(i = 0; i < symbols; i++)
+  {
+    linkSymbol(&stackA, &stackB);
+    linkSymbol(&stackB, &stackA);
+  }
+}
+
+/* Open stackA and stackB and connect them to each other until the link is up. */
+static void startLink(uint8_t extendedA, uint8_t extendedB, uint32_t controlMask)
+{
+  RIOSTACK_open(&stackA, NULL,
+      RIOSTACK_BUFFER_SIZE*LINK_QUEUE_LENGTH, rxPacketBufferA,
+      RIOSTACK_BUFFER_SIZE*LINK_QUEUE_LENGTH, txPacketBufferA);
+  RIOSTACK_open(&stackB, NULL,
+      RIOSTACK_BUFFER_SIZE*LINK_QUEUE_LENGTH, rxPacketBufferB,
+      RIOSTACK_BUFFER_SIZE*LINK_QUEUE_LENGTH, txPacketBufferB);
+  RIOSTACK_setExtendedAckId(&stackA, extendedA);
+  RIOSTACK_setExtendedAckId(&stackB, extendedB);
+  RIOSTACK_portSetTimeout(&stackA, 1000);
+  RIOSTACK_portSetTimeout(&stackB, 1000);
+  RIOSTACK_portSetStatus(&stackA, 1);
+  RIOSTACK_portSetStatus(&stackB, 1);
+  linkControlMask = controlMask;
+
+  while(!RIOSTACK_getLinkIsInitialized(&stackA) || !RIOSTACK_getLinkIsInitialized(&stackB))
+  {
+    runLink(1);
+  }
+}
+
+/* Open stackA and stackB with the given link training, connect them and return 
+   the number of symbols each stack sent until the link was up. The number of 
+   control symbols sent by stackA is returned in statusA. */
+static int trainLink(uint8_t intervalA, uint8_t statusTxA, uint8_t statusRxA, uint8_t fastB, int *statusA)
+{
+  RioSymbol_t s;
+  int symbols;
+
+  RIOSTACK_open(&stackA, NULL,
+      RIOSTACK_BUFFER_SIZE*LINK_QUEUE_LENGTH, rxPacketBufferA,
+      RIOSTACK_BUFFER_SIZE*LINK_QUEUE_LENGTH, txPacketBufferA);
+  RIOSTACK_open(&stackB, NULL,
+      RIOSTACK_BUFFER_SIZE*LINK_QUEUE_LENGTH, rxPacketBufferB,
+      RIOSTACK_BUFFER_SIZE*LINK_QUEUE_LENGTH, txPacketBufferB);
+  RIOSTACK_setLinkTraining(&stackA, intervalA, intervalA, statusTxA, statusRxA);
+  if(fastB)
+  {
+    RIOSTACK_setLinkTrainingFast(&stackB);
+  }
+  RIOSTACK_portSetTimeout(&stackA, 1000);
+  RIOSTACK_portSetTimeout(&stackB, 1000);
+  RIOSTACK_portSetStatus(&stackA, 1);
+  RIOSTACK_portSetStatus(&stackB, 1);
+
+  *statusA = 0;
+  for(symbols = 0; !RIOSTACK_getLinkIsInitialized(&stackA) || !RIOSTACK_getLinkIsInitialized(&stackB); symbols++)
+  {
+    s = RIOSTACK_portGetSymbol(&stackA);
+    if(s.type == RIOSTACK_SYMBOL_TYPE_CONTROL)
+    {
+      (*statusA)++;
+    }
+    RIOSTACK_portAddSymbol(&stackB, s);
+    linkSymbol(&stackB, &stackA);
+  }
+
+  return symbols;
+}
+
+/* Send doorbells from stackA while stackB cannot answer and return the number of 
+   packets that was received by stackB before stackA stopped transmitting. Then 
+   let stackB answer and check that all doorbells arrives in order. */
+static int sendWindow(int packets, uint16_t infoStart)
+{
+  RioPacket_t rioPacket;
+  uint16_t dstid, srcid, info;
+  uint8_t tid;
+  int window;
+  int i;
+
+  for(i = 0; i < packets; i++)
+  {
+    RIOPACKET_setDoorbell(&rioPacket, 0x0001, 0x0002, (uint8_t) i, (uint16_t) (infoStart+i));
+    RIOSTACK_setOutboundPacket(&stackA, &rioPacket);
+  }
+
+  /* Only let stackA transmit, no packet-accepted reaches stackA. */
+  for(i = 0; i < 20*packets; i++)
+  {
+    linkSymbol(&stackA, &stackB);
+  }
+  window = RIOSTACK_getInboundQueueLength(&stackB);
+
+  /* Let the link run normally. */
+  runLink(20*packets);
+  TESTEXPR(RIOSTACK_getOutboundQueueLength(&stackA), 0);
+  TESTEXPR(RIOSTACK_getInboundQueueLength(&stackB), packets);
+  for(i = 0; i < packets; i++)
+  {
+    RIOSTACK_getInboundPacket(&stackB, &rioPacket);
+    TESTCOND(RIOPACKET_valid(&rioPacket));
+    RIOPACKET_getDoorbell(&rioPacket, &dstid, &srcid, &tid, &info);
+    TESTEXPR(info, (uint16_t) (infoStart+i));
+  }
+
+  return window;
+}
+
 /* Transmit a waiting outbound packet */
 static void transmitPacket(const uint32_t buffer[], uint32_t bufferLength, uint8_t ackedId, uint8_t inboundQueueAvailable,
     int withEnd)
@@ -244,6 +388,140 @@ static void causeInputErrorStopped(void)
   TESTEXPR(stack.txState, TX_STATE_SEND_PACKET_NOT_ACCEPTED);
 }
 
+/* The events and words that has been given to earlyHandler(). Packets are 
+   forwarded to earlyForward using cut-through if it is set. */
+static int earlyEvents[4];
+static uint32_t earlyWords[RIOPACKET_SIZE_MAX];
+static int earlyWordCount;
+static uint8_t earlyHeaderSize;
+static uint8_t earlyConsume;
+static RioStack_t *earlyForward;
+
+static void earlyReset(uint8_t consume, RioStack_t *forward)
+{
+  int i;
+
+  for(i = 0; i < 4; i++)
+  {
+    earlyEvents[i] = 0;
+  }
+  earlyWordCount = 0;
+  earlyHeaderSize = 0;
+  earlyConsume = consume;
+  earlyForward = forward;
+}
+
+static uint8_t earlyHandler(void *context, RioStack_t *s, const RioStackEarlyEvent_t event, 
+                            const uint8_t size, const uint32_t *words)
+{
+  int i;
+
+  earlyEvents[event]++;
+  if(event == RIOSTACK_EARLY_HEADER)
+  {
+    earlyHeaderSize = size;
+    if(earlyForward != NULL)
+    {
+      RIOSTACK_startOutboundPacket(earlyForward);
+    }
+  }
+  for(i = 0; i < size; i++)
+  {
+    earlyWords[earlyWordCount++] = words[i];
+  }
+  if(earlyForward != NULL)
+  {
+    if(size > 0)
+    {
+      RIOSTACK_appendOutboundPacket(earlyForward, size, words);
+    }
+    if(event == RIOSTACK_EARLY_END)
+    {
+      RIOSTACK_endOutboundPacket(earlyForward);
+    }
+    if(event == RIOSTACK_EARLY_ABORT)
+    {
+      RIOSTACK_abortOutboundPacket(earlyForward);
+    }
+  }
+
+  return (event == RIOSTACK_EARLY_END) ? earlyConsume : 0;
+}
+
+static int multicastEvents;
+static uint32_t multicastTime;
+
+static void multicastEventHandler(void *context, RioStack_t *s, const uint32_t portTime)
+{
+  multicastEvents++;
+  multicastTime = portTime;
+}
+
+/* Virtual channel queues of stackA and stackB. */
+static uint32_t txVc0BufferA[RIOSTACK_BUFFER_SIZE * LINK_QUEUE_LENGTH];
+static uint32_t txVc1BufferA[RIOSTACK_BUFFER_SIZE * LINK_QUEUE_LENGTH];
+static uint32_t rxVc1BufferA[RIOSTACK_BUFFER_SIZE * LINK_QUEUE_LENGTH];
+static uint32_t txVc0BufferB[RIOSTACK_BUFFER_SIZE * LINK_QUEUE_LENGTH];
+static uint32_t txVc1BufferB[RIOSTACK_BUFFER_SIZE * LINK_QUEUE_LENGTH];
+static uint32_t rxVc1BufferB[RIOSTACK_BUFFER_SIZE * LINK_QUEUE_LENGTH];
+
+/* Open stackA and stackB with virtual channels and inbound queues with room for 
+   rxQueueLength packets on each virtual channel and connect them until the link 
+   is up and the buffer status of VC1 is known. */
+static void startVcLink(uint32_t rxQueueLength)
+{
+  RIOSTACK_open(&stackA, NULL,
+      RIOSTACK_BUFFER_SIZE*rxQueueLength, rxPacketBufferA,
+      RIOSTACK_BUFFER_SIZE*LINK_QUEUE_LENGTH, txPacketBufferA);
+  RIOSTACK_open(&stackB, NULL,
+      RIOSTACK_BUFFER_SIZE*rxQueueLength, rxPacketBufferB,
+      RIOSTACK_BUFFER_SIZE*LINK_QUEUE_LENGTH, txPacketBufferB);
+  RIOSTACK_setVirtualChannels(&stackA, 
+      RIOSTACK_BUFFER_SIZE*LINK_QUEUE_LENGTH, txVc0BufferA,
+      RIOSTACK_BUFFER_SIZE*LINK_QUEUE_LENGTH, txVc1BufferA,
+      RIOSTACK_BUFFER_SIZE*rxQueueLength, rxVc1BufferA);
+  RIOSTACK_setVirtualChannels(&stackB, 
+      RIOSTACK_BUFFER_SIZE*LINK_QUEUE_LENGTH, txVc0BufferB,
+      RIOSTACK_BUFFER_SIZE*LINK_QUEUE_LENGTH, txVc1BufferB,
+      RIOSTACK_BUFFER_SIZE*rxQueueLength, rxVc1BufferB);
+  RIOSTACK_portSetTimeout(&stackA, 1000);
+  RIOSTACK_portSetTimeout(&stackB, 1000);
+  RIOSTACK_portSetStatus(&stackA, 1);
+  RIOSTACK_portSetStatus(&stackB, 1);
+  linkControlMask = 0xffffffff;
+
+  while(!RIOSTACK_getLinkIsInitialized(&stackA) || !RIOSTACK_getLinkIsInitialized(&stackB))
+  {
+    runLink(1);
+  }
+  runLink(10);
+}
+
+/* Queue a doorbell on a virtual channel of stackA. */
+static void sendVc(uint8_t vc, uint16_t info)
+{
+  RioPacket_t rioPacket;
+
+  RIOPACKET_setDoorbell(&rioPacket, 0x0001, 0x0002, 0x00, info);
+  RIOPACKET_patchHeader(&rioPacket, RIOPACKET_FIELD_VC, vc);
+  RIOSTACK_setOutboundPacket(&stackA, &rioPacket);
+}
+
+/* Get a doorbell from a virtual channel of stackB and return its info field. */
+static uint16_t receiveVc(uint8_t vc)
+{
+  RioPacket_t rioPacket;
+  uint16_t dstid, srcid, info;
+  uint8_t tid;
+
+  RIOSTACK_getInboundPacketVc(&stackB, vc, &rioPacket);
+  TESTCOND(RIOPACKET_valid(&rioPacket));
+  TESTEXPR(RIOPACKET_getVc(&rioPacket), vc);
+  RIOPACKET_getDoorbell(&rioPacket, &dstid, &srcid, &tid, &info);
+
+  return info;
+}
+
 /*******************************************************************************
  * Module test for this file.
  *******************************************************************************/
@@ -261,6 +539,11 @@ static void allTests(void)
   uint8_t tid;
   uint16_t info;
   uint32_t packetLength;
+  uint32_t dstIdExt;
+  uint32_t srcIdExt;
+  uint8_t status;
+  int window;
+  uint8_t data[256];
 
   /******************************************************************************/
   PrintS("----------------------------------------------------------------------");
@@ -1266,11 +1549,10 @@ static void allTests(void)
   TESTSTART("TG_riostack-TC3-Step3");
   /******************************************************************************/
 
-  /* Send packet with valid ackid and crc but too short. */
+  /* Send packet with valid ackid but shorter than RIOPACKET_SIZE_MIN. */
   packetLength = createDoorbell(packet, 10, 0, 0, 10, 0);
   RIOSTACK_portAddSymbol(&stack, createControlSymbol(STYPE0_STATUS, 5, 1, STYPE1_START_OF_PACKET, 0));
   RIOSTACK_portAddSymbol(&stack, createDataSymbol(packet[0]));
-  RIOSTACK_portAddSymbol(&stack, createDataSymbol(((uint32_t) RIOPACKET_crc32(packet[0] & 0x07ffffff, 0xffff)) << 16));
   TESTEXPR(stack.rxState, RX_STATE_LINK_INITIALIZED);
   TESTEXPR(stack.txState, TX_STATE_LINK_INITIALIZED);
   RIOSTACK_portAddSymbol(&stack, createControlSymbol(STYPE0_STATUS, 5, 1, STYPE1_END_OF_PACKET, 0));
@@ -2011,7 +2293,7 @@ static void allTests(void)
 
   packetLength = createDoorbell(packet, 0, 0, 0xffff, 36, 0);
   RIOSTACK_portAddSymbol(&stack, createControlSymbol(STYPE0_STATUS, 0, 8, STYPE1_START_OF_PACKET, 0));
-  for( i = 0; i < 2; i++ ) /* Partial data */
+  for( i = 0; i < RIOPACKET_SIZE_MIN-1; i++ ) /* Partial data */
   {
     RIOSTACK_portAddSymbol(&stack, createDataSymbol(packet[i]));
   }
@@ -2749,6 +3031,1356 @@ static void allTests(void)
   TESTEXPR(RIOSTACK_getInboundQueueLength(&stack), 0);
   TESTEXPR(RIOSTACK_getOutboundQueueLength(&stack), 0);
 
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("TG_riostack-TC7");
+  PrintS("Description: Exchange packets using a packet pool.");
+  PrintS("Requirement: XXXXX");
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 1:");
+  PrintS("Action: Send one pooled packet twice using an extra reference.");
+  PrintS("Result: Both packets should be transmitted from the pool element and ");
+  PrintS("it should be returned once both packets has been acknowledged.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riostack-TC7-Step1");
+  /******************************************************************************/
+  {
+    RioPool_t pool;
+    RioPoolEntry_t poolEntries[2];
+    RioPoolHandle_t handle;
+
+    startStack(QUEUE_LENGTH);
+    RIOPOOL_open(&pool, 2, poolEntries);
+
+    handle = RIOPOOL_allocate(&pool);
+    TESTCOND(handle != RIOPOOL_HANDLE_INVALID);
+    RIOPACKET_setDoorbell(RIOPOOL_getPacket(&pool, handle), 0x0123, 0x4567, 0x89, 0xabcd);
+
+    RIOPOOL_retain(&pool, handle);
+    RIOSTACK_setOutboundPacketHandle(&stack, &pool, handle);
+    TESTEXPR(RIOPOOL_getReferences(&pool, handle), 2);
+    RIOSTACK_setOutboundPacketHandle(&stack, &pool, handle);
+    TESTEXPR(RIOPOOL_getReferences(&pool, handle), 2);
+    TESTEXPR(RIOPOOL_getAvailable(&pool), 1);
+    TESTEXPR(RIOSTACK_getOutboundQueueLength(&stack), 2);
+
+    packetLength = createDoorbell(packet, 0, 0x0123, 0x4567, 0x89, 0xabcd);
+    transmitPacket(packet, packetLength, 0, QUEUE_LENGTH, 0);
+    packetLength = createDoorbell(packet, 1, 0x0123, 0x4567, 0x89, 0xabcd);
+    transmitPacket(packet, packetLength, 0, QUEUE_LENGTH, 1);
+    TESTEXPR(RIOPOOL_getReferences(&pool, handle), 2);
+
+    /* The references are released when the packets are acknowledged. */
+    RIOSTACK_portAddSymbol(&stack, createControlSymbol(STYPE0_PACKET_ACCEPTED, 0, 1, STYPE1_NOP, 0));
+    TESTEXPR(RIOPOOL_getReferences(&pool, handle), 1);
+    TESTEXPR(RIOPOOL_getAvailable(&pool), 1);
+    RIOSTACK_portAddSymbol(&stack, createControlSymbol(STYPE0_PACKET_ACCEPTED, 1, 1, STYPE1_NOP, 0));
+    TESTEXPR(RIOPOOL_getReferences(&pool, handle), 0);
+    TESTEXPR(RIOPOOL_getAvailable(&pool), 2);
+    TESTEXPR(RIOSTACK_getOutboundQueueLength(&stack), 0);
+  }
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 2:");
+  PrintS("Action: Receive packets into a pool.");
+  PrintS("Result: The packets should be read into pooled packets and be left in ");
+  PrintS("the inbound queue when the pool is empty.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riostack-TC7-Step2");
+  /******************************************************************************/
+  {
+    RioPool_t pool;
+    RioPoolEntry_t poolEntries[1];
+    RioPoolHandle_t handle;
+
+    startStack(QUEUE_LENGTH);
+    RIOPOOL_open(&pool, 1, poolEntries);
+
+    packetLength = createDoorbell(packet, 0, 0x0123, 0x4567, 0x89, 0xabcd);
+    receivePacket(packet, packetLength, 0, QUEUE_LENGTH, 1);
+    packetLength = createDoorbell(packet, 1, 0x0123, 0x4567, 0x8a, 0xabce);
+    receivePacket(packet, packetLength, 0, QUEUE_LENGTH, 1);
+    TESTEXPR(RIOSTACK_getInboundQueueLength(&stack), 2);
+
+    handle = RIOSTACK_getInboundPacketHandle(&stack, &pool);
+    TESTCOND(handle != RIOPOOL_HANDLE_INVALID);
+    TESTEXPR(RIOSTACK_getInboundQueueLength(&stack), 1);
+    RIOPACKET_getDoorbell(RIOPOOL_getPacket(&pool, handle), &dstid, &srcid, &tid, &info);
+    TESTEXPR(dstid, 0x0123);
+    TESTEXPR(srcid, 0x4567);
+    TESTEXPR(tid, 0x89);
+    TESTEXPR(info, 0xabcd);
+
+    TESTEXPR(RIOSTACK_getInboundPacketHandle(&stack, &pool), RIOPOOL_HANDLE_INVALID);
+    TESTEXPR(RIOSTACK_getInboundQueueLength(&stack), 1);
+
+    RIOPOOL_release(&pool, handle);
+    handle = RIOSTACK_getInboundPacketHandle(&stack, &pool);
+    TESTCOND(handle != RIOPOOL_HANDLE_INVALID);
+    TESTEXPR(RIOSTACK_getInboundQueueLength(&stack), 0);
+    RIOPACKET_getDoorbell(RIOPOOL_getPacket(&pool, handle), &dstid, &srcid, &tid, &info);
+    TESTEXPR(tid, 0x8a);
+    TESTEXPR(info, 0xabce);
+    RIOPOOL_release(&pool, handle);
+    TESTEXPR(RIOPOOL_getAvailable(&pool), 1);
+  }
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 3:");
+  PrintS("Action: Send pooled packets from several pools.");
+  PrintS("Result: Each packet should be transmitted from its own pool and be ");
+  PrintS("        returned to it when acknowledged. A packet from one pool more ");
+  PrintS("        than the stack can keep should assert.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riostack-TC7-Step3");
+  /******************************************************************************/
+  {
+    RioPool_t pool[RIOSTACK_POOLS+1u];
+    RioPoolEntry_t poolEntries[RIOSTACK_POOLS+1u][1];
+    RioPoolHandle_t handle[RIOSTACK_POOLS+1u];
+
+    startStack(QUEUE_LENGTH);
+    for(i = 0; i <= RIOSTACK_POOLS; i++)
+    {
+      RIOPOOL_open(&pool[i], 1, poolEntries[i]);
+      handle[i] = RIOPOOL_allocate(&pool[i]);
+      RIOPACKET_setDoorbell(RIOPOOL_getPacket(&pool[i], handle[i]), 0x0123, 0x4567, (uint8_t) i, 0xabcd);
+    }
+    for(i = 0; i < RIOSTACK_POOLS; i++)
+    {
+      RIOSTACK_setOutboundPacketHandle(&stack, &pool[i], handle[i]);
+    }
+    TESTEXPR(RIOSTACK_getOutboundQueueLength(&stack), RIOSTACK_POOLS);
+
+    TEST_numExpectedAssertsRemaining = 1;
+    RIOSTACK_setOutboundPacketHandle(&stack, &pool[RIOSTACK_POOLS], handle[RIOSTACK_POOLS]);
+    TESTEXPR(TEST_numExpectedAssertsRemaining, 0);
+    TESTEXPR(RIOSTACK_getOutboundQueueLength(&stack), RIOSTACK_POOLS);
+
+    for(i = 0; i < RIOSTACK_POOLS; i++)
+    {
+      packetLength = createDoorbell(packet, (uint8_t) i, 0x0123, 0x4567, (uint8_t) i, 0xabcd);
+      transmitPacket(packet, packetLength, 0, QUEUE_LENGTH, i == (RIOSTACK_POOLS-1u));
+    }
+    for(i = 0; i < RIOSTACK_POOLS; i++)
+    {
+      RIOSTACK_portAddSymbol(&stack, createControlSymbol(STYPE0_PACKET_ACCEPTED, (uint8_t) i, 1, STYPE1_NOP, 0));
+      TESTEXPR(RIOPOOL_getAvailable(&pool[i]), 1);
+    }
+    TESTEXPR(RIOSTACK_getOutboundQueueLength(&stack), 0);
+  }
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("TG_riostack-TC8");
+  PrintS("Description: Test extended ackIds.");
+  PrintS("Requirement: XXXXX");
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 1:");
+  PrintS("Action: Connect two stacks that both has extended ackIds enabled and ");
+  PrintS("        send more packets than fits in the 5-bit ackId window.");
+  PrintS("Result: 6-bit ackIds should be negotiated and 63 packets should be ");
+  PrintS("        outstanding. The packets should be received in order also when ");
+  PrintS("        the ackIds wrap.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riostack-TC8-Step1");
+  /******************************************************************************/
+
+  startLink(1, 1, 0xffffffff);
+  TESTEXPR(RIOSTACK_getExtendedAckId(&stackA), 1);
+  TESTEXPR(RIOSTACK_getExtendedAckId(&stackB), 1);
+
+  TESTEXPR(sendWindow(70, 0x1000), 63);
+  TESTEXPR(sendWindow(70, 0x2000), 63);
+  TESTEXPR(stackA.txAckId, 140 % 64);
+  TESTEXPR(stackB.rxAckId, 140 % 64);
+  TESTEXPR(stackA.statusOutboundPacketComplete, 140);
+  TESTEXPR(stackB.statusInboundErrorPacketAckId, 0);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 2:");
+  PrintS("Action: Connect a stack with extended ackIds enabled to a stack without.");
+  PrintS("Result: Both stacks should use 5-bit ackIds and 31 packets should be ");
+  PrintS("        outstanding.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riostack-TC8-Step2");
+  /******************************************************************************/
+
+  startLink(1, 0, 0xffffffff);
+  TESTEXPR(RIOSTACK_getExtendedAckId(&stackA), 0);
+  TESTEXPR(RIOSTACK_getExtendedAckId(&stackB), 0);
+  TESTEXPR(sendWindow(70, 0x3000), 31);
+  TESTEXPR(stackA.txAckId, 70 % 32);
+
+  startLink(0, 1, 0xffffffff);
+  TESTEXPR(RIOSTACK_getExtendedAckId(&stackA), 0);
+  TESTEXPR(RIOSTACK_getExtendedAckId(&stackB), 0);
+  TESTEXPR(sendWindow(70, 0x4000), 31);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 3:");
+  PrintS("Action: Connect two stacks with extended ackIds enabled using ports ");
+  PrintS("        that only transfers 24-bit control symbols.");
+  PrintS("Result: Both stacks should fall back to 5-bit ackIds.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riostack-TC8-Step3");
+  /******************************************************************************/
+
+  startLink(1, 1, 0x00ffffff);
+  TESTEXPR(RIOSTACK_getExtendedAckId(&stackA), 0);
+  TESTEXPR(RIOSTACK_getExtendedAckId(&stackB), 0);
+  TESTEXPR(sendWindow(70, 0x5000), 31);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 4:");
+  PrintS("Action: Reinitialize a link that uses extended ackIds after disabling ");
+  PrintS("        them in one of the stacks.");
+  PrintS("Result: The link should be renegotiated to use 5-bit ackIds.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riostack-TC8-Step4");
+  /******************************************************************************/
+
+  startLink(1, 1, 0xffffffff);
+  TESTEXPR(RIOSTACK_getExtendedAckId(&stackA), 1);
+
+  RIOSTACK_setExtendedAckId(&stackB, 0);
+  RIOSTACK_portSetStatus(&stackA, 1);
+  RIOSTACK_portSetStatus(&stackB, 1);
+  while(!RIOSTACK_getLinkIsInitialized(&stackA) || !RIOSTACK_getLinkIsInitialized(&stackB))
+  {
+    runLink(1);
+  }
+  TESTEXPR(RIOSTACK_getExtendedAckId(&stackA), 0);
+  TESTEXPR(RIOSTACK_getExtendedAckId(&stackB), 0);
+  TESTEXPR(sendWindow(40, 0x6000), 31);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("TG_riostack-TC9");
+  PrintS("Description: Test the outbound queue when a link goes down.");
+  PrintS("Requirement: XXXXX");
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 1:");
+  PrintS("Action: Send doorbells when no packet-accepted reaches the transmitter ");
+  PrintS("        and set the port to uninitialized. Remove the outbound packets.");
+  PrintS("Result: The packets that were transmitted should be returned first and ");
+  PrintS("        marked as transmitted, followed by the packets that were not ");
+  PrintS("        transmitted. Removing packets from an empty queue or from an ");
+  PrintS("        active port should assert.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riostack-TC9-Step1");
+  /******************************************************************************/
+
+  startLink(0, 0, 0xffffffff);
+  for(i = 0; i < 10; i++)
+  {
+    RIOPACKET_setDoorbell(&rioPacket, 0x0001, 0x0002, (uint8_t) i, (uint16_t) (0x7000+i));
+    RIOSTACK_setOutboundPacket(&stackA, &rioPacket);
+  }
+  for(i = 0; i < 20; i++)
+  {
+    linkSymbol(&stackA, &stackB);
+  }
+  window = RIOSTACK_getInboundQueueLength(&stackB);
+  TESTCOND(window > 0);
+  TESTCOND(window < 10);
+
+  TEST_numExpectedAssertsRemaining = 1;
+  RIOSTACK_getOutboundPacket(&stackA, &rioPacket);
+  TESTEXPR(TEST_numExpectedAssertsRemaining, 0);
+
+  RIOSTACK_portSetStatus(&stackA, 0);
+  TESTEXPR(RIOSTACK_getOutboundQueueLength(&stackA), 10);
+  for(i = 0; i < 10; i++)
+  {
+    TESTEXPR(RIOSTACK_getOutboundPacket(&stackA, &rioPacket), (i < window) ? 1 : 0);
+    TESTCOND(RIOPACKET_valid(&rioPacket));
+    RIOPACKET_getDoorbell(&rioPacket, &dstid, &srcid, &tid, &info);
+    TESTEXPR(info, 0x7000+i);
+  }
+  TESTEXPR(RIOSTACK_getOutboundQueueLength(&stackA), 0);
+
+  TEST_numExpectedAssertsRemaining = 1;
+  RIOSTACK_getOutboundPacket(&stackA, &rioPacket);
+  TESTEXPR(TEST_numExpectedAssertsRemaining, 0);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 2:");
+  PrintS("Action: Send doorbells when no packet-accepted reaches the transmitter, ");
+  PrintS("        set the ports to uninitialized and then initialize them again.");
+  PrintS("Result: The packets that were not acknowledged should be transmitted ");
+  PrintS("        again in order after the packets that were received before the ");
+  PrintS("        port went down.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riostack-TC9-Step2");
+  /******************************************************************************/
+
+  startLink(0, 0, 0xffffffff);
+  for(i = 0; i < 10; i++)
+  {
+    RIOPACKET_setDoorbell(&rioPacket, 0x0001, 0x0002, (uint8_t) i, (uint16_t) (0x8000+i));
+    RIOSTACK_setOutboundPacket(&stackA, &rioPacket);
+  }
+  for(i = 0; i < 20; i++)
+  {
+    linkSymbol(&stackA, &stackB);
+  }
+  window = RIOSTACK_getInboundQueueLength(&stackB);
+  TESTCOND(window > 0);
+
+  RIOSTACK_portSetStatus(&stackA, 0);
+  RIOSTACK_portSetStatus(&stackB, 0);
+  RIOSTACK_portSetStatus(&stackA, 1);
+  RIOSTACK_portSetStatus(&stackB, 1);
+  runLink(1000);
+  TESTEXPR(RIOSTACK_getOutboundQueueLength(&stackA), 0);
+  TESTEXPR(RIOSTACK_getInboundQueueLength(&stackB), window+10);
+  for(i = 0; i < window+10; i++)
+  {
+    RIOSTACK_getInboundPacket(&stackB, &rioPacket);
+    RIOPACKET_getDoorbell(&rioPacket, &dstid, &srcid, &tid, &info);
+    TESTEXPR(info, 0x8000 + ((i < window) ? i : (i-window)));
+  }
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("TG_riostack-TC10");
+  PrintS("Description: Test snapshot and restore of a stack.");
+  PrintS("Requirement: XXXXX");
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 1:");
+  PrintS("Action: Take snapshots of two connected stacks with packets in flight ");
+  PrintS("        in both directions, clear the stacks and restore them.");
+  PrintS("Result: The restored stacks should give identical snapshots and the ");
+  PrintS("        link should continue without errors with all packets ");
+  PrintS("        received in order.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riostack-TC10-Step1");
+  /******************************************************************************/
+
+  startLink(1, 1, 0xffffffff);
+  for(i = 0; i < 20; i++)
+  {
+    RIOPACKET_setDoorbell(&rioPacket, 0x0001, 0x0002, (uint8_t) i, (uint16_t) (0x9000+i));
+    RIOSTACK_setOutboundPacket(&stackA, &rioPacket);
+  }
+  for(i = 0; i < 5; i++)
+  {
+    RIOPACKET_setDoorbell(&rioPacket, 0x0002, 0x0001, (uint8_t) i, (uint16_t) (0xa000+i));
+    RIOSTACK_setOutboundPacket(&stackB, &rioPacket);
+  }
+  runLink(15);
+  linkSymbol(&stackA, &stackB);
+  TESTCOND(RIOSTACK_getOutboundQueueLength(&stackA) > 0);
+  TESTCOND(RIOSTACK_getInboundQueueLength(&stackB) > 0);
+  TESTCOND(stackB.rxCounter > 1);
+
+  length = (uint16_t) RIOSTACK_getSnapshotSize(&stackA);
+  TESTEXPR(RIOSTACK_snapshot(&stackA, length-1, snapshotA), 0);
+  TESTEXPR(RIOSTACK_snapshot(&stackA, SNAPSHOT_SIZE_MAX, snapshotA), length);
+  TESTEXPR(snapshotA[0], 'R');
+  TESTEXPR(snapshotA[3], 'S');
+  TESTEXPR(snapshotA[7], RIOSTACK_SNAPSHOT_VERSION);
+  packetLength = RIOSTACK_snapshot(&stackB, SNAPSHOT_SIZE_MAX, snapshotB);
+  TESTEXPR(packetLength, RIOSTACK_getSnapshotSize(&stackB));
+
+  /* Simulate a new process. */
+  memset(&stackA, 0xa5, sizeof(stackA));
+  memset(&stackB, 0xa5, sizeof(stackB));
+  memset(txPacketBufferA, 0xa5, sizeof(txPacketBufferA));
+  memset(rxPacketBufferB, 0xa5, sizeof(rxPacketBufferB));
+  RIOSTACK_open(&stackA, NULL,
+      RIOSTACK_BUFFER_SIZE*LINK_QUEUE_LENGTH, rxPacketBufferA,
+      RIOSTACK_BUFFER_SIZE*LINK_QUEUE_LENGTH, txPacketBufferA);
+  RIOSTACK_open(&stackB, NULL,
+      RIOSTACK_BUFFER_SIZE*LINK_QUEUE_LENGTH, rxPacketBufferB,
+      RIOSTACK_BUFFER_SIZE*LINK_QUEUE_LENGTH, txPacketBufferB);
+  TESTCOND(RIOSTACK_restore(&stackA, length, snapshotA));
+  TESTCOND(RIOSTACK_restore(&stackB, SNAPSHOT_SIZE_MAX, snapshotB));
+  TESTCOND(RIOSTACK_getLinkIsInitialized(&stackA));
+  TESTEXPR(RIOSTACK_getExtendedAckId(&stackA), 1);
+
+  TESTEXPR(RIOSTACK_snapshot(&stackA, SNAPSHOT_SIZE_MAX, snapshotOther), length);
+  TESTEXPR(memcmp(snapshotA, snapshotOther, length), 0);
+  TESTEXPR(RIOSTACK_snapshot(&stackB, SNAPSHOT_SIZE_MAX, snapshotOther), packetLength);
+  TESTEXPR(memcmp(snapshotB, snapshotOther, packetLength), 0);
+
+  runLink(2000);
+  TESTEXPR(RIOSTACK_getOutboundQueueLength(&stackA), 0);
+  TESTEXPR(RIOSTACK_getOutboundQueueLength(&stackB), 0);
+  TESTEXPR(RIOSTACK_getInboundQueueLength(&stackB), 20);
+  for(i = 0; i < 20; i++)
+  {
+    RIOSTACK_getInboundPacket(&stackB, &rioPacket);
+    TESTCOND(RIOPACKET_valid(&rioPacket));
+    RIOPACKET_getDoorbell(&rioPacket, &dstid, &srcid, &tid, &info);
+    TESTEXPR(info, 0x9000+i);
+  }
+  TESTEXPR(RIOSTACK_getInboundQueueLength(&stackA), 5);
+  for(i = 0; i < 5; i++)
+  {
+    RIOSTACK_getInboundPacket(&stackA, &rioPacket);
+    RIOPACKET_getDoorbell(&rioPacket, &dstid, &srcid, &tid, &info);
+    TESTEXPR(info, 0xa000+i);
+  }
+  TESTEXPR(stackA.statusOutboundPacketComplete, 20);
+  TESTEXPR(stackB.statusInboundPacketComplete, 20);
+  TESTEXPR(stackA.statusPartnerLinkRequest, 0);
+  TESTEXPR(stackB.statusPartnerLinkRequest, 0);
+  TESTEXPR(stackA.statusOutboundErrorTimeout, 0);
+  TESTEXPR(stackB.statusInboundErrorPacketAckId, 0);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 2:");
+  PrintS("Action: Restore invalid snapshots.");
+  PrintS("Result: The snapshots should be rejected and the stack unchanged.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riostack-TC10-Step2");
+  /******************************************************************************/
+
+  RIOSTACK_open(&stackA, NULL,
+      RIOSTACK_BUFFER_SIZE*LINK_QUEUE_LENGTH, rxPacketBufferA,
+      RIOSTACK_BUFFER_SIZE*LINK_QUEUE_LENGTH, txPacketBufferA);
+  TESTCOND(!RIOSTACK_restore(&stackA, 8, snapshotA));
+  TESTCOND(!RIOSTACK_restore(&stackA, length-4, snapshotA));
+
+  memcpy(snapshotOther, snapshotA, length);
+  snapshotOther[1] ^= 0x01;
+  TESTCOND(!RIOSTACK_restore(&stackA, length, snapshotOther));
+
+  memcpy(snapshotOther, snapshotA, length);
+  snapshotOther[7] = RIOSTACK_SNAPSHOT_VERSION+1;
+  TESTCOND(!RIOSTACK_restore(&stackA, length, snapshotOther));
+
+  /* The receiver state is the first word after the header. */
+  memcpy(snapshotOther, snapshotA, length);
+  snapshotOther[15] = 0x7f;
+  TESTCOND(!RIOSTACK_restore(&stackA, length, snapshotOther));
+
+  memcpy(snapshotOther, snapshotA, length);
+  snapshotOther[length-1] ^= 0x01;
+  TESTCOND(RIOSTACK_restore(&stackA, length, snapshotOther));
+  TESTEXPR(stackA.statusPartnerErrorGeneral, 1);
+
+  RIOSTACK_open(&stackA, NULL,
+      RIOSTACK_BUFFER_SIZE*LINK_QUEUE_LENGTH, rxPacketBufferA,
+      RIOSTACK_BUFFER_SIZE*(LINK_QUEUE_LENGTH/2), txPacketBufferA);
+  TESTCOND(!RIOSTACK_restore(&stackA, length, snapshotA));
+  TESTEXPR(stackA.rxState, RX_STATE_UNINITIALIZED);
+  TESTEXPR(RIOSTACK_getOutboundQueueLength(&stackA), 0);
+  TESTEXPR(stackA.statusInboundPacketComplete, 0);
+
+  /* The handles of pooled packets in the outbound queue must not be lost. */
+  {
+    RioPool_t pool;
+    RioPoolEntry_t poolEntries[1];
+    RioPoolHandle_t handle;
+
+    RIOSTACK_open(&stackA, NULL,
+        RIOSTACK_BUFFER_SIZE*LINK_QUEUE_LENGTH, rxPacketBufferA,
+        RIOSTACK_BUFFER_SIZE*LINK_QUEUE_LENGTH, txPacketBufferA);
+    RIOPOOL_open(&pool, 1, poolEntries);
+    handle = RIOPOOL_allocate(&pool);
+    RIOPACKET_setDoorbell(RIOPOOL_getPacket(&pool, handle), 0x0123, 0x4567, 0x89, 0xabcd);
+    RIOSTACK_setOutboundPacketHandle(&stackA, &pool, handle);
+    TESTCOND(!RIOSTACK_restore(&stackA, length, snapshotA));
+    TESTEXPR(RIOSTACK_getOutboundQueueLength(&stackA), 1);
+    TESTEXPR(stackA.txPoolPackets, 1);
+    TESTEXPR(RIOPOOL_getReferences(&pool, handle), 1);
+  }
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("TG_riostack-TC11");
+  PrintS("Description: Test link training parameters.");
+  PrintS("Requirement: XXXXX");
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 1:");
+  PrintS("Action: Initialize links with default and fast link training.");
+  PrintS("Result: Fast link training should initialize the link in a fraction ");
+  PrintS("        of the symbols and still send at least 15 status-control-");
+  PrintS("        symbols. Fast training in one stack only should also be ");
+  PrintS("        faster.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riostack-TC11-Step1");
+  /******************************************************************************/
+
+  linkControlMask = 0xffffffff;
+  j = trainLink(RIOSTACK_TRAINING_INTERVAL, RIOSTACK_TRAINING_STATUS_TX, RIOSTACK_TRAINING_STATUS_RX, 0, &window);
+  TESTCOND(j > 255);
+  TESTCOND(window >= 16);
+
+  i = trainLink(0, RIOSTACK_TRAINING_STATUS_TX, RIOSTACK_TRAINING_STATUS_RX, 1, &window);
+  TESTCOND(i < 20);
+  TESTCOND(window >= 16);
+  TESTEXPR(window, i);
+
+  i = trainLink(RIOSTACK_TRAINING_INTERVAL, RIOSTACK_TRAINING_STATUS_TX, RIOSTACK_TRAINING_STATUS_RX, 1, &window);
+  TESTCOND(i < j);
+
+  /* The link should work normally. */
+  TESTEXPR(sendWindow(10, 0xb000), 10);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 2:");
+  PrintS("Action: Set status counts below and above the minimums.");
+  PrintS("Result: Counts below the minimums should be raised to the minimums. ");
+  PrintS("        Higher counts should be sent and required.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riostack-TC11-Step2");
+  /******************************************************************************/
+
+  RIOSTACK_setLinkTraining(&stackA, 3, 1, 2, 3);
+  TESTEXPR(stackA.trainingInterval, 3);
+  TESTEXPR(stackA.trainingIntervalReceived, 1);
+  TESTEXPR(stackA.trainingStatusTx, RIOSTACK_TRAINING_STATUS_TX);
+  TESTEXPR(stackA.trainingStatusRx, RIOSTACK_TRAINING_STATUS_RX);
+
+  i = trainLink(0, 40, RIOSTACK_TRAINING_STATUS_RX, 1, &window);
+  TESTCOND(window >= 41);
+  TESTCOND(i < 50);
+
+  /* The link partner only sends the minimum number of status-control-symbols 
+     back-to-back, the rest arrives as the periodic status-control-symbols. */
+  i = trainLink(0, RIOSTACK_TRAINING_STATUS_TX, 30, 1, &window);
+  TESTCOND(i >= 31);
+  TESTEXPR(sendWindow(10, 0xc000), 10);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("TG_riostack-TC12");
+  PrintS("Description: Test cut-through transmission.");
+  PrintS("Requirement: XXXXX");
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 1:");
+  PrintS("Action: Start an outbound packet and add its words a few at a time.");
+  PrintS("Result: The packet should be started at once and each word should be ");
+  PrintS("        sent when it has been added. Idle-symbols should be sent ");
+  PrintS("        while waiting for more words.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riostack-TC12-Step1");
+  /******************************************************************************/
+
+  for(i = 0; i < 256; i++)
+  {
+    data[i] = (uint8_t) i;
+  }
+
+  startStack(QUEUE_LENGTH);
+  RIOPACKET_setNwrite(&rioPacket, 0x0001, 0x0002, 0x1000, 32, data);
+
+  RIOSTACK_startOutboundPacket(&stack);
+  TESTEXPR(RIOSTACK_getOutboundQueueLength(&stack), 1);
+  s = RIOSTACK_portGetSymbol(&stack);
+  TESTEXPR(s.type, RIOSTACK_SYMBOL_TYPE_CONTROL);
+  TESTEXPR(STYPE1_GET(s.data), STYPE1_START_OF_PACKET);
+  s = RIOSTACK_portGetSymbol(&stack);
+  TESTEXPR(s.type, RIOSTACK_SYMBOL_TYPE_IDLE);
+
+  RIOSTACK_appendOutboundPacket(&stack, 3, &rioPacket.payload[0]);
+  for(i = 0; i < 3; i++)
+  {
+    TESTSYMBOL(RIOSTACK_portGetSymbol(&stack), createDataSymbol(rioPacket.payload[i]));
+  }
+  s = RIOSTACK_portGetSymbol(&stack);
+  TESTEXPR(s.type, RIOSTACK_SYMBOL_TYPE_IDLE);
+
+  RIOSTACK_appendOutboundPacket(&stack, rioPacket.size-3, &rioPacket.payload[3]);
+  RIOSTACK_endOutboundPacket(&stack);
+  TESTEXPR(stack.txCutThrough, 0);
+  for(i = 3; i < rioPacket.size; i++)
+  {
+    TESTSYMBOL(RIOSTACK_portGetSymbol(&stack), createDataSymbol(rioPacket.payload[i]));
+  }
+  s = RIOSTACK_portGetSymbol(&stack);
+  TESTEXPR(s.type, RIOSTACK_SYMBOL_TYPE_CONTROL);
+  TESTEXPR(STYPE1_GET(s.data), STYPE1_END_OF_PACKET);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 2:");
+  PrintS("Action: Abort an outbound packet that has been partly sent and send ");
+  PrintS("        a new packet.");
+  PrintS("Result: A stomp-control-symbol should be sent and the new packet ");
+  PrintS("        should use the ackId of the aborted packet.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riostack-TC12-Step2");
+  /******************************************************************************/
+
+  RIOSTACK_startOutboundPacket(&stack);
+  RIOSTACK_appendOutboundPacket(&stack, 3, &rioPacket.payload[0]);
+  s = RIOSTACK_portGetSymbol(&stack);
+  TESTEXPR(STYPE1_GET(s.data), STYPE1_START_OF_PACKET);
+  TESTSYMBOL(RIOSTACK_portGetSymbol(&stack), createDataSymbol(rioPacket.payload[0] | (1ul << 27)));
+  TESTSYMBOL(RIOSTACK_portGetSymbol(&stack), createDataSymbol(rioPacket.payload[1]));
+
+  RIOSTACK_abortOutboundPacket(&stack);
+  TESTEXPR(stack.txCutThrough, 0);
+  TESTEXPR(RIOSTACK_getOutboundQueueLength(&stack), 1);
+  s = RIOSTACK_portGetSymbol(&stack);
+  TESTEXPR(s.type, RIOSTACK_SYMBOL_TYPE_CONTROL);
+  TESTEXPR(STYPE1_GET(s.data), STYPE1_STOMP);
+  s = RIOSTACK_portGetSymbol(&stack);
+  TESTEXPR(s.type, RIOSTACK_SYMBOL_TYPE_IDLE);
+
+  RIOPACKET_setDoorbell(&rioPacket, 0x0001, 0x0002, 0x03, 0x0405);
+  RIOSTACK_setOutboundPacket(&stack, &rioPacket);
+  s = RIOSTACK_portGetSymbol(&stack);
+  TESTEXPR(STYPE1_GET(s.data), STYPE1_START_OF_PACKET);
+  TESTSYMBOL(RIOSTACK_portGetSymbol(&stack), createDataSymbol(rioPacket.payload[0] | (1ul << 27)));
+  TESTSYMBOL(RIOSTACK_portGetSymbol(&stack), createDataSymbol(rioPacket.payload[1]));
+  TESTSYMBOL(RIOSTACK_portGetSymbol(&stack), createDataSymbol(rioPacket.payload[2]));
+  s = RIOSTACK_portGetSymbol(&stack);
+  TESTEXPR(STYPE1_GET(s.data), STYPE1_END_OF_PACKET);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 3:");
+  PrintS("Action: Abort outbound packets that have not been started, both when ");
+  PrintS("        the link is idle and when another packet is being sent.");
+  PrintS("Result: The packets should be removed without sending a stomp-");
+  PrintS("        control-symbol.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riostack-TC12-Step3");
+  /******************************************************************************/
+
+  RIOSTACK_startOutboundPacket(&stack);
+  RIOSTACK_abortOutboundPacket(&stack);
+  TESTEXPR(RIOSTACK_getOutboundQueueLength(&stack), 2);
+  s = RIOSTACK_portGetSymbol(&stack);
+  TESTEXPR(s.type, RIOSTACK_SYMBOL_TYPE_IDLE);
+
+  RIOSTACK_setOutboundPacket(&stack, &rioPacket);
+  s = RIOSTACK_portGetSymbol(&stack);
+  TESTEXPR(STYPE1_GET(s.data), STYPE1_START_OF_PACKET);
+  TESTSYMBOL(RIOSTACK_portGetSymbol(&stack), createDataSymbol(rioPacket.payload[0] | (2ul << 27)));
+  RIOSTACK_startOutboundPacket(&stack);
+  RIOSTACK_appendOutboundPacket(&stack, 2, &rioPacket.payload[0]);
+  RIOSTACK_abortOutboundPacket(&stack);
+  TESTEXPR(RIOSTACK_getOutboundQueueLength(&stack), 3);
+  TESTSYMBOL(RIOSTACK_portGetSymbol(&stack), createDataSymbol(rioPacket.payload[1]));
+  TESTSYMBOL(RIOSTACK_portGetSymbol(&stack), createDataSymbol(rioPacket.payload[2]));
+  s = RIOSTACK_portGetSymbol(&stack);
+  TESTEXPR(STYPE1_GET(s.data), STYPE1_END_OF_PACKET);
+  s = RIOSTACK_portGetSymbol(&stack);
+  TESTEXPR(s.type, RIOSTACK_SYMBOL_TYPE_IDLE);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 4:");
+  PrintS("Action: Forward a 256 byte NWRITE over a link one word per symbol, ");
+  PrintS("        with and without cut-through. Abort a forwarded packet.");
+  PrintS("Result: With cut-through, the packet should be received a few symbols ");
+  PrintS("        after the last word was added. An aborted packet should not ");
+  PrintS("        be received and the link should continue to work.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riostack-TC12-Step4");
+  /******************************************************************************/
+
+  startLink(0, 0, 0xffffffff);
+  RIOPACKET_setNwrite(&rioPacket, 0x0001, 0x0002, 0x1000, 256, data);
+  TESTEXPR(rioPacket.size, 68);
+
+  /* Cut-through, the words are added at the rate they are sent. */
+  RIOSTACK_startOutboundPacket(&stackA);
+  for(i = 0; i < rioPacket.size; i++)
+  {
+    RIOSTACK_appendOutboundPacket(&stackA, 1, &rioPacket.payload[i]);
+    runLink(1);
+  }
+  RIOSTACK_endOutboundPacket(&stackA);
+  for(i = 0; RIOSTACK_getInboundQueueLength(&stackB) == 0; i++)
+  {
+    runLink(1);
+  }
+  TESTCOND(i <= 3);
+
+  /* Store-and-forward, the packet is queued when all words are known. */
+  runLink(rioPacket.size);
+  RIOSTACK_setOutboundPacket(&stackA, &rioPacket);
+  for(j = 0; RIOSTACK_getInboundQueueLength(&stackB) == 1; j++)
+  {
+    runLink(1);
+  }
+  TESTCOND(j > rioPacket.size);
+
+  for(i = 0; i < 2; i++)
+  {
+    RIOSTACK_getInboundPacket(&stackB, &rioPacket);
+    TESTCOND(RIOPACKET_valid(&rioPacket));
+    RIOPACKET_getNwrite(&rioPacket, &dstid, &srcid, &packetLength, &length, data);
+    TESTEXPR(packetLength, 0x1000);
+    TESTEXPR(length, 256);
+    TESTEXPR(data[255], 255);
+  }
+
+  /* Abort a packet on the link. */
+  RIOSTACK_startOutboundPacket(&stackA);
+  for(i = 0; i < 10; i++)
+  {
+    RIOSTACK_appendOutboundPacket(&stackA, 1, &rioPacket.payload[i]);
+    runLink(1);
+  }
+  RIOSTACK_abortOutboundPacket(&stackA);
+  runLink(20);
+  TESTEXPR(RIOSTACK_getOutboundQueueLength(&stackA), 0);
+  TESTEXPR(RIOSTACK_getInboundQueueLength(&stackB), 0);
+  TESTEXPR(stackB.statusInboundErrorPacketCrc, 0);
+  TESTEXPR(sendWindow(10, 0xd000), 10);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 5:");
+  PrintS("Action: Use the cut-through functions in the wrong order.");
+  PrintS("Result: Asserts should be raised and no snapshot should be taken ");
+  PrintS("        while a packet is being written.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riostack-TC12-Step5");
+  /******************************************************************************/
+
+  TEST_numExpectedAssertsRemaining = 1;
+  RIOSTACK_abortOutboundPacket(&stackA);
+  TESTEXPR(TEST_numExpectedAssertsRemaining, 0);
+
+  TEST_numExpectedAssertsRemaining = 1;
+  RIOSTACK_endOutboundPacket(&stackA);
+  TESTEXPR(TEST_numExpectedAssertsRemaining, 0);
+
+  RIOSTACK_startOutboundPacket(&stackA);
+  TESTEXPR(RIOSTACK_snapshot(&stackA, SNAPSHOT_SIZE_MAX, snapshotA), 0);
+
+  TEST_numExpectedAssertsRemaining = 1;
+  RIOSTACK_startOutboundPacket(&stackA);
+  TESTEXPR(TEST_numExpectedAssertsRemaining, 0);
+
+  TEST_numExpectedAssertsRemaining = 1;
+  RIOSTACK_setOutboundPacket(&stackA, &rioPacket);
+  TESTEXPR(TEST_numExpectedAssertsRemaining, 0);
+
+  TEST_numExpectedAssertsRemaining = 1;
+  RIOSTACK_endOutboundPacket(&stackA);
+  TESTEXPR(TEST_numExpectedAssertsRemaining, 0);
+
+  TESTEXPR(RIOSTACK_getOutboundQueueLength(&stackA), 1);
+  RIOSTACK_abortOutboundPacket(&stackA);
+  TESTEXPR(RIOSTACK_getOutboundQueueLength(&stackA), 0);
+  TESTCOND(RIOSTACK_snapshot(&stackA, SNAPSHOT_SIZE_MAX, snapshotA) > 0);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("TG_riostack-TC13");
+  PrintS("Description: Test the early handler of inbound packets.");
+  PrintS("Requirement: XXXXX");
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 1:");
+  PrintS("Action: Send a packet over a link to a stack with an early handler ");
+  PrintS("        that needs two header words.");
+  PrintS("Result: The header should be reported when the second data-symbol ");
+  PrintS("        has been received, the rest of the words one at a time and ");
+  PrintS("        the end when the packet is complete. The packet should be ");
+  PrintS("        delivered as usual.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riostack-TC13-Step1");
+  /******************************************************************************/
+
+  startLink(0, 0, 0xffffffff);
+  RIOSTACK_setEarlyHandler(&stackB, 2, earlyHandler, NULL);
+  earlyReset(0, NULL);
+  RIOPACKET_setNwrite(&rioPacket, 0x0001, 0x0002, 0x1000, 64, data);
+  RIOSTACK_setOutboundPacket(&stackA, &rioPacket);
+
+  /* Start-of-packet and the first word. */
+  linkSymbol(&stackA, &stackB);
+  linkSymbol(&stackA, &stackB);
+  TESTEXPR(earlyEvents[RIOSTACK_EARLY_HEADER], 0);
+  linkSymbol(&stackA, &stackB);
+  TESTEXPR(earlyEvents[RIOSTACK_EARLY_HEADER], 1);
+  TESTEXPR(earlyHeaderSize, 2);
+  TESTEXPR(earlyWords[0], rioPacket.payload[0]);
+  TESTEXPR(earlyWords[1], rioPacket.payload[1]);
+  linkSymbol(&stackA, &stackB);
+  TESTEXPR(earlyEvents[RIOSTACK_EARLY_WORD], 1);
+  TESTEXPR(earlyWords[2], rioPacket.payload[2]);
+
+  runLink(rioPacket.size + 10);
+  TESTEXPR(earlyEvents[RIOSTACK_EARLY_HEADER], 1);
+  TESTEXPR(earlyEvents[RIOSTACK_EARLY_WORD], rioPacket.size - 2);
+  TESTEXPR(earlyEvents[RIOSTACK_EARLY_END], 1);
+  TESTEXPR(earlyEvents[RIOSTACK_EARLY_ABORT], 0);
+  TESTEXPR(earlyWordCount, rioPacket.size);
+  for(i = 0; i < rioPacket.size; i++)
+  {
+    TESTEXPR(earlyWords[i], rioPacket.payload[i]);
+  }
+  TESTEXPR(RIOSTACK_getInboundQueueLength(&stackB), 1);
+  RIOSTACK_getInboundPacket(&stackB, &rioPacket);
+  TESTCOND(RIOPACKET_valid(&rioPacket));
+
+  /* The ackId is removed from the header also when it is not zero. */
+  earlyReset(0, NULL);
+  RIOPACKET_setDoorbell(&rioPacket, 0x0001, 0x0002, 0x03, 0x0405);
+  RIOSTACK_setOutboundPacket(&stackA, &rioPacket);
+  runLink(10);
+  TESTEXPR(earlyEvents[RIOSTACK_EARLY_END], 1);
+  TESTEXPR(earlyWords[0], rioPacket.payload[0]);
+  TESTEXPR(RIOSTACK_getInboundQueueLength(&stackB), 1);
+  RIOSTACK_getInboundPacket(&stackB, &rioPacket);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 2:");
+  PrintS("Action: Let the early handler consume the packets.");
+  PrintS("Result: The packets should be accepted but not delivered.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riostack-TC13-Step2");
+  /******************************************************************************/
+
+  earlyReset(1, NULL);
+  RIOPACKET_setDoorbell(&rioPacket, 0x0001, 0x0002, 0x03, 0x0405);
+  RIOSTACK_setOutboundPacket(&stackA, &rioPacket);
+  RIOSTACK_setOutboundPacket(&stackA, &rioPacket);
+  runLink(20);
+  TESTEXPR(earlyEvents[RIOSTACK_EARLY_END], 2);
+  TESTEXPR(RIOSTACK_getInboundQueueLength(&stackB), 0);
+  TESTEXPR(RIOSTACK_getOutboundQueueLength(&stackA), 0);
+
+  /* A packet that is not longer than the header has no words after it. */
+  RIOSTACK_setEarlyHandler(&stackB, 3, earlyHandler, NULL);
+  earlyReset(1, NULL);
+  RIOSTACK_setOutboundPacket(&stackA, &rioPacket);
+  runLink(10);
+  TESTEXPR(earlyEvents[RIOSTACK_EARLY_HEADER], 1);
+  TESTEXPR(earlyHeaderSize, 3);
+  TESTEXPR(earlyEvents[RIOSTACK_EARLY_WORD], 0);
+  TESTEXPR(earlyEvents[RIOSTACK_EARLY_END], 1);
+  TESTEXPR(RIOSTACK_getInboundQueueLength(&stackB), 0);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 3:");
+  PrintS("Action: Receive packets that are stomped and that have crc errors.");
+  PrintS("Result: The early handler should be told to abort the packets and ");
+  PrintS("        they should not be delivered.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riostack-TC13-Step3");
+  /******************************************************************************/
+
+  startStack(QUEUE_LENGTH);
+  RIOSTACK_setEarlyHandler(&stack, 1, earlyHandler, NULL);
+  earlyReset(0, NULL);
+  (void) createDoorbell(packet, 0, 0xdead, 0xbeef, 0xaf, 0x1234);
+
+  /* A stomped packet. */
+  RIOSTACK_portAddSymbol(&stack, createControlSymbol(STYPE0_STATUS, 0, 1, STYPE1_START_OF_PACKET, 0));
+  RIOSTACK_portAddSymbol(&stack, createDataSymbol(packet[0]));
+  RIOSTACK_portAddSymbol(&stack, createDataSymbol(packet[1]));
+  TESTEXPR(earlyEvents[RIOSTACK_EARLY_HEADER], 1);
+  TESTEXPR(earlyEvents[RIOSTACK_EARLY_WORD], 1);
+  RIOSTACK_portAddSymbol(&stack, createControlSymbol(STYPE0_STATUS, 0, 1, STYPE1_STOMP, 0));
+  TESTEXPR(earlyEvents[RIOSTACK_EARLY_ABORT], 1);
+  TESTEXPR(earlyEvents[RIOSTACK_EARLY_END], 0);
+  TESTEXPR(RIOSTACK_getInboundQueueLength(&stack), 0);
+  (void) RIOSTACK_portGetSymbol(&stack);
+
+  /* A packet that is stomped before the header is complete is not reported. */
+  RIOSTACK_setEarlyHandler(&stack, 2, earlyHandler, NULL);
+  earlyReset(0, NULL);
+  RIOSTACK_portAddSymbol(&stack, createControlSymbol(STYPE0_STATUS, 0, 1, STYPE1_START_OF_PACKET, 0));
+  RIOSTACK_portAddSymbol(&stack, createDataSymbol(packet[0]));
+  RIOSTACK_portAddSymbol(&stack, createControlSymbol(STYPE0_STATUS, 0, 1, STYPE1_STOMP, 0));
+  TESTEXPR(earlyEvents[RIOSTACK_EARLY_HEADER], 0);
+  TESTEXPR(earlyEvents[RIOSTACK_EARLY_ABORT], 0);
+  (void) RIOSTACK_portGetSymbol(&stack);
+
+  /* A packet with a crc error. */
+  startStack(QUEUE_LENGTH);
+  RIOSTACK_setEarlyHandler(&stack, 1, earlyHandler, NULL);
+  earlyReset(0, NULL);
+  RIOSTACK_portAddSymbol(&stack, createControlSymbol(STYPE0_STATUS, 0, 1, STYPE1_START_OF_PACKET, 0));
+  RIOSTACK_portAddSymbol(&stack, createDataSymbol(packet[0]));
+  RIOSTACK_portAddSymbol(&stack, createDataSymbol(packet[1]));
+  RIOSTACK_portAddSymbol(&stack, createDataSymbol(packet[2] ^ 1));
+  RIOSTACK_portAddSymbol(&stack, createControlSymbol(STYPE0_STATUS, 0, 1, STYPE1_END_OF_PACKET, 0));
+  TESTEXPR(stack.rxState, RX_STATE_INPUT_ERROR_STOPPED);
+  TESTEXPR(earlyEvents[RIOSTACK_EARLY_WORD], 2);
+  TESTEXPR(earlyEvents[RIOSTACK_EARLY_ABORT], 1);
+  TESTEXPR(earlyEvents[RIOSTACK_EARLY_END], 0);
+  TESTEXPR(RIOSTACK_getInboundQueueLength(&stack), 0);
+
+  /* A link error in the middle of a packet. */
+  startStack(QUEUE_LENGTH);
+  RIOSTACK_setEarlyHandler(&stack, 1, earlyHandler, NULL);
+  earlyReset(0, NULL);
+  RIOSTACK_portAddSymbol(&stack, createControlSymbol(STYPE0_STATUS, 0, 1, STYPE1_START_OF_PACKET, 0));
+  RIOSTACK_portAddSymbol(&stack, createDataSymbol(packet[0]));
+  causeInputErrorStopped();
+  TESTEXPR(earlyEvents[RIOSTACK_EARLY_ABORT], 1);
+
+  /* The port goes down in the middle of a packet. */
+  startStack(QUEUE_LENGTH);
+  RIOSTACK_setEarlyHandler(&stack, 1, earlyHandler, NULL);
+  earlyReset(0, NULL);
+  RIOSTACK_portAddSymbol(&stack, createControlSymbol(STYPE0_STATUS, 0, 1, STYPE1_START_OF_PACKET, 0));
+  RIOSTACK_portAddSymbol(&stack, createDataSymbol(packet[0]));
+  RIOSTACK_portSetStatus(&stack, 0);
+  TESTEXPR(earlyEvents[RIOSTACK_EARLY_ABORT], 1);
+  TESTEXPR(earlyEvents[RIOSTACK_EARLY_END], 0);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 4:");
+  PrintS("Action: Forward packets from the early handler to another stack ");
+  PrintS("        using cut-through. Forward a packet with a crc error.");
+  PrintS("Result: The forwarded packet should be started before it has been ");
+  PrintS("        received completely. The packet with crc error should be ");
+  PrintS("        stomped.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riostack-TC13-Step4");
+  /******************************************************************************/
+
+  startLink(0, 0, 0xffffffff);
+  startStack(QUEUE_LENGTH);
+  RIOSTACK_setEarlyHandler(&stackB, 1, earlyHandler, NULL);
+  earlyReset(1, &stack);
+  RIOPACKET_setNwrite(&rioPacket, 0x0001, 0x0002, 0x1000, 256, data);
+  RIOSTACK_setOutboundPacket(&stackA, &rioPacket);
+
+  /* Wait for the header on stackB, it is forwarded at once. */
+  for(i = 0; earlyEvents[RIOSTACK_EARLY_HEADER] == 0; i++)
+  {
+    runLink(1);
+  }
+  TESTCOND(i < 5);
+  TESTEXPR(RIOSTACK_getOutboundQueueLength(&stack), 1);
+  s = RIOSTACK_portGetSymbol(&stack);
+  TESTEXPR(STYPE1_GET(s.data), STYPE1_START_OF_PACKET);
+  TESTSYMBOL(RIOSTACK_portGetSymbol(&stack), createDataSymbol(rioPacket.payload[0]));
+
+  /* Forward the rest of the packet at the rate it is received. */
+  for(i = 1; i < rioPacket.size; i++)
+  {
+    while(earlyWordCount <= i)
+    {
+      runLink(1);
+    }
+    TESTSYMBOL(RIOSTACK_portGetSymbol(&stack), createDataSymbol(rioPacket.payload[i]));
+  }
+  runLink(5);
+  TESTEXPR(earlyEvents[RIOSTACK_EARLY_END], 1);
+  TESTEXPR(stack.txCutThrough, 0);
+  s = RIOSTACK_portGetSymbol(&stack);
+  TESTEXPR(STYPE1_GET(s.data), STYPE1_END_OF_PACKET);
+  TESTEXPR(RIOSTACK_getInboundQueueLength(&stackB), 0);
+
+  /* A packet with a crc error is stomped on the outbound link. */
+  earlyReset(1, &stack);
+  (void) createDoorbell(packet, stackB.rxAckId, 0xdead, 0xbeef, 0xaf, 0x1234);
+  RIOSTACK_portAddSymbol(&stackB, createControlSymbol(STYPE0_STATUS, 0, 1, STYPE1_START_OF_PACKET, 0));
+  RIOSTACK_portAddSymbol(&stackB, createDataSymbol(packet[0]));
+  RIOSTACK_portAddSymbol(&stackB, createDataSymbol(packet[1]));
+  RIOSTACK_portAddSymbol(&stackB, createDataSymbol(packet[2] ^ 1));
+  s = RIOSTACK_portGetSymbol(&stack);
+  TESTEXPR(STYPE1_GET(s.data), STYPE1_START_OF_PACKET);
+  TESTSYMBOL(RIOSTACK_portGetSymbol(&stack), createDataSymbol((packet[0] & 0x03fffffful) | (1ul << 27)));
+  TESTSYMBOL(RIOSTACK_portGetSymbol(&stack), createDataSymbol(packet[1]));
+  TESTSYMBOL(RIOSTACK_portGetSymbol(&stack), createDataSymbol(packet[2] ^ 1));
+  RIOSTACK_portAddSymbol(&stackB, createControlSymbol(STYPE0_STATUS, 0, 1, STYPE1_END_OF_PACKET, 0));
+  TESTEXPR(earlyEvents[RIOSTACK_EARLY_ABORT], 1);
+  s = RIOSTACK_portGetSymbol(&stack);
+  TESTEXPR(s.type, RIOSTACK_SYMBOL_TYPE_CONTROL);
+  TESTEXPR(STYPE1_GET(s.data), STYPE1_STOMP);
+  TESTEXPR(RIOSTACK_getOutboundQueueLength(&stack), 1);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 5:");
+  PrintS("Action: Set an early handler with an invalid header size.");
+  PrintS("Result: Asserts should be raised.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riostack-TC13-Step5");
+  /******************************************************************************/
+
+  TEST_numExpectedAssertsRemaining = 1;
+  RIOSTACK_setEarlyHandler(&stack, 0, earlyHandler, NULL);
+  TESTEXPR(TEST_numExpectedAssertsRemaining, 0);
+
+  TEST_numExpectedAssertsRemaining = 1;
+  RIOSTACK_setEarlyHandler(&stack, 4, earlyHandler, NULL);
+  TESTEXPR(TEST_numExpectedAssertsRemaining, 0);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("TG_riostack-TC14");
+  PrintS("Description: Test virtual channels.");
+  PrintS("Requirement: XXXXX");
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 1:");
+  PrintS("Action: Send packets on VC0 and VC1 over a link where both stacks use ");
+  PrintS("        virtual channels.");
+  PrintS("Result: The VC1 buffer status should be exchanged when the link is ");
+  PrintS("        initialized and the packets should be delivered to the inbound ");
+  PrintS("        queues of their virtual channels.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riostack-TC14-Step1");
+  /******************************************************************************/
+
+  startVcLink(LINK_QUEUE_LENGTH);
+  TESTEXPR(stackA.txVcBufferStatus, 31);
+  TESTEXPR(stackB.txVcBufferStatus, 31);
+
+  sendVc(0, 0x0100);
+  sendVc(1, 0x0101);
+  TESTEXPR(RIOSTACK_getOutboundQueueLength(&stackA), 2);
+  TESTEXPR(RIOSTACK_getOutboundQueueAvailableVc(&stackA, 0), LINK_QUEUE_LENGTH-1);
+  TESTEXPR(RIOSTACK_getOutboundQueueAvailableVc(&stackA, 1), LINK_QUEUE_LENGTH-1);
+  runLink(30);
+  TESTEXPR(RIOSTACK_getOutboundQueueLength(&stackA), 0);
+  TESTEXPR(RIOSTACK_getInboundQueueLength(&stackB), 1);
+  TESTEXPR(RIOSTACK_getInboundQueueLengthVc(&stackB, 1), 1);
+  TESTEXPR(receiveVc(1), 0x0101);
+  TESTEXPR(receiveVc(0), 0x0100);
+  runLink(10);
+  TESTEXPR(stackA.txVcBufferStatus, 31);
+
+  /* Without virtual channels, there is no room for VC1 packets. */
+  startLink(0, 0, 0xffffffff);
+  TESTEXPR(RIOSTACK_getOutboundQueueAvailableVc(&stackA, 1), 0);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 2:");
+  PrintS("Action: Send more VC0 packets than the link-partner has room for and ");
+  PrintS("        then some VC1 packets. Empty the VC0 inbound queue.");
+  PrintS("Result: The VC1 packets should be delivered while VC0 is full, without ");
+  PrintS("        any packet-retries. The rest of the VC0 packets should be ");
+  PrintS("        delivered in order when there is room again.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riostack-TC14-Step2");
+  /******************************************************************************/
+
+  startVcLink(4);
+  for(i = 0; i < 6; i++)
+  {
+    sendVc(0, (uint16_t) (0x0200+i));
+  }
+  runLink(200);
+  TESTEXPR(RIOSTACK_getInboundQueueLength(&stackB), 4);
+  TESTEXPR(RIOSTACK_getOutboundQueueLength(&stackA), 2);
+
+  sendVc(1, 0x0210);
+  sendVc(1, 0x0211);
+  runLink(100);
+  TESTEXPR(RIOSTACK_getInboundQueueLengthVc(&stackB, 1), 2);
+  TESTEXPR(RIOSTACK_getOutboundQueueLength(&stackA), 2);
+  TESTEXPR(receiveVc(1), 0x0210);
+  TESTEXPR(receiveVc(1), 0x0211);
+
+  for(i = 0; i < 4; i++)
+  {
+    TESTEXPR(receiveVc(0), 0x0200+i);
+  }
+
+  /* The new buffer status is sent in the next periodic status-control-symbol. */
+  runLink(600);
+  TESTEXPR(RIOSTACK_getOutboundQueueLength(&stackA), 0);
+  TESTEXPR(RIOSTACK_getInboundQueueLength(&stackB), 2);
+  TESTEXPR(receiveVc(0), 0x0204);
+  TESTEXPR(receiveVc(0), 0x0205);
+  TESTEXPR(stackB.statusInboundPacketRetry, 0);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 3:");
+  PrintS("Action: Give VC1 the weight three and send eight packets on each ");
+  PrintS("        virtual channel.");
+  PrintS("Result: Three VC1 packets should be sent for each VC0 packet until ");
+  PrintS("        VC1 has nothing more to send.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riostack-TC14-Step3");
+  /******************************************************************************/
+
+  startVcLink(LINK_QUEUE_LENGTH);
+  RIOSTACK_setVirtualChannelWeight(&stackA, 1, 3);
+  for(i = 0; i < 8; i++)
+  {
+    sendVc(0, (uint16_t) (0x0300+i));
+    sendVc(1, (uint16_t) (0x0310+i));
+  }
+
+  /* Record the virtual channel of each packet in the order they arrive. */
+  j = 0;
+  window = 0;
+  for(i = 0; (i < 200) && (j < 16); i++)
+  {
+    runLink(1);
+    if(RIOSTACK_getInboundQueueLengthVc(&stackB, 1) > 0)
+    {
+      TESTEXPR(receiveVc(1), 0x0310+window);
+      window++;
+      data[j++] = 1;
+    }
+    else if(RIOSTACK_getInboundQueueLength(&stackB) > 0)
+    {
+      TESTEXPR(receiveVc(0), 0x0300+(j-window));
+      data[j++] = 0;
+    }
+  }
+  TESTEXPR(j, 16);
+  for(i = 0; i < 16; i++)
+  {
+    TESTEXPR(data[i], ((i == 0) || (i == 4) || (i == 8) || (i >= 11)) ? 0 : 1);
+  }
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 4:");
+  PrintS("Action: Use invalid virtual channels and weights and set virtual ");
+  PrintS("        channels on an active port.");
+  PrintS("Result: Asserts should be raised.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riostack-TC14-Step4");
+  /******************************************************************************/
+
+  TEST_numExpectedAssertsRemaining = 1;
+  RIOSTACK_setVirtualChannelWeight(&stackA, 2, 1);
+  TESTEXPR(TEST_numExpectedAssertsRemaining, 0);
+
+  TEST_numExpectedAssertsRemaining = 1;
+  RIOSTACK_setVirtualChannelWeight(&stackA, 1, 0);
+  TESTEXPR(TEST_numExpectedAssertsRemaining, 0);
+
+  TEST_numExpectedAssertsRemaining = 1;
+  TESTEXPR(RIOSTACK_getOutboundQueueAvailableVc(&stackA, 2), 0);
+  TESTEXPR(TEST_numExpectedAssertsRemaining, 0);
+
+  TEST_numExpectedAssertsRemaining = 1;
+  RIOSTACK_setVirtualChannels(&stackA, 
+      RIOSTACK_BUFFER_SIZE*LINK_QUEUE_LENGTH, txVc0BufferA,
+      RIOSTACK_BUFFER_SIZE*LINK_QUEUE_LENGTH, txVc1BufferA,
+      RIOSTACK_BUFFER_SIZE*LINK_QUEUE_LENGTH, rxVc1BufferA);
+  TESTEXPR(TEST_numExpectedAssertsRemaining, 0);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("TG_riostack-TC15");
+  PrintS("Description: Test multicast-event-control-symbols.");
+  PrintS("Requirement: XXXXX");
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 1:");
+  PrintS("Action: Send a multicast-event on an idle link.");
+  PrintS("Result: The multicast-event should be the next symbol and the handler ");
+  PrintS("        of the link-partner should be called with its port time.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riostack-TC15-Step1");
+  /******************************************************************************/
+
+  startLink(0, 0, 0xffffffff);
+  runLink(10);
+  multicastEvents = 0;
+  RIOSTACK_setMulticastEventHandler(&stackB, multicastEventHandler, NULL);
+  RIOSTACK_sendMulticastEvent(&stackA);
+  RIOSTACK_sendMulticastEvent(&stackA);
+  s = RIOSTACK_portGetSymbol(&stackA);
+  TESTEXPR(s.type, RIOSTACK_SYMBOL_TYPE_CONTROL);
+  TESTEXPR(STYPE0_GET(s.data), STYPE0_STATUS);
+  TESTEXPR(STYPE1_GET(s.data), STYPE1_MULTICAST_EVENT);
+  RIOSTACK_portSetTime(&stackB, 1234);
+  RIOSTACK_portAddSymbol(&stackB, s);
+  TESTEXPR(multicastEvents, 1);
+  TESTEXPR(multicastTime, 1234);
+
+  /* Only one multicast-event is sent. */
+  for(i = 0; i < 300; i++)
+  {
+    s = RIOSTACK_portGetSymbol(&stackA);
+    TESTCOND((s.type != RIOSTACK_SYMBOL_TYPE_CONTROL) || (STYPE1_GET(s.data) != STYPE1_MULTICAST_EVENT));
+  }
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 2:");
+  PrintS("Action: Send a multicast-event while a packet is being sent.");
+  PrintS("Result: The multicast-event should be sent between two data-symbols ");
+  PrintS("        of the packet and the packet should be received correctly.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riostack-TC15-Step2");
+  /******************************************************************************/
+
+  startLink(0, 0, 0xffffffff);
+  runLink(10);
+  multicastEvents = 0;
+  RIOSTACK_setMulticastEventHandler(&stackB, multicastEventHandler, NULL);
+  RIOPACKET_setNwrite(&rioPacket, 0x0001, 0x0002, 0x1000, 64, data);
+  RIOSTACK_setOutboundPacket(&stackA, &rioPacket);
+
+  /* Start-of-packet and two words. */
+  linkSymbol(&stackA, &stackB);
+  linkSymbol(&stackA, &stackB);
+  linkSymbol(&stackA, &stackB);
+
+  RIOSTACK_sendMulticastEvent(&stackA);
+  s = RIOSTACK_portGetSymbol(&stackA);
+  TESTEXPR(s.type, RIOSTACK_SYMBOL_TYPE_CONTROL);
+  TESTEXPR(STYPE1_GET(s.data), STYPE1_MULTICAST_EVENT);
+  RIOSTACK_portSetTime(&stackB, 5678);
+  RIOSTACK_portAddSymbol(&stackB, s);
+  TESTEXPR(multicastEvents, 1);
+  TESTEXPR(multicastTime, 5678);
+  s = RIOSTACK_portGetSymbol(&stackA);
+  TESTSYMBOL(s, createDataSymbol(rioPacket.payload[2]));
+  RIOSTACK_portAddSymbol(&stackB, s);
+
+  runLink(rioPacket.size + 10);
+  TESTEXPR(multicastEvents, 1);
+  TESTEXPR(RIOSTACK_getOutboundQueueLength(&stackA), 0);
+  TESTEXPR(RIOSTACK_getInboundQueueLength(&stackB), 1);
+  RIOSTACK_getInboundPacket(&stackB, &rioPacket);
+  TESTCOND(RIOPACKET_valid(&rioPacket));
+
+  /* Without a handler, the multicast-event is discarded. */
+  RIOSTACK_setMulticastEventHandler(&stackB, NULL, NULL);
+  RIOSTACK_sendMulticastEvent(&stackA);
+  runLink(10);
+  TESTEXPR(multicastEvents, 1);
+  TESTEXPR(sendWindow(4, 0xe000), 4);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("TG_riostack-TC16");
+  PrintS("Description: Test packets of the smallest size.");
+  PrintS("Requirement: XXXXX");
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 1:");
+  PrintS("Action: Send two-word responses with 8-bit deviceIds over a link, ");
+  PrintS("        one ended by end-of-packet and one by a new start-of-packet.");
+  PrintS("Result: The responses should be accepted and received unchanged.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riostack-TC16-Step1");
+  /******************************************************************************/
+
+  startLink(0, 0, 0xffffffff);
+  RIOPACKET_setResponseNoPayloadExt(&rioPacket, RIOPACKET_TT_8BITS, 0x12, 0x34, 0x56, 
+                                    RIOPACKET_RESPONSE_STATUS_DONE);
+  TESTEXPR(rioPacket.size, RIOPACKET_SIZE_MIN);
+  RIOSTACK_setOutboundPacket(&stackA, &rioPacket);
+  RIOSTACK_setOutboundPacket(&stackA, &rioPacket);
+  runLink(20);
+  TESTEXPR(RIOSTACK_getOutboundQueueLength(&stackA), 0);
+  TESTEXPR(RIOSTACK_getInboundQueueLength(&stackB), 2);
+  TESTEXPR(stackB.statusInboundErrorGeneral, 0);
+  TESTEXPR(stackB.statusInboundPacketComplete, 2);
+
+  for(i = 0; i < 2; i++)
+  {
+    RIOSTACK_getInboundPacket(&stackB, &rioPacket);
+    TESTEXPR(rioPacket.size, RIOPACKET_SIZE_MIN);
+    TESTCOND(RIOPACKET_valid(&rioPacket));
+    TESTEXPR(RIOPACKET_getTt(&rioPacket), RIOPACKET_TT_8BITS);
+    RIOPACKET_getResponseNoPayloadExt(&rioPacket, &dstIdExt, &srcIdExt, &tid, &status);
+    TESTEXPR(dstIdExt, 0x12);
+    TESTEXPR(srcIdExt, 0x34);
+    TESTEXPR(tid, 0x56);
+    TESTEXPR(status, RIOPACKET_RESPONSE_STATUS_DONE);
+  }
+
   /******************************************************************************/
   TESTEND;
   /******************************************************************************/
@@ -0,0 +1,435 @@
+/******************************************************************************
+ * (C) Copyright 2013-2015 Magnus Rosenius and the Free Software Foundation.
+ *
+ * This file is part of OpenRIO.
+ *
+ * OpenRIO is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenRIO is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Lesser Public License
+ * along with OpenRIO.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+
+/******************************************************************************
+ * Description:
+ * Unit tests for riostream.c.
+ ******************************************************************************/
+
+
+#define MODULE_TEST
+#include "riostream.c"
+#include "riostack.c"
+#include "riopacket.c"
+#include "riopool.c"
+#include <CUnit/CUnit.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PrintS(s) printf(s "\n")
+
+#define TESTSTART(s) printf(s "...")
+#define TESTEND printf(" done.\n");
+
+#define TESTCOND(got) CU_ASSERT(got)
+#define TESTEXPR(got, expected) CU_ASSERT_EQUAL((got), (expected))
+
+#define QUEUE_LENGTH 8
+#define PDUS 2
+#define BUFFERS 3
+
+int TEST_numExpectedAssertsRemaining = 0;
+
+static RioStreamTx_t txA;
+static RioStreamTx_t txB;
+static RioStreamRx_t rx;
+static RioStreamPdu_t pdus[PDUS];
+
+static uint8_t pduA[RIOSTREAM_PDU_SIZE_MAX];
+static uint8_t pduB[RIOSTREAM_PDU_SIZE_MAX];
+static uint8_t buffers[BUFFERS][RIOSTREAM_PDU_SIZE_MAX];
+
+#include "test_riolink.h"
+
+/* Information about the allocate and complete calls. */
+static uint32_t bufferSize;
+static int allocateCalls;
+static int completeCalls;
+static void *completeContext;
+static RioStreamPdu_t completed[BUFFERS];
+
+static uint8_t *testAllocate(void *context, const RioStreamPdu_t *pdu, uint32_t *size)
+{
+  uint8_t *buffer;
+
+  if(allocateCalls < BUFFERS)
+  {
+    buffer = buffers[allocateCalls];
+    *size = bufferSize;
+    allocateCalls++;
+  }
+  else
+  {
+    buffer = NULL;
+  }
+
+  return buffer;
+}
+
+static void testComplete(void *context, const RioStreamPdu_t *pdu)
+{
+  completeContext = context;
+  if(completeCalls < BUFFERS)
+  {
+    completed[completeCalls] = *pdu;
+  }
+  completeCalls++;
+}
+
+static void rxOpen(uint32_t size)
+{
+  bufferSize = size;
+  allocateCalls = 0;
+  completeCalls = 0;
+  completeContext = NULL;
+  memset(buffers, 0, sizeof(buffers));
+  RIOSTREAM_rxOpen(&rx, PDUS, pdus, testAllocate, testComplete, &rx);
+}
+
+static void fillPdu(uint8_t *pdu, uint8_t seed)
+{
+  uint32_t i;
+
+  for(i = 0; i < RIOSTREAM_PDU_SIZE_MAX; i++)
+  {
+    pdu[i] = (uint8_t) (seed + i + (i >> 8));
+  }
+}
+
+/*******************************************************************************
+ * Module test for this file.
+ *******************************************************************************/
+
+static void allTests(void)
+{
+  RioPacket_t packet;
+  RioPacket_t packetA;
+  RioPacket_t packetB;
+  uint32_t lengths[] = {1, 2, 3, 31, 32, 33, 64, 255, 256, 257, 1000, 65535, 65536};
+  uint16_t mtus[] = {32, 64, 252, 256};
+  uint32_t segments;
+  uint32_t expected;
+  uint8_t moreA;
+  uint8_t moreB;
+  int i;
+  int j;
+
+  fillPdu(pduA, 0x11);
+  fillPdu(pduB, 0x77);
+
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("TG_riostream");
+  PrintS("----------------------------------------------------------------------");
+  PrintS("TG_riostream-TC1");
+  PrintS("Description: Test segmentation and reassembly of PDUs.");
+  PrintS("Requirement: XXXXX");
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 1:");
+  PrintS("Action: Segment PDUs of different lengths using different MTUs and ");
+  PrintS("reassemble them.");
+  PrintS("Result: The PDUs should be split into the expected number of ");
+  PrintS("segments and be reassembled unchanged.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riostream-TC1-Step1");
+  /******************************************************************************/
+
+  for(i = 0; i < (sizeof(mtus)/sizeof(mtus[0])); i++)
+  {
+    for(j = 0; j < (sizeof(lengths)/sizeof(lengths[0])); j++)
+    {
+      rxOpen(RIOSTREAM_PDU_SIZE_MAX);
+      RIOSTREAM_txOpen(&txA, 0x0002, 0x0001, 0x12, 0x3456, mtus[i], lengths[j], pduA);
+
+      segments = 0;
+      while(RIOSTREAM_txGetSegment(&txA, &packet))
+      {
+        TESTEXPR(RIOPACKET_valid(&packet), 1);
+        TESTEXPR(RIOSTREAM_rxReceive(&rx, &packet), 1);
+        segments++;
+      }
+      TESTEXPR(RIOSTREAM_txIsDone(&txA), 1);
+      TESTEXPR(RIOSTREAM_txGetSegment(&txA, &packet), 0);
+
+      expected = (lengths[j] + mtus[i] - 1) / mtus[i];
+      TESTEXPR(segments, expected);
+      TESTEXPR(allocateCalls, 1);
+      TESTEXPR(completeCalls, 1);
+      TESTEXPR(completeContext, &rx);
+      TESTEXPR(completed[0].status, RIOSTREAM_STATUS_OK);
+      TESTEXPR(completed[0].dstId, 0x0002);
+      TESTEXPR(completed[0].srcId, 0x0001);
+      TESTEXPR(completed[0].cos, 0x12);
+      TESTEXPR(completed[0].streamId, 0x3456);
+      TESTEXPR(completed[0].buffer, buffers[0]);
+      TESTEXPR(completed[0].length, lengths[j]);
+      TESTEXPR(memcmp(buffers[0], pduA, lengths[j]), 0);
+      TESTEXPR(rx.statusPduComplete, 1);
+      TESTEXPR(rx.statusPduError, 0);
+    }
+  }
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 2:");
+  PrintS("Action: Interleave the segments of PDUs from two sources and from two ");
+  PrintS("classes of service from the same source.");
+  PrintS("Result: The PDUs should be reassembled into separate buffers.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riostream-TC1-Step2");
+  /******************************************************************************/
+
+  rxOpen(RIOSTREAM_PDU_SIZE_MAX);
+  RIOSTREAM_txOpen(&txA, 0x0002, 0x0001, 0x00, 0x0001, 64, 1000, pduA);
+  RIOSTREAM_txOpen(&txB, 0x0002, 0x0003, 0x00, 0x0002, 128, 700, pduB);
+  do
+  {
+    moreA = RIOSTREAM_txGetSegment(&txA, &packetA);
+    moreB = RIOSTREAM_txGetSegment(&txB, &packetB);
+    if(moreA)
+    {
+      TESTEXPR(RIOSTREAM_rxReceive(&rx, &packetA), 1);
+    }
+    if(moreB)
+    {
+      TESTEXPR(RIOSTREAM_rxReceive(&rx, &packetB), 1);
+    }
+  } while(moreA || moreB);
+
+  TESTEXPR(completeCalls, 2);
+  TESTEXPR(completed[0].srcId, 0x0003);
+  TESTEXPR(completed[0].streamId, 0x0002);
+  TESTEXPR(completed[0].length, 700);
+  TESTEXPR(completed[0].buffer, buffers[1]);
+  TESTEXPR(memcmp(buffers[1], pduB, 700), 0);
+  TESTEXPR(completed[1].srcId, 0x0001);
+  TESTEXPR(completed[1].streamId, 0x0001);
+  TESTEXPR(completed[1].length, 1000);
+  TESTEXPR(completed[1].buffer, buffers[0]);
+  TESTEXPR(memcmp(buffers[0], pduA, 1000), 0);
+
+  rxOpen(RIOSTREAM_PDU_SIZE_MAX);
+  RIOSTREAM_txOpen(&txA, 0x0002, 0x0001, 0x01, 0x0001, 32, 100, pduA);
+  RIOSTREAM_txOpen(&txB, 0x0002, 0x0001, 0x02, 0x0002, 32, 100, pduB);
+  do
+  {
+    moreA = RIOSTREAM_txGetSegment(&txA, &packetA);
+    moreB = RIOSTREAM_txGetSegment(&txB, &packetB);
+    if(moreA)
+    {
+      TESTEXPR(RIOSTREAM_rxReceive(&rx, &packetA), 1);
+    }
+    if(moreB)
+    {
+      TESTEXPR(RIOSTREAM_rxReceive(&rx, &packetB), 1);
+    }
+  } while(moreA || moreB);
+
+  TESTEXPR(completeCalls, 2);
+  TESTEXPR(completed[0].cos, 0x01);
+  TESTEXPR(completed[0].status, RIOSTREAM_STATUS_OK);
+  TESTEXPR(memcmp(buffers[0], pduA, 100), 0);
+  TESTEXPR(completed[1].cos, 0x02);
+  TESTEXPR(completed[1].status, RIOSTREAM_STATUS_OK);
+  TESTEXPR(memcmp(buffers[1], pduB, 100), 0);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 3:");
+  PrintS("Action: Receive PDUs that are erroneous or cannot be stored.");
+  PrintS("Result: The errors should be reported and the segments that cannot be ");
+  PrintS("stored should be discarded.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riostream-TC1-Step3");
+  /******************************************************************************/
+
+  /* A PDU that does not fit in the buffer. */
+  rxOpen(100);
+  RIOSTREAM_txOpen(&txA, 0x0002, 0x0001, 0x00, 0x0001, 64, 200, pduA);
+  while(RIOSTREAM_txGetSegment(&txA, &packet))
+  {
+    TESTEXPR(RIOSTREAM_rxReceive(&rx, &packet), 1);
+  }
+  TESTEXPR(completeCalls, 1);
+  TESTEXPR(completed[0].status, RIOSTREAM_STATUS_OVERFLOW);
+  TESTEXPR(completed[0].length, 64);
+  TESTEXPR(rx.statusPduError, 1);
+  TESTEXPR(rx.statusSegmentDiscarded, 3);
+
+  /* A PDU where a segment is lost. */
+  rxOpen(RIOSTREAM_PDU_SIZE_MAX);
+  RIOSTREAM_txOpen(&txA, 0x0002, 0x0001, 0x00, 0x0001, 64, 200, pduA);
+  for(i = 0; RIOSTREAM_txGetSegment(&txA, &packet); i++)
+  {
+    if(i != 1)
+    {
+      TESTEXPR(RIOSTREAM_rxReceive(&rx, &packet), 1);
+    }
+  }
+  TESTEXPR(completeCalls, 1);
+  TESTEXPR(completed[0].status, RIOSTREAM_STATUS_LENGTH);
+  TESTEXPR(completed[0].length, 136);
+
+  /* A PDU where the end segment is lost. */
+  rxOpen(RIOSTREAM_PDU_SIZE_MAX);
+  RIOSTREAM_txOpen(&txA, 0x0002, 0x0001, 0x00, 0x0001, 64, 200, pduA);
+  for(i = 0; RIOSTREAM_txGetSegment(&txA, &packet); i++)
+  {
+    if(i != 3)
+    {
+      TESTEXPR(RIOSTREAM_rxReceive(&rx, &packet), 1);
+    }
+  }
+  TESTEXPR(completeCalls, 0);
+  RIOSTREAM_txOpen(&txA, 0x0002, 0x0001, 0x00, 0x0002, 64, 10, pduA);
+  TESTEXPR(RIOSTREAM_txGetSegment(&txA, &packet), 1);
+  TESTEXPR(RIOSTREAM_rxReceive(&rx, &packet), 1);
+  TESTEXPR(completeCalls, 2);
+  TESTEXPR(completed[0].status, RIOSTREAM_STATUS_ABORTED);
+  TESTEXPR(completed[0].streamId, 0x0001);
+  TESTEXPR(completed[0].length, 192);
+  TESTEXPR(completed[1].status, RIOSTREAM_STATUS_OK);
+  TESTEXPR(completed[1].streamId, 0x0002);
+  TESTEXPR(completed[1].length, 10);
+
+  /* Segments without a start segment, no free reassembly contexts and no buffers. */
+  rxOpen(RIOSTREAM_PDU_SIZE_MAX);
+  RIOSTREAM_txOpen(&txA, 0x0002, 0x0001, 0x00, 0x0001, 64, 200, pduA);
+  (void) RIOSTREAM_txGetSegment(&txA, &packet);
+  TESTEXPR(RIOSTREAM_txGetSegment(&txA, &packet), 1);
+  TESTEXPR(RIOSTREAM_rxReceive(&rx, &packet), 1);
+  TESTEXPR(rx.statusSegmentDiscarded, 1);
+  TESTEXPR(allocateCalls, 0);
+
+  for(i = 0; i < PDUS+1; i++)
+  {
+    RIOSTREAM_txOpen(&txA, 0x0002, 0x0010+i, 0x00, 0x0001, 64, 200, pduA);
+    (void) RIOSTREAM_txGetSegment(&txA, &packet);
+    TESTEXPR(RIOSTREAM_rxReceive(&rx, &packet), 1);
+  }
+  TESTEXPR(allocateCalls, PDUS);
+  TESTEXPR(rx.statusSegmentDiscarded, 2);
+
+  rxOpen(RIOSTREAM_PDU_SIZE_MAX);
+  allocateCalls = BUFFERS;
+  RIOSTREAM_txOpen(&txA, 0x0002, 0x0001, 0x00, 0x0001, 64, 10, pduA);
+  (void) RIOSTREAM_txGetSegment(&txA, &packet);
+  TESTEXPR(RIOSTREAM_rxReceive(&rx, &packet), 1);
+  TESTEXPR(completeCalls, 0);
+  TESTEXPR(rx.statusSegmentDiscarded, 1);
+
+  /* Packets that are not data streaming segments. */
+  RIOPACKET_setDoorbell(&packet, 0x0002, 0x0001, 0x00, 0x1234);
+  TESTEXPR(RIOSTREAM_rxReceive(&rx, &packet), 0);
+
+  /* Invalid arguments. */
+  TEST_numExpectedAssertsRemaining = 1;
+  RIOSTREAM_txOpen(&txA, 0x0002, 0x0001, 0x00, 0x0001, 30, 10, pduA);
+  TESTEXPR(TEST_numExpectedAssertsRemaining, 0);
+  TEST_numExpectedAssertsRemaining = 1;
+  RIOSTREAM_txOpen(&txA, 0x0002, 0x0001, 0x00, 0x0001, 64, RIOSTREAM_PDU_SIZE_MAX+1, pduA);
+  TESTEXPR(TEST_numExpectedAssertsRemaining, 0);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("TG_riostream-TC2");
+  PrintS("Description: Test data streaming between two stacks.");
+  PrintS("Requirement: XXXXX");
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 1:");
+  PrintS("Action: Send a PDU that is larger than the outbound queue to a stack ");
+  PrintS("with an attached receiver.");
+  PrintS("Result: The PDU should be received and no segments should be placed ");
+  PrintS("in the inbound queue.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riostream-TC2-Step1");
+  /******************************************************************************/
+
+  startLink();
+  rxOpen(RIOSTREAM_PDU_SIZE_MAX);
+  RIOSTREAM_rxAttach(&rx, &stackB);
+
+  RIOSTREAM_txOpen(&txA, 0x0002, 0x0001, 0x05, 0xabcd, 256, 5000, pduA);
+  segments = 0;
+  for(i = 0; (i < 100) && !RIOSTREAM_txIsDone(&txA); i++)
+  {
+    segments += RIOSTREAM_txSend(&txA, &stackA);
+    runLink(1000);
+  }
+  runLink(1000);
+  TESTEXPR(RIOSTREAM_txIsDone(&txA), 1);
+  TESTEXPR(segments, 20);
+
+  RIOPACKET_setDoorbell(&packet, 0x0002, 0x0001, 0x00, 0x1234);
+  RIOSTACK_setOutboundPacket(&stackA, &packet);
+  runLink(200);
+
+  TESTEXPR(RIOSTACK_getInboundQueueLength(&stackB), 1);
+  TESTEXPR(completeCalls, 1);
+  TESTEXPR(completed[0].status, RIOSTREAM_STATUS_OK);
+  TESTEXPR(completed[0].streamId, 0xabcd);
+  TESTEXPR(completed[0].cos, 0x05);
+  TESTEXPR(completed[0].length, 5000);
+  TESTEXPR(memcmp(buffers[0], pduA, 5000), 0);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+}
+
+CU_ErrorCode addTests( void )
+{
+  if( CUE_SUCCESS != CU_initialize_registry() )
+  {
+    return CU_get_error();
+  }
+
+  CU_pSuite suite = CU_add_suite( "RIOSTREAMTEST", NULL, NULL );
+  if( NULL == suite )
+  {
+    CU_cleanup_registry();
+    return CU_get_error();
+  }
+
+  CU_add_test( suite, "allTests", &allTests );
+
+  return CUE_SUCCESS;
+}
+
+
+int main(int argc, char argv[])
+{
+  addTests();
+  CU_basic_run_tests();
+  return CU_get_error();
+}
+
+/*************************** end of file **************************************/
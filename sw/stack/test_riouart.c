@@ -0,0 +1,348 @@
+/******************************************************************************
+ * (C) Copyright 2013-2015 Magnus Rosenius and the Free Software Foundation.
+ *
+ * This file is part of OpenRIO.
+ *
+ * OpenRIO is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenRIO is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Lesser Public License
+ * along with OpenRIO.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+
+/******************************************************************************
+ * Description:
+ * Unit tests for riouart.c.
+ ******************************************************************************/
+
+
+#define MODULE_TEST
+#include "riouart.c"
+#include "riostack.c"
+#include "riopacket.c"
+#include "riopool.c"
+#include <CUnit/CUnit.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PrintS(s) printf(s "\n")
+
+#define TESTSTART(s) printf(s "...")
+#define TESTEND printf(" done.\n");
+
+#define TESTCOND(got) CU_ASSERT(got)
+#define TESTEXPR(got, expected) CU_ASSERT_EQUAL((got), (expected))
+
+#define QUEUE_LENGTH 8
+#define SYMBOLS 1000
+
+int TEST_numExpectedAssertsRemaining = 0;
+
+static RioUart_t uartA;
+static RioUart_t uartB;
+
+static RioSymbol_t symbols[SYMBOLS];
+static RioSymbol_t received[RIOUART_SYMBOL_SIZE_MAX*SYMBOLS];
+static uint8_t buffer[RIOUART_SYMBOL_SIZE_MAX*SYMBOLS];
+
+#define TEST_RIOLINK_CODEC
+#include "test_riolink.h"
+
+/* Decode bytes and check that exactly one symbol was decoded. */
+static RioSymbol_t decodeOne(uint32_t count, const uint8_t *bytes)
+{
+  RioSymbol_t s[8];
+
+  TESTEXPR(RIOUART_decodeSymbols(&uartB, count, bytes, s), 1);
+  return s[0];
+}
+
+/* Encode one symbol and check the bytes. */
+static void encodeOne(RioSymbolType_t type, uint32_t data, uint32_t count, const uint8_t *expected)
+{
+  RioSymbol_t s;
+  uint8_t b[RIOUART_SYMBOL_SIZE_MAX];
+
+  s.type = type;
+  s.data = data;
+  TESTEXPR(RIOUART_encodeSymbols(1, &s, b), count);
+  TESTCOND(memcmp(b, expected, count) == 0);
+}
+
+/* Exchange symbols between two stacks through two codecs. */
+static void runLink(int symbols)
+{
+  uint8_t b[RIOUART_SYMBOL_SIZE_MAX];
+  uint32_t n;
+  int i;
+
+  for(i = 0; i < symbols; i++)
+  {
+    n = RIOUART_transmit(&stackA, sizeof(b), b);
+    RIOUART_receive(&uartB, &stackB, n, b);
+    n = RIOUART_transmit(&stackB, sizeof(b), b);
+    RIOUART_receive(&uartA, &stackA, n, b);
+  }
+}
+
+/*******************************************************************************
+ * Module test for this file.
+ *******************************************************************************/
+
+static void allTests(void)
+{
+  RioPacket_t packet;
+  RioSymbol_t s;
+  uint16_t dstid;
+  uint16_t srcid;
+  uint8_t tid;
+  uint16_t info;
+  uint32_t n;
+  uint32_t m;
+  int i;
+
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("TG_riouart");
+  PrintS("----------------------------------------------------------------------");
+  PrintS("TG_riouart-TC1");
+  PrintS("Description: Test the receiver.");
+  PrintS("Requirement: XXXXX");
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 1:");
+  PrintS("Action: Receive flags, control symbols and data symbols.");
+  PrintS("Result: Idle, control and data symbols should be decoded. A flag ");
+  PrintS("        after one or two octets should be an error symbol.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riouart-TC1-Step1");
+  /******************************************************************************/
+
+  RIOUART_open(&uartB);
+
+  s = decodeOne(1, (uint8_t[]) {0x7e});
+  TESTEXPR(s.type, RIOSTACK_SYMBOL_TYPE_IDLE);
+
+  s = decodeOne(2, (uint8_t[]) {0xaa, 0x7e});
+  TESTEXPR(s.type, RIOSTACK_SYMBOL_TYPE_ERROR);
+
+  s = decodeOne(3, (uint8_t[]) {0xaa, 0x55, 0x7e});
+  TESTEXPR(s.type, RIOSTACK_SYMBOL_TYPE_ERROR);
+  TESTEXPR(uartB.statusRxError, 2);
+
+  s = decodeOne(4, (uint8_t[]) {0x11, 0x22, 0x33, 0x7e});
+  TESTEXPR(s.type, RIOSTACK_SYMBOL_TYPE_CONTROL);
+  TESTEXPR(s.data, 0x00112233);
+
+  s = decodeOne(4, (uint8_t[]) {0x44, 0x55, 0x66, 0x77});
+  TESTEXPR(s.type, RIOSTACK_SYMBOL_TYPE_DATA);
+  TESTEXPR(s.data, 0x44556677);
+
+  s = decodeOne(4, (uint8_t[]) {0x88, 0x99, 0xaa, 0xbb});
+  TESTEXPR(s.type, RIOSTACK_SYMBOL_TYPE_DATA);
+  TESTEXPR(s.data, 0x8899aabb);
+
+  s = decodeOne(4, (uint8_t[]) {0xcc, 0xdd, 0xee, 0x7e});
+  TESTEXPR(s.type, RIOSTACK_SYMBOL_TYPE_CONTROL);
+  TESTEXPR(s.data, 0x00ccddee);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 2:");
+  PrintS("Action: Receive control and data symbols with stuffed octets.");
+  PrintS("Result: The stuffed octets should be restored.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riouart-TC1-Step2");
+  /******************************************************************************/
+
+  s = decodeOne(5, (uint8_t[]) {0x7d, 0x5e, 0xff, 0x01, 0x7e});
+  TESTEXPR(s.type, RIOSTACK_SYMBOL_TYPE_CONTROL);
+  TESTEXPR(s.data, 0x007eff01);
+
+  s = decodeOne(6, (uint8_t[]) {0x7d, 0x5e, 0xff, 0x7d, 0x5d, 0x7e});
+  TESTEXPR(s.type, RIOSTACK_SYMBOL_TYPE_CONTROL);
+  TESTEXPR(s.data, 0x007eff7d);
+
+  s = decodeOne(7, (uint8_t[]) {0x7d, 0x5d, 0x7d, 0x5e, 0x7d, 0x5d, 0x7e});
+  TESTEXPR(s.type, RIOSTACK_SYMBOL_TYPE_CONTROL);
+  TESTEXPR(s.data, 0x007d7e7d);
+
+  s = decodeOne(5, (uint8_t[]) {0x7d, 0x5e, 0x00, 0x01, 0x02});
+  TESTEXPR(s.type, RIOSTACK_SYMBOL_TYPE_DATA);
+  TESTEXPR(s.data, 0x7e000102);
+
+  s = decodeOne(7, (uint8_t[]) {0x7d, 0x5e, 0x7d, 0x5d, 0x7d, 0x5e, 0x05});
+  TESTEXPR(s.type, RIOSTACK_SYMBOL_TYPE_DATA);
+  TESTEXPR(s.data, 0x7e7d7e05);
+
+  s = decodeOne(8, (uint8_t[]) {0x7d, 0x5e, 0x7d, 0x5d, 0x7d, 0x5e, 0x7d, 0x5d});
+  TESTEXPR(s.type, RIOSTACK_SYMBOL_TYPE_DATA);
+  TESTEXPR(s.data, 0x7e7d7e7d);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("TG_riouart-TC2");
+  PrintS("Description: Test the transmitter.");
+  PrintS("Requirement: XXXXX");
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 1:");
+  PrintS("Action: Transmit idle, control and data symbols with and without ");
+  PrintS("        octets that needs stuffing.");
+  PrintS("Result: The octets should be sent most significant first, stuffed ");
+  PrintS("        when needed and control symbols should end with a flag.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riouart-TC2-Step1");
+  /******************************************************************************/
+
+  encodeOne(RIOSTACK_SYMBOL_TYPE_IDLE, 0, 1, (uint8_t[]) {0x7e});
+  encodeOne(RIOSTACK_SYMBOL_TYPE_ERROR, 0, 1, (uint8_t[]) {0x7e});
+  encodeOne(RIOSTACK_SYMBOL_TYPE_CONTROL, 0x00112233, 4, (uint8_t[]) {0x11, 0x22, 0x33, 0x7e});
+  encodeOne(RIOSTACK_SYMBOL_TYPE_CONTROL, 0xffccddee, 4, (uint8_t[]) {0xcc, 0xdd, 0xee, 0x7e});
+  encodeOne(RIOSTACK_SYMBOL_TYPE_DATA, 0x44556677, 4, (uint8_t[]) {0x44, 0x55, 0x66, 0x77});
+  encodeOne(RIOSTACK_SYMBOL_TYPE_CONTROL, 0xff7e0102, 5, (uint8_t[]) {0x7d, 0x5e, 0x01, 0x02, 0x7e});
+  encodeOne(RIOSTACK_SYMBOL_TYPE_CONTROL, 0xff7e7d01, 6, (uint8_t[]) {0x7d, 0x5e, 0x7d, 0x5d, 0x01, 0x7e});
+  encodeOne(RIOSTACK_SYMBOL_TYPE_CONTROL, 0xff7e7d7e, 7,
+            (uint8_t[]) {0x7d, 0x5e, 0x7d, 0x5d, 0x7d, 0x5e, 0x7e});
+  encodeOne(RIOSTACK_SYMBOL_TYPE_DATA, 0x7e010203, 5, (uint8_t[]) {0x7d, 0x5e, 0x01, 0x02, 0x03});
+  encodeOne(RIOSTACK_SYMBOL_TYPE_DATA, 0x7e7d7e01, 7,
+            (uint8_t[]) {0x7d, 0x5e, 0x7d, 0x5d, 0x7d, 0x5e, 0x01});
+  encodeOne(RIOSTACK_SYMBOL_TYPE_DATA, 0x7e7d7e7d, 8,
+            (uint8_t[]) {0x7d, 0x5e, 0x7d, 0x5d, 0x7d, 0x5e, 0x7d, 0x5d});
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 2:");
+  PrintS("Action: Encode a buffer of random symbols and decode it in pieces of ");
+  PrintS("        different sizes.");
+  PrintS("Result: The decoded symbols should be the same as the encoded.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riouart-TC2-Step2");
+  /******************************************************************************/
+
+  for(i = 0; i < SYMBOLS; i++)
+  {
+    symbols[i].type = (RioSymbolType_t) (rand() % 3);
+    symbols[i].data = (uint32_t) rand();
+    if((rand() & 1) != 0)
+    {
+      symbols[i].data = (symbols[i].data & 0xff00ff00ul) | 0x007e007dul;
+    }
+    if(symbols[i].type == RIOSTACK_SYMBOL_TYPE_CONTROL)
+    {
+      symbols[i].data &= 0x00fffffful;
+    }
+    else if(symbols[i].type == RIOSTACK_SYMBOL_TYPE_IDLE)
+    {
+      symbols[i].data = 0;
+    }
+  }
+  n = RIOUART_encodeSymbols(SYMBOLS, symbols, buffer);
+  TESTCOND(n <= RIOUART_SYMBOL_SIZE_MAX*SYMBOLS);
+
+  RIOUART_open(&uartB);
+  m = 0;
+  for(i = 0; i < (int) n; i += (i % 13) + 1)
+  {
+    m += RIOUART_decodeSymbols(&uartB, ((i % 13) + 1 < (int) n - i) ? (i % 13) + 1 : n - i,
+                               &buffer[i], &received[m]);
+  }
+  TESTEXPR(m, SYMBOLS);
+  for(i = 0; i < SYMBOLS; i++)
+  {
+    TESTEXPR(received[i].type, symbols[i].type);
+    TESTEXPR(received[i].data, symbols[i].data);
+  }
+  TESTEXPR(uartB.statusRxError, 0);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+  PrintS("----------------------------------------------------------------------");
+  PrintS("TG_riouart-TC3");
+  PrintS("Description: Test two stacks connected through codecs.");
+  PrintS("Requirement: XXXXX");
+  PrintS("----------------------------------------------------------------------");
+  PrintS("Step 1:");
+  PrintS("Action: Initialize the link and send doorbells in both directions.");
+  PrintS("Result: The link should be initialized and the doorbells received.");
+  PrintS("----------------------------------------------------------------------");
+  /******************************************************************************/
+  TESTSTART("TG_riouart-TC3-Step1");
+  /******************************************************************************/
+
+  RIOUART_open(&uartA);
+  RIOUART_open(&uartB);
+  startLink();
+
+  for(i = 0; i < 3*QUEUE_LENGTH; i++)
+  {
+    RIOPACKET_setDoorbell(&packet, 0x0002, 0x0001, i, 0x7e7d+i);
+    RIOSTACK_setOutboundPacket(&stackA, &packet);
+    RIOPACKET_setDoorbell(&packet, 0x0001, 0x0002, i, 0x2000+i);
+    RIOSTACK_setOutboundPacket(&stackB, &packet);
+    runLink(50);
+
+    TESTEXPR(RIOSTACK_getInboundQueueLength(&stackB), 1);
+    RIOSTACK_getInboundPacket(&stackB, &packet);
+    RIOPACKET_getDoorbell(&packet, &dstid, &srcid, &tid, &info);
+    TESTEXPR(info, 0x7e7d+i);
+    TESTEXPR(RIOSTACK_getInboundQueueLength(&stackA), 1);
+    RIOSTACK_getInboundPacket(&stackA, &packet);
+    RIOPACKET_getDoorbell(&packet, &dstid, &srcid, &tid, &info);
+    TESTEXPR(info, 0x2000+i);
+  }
+  TESTEXPR(uartA.statusRxError, 0);
+  TESTEXPR(uartB.statusRxError, 0);
+
+  /******************************************************************************/
+  TESTEND;
+  /******************************************************************************/
+}
+
+
+CU_ErrorCode addTests( void )
+{
+  if( CUE_SUCCESS != CU_initialize_registry() )
+  {
+    return CU_get_error();
+  }
+
+  CU_pSuite suite = CU_add_suite( "RIOUARTTEST", NULL, NULL );
+  if( NULL == suite )
+  {
+    CU_cleanup_registry();
+    return CU_get_error();
+  }
+
+  CU_add_test( suite, "allTests", &allTests );
+
+  return CUE_SUCCESS;
+}
+
+
+int main(int argc, char argv[])
+{
+  addTests();
+  CU_basic_run_tests();
+  return CU_get_error();
+}
+
+/*************************** end of file **************************************/